@@ -0,0 +1,109 @@
+#!/bin/sh
+#
+# Benchmark driver for the cc65 toolchain.
+#
+# Compiles, assembles and links a pinned corpus - the samples tree plus the
+# synthetic stress inputs in this directory - and reports wall time, peak
+# RSS and instruction count per benchmark. Peak RSS needs GNU time and the
+# instruction counts need perf(1); both columns degrade to '-' when the
+# respective tool is not available.
+#
+# Results are compared against baseline.txt if it exists. Run with --save
+# to store the current results as the new baseline.
+#
+
+BINDIR=${BINDIR:-../bin}
+WORKDIR=${WORKDIR:-../benchwrk}
+BASELINE=baseline.txt
+RESULTS=$WORKDIR/results.txt
+
+CC=$BINDIR/cc65
+AS=$BINDIR/ca65
+LD=$BINDIR/ld65
+
+# Check for the tools used for the measurements
+HAVE_GNU_TIME=no
+if /usr/bin/time -f '%e %M' true >/dev/null 2>&1; then
+    HAVE_GNU_TIME=yes
+fi
+HAVE_PERF=no
+if perf stat -e instructions true >/dev/null 2>&1; then
+    HAVE_PERF=yes
+fi
+
+mkdir -p "$WORKDIR" || exit 1
+: > "$RESULTS"
+
+# run <name> <command ...>
+#
+# Runs the command once to warm up the file system caches, then measures a
+# second run and appends "<name> <seconds> <rss-kb> <instructions>" to the
+# result file.
+run () {
+    name=$1; shift
+
+    # Warmup run, which also catches failing commands
+    "$@" > /dev/null || { echo "bench: $name failed" >&2; exit 1; }
+
+    # Instruction count
+    insn=-
+    if [ $HAVE_PERF = yes ]; then
+        perf stat -e instructions -x, -o "$WORKDIR/perf.tmp" "$@" > /dev/null 2>&1
+        insn=$(awk -F, '$3 ~ /instructions/ { print $1 }' "$WORKDIR/perf.tmp")
+        [ -n "$insn" ] || insn=-
+    fi
+
+    # Measured run. Beware: 'set --' clobbers the command arguments, so this
+    # must come last.
+    if [ $HAVE_GNU_TIME = yes ]; then
+        /usr/bin/time -f '%e %M' -o "$WORKDIR/time.tmp" "$@" > /dev/null
+        set -- $(cat "$WORKDIR/time.tmp")
+        secs=$1
+        rss=$2
+    else
+        start=$(date +%s.%N)
+        "$@" > /dev/null
+        end=$(date +%s.%N)
+        secs=$(echo "$start $end" | awk '{ printf "%.2f", $2 - $1 }')
+        rss=-
+    fi
+
+    echo "$name $secs $rss $insn" >> "$RESULTS"
+}
+
+# The pinned corpus. The samples exercise the normal compile/assemble/link
+# path, the stress inputs concentrate on the macro expander and the
+# optimizer.
+for S in ascii fire gunzip65 hello mandelbrot sieve; do
+    run "cc65:$S" $CC -t c64 -Oirs -I ../include -o "$WORKDIR/$S.s" "../samples/$S.c"
+    run "ca65:$S" $AS -t c64 -o "$WORKDIR/$S.o" "$WORKDIR/$S.s"
+done
+run "cc65:optstress" $CC -t c64 -Oirs -I ../include -o "$WORKDIR/optstress.s" optstress.c
+run "ca65:optstress" $AS -t c64 -o "$WORKDIR/optstress.o" "$WORKDIR/optstress.s"
+run "ca65:macrostress" $AS -o "$WORKDIR/macrostress.o" macrostress.s
+run "ld65:gunzip65" $LD -o "$WORKDIR/gunzip65.prg" -C ../cfg/c64.cfg "$WORKDIR/gunzip65.o" c64.lib -L ../lib
+
+# Print the report, with deltas against the baseline if there is one
+echo
+printf '%-18s %9s %10s %14s\n' "benchmark" "time[s]" "rss[KB]" "instructions"
+if [ -f $BASELINE ]; then
+    awk 'NR == FNR { base[$1] = $2; next }
+         {
+             delta = ""
+             if ($1 in base && base[$1] > 0) {
+                 delta = sprintf ("  %+6.1f%%", ($2 - base[$1]) / base[$1] * 100.0)
+             }
+             printf "%-18s %9s %10s %14s%s\n", $1, $2, $3, $4, delta
+         }' $BASELINE "$RESULTS"
+else
+    awk '{ printf "%-18s %9s %10s %14s\n", $1, $2, $3, $4 }' "$RESULTS"
+    echo
+    echo "No baseline - run 'make save' to store these results as the baseline."
+fi
+
+# Save the results as the new baseline if requested
+if [ "$1" = "--save" ]; then
+    cp "$RESULTS" $BASELINE
+    echo
+    echo "Results saved as the new baseline."
+fi
@@ -0,0 +1,26 @@
+;
+; Synthetic stress input for the assembler macro expander.
+;
+; The inner macros are expanded twenty thousand times via .repeat, so the
+; run time is dominated by macro lookup, parameter substitution and token
+; replay in src/ca65/macro.c.
+;
+
+.macro  store   addr, val
+        lda     #<(val)
+        sta     addr
+        lda     #>(val)
+        sta     addr+1
+.endmacro
+
+.macro  entry   num
+        .if (num & 1)
+        store   $0400 + (num & $3F) * 2, num * 17
+        .else
+        store   $0400 + (num & $3F) * 2 + 1, num * 23
+        .endif
+.endmacro
+
+.repeat 20000, I
+        entry   I
+.endrepeat
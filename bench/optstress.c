@@ -0,0 +1,64 @@
+/*
+** Synthetic stress input for the compiler optimizer.
+**
+** The macros stamp out many similar functions, each with enough arithmetic,
+** branches and loops that the peephole optimizer in src/cc65/codeopt.c gets
+** a code segment of useful size to chew on for every single function.
+*/
+
+
+
+#define STEP(k)                                                 \
+    s += (x >> 1) + (x & 7) * (k) + i;                          \
+    if (s & 1) {                                                \
+        s ^= x + (k);                                           \
+    } else {                                                    \
+        s -= (k) + (i << 2);                                    \
+    }                                                           \
+    switch (s & 3) {                                            \
+        case 0:  s += x;      break;                            \
+        case 1:  s -= x >> 2; break;                            \
+        case 2:  s ^= (k);    break;                            \
+        default: s += i;      break;                            \
+    }
+
+#define F(name, k)                                              \
+static unsigned name (unsigned x)                               \
+{                                                               \
+    unsigned i;                                                 \
+    unsigned s = k;                                             \
+    for (i = 0; i < 10; ++i) {                                  \
+        STEP (k + 0)                                            \
+        STEP (k + 1)                                            \
+        STEP (k + 2)                                            \
+        STEP (k + 3)                                            \
+        STEP (k + 4)                                            \
+        STEP (k + 5)                                            \
+        STEP (k + 6)                                            \
+        STEP (k + 7)                                            \
+    }                                                           \
+    return s;                                                   \
+}
+
+F (f01,  1) F (f02,  2) F (f03,  3) F (f04,  4) F (f05,  5)
+F (f06,  6) F (f07,  7) F (f08,  8) F (f09,  9) F (f10, 10)
+F (f11, 11) F (f12, 12) F (f13, 13) F (f14, 14) F (f15, 15)
+F (f16, 16) F (f17, 17) F (f18, 18) F (f19, 19) F (f20, 20)
+F (f21, 21) F (f22, 22) F (f23, 23) F (f24, 24) F (f25, 25)
+F (f26, 26) F (f27, 27) F (f28, 28) F (f29, 29) F (f30, 30)
+F (f31, 31) F (f32, 32) F (f33, 33) F (f34, 34) F (f35, 35)
+F (f36, 36) F (f37, 37) F (f38, 38) F (f39, 39) F (f40, 40)
+
+int main (void)
+{
+    unsigned s = 0;
+    s += f01 (s); s += f02 (s); s += f03 (s); s += f04 (s); s += f05 (s);
+    s += f06 (s); s += f07 (s); s += f08 (s); s += f09 (s); s += f10 (s);
+    s += f11 (s); s += f12 (s); s += f13 (s); s += f14 (s); s += f15 (s);
+    s += f16 (s); s += f17 (s); s += f18 (s); s += f19 (s); s += f20 (s);
+    s += f21 (s); s += f22 (s); s += f23 (s); s += f24 (s); s += f25 (s);
+    s += f26 (s); s += f27 (s); s += f28 (s); s += f29 (s); s += f30 (s);
+    s += f31 (s); s += f32 (s); s += f33 (s); s += f34 (s); s += f35 (s);
+    s += f36 (s); s += f37 (s); s += f38 (s); s += f39 (s); s += f40 (s);
+    return (int) s;
+}
@@ -100,6 +100,13 @@ unsigned char doesclrscrafterexit (void);
 ** termination.
 */
 
+void* __fastcall__ decompress (void* dest, const void* src);
+/* Expand a segment that was run length encoded by the linker (COMPRESSED
+** attribute in the SEGMENTS section of the linker config) to dest. src is
+** the load address of the compressed data. Returns the first byte behind
+** the expanded output.
+*/
+
 
 
 /* End of cc65.h */
@@ -0,0 +1,73 @@
+;
+; void* __fastcall__ decompress (void* dest, const void* src);
+;
+; Expand a segment that was run length encoded by the linker (COMPRESSED
+; attribute in the SEGMENTS section of the linker config). The input is a
+; sequence of chunks, each introduced by a control byte C: C in 1..127 means
+; C literal bytes follow, C in 128..255 means that the following byte is
+; repeated C-125 (3..130) times, and C == 0 ends the stream. The function
+; returns the first byte behind the expanded output.
+;
+
+        .export         _decompress
+        .import         popax
+        .importzp       ptr1, ptr2, tmp1
+
+_decompress:
+        sta     ptr1
+        stx     ptr1+1          ; Source
+        jsr     popax
+        sta     ptr2
+        stx     ptr2+1          ; Destination
+        ldy     #0              ; Stays zero all the time
+
+; Fetch the next control byte
+
+Next:   lda     (ptr1),y
+        jsr     IncSrc
+        cmp     #0
+        beq     Done            ; Zero ends the stream
+        bmi     Run             ; 128..255 is a repeat run
+
+; 1..127: Copy that many literal bytes
+
+        sta     tmp1
+Lit:    lda     (ptr1),y
+        jsr     IncSrc
+        sta     (ptr2),y
+        jsr     IncDest
+        dec     tmp1
+        bne     Lit
+        beq     Next
+
+; 128..255: The following byte is repeated C-125 times
+
+Run:    sec
+        sbc     #125
+        sta     tmp1
+        lda     (ptr1),y
+Rep:    sta     (ptr2),y
+        jsr     IncDest
+        dec     tmp1
+        bne     Rep
+        jsr     IncSrc
+        jmp     Next
+
+; Done. Return the first byte behind the output.
+
+Done:   lda     ptr2
+        ldx     ptr2+1
+        rts
+
+; Increment helpers. Beware: Both must preserve the accumulator.
+
+IncSrc: inc     ptr1
+        bne     @L1
+        inc     ptr1+1
+@L1:    rts
+
+IncDest:
+        inc     ptr2
+        bne     @L1
+        inc     ptr2+1
+@L1:    rts
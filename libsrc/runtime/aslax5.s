@@ -0,0 +1,21 @@
+;
+; CC65 runtime: Scale the primary register by 32
+;
+
+        .export         aslax5, shlax5
+        .importzp       tmp1
+
+aslax5:
+shlax5: stx     tmp1
+        asl     a
+        rol     tmp1
+        asl     a
+        rol     tmp1
+        asl     a
+        rol     tmp1
+        asl     a
+        rol     tmp1
+        asl     a
+        rol     tmp1
+        ldx     tmp1
+        rts
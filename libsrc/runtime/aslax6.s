@@ -0,0 +1,23 @@
+;
+; CC65 runtime: Scale the primary register by 64
+;
+
+        .export         aslax6, shlax6
+        .importzp       tmp1
+
+aslax6:
+shlax6: stx     tmp1
+        asl     a
+        rol     tmp1
+        asl     a
+        rol     tmp1
+        asl     a
+        rol     tmp1
+        asl     a
+        rol     tmp1
+        asl     a
+        rol     tmp1
+        asl     a
+        rol     tmp1
+        ldx     tmp1
+        rts
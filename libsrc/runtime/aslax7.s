@@ -0,0 +1,25 @@
+;
+; CC65 runtime: Scale the primary register by 128
+;
+
+        .export         aslax7, shlax7
+        .importzp       tmp1
+
+aslax7:
+shlax7: stx     tmp1
+        asl     a
+        rol     tmp1
+        asl     a
+        rol     tmp1
+        asl     a
+        rol     tmp1
+        asl     a
+        rol     tmp1
+        asl     a
+        rol     tmp1
+        asl     a
+        rol     tmp1
+        asl     a
+        rol     tmp1
+        ldx     tmp1
+        rts
@@ -61,8 +61,11 @@ void AddObjFiles (int argc, char* argv [])
         Error ("No object files to add");
     }
 
-    /* Open the library, read the index */
-    LibOpen (argv [0], 0, 1);
+    /* Open the library for in-place appending, read the index. All object
+    ** files given on the command line are added in one pass, so only one
+    ** index rewrite is paid for the whole batch.
+    */
+    LibOpenInPlace (argv [0]);
 
     /* Add the object files */
     I = 1;
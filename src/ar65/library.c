@@ -40,6 +40,7 @@
 /* common */
 #include "cmdline.h"
 #include "exprdefs.h"
+#include "hashfunc.h"
 #include "libdefs.h"
 #include "print.h"
 #include "symdefs.h"
@@ -70,6 +71,11 @@ static char*            NewLibName = 0;
 static FILE*            Lib = 0;
 static FILE*            NewLib = 0;
 
+/* Flag for in-place updates. If set, NewLib is an alias for Lib and new data
+** is appended to the existing library instead of copying it to a temp file.
+*/
+static int              InPlace = 0;
+
 /* The library header */
 static LibHeader        Header = {
     LIB_MAGIC,
@@ -78,6 +84,65 @@ static LibHeader        Header = {
     0
 };
 
+/* The shared string pool of the library. The pool is append only, so the
+** indices of strings read from an existing library stay valid and member
+** data that references them may be copied unchanged. Strings of deleted
+** members stay in the pool; they are squeezed out when the library is
+** rebuilt from the object files.
+*/
+static Collection       StrPool = STATIC_COLLECTION_INITIALIZER;
+
+/* Hash table mapping strings to their pool indices */
+#define STRPOOL_HASHTAB_SIZE    1024U
+typedef struct PoolNode PoolNode;
+struct PoolNode {
+    PoolNode*           Next;           /* Next node in hash chain */
+    unsigned            Id;             /* Index of the string in the pool */
+};
+static PoolNode*        PoolHashTab[STRPOOL_HASHTAB_SIZE];
+
+
+
+/*****************************************************************************/
+/*                             Shared string pool                            */
+/*****************************************************************************/
+
+
+
+unsigned LibInternString (const char* S)
+/* Insert the given string into the shared string pool if it is not already
+** there and return its pool index.
+*/
+{
+    /* Search the hash chain for the string */
+    PoolNode** Slot = &PoolHashTab[HashStr (S) & (STRPOOL_HASHTAB_SIZE - 1)];
+    PoolNode* N;
+    for (N = *Slot; N != 0; N = N->Next) {
+        if (strcmp (CollConstAt (&StrPool, N->Id), S) == 0) {
+            return N->Id;
+        }
+    }
+
+    /* Not found, insert the string */
+    N = xmalloc (sizeof (*N));
+    N->Next = *Slot;
+    N->Id   = CollCount (&StrPool);
+    *Slot   = N;
+    CollAppend (&StrPool, xstrdup (S));
+    return N->Id;
+}
+
+
+
+const char* LibPoolString (unsigned Id)
+/* Return the string with the given pool index */
+{
+    if (Id >= CollCount (&StrPool)) {
+        Error ("Invalid string pool index in library '%s'", LibName);
+    }
+    return CollConstAt (&StrPool, Id);
+}
+
 
 
 /*****************************************************************************/
@@ -139,6 +204,29 @@ static void ReadIndex (void)
         ReadIndexEntry ();
     }
 
+    /* If the library has a checksum table, it follows the member entries
+    ** and holds one checksum per member in index order.
+    */
+    if ((Header.Flags & LIB_FLAG_HASHTAB) != 0) {
+        for (I = 0; I < CollCount (&ObjPool); ++I) {
+            ObjData* O  = CollAtUnchecked (&ObjPool, I);
+            O->HaveHash = Read8 (Lib);
+            O->Hash     = Read32 (Lib);
+        }
+    }
+
+    /* If the library has a shared string pool, it follows the checksum
+    ** table. Interning the strings in file order reproduces their indices.
+    */
+    if ((Header.Flags & LIB_FLAG_STRPOOL) != 0) {
+        unsigned long StrCount = ReadVar (Lib);
+        while (StrCount--) {
+            char* S = ReadStr (Lib);
+            LibInternString (S);
+            xfree (S);
+        }
+    }
+
     /* Read basic object file data from the actual entries */
     for (I = 0; I < CollCount (&ObjPool); ++I) {
 
@@ -146,7 +234,7 @@ static void ReadIndex (void)
         ObjData* O = CollAtUnchecked (&ObjPool, I);
 
         /* Read data */
-        ObjReadData (Lib, O);
+        ObjReadData (Lib, O, (Header.Flags & LIB_FLAG_STRPOOL) != 0);
     }
 }
 
@@ -176,9 +264,11 @@ static void WriteHeader (void)
 static void WriteIndexEntry (const ObjData* O)
 /* Write one index entry */
 {
-    /* Module name/flags/MTime/start/size */
+    /* Module name/flags/MTime/start/size. OBJ_HAVEDATA and OBJ_POOLDATA
+    ** describe internal state only and are not stored.
+    */
     WriteStr (NewLib, O->Name);
-    Write16  (NewLib, O->Flags & ~OBJ_HAVEDATA);
+    Write16  (NewLib, O->Flags & ~(OBJ_HAVEDATA | OBJ_POOLDATA));
     Write32  (NewLib, O->MTime);
     Write32  (NewLib, O->Start);
     Write32  (NewLib, O->Size);
@@ -189,7 +279,8 @@ static void WriteIndexEntry (const ObjData* O)
 static void WriteIndex (void)
 /* Write the index of a library file */
 {
-    unsigned I;
+    unsigned Count;
+    unsigned I, J;
 
     /* Sync I/O in case the last operation was a read */
     fseek (NewLib, 0, SEEK_CUR);
@@ -204,6 +295,50 @@ static void WriteIndex (void)
     for (I = 0; I < CollCount (&ObjPool); ++I) {
         WriteIndexEntry (CollConstAt (&ObjPool, I));
     }
+
+    /* Write the checksum table: For each member one flag byte that tells
+    ** if the checksum is valid, then the checksum itself. Members read from
+    ** libraries without a checksum table keep an invalid entry.
+    */
+    for (I = 0; I < CollCount (&ObjPool); ++I) {
+        const ObjData* O = CollConstAt (&ObjPool, I);
+        Write8  (NewLib, O->HaveHash != 0);
+        Write32 (NewLib, O->Hash);
+    }
+
+    /* Write the shared string pool. The member data was written before the
+    ** index, so all strings are interned at this point.
+    */
+    WriteVar (NewLib, CollCount (&StrPool));
+    for (I = 0; I < CollCount (&StrPool); ++I) {
+        WriteStr (NewLib, CollConstAt (&StrPool, I));
+    }
+
+    /* Count the exports of all object files */
+    Count = 0;
+    for (I = 0; I < CollCount (&ObjPool); ++I) {
+        const ObjData* O = CollConstAt (&ObjPool, I);
+        Count += CollCount (&O->Exports);
+    }
+
+    /* Write the export index: The export count, then for each export its
+    ** name and the number of the member that exports it. The linker uses
+    ** this index to select members without parsing the headers of members
+    ** it doesn't need.
+    */
+    WriteVar (NewLib, Count);
+    for (I = 0; I < CollCount (&ObjPool); ++I) {
+        const ObjData* O = CollConstAt (&ObjPool, I);
+        for (J = 0; J < CollCount (&O->Exports); ++J) {
+            WriteStr (NewLib, CollConstAt (&O->Exports, J));
+            WriteVar (NewLib, I);
+        }
+    }
+
+    /* Flag the checksum table, the string pool and the export index in the
+    ** header.
+    */
+    Header.Flags |= LIB_FLAG_HASHTAB | LIB_FLAG_STRPOOL | LIB_FLAG_EXPINDEX;
 }
 
 
@@ -266,24 +401,82 @@ void LibOpen (const char* Name, int MustExist, int NeedTemp)
 
 
 
-unsigned long LibCopyTo (FILE* F, unsigned long Bytes)
+void LibOpenInPlace (const char* Name)
+/* Open an existing library for appending new members in place. The data of
+** members that are not replaced stays untouched; new member data overwrites
+** the old index, which is rewritten behind the new data on close. This makes
+** the cost of an update proportional to the added members instead of the
+** library size, at the price of a corrupt library if ar65 is interrupted
+** while writing. If the library does not exist or cannot be opened for
+** updating, fall back to the temp file mechanism of LibOpen.
+*/
+{
+    /* Try to open the library for updating */
+    FILE* F = fopen (Name, "r+b");
+    if (F == 0) {
+        /* Use the normal mechanism, which also handles creation */
+        LibOpen (Name, 0, 1);
+        return;
+    }
+
+    /* Remember the name and the file */
+    LibName = xstrdup (Name);
+    Lib     = F;
+
+    /* Read the header */
+    ReadHeader ();
+
+    /* An in-place update requires the shared string pool, since the data of
+    ** unchanged members stays untouched. If the library still has inline
+    ** member strings, fall back to a full rewrite which converts it.
+    */
+    if ((Header.Flags & LIB_FLAG_STRPOOL) == 0) {
+        fclose (Lib);
+        Lib = 0;
+        xfree ((char*) LibName);
+        LibOpen (Name, 1, 1);
+        return;
+    }
+
+    /* All writes go to the library itself */
+    NewLib  = Lib;
+    InPlace = 1;
+
+    /* Read the existing index */
+    ReadIndex ();
+
+    /* New member data is appended where the old index started */
+    fseek (Lib, Header.IndexOffs, SEEK_SET);
+}
+
+
+
+unsigned long LibCopyTo (FILE* F, unsigned long Bytes, unsigned long* Hash)
 /* Copy data from F to the temp library file, return the start position in
-** the temporary library file.
+** the temporary library file. If Hash is not NULL, the checksum of the
+** copied data is stored there.
 */
 {
     unsigned char Buf [4096];
+    unsigned H = HASHDATA_INITIAL;
 
     /* Remember the position */
     unsigned long Pos = ftell (NewLib);
 
-    /* Copy loop */
+    /* Copy loop, checksumming the data as it passes through */
     while (Bytes) {
         unsigned Count = (Bytes > sizeof (Buf))? sizeof (Buf) : Bytes;
         ReadData (F, Buf, Count);
+        H = HashData (Buf, Count, H);
         WriteData (NewLib, Buf, Count);
         Bytes -= Count;
     }
 
+    /* Pass the checksum back if the caller wants it */
+    if (Hash) {
+        *Hash = H;
+    }
+
     /* Return the start position */
     return Pos;
 }
@@ -309,6 +502,38 @@ void LibCopyFrom (unsigned long Pos, unsigned long Bytes, FILE* F)
 
 
 
+unsigned long LibWriteData (const void* Data, unsigned long Size, unsigned long* Hash)
+/* Write a block of data to the temp library file, return the start position
+** in the temporary library file. If Hash is not NULL, the checksum of the
+** written data is stored there.
+*/
+{
+    /* Remember the position */
+    unsigned long Pos = ftell (NewLib);
+
+    /* Write the data */
+    WriteData (NewLib, Data, Size);
+
+    /* Pass the checksum back if the caller wants it */
+    if (Hash) {
+        *Hash = HashData (Data, Size, HASHDATA_INITIAL);
+    }
+
+    /* Return the start position */
+    return Pos;
+}
+
+
+
+void LibReadData (unsigned long Pos, unsigned long Size, void* Data)
+/* Read a block of data from the library file */
+{
+    fseek (Lib, Pos, SEEK_SET);
+    ReadData (Lib, Data, Size);
+}
+
+
+
 static void LibCheckExports (ObjData* O)
 /* Insert all exports from the given object file into the global list
 ** checking for duplicates.
@@ -333,6 +558,69 @@ static void LibCheckExports (ObjData* O)
 
 
 
+void LibVerify (void)
+/* Compare the stored member checksums of the open library against checksums
+** computed from the member data. All members are checked before the function
+** bails out, so one run reports every corrupt member.
+*/
+{
+    unsigned I;
+    unsigned char Buf [4096];
+    unsigned Bad     = 0;
+    unsigned Missing = 0;
+
+    /* Walk over all members */
+    for (I = 0; I < CollCount (&ObjPool); ++I) {
+
+        unsigned H;
+        unsigned long Bytes;
+
+        /* Get the object file entry */
+        const ObjData* O = CollConstAt (&ObjPool, I);
+
+        /* Members from libraries without a checksum table cannot be
+        ** verified.
+        */
+        if (!O->HaveHash) {
+            Print (stdout, 1, "Skipping module '%s' (no checksum)\n", O->Name);
+            ++Missing;
+            continue;
+        }
+
+        /* Checksum the member data */
+        fseek (Lib, O->Start, SEEK_SET);
+        H     = HASHDATA_INITIAL;
+        Bytes = O->Size;
+        while (Bytes) {
+            unsigned Count = (Bytes > sizeof (Buf))? sizeof (Buf) : Bytes;
+            ReadData (Lib, Buf, Count);
+            H = HashData (Buf, Count, H);
+            Bytes -= Count;
+        }
+
+        /* Compare against the stored checksum */
+        if (H != O->Hash) {
+            Warning ("Checksum mismatch in module '%s' of library '%s'",
+                     O->Name, LibName);
+            ++Bad;
+        } else {
+            Print (stdout, 1, "Module '%s' is ok\n", O->Name);
+        }
+    }
+
+    /* Summarize */
+    if (Missing > 0) {
+        Warning ("%u module(s) in library '%s' have no checksum",
+                 Missing, LibName);
+    }
+    if (Bad > 0) {
+        Error ("%u of %u module(s) in library '%s' failed verification",
+               Bad, CollCount (&ObjPool), LibName);
+    }
+}
+
+
+
 void LibClose (void)
 /* Write remaining data, close both files and copy the temp file to the old
 ** filename
@@ -357,13 +645,27 @@ void LibClose (void)
             /* Check exports, make global export table */
             LibCheckExports (O);
 
-            /* Copy data if needed */
-            if ((O->Flags & OBJ_HAVEDATA) == 0) {
-                /* Data is still in the old library */
-                fseek (Lib, O->Start, SEEK_SET);
-                O->Start = ftell (NewLib);
-                LibCopyTo (Lib, O->Size);
-                O->Flags |= OBJ_HAVEDATA;
+            /* Copy data if needed. For an in-place update the data of
+            ** unchanged members stays where it is.
+            */
+            if (!InPlace && (O->Flags & OBJ_HAVEDATA) == 0) {
+                if ((O->Flags & OBJ_POOLDATA) != 0) {
+                    /* The member data already uses the pooled string
+                    ** encoding, and the pool of the old library was interned
+                    ** first, so the indices are still valid and the data can
+                    ** be copied unchanged.
+                    */
+                    fseek (Lib, O->Start, SEEK_SET);
+                    O->Start = ftell (NewLib);
+                    LibCopyTo (Lib, O->Size, &O->Hash);
+                    O->HaveHash = 1;
+                    O->Flags |= OBJ_HAVEDATA;
+                } else {
+                    /* The member carries inline strings, convert it to the
+                    ** pooled encoding while copying.
+                    */
+                    ObjWritePooled (Lib, O);
+                }
             }
         }
 
@@ -373,6 +675,21 @@ void LibClose (void)
         /* Write the updated header */
         WriteHeader ();
 
+        if (InPlace) {
+
+            /* The new data was written to the library itself, so we're
+            ** done. Stale bytes of the old index beyond the new file end
+            ** are not reachable from the index and therefore harmless.
+            */
+            if (fclose (Lib) != 0) {
+                Error ("Problem closing '%s': %s", LibName, strerror (errno));
+            }
+            Lib    = 0;
+            NewLib = 0;
+
+            return;
+        }
+
         /* Close the file */
         if (Lib && fclose (Lib) != 0) {
             Error ("Error closing library: %s", strerror (errno));
@@ -65,14 +65,46 @@ void LibOpen (const char* Name, int MustExist, int NeedTemp);
 ** is created.
 */
 
-unsigned long LibCopyTo (FILE* F, unsigned long Bytes);
+void LibOpenInPlace (const char* Name);
+/* Open an existing library for appending new members in place. The data of
+** members that are not replaced stays untouched; new member data overwrites
+** the old index, which is rewritten behind the new data on close. If the
+** library does not exist or cannot be opened for updating, fall back to the
+** temp file mechanism of LibOpen.
+*/
+
+unsigned LibInternString (const char* S);
+/* Insert the given string into the shared string pool if it is not already
+** there and return its pool index.
+*/
+
+const char* LibPoolString (unsigned Id);
+/* Return the string with the given pool index */
+
+unsigned long LibCopyTo (FILE* F, unsigned long Bytes, unsigned long* Hash);
 /* Copy data from F to the temp library file, return the start position in
-** the temporary library file.
+** the temporary library file. If Hash is not NULL, the checksum of the
+** copied data is stored there.
 */
 
 void LibCopyFrom (unsigned long Pos, unsigned long Bytes, FILE* F);
 /* Copy data from the library file into another file */
 
+unsigned long LibWriteData (const void* Data, unsigned long Size, unsigned long* Hash);
+/* Write a block of data to the temp library file, return the start position
+** in the temporary library file. If Hash is not NULL, the checksum of the
+** written data is stored there.
+*/
+
+void LibReadData (unsigned long Pos, unsigned long Size, void* Data);
+/* Read a block of data from the library file */
+
+void LibVerify (void);
+/* Compare the stored member checksums of the open library against checksums
+** computed from the member data. All members are checked before the function
+** bails out, so one run reports every corrupt member.
+*/
+
 void LibClose (void);
 /* Write remaining data, close both files and copy the temp file to the old
 ** filename
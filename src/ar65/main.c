@@ -48,6 +48,7 @@
 #include "del.h"
 #include "list.h"
 #include "extract.h"
+#include "verify.h"
 
 
 
@@ -67,7 +68,8 @@ static void Usage (void)
             "\tt\tList library table\n"
             "\tv\tIncrease verbosity (put before other operation)\n"
             "\tx\tExtract modules\n"
-            "\tV\tPrint the archiver version\n",
+            "\tV\tPrint the archiver version\n"
+            "\t--verify\tVerify the member checksums\n",
             ProgName);
     exit (EXIT_FAILURE);
 }
@@ -125,6 +127,15 @@ int main (int argc, char* argv [])
                 fprintf (stderr, "%s V%s\n", ProgName, GetVersionAsString ());
                 break;
 
+            case '-':
+                if (strcmp (Arg, "--verify") == 0) {
+                    VerifyObjFiles (ArgCount - I - 1, &ArgVec [I+1]);
+                } else {
+                    fprintf (stderr, "Unknown option: %s\n", Arg);
+                    Usage ();
+                }
+                break;
+
             default:
                 fprintf (stderr, "Unknown option: %s\n", Arg);
                 Usage ();
@@ -76,6 +76,8 @@ ObjData* NewObjData (void)
     O->MTime       = 0;
     O->Start       = 0;
     O->Size        = 0;
+    O->Hash        = 0;
+    O->HaveHash    = 0;
 
     O->Strings     = EmptyCollection;
     O->Exports     = EmptyCollection;
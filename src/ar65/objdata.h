@@ -52,6 +52,7 @@
 
 /* Values for the Flags field */
 #define OBJ_HAVEDATA    0x0001          /* The object data is in the tmp file */
+#define OBJ_POOLDATA    0x0002          /* Strings reference the shared pool */
 
 
 /* Internal structure holding object file data */
@@ -64,6 +65,8 @@ struct ObjData {
     unsigned long       MTime;          /* Modifiation time of object file */
     unsigned long       Start;          /* Start offset of data in library */
     unsigned long       Size;           /* Size of data in library */
+    unsigned long       Hash;           /* Checksum of data in library */
+    unsigned            HaveHash;       /* True if Hash is valid */
 
     /* Object file header */
     ObjHeader           Header;
@@ -115,6 +115,90 @@ static void ObjReadHeader (FILE* Obj, ObjHeader* H, const char* Name)
 
 
 
+static unsigned EncodeVar (unsigned char* Buf, unsigned long V)
+/* Encode V into Buf using the variable sized format of the object file
+** format and return the number of bytes used.
+*/
+{
+    unsigned Bytes = 0;
+    do {
+        unsigned char C = V & 0x7F;
+        V >>= 7;
+        if (V) {
+            C |= 0x80;
+        }
+        Buf[Bytes++] = C;
+    } while (V != 0);
+    return Bytes;
+}
+
+
+
+static unsigned long Get32 (const unsigned char* Buf)
+/* Read a 32 bit value in little endian format from Buf */
+{
+    return ((unsigned long) Buf[0])       |
+           ((unsigned long) Buf[1] <<  8) |
+           ((unsigned long) Buf[2] << 16) |
+           ((unsigned long) Buf[3] << 24);
+}
+
+
+
+static void Put32 (unsigned char* Buf, unsigned long V)
+/* Write a 32 bit value in little endian format to Buf */
+{
+    Buf[0] = V         & 0xFF;
+    Buf[1] = (V >>  8) & 0xFF;
+    Buf[2] = (V >> 16) & 0xFF;
+    Buf[3] = (V >> 24) & 0xFF;
+}
+
+
+
+static unsigned char* SpliceStrPool (const unsigned char* Buf, const ObjData* O,
+                                     const unsigned char* Pool, unsigned long PoolSize,
+                                     unsigned long* NewSize)
+/* Return a copy of the member data in Buf with the string pool section
+** replaced by the one in Pool. The offsets of the sections behind the string
+** pool are adjusted for the size change. The caller must free the result.
+*/
+{
+    unsigned I;
+    const ObjHeader* H = &O->Header;
+    unsigned long Head = H->StrPoolOffs;
+    unsigned long Tail = O->Size - (H->StrPoolOffs + H->StrPoolSize);
+    unsigned char* New = xmalloc (Head + PoolSize + Tail);
+
+    /* Copy the data before and behind the string pool with the replacement
+    ** section in between.
+    */
+    memcpy (New, Buf, Head);
+    memcpy (New + Head, Pool, PoolSize);
+    memcpy (New + Head + PoolSize, Buf + Head + H->StrPoolSize, Tail);
+
+    /* Adjust the section offsets in the header. The header holds eleven
+    ** offset/size pairs of 32 bit values starting at offset 8; only offsets
+    ** behind the string pool move.
+    */
+    for (I = 0; I < 11; ++I) {
+        unsigned char* P = New + 8 + I * 8;
+        unsigned long Offs = Get32 (P);
+        if (Offs > H->StrPoolOffs) {
+            Put32 (P, Offs + PoolSize - H->StrPoolSize);
+        }
+    }
+
+    /* Store the size of the replacement section */
+    Put32 (New + 8 + 7 * 8 + 4, PoolSize);
+
+    /* Pass the new member size back and return the buffer */
+    *NewSize = Head + PoolSize + Tail;
+    return New;
+}
+
+
+
 static void SkipExpr (FILE* F)
 /* Skip an expression in F */
 {
@@ -152,11 +236,21 @@ static void SkipExpr (FILE* F)
 
 
 
-static void SkipLineInfoList (FILE* F)
+static void SkipLineInfoList (FILE* F, const ObjHeader* H)
 /* Skip a list of line infos in F */
 {
+    unsigned long Count;
+
+    /* If the file has interned line info lists, only an index into the list
+    ** table is stored.
+    */
+    if (OBJ_HAS_LILISTS (H->Flags)) {
+        (void) ReadVar (F);
+        return;
+    }
+
     /* Number of indices preceeds the list */
-    unsigned long Count = ReadVar (F);
+    Count = ReadVar (F);
 
     /* Skip indices */
     while (Count--) {
@@ -166,9 +260,11 @@ static void SkipLineInfoList (FILE* F)
 
 
 
-void ObjReadData (FILE* F, ObjData* O)
+void ObjReadData (FILE* F, ObjData* O, int Pooled)
 /* Read object file data from the given file. The function expects the Name
-** and Start fields to be valid. Header and basic data are read.
+** and Start fields to be valid. Header and basic data are read. If Pooled
+** is true, the string pool section of the member contains indices into the
+** shared string pool of the library instead of the strings themselves.
 */
 {
     unsigned long Count;
@@ -183,8 +279,16 @@ void ObjReadData (FILE* F, ObjData* O)
     fseek (F, O->Start + O->Header.StrPoolOffs, SEEK_SET);
     Count = ReadVar (F);
     CollGrow (&O->Strings, Count);
-    while (Count--) {
-        CollAppend (&O->Strings, ReadStr (F));
+    if (Pooled) {
+        /* The strings live in the shared pool of the library */
+        while (Count--) {
+            CollAppend (&O->Strings, xstrdup (LibPoolString (ReadVar (F))));
+        }
+        O->Flags |= OBJ_POOLDATA;
+    } else {
+        while (Count--) {
+            CollAppend (&O->Strings, ReadStr (F));
+        }
     }
 
     /* Read the exports */
@@ -218,9 +322,54 @@ void ObjReadData (FILE* F, ObjData* O)
         }
 
         /* Line info indices */
-        SkipLineInfoList (F);
-        SkipLineInfoList (F);
+        SkipLineInfoList (F, &O->Header);
+        SkipLineInfoList (F, &O->Header);
+    }
+}
+
+
+
+void ObjWritePooled (FILE* Source, ObjData* O)
+/* Convert the object file data starting at O->Start in Source to the pooled
+** string encoding and append it to the library file. Start, Size, Hash and
+** the flags of O are updated to describe the written member.
+*/
+{
+    unsigned char* Pool;
+    unsigned char* New;
+    unsigned long PoolSize, NewSize;
+    unsigned I;
+    unsigned Count = CollCount (&O->Strings);
+
+    /* Read the complete member data */
+    unsigned char* Buf = xmalloc (O->Size);
+    fseek (Source, O->Start, SEEK_SET);
+    ReadData (Source, Buf, O->Size);
+
+    /* Build the replacement string pool section: The string count, then for
+    ** each string its index in the shared pool. Interning the strings in
+    ** the order of O->Strings keeps the order of the old pool section.
+    */
+    Pool = xmalloc ((Count + 1) * 5);   /* Upper bound for the varints */
+    PoolSize = EncodeVar (Pool, Count);
+    for (I = 0; I < Count; ++I) {
+        PoolSize += EncodeVar (Pool + PoolSize,
+                               LibInternString (CollConstAt (&O->Strings, I)));
     }
+
+    /* Splice the new section into the member data */
+    New = SpliceStrPool (Buf, O, Pool, PoolSize, &NewSize);
+
+    /* Append the result to the library, checksumming it on the way */
+    O->Start    = LibWriteData (New, NewSize, &O->Hash);
+    O->Size     = NewSize;
+    O->HaveHash = 1;
+    O->Flags   |= OBJ_HAVEDATA | OBJ_POOLDATA;
+
+    /* Cleanup */
+    xfree (New);
+    xfree (Pool);
+    xfree (Buf);
 }
 
 
@@ -286,13 +435,13 @@ void ObjAdd (const char* Name)
     O->Size     = ftell (Obj);
 
     /* Read the basic data from the object file */
-    ObjReadData (Obj, O);
+    ObjReadData (Obj, O, 0);
 
-    /* Copy the complete object data to the library file and update the
-    ** starting offset
+    /* Convert the object data to the pooled string encoding and append it
+    ** to the library file, checksumming it on the way. This updates the
+    ** starting offset and the size.
     */
-    fseek (Obj, 0, SEEK_SET);
-    O->Start    = LibCopyTo (Obj, O->Size);
+    ObjWritePooled (Obj, O);
 
     /* Done, close the file (we read it only, so no error check) */
     fclose (Obj);
@@ -323,9 +472,53 @@ void ObjExtract (const char* Name)
     }
 
     /* Copy the complete object file data from the library to the new object
-    ** file.
+    ** file. If the member references the shared string pool, rebuild the
+    ** inline string pool section that a standalone object file must carry.
     */
-    LibCopyFrom (O->Start, O->Size, Obj);
+    if ((O->Flags & OBJ_POOLDATA) != 0) {
+
+        unsigned char* New;
+        unsigned char* Pool;
+        unsigned char* P;
+        unsigned char* Buf;
+        unsigned long PoolSize, NewSize;
+        unsigned I;
+        unsigned Count = CollCount (&O->Strings);
+
+        /* Read the member data from the library */
+        Buf = xmalloc (O->Size);
+        LibReadData (O->Start, O->Size, Buf);
+
+        /* Build the inline string pool section: The string count, then each
+        ** string with its length preceeding the characters.
+        */
+        PoolSize = 5;                   /* Upper bound for the count */
+        for (I = 0; I < Count; ++I) {
+            PoolSize += strlen (CollConstAt (&O->Strings, I)) + 5;
+        }
+        P = Pool = xmalloc (PoolSize);
+        P += EncodeVar (P, Count);
+        for (I = 0; I < Count; ++I) {
+            const char* S = CollConstAt (&O->Strings, I);
+            unsigned Len = strlen (S);
+            P += EncodeVar (P, Len);
+            memcpy (P, S, Len);
+            P += Len;
+        }
+        PoolSize = P - Pool;
+
+        /* Splice the inline section into the member data and write it */
+        New = SpliceStrPool (Buf, O, Pool, PoolSize, &NewSize);
+        WriteData (Obj, New, NewSize);
+
+        /* Cleanup */
+        xfree (New);
+        xfree (Pool);
+        xfree (Buf);
+
+    } else {
+        LibCopyFrom (O->Start, O->Size, Obj);
+    }
 
     /* Close the file */
     if (fclose (Obj) != 0) {
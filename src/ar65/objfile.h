@@ -58,9 +58,17 @@ struct ObjData;
 
 
 
-void ObjReadData (FILE* F, struct ObjData* O);
+void ObjReadData (FILE* F, struct ObjData* O, int Pooled);
 /* Read object file data from the given file. The function expects the Name
-** and Start fields to be valid. Header and basic data are read.
+** and Start fields to be valid. Header and basic data are read. If Pooled
+** is true, the string pool section of the member contains indices into the
+** shared string pool of the library instead of the strings themselves.
+*/
+
+void ObjWritePooled (FILE* Source, struct ObjData* O);
+/* Convert the object file data starting at O->Start in Source to the pooled
+** string encoding and append it to the library file. Start, Size, Hash and
+** the flags of O are updated to describe the written member.
 */
 
 void ObjAdd (const char* Name);
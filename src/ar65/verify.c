@@ -0,0 +1,73 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                 verify.c                                  */
+/*                                                                           */
+/*             Object file verification for the ar65 archiver                */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* (C) 1998-2013, Ullrich von Bassewitz                                      */
+/*                Roemerstrasse 52                                           */
+/*                D-70794 Filderstadt                                        */
+/* EMail:         uz@cc65.org                                                */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#include <stdlib.h>
+
+/* ar65 */
+#include "error.h"
+#include "library.h"
+#include "verify.h"
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+void VerifyObjFiles (int argc, char* argv [])
+/* Verify the member checksums of a library */
+{
+    /* Check the argument count */
+    if (argc <= 0) {
+        Error ("No library name given");
+    }
+    if (argc > 1) {
+        Error ("Too many arguments");
+    }
+
+    /* Open the library, read the index */
+    LibOpen (argv [0], 1, 0);
+
+    /* Check all members against the stored checksums */
+    LibVerify ();
+
+    /* Close the library */
+    LibClose ();
+
+    /* Successful end */
+    exit (EXIT_SUCCESS);
+}
@@ -1,15 +1,15 @@
 /*****************************************************************************/
 /*                                                                           */
-/*                                  ident.c                                  */
+/*                                 verify.h                                  */
 /*                                                                           */
-/*                 Identifier handling for the cc65 compiler                 */
+/*             Object file verification for the ar65 archiver                */
 /*                                                                           */
 /*                                                                           */
 /*                                                                           */
-/* (C) 1998     Ullrich von Bassewitz                                        */
-/*              Wacholderweg 14                                              */
-/*              D-70597 Stuttgart                                            */
-/* EMail:       uz@musoftware.de                                             */
+/* (C) 1998-2013, Ullrich von Bassewitz                                      */
+/*                Roemerstrasse 52                                           */
+/*                D-70794 Filderstadt                                        */
+/* EMail:         uz@cc65.org                                                */
 /*                                                                           */
 /*                                                                           */
 /* This software is provided 'as-is', without any expressed or implied       */
@@ -33,11 +33,8 @@
 
 
 
-/* common */
-#include "chartype.h"
-                     
-/* cc65 */
-#include "ident.h"
+#ifndef VERIFY_H
+#define VERIFY_H
 
 
 
@@ -47,8 +44,11 @@
 
 
 
-int IsIdent (char c)
-/* Return true if the given char may start an identifier */
-{
-    return (IsAlpha (c) || c == '_');
-}
+void VerifyObjFiles (int argc, char* argv []);
+/* Verify the member checksums of a library */
+
+
+
+/* End of verify.h */
+
+#endif
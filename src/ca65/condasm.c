@@ -39,6 +39,7 @@
 #include "instr.h"
 #include "lineinfo.h"
 #include "nexttok.h"
+#include "scanner.h"
 #include "symbol.h"
 #include "symtab.h"
 #include "condasm.h"
@@ -438,7 +439,12 @@ void DoConditionals (void)
                 break;
 
             default:
-                /* Skip tokens */
+                /* Skip tokens. If input comes directly from a file, have the
+                ** scanner skip ahead to the next possible directive at
+                ** character level first, which is a lot cheaper than reading
+                ** the skipped tokens one by one.
+                */
+                SkipRawInput ();
                 NextTok ();
 
         }
@@ -38,6 +38,7 @@
 #include <stdarg.h>
 
 /* common */
+#include "diagfile.h"
 #include "strbuf.h"
 
 /* ca65 */
@@ -92,6 +93,10 @@ static void VPrintMsg (const FilePos* Pos, const char* Desc,
     /* Append the message to the message header */
     SB_Append (&S, &Msg);
 
+    /* Pass the unformatted message to the diagnostic file */
+    DiagnosticRecord (Desc, SB_GetConstBuf (GetFileName (Pos->Name)),
+                      Pos->Line, SB_GetConstBuf (&Msg));
+
     /* Delete the formatted message */
     SB_Done (&Msg);
 
@@ -375,6 +380,8 @@ void Fatal (const char* Format, ...)
 
     fprintf (stderr, "Fatal error: %s\n", SB_GetConstBuf (&S));
 
+    DiagnosticRecord ("Fatal", "", 0, SB_GetConstBuf (&S));
+
     SB_Done (&S);
 
     /* And die... */
@@ -396,6 +403,8 @@ void Internal (const char* Format, ...)
 
     fprintf (stderr, "Internal assembler error: %s\n", SB_GetConstBuf (&S));
 
+    DiagnosticRecord ("Internal", "", 0, SB_GetConstBuf (&S));
+
     SB_Done (&S);
 
     exit (EXIT_FAILURE);
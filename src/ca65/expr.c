@@ -1732,11 +1732,18 @@ static ExprNode* GenBankExpr (unsigned SecNum)
 ExprNode* GenAddExpr (ExprNode* Left, ExprNode* Right)
 /* Generate an addition from the two operands */
 {
-    long Val;
-    if (IsEasyConst (Left, &Val) && Val == 0) {
+    long LVal, RVal;
+    if (IsEasyConst (Left, &LVal) && IsEasyConst (Right, &RVal)) {
+        /* Both operands are constant, so evaluate instead of building a
+        ** tree that the study passes would collapse later anyway.
+        */
+        FreeExpr (Left);
+        FreeExpr (Right);
+        return GenLiteralExpr (LVal + RVal);
+    } else if (IsEasyConst (Left, &LVal) && LVal == 0) {
         FreeExpr (Left);
         return Right;
-    } else if (IsEasyConst (Right, &Val) && Val == 0) {
+    } else if (IsEasyConst (Right, &RVal) && RVal == 0) {
         FreeExpr (Right);
         return Left;
     } else {
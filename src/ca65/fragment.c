@@ -41,6 +41,22 @@
 
 
 
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* Fragments are allocated in large numbers - most are just a few bytes of
+** literal data - and are never freed, so they are carved out of larger
+** blocks to save the allocator overhead of many small allocations.
+*/
+#define FRAG_BLOCK_SIZE 1024U
+static Fragment* FragBlock = 0;                     /* Current block */
+static unsigned  FragBlockUsed = FRAG_BLOCK_SIZE;   /* Used entries in block */
+
+
+
 /*****************************************************************************/
 /*                                   Code                                    */
 /*****************************************************************************/
@@ -52,8 +68,16 @@ Fragment* NewFragment (unsigned char Type, unsigned short Len)
 ** into the current segment.
 */
 {
-    /* Create a new fragment */
-    Fragment* F = xmalloc (sizeof (*F));
+    Fragment* F;
+
+    /* Start a new block if the current one is full, then allocate the new
+    ** fragment from the block.
+    */
+    if (FragBlockUsed >= FRAG_BLOCK_SIZE) {
+        FragBlock = xmalloc (FRAG_BLOCK_SIZE * sizeof (Fragment));
+        FragBlockUsed = 0;
+    }
+    F = FragBlock + FragBlockUsed++;
 
     /* Initialize it */
     F->Next     = 0;
@@ -66,3 +90,13 @@ Fragment* NewFragment (unsigned char Type, unsigned short Len)
     /* And return it */
     return F;
 }
+
+
+
+unsigned char* GetFragLiteral (Fragment* F)
+/* Return a pointer to the data of a literal fragment. Data that fits into
+** the fragment itself is stored inline, larger chunks are on the heap.
+*/
+{
+    return (F->Len > sizeof (F->V.Data))? F->V.Buf : F->V.Data;
+}
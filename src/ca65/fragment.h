@@ -62,6 +62,7 @@ struct Fragment {
     unsigned char       Type;       /* Fragment type */
     union {
         unsigned char   Data[sizeof (ExprNode*)];       /* Literal values */
+        unsigned char*  Buf;                            /* Larger literal data */
         ExprNode*       Expr;                           /* Expression */
     } V;
 };
@@ -79,6 +80,11 @@ Fragment* NewFragment (unsigned char Type, unsigned short Len);
 ** into the current segment.
 */
 
+unsigned char* GetFragLiteral (Fragment* F);
+/* Return a pointer to the data of a literal fragment. Data that fits into
+** the fragment itself is stored inline, larger chunks are on the heap.
+*/
+
 
 
 /* End of fragment.h */
@@ -41,6 +41,7 @@
 #include "addrsize.h"
 #include "attrib.h"
 #include "bitops.h"
+#include "chartype.h"
 #include "check.h"
 #include "mmodel.h"
 
@@ -940,6 +941,20 @@ static const InsTable* InsTabs[CPU_COUNT] = {
 };
 const InsTable* InsTab = (const InsTable*) &InsTab6502;
 
+/* Hash index over the mnemonics of the current instruction table. Since a
+** mnemonic has at most four characters, the uppercased name is packed into
+** one unsigned long, so a lookup is a hash probe plus a word compare instead
+** of a bsearch with string comparisons. The index is rebuilt lazily whenever
+** the instruction table changes. HashedTab remembers the table the index was
+** built for, a zero in InsHashIdx marks a free slot, used slots contain the
+** index into InsTab->Ins plus one.
+*/
+#define INS_HASHTAB_SIZE        512U
+#define INS_HASHTAB_MASK        (INS_HASHTAB_SIZE - 1)
+static const InsTable* HashedTab = 0;
+static unsigned long  InsHashKey[INS_HASHTAB_SIZE];
+static unsigned short InsHashIdx[INS_HASHTAB_SIZE];
+
 /* Table to build the effective 65xx opcode from a base opcode and an
 ** addressing mode. (The value in the table is ORed with the base opcode)
 */
@@ -1100,11 +1115,22 @@ static int EvalEA (const InsDesc* Ins, EffAddr* A)
         ExprDesc ED;
         ED_Init (&ED);
 
-        /* Study the expression */
-        StudyExpr (A->Expr, &ED);
+        /* The dominant operands are a plain constant or a plain import, for
+        ** which the address size is immediately known. Handle these without
+        ** a full study of the expression - there is nothing to simplify for
+        ** them, either.
+        */
+        if (A->Expr->Op == EXPR_LITERAL) {
+            ED.AddrSize = GetConstAddrSize (A->Expr->V.IVal);
+        } else if (A->Expr->Op == EXPR_SYMBOL && SymIsImport (A->Expr->V.Sym)) {
+            ED.AddrSize = GetSymAddrSize (A->Expr->V.Sym);
+        } else {
+            /* Study the expression */
+            StudyExpr (A->Expr, &ED);
 
-        /* Simplify it if possible */
-        A->Expr = SimplifyExpr (A->Expr, &ED);
+            /* Simplify it if possible */
+            A->Expr = SimplifyExpr (A->Expr, &ED);
+        }
 
         if (ED.AddrSize == ADDR_SIZE_DEFAULT) {
             /* We don't know how big the expression is. If the instruction
@@ -1683,10 +1709,41 @@ static void PutSweet16Branch (const InsDesc* Ins)
 
 
 
-static int CmpName (const void* Key, const void* Instr)
-/* Compare function for bsearch */
+static unsigned InsHash (unsigned long Key)
+/* Get the hash table slot for a packed mnemonic */
 {
-    return strcmp ((const char*)Key, ((const InsDesc*) Instr)->Mnemonic);
+    return (unsigned) ((Key * 0x9E3779B1UL) >> 16) & INS_HASHTAB_MASK;
+}
+
+
+
+static void BuildInsHash (void)
+/* Build the hash index for the current instruction table */
+{
+    unsigned I;
+
+    /* Clear the old index */
+    memset (InsHashIdx, 0, sizeof (InsHashIdx));
+
+    /* Insert all mnemonics, resolving collisions by linear probing */
+    for (I = 0; I < InsTab->Count; ++I) {
+        const char* M = InsTab->Ins[I].Mnemonic;
+        unsigned long Key = 0;
+        unsigned Slot;
+        unsigned J;
+        for (J = 0; M[J] != '\0'; ++J) {
+            Key = (Key << 8) | (unsigned char) M[J];
+        }
+        Slot = InsHash (Key);
+        while (InsHashIdx[Slot] != 0) {
+            Slot = (Slot + 1) & INS_HASHTAB_MASK;
+        }
+        InsHashKey[Slot] = Key;
+        InsHashIdx[Slot] = (unsigned short) (I + 1);
+    }
+
+    /* Remember the table the index was built for */
+    HashedTab = InsTab;
 }
 
 
@@ -1722,8 +1779,9 @@ int FindInstruction (const StrBuf* Ident)
 */
 {
     unsigned I;
-    const InsDesc* ID;
-    char Key[sizeof (ID->Mnemonic)];
+    unsigned Len;
+    unsigned long Key;
+    unsigned Slot;
 
     /* Shortcut for the "none" CPU: If there are no instructions to search
     ** for, bail out early.
@@ -1733,30 +1791,38 @@ int FindInstruction (const StrBuf* Ident)
         return -1;
     }
 
-    /* Make a copy, and uppercase that copy */
-    I = 0;
-    while (I < SB_GetLen (Ident)) {
-        /* If the identifier is longer than the longest mnemonic, it cannot
-        ** be one.
-        */
-        if (I >= sizeof (Key) - 1) {
-            /* Not found, no need for further action */
-            return -1;
-        }
-        Key[I] = toupper ((unsigned char)SB_AtUnchecked (Ident, I));
-        ++I;
+    /* If the identifier is longer than the longest mnemonic, it cannot
+    ** be one.
+    */
+    Len = SB_GetLen (Ident);
+    if (Len >= sizeof (InsTab->Ins[0].Mnemonic)) {
+        /* Not found, no need for further action */
+        return -1;
     }
-    Key[I] = '\0';
 
-    /* Search for the key */
-    ID = bsearch (Key, InsTab->Ins, InsTab->Count, sizeof (InsDesc), CmpName);
-    if (ID == 0) {
-        /* Not found */
-        return -1;
-    } else {
-        /* Found, return the entry */
-        return ID - InsTab->Ins;
+    /* Pack the uppercased identifier into one word */
+    Key = 0;
+    for (I = 0; I < Len; ++I) {
+        Key = (Key << 8) | (unsigned char) CharToUpper (SB_AtUnchecked (Ident, I));
+    }
+
+    /* Rebuild the hash index if the instruction table has changed */
+    if (HashedTab != InsTab) {
+        BuildInsHash ();
     }
+
+    /* Probe the hash index for the key */
+    Slot = InsHash (Key);
+    while (InsHashIdx[Slot] != 0) {
+        if (InsHashKey[Slot] == Key) {
+            /* Found, return the entry */
+            return (int) (InsHashIdx[Slot] - 1);
+        }
+        Slot = (Slot + 1) & INS_HASHTAB_MASK;
+    }
+
+    /* Not found */
+    return -1;
 }
 
 
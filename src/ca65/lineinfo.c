@@ -69,6 +69,15 @@ static int HT_Compare (const void* Key1, const void* Key2);
 ** than zero if Key1 is greater then Key2.
 */
 
+static unsigned LT_GenHash (const void* Key);
+/* Generate the hash over a line info list key. */
+
+static const void* LT_GetKey (const void* Entry);
+/* Given a pointer to the user entry data, return a pointer to the key */
+
+static int LT_Compare (const void* Key1, const void* Key2);
+/* Compare two line info list keys. */
+
 
 
 /*****************************************************************************/
@@ -96,9 +105,35 @@ struct LineInfo {
 
 
 
+/* Structure that holds the key for a line info list: A list of line info
+** ids as it is written to the object file.
+*/
+typedef struct LineInfoIdListKey LineInfoIdListKey;
+struct LineInfoIdListKey {
+    unsigned        Count;              /* Number of ids in the list */
+    const unsigned* Ids;                /* The ids themselves */
+};
+
+/* Structure that holds an interned line info list. Since the same lists of
+** line infos are attached to lots of fragments and symbols, especially for
+** macro generated code, the lists are written to the object file just once
+** and referenced by index (see OBJ_FLAGS_LILISTS in objdefs.h).
+*/
+typedef struct LineInfoIdList LineInfoIdList;
+struct LineInfoIdList {
+    HashNode          Node;             /* Hash table node */
+    unsigned          Id;               /* Index of the list */
+    LineInfoIdListKey Key;              /* Key for this list */
+};
+
+
+
 /* Collection containing all line infos */
 static Collection LineInfoList = STATIC_COLLECTION_INITIALIZER;
 
+/* Collection containing all interned line info lists in id order */
+static Collection LineInfoIdLists = STATIC_COLLECTION_INITIALIZER;
+
 /* Collection with currently active line infos */
 static Collection CurLineInfo = STATIC_COLLECTION_INITIALIZER;
 
@@ -112,6 +147,16 @@ static const HashFunctions HashFunc = {
 /* Line info hash table */
 static HashTable LineInfoTab = STATIC_HASHTABLE_INITIALIZER (1051, &HashFunc);
 
+/* Hash table functions for line info lists */
+static const HashFunctions ListHashFunc = {
+    LT_GenHash,
+    LT_GetKey,
+    LT_Compare
+};
+
+/* Line info list hash table */
+static HashTable LineInfoIdListTab = STATIC_HASHTABLE_INITIALIZER (1051, &ListHashFunc);
+
 /* The current assembler input line */
 static LineInfo* AsmLineInfo = 0;
 
@@ -168,6 +213,50 @@ static int HT_Compare (const void* Key1, const void* Key2)
 
 
 
+static unsigned LT_GenHash (const void* Key)
+/* Generate the hash over a line info list key. */
+{
+    /* Key is a LineInfoIdListKey pointer */
+    const LineInfoIdListKey* K = Key;
+
+    /* Hash over the complete list of ids */
+    unsigned I;
+    unsigned Hash = K->Count;
+    for (I = 0; I < K->Count; ++I) {
+        Hash = HashInt (Hash ^ K->Ids[I]);
+    }
+    return Hash;
+}
+
+
+
+static const void* LT_GetKey (const void* Entry)
+/* Given a pointer to the user entry data, return a pointer to the key */
+{
+    return &((const LineInfoIdList*)Entry)->Key;
+}
+
+
+
+static int LT_Compare (const void* Key1, const void* Key2)
+/* Compare two line info list keys. */
+{
+    /* Convert both parameters to LineInfoIdListKey pointers */
+    const LineInfoIdListKey* K1 = Key1;
+    const LineInfoIdListKey* K2 = Key2;
+
+    /* Compare the length, then the ids */
+    int Res = (int)K2->Count - (int)K1->Count;
+    if (Res == 0 && K1->Count > 0) {
+        Res = memcmp (K1->Ids, K2->Ids, K1->Count * sizeof (K1->Ids[0]));
+    }
+
+    /* Done */
+    return Res;
+}
+
+
+
 /*****************************************************************************/
 /*                              struct LineInfo                              */
 /*****************************************************************************/
@@ -456,15 +545,27 @@ unsigned GetLineInfoType (const LineInfo* LI)
 
 
 void WriteLineInfo (const Collection* LineInfos)
-/* Write a list of line infos to the object file. */
+/* Write a list of line infos to the object file. The list itself is interned
+** and only its index is written, since especially macro generated code repeats
+** the same lists over and over. The table with the lists is written together
+** with the line infos (see WriteLineInfos).
+*/
 {
-    unsigned I;
-
-    /* Write the count */
-    ObjWriteVar (CollCount (LineInfos));
+    static unsigned* Ids = 0;           /* Buffer for the list of ids */
+    static unsigned  IdsSize = 0;       /* Size of the buffer */
 
-    /* Write the line info indices */
-    for (I = 0; I < CollCount (LineInfos); ++I) {
+    unsigned I;
+    LineInfoIdListKey Key;
+    LineInfoIdList* L;
+
+    /* Collect the ids of the line infos in the list */
+    unsigned Count = CollCount (LineInfos);
+    if (Count > IdsSize) {
+        xfree (Ids);
+        IdsSize = Count;
+        Ids = xmalloc (IdsSize * sizeof (Ids[0]));
+    }
+    for (I = 0; I < Count; ++I) {
 
         /* Get a pointer to the line info */
         const LineInfo* LI = CollConstAt (LineInfos, I);
@@ -472,9 +573,38 @@ void WriteLineInfo (const Collection* LineInfos)
         /* Safety */
         CHECK (LI->Id != ~0U);
 
-        /* Write the index to the file */
-        ObjWriteVar (LI->Id);
+        /* Remember the index */
+        Ids[I] = LI->Id;
+    }
+
+    /* Search for an existing list with these ids and create a new one if
+    ** this list wasn't written before.
+    */
+    Key.Count = Count;
+    Key.Ids   = Ids;
+    L = HT_Find (&LineInfoIdListTab, &Key);
+    if (L == 0) {
+
+        /* Allocate a new list and copy the key data */
+        L = xmalloc (sizeof (LineInfoIdList));
+        InitHashNode (&L->Node);
+        L->Id        = CollCount (&LineInfoIdLists);
+        L->Key.Count = Count;
+        if (Count > 0) {
+            unsigned* P = xmalloc (Count * sizeof (P[0]));
+            memcpy (P, Ids, Count * sizeof (P[0]));
+            L->Key.Ids = P;
+        } else {
+            L->Key.Ids = 0;
+        }
+
+        /* Insert it into the hash table and the id ordered list */
+        HT_Insert (&LineInfoIdListTab, L);
+        CollAppend (&LineInfoIdLists, L);
     }
+
+    /* Write the index of the list to the file */
+    ObjWriteVar (L->Id);
 }
 
 
@@ -506,6 +636,23 @@ void WriteLineInfos (void)
         WriteSpanList (&LI->Spans);
     }
 
+    /* Write the table with the interned line info lists. This must happen
+    ** after all other sections that reference such lists have been written.
+    */
+    ObjWriteVar (CollCount (&LineInfoIdLists));
+    for (I = 0; I < CollCount (&LineInfoIdLists); ++I) {
+
+        /* Get a pointer to this list */
+        const LineInfoIdList* L = CollConstAt (&LineInfoIdLists, I);
+        unsigned J;
+
+        /* Write the ids of the list */
+        ObjWriteVar (L->Key.Count);
+        for (J = 0; J < L->Key.Count; ++J) {
+            ObjWriteVar (L->Key.Ids[J]);
+        }
+    }
+
     /* End of line infos */
     ObjEndLineInfos ();
 }
@@ -42,6 +42,7 @@
 #include "fname.h"
 #include "fragdefs.h"
 #include "strbuf.h"
+#include "strpool.h"
 #include "version.h"
 #include "xmalloc.h"
 
@@ -51,6 +52,9 @@
 #include "global.h"
 #include "listing.h"
 #include "segment.h"
+#include "studyexpr.h"
+#include "symentry.h"
+#include "ulabel.h"
 
 
 
@@ -60,11 +64,18 @@
 
 
 
-/* Single linked list of lines */
-ListLine*       LineList = 0;           /* List of listing lines */
+/* Single linked list of lines. Lines are written to the listing file and
+** freed as soon as they can no longer change, so the list only holds the
+** window between the oldest unwritten line and the current one.
+*/
+ListLine*       LineList = 0;           /* Oldest line still in memory */
 ListLine*       LineCur  = 0;           /* Current listing line */
 ListLine*       LineLast = 0;           /* Last (current) listing line */
 
+/* Output file for the listing */
+static FILE*    ListingStream = 0;      /* Open listing file */
+static char     HeaderBuf [LINE_HEADER_LEN+1];  /* Line header buffer */
+
 /* Page and other formatting */
 int             PageLength = -1;        /* Length of a listing page */
 static unsigned PageNumber = 1;         /* Current listing page number */
@@ -74,6 +85,32 @@ static unsigned ListBytes  = 12;        /* Number of bytes to list for one line
 /* Switch the listing on/off */
 static int      ListingEnabled = 1;     /* Enabled if > 0 */
 
+/* Listing format */
+int             ListingFormat = LIST_FORMAT_TEXT;
+
+/* Buffers for the binary listing. Lines are serialized into memory as they
+** become final and the whole file is written with a few bulk writes at the
+** end. The string pool is private to the listing, so the source lines don't
+** end up in the string pool of the object file.
+*/
+static StringPool* LstStrPool = 0;      /* Source lines and file names */
+static StrBuf   LstRecords = STATIC_STRBUF_INITIALIZER; /* Line records */
+static StrBuf   LstData = STATIC_STRBUF_INITIALIZER;    /* Code/data bytes */
+static unsigned long LstLineCount = 0;  /* Number of line records */
+
+
+
+/*****************************************************************************/
+/*                                 Forwards                                  */
+/*****************************************************************************/
+
+
+
+static void FlushListing (const ListLine* Last, int Force);
+/* Write and free listing lines up to but not including Last. Unless Force
+** is given, stop at the first line that is not final yet.
+*/
+
 
 
 /*****************************************************************************/
@@ -105,6 +142,7 @@ void NewListingLine (const StrBuf* Line, unsigned char File, unsigned char Depth
         L->Next         = 0;
         L->FragList     = 0;
         L->FragLast     = 0;
+        L->Wait         = 0;
         L->PC           = GetPC ();
         L->Reloc        = GetRelocMode ();
         L->File         = File;
@@ -195,6 +233,13 @@ void InitListingLine (void)
         LineCur->Reloc      = GetRelocMode ();
         LineCur->Output     = (ListingEnabled > 0);
         LineCur->ListBytes  = (unsigned char) ListBytes;
+
+        /* Lines before the current one no longer get fragments added and
+        ** their flags won't change. Write those whose data is final to the
+        ** listing file and release the memory, so memory usage is bounded
+        ** by the window of unresolved references instead of the full source.
+        */
+        FlushListing (LineCur, 0);
     }
 }
 
@@ -293,162 +338,507 @@ static char* MakeLineHeader (char* H, const ListLine* L)
 
 
 
-void CreateListing (void)
-/* Create the listing */
+static int LineIsFinal (ListLine* L)
+/* Check if the data listed for the given line can no longer change. Literal
+** and fill fragments are always final. An expression fragment is final if
+** the expression is constant, or if it can no longer become constant because
+** all symbols it references are defined or imported. An expression that
+** references an undefined symbol may still resolve to a constant once the
+** symbol is defined, so the line must be kept until then.
+*/
 {
-    FILE* F;
     Fragment* Frag;
-    ListLine* L;
-    char HeaderBuf [LINE_HEADER_LEN+1];
 
-    /* Open the real listing file */
-    F = fopen (SB_GetConstBuf (&ListingName), "w");
-    if (F == 0) {
-        Fatal ("Cannot open listing file '%s': %s",
-               SB_GetConstBuf (&ListingName),
-               strerror (errno));
+    /* If the line already waits for a symbol, do the cheap check first to
+    ** avoid studying the expressions again and again while the line cannot
+    ** be written anyway.
+    */
+    if (L->Wait != 0) {
+        if (!SymIsDef (L->Wait)) {
+            return 0;
+        }
+        L->Wait = 0;
     }
 
-    /* Reset variables, print the header for the first page */
-    PageNumber = 0;
-    PrintPageHeader (F, LineList);
-
-    /* Terminate the header buffer. The last byte will never get overwritten */
-    HeaderBuf [LINE_HEADER_LEN] = '\0';
+    /* Check all expression fragments of the line */
+    for (Frag = L->FragList; Frag != 0; Frag = Frag->LineList) {
+        if (Frag->Type == FRAG_EXPR || Frag->Type == FRAG_SEXPR) {
+
+            ExprDesc ED;
+            unsigned I;
+            int IsConst;
+
+            /* Study the expression */
+            ED_Init (&ED);
+            StudyExpr (Frag->V.Expr, &ED);
+            IsConst = ED_IsConst (&ED);
+
+            if (!IsConst) {
+                /* Not constant. If the expression references an undefined
+                ** symbol, remember the symbol and wait for its definition.
+                */
+                for (I = 0; I < ED.SymCount; ++I) {
+                    struct SymEntry* Sym = ED.SymRef[I].Ref;
+                    if (!SymIsDef (Sym) && !SymIsImport (Sym)) {
+                        L->Wait = Sym;
+                        break;
+                    }
+                }
+            }
 
-    /* Walk through all listing lines */
-    L = LineList;
-    while (L) {
+            /* Release memory allocated for the expression descriptor */
+            ED_Done (&ED);
 
-        char* Buf;
-        char* B;
-        unsigned Count;
-        unsigned I;
-        char* Line;
+            /* If we found an undefined symbol, the line is not final */
+            if (L->Wait != 0) {
+                return 0;
+            }
 
-        /* If we should not output this line, go to the next */
-        if (L->Output == 0) {
-            L = L->Next;
-            continue;
+            /* Unnamed labels are not tracked by the symbol references, and
+            ** expressions that contain one cannot be studied while any
+            ** unnamed label is still undefined. So retry later in this case.
+            */
+            if (!IsConst && !ULabCanResolve ()) {
+                return 0;
+            }
         }
+    }
 
-        /* If we don't have a fragment list for this line, things are easy */
-        if (L->FragList == 0) {
-            PrintLine (F, MakeLineHeader (HeaderBuf, L), L->Line, L);
-            L = L->Next;
-            continue;
-        }
+    /* Nothing in this line will change any more */
+    return 1;
+}
 
-        /* Count the number of bytes in the complete fragment list */
-        Count = 0;
-        Frag = L->FragList;
-        while (Frag) {
-            Count += Frag->Len;
-            Frag = Frag->LineList;
-        }
 
-        /* Allocate memory for the given number of bytes */
-        Buf = xmalloc (Count*2+1);
 
-        /* Copy an ASCII representation of the bytes into the buffer */
-        B = Buf;
-        Frag = L->FragList;
-        while (Frag) {
+static void OutputListingLine (FILE* F, ListLine* L)
+/* Write one listing line to the listing file */
+{
+    Fragment* Frag;
+    char* Buf;
+    char* B;
+    unsigned Count;
+    unsigned I;
+    char* Line;
+
+    /* If we should not output this line, bail out */
+    if (L->Output == 0) {
+        return;
+    }
+
+    /* If we don't have a fragment list for this line, things are easy */
+    if (L->FragList == 0) {
+        PrintLine (F, MakeLineHeader (HeaderBuf, L), L->Line, L);
+        return;
+    }
 
-            /* Write data depending on the type */
-            switch (Frag->Type) {
+    /* Count the number of bytes in the complete fragment list */
+    Count = 0;
+    Frag = L->FragList;
+    while (Frag) {
+        Count += Frag->Len;
+        Frag = Frag->LineList;
+    }
 
-                case FRAG_LITERAL:
-                    for (I = 0; I < Frag->Len; ++I) {
-                        B = AddHex (B, Frag->V.Data[I]);
+    /* Allocate memory for the given number of bytes */
+    Buf = xmalloc (Count*2+1);
+
+    /* Copy an ASCII representation of the bytes into the buffer */
+    B = Buf;
+    Frag = L->FragList;
+    while (Frag) {
+
+        /* Write data depending on the type */
+        switch (Frag->Type) {
+
+            case FRAG_LITERAL:
+                for (I = 0; I < Frag->Len; ++I) {
+                    B = AddHex (B, GetFragLiteral (Frag)[I]);
+                }
+                break;
+
+            case FRAG_EXPR:
+            case FRAG_SEXPR:
+                {
+                    /* If the expression is constant, list its value like it
+                    ** will be placed into the object file, otherwise mark
+                    ** the bytes as relocatable. This matches what SegDone
+                    ** does to such fragments after assembly.
+                    */
+                    ExprDesc ED;
+                    ED_Init (&ED);
+                    StudyExpr (Frag->V.Expr, &ED);
+                    if (ED_IsConst (&ED)) {
+                        long Val = ED.Val;
+                        for (I = 0; I < Frag->Len; ++I) {
+                            B = AddHex (B, Val & 0xFF);
+                            Val >>= 8;
+                        }
+                    } else {
+                        B = AddMult (B, 'r', Frag->Len*2);
                     }
-                    break;
+                    ED_Done (&ED);
+                }
+                break;
 
-                case FRAG_EXPR:
-                case FRAG_SEXPR:
-                    B = AddMult (B, 'r', Frag->Len*2);
-                    break;
+            case FRAG_FILL:
+                B = AddMult (B, 'x', Frag->Len*2);
+                break;
 
-                case FRAG_FILL:
-                    B = AddMult (B, 'x', Frag->Len*2);
-                    break;
+            default:
+                Internal ("Invalid fragment type: %u", Frag->Type);
 
-                default:
-                    Internal ("Invalid fragment type: %u", Frag->Type);
+        }
 
-            }
+        /* Next fragment */
+        Frag = Frag->LineList;
 
-            /* Next fragment */
-            Frag = Frag->LineList;
+    }
 
+    /* Limit the number of bytes actually printed */
+    if (L->ListBytes != 0) {
+        /* Not unlimited */
+        if (Count > L->ListBytes) {
+            Count = L->ListBytes;
         }
+    }
 
-        /* Limit the number of bytes actually printed */
-        if (L->ListBytes != 0) {
-            /* Not unlimited */
-            if (Count > L->ListBytes) {
-                Count = L->ListBytes;
-            }
+    /* Output the data. The format of a listing line is:
+    **
+    **      PPPPPPm I  11 22 33 44
+    **
+    ** where
+    **
+    **      PPPPPP  is the PC
+    **      m       is the mode ('r' or empty)
+    **      I       is the include level
+    **      11 ..   are code or data bytes
+    */
+    Line = L->Line;
+    B    = Buf;
+    while (Count) {
+
+        unsigned    Chunk;
+        char*       P;
+
+        /* Prepare the line header */
+        MakeLineHeader (HeaderBuf, L);
+
+        /* Get the number of bytes for the next line */
+        Chunk = Count;
+        if (Chunk > 4) {
+            Chunk = 4;
         }
+        Count -= Chunk;
 
-        /* Output the data. The format of a listing line is:
-        **
-        **      PPPPPPm I  11 22 33 44
-        **
-        ** where
-        **
-        **      PPPPPP  is the PC
-        **      m       is the mode ('r' or empty)
-        **      I       is the include level
-        **      11 ..   are code or data bytes
+        /* Increment the program counter. Since we don't need the PC stored
+        ** in the LineList object for anything else, just increment this
+        ** variable.
         */
-        Line = L->Line;
-        B    = Buf;
-        while (Count) {
+        L->PC += Chunk;
+
+        /* Copy the bytes into the line */
+        P = HeaderBuf + 11;
+        for (I = 0; I < Chunk; ++I) {
+            *P++ = *B++;
+            *P++ = *B++;
+            *P++ = ' ';
+        }
 
-            unsigned    Chunk;
-            char*       P;
+        /* Output this line */
+        PrintLine (F, HeaderBuf, Line, L);
 
-            /* Prepare the line header */
-            MakeLineHeader (HeaderBuf, L);
+        /* Don't output a line twice */
+        Line = "";
 
-            /* Get the number of bytes for the next line */
-            Chunk = Count;
-            if (Chunk > 4) {
-                Chunk = 4;
-            }
-            Count -= Chunk;
+    }
 
-            /* Increment the program counter. Since we don't need the PC stored
-            ** in the LineList object for anything else, just increment this
-            ** variable.
-            */
-            L->PC += Chunk;
-
-            /* Copy the bytes into the line */
-            P = HeaderBuf + 11;
-            for (I = 0; I < Chunk; ++I) {
-                *P++ = *B++;
-                *P++ = *B++;
-                *P++ = ' ';
-            }
+    /* Delete the temporary buffer */
+    xfree (Buf);
+}
 
-            /* Output this line */
-            PrintLine (F, HeaderBuf, Line, L);
 
-            /* Don't output a line twice */
-            Line = "";
+
+static void BufWrite8 (StrBuf* B, unsigned long Val)
+/* Append an 8 bit value to a binary buffer */
+{
+    SB_AppendChar (B, (int) (Val & 0xFF));
+}
+
+
+
+static void BufWrite16 (StrBuf* B, unsigned long Val)
+/* Append a 16 bit value in little endian order to a binary buffer */
+{
+    BufWrite8 (B, Val);
+    BufWrite8 (B, Val >> 8);
+}
+
+
+
+static void BufWrite32 (StrBuf* B, unsigned long Val)
+/* Append a 32 bit value in little endian order to a binary buffer */
+{
+    BufWrite16 (B, Val);
+    BufWrite16 (B, Val >> 16);
+}
+
+
+
+static void CollectBinaryLine (ListLine* L)
+/* Serialize one listing line into the binary listing buffers */
+{
+    Fragment* Frag;
+    unsigned long DataOffs;
+    unsigned long Count;
+    unsigned Flags;
+    unsigned I;
+
+    /* If we should not output this line, bail out */
+    if (L->Output == 0) {
+        return;
+    }
+
+    /* Create the string pool when the first line is ready */
+    if (LstStrPool == 0) {
+        LstStrPool = NewStringPool (1103);
+        /* Insert an empty string, so it will have string id zero */
+        SP_AddStr (LstStrPool, "");
+    }
+
+    /* The bytes of this line start where the last line ended */
+    DataOffs = SB_GetLen (&LstData);
+    Flags = L->Reloc? LST_FLAG_RELOC : 0;
+
+    /* Append the raw bytes of all fragments to the data blob. Other than
+    ** the text listing, the binary listing is not limited by .listbytes,
+    ** since the tools reading it want the real per-line sizes.
+    */
+    Count = 0;
+    for (Frag = L->FragList; Frag != 0; Frag = Frag->LineList) {
+
+        switch (Frag->Type) {
+
+            case FRAG_LITERAL:
+                SB_AppendBuf (&LstData, (const char*) GetFragLiteral (Frag),
+                              Frag->Len);
+                break;
+
+            case FRAG_EXPR:
+            case FRAG_SEXPR:
+                {
+                    /* If the expression is constant, store its value like it
+                    ** will be placed into the object file, otherwise store
+                    ** zeroes and mark the record.
+                    */
+                    ExprDesc ED;
+                    ED_Init (&ED);
+                    StudyExpr (Frag->V.Expr, &ED);
+                    if (ED_IsConst (&ED)) {
+                        long Val = ED.Val;
+                        for (I = 0; I < Frag->Len; ++I) {
+                            BufWrite8 (&LstData, Val);
+                            Val >>= 8;
+                        }
+                    } else {
+                        Flags |= LST_FLAG_UNRESOLVED;
+                        for (I = 0; I < Frag->Len; ++I) {
+                            BufWrite8 (&LstData, 0);
+                        }
+                    }
+                    ED_Done (&ED);
+                }
+                break;
+
+            case FRAG_FILL:
+                for (I = 0; I < Frag->Len; ++I) {
+                    BufWrite8 (&LstData, 0);
+                }
+                break;
+
+            default:
+                Internal ("Invalid fragment type: %u", Frag->Type);
 
         }
 
-        /* Delete the temporary buffer */
-        xfree (Buf);
+        Count += Frag->Len;
 
-        /* Next line */
-        L = L->Next;
+    }
 
+    /* Append the fixed size line record */
+    BufWrite32 (&LstRecords, SP_AddStr (LstStrPool, L->Line));
+    BufWrite32 (&LstRecords, SP_Add (LstStrPool, GetFileName (L->File)));
+    BufWrite32 (&LstRecords, L->PC);
+    BufWrite32 (&LstRecords, DataOffs);
+    BufWrite32 (&LstRecords, Count);
+    BufWrite8  (&LstRecords, Flags);
+    BufWrite8  (&LstRecords, L->Depth);
+    BufWrite16 (&LstRecords, 0);
+    ++LstLineCount;
+}
+
+
+
+static void WriteBuf (FILE* F, const StrBuf* B)
+/* Write the contents of a binary buffer to the listing file */
+{
+    if (SB_GetLen (B) > 0 &&
+        fwrite (SB_GetConstBuf (B), 1, SB_GetLen (B), F) != SB_GetLen (B)) {
+        Fatal ("Cannot write to listing file '%s': %s",
+               SB_GetConstBuf (&ListingName),
+               strerror (errno));
+    }
+}
+
+
+
+static void WriteBinaryListing (void)
+/* Write the buffered binary listing to the listing file */
+{
+    StrBuf Header = AUTO_STRBUF_INITIALIZER;
+    StrBuf Strings = AUTO_STRBUF_INITIALIZER;
+    unsigned Count;
+    unsigned I;
+    FILE* F;
+
+    /* Serialize the string pool */
+    Count = (LstStrPool != 0)? SP_GetCount (LstStrPool) : 0;
+    for (I = 0; I < Count; ++I) {
+        const StrBuf* S = SP_Get (LstStrPool, I);
+        BufWrite32 (&Strings, SB_GetLen (S));
+        SB_Append (&Strings, S);
+    }
+
+    /* Build the header. The data blob follows the line records, the string
+    ** pool follows the data blob.
+    */
+    BufWrite32 (&Header, LST_MAGIC);
+    BufWrite16 (&Header, LST_VERSION);
+    BufWrite16 (&Header, 0);                    /* Flags */
+    BufWrite32 (&Header, LstLineCount);
+    BufWrite32 (&Header, LST_HEADER_SIZE + SB_GetLen (&LstRecords));
+    BufWrite32 (&Header, SB_GetLen (&LstData));
+    BufWrite32 (&Header, LST_HEADER_SIZE + SB_GetLen (&LstRecords) +
+                         SB_GetLen (&LstData));
+    BufWrite32 (&Header, Count);
+    BufWrite32 (&Header, SB_GetLen (&Strings));
+    CHECK (SB_GetLen (&Header) == LST_HEADER_SIZE);
+    CHECK (SB_GetLen (&LstRecords) == LstLineCount * LST_RECORD_SIZE);
+
+    /* Open the listing file */
+    F = fopen (SB_GetConstBuf (&ListingName), "wb");
+    if (F == 0) {
+        Fatal ("Cannot open listing file '%s': %s",
+               SB_GetConstBuf (&ListingName),
+               strerror (errno));
+    }
+
+    /* Write the sections with a few bulk writes */
+    WriteBuf (F, &Header);
+    WriteBuf (F, &LstRecords);
+    WriteBuf (F, &LstData);
+    WriteBuf (F, &Strings);
+
+    /* Close the file */
+    if (fclose (F) != 0) {
+        Fatal ("Cannot write to listing file '%s': %s",
+               SB_GetConstBuf (&ListingName),
+               strerror (errno));
+    }
+
+    /* Release the buffers */
+    SB_Done (&Header);
+    SB_Done (&Strings);
+    SB_Done (&LstRecords);
+    SB_Done (&LstData);
+}
+
+
+
+static void FlushListing (const ListLine* Last, int Force)
+/* Write and free listing lines up to but not including Last. Unless Force
+** is given, stop at the first line that is not final yet.
+*/
+{
+    /* Lines for the binary listing are serialized into memory and written
+    ** in one go when the assembly is done.
+    */
+    if (ListingFormat == LIST_FORMAT_BINARY) {
+        while (LineList != Last && (Force || LineIsFinal (LineList))) {
+            ListLine* L = LineList;
+            CollectBinaryLine (L);
+            LineList = L->Next;
+            xfree (L);
+        }
+        return;
+    }
+
+    /* Open the listing file when the first line is ready. Opening it late
+    ** means an empty assembly won't leave a listing with just a header.
+    */
+    if (ListingStream == 0 && LineList != Last &&
+        (Force || LineIsFinal (LineList))) {
+
+        /* Open the real listing file */
+        ListingStream = fopen (SB_GetConstBuf (&ListingName), "w");
+        if (ListingStream == 0) {
+            Fatal ("Cannot open listing file '%s': %s",
+                   SB_GetConstBuf (&ListingName),
+                   strerror (errno));
+        }
+
+        /* Reset variables, print the header for the first page */
+        PageNumber = 0;
+        PrintPageHeader (ListingStream, LineList);
+
+        /* Terminate the header buffer. The last byte will never get
+        ** overwritten.
+        */
+        HeaderBuf [LINE_HEADER_LEN] = '\0';
+    }
+
+    /* Write the lines and release the memory */
+    while (LineList != Last && (Force || LineIsFinal (LineList))) {
+        ListLine* L = LineList;
+        OutputListingLine (ListingStream, L);
+        LineList = L->Next;
+        xfree (L);
+    }
+}
+
+
+
+void CreateListing (void)
+/* Finish the listing */
+{
+    /* Write out the lines that are still in memory. SegDone has converted
+    ** all resolvable expressions to literals by now, so everything is final.
+    */
+    FlushListing (0, 1);
+    LineCur = LineLast = 0;
+
+    /* For the binary format, write the buffered lines now */
+    if (ListingFormat == LIST_FORMAT_BINARY) {
+        WriteBinaryListing ();
+        return;
     }
 
     /* Close the listing file */
-    (void) fclose (F);
+    if (ListingStream) {
+        (void) fclose (ListingStream);
+        ListingStream = 0;
+    }
+}
+
+
+
+void AbortListing (void)
+/* Close and remove a partially written listing file. Since lines are written
+** while assembling, a failed assembly may have created one.
+*/
+{
+    if (ListingStream) {
+        (void) fclose (ListingStream);
+        ListingStream = 0;
+        remove (SB_GetConstBuf (&ListingName));
+    }
 }
@@ -50,6 +50,7 @@
 
 
 struct StrBuf;
+struct SymEntry;
 
 
 
@@ -68,6 +69,7 @@ struct ListLine {
     ListLine*           Next;           /* Pointer to next line */
     Fragment*           FragList;       /* List of fragments for this line */
     Fragment*           FragLast;       /* Last entry in fragment list */
+    struct SymEntry*    Wait;           /* Undefined symbol the line waits for */
     unsigned long       PC;             /* Program counter for this line */
     unsigned char       Reloc;          /* Relocatable mode? */
     unsigned char       File;           /* From which file is the line? */
@@ -77,8 +79,8 @@ struct ListLine {
     char                Line[1];        /* Line with dynamic length */
 };
 
-/* Single linked list of lines */
-extern ListLine*        LineList;       /* List of listing lines */
+/* Single linked list of lines still in memory */
+extern ListLine*        LineList;       /* Oldest line still in memory */
 extern ListLine*        LineCur;        /* Current listing line */
 extern ListLine*        LineLast;       /* Last listing line */
 
@@ -91,6 +93,54 @@ extern int              PageLength;     /* Length of a listing page */
 #define MIN_LIST_BYTES  4
 #define MAX_LIST_BYTES  255
 
+/* Listing file formats. The binary format is meant for tools that track
+** per-line code sizes and is laid out for random access: a fixed size
+** header is followed by LST_RECORD_SIZE sized line records, so record N
+** lives at offset LST_HEADER_SIZE + N * LST_RECORD_SIZE. The records are
+** followed by a blob with the raw code/data bytes of all lines and a
+** string pool with the source lines and file names.
+**
+** All values are stored in little endian order. The header is:
+**
+**      32      Magic (LST_MAGIC)
+**      16      Version (LST_VERSION)
+**      16      Flags, currently zero
+**      32      Number of line records
+**      32      File offset of the data blob
+**      32      Size of the data blob in bytes
+**      32      File offset of the string pool
+**      32      Number of strings in the string pool
+**      32      Size of the string pool in bytes
+**
+** Each line record is:
+**
+**      32      String id of the source line
+**      32      String id of the file name
+**      32      Program counter
+**      32      Offset of the bytes of this line in the data blob
+**      32      Number of bytes for this line
+**       8      Flags (LST_FLAG_xxx)
+**       8      Include depth
+**      16      Reserved, zero
+**
+** The string pool holds each string as a 32 bit length followed by the
+** string bytes without a terminator; string ids count the strings in
+** store order starting with zero, and id zero is the empty string.
+*/
+#define LIST_FORMAT_TEXT        0
+#define LIST_FORMAT_BINARY      1
+extern int              ListingFormat;  /* Format of the listing file */
+
+/* Binary listing file layout */
+#define LST_MAGIC               0x74736C36UL    /* "6lst" */
+#define LST_VERSION             1
+#define LST_HEADER_SIZE         32
+#define LST_RECORD_SIZE         24
+
+/* Flags in a binary listing line record */
+#define LST_FLAG_RELOC          0x01    /* PC is relocatable */
+#define LST_FLAG_UNRESOLVED     0x02    /* Data contains placeholder bytes */
+
 
 
 /*****************************************************************************/
@@ -116,7 +166,15 @@ void InitListingLine (void);
 /* Initialize the current listing line */
 
 void CreateListing (void);
-/* Create the listing */
+/* Write out the remaining lines and finish the listing. Most lines have
+** already been written during assembly, as soon as they could no longer
+** change.
+*/
+
+void AbortListing (void);
+/* Close and remove a partially written listing file. Since lines are written
+** while assembling, a failed assembly may have created one.
+*/
 
 
 
@@ -100,8 +100,7 @@ struct Macro {
     unsigned        ParamCount; /* Parameter count of macro */
     IdDesc*         Params;     /* Identifiers of macro parameters */
     unsigned        TokCount;   /* Number of tokens for this macro */
-    TokNode*        TokRoot;    /* Root of token list */
-    TokNode*        TokLast;    /* Pointer to last token in list */
+    Token*          Body;       /* Macro body, a contiguous token array */
     StrBuf          Name;       /* Macro name, dynamically allocated */
     unsigned        Expansions; /* Number of active macro expansions */
     unsigned char   Style;      /* Macro style */
@@ -124,7 +123,7 @@ struct MacExp {
     MacExp*     Next;           /* Pointer to next expansion */
     Macro*      M;              /* Which macro do we expand? */
     unsigned    IfSP;           /* .IF stack pointer at start of expansion */
-    TokNode*    Exp;            /* Pointer to current token */
+    unsigned    Exp;            /* Index of current macro body token */
     TokNode*    Final;          /* Pointer to final token */
     unsigned    MacExpansions;  /* Number of active macro expansions */
     unsigned    LocalStart;     /* Start of counter for local symbol names */
@@ -150,6 +149,9 @@ static unsigned LocalName = 0;
 /* Define-style macros disabled if != 0 */
 static unsigned DisableDefines = 0;
 
+/* Number of define-style macros */
+static unsigned DefineCount = 0;
+
 
 
 /*****************************************************************************/
@@ -245,13 +247,15 @@ static Macro* NewMacro (const StrBuf* Name, unsigned char Style)
     M->ParamCount = 0;
     M->Params     = 0;
     M->TokCount   = 0;
-    M->TokRoot    = 0;
-    M->TokLast    = 0;
+    M->Body       = 0;
     SB_Init (&M->Name);
     SB_Copy (&M->Name, Name);
     M->Expansions = 0;
     M->Style      = Style;
     M->Incomplete = 1;
+    if (Style == MAC_STYLE_DEFINE) {
+        ++DefineCount;
+    }
 
     /* Insert the macro into the hash table */
     HT_Insert (&MacroTab, &M->Node);
@@ -265,7 +269,12 @@ static Macro* NewMacro (const StrBuf* Name, unsigned char Style)
 static void FreeMacro (Macro* M)
 /* Free a macro entry which has already been removed from the macro table. */
 {
-    TokNode* T;
+    unsigned I;
+
+    /* One define-style macro less */
+    if (M->Style == MAC_STYLE_DEFINE) {
+        --DefineCount;
+    }
 
     /* Free locals */
     FreeIdDescList (M->Locals);
@@ -273,11 +282,11 @@ static void FreeMacro (Macro* M)
     /* Free identifiers of parameters */
     FreeIdDescList (M->Params);
 
-    /* Free the token list for the macro */
-    while ((T = M->TokRoot) != 0) {
-        M->TokRoot = T->Next;
-        FreeTokNode (T);
+    /* Free the macro body */
+    for (I = 0; I < M->TokCount; ++I) {
+        SB_Done (&M->Body[I].SVal);
     }
+    xfree (M->Body);
 
     /* Free the macro name */
     SB_Done (&M->Name);
@@ -299,7 +308,7 @@ static MacExp* NewMacExp (Macro* M)
     /* Initialize the data */
     E->M                = M;
     E->IfSP             = GetIfStack ();
-    E->Exp              = M->TokRoot;
+    E->Exp              = 0;
     E->Final            = 0;
     E->MacExpansions    = ++MacExpansions;      /* One macro expansion more */
     E->LocalStart       = LocalName;
@@ -389,7 +398,8 @@ void MacDef (unsigned Style)
 /* Parse a macro definition */
 {
     Macro* M;
-    TokNode* N;
+    Token* T;
+    unsigned TokAlloc;
     int HaveParams;
 
     /* We expect a macro name here */
@@ -486,9 +496,10 @@ void MacDef (unsigned Style)
 
     /* Preparse the macro body. We will read the tokens until we reach end of
     ** file, or a .endmacro (or end of line for DEFINE-style macros) and store
-    ** them into a token list internal to the macro. For classic macros,
+    ** them into a token array internal to the macro. For classic macros,
     ** the .LOCAL command is detected and removed, at this time.
     */
+    TokAlloc = 0;
     while (1) {
 
         /* Check for end of macro */
@@ -546,18 +557,24 @@ void MacDef (unsigned Style)
             continue;
         }
 
-        /* Create a token node for the current token */
-        N = NewTokNode ();
+        /* Grow the macro body if needed, then store the current token */
+        if (M->TokCount >= TokAlloc) {
+            TokAlloc = (TokAlloc == 0)? 32 : TokAlloc * 2;
+            M->Body = xrealloc (M->Body, TokAlloc * sizeof (Token));
+        }
+        T = M->Body + M->TokCount++;
+        SB_Init (&T->SVal);
+        CopyToken (T, &CurTok);
 
         /* If the token is an identifier, check if it is a local parameter */
-        if (CurTok.Tok == TOK_IDENT) {
+        if (T->Tok == TOK_IDENT) {
             unsigned Count = 0;
             IdDesc* I = M->Params;
             while (I) {
-                if (SB_Compare (&I->Id, &CurTok.SVal) == 0) {
+                if (SB_Compare (&I->Id, &T->SVal) == 0) {
                     /* Local param name, replace it */
-                    N->T.Tok  = TOK_MACPARAM;
-                    N->T.IVal = Count;
+                    T->Tok  = TOK_MACPARAM;
+                    T->IVal = Count;
                     break;
                 }
                 ++Count;
@@ -565,17 +582,6 @@ void MacDef (unsigned Style)
             }
         }
 
-        /* Insert the new token in the list */
-        if (M->TokCount == 0) {
-            /* First token */
-            M->TokRoot = M->TokLast = N;
-        } else {
-            /* We have already tokens */
-            M->TokLast->Next = N;
-            M->TokLast = N;
-        }
-        ++M->TokCount;
-
         /* Read the next token */
         NextTok ();
     }
@@ -585,6 +591,33 @@ void MacDef (unsigned Style)
         NextTok ();
     }
 
+    /* If the macro has local symbols, resolve identifiers in the body that
+    ** name one of them now, so the names don't have to be compared again
+    ** on each expansion. The list index plus one is stored in the IVal
+    ** attribute, which is unused for identifier tokens; zero marks
+    ** identifiers that are no local symbols. This is done in a separate
+    ** pass since .LOCAL declarations may follow uses of the symbols.
+    */
+    if (M->LocalCount > 0) {
+        unsigned J;
+        for (J = 0; J < M->TokCount; ++J) {
+            T = M->Body + J;
+            if (T->Tok == TOK_IDENT || T->Tok == TOK_LOCAL_IDENT) {
+                unsigned Index = 0;
+                IdDesc* I = M->Locals;
+                T->IVal = 0;
+                while (I) {
+                    if (SB_Compare (&I->Id, &T->SVal) == 0) {
+                        T->IVal = (long) (Index + 1);
+                        break;
+                    }
+                    ++Index;
+                    I = I->Next;
+                }
+            }
+        }
+    }
+
     /* Reset the Incomplete flag now that parsing is done */
     M->Incomplete = 0;
 
@@ -676,10 +709,11 @@ ExpandParam:
     /* We're not expanding macro parameters. Check if we have tokens left from
     ** the macro itself.
     */
-    if (Mac->Exp) {
+    if (Mac->Exp < Mac->M->TokCount) {
 
         /* Use next macro token */
-        TokSet (Mac->Exp);
+        CopyToken (&CurTok, Mac->M->Body + Mac->Exp);
+        SB_Terminate (&CurTok.SVal);
 
         /* Create new line info for this token */
         if (Mac->LI) {
@@ -687,8 +721,8 @@ ExpandParam:
         }
         Mac->LI = StartLine (&CurTok.Pos, LI_TYPE_MACRO, Mac->MacExpansions);
 
-        /* Set pointer to next token */
-        Mac->Exp = Mac->Exp->Next;
+        /* Bump the index of the current token */
+        ++Mac->Exp;
 
         /* Is it a request for actual parameter count? */
         if (CurTok.Tok == TOK_PARAMCOUNT) {
@@ -707,34 +741,30 @@ ExpandParam:
             goto ExpandParam;
         }
 
-        /* If it's an identifier, it may in fact be a local symbol */
+        /* If it's an identifier, it may in fact be a local symbol. These
+        ** were resolved to list indices when the macro was defined, the
+        ** index plus one is stored in the IVal attribute.
+        */
         if ((CurTok.Tok == TOK_IDENT || CurTok.Tok == TOK_LOCAL_IDENT) &&
-            Mac->M->LocalCount) {
-            /* Search for the local symbol in the list */
-            unsigned Index = 0;
-            IdDesc* I = Mac->M->Locals;
-            while (I) {
-                if (SB_Compare (&CurTok.SVal, &I->Id) == 0) {
-                    /* This is in fact a local symbol, change the name. Be sure
-                    ** to generate a local label name if the original name was
-                    ** a local label, and also generate a name that cannot be
-                    ** generated by a user.
-                    */
-                    if (SB_At (&I->Id, 0) == LocalStart) {
-                        /* Must generate a local symbol */
-                        SB_Printf (&CurTok.SVal, "%cLOCAL-MACRO_SYMBOL-%04X",
-                                   LocalStart, Mac->LocalStart + Index);
-                    } else {
-                        /* Global symbol */
-                        SB_Printf (&CurTok.SVal, "LOCAL-MACRO_SYMBOL-%04X",
-                                   Mac->LocalStart + Index);
-                    }
-                    break;
-                }
-                /* Next symbol */
-                ++Index;
-                I = I->Next;
+            Mac->M->LocalCount && CurTok.IVal > 0) {
+
+            unsigned Index = (unsigned) CurTok.IVal - 1;
+
+            /* This is in fact a local symbol, change the name. Be sure
+            ** to generate a local label name if the original name was
+            ** a local label, and also generate a name that cannot be
+            ** generated by a user.
+            */
+            if (SB_At (&CurTok.SVal, 0) == LocalStart) {
+                /* Must generate a local symbol */
+                SB_Printf (&CurTok.SVal, "%cLOCAL-MACRO_SYMBOL-%04X",
+                           LocalStart, Mac->LocalStart + Index);
+            } else {
+                /* Global symbol */
+                SB_Printf (&CurTok.SVal, "LOCAL-MACRO_SYMBOL-%04X",
+                           Mac->LocalStart + Index);
             }
+            CurTok.IVal = 0;
 
             /* Done */
             return 1;
@@ -1025,6 +1055,14 @@ Macro* FindDefine (const StrBuf* Name)
 
 
 
+int HaveDefineStyleMacros (void)
+/* Return true if at least one define-style macro is defined */
+{
+    return (DefineCount > 0);
+}
+
+
+
 int InMacExpansion (void)
 /* Return true if we're currently expanding a macro */
 {
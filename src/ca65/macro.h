@@ -94,6 +94,9 @@ Macro* FindDefine (const struct StrBuf* Name);
 ** such macro was found, return NULL.
 */
 
+int HaveDefineStyleMacros (void);
+/* Return true if at least one define-style macro is defined */
+
 int InMacExpansion (void);
 /* Return true if we're currently expanding a macro */
 
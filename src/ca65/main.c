@@ -43,6 +43,7 @@
 #include "chartype.h"
 #include "cmdline.h"
 #include "debugflag.h"
+#include "diagfile.h"
 #include "mmodel.h"
 #include "print.h"
 #include "scopedefs.h"
@@ -50,6 +51,7 @@
 #include "target.h"
 #include "tgttrans.h"
 #include "version.h"
+#include "xmalloc.h"
 
 /* ca65 */
 #include "abend.h"
@@ -116,6 +118,7 @@ static void Usage (void)
             "  --create-full-dep name\tCreate a full make dependency file\n"
             "  --debug\t\t\tDebug mode\n"
             "  --debug-info\t\t\tAdd debug info to object file\n"
+            "  --diagnostics name\t\tWrite machine readable diagnostics to a file\n"
             "  --feature name\t\tSet an emulation feature\n"
             "  --help\t\t\tHelp (this text)\n"
             "  --ignore-case\t\t\tIgnore case of symbols\n"
@@ -123,6 +126,7 @@ static void Usage (void)
             "  --large-alignment\t\tDon't warn about large alignments\n"
             "  --listing name\t\tCreate a listing file if assembly was ok\n"
             "  --list-bytes n\t\tMaximum number of bytes per listing line\n"
+            "  --list-format format\t\tListing format, one of text and binary\n"
             "  --memory-model model\t\tSet the memory model\n"
             "  --pagelength n\t\tSet the page length for the listing\n"
             "  --relax-checks\t\tRelax some checks (see docs)\n"
@@ -474,6 +478,14 @@ static void OptDebugInfo (const char* Opt attribute ((unused)),
 
 
 
+static void OptDiagnostics (const char* Opt attribute ((unused)), const char* Arg)
+/* Handle the --diagnostics option */
+{
+    SetDiagnosticFile (Arg);
+}
+
+
+
 static void OptFeature (const char* Opt attribute ((unused)), const char* Arg)
 /* Set an emulation feature */
 {
@@ -546,6 +558,20 @@ static void OptListBytes (const char* Opt, const char* Arg)
 
 
 
+static void OptListFormat (const char* Opt, const char* Arg)
+/* Set the format of the listing file */
+{
+    if (strcmp (Arg, "text") == 0) {
+        ListingFormat = LIST_FORMAT_TEXT;
+    } else if (strcmp (Arg, "binary") == 0) {
+        ListingFormat = LIST_FORMAT_BINARY;
+    } else {
+        InvArg (Opt, Arg);
+    }
+}
+
+
+
 static void OptListing (const char* Opt, const char* Arg)
 /* Create a listing file */
 {
@@ -884,15 +910,18 @@ static void CreateObjFile (void)
     /* Write the scopes if requested */
     WriteScopes ();
 
+    /* Write the assertions. Must be done before the line infos are written,
+    ** since assertions reference line info lists and the table with these
+    ** lists is part of the line info section.
+    */
+    WriteAssertions ();
+
     /* Write line infos if requested */
     WriteLineInfos ();
 
     /* Write the string pool */
     WriteStrPool ();
 
-    /* Write the assertions */
-    WriteAssertions ();
-
     /* Write the spans */
     WriteSpans ();
 
@@ -914,12 +943,14 @@ int main (int argc, char* argv [])
         { "--create-full-dep",  1,      OptCreateFullDep        },
         { "--debug",            0,      OptDebug                },
         { "--debug-info",       0,      OptDebugInfo            },
+        { "--diagnostics",      1,      OptDiagnostics          },
         { "--feature",          1,      OptFeature              },
         { "--help",             0,      OptHelp                 },
         { "--ignore-case",      0,      OptIgnoreCase           },
         { "--include-dir",      1,      OptIncludeDir           },
         { "--large-alignment",  0,      OptLargeAlignment       },
         { "--list-bytes",       1,      OptListBytes            },
+        { "--list-format",      1,      OptListFormat           },
         { "--listing",          1,      OptListing              },
         { "--memory-model",     1,      OptMemoryModel          },
         { "--pagelength",       1,      OptPageLength           },
@@ -1091,6 +1122,13 @@ int main (int argc, char* argv [])
     /* Assemble the input */
     Assemble ();
 
+    /* Report the heap usage of the assembly pass if requested. The line is
+    ** only printed when the tools were compiled with XMALLOC_STATS.
+    */
+    if (Verbosity > 0) {
+        xmemreport (stderr, "assemble");
+    }
+
     /* If we didn't have any errors, check the pseudo insn stacks */
     if (ErrorCount == 0) {
         CheckPseudo ();
@@ -1144,6 +1182,16 @@ int main (int argc, char* argv [])
             CreateListing ();
         }
        CreateDependencies ();
+    } else if (SB_GetLen (&ListingName) > 0) {
+        /* Listing lines are streamed to disk during assembly, so remove a
+        ** partially written listing file.
+        */
+        AbortListing ();
+    }
+
+    /* Report the heap usage after output generation if requested */
+    if (Verbosity > 0) {
+        xmemreport (stderr, "output");
     }
 
     /* Close the input file */
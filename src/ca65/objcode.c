@@ -36,6 +36,9 @@
 #include <string.h>
 #include <errno.h>
 
+/* common */
+#include "xmalloc.h"
+
 /* cc65 */
 #include "error.h"
 #include "fragment.h"
@@ -157,21 +160,30 @@ void EmitData (const void* D, unsigned Size)
     /* Make a useful pointer from Data */
     const unsigned char* Data = D;
 
-    /* Create lots of fragments for the data */
+    /* Create literal fragments for the data. Everything up to the maximum
+    ** fragment length goes into one fragment, with the data on the heap if
+    ** it doesn't fit into the fragment itself.
+    */
     while (Size) {
         Fragment* F;
 
         /* Determine the length of the next fragment */
         unsigned Len = Size;
-        if (Len > sizeof (F->V.Data)) {
-            Len = sizeof (F->V.Data);
+        if (Len > 0xFFFF) {
+            /* The fragment length field is 16 bits */
+            Len = 0xFFFF;
         }
 
         /* Create a new fragment */
-        F = GenFragment (FRAG_LITERAL, Len);
+        F = GenFragment (FRAG_LITERAL, (unsigned short) Len);
 
         /* Copy the data */
-        memcpy (F->V.Data, Data, Len);
+        if (Len > sizeof (F->V.Data)) {
+            F->V.Buf = xmalloc (Len);
+            memcpy (F->V.Buf, Data, Len);
+        } else {
+            memcpy (F->V.Data, Data, Len);
+        }
 
         /* Next chunk */
         Data += Len;
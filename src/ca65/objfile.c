@@ -39,8 +39,10 @@
 #include <errno.h>
 
 /* common */
+#include "check.h"
 #include "fname.h"
 #include "objdefs.h"
+#include "xmalloc.h"
 
 /* ca65 */
 #include "global.h"
@@ -58,6 +60,24 @@
 /* File descriptor */
 static FILE* F = 0;
 
+/* The object file is formatted into a growable memory buffer and written to
+** disk with one large write when the file is closed. This replaces many
+** small writes and the seeks used to patch sizes and the header by cheap
+** memory accesses. Buf covers the whole file, BufPos is the current write
+** position within it and BufLen the amount of valid data. BufPos may be
+** below BufLen after a seek back into already written data.
+*/
+static unsigned char* Buf = 0;
+static unsigned long BufSize = 0;
+static unsigned long BufLen = 0;
+static unsigned long BufPos = 0;
+
+/* Range ignored when comparing against an existing file, see
+** ObjExcludeFromCompare.
+*/
+static unsigned long SkipStart = 0;
+static unsigned long SkipEnd = 0;
+
 /* Default extension */
 #define OBJ_EXT ".o"
 
@@ -118,6 +138,77 @@ static void ObjWriteError (void)
 
 
 
+static void ObjGrow (unsigned long NewSize)
+/* Grow the output buffer so it holds at least NewSize bytes */
+{
+    /* Double the buffer size until the request is satisfied */
+    unsigned long Size = (BufSize == 0)? 0x10000 : BufSize;
+    while (Size < NewSize) {
+        Size *= 2;
+    }
+
+    /* Reallocate the buffer */
+    Buf = xrealloc (Buf, Size);
+    BufSize = Size;
+}
+
+
+
+static int ObjFileUnchanged (void)
+/* Compare the formatted object image against an existing output file. Return
+** true if the file exists and is byte for byte identical. The write can then
+** be skipped, and since the file keeps its timestamp, make will not rebuild
+** anything downstream of it.
+*/
+{
+    unsigned char Chunk[4096];
+    unsigned long Done = 0;
+    FILE* Old;
+
+    /* Try to open an existing file */
+    Old = fopen (OutFile, "rb");
+    if (Old == 0) {
+        return 0;
+    }
+
+    /* Compare the contents in chunks */
+    while (Done < BufLen) {
+        size_t Bytes = sizeof (Chunk);
+        if (BufLen - Done < Bytes) {
+            Bytes = (size_t) (BufLen - Done);
+        }
+        if (fread (Chunk, 1, Bytes, Old) != Bytes) {
+            fclose (Old);
+            return 0;
+        }
+        if (memcmp (Chunk, Buf + Done, Bytes) != 0) {
+            /* Differences are allowed within the excluded range only */
+            size_t I;
+            for (I = 0; I < Bytes; ++I) {
+                unsigned long Pos = Done + I;
+                if (Chunk[I] != Buf[Pos] &&
+                    (Pos < SkipStart || Pos >= SkipEnd)) {
+                    fclose (Old);
+                    return 0;
+                }
+            }
+        }
+        Done += Bytes;
+    }
+
+    /* The old file must not contain additional data */
+    if (fgetc (Old) != EOF) {
+        fclose (Old);
+        return 0;
+    }
+
+    /* Identical */
+    fclose (Old);
+    return 1;
+}
+
+
+
 static void ObjWriteHeader (void)
 /* Write the object file header to the current file position */
 {
@@ -157,7 +248,7 @@ static void ObjWriteHeader (void)
 
 
 void ObjOpen (void)
-/* Open the object file for writing, write a dummy header */
+/* Start the object file, write a dummy header */
 {
     /* Do we have a name for the output file? */
     if (OutFile == 0) {
@@ -167,13 +258,10 @@ void ObjOpen (void)
         OutFile = MakeFilename (InFile, OBJ_EXT);
     }
 
-    /* Create the output file */
-    F = fopen (OutFile, "w+b");
-    if (F == 0) {
-        Fatal ("Cannot open output file '%s': %s", OutFile, strerror (errno));
-    }
-
-    /* Write a dummy header */
+    /* The file itself is created in ObjClose, after it is known if an
+    ** identical file already exists. Start the image with a dummy header
+    ** that is patched when the file is closed.
+    */
     ObjWriteHeader ();
 }
 
@@ -183,22 +271,58 @@ void ObjClose (void)
 /* Write an update header and close the object file. */
 {
     /* Go back to the beginning */
-    if (fseek (F, 0, SEEK_SET) != 0) {
-        ObjWriteError ();
-    }
+    ObjSetFilePos (0);
 
     /* If we have debug infos, set the flag in the header */
     if (DbgSyms) {
         Header.Flags |= OBJ_FLAGS_DBGINFO;
     }
 
+    /* Line info lists are interned and written as a shared table */
+    Header.Flags |= OBJ_FLAGS_LILISTS;
+
     /* Write the updated header */
     ObjWriteHeader ();
 
-    /* Close the file */
-    if (fclose (F) != 0) {
-        ObjWriteError ();
+    /* If an identical object file already exists, leave it alone. Keeping
+    ** its timestamp prunes all relink and rearchive steps downstream, which
+    ** is common when unchanged generated files get touched.
+    */
+    if (!ObjFileUnchanged ()) {
+
+        /* Create the output file */
+        F = fopen (OutFile, "wb");
+        if (F == 0) {
+            Fatal ("Cannot open output file '%s': %s", OutFile, strerror (errno));
+        }
+
+        /* Flush the buffered data to disk with one large write */
+        if (BufLen > 0 && fwrite (Buf, 1, BufLen, F) != BufLen) {
+            ObjWriteError ();
+        }
+
+        /* Close the file */
+        if (fclose (F) != 0) {
+            ObjWriteError ();
+        }
     }
+
+    /* Free the buffer */
+    xfree (Buf);
+    Buf = 0;
+    BufSize = BufLen = BufPos = 0;
+}
+
+
+
+void ObjExcludeFromCompare (unsigned long Start, unsigned long End)
+/* Exclude the file range [Start, End) from the comparison with an existing
+** object file. Used for the time stamp option, which changes on every run
+** without making the output any different.
+*/
+{
+    SkipStart = Start;
+    SkipEnd = End;
 }
 
 
@@ -206,11 +330,7 @@ void ObjClose (void)
 unsigned long ObjGetFilePos (void)
 /* Get the current file position */
 {
-    long Pos = ftell (F);
-    if (Pos < 0) {
-        ObjWriteError ();
-    }
-    return Pos;
+    return BufPos;
 }
 
 
@@ -218,9 +338,8 @@ unsigned long ObjGetFilePos (void)
 void ObjSetFilePos (unsigned long Pos)
 /* Set the file position */
 {
-    if (fseek (F, Pos, SEEK_SET) != 0) {
-        ObjWriteError ();
-    }
+    CHECK (Pos <= BufLen);
+    BufPos = Pos;
 }
 
 
@@ -228,8 +347,12 @@ void ObjSetFilePos (unsigned long Pos)
 void ObjWrite8 (unsigned V)
 /* Write an 8 bit value to the file */
 {
-    if (putc (V, F) == EOF) {
-        ObjWriteError ();
+    if (BufPos >= BufSize) {
+        ObjGrow (BufPos + 1);
+    }
+    Buf[BufPos++] = (unsigned char) V;
+    if (BufPos > BufLen) {
+        BufLen = BufPos;
     }
 }
 
@@ -316,8 +439,13 @@ void ObjWriteBuf (const StrBuf* S)
 void ObjWriteData (const void* Data, unsigned Size)
 /* Write literal data to the file */
 {
-    if (fwrite (Data, 1, Size, F) != Size) {
-        ObjWriteError ();
+    if (BufPos + Size > BufSize) {
+        ObjGrow (BufPos + Size);
+    }
+    memcpy (Buf + BufPos, Data, Size);
+    BufPos += Size;
+    if (BufPos > BufLen) {
+        BufLen = BufPos;
     }
 }
 
@@ -342,7 +470,7 @@ void ObjWritePos (const FilePos* Pos)
 void ObjStartOptions (void)
 /* Mark the start of the option section */
 {
-    Header.OptionOffs = ftell (F);
+    Header.OptionOffs = ObjGetFilePos ();
 }
 
 
@@ -350,7 +478,7 @@ void ObjStartOptions (void)
 void ObjEndOptions (void)
 /* Mark the end of the option section */
 {
-    Header.OptionSize = ftell (F) - Header.OptionOffs;
+    Header.OptionSize = ObjGetFilePos () - Header.OptionOffs;
 }
 
 
@@ -358,7 +486,7 @@ void ObjEndOptions (void)
 void ObjStartFiles (void)
 /* Mark the start of the files section */
 {
-    Header.FileOffs = ftell (F);
+    Header.FileOffs = ObjGetFilePos ();
 }
 
 
@@ -366,7 +494,7 @@ void ObjStartFiles (void)
 void ObjEndFiles (void)
 /* Mark the end of the files section */
 {
-    Header.FileSize = ftell (F) - Header.FileOffs;
+    Header.FileSize = ObjGetFilePos () - Header.FileOffs;
 }
 
 
@@ -374,7 +502,7 @@ void ObjEndFiles (void)
 void ObjStartSegments (void)
 /* Mark the start of the segment section */
 {
-    Header.SegOffs = ftell (F);
+    Header.SegOffs = ObjGetFilePos ();
 }
 
 
@@ -382,7 +510,7 @@ void ObjStartSegments (void)
 void ObjEndSegments (void)
 /* Mark the end of the segment section */
 {
-    Header.SegSize = ftell (F) - Header.SegOffs;
+    Header.SegSize = ObjGetFilePos () - Header.SegOffs;
 }
 
 
@@ -390,7 +518,7 @@ void ObjEndSegments (void)
 void ObjStartImports (void)
 /* Mark the start of the import section */
 {
-    Header.ImportOffs = ftell (F);
+    Header.ImportOffs = ObjGetFilePos ();
 }
 
 
@@ -398,7 +526,7 @@ void ObjStartImports (void)
 void ObjEndImports (void)
 /* Mark the end of the import section */
 {
-    Header.ImportSize = ftell (F) - Header.ImportOffs;
+    Header.ImportSize = ObjGetFilePos () - Header.ImportOffs;
 }
 
 
@@ -406,7 +534,7 @@ void ObjEndImports (void)
 void ObjStartExports (void)
 /* Mark the start of the export section */
 {
-    Header.ExportOffs = ftell (F);
+    Header.ExportOffs = ObjGetFilePos ();
 }
 
 
@@ -414,7 +542,7 @@ void ObjStartExports (void)
 void ObjEndExports (void)
 /* Mark the end of the export section */
 {
-    Header.ExportSize = ftell (F) - Header.ExportOffs;
+    Header.ExportSize = ObjGetFilePos () - Header.ExportOffs;
 }
 
 
@@ -422,7 +550,7 @@ void ObjEndExports (void)
 void ObjStartDbgSyms (void)
 /* Mark the start of the debug symbol section */
 {
-    Header.DbgSymOffs = ftell (F);
+    Header.DbgSymOffs = ObjGetFilePos ();
 }
 
 
@@ -430,7 +558,7 @@ void ObjStartDbgSyms (void)
 void ObjEndDbgSyms (void)
 /* Mark the end of the debug symbol section */
 {
-    Header.DbgSymSize = ftell (F) - Header.DbgSymOffs;
+    Header.DbgSymSize = ObjGetFilePos () - Header.DbgSymOffs;
 }
 
 
@@ -438,7 +566,7 @@ void ObjEndDbgSyms (void)
 void ObjStartLineInfos (void)
 /* Mark the start of the line info section */
 {
-    Header.LineInfoOffs = ftell (F);
+    Header.LineInfoOffs = ObjGetFilePos ();
 }
 
 
@@ -446,7 +574,7 @@ void ObjStartLineInfos (void)
 void ObjEndLineInfos (void)
 /* Mark the end of the line info section */
 {
-    Header.LineInfoSize = ftell (F) - Header.LineInfoOffs;
+    Header.LineInfoSize = ObjGetFilePos () - Header.LineInfoOffs;
 }
 
 
@@ -454,7 +582,7 @@ void ObjEndLineInfos (void)
 void ObjStartStrPool (void)
 /* Mark the start of the string pool section */
 {
-    Header.StrPoolOffs = ftell (F);
+    Header.StrPoolOffs = ObjGetFilePos ();
 }
 
 
@@ -462,7 +590,7 @@ void ObjStartStrPool (void)
 void ObjEndStrPool (void)
 /* Mark the end of the string pool section */
 {
-    Header.StrPoolSize = ftell (F) - Header.StrPoolOffs;
+    Header.StrPoolSize = ObjGetFilePos () - Header.StrPoolOffs;
 }
 
 
@@ -470,7 +598,7 @@ void ObjEndStrPool (void)
 void ObjStartAssertions (void)
 /* Mark the start of the assertion table */
 {
-    Header.AssertOffs = ftell (F);
+    Header.AssertOffs = ObjGetFilePos ();
 }
 
 
@@ -478,7 +606,7 @@ void ObjStartAssertions (void)
 void ObjEndAssertions (void)
 /* Mark the end of the assertion table */
 {
-    Header.AssertSize = ftell (F) - Header.AssertOffs;
+    Header.AssertSize = ObjGetFilePos () - Header.AssertOffs;
 }
 
 
@@ -486,7 +614,7 @@ void ObjEndAssertions (void)
 void ObjStartScopes (void)
 /* Mark the start of the scope table */
 {
-    Header.ScopeOffs = ftell (F);
+    Header.ScopeOffs = ObjGetFilePos ();
 }
 
 
@@ -494,7 +622,7 @@ void ObjStartScopes (void)
 void ObjEndScopes (void)
 /* Mark the end of the scope table */
 {
-    Header.ScopeSize = ftell (F) - Header.ScopeOffs;
+    Header.ScopeSize = ObjGetFilePos () - Header.ScopeOffs;
 }
 
 
@@ -502,7 +630,7 @@ void ObjEndScopes (void)
 void ObjStartSpans (void)
 /* Mark the start of the span table */
 {
-    Header.SpanOffs = ftell (F);
+    Header.SpanOffs = ObjGetFilePos ();
 }
 
 
@@ -510,5 +638,5 @@ void ObjStartSpans (void)
 void ObjEndSpans (void)
 /* Mark the end of the span table */
 {
-    Header.SpanSize = ftell (F) - Header.SpanOffs;
+    Header.SpanSize = ObjGetFilePos () - Header.SpanOffs;
 }
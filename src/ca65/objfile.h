@@ -51,7 +51,13 @@
 
 
 void ObjOpen (void);
-/* Open the object file for writing, write a dummy header */
+/* Start the object file, write a dummy header */
+
+void ObjExcludeFromCompare (unsigned long Start, unsigned long End);
+/* Exclude the file range [Start, End) from the comparison with an existing
+** object file. Used for the time stamp option, which changes on every run
+** without making the output any different.
+*/
 
 void ObjClose (void);
 /* Write an update header and close the object file. */
@@ -167,9 +167,19 @@ void WriteOptions (void)
     O = OptRoot;
     while (O) {
 
-        /* Write the type of the option, then the value */
+        /* Write the type of the option, then the value. The time stamp is
+        ** different on every run and must not keep an otherwise unchanged
+        ** object file from being detected as such, so its value bytes are
+        ** left out of the file comparison.
+        */
         ObjWrite8 (O->Type);
-        ObjWriteVar (O->Val);
+        if (O->Type == OPT_DATETIME) {
+            unsigned long Start = ObjGetFilePos ();
+            ObjWriteVar (O->Val);
+            ObjExcludeFromCompare (Start, ObjGetFilePos ());
+        } else {
+            ObjWriteVar (O->Val);
+        }
 
         /* Next option */
         O = O->Next;
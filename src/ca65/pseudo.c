@@ -576,15 +576,39 @@ static void DoByte (void)
     Span* S = OpenSpan ();
     StrBuf Type = AUTO_STRBUF_INITIALIZER;
 
+    /* Buffer for constant data. Constant values and strings are collected
+    ** and emitted as one chunk, so a long list of plain numbers ends up in
+    ** one fragment instead of one fragment per value.
+    */
+    StrBuf Data = AUTO_STRBUF_INITIALIZER;
+
     /* Parse arguments */
     while (1) {
         if (CurTok.Tok == TOK_STRCON) {
-            /* A string, translate into target charset and emit */
+            /* A string, translate into target charset and buffer it */
             TgtTranslateStrBuf (&CurTok.SVal);
-            EmitStrBuf (&CurTok.SVal);
+            SB_Append (&Data, &CurTok.SVal);
             NextTok ();
         } else {
-            EmitByte (BoundedExpr (Expression, 1));
+            ExprNode* Expr = BoundedExpr (Expression, 1);
+            long Val;
+            if (IsEasyConst (Expr, &Val)) {
+                /* A constant value, buffer it */
+                if (!IsByteRange (Val)) {
+                    Error ("Range error (%ld not in [0..255])", Val);
+                }
+                SB_AppendChar (&Data, (char) (Val & 0xFF));
+                FreeExpr (Expr);
+            } else {
+                /* A real expression. Flush the buffered data first, so the
+                ** bytes are emitted in order.
+                */
+                if (SB_NotEmpty (&Data)) {
+                    EmitStrBuf (&Data);
+                    SB_Clear (&Data);
+                }
+                EmitByte (Expr);
+            }
         }
         if (CurTok.Tok != TOK_COMMA) {
             break;
@@ -598,6 +622,12 @@ static void DoByte (void)
         }
     }
 
+    /* Emit the buffered data */
+    if (SB_NotEmpty (&Data)) {
+        EmitStrBuf (&Data);
+    }
+    SB_Done (&Data);
+
     /* Close the span, then add type information to it.
     ** Note: empty string operands emit nothing;
     ** so, add a type only if there's a span.
@@ -1302,28 +1332,26 @@ static void DoIncBin (void)
     /* Seek to the start position */
     fseek (F, Start, SEEK_SET);
 
-    /* Read chunks and insert them into the output */
-    while (Count > 0) {
-
-        unsigned char Buf [1024];
+    /* Read the file in one go and insert the data into the output. EmitData
+    ** will split the data into chunks if it is too large for one fragment.
+    */
+    if (Count > 0) {
 
-        /* Calculate the number of bytes to read */
-        size_t BytesToRead = (Count > (long)sizeof(Buf))? sizeof(Buf) : (size_t) Count;
+        unsigned char* Buf = xmalloc ((size_t) Count);
 
-        /* Read chunk */
-        size_t BytesRead = fread (Buf, 1, BytesToRead, F);
-        if (BytesToRead != BytesRead) {
+        /* Read the data */
+        size_t BytesRead = fread (Buf, 1, (size_t) Count, F);
+        if ((size_t) Count != BytesRead) {
             /* Some sort of error */
             ErrorSkip ("Cannot read from include file '%m%p': %s",
                        &Name, strerror (errno));
-            break;
+        } else {
+            /* Insert it into the output */
+            EmitData (Buf, (unsigned) Count);
         }
 
-        /* Insert it into the output */
-        EmitData (Buf, BytesRead);
-
-        /* Keep the counters current */
-        Count -= BytesRead;
+        /* Release the buffer */
+        xfree (Buf);
     }
 
 Done:
@@ -1934,9 +1962,31 @@ static void DoWord (void)
     Span* S = OpenSpan ();
     StrBuf Type = STATIC_STRBUF_INITIALIZER;
 
+    /* Buffer for constant data, see DoByte */
+    StrBuf Data = AUTO_STRBUF_INITIALIZER;
+
     /* Parse arguments */
     while (1) {
-        EmitWord (BoundedExpr (Expression, 2));
+        ExprNode* Expr = BoundedExpr (Expression, 2);
+        long Val;
+        if (IsEasyConst (Expr, &Val)) {
+            /* A constant value, buffer it */
+            if (!IsWordRange (Val)) {
+                Error ("Range error (%ld not in [0..65535])", Val);
+            }
+            SB_AppendChar (&Data, (char) (Val & 0xFF));
+            SB_AppendChar (&Data, (char) ((Val >> 8) & 0xFF));
+            FreeExpr (Expr);
+        } else {
+            /* A real expression. Flush the buffered data first, so the
+            ** bytes are emitted in order.
+            */
+            if (SB_NotEmpty (&Data)) {
+                EmitStrBuf (&Data);
+                SB_Clear (&Data);
+            }
+            EmitWord (Expr);
+        }
         if (CurTok.Tok != TOK_COMMA) {
             break;
         } else {
@@ -1944,6 +1994,12 @@ static void DoWord (void)
         }
     }
 
+    /* Emit the buffered data */
+    if (SB_NotEmpty (&Data)) {
+        EmitStrBuf (&Data);
+    }
+    SB_Done (&Data);
+
     /* Close the span, then add type information to it */
     S = CloseSpan (S);
     SetSpanType (S, GenArrayType (&Type, GetSpanSize (S), EType, sizeof (EType)));
@@ -104,6 +104,7 @@ typedef struct CharSourceFunctions CharSourceFunctions;
 struct CharSourceFunctions {
     void (*MarkStart) (CharSource*);    /* Mark the start pos of a token */
     void (*NextChar) (CharSource*);     /* Read next char from input */
+    void (*StringSpan) (CharSource*, int); /* Bulk-copy string chars to SVal */
     void (*Done) (CharSource*);         /* Close input source */
 };
 
@@ -439,6 +440,51 @@ static void IFNextChar (CharSource* S)
 
 
 
+static void IFStringSpan (CharSource* S, int StringTerm)
+/* Bulk-copy plain string constant characters to SVal. The current char in C
+** is part of the span, the remainder is searched for in the line buffer, so
+** the span is appended in one chunk instead of one call per character. On
+** return, C holds the first character the string scanner must look at again:
+** the terminator, a newline, or the start of an escape sequence.
+*/
+{
+    StrBuf* Line = &S->V.File.Line;
+    const char* Buf = SB_GetConstBuf (Line);
+    unsigned Len = SB_GetLen (Line);
+    unsigned I = SB_GetIndex (Line);
+    unsigned Start = I;
+
+    /* Check the current character first */
+    if (C == EOF || C == StringTerm || C == '\n' ||
+        (C == '\\' && StringEscapes)) {
+        return;
+    }
+    SB_AppendChar (&CurTok.SVal, C);
+
+    /* Search for the end of the span. The line buffer always ends with a
+    ** newline, so the search will stop within the line.
+    */
+    while (I < Len) {
+        int N = (unsigned char) Buf[I];
+        if (N == StringTerm || N == '\n' || (N == '\\' && StringEscapes)) {
+            break;
+        }
+        ++I;
+    }
+
+    /* Append the span in one chunk */
+    if (I > Start) {
+        SB_AppendBuf (&CurTok.SVal, Buf + Start, I - Start);
+    }
+
+    /* Make the stop character the current one, like IFNextChar does */
+    S->V.File.Pos.Col = I;
+    SB_SetIndex (Line, I + 1);
+    C = (unsigned char) Buf[I];
+}
+
+
+
 void IFDone (CharSource* S)
 /* Close the current input file */
 {
@@ -474,6 +520,7 @@ void IFDone (CharSource* S)
 static const CharSourceFunctions IFFunc = {
     IFMarkStart,
     IFNextChar,
+    IFStringSpan,
     IFDone
 };
 
@@ -597,6 +644,37 @@ static void IDNextChar (CharSource* S)
 
 
 
+static void IDStringSpan (CharSource* S, int StringTerm)
+/* Bulk-copy plain string constant characters to SVal. See IFStringSpan. */
+{
+    const char* Start = S->V.Data.Pos;
+    const char* P = Start;
+
+    /* Check the current character first */
+    if (C == EOF || C == StringTerm || C == '\n' ||
+        (C == '\\' && StringEscapes)) {
+        return;
+    }
+    SB_AppendChar (&CurTok.SVal, C);
+
+    /* Search for the end of the span */
+    while (*P != '\0' && *P != StringTerm && *P != '\n' &&
+           !(*P == '\\' && StringEscapes)) {
+        ++P;
+    }
+
+    /* Append the span in one chunk */
+    if (P > Start) {
+        SB_AppendBuf (&CurTok.SVal, Start, (unsigned) (P - Start));
+    }
+
+    /* Make the stop character the current one, like IDNextChar does */
+    S->V.Data.Pos = P;
+    IDNextChar (S);
+}
+
+
+
 void IDDone (CharSource* S)
 /* Close the current input data */
 {
@@ -612,6 +690,7 @@ void IDDone (CharSource* S)
 static const CharSourceFunctions IDFunc = {
     IDMarkStart,
     IDNextChar,
+    IDStringSpan,
     IDDone
 };
 
@@ -763,17 +842,21 @@ static void ReadIdent (void)
 ** checked.
 */
 {
-    /* Read the identifier */
-    do {
-        SB_AppendChar (&CurTok.SVal, C);
-        NextChar ();
-    } while (IsIdChar (C));
-    SB_Terminate (&CurTok.SVal);
-
-    /* If we should ignore case, convert the identifier to upper case */
+    /* Read the identifier. If we should ignore case, fold it to upper case
+    ** while reading instead of rescanning the finished name.
+    */
     if (IgnoreCase) {
-        UpcaseSVal ();
+        do {
+            SB_AppendChar (&CurTok.SVal, CharToUpper (C));
+            NextChar ();
+        } while (IsIdChar (C));
+    } else {
+        do {
+            SB_AppendChar (&CurTok.SVal, C);
+            NextChar ();
+        } while (IsIdChar (C));
     }
+    SB_Terminate (&CurTok.SVal);
 }
 
 
@@ -786,6 +869,12 @@ static void ReadStringConst (int StringTerm)
 
     /* Read the string */
     while (1) {
+        /* Bulk-copy the plain characters up to the next terminator, newline
+        ** or escape sequence. The per character loop below then only has to
+        ** deal with these special cases.
+        */
+        Source->Func->StringSpan (Source, StringTerm);
+
         if (C == StringTerm) {
             break;
         }
@@ -1514,6 +1603,149 @@ CharAgain:
 
 
 
+void SkipRawInput (void)
+/* Skip characters from the current input file up to the next character that
+** may start a token of interest while skipping a false conditional branch:
+** a pseudo instruction, an identifier that may name a define-style macro,
+** or end of file. Comments, strings and character constants are skipped
+** without tokenizing or checking their contents. When input doesn't come
+** directly from a file, the function returns without skipping anything.
+*/
+{
+    /* Tokens from the input stack (macro expansions, .repeat playback) must
+    ** be read one by one, as after a forced end of assembly.
+    */
+    if (HavePushedInput () || ForcedEnd) {
+        return;
+    }
+
+    /* Identifiers may only be skipped blindly if they cannot start a
+    ** define-style macro expansion, since the scanner expands those even
+    ** inside a false conditional.
+    */
+    while (1) {
+
+        if (IsIdStart (C)) {
+            if (HaveDefineStyleMacros ()) {
+                /* Let the caller tokenize the identifier */
+                return;
+            }
+            do {
+                NextChar ();
+            } while (IsIdChar (C));
+            continue;
+        }
+
+        if (C == LocalStart) {
+            /* A cheap local symbol, which can never be a define-style macro */
+            do {
+                NextChar ();
+            } while (IsIdChar (C));
+            continue;
+        }
+
+        switch (C) {
+
+            case '.':
+            case EOF:
+                /* Tokenize normally from here */
+                return;
+
+            case ';':
+                /* Comment, skip to end of line */
+                do {
+                    NextChar ();
+                } while (C != '\n' && C != EOF);
+                break;
+
+            case '\"':
+                /* Skip a string constant */
+                NextChar ();
+                while (C != '\"' && C != '\n' && C != EOF) {
+                    if (C == '\\' && StringEscapes) {
+                        NextChar ();
+                        if (C == '\n' || C == EOF) {
+                            break;
+                        }
+                    }
+                    NextChar ();
+                }
+                if (C == '\"') {
+                    NextChar ();
+                }
+                break;
+
+            case '\'':
+                if (LooseStringTerm) {
+                    /* Skip a string with ' as terminator */
+                    NextChar ();
+                    while (C != '\'' && C != '\n' && C != EOF) {
+                        if (C == '\\' && StringEscapes) {
+                            NextChar ();
+                            if (C == '\n' || C == EOF) {
+                                break;
+                            }
+                        }
+                        NextChar ();
+                    }
+                    if (C == '\'') {
+                        NextChar ();
+                    }
+                } else {
+                    /* Skip a character constant */
+                    NextChar ();
+                    if (C != '\n' && C != EOF) {
+                        NextChar ();
+                        if (C == '\'') {
+                            NextChar ();
+                        }
+                    }
+                }
+                break;
+
+            case '/':
+                /* Check for a C style comment */
+                NextChar ();
+                if (CComments && C == '*') {
+                    NextChar ();
+                    while (C != EOF) {
+                        if (C == '*') {
+                            NextChar ();
+                            if (C == '/') {
+                                NextChar ();
+                                break;
+                            }
+                        } else {
+                            NextChar ();
+                        }
+                    }
+                }
+                break;
+
+            case '\\':
+                /* Honor line continuations */
+                NextChar ();
+                if (LineCont && C == '\n') {
+                    NextChar ();
+                }
+                break;
+
+            case '\n':
+                /* End of line, go on with the next one */
+                NextChar ();
+                break;
+
+            default:
+                /* Any other character is skipped unchecked */
+                NextChar ();
+                break;
+
+        }
+    }
+}
+
+
+
 int GetSubKey (const char* const* Keys, unsigned Count)
 /* Search for a subkey in a table of keywords. The current token must be an
 ** identifier and all keys must be in upper case. The identifier will be
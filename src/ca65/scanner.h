@@ -84,6 +84,15 @@ void UpcaseSVal (void);
 void NextRawTok (void);
 /* Read the next raw token from the input stream */
 
+void SkipRawInput (void);
+/* Skip characters from the current input file up to the next character that
+** may start a token of interest while skipping a false conditional branch:
+** a pseudo instruction, an identifier that may name a define-style macro,
+** or end of file. Comments, strings and character constants are skipped
+** without tokenizing or checking their contents. When input doesn't come
+** directly from a file, the function returns without skipping anything.
+*/
+
 int GetSubKey (const char* const* Keys, unsigned Count);
 /* Search for a subkey in a table of keywords. The current token must be an
 ** identifier and all keys must be in upper case. The identifier will be
@@ -453,7 +453,7 @@ void SegDump (void)
                     State = 0;
                 }
                 for (I = 0; I < F->Len; ++I) {
-                    printf (" %02X", F->V.Data [I]);
+                    printf (" %02X", GetFragLiteral (F)[I]);
                     X += 3;
                 }
             } else if (F->Type == FRAG_EXPR || F->Type == FRAG_SEXPR) {
@@ -555,7 +555,7 @@ static void WriteOneSeg (Segment* Seg)
             case FRAG_LITERAL:
                 ObjWrite8 (FRAG_LITERAL);
                 ObjWriteVar (Frag->Len);
-                ObjWriteData (Frag->V.Data, Frag->Len);
+                ObjWriteData (GetFragLiteral (Frag), Frag->Len);
                 break;
 
             case FRAG_EXPR:
@@ -50,6 +50,24 @@
 
 
 
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* Generation counter for the study results cached at symbol entries. It
+** is bumped whenever the resolution state of a symbol changes, which
+** invalidates all cached results at once. The counter moves in steps of
+** two, because a cache slot stores the generation itself after the first
+** study in a state and the generation plus one from the second study on,
+** which allows to count studies without extra memory. Symbols start out
+** with generation zero, which never matches, so they have no valid cache.
+*/
+static unsigned StudyGeneration = 2;
+
+
+
 /*****************************************************************************/
 /*                              struct ExprDesc                              */
 /*****************************************************************************/
@@ -414,6 +432,82 @@ static void ED_Neg (ExprDesc* D)
 
 
 
+static void ED_Copy (const ExprDesc* From, ExprDesc* To)
+/* Copy the data from one ExprDesc to another, duplicating the reference
+** lists. To must be initialized and empty.
+*/
+{
+    *To = *From;
+    if (To->SymCount > 0) {
+        To->SymLimit = To->SymCount;
+        To->SymRef   = xmalloc (To->SymLimit * sizeof (To->SymRef[0]));
+        memcpy (To->SymRef, From->SymRef, To->SymCount * sizeof (To->SymRef[0]));
+    } else {
+        To->SymLimit = 0;
+        To->SymRef   = 0;
+    }
+    if (To->SecCount > 0) {
+        To->SecLimit = To->SecCount;
+        To->SecRef   = xmalloc (To->SecLimit * sizeof (To->SecRef[0]));
+        memcpy (To->SecRef, From->SecRef, To->SecCount * sizeof (To->SecRef[0]));
+    } else {
+        To->SecLimit = 0;
+        To->SecRef   = 0;
+    }
+}
+
+
+
+static int CacheCheck (ExprDesc** Study, unsigned* StudyGen, ExprDesc* D, int* Store)
+/* Check for a study result cached in the given slot. If the slot contains a
+** result from the current resolution state, copy it into D and return true.
+** Otherwise return false and set Store to true if this is at least the
+** third study in this state, so that the caller should cache the new
+** result. Caching only from the third study on keeps symbols that are
+** studied once or twice per state - the common case, since most symbols
+** change with every definition while parsing - free of any allocation
+** overhead.
+*/
+{
+    if (*StudyGen == StudyGeneration + 1) {
+        if (*Study != 0) {
+            /* Valid cached result */
+            ED_Copy (*Study, D);
+            return 1;
+        }
+        /* Studied twice before in this state, the result is worth keeping */
+        *Store = 1;
+    } else {
+        if (*StudyGen == StudyGeneration) {
+            /* Second study in this state */
+            *StudyGen = StudyGeneration + 1;
+        } else {
+            /* First study in this state. Drop an outdated result and just
+            ** remember that the slot was visited.
+            */
+            if (*Study != 0) {
+                ED_Done (*Study);
+                xfree (*Study);
+                *Study = 0;
+            }
+            *StudyGen = StudyGeneration;
+        }
+        *Store = 0;
+    }
+    return 0;
+}
+
+
+
+static void CacheStore (ExprDesc** Study, const ExprDesc* D)
+/* Remember a study result in the given cache slot */
+{
+    *Study = xmalloc (sizeof (**Study));
+    ED_Copy (D, *Study);
+}
+
+
+
 static void ED_Move (ExprDesc* From, ExprDesc* To)
 /* Move the data from one ExprDesc to another. Old data is freed, and From
 ** is prepared to that ED_Done may be called safely.
@@ -442,7 +536,7 @@ static void StudyExprInternal (ExprNode* Expr, ExprDesc* D);
 
 
 
-static unsigned char GetConstAddrSize (long Val)
+unsigned char GetConstAddrSize (long Val)
 /* Get the address size of a constant */
 {
     if ((Val & ~0xFFL) == 0) {
@@ -530,6 +624,15 @@ static void StudySymbol (ExprNode* Expr, ExprDesc* D)
         } else {
 
             unsigned char AddrSize;
+            int Store;
+
+            /* Check for a study result cached at the symbol. Symbols are
+            ** referenced from many expressions, and symbols defined in terms
+            ** of other symbols would otherwise be walked over and over again.
+            */
+            if (CacheCheck (&Sym->Study, &Sym->StudyGen, D, &Store)) {
+                return;
+            }
 
             /* Mark the symbol and study its associated expression */
             SymMarkUser (Sym);
@@ -549,6 +652,13 @@ static void StudySymbol (ExprNode* Expr, ExprDesc* D)
             if (AddrSize != ADDR_SIZE_DEFAULT) {
                 D->AddrSize = AddrSize;
             }
+
+            /* Cache the result at the symbol for further studies in this
+            ** resolution state.
+            */
+            if (Store) {
+                CacheStore (&Sym->Study, D);
+            }
         }
 
     } else if (SymIsImport (Sym)) {
@@ -1563,3 +1673,14 @@ void StudyExpr (ExprNode* Expr, ExprDesc* D)
     printf ("%u sections:\n", D->SecCount);
 #endif
 }
+
+
+
+void InvalidateStudyCache (void)
+/* Invalidate the study results cached at symbol entries. Must be called
+** whenever the resolution state of a symbol changes, since studies done
+** before the change may classify an expression differently.
+*/
+{
+    StudyGeneration += 2;
+}
@@ -115,6 +115,15 @@ int ED_IsConst (const ExprDesc* ED);
 void StudyExpr (ExprNode* Expr, ExprDesc* D);
 /* Study an expression tree and place the contents into D */
 
+void InvalidateStudyCache (void);
+/* Invalidate the study results cached at symbol entries. Must be called
+** whenever the resolution state of a symbol changes, since studies done
+** before the change may classify an expression differently.
+*/
+
+unsigned char GetConstAddrSize (long Val);
+/* Get the address size of a constant */
+
 
 
 /* End of studyexpr.h */
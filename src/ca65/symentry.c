@@ -65,6 +65,13 @@ SymEntry* SymList = 0;
 /* Pointer to last defined symbol */
 SymEntry* SymLast = 0;
 
+/* Symbol table entries are never freed, so they are carved out of larger
+** blocks to save the allocator overhead of many small allocations.
+*/
+#define SYM_BLOCK_SIZE  256U
+static SymEntry* SymBlock = 0;                  /* Current block */
+static unsigned SymBlockUsed = SYM_BLOCK_SIZE;  /* Used entries in block */
+
 
 
 /*****************************************************************************/
@@ -77,9 +84,16 @@ SymEntry* NewSymEntry (const StrBuf* Name, unsigned Flags)
 /* Allocate a symbol table entry, initialize and return it */
 {
     unsigned I;
+    SymEntry* S;
 
-    /* Allocate memory */
-    SymEntry* S = xmalloc (sizeof (SymEntry));
+    /* Take the entry from the current block, starting a new block if the
+    ** current one is exhausted.
+    */
+    if (SymBlockUsed >= SYM_BLOCK_SIZE) {
+        SymBlock = xmalloc (SYM_BLOCK_SIZE * sizeof (SymEntry));
+        SymBlockUsed = 0;
+    }
+    S = SymBlock + SymBlockUsed++;
 
     /* Initialize the entry */
     S->Left       = 0;
@@ -97,6 +111,8 @@ SymEntry* NewSymEntry (const StrBuf* Name, unsigned Flags)
     S->ImportId   = ~0U;
     S->ExportId   = ~0U;
     S->Expr       = 0;
+    S->Study      = 0;
+    S->StudyGen   = 0;
     S->ExprRefs   = AUTO_COLLECTION_INITIALIZER;
     S->ExportSize = ADDR_SIZE_DEFAULT;
     S->AddrSize   = ADDR_SIZE_DEFAULT;
@@ -153,6 +169,9 @@ int SymSearchTree (SymEntry* T, const StrBuf* Name, SymEntry** E)
 void SymTransferExprRefs (SymEntry* From, SymEntry* To)
 /* Transfer all expression references from one symbol to another. */
 {
+    /* The resolution state changes, cached expression studies are stale */
+    InvalidateStudyCache ();
+
     unsigned I;
 
     for (I = 0; I < CollCount (&From->ExprRefs); ++I) {
@@ -211,6 +230,9 @@ static void SymReplaceExprRefs (SymEntry* S)
 void SymDef (SymEntry* S, ExprNode* Expr, unsigned char AddrSize, unsigned Flags)
 /* Define a new symbol */
 {
+    /* Cached expression studies are stale now */
+    InvalidateStudyCache ();
+
     if (S->Flags & SF_IMPORT) {
         /* Defined symbol is marked as imported external symbol */
         Error ("Symbol '%m%p' is already an import", GetSymName (S));
@@ -314,6 +336,9 @@ void SymRef (SymEntry* S)
 void SymImport (SymEntry* S, unsigned char AddrSize, unsigned Flags)
 /* Mark the given symbol as an imported symbol */
 {
+    /* Cached expression studies are stale now */
+    InvalidateStudyCache ();
+
     if (S->Flags & SF_DEFINED) {
         Error ("Symbol '%m%p' is already defined", GetSymName (S));
         S->Flags |= SF_MULTDEF;
@@ -366,6 +391,9 @@ void SymImport (SymEntry* S, unsigned char AddrSize, unsigned Flags)
 void SymExport (SymEntry* S, unsigned char AddrSize, unsigned Flags)
 /* Mark the given symbol as an exported symbol */
 {
+    /* Cached expression studies are stale now */
+    InvalidateStudyCache ();
+
     /* Check if it's ok to export the symbol */
     if (S->Flags & SF_IMPORT) {
         /* The symbol is already marked as imported external symbol */
@@ -432,6 +460,9 @@ void SymGlobal (SymEntry* S, unsigned char AddrSize, unsigned Flags)
 ** either imported or exported.
 */
 {
+    /* Cached expression studies are stale now */
+    InvalidateStudyCache ();
+
     if (S->Flags & SF_VAR) {
         /* Variable symbols cannot be exported or imported */
         Error ("Var symbol '%m%p' cannot be made global", GetSymName (S));
@@ -526,6 +557,9 @@ void SymConDes (SymEntry* S, unsigned char AddrSize, unsigned Type, unsigned Pri
 ** mark the symbol as an export. Initializers may never be zero page symbols.
 */
 {
+    /* Cached expression studies are stale now */
+    InvalidateStudyCache ();
+
     /* Check the parameters */
 #if (CD_TYPE_MIN != 0)
     CHECK (Type >= CD_TYPE_MIN && Type <= CD_TYPE_MAX);
@@ -596,6 +630,9 @@ void SymGuessedAddrSize (SymEntry* Sym, unsigned char AddrSize)
 ** is undefined, and absolute addressing was available.
 */
 {
+    /* Cached expression studies are stale now */
+    InvalidateStudyCache ();
+
     /* We must have a valid address size passed */
     PRECONDITION (AddrSize != ADDR_SIZE_DEFAULT);
 
@@ -620,6 +657,9 @@ void SymExportFromGlobal (SymEntry* S)
 ** into an export.
 */
 {
+    /* Cached expression studies are stale now */
+    InvalidateStudyCache ();
+
     /* Remove the global flag and make the symbol an export */
     S->Flags &= ~SF_GLOBAL;
     S->Flags |= SF_EXPORT;
@@ -632,6 +672,9 @@ void SymImportFromGlobal (SymEntry* S)
 ** into an import.
 */
 {
+    /* Cached expression studies are stale now */
+    InvalidateStudyCache ();
+
     /* Remove the global flag and make it an import */
     S->Flags &= ~SF_GLOBAL;
     S->Flags |= SF_IMPORT;
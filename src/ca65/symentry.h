@@ -103,6 +103,8 @@ struct SymEntry {
     unsigned            ImportId;       /* Id of import if this is one */
     unsigned            ExportId;       /* Id of export if this is one */
     struct ExprNode*    Expr;           /* Symbol expression */
+    struct ExprDesc*    Study;          /* Cached study result of Expr */
+    unsigned            StudyGen;       /* Resolution state of the cache */
     Collection          ExprRefs;       /* Expressions using this symbol */
     unsigned char       ExportSize;     /* Export address size */
     unsigned char       AddrSize;       /* Address size of label */
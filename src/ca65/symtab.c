@@ -373,17 +373,16 @@ SymEntry* SymFindLocal (SymEntry* Parent, const StrBuf* Name, SymFindAction Acti
 
 
 
-SymEntry* SymFind (SymTable* Scope, const StrBuf* Name, SymFindAction Action)
-/* Find a new symbol table entry in the given table. If Action contains
-** SYM_ALLOC_NEW and the entry is not found, create a new one. Return the
-** entry found, or the new entry created, or - in case Action is
-** SYM_FIND_EXISTING - return 0.
+static SymEntry* SymFindHashed (SymTable* Scope, const StrBuf* Name,
+                                unsigned NameHash, SymFindAction Action)
+/* Like SymFind below, but the hash over the name is passed in by the caller,
+** so loops that search several scopes for the same name hash it just once.
 */
 {
     SymEntry* S;
 
-    /* Global symbol: Get the hash value for the name */
-    unsigned Hash = HashBuf (Name) % Scope->TableSlots;
+    /* Global symbol: Fold the name hash into the table size */
+    unsigned Hash = NameHash % Scope->TableSlots;
 
     /* Search for the entry */
     int Cmp = SymSearchTree (Scope->Table[Hash], Name, &S);
@@ -425,6 +424,18 @@ SymEntry* SymFind (SymTable* Scope, const StrBuf* Name, SymFindAction Action)
 
 
 
+SymEntry* SymFind (SymTable* Scope, const StrBuf* Name, SymFindAction Action)
+/* Find a new symbol table entry in the given table. If Action contains
+** SYM_ALLOC_NEW and the entry is not found, create a new one. Return the
+** entry found, or the new entry created, or - in case Action is
+** SYM_FIND_EXISTING - return 0.
+*/
+{
+    return SymFindHashed (Scope, Name, HashBuf (Name), Action);
+}
+
+
+
 SymEntry* SymFindAny (SymTable* Scope, const StrBuf* Name)
 /* Find a symbol in the given or any of its parent scopes. The function will
 ** never create a new symbol, since this can only be done in one specific
@@ -478,9 +489,11 @@ static void SymCheckUndefined (SymEntry* S)
     */
     SymEntry* Sym = 0;
     if ((S->Flags & SF_FIXED) == 0) {
+        const StrBuf* Name = GetStrBuf (S->Name);
+        unsigned NameHash = HashBuf (Name);
         SymTable* Tab = GetSymParentScope (S);
         while (Tab) {
-            Sym = SymFind (Tab, GetStrBuf (S->Name), SYM_FIND_EXISTING | SYM_CHECK_ONLY);
+            Sym = SymFindHashed (Tab, Name, NameHash, SYM_FIND_EXISTING | SYM_CHECK_ONLY);
             if (Sym && (Sym->Flags & (SF_DEFINED | SF_IMPORT)) != 0) {
                 /* We've found a symbol in a higher level that is
                 ** either defined in the source, or an import.
@@ -58,6 +58,14 @@
 /* Number of currently pushed token lists */
 static unsigned PushCounter = 0;
 
+/* Free list of token nodes. Macro expansion and .repeat playback allocate
+** and free a node per expanded token, so nodes are recycled here instead of
+** being returned to the heap. The SVal buffers of listed nodes stay
+** allocated, which means that reusing a node normally doesn't reallocate
+** the string value either.
+*/
+static TokNode* FreeNodes = 0;
+
 
 
 /*****************************************************************************/
@@ -69,13 +77,19 @@ static unsigned PushCounter = 0;
 TokNode* NewTokNode (void)
 /* Create and return a token node with the current token value */
 {
+    TokNode* N;
 
-    /* Allocate memory */
-    TokNode* N = xmalloc (sizeof (TokNode));
+    /* Allocate memory, reusing a recycled node if possible */
+    if (FreeNodes) {
+        N = FreeNodes;
+        FreeNodes = N->Next;
+    } else {
+        N = xmalloc (sizeof (TokNode));
+        SB_Init (&N->T.SVal);
+    }
 
     /* Initialize the token contents */
     N->Next     = 0;
-    SB_Init (&N->T.SVal);
     CopyToken (&N->T, &CurTok);
 
     /* Return the node */
@@ -87,8 +101,11 @@ TokNode* NewTokNode (void)
 void FreeTokNode (TokNode* N)
 /* Free the given token node */
 {
-    SB_Done (&N->T.SVal);
-    xfree (N);
+    /* Put the node into the free list for recycling by NewTokNode. The SVal
+    ** buffer is kept, see the comment at the free list.
+    */
+    N->Next = FreeNodes;
+    FreeNodes = N;
 }
 
 
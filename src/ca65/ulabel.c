@@ -43,6 +43,7 @@
 #include "expr.h"
 #include "lineinfo.h"
 #include "scanner.h"
+#include "studyexpr.h"
 #include "ulabel.h"
 
 
@@ -65,6 +66,14 @@ struct ULabel {
 static Collection ULabList      = STATIC_COLLECTION_INITIALIZER;
 static unsigned ULabDefCount    = 0;    /* Number of defined labels */
 
+/* ULabels are never freed individually, so instead of one allocation per
+** label they are carved out of larger blocks. Macro generated code uses
+** unnamed labels densely, which makes the allocation overhead noticeable.
+*/
+#define ULABEL_BLOCK_SIZE       1024    /* Labels per allocation block */
+static ULabel* ULabBlock        = 0;    /* Current allocation block */
+static unsigned ULabBlockUsed   = ULABEL_BLOCK_SIZE; /* Used labels in block */
+
 
 
 /*****************************************************************************/
@@ -78,8 +87,16 @@ static ULabel* NewULabel (ExprNode* Val)
 ** structure is returned.
 */
 {
-    /* Allocate memory for the ULabel structure */
-    ULabel* L = xmalloc (sizeof (ULabel));
+    ULabel* L;
+
+    /* Get memory for the ULabel structure from the current block, starting
+    ** a new block if it is used up.
+    */
+    if (ULabBlockUsed >= ULABEL_BLOCK_SIZE) {
+        ULabBlock = xmalloc (ULABEL_BLOCK_SIZE * sizeof (ULabel));
+        ULabBlockUsed = 0;
+    }
+    L = ULabBlock + ULabBlockUsed++;
 
     /* Initialize the fields */
     L->LineInfos = EmptyCollection;
@@ -153,6 +170,9 @@ ExprNode* ULabRef (int Which)
 void ULabDef (void)
 /* Define an unnamed label at the current PC */
 {
+    /* Cached expression studies are stale now */
+    InvalidateStudyCache ();
+
     if (ULabDefCount < CollCount (&ULabList)) {
         /* We did already have a forward reference to this label, so has
         ** already been generated, but doesn't have a value. Use the current
@@ -38,6 +38,7 @@
 
 /* cc65 */
 #include "asmcode.h"
+#include "codeent.h"
 #include "codeseg.h"
 #include "dataseg.h"
 #include "segments.h"
@@ -94,6 +95,23 @@ void MoveCode (const CodeMark* Start, const CodeMark* End, const CodeMark* Targe
 
 
 
+void MarkUnlikelyBranch (void)
+/* If the last emitted instruction is a conditional branch, mark it as likely
+** taken, meaning that the code that follows it in the fall through path is
+** rarely executed. Used for conditions annotated with __builtin_expect.
+*/
+{
+    unsigned Count = CS_GetEntryCount (CS->Code);
+    if (Count > 0) {
+        CodeEntry* E = CS_GetEntry (CS->Code, Count-1);
+        if ((E->Info & OF_CBRA) != 0) {
+            E->Flags |= CEF_UNLIKELY;
+        }
+    }
+}
+
+
+
 int CodeRangeIsEmpty (const CodeMark* Start, const CodeMark* End)
 /* Return true if the given code range is empty (no code between Start and End) */
 {
@@ -109,6 +127,17 @@ int CodeRangeIsEmpty (const CodeMark* Start, const CodeMark* End)
 
 
 
+int HavePendingCodeLabel (void)
+/* Return true if a code label is waiting to be attached to the next code
+** entry. Code moved to the current position later would end up before the
+** label, so in this case code may not be deferred.
+*/
+{
+    return CS_HavePendingLabel (CS->Code);
+}
+
+
+
 void WriteAsmOutput (void)
 /* Write the final assembler output to the output file */
 {
@@ -79,9 +79,21 @@ void MoveCode (const CodeMark* Start, const CodeMark* End, const CodeMark* Targe
 ** (before) Target. The code marks aren't updated.
 */
 
+void MarkUnlikelyBranch (void);
+/* If the last emitted instruction is a conditional branch, mark it as likely
+** taken, meaning that the code that follows it in the fall through path is
+** rarely executed. Used for conditions annotated with __builtin_expect.
+*/
+
 int CodeRangeIsEmpty (const CodeMark* Start, const CodeMark* End);
 /* Return true if the given code range is empty (no code between Start and End) */
 
+int HavePendingCodeLabel (void);
+/* Return true if a code label is waiting to be attached to the next code
+** entry. Code moved to the current position later would end up before the
+** label, so in this case code may not be deferred.
+*/
+
 void WriteAsmOutput (void);
 /* Write the final assembler output to the output file */
 
@@ -117,8 +117,14 @@ static SymEntry* AsmGetSym (unsigned Arg, unsigned Type)
         return 0;
     }
 
-    /* Mark the symbol as referenced */
+    /* Mark the symbol as referenced. For functions, count the reference so
+    ** that return value usage tracking stays conservative for functions
+    ** used from inline assembly.
+    */
     Sym->Flags |= SC_REF;
+    if ((Sym->Flags & SC_FUNC) == SC_FUNC) {
+        ++Sym->FuncRefs;
+    }
 
     /* Return it */
     return Sym;
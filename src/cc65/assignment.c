@@ -43,6 +43,7 @@
 #include "loadexpr.h"
 #include "scanner.h"
 #include "stdnames.h"
+#include "symentry.h"
 #include "typecmp.h"
 #include "typeconv.h"
 
@@ -231,6 +232,44 @@ void Assignment (ExprDesc* Expr)
         /* Restore the expression type */
         Expr->Type = ltype;
 
+    } else if (ED_IsSoa (Expr)) {
+
+        CodeMark PushPos;
+
+        /* Assignment to an element of an array with split lo/hi byte layout.
+        ** The element index is in the primary register. Save it on the stack
+        ** while the right hand side is evaluated.
+        */
+        unsigned Count = (unsigned) GetElementCount (Expr->Sym->Type);
+        GetCodePos (&PushPos);
+        g_push (CF_CHAR | CF_FORCECHAR | CF_UNSIGNED, 0);
+
+        /* Read the expression on the right side of the '=' */
+        MarkedExprWithCheck (hie1, &Expr2);
+
+        /* Do type conversion if necessary */
+        TypeConversion (&Expr2, ltype);
+
+        /* If the right hand side is constant and no code was generated for
+        ** it, the index is still in the primary and the push of the index
+        ** can be removed.
+        */
+        if (ED_IsConstAbsInt (&Expr2) && ED_CodeRangeIsEmpty (&Expr2)) {
+
+            RemoveCode (&PushPos);
+            g_soa_putind_const (TypeOf (ltype) | CF_EXTERNAL, Expr->Name,
+                                Count, Expr2.IVal);
+
+        } else {
+
+            /* If necessary, load the value into the primary register */
+            LoadExpr (CF_NONE, &Expr2);
+
+            /* Store the value into the two byte planes */
+            g_soa_putind (TypeOf (ltype) | CF_EXTERNAL, Expr->Name, Count);
+
+        }
+
     } else {
 
         /* Get the address on stack if needed */
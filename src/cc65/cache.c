@@ -0,0 +1,446 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                  cache.c                                  */
+/*                                                                           */
+/*                     Compilation cache for the cc65 compiler               */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+/* The cache maps a key built from the command line, the compiler version
+** and the contents of the main input file to the generated output. Since
+** included files contribute to the output but are only known after the
+** input was processed, each cache entry carries a manifest that lists all
+** files read together with their content hashes. An entry is used only if
+** every file in its manifest is unchanged, like the direct mode of other
+** compiler caches.
+*/
+
+
+
+#include <stdio.h>
+#include <string.h>
+
+/* common */
+#include "cmdline.h"
+#include "print.h"
+#include "version.h"
+#include "xmalloc.h"
+
+/* cc65 */
+#include "cache.h"
+#include "input.h"
+#include "output.h"
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* Name of the cache directory, NULL if the cache is not used */
+const char* CacheDir = 0;
+
+/* The key for this compilation in printable form. Valid if HaveKey is set. */
+static char KeyHex[17];
+static int  HaveKey = 0;
+
+/* Content hash. Two independent 32 bit streams are combined into a 64 bit
+** value to make accidental collisions unlikely.
+*/
+typedef struct ContentHash ContentHash;
+struct ContentHash {
+    unsigned long A;
+    unsigned long B;
+};
+
+/* Memoized file hashes. On a cache miss every input file is hashed once
+** when the old manifest is checked and again when the new entry is stored,
+** which reads each header twice. The result of the first pass is remembered
+** here, so no file is read more than once per compilation. The files are
+** assumed not to change while the compiler runs, which the manifest scheme
+** requires anyway.
+*/
+typedef struct HashMemo HashMemo;
+struct HashMemo {
+    HashMemo*   Next;           /* Next entry in hash chain */
+    ContentHash Hash;           /* Content hash of the file */
+    char        Name[1];        /* File name, dynamically sized */
+};
+
+#define MEMO_TAB_SIZE   64U     /* Must be a power of two */
+static HashMemo* MemoTab[MEMO_TAB_SIZE];
+
+
+
+/*****************************************************************************/
+/*                                 Hashing                                   */
+/*****************************************************************************/
+
+
+
+static void HashInit (ContentHash* H)
+/* Initialize a content hash */
+{
+    H->A = 2166136261UL;
+    H->B = 0x84222325UL;
+}
+
+
+
+static void HashData (ContentHash* H, const void* Data, size_t Size)
+/* Add a data block to a content hash. Stream A is plain FNV-1a, stream B
+** uses a different multiplier and an additive constant.
+*/
+{
+    const unsigned char* P = Data;
+    while (Size--) {
+        H->A = ((H->A ^ *P) * 16777619UL) & 0xFFFFFFFFUL;
+        H->B = ((H->B ^ *P) * 0x5BD1E995UL + 0x9E3779B9UL) & 0xFFFFFFFFUL;
+        ++P;
+    }
+}
+
+
+
+static void HashStr (ContentHash* H, const char* S)
+/* Add a string including the terminator to a content hash, so adjacent
+** strings cannot run into each other.
+*/
+{
+    HashData (H, S, strlen (S) + 1);
+}
+
+
+
+static int HashFile (ContentHash* H, const char* Name)
+/* Add the contents of a file to a content hash. Return false if the file
+** could not be read.
+*/
+{
+    char Buf[4096];
+    size_t Size;
+
+    FILE* F = fopen (Name, "rb");
+    if (F == 0) {
+        return 0;
+    }
+    while ((Size = fread (Buf, 1, sizeof (Buf), F)) > 0) {
+        HashData (H, Buf, Size);
+    }
+    if (ferror (F)) {
+        fclose (F);
+        return 0;
+    }
+    fclose (F);
+    return 1;
+}
+
+
+
+static int HashFileMemo (ContentHash* H, const char* Name)
+/* Like HashFile, but consult and fill the memo table, so a file already
+** hashed in this compilation is not read again.
+*/
+{
+    HashMemo** Slot;
+    HashMemo* M;
+    unsigned SlotIdx;
+    const char* P;
+
+    /* Find the hash chain for the name */
+    SlotIdx = 0;
+    for (P = Name; *P != '\0'; ++P) {
+        SlotIdx = SlotIdx * 33 + (unsigned char) *P;
+    }
+    Slot = &MemoTab[SlotIdx & (MEMO_TAB_SIZE - 1)];
+
+    /* Search for an existing entry */
+    for (M = *Slot; M != 0; M = M->Next) {
+        if (strcmp (M->Name, Name) == 0) {
+            *H = M->Hash;
+            return 1;
+        }
+    }
+
+    /* Not known, hash the file */
+    HashInit (H);
+    if (!HashFile (H, Name)) {
+        return 0;
+    }
+
+    /* Remember the result */
+    M = xmalloc (sizeof (HashMemo) + strlen (Name));
+    M->Hash = *H;
+    strcpy (M->Name, Name);
+    M->Next = *Slot;
+    *Slot   = M;
+    return 1;
+}
+
+
+
+static void HashHex (const ContentHash* H, char* Buf)
+/* Place the printable form of a content hash into Buf (17 bytes) */
+{
+    sprintf (Buf, "%08lX%08lX", H->A, H->B);
+}
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+static char* CachePath (const char* Ext)
+/* Build the name of a cache file with the given extension. The result is
+** allocated on the heap.
+*/
+{
+    char* Path = xmalloc (strlen (CacheDir) + 1 + sizeof (KeyHex) + strlen (Ext));
+    sprintf (Path, "%s/%s%s", CacheDir, KeyHex, Ext);
+    return Path;
+}
+
+
+
+static int CopyFile (const char* From, const char* To)
+/* Copy a file. Return false on errors. */
+{
+    char Buf[4096];
+    size_t Size;
+    int OK = 1;
+    FILE* In;
+    FILE* Out;
+
+    In = fopen (From, "rb");
+    if (In == 0) {
+        return 0;
+    }
+    Out = fopen (To, "wb");
+    if (Out == 0) {
+        fclose (In);
+        return 0;
+    }
+    while ((Size = fread (Buf, 1, sizeof (Buf), In)) > 0) {
+        if (fwrite (Buf, 1, Size, Out) != Size) {
+            OK = 0;
+            break;
+        }
+    }
+    if (ferror (In)) {
+        OK = 0;
+    }
+    fclose (In);
+    if (fclose (Out) != 0) {
+        OK = 0;
+    }
+    return OK;
+}
+
+
+
+void CacheSetKey (const char* Input)
+/* Compute the cache key for the given main input file and the current
+** command line. If the input file cannot be read, the cache is disabled
+** for this compilation.
+*/
+{
+    ContentHash H;
+    unsigned I;
+
+    HashInit (&H);
+
+    /* The compiler version is part of the key, so an update invalidates
+    ** the cache.
+    */
+    HashStr (&H, GetVersionAsString ());
+
+    /* All command line arguments are part of the key. This includes some
+    ** arguments that don't change the output, at the price of a few
+    ** unnecessary cache misses.
+    */
+    for (I = 1; I < ArgCount; ++I) {
+        HashStr (&H, ArgVec[I]);
+    }
+
+    /* The contents of the main file complete the key */
+    if (!HashFile (&H, Input)) {
+        return;
+    }
+
+    HashHex (&H, KeyHex);
+    HaveKey = 1;
+}
+
+
+
+int CacheLookup (void)
+/* Check if the cache holds output for the current key and if all input
+** files recorded with it are unchanged. If so, copy the cached output to
+** the output file and return true. Return false otherwise.
+*/
+{
+    char Line[1024];
+    char* Path;
+    FILE* F;
+    int Hit = 1;
+
+    /* Bail out if we have no key */
+    if (!HaveKey) {
+        return 0;
+    }
+
+    /* Open the manifest of the entry */
+    Path = CachePath (".d");
+    F = fopen (Path, "r");
+    xfree (Path);
+    if (F == 0) {
+        return 0;
+    }
+
+    /* Each line holds the content hash and the name of one input file.
+    ** All files must hash to the recorded values.
+    */
+    while (Hit && fgets (Line, sizeof (Line), F) != 0) {
+
+        ContentHash H;
+        char Hex[17];
+        char* Name;
+        unsigned Len;
+
+        /* Split the line into hash and file name */
+        Len = strlen (Line);
+        if (Len > 0 && Line[Len-1] == '\n') {
+            Line[Len-1] = '\0';
+        }
+        if (Len < 18) {
+            /* Damaged manifest */
+            Hit = 0;
+            break;
+        }
+        Name = Line + 17;
+
+        /* Compare the recorded hash against the current file contents */
+        if (!HashFileMemo (&H, Name)) {
+            Hit = 0;
+            break;
+        }
+        HashHex (&H, Hex);
+        if (strncmp (Line, Hex, 16) != 0) {
+            Hit = 0;
+        }
+    }
+    fclose (F);
+
+    /* If all inputs are unchanged, use the cached output */
+    if (Hit) {
+        Path = CachePath (".s");
+        Hit = CopyFile (Path, OutputFilename);
+        xfree (Path);
+    }
+
+    if (Hit) {
+        Print (stdout, 1, "Cache hit for '%s'\n", OutputFilename);
+    }
+    return Hit;
+}
+
+
+
+void CacheStore (void)
+/* Store the output file together with the list of all input files read in
+** the cache. Errors are ignored since the cache is only an accelerator.
+*/
+{
+    char* Path;
+    char* TmpPath;
+    FILE* F;
+    unsigned I;
+    unsigned Count;
+    int OK;
+
+    /* Bail out if we have no key */
+    if (!HaveKey) {
+        return;
+    }
+
+    /* The files are written under a temporary name first and moved into
+    ** place afterwards, so a parallel build never sees a partial entry.
+    ** Two processes storing the same key write identical contents, so a
+    ** shared temporary name is harmless.
+    */
+
+    /* Store the output file */
+    Path    = CachePath (".s");
+    TmpPath = CachePath (".s.tmp");
+    if (CopyFile (OutputFilename, TmpPath)) {
+        remove (Path);
+        rename (TmpPath, Path);
+    } else {
+        remove (TmpPath);
+        xfree (Path);
+        xfree (TmpPath);
+        return;
+    }
+    xfree (Path);
+    xfree (TmpPath);
+
+    /* Write the manifest */
+    Path    = CachePath (".d");
+    TmpPath = CachePath (".d.tmp");
+    F = fopen (TmpPath, "w");
+    OK = (F != 0);
+    Count = GetInputFileCount ();
+    for (I = 0; OK && I < Count; ++I) {
+
+        ContentHash H;
+        char Hex[17];
+        const char* Name = GetInputFileName (I);
+
+        /* Hash the file and write the manifest line */
+        if (!HashFileMemo (&H, Name)) {
+            OK = 0;
+            break;
+        }
+        HashHex (&H, Hex);
+        fprintf (F, "%s %s\n", Hex, Name);
+    }
+    if (F != 0) {
+        if (fclose (F) != 0) {
+            OK = 0;
+        }
+        if (OK) {
+            remove (Path);
+            rename (TmpPath, Path);
+        } else {
+            remove (TmpPath);
+        }
+    }
+    xfree (Path);
+    xfree (TmpPath);
+}
@@ -0,0 +1,73 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                  cache.h                                  */
+/*                                                                           */
+/*                     Compilation cache for the cc65 compiler               */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#ifndef CACHE_H
+#define CACHE_H
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* Name of the cache directory, NULL if the cache is not used */
+extern const char* CacheDir;
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+void CacheSetKey (const char* Input);
+/* Compute the cache key for the given main input file and the current
+** command line. If the input file cannot be read, the cache is disabled
+** for this compilation.
+*/
+
+int CacheLookup (void);
+/* Check if the cache holds output for the current key and if all input
+** files recorded with it are unchanged. If so, copy the cached output to
+** the output file and return true. Return false otherwise.
+*/
+
+void CacheStore (void);
+/* Store the output file together with the list of all input files read in
+** the cache. Errors are ignored since the cache is only an accelerator.
+*/
+
+
+
+/* End of cache.h */
+
+#endif
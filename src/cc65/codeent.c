@@ -34,11 +34,13 @@
 
 
 #include <stdlib.h>
+#include <string.h>
 
 /* common */
 #include "chartype.h"
 #include "check.h"
 #include "debugflag.h"
+#include "hashfunc.h"
 #include "xmalloc.h"
 #include "xsprintf.h"
 
@@ -62,6 +64,29 @@
 /* Empty argument */
 static char EmptyArg[] = "";
 
+/* Free list of code entry structs. The optimizer creates and deletes
+** thousands of entries per function, so instead of returning the memory to
+** the heap, deleted entries are kept here and recycled by NewCodeEntry. The
+** JumpTo field is used to link the entries in the list.
+*/
+static CodeEntry* FreeEntries = 0;
+
+/* Interned argument strings. Arguments repeat heavily (zero page register
+** names, runtime function names, small constants), so instead of copying
+** each one with xstrdup, identical arguments share one interned copy that
+** lives until the end of the compilation. As a consequence, entries with
+** equal arguments have pointer equal Arg fields, which makes the argument
+** comparison in CodeEntriesAreEqual a pointer check.
+*/
+typedef struct ArgEntry ArgEntry;
+struct ArgEntry {
+    ArgEntry*   Next;               /* Next entry in hash chain */
+    char        Arg[1];             /* Argument string, dynamically sized */
+};
+
+#define ARG_TAB_SIZE    1024U       /* Must be a power of two */
+static ArgEntry* ArgTab[ARG_TAB_SIZE];
+
 
 
 /*****************************************************************************/
@@ -70,26 +95,33 @@ static char EmptyArg[] = "";
 
 
 
-static void FreeArg (char* Arg)
-/* Free a code entry argument */
-{
-    if (Arg != EmptyArg) {
-        xfree (Arg);
-    }
-}
-
-
-
 static char* GetArgCopy (const char* Arg)
-/* Create an argument copy for assignment */
+/* Return the interned copy for the given argument */
 {
-    if (Arg && Arg[0] != '\0') {
-        /* Create a copy */
-        return xstrdup (Arg);
-    } else {
+    ArgEntry** Slot;
+    ArgEntry*  A;
+    unsigned   Len;
+
+    if (Arg == 0 || Arg[0] == '\0') {
         /* Use the empty argument string */
         return EmptyArg;
     }
+
+    /* Search the intern table */
+    Slot = &ArgTab[HashStr (Arg) & (ARG_TAB_SIZE - 1)];
+    for (A = *Slot; A != 0; A = A->Next) {
+        if (strcmp (A->Arg, Arg) == 0) {
+            return A->Arg;
+        }
+    }
+
+    /* Not found, create a new entry */
+    Len = strlen (Arg);
+    A = xmalloc (sizeof (ArgEntry) + Len);
+    memcpy (A->Arg, Arg, Len + 1);
+    A->Next = *Slot;
+    *Slot   = A;
+    return A->Arg;
 }
 
 
@@ -238,8 +270,14 @@ CodeEntry* NewCodeEntry (opc_t OPC, am_t AM, const char* Arg,
     /* Get the opcode description */
     const OPCDesc* D = GetOPCDesc (OPC);
 
-    /* Allocate memory */
-    CodeEntry* E = xmalloc (sizeof (CodeEntry));
+    /* Allocate memory, reusing a recycled entry if possible */
+    CodeEntry* E;
+    if (FreeEntries) {
+        E = FreeEntries;
+        FreeEntries = (CodeEntry*) E->JumpTo;
+    } else {
+        E = xmalloc (sizeof (CodeEntry));
+    }
 
     /* Initialize the fields */
     E->OPC    = D->OPC;
@@ -249,6 +287,7 @@ CodeEntry* NewCodeEntry (opc_t OPC, am_t AM, const char* Arg,
     E->Flags  = NumArg (E->Arg, &E->Num)? CEF_NUMARG : 0;   /* Needs E->Arg */
     E->Info   = D->Info;
     E->JumpTo = JumpTo;
+    E->RefIndex = 0;
     E->LI     = UseLineInfo (LI);
     E->RI     = 0;
     SetUseChgInfo (E, D);
@@ -256,6 +295,7 @@ CodeEntry* NewCodeEntry (opc_t OPC, am_t AM, const char* Arg,
 
     /* If we have a label given, add this entry to the label */
     if (JumpTo) {
+        E->RefIndex = CollCount (&JumpTo->JumpFrom);
         CollAppend (&JumpTo->JumpFrom, E);
     }
 
@@ -268,8 +308,7 @@ CodeEntry* NewCodeEntry (opc_t OPC, am_t AM, const char* Arg,
 void FreeCodeEntry (CodeEntry* E)
 /* Free the given code entry */
 {
-    /* Free the string argument if we have one */
-    FreeArg (E->Arg);
+    /* The string argument is interned and shared, so it is not freed */
 
     /* Cleanup the collection */
     DoneCollection (&E->Labels);
@@ -280,8 +319,9 @@ void FreeCodeEntry (CodeEntry* E)
     /* Delete the register info */
     CE_FreeRegInfo (E);
 
-    /* Free the entry */
-    xfree (E);
+    /* Put the entry into the free list for recycling by NewCodeEntry */
+    E->JumpTo = (CodeLabel*) FreeEntries;
+    FreeEntries = E;
 }
 
 
@@ -306,7 +346,8 @@ void CE_ReplaceOPC (CodeEntry* E, opc_t OPC)
 int CodeEntriesAreEqual (const CodeEntry* E1, const CodeEntry* E2)
 /* Check if both code entries are equal */
 {
-    return (E1->OPC == E2->OPC && E1->AM == E2->AM && strcmp (E1->Arg, E2->Arg) == 0);
+    /* Arguments are interned, so a pointer check is sufficient */
+    return (E1->OPC == E2->OPC && E1->AM == E2->AM && E1->Arg == E2->Arg);
 }
 
 
@@ -332,8 +373,7 @@ void CE_ClearJumpTo (CodeEntry* E)
     /* Clear the JumpTo entry */
     E->JumpTo = 0;
 
-    /* Clear the argument and assign the empty one */
-    FreeArg (E->Arg);
+    /* Assign the empty argument */
     E->Arg = EmptyArg;
 }
 
@@ -355,10 +395,7 @@ void CE_MoveLabel (CodeLabel* L, CodeEntry* E)
 void CE_SetArg (CodeEntry* E, const char* Arg)
 /* Replace the argument by the new one. */
 {
-    /* Free the old argument */
-    FreeArg (E->Arg);
-
-    /* Assign the new one */
+    /* Assign the new one; the old one is interned and shared */
     E->Arg = GetArgCopy (Arg);
 
     /* Update the Use and Chg in E */
@@ -1329,10 +1366,18 @@ void CE_GenRegInfo (CodeEntry* E, RegContents* InputRegs)
         case OP65_TXS:
             break;
 
+        case OP65_TXY:
+            Out->RegY = In->RegX;
+            break;
+
         case OP65_TYA:
             Out->RegA = In->RegY;
             break;
 
+        case OP65_TYX:
+            Out->RegX = In->RegY;
+            break;
+
         default:
             break;
 
@@ -1399,18 +1444,25 @@ void CE_Output (const CodeEntry* E)
     int Space;
     const char* Target;
 
-    /* If we have a label, print that */
+    /* If we have a label, print that. ca65 accepts only one label per line,
+    ** so each one but the last goes onto a line of its own.
+    */
     unsigned LabelCount = CollCount (&E->Labels);
     unsigned I;
     for (I = 0; I < LabelCount; ++I) {
-        CL_Output (CollConstAt (&E->Labels, I));
+        const CodeLabel* L = CollConstAt (&E->Labels, I);
+        CL_Output (L);
+        if (I + 1 < LabelCount && strlen (L->Name) <= 6) {
+            WriteOutputStr ("\n");
+        }
     }
 
     /* Get the opcode description */
     D = GetOPCDesc (E->OPC);
 
     /* Print the mnemonic */
-    Chars = WriteOutput ("\t%s", D->Mnemo);
+    Chars = WriteOutputStr ("\t");
+    Chars += WriteOutputStr (D->Mnemo);
 
     /* Space to leave before the operand */
     Space = 9 - Chars;
@@ -1475,6 +1527,14 @@ void CE_Output (const CodeEntry* E)
 
     }
 
+    /* Print size and cycle estimates if requested */
+    if (AddCycles) {
+        Chars += WriteOutput ("%*s; %u/%u",
+                              (int)(30-Chars), "",
+                              E->Size,
+                              GetInsnCycles (E->OPC, E->AM));
+    }
+
     /* Print usage info if requested by the debugging flag */
     if (Debug) {
         char Use [128];
@@ -1495,5 +1555,5 @@ void CE_Output (const CodeEntry* E)
     }
 
     /* Terminate the line */
-    WriteOutput ("\n");
+    WriteOutputStr ("\n");
 }
@@ -62,6 +62,7 @@
 #define CEF_USERMARK    0x0001U         /* Generic mark by user functions */
 #define CEF_NUMARG      0x0002U         /* Insn has numerical argument */
 #define CEF_DONT_REMOVE 0x0004U         /* Insn shouldn't be removed, marked by user functions */
+#define CEF_UNLIKELY    0x0008U         /* Cond branch is likely taken, fall through is cold */
 
 /* Code entry structure */
 typedef struct CodeEntry CodeEntry;
@@ -76,6 +77,7 @@ struct CodeEntry {
     unsigned short      Use;            /* Registers used */
     unsigned short      Chg;            /* Registers changed/destroyed */
     CodeLabel*          JumpTo;         /* Jump label */
+    unsigned            RefIndex;       /* Index in JumpTo->JumpFrom */
     Collection          Labels;         /* Labels for this instruction */
     LineInfo*           LI;             /* Source line info for this insn */
     RegInfo*            RI;             /* Register info for this insn */
@@ -40,6 +40,7 @@
 /* common */
 #include "check.h"
 #include "cpu.h"
+#include "hashfunc.h"
 #include "inttypes.h"
 #include "strbuf.h"
 #include "xmalloc.h"
@@ -50,10 +51,15 @@
 #include "asmcode.h"
 #include "asmlabel.h"
 #include "casenode.h"
+#include "codeent.h"
+#include "codelab.h"
 #include "codeseg.h"
 #include "dataseg.h"
 #include "error.h"
+#include "function.h"
 #include "global.h"
+#include "globfold.h"
+#include "ident.h"
 #include "segments.h"
 #include "stackptr.h"
 #include "stdfunc.h"
@@ -899,6 +905,22 @@ void g_getind (unsigned Flags, unsigned Offs)
 
 
 
+void g_soa_getind (unsigned Flags, uintptr_t Label, unsigned Count)
+/* Fetch an element of an array with split lo/hi byte layout into the primary
+** register. The element index is in the primary, the array holds Count
+** elements, so the hi byte plane starts Count bytes behind the label.
+*/
+{
+    AddCodeLine ("tay");
+    AddCodeLine ("ldx %s,y", GetLabelName (Flags, Label, Count));
+    AddCodeLine ("lda %s,y", GetLabelName (Flags, Label, 0));
+    if (Flags & CF_TEST) {
+        g_test (Flags);
+    }
+}
+
+
+
 void g_leasp (int Offs)
 /* Fetch the address of the specified symbol into the primary register */
 {
@@ -1181,6 +1203,44 @@ void g_putind (unsigned Flags, unsigned Offs)
 
 
 
+void g_soa_putind (unsigned Flags, uintptr_t Label, unsigned Count)
+/* Store the primary register into an element of an array with split lo/hi
+** byte layout. The element index has been pushed onto the stack as a single
+** byte and is dropped. The value remains in the primary register.
+*/
+{
+    AddCodeLine ("sta tmp1");
+    AddCodeLine ("ldy #$00");
+    AddCodeLine ("lda (sp),y");
+    AddCodeLine ("tay");
+    AddCodeLine ("txa");
+    AddCodeLine ("sta %s,y", GetLabelName (Flags, Label, Count));
+    AddCodeLine ("lda tmp1");
+    AddCodeLine ("sta %s,y", GetLabelName (Flags, Label, 0));
+
+    /* Drop the index byte */
+    g_drop (1);
+    pop (CF_CHAR | CF_FORCECHAR);
+}
+
+
+
+void g_soa_putind_const (unsigned Flags, uintptr_t Label, unsigned Count, unsigned long Val)
+/* Store the constant value Val into an element of an array with split lo/hi
+** byte layout. The element index is in the primary register. The value is
+** loaded into the primary register.
+*/
+{
+    AddCodeLine ("tay");
+    AddCodeLine ("lda #$%02X", (unsigned char) (Val >> 8));
+    AddCodeLine ("sta %s,y", GetLabelName (Flags, Label, Count));
+    AddCodeLine ("lda #$%02X", (unsigned char) Val);
+    AddCodeLine ("sta %s,y", GetLabelName (Flags, Label, 0));
+    AddCodeLine ("ldx #$%02X", (unsigned char) (Val >> 8));
+}
+
+
+
 /*****************************************************************************/
 /*                    type conversion and similiar stuff                     */
 /*****************************************************************************/
@@ -2329,6 +2389,16 @@ void g_call (unsigned Flags, const char* Label, unsigned ArgSize)
         /* Pass the argument count */
         AddCodeLine ("ldy #$%02X", ArgSize);
     }
+
+    /* Record the call for the stack usage annotation. The stack pointer
+    ** still includes the pushed arguments here.
+    */
+    if (StackUsage) {
+        char Buf[IDENTSIZE+2];
+        xsprintf (Buf, sizeof (Buf), "_%s", Label);
+        F_RecordCall (CurrentFunc, Buf);
+    }
+
     AddCodeLine ("jsr _%s", Label);
     StackPtr += ArgSize;                /* callee pops args */
 }
@@ -2360,6 +2430,11 @@ void g_callind (unsigned Flags, unsigned ArgSize, int Offs)
         AddCodeLine ("jsr jmpvec");
     }
 
+    /* The target of the call is unknown to the stack usage annotation */
+    if (StackUsage) {
+        F_RecordCall (CurrentFunc, "*");
+    }
+
     /* Callee pops args */
     StackPtr += ArgSize;
 }
@@ -2524,7 +2599,9 @@ void g_mul (unsigned flags, unsigned long val)
         "tosmulax", "tosumulax", "tosmuleax", "tosumuleax"
     };
 
-    int p2;
+    int           p2;
+    unsigned long Odd;
+    unsigned      Shift;
 
     /* Do strength reduction if the value is constant and a power of two */
     if (flags & CF_CONST && (p2 = PowerOf2 (val)) >= 0) {
@@ -2577,6 +2654,32 @@ void g_mul (unsigned flags, unsigned long val)
                             AddCodeLine ("asl a");
                             return;
                     }
+
+                    /* Decompose other values into one of the sequences from
+                    ** above followed by a left shift (e.g. 12 = 3 << 2).
+                    ** This is always cheaper than the generic multiplication.
+                    */
+                    if (val != 0) {
+                        Odd   = val;
+                        Shift = 0;
+                        while ((Odd & 0x01) == 0) {
+                            Odd >>= 1;
+                            ++Shift;
+                        }
+                        if (Odd == 3 || Odd == 5) {
+                            AddCodeLine ("sta tmp1");
+                            AddCodeLine ("asl a");
+                            if (Odd == 5) {
+                                AddCodeLine ("asl a");
+                            }
+                            AddCodeLine ("clc");
+                            AddCodeLine ("adc tmp1");
+                            while (Shift--) {
+                                AddCodeLine ("asl a");
+                            }
+                            return;
+                        }
+                    }
                 }
                 /* FALLTHROUGH */
 
@@ -2601,6 +2704,26 @@ void g_mul (unsigned flags, unsigned long val)
                         AddCodeLine ("jsr mulax10");
                         return;
                 }
+
+                /* Decompose other values into a call to one of the helpers
+                ** above followed by a left shift (e.g. 320 = 5 << 6). Both
+                ** the helpers and the shift routines are much cheaper than
+                ** the generic multiplication, which also needs the lhs
+                ** pushed on the stack.
+                */
+                if (val != 0) {
+                    Odd   = val;
+                    Shift = 0;
+                    while ((Odd & 0x01) == 0) {
+                        Odd >>= 1;
+                        ++Shift;
+                    }
+                    if (Odd == 3 || Odd == 5 || Odd == 7 || Odd == 9) {
+                        AddCodeLine ("jsr mulax%lu", Odd);
+                        g_asl (flags, Shift);
+                        return;
+                    }
+                }
                 break;
 
             case CF_LONG:
@@ -4208,16 +4331,24 @@ void g_defdata (unsigned flags, unsigned long val, long offs)
         /* Numeric constant */
         switch (flags & CF_TYPEMASK) {
 
-            case CF_CHAR:
-                AddDataLine ("\t.byte\t$%02lX", val & 0xFF);
+            case CF_CHAR: {
+                /* Add the byte in raw form, so consecutive byte sized data
+                ** accumulates and is formatted in one step on output.
+                */
+                unsigned char B = (unsigned char) (val & 0xFF);
+                AddDataBytes (&B, 1);
+                GF_InitData (val, 1);
                 break;
+            }
 
             case CF_INT:
                 AddDataLine ("\t.word\t$%04lX", val & 0xFFFF);
+                GF_InitData (val, 2);
                 break;
 
             case CF_LONG:
                 AddDataLine ("\t.dword\t$%08lX", val & 0xFFFFFFFF);
+                GF_InitData (val, 4);
                 break;
 
             default:
@@ -4234,6 +4365,12 @@ void g_defdata (unsigned flags, unsigned long val, long offs)
         /* Labels are always 16 bit */
         AddDataLine ("\t.addr\t%s", Label);
 
+        /* The value is only known at link time */
+        GF_InitUnknown (2);
+        if ((flags & CF_ADDRMASK) == CF_EXTERNAL) {
+            GF_InitAddrRef ((const char*) (uintptr_t) val);
+        }
+
     }
 }
 
@@ -4242,35 +4379,11 @@ void g_defdata (unsigned flags, unsigned long val, long offs)
 void g_defbytes (const void* Bytes, unsigned Count)
 /* Output a row of bytes as a constant */
 {
-    unsigned Chunk;
-    char Buf [128];
-    char* B;
-
-    /* Cast the buffer pointer */
-    const unsigned char* Data = (const unsigned char*) Bytes;
-
-    /* Output the stuff */
-    while (Count) {
-
-        /* How many go into this line? */
-        if ((Chunk = Count) > 16) {
-            Chunk = 16;
-        }
-        Count -= Chunk;
-
-        /* Output one line */
-        strcpy (Buf, "\t.byte\t");
-        B = Buf + 7;
-        do {
-            B += sprintf (B, "$%02X", *Data++);
-            if (--Chunk) {
-                *B++ = ',';
-            }
-        } while (Chunk);
-
-        /* Output the line */
-        AddDataLine ("%s", Buf);
-    }
+    /* Add the bytes in raw form. They are formatted in one step when the
+    ** data segment is output.
+    */
+    AddDataBytes (Bytes, Count);
+    GF_InitBytes (Bytes, Count);
 }
 
 
@@ -4280,6 +4393,7 @@ void g_zerobytes (unsigned Count)
 {
     if (Count > 0) {
         AddDataLine ("\t.res\t%u,$00", Count);
+        GF_InitZero (Count);
     }
 }
 
@@ -4365,14 +4479,279 @@ void g_initstatic (unsigned InitLabel, unsigned VarLabel, unsigned Size)
 
 
 
+/* Tunables for the jump table strategy. A table is only used if it has at
+** least CASE_TABLE_MIN_LABELS case labels, at most CASE_TABLE_MAX_SIZE slots
+** and at least half of the slots are actually used. The slot count limit
+** comes from the indexed access: The scaled index must fit into one byte.
+*/
+#define CASE_TABLE_MIN_LABELS   8
+#define CASE_TABLE_MAX_SIZE     128
+
+
+
+static int CollectCaseLabels (Collection* Nodes, unsigned long Val, unsigned Depth,
+                              unsigned long* Values, unsigned* Labels, unsigned* Count)
+/* Collect the value/label pairs from a CaseNode tree. Val contains the case
+** value bytes collected from the outer tree levels. Return false if there
+** are more than CASE_TABLE_MAX_SIZE case labels, return true otherwise.
+*/
+{
+    unsigned I;
+    for (I = 0; I < CollCount (Nodes); ++I) {
+
+        /* Get the next case node and add its byte to the value */
+        CaseNode* N = CollAtUnchecked (Nodes, I);
+        unsigned long V = (Val << 8) | CN_GetValue (N);
+
+        if (Depth == 1) {
+            /* Leaf level, remember the value and its label */
+            if (*Count >= CASE_TABLE_MAX_SIZE) {
+                return 0;
+            }
+            Values[*Count] = V;
+            Labels[*Count] = CN_GetLabel (N);
+            ++*Count;
+        } else {
+            /* Collect the next level */
+            if (!CollectCaseLabels (N->Nodes, V, Depth-1, Values, Labels, Count)) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+
+
+static CodeLabel* FindCaseTarget (unsigned Label)
+/* Find the code label with the given label number and resolve it to the
+** label that will survive label merging. Return NULL if the label cannot
+** be used as a jump table target.
+*/
+{
+    /* Search the label by name */
+    const char* Name = LocalLabelName (Label);
+    CodeLabel* L = CS_FindLabel (CS->Code, Name, HashStr (Name) % CS_LABEL_HASH_SIZE);
+
+    /* The label must be attached to an insn, otherwise we cannot tell which
+    ** label CS_MergeLabels will keep for this position.
+    */
+    if (L == 0 || L->Owner == 0) {
+        return 0;
+    }
+
+    /* CS_MergeLabels will keep the first label of the owner and redirect all
+    ** others (think "case 1: case 2:"), so reference that one in the table.
+    */
+    return CE_GetLabel (L->Owner, 0);
+}
+
+
+
+static int g_casetable (Collection* Nodes, unsigned DefaultLabel, unsigned Depth)
+/* Try to generate a jump table for a switch statement. The table is emitted
+** into the read only data segment and holds the address of the case label
+** for each selector value in the covered range; the selector is checked
+** against the range and then used as index into the table. Return true if
+** the table was emitted, return false if the case values are not dense
+** enough, so the caller has to emit a compare cascade instead.
+*/
+{
+    unsigned long Values[CASE_TABLE_MAX_SIZE];  /* Case values */
+    unsigned      Labels[CASE_TABLE_MAX_SIZE];  /* Case label numbers */
+    CodeLabel*    Slots[CASE_TABLE_MAX_SIZE];   /* Table slot targets */
+    unsigned      Count = 0;                    /* Number of case labels */
+    unsigned long SignBit;                      /* Sign bit of the selector */
+    unsigned long Mask;                         /* Value mask for the selector */
+    unsigned long UMin, UMax;                   /* Unsigned value range */
+    long          SMin, SMax;                   /* Signed value range */
+    unsigned long USize, SSize;                 /* Size of both ranges */
+    unsigned long Base;                         /* Value of the first slot */
+    unsigned long Size;                         /* Number of table slots */
+    unsigned      TableLabel;                   /* Label for the table itself */
+    CodeEntry*    E;                            /* The dispatching jump insn */
+    unsigned      I, J;
+
+    /* The indexed dispatch handles only char and int sized selectors. For
+    ** long selectors, the caller compares the high bytes first and recurses,
+    ** so the low word of a long switch may still end up here.
+    */
+    if (Depth > 2) {
+        return 0;
+    }
+
+    /* Collect the case values and their labels from the tree */
+    if (!CollectCaseLabels (Nodes, 0, Depth, Values, Labels, &Count)) {
+        return 0;
+    }
+    if (Count < CASE_TABLE_MIN_LABELS) {
+        return 0;
+    }
+
+    /* Determine the covered value range. Since we don't know if the selector
+    ** is signed or unsigned, try both interpretations and use the smaller
+    ** range. The index computation below is done modulo the selector size,
+    ** so it is correct for either signedness as long as the range fits.
+    */
+    SignBit = 1UL << (Depth * 8 - 1);
+    Mask    = (SignBit << 1) - 1;
+    UMin = UMax = Values[0];
+    SMin = SMax = (long) (Values[0] ^ SignBit) - (long) SignBit;
+    for (I = 1; I < Count; ++I) {
+        unsigned long V = Values[I];
+        long          S = (long) (V ^ SignBit) - (long) SignBit;
+        if (V < UMin) {
+            UMin = V;
+        }
+        if (V > UMax) {
+            UMax = V;
+        }
+        if (S < SMin) {
+            SMin = S;
+        }
+        if (S > SMax) {
+            SMax = S;
+        }
+    }
+    USize = UMax - UMin + 1;
+    SSize = (unsigned long) (SMax - SMin) + 1;
+    if (USize <= SSize) {
+        Base = UMin;
+        Size = USize;
+    } else {
+        Base = (unsigned long) SMin & Mask;
+        Size = SSize;
+    }
+
+    /* Check table size and density */
+    if (Size > CASE_TABLE_MAX_SIZE || Size > 2UL * Count) {
+        return 0;
+    }
+
+    /* Resolve the case labels to their table targets. Bail out and leave the
+    ** work to the compare cascade if a label cannot be resolved.
+    */
+    for (I = 0; I < Size; ++I) {
+        Slots[I] = 0;
+    }
+    for (I = 0; I < Count; ++I) {
+        CodeLabel* L = FindCaseTarget (Labels[I]);
+        if (L == 0) {
+            return 0;
+        }
+        Slots[(Values[I] - Base) & Mask] = L;
+    }
+
+    /* Get a label for the table */
+    TableLabel = GetLocalLabel ();
+
+    /* Output the range check. Subtracting the base value maps the covered
+    ** range to 0..Size-1, any other selector yields an index >= Size (the
+    ** subtraction is modulo the selector size, see above).
+    */
+    if (Depth == 2) {
+        if (Base != 0) {
+            AddCodeLine ("sec");
+            AddCodeLine ("sbc #$%02X", (unsigned char) Base);
+            AddCodeLine ("tay");
+            AddCodeLine ("txa");
+            AddCodeLine ("sbc #$%02X", (unsigned char) (Base >> 8));
+            AddCodeLine ("jne %s", LocalLabelName (DefaultLabel));
+            AddCodeLine ("tya");
+        } else {
+            AddCodeLine ("cpx #$00");
+            AddCodeLine ("jne %s", LocalLabelName (DefaultLabel));
+        }
+    } else {
+        if (Base != 0) {
+            AddCodeLine ("sec");
+            AddCodeLine ("sbc #$%02X", (unsigned char) Base);
+        }
+    }
+    AddCodeLine ("cmp #$%02X", (unsigned char) Size);
+    AddCodeLine ("jcs %s", LocalLabelName (DefaultLabel));
+
+    /* Scale the index and jump through the table. This is the same dispatch
+    ** that is generated for computed gotos.
+    */
+    AddCodeLine ("asl a");
+    if (CPUIsets[CPU] & CPU_ISET_65SC02) {
+        AddCodeLine ("tax");
+        AddCodeLine ("jmp (.loword(%s),x)", LocalLabelName (TableLabel));
+    } else {
+        AddCodeLine ("tay");
+        AddCodeLine ("lda %s,y", LocalLabelName (TableLabel));
+        AddCodeLine ("ldx %s+1,y", LocalLabelName (TableLabel));
+        AddCodeLine ("jmp callax");
+    }
+
+    /* Remember the dispatching jump insn */
+    E = CS_GetEntry (CS->Code, CS_GetEntryCount (CS->Code) - 1);
+
+    /* If the range has holes, emit a stub that jumps to the default label
+    ** and use it for the unused slots. The stub cannot pick up foreign
+    ** labels since all case labels are attached to insns at this point.
+    */
+    for (I = 0; I < Size; ++I) {
+        if (Slots[I] == 0) {
+            unsigned StubLabel = GetLocalLabel ();
+            CodeLabel* StubLab;
+            g_defcodelabel (StubLabel);
+            g_jump (DefaultLabel);
+            StubLab = FindCaseTarget (StubLabel);
+            CHECK (StubLab != 0);
+            for (J = I; J < Size; ++J) {
+                if (Slots[J] == 0) {
+                    Slots[J] = StubLab;
+                }
+            }
+            break;
+        }
+    }
+
+    /* Let the dispatching jump reference all targets, so the optimizer knows
+    ** about the flow and keeps the labels (same scheme as for the computed
+    ** goto jump tables, see goto.c).
+    */
+    for (I = 0; I < Size; ++I) {
+        for (J = 0; J < I; ++J) {
+            if (Slots[J] == Slots[I]) {
+                break;
+            }
+        }
+        if (J == I) {
+            CollAppend (&Slots[I]->JumpFrom, E);
+        }
+    }
+
+    /* Output the table itself to the read only data segment */
+    g_userodata ();
+    g_defdatalabel (TableLabel);
+    for (I = 0; I < Size; ++I) {
+        AddDataLine ("\t.addr\t%s", Slots[I]->Name);
+    }
+
+    /* Done */
+    return 1;
+}
+
+
+
 void g_switch (Collection* Nodes, unsigned DefaultLabel, unsigned Depth)
 /* Generate code for a switch statement */
 {
     unsigned NextLabel = 0;
     unsigned I;
+    const char* Compare;
+
+    /* If the case values are dense enough, use a jump table instead of a
+    ** compare cascade.
+    */
+    if (g_casetable (Nodes, DefaultLabel, Depth)) {
+        return;
+    }
 
     /* Setup registers and determine which compare insn to use */
-    const char* Compare;
     switch (Depth) {
         case 1:
             Compare = "cmp #$%02X";
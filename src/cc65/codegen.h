@@ -282,6 +282,12 @@ void g_getind (unsigned Flags, unsigned Offs);
 ** into the primary register
 */
 
+void g_soa_getind (unsigned Flags, uintptr_t Label, unsigned Count);
+/* Fetch an element of an array with split lo/hi byte layout into the primary
+** register. The element index is in the primary, the array holds Count
+** elements, so the hi byte plane starts Count bytes behind the label.
+*/
+
 void g_leasp (int Offs);
 /* Fetch the address of the specified symbol into the primary register */
 
@@ -309,6 +315,18 @@ void g_putind (unsigned flags, unsigned offs);
 ** on the top of the stack
 */
 
+void g_soa_putind (unsigned Flags, uintptr_t Label, unsigned Count);
+/* Store the primary register into an element of an array with split lo/hi
+** byte layout. The element index has been pushed onto the stack as a single
+** byte and is dropped. The value remains in the primary register.
+*/
+
+void g_soa_putind_const (unsigned Flags, uintptr_t Label, unsigned Count, unsigned long Val);
+/* Store the constant value Val into an element of an array with split lo/hi
+** byte layout. The element index is in the primary register. The value is
+** loaded into the primary register.
+*/
+
 
 
 /*****************************************************************************/
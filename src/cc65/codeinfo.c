@@ -426,8 +426,16 @@ fncls_t GetFuncInfo (const char* Name, unsigned short* Use, unsigned short* Chg)
                 *Use = REG_NONE;
             }
 
-            /* Will destroy all registers */
-            *Chg = REG_ALL;
+            /* Will destroy all registers, unless the function was already
+            ** compiled and we know which registers its final code can
+            ** actually change. Wrappers may go to any function, so the
+            ** worst case must be assumed for them.
+            */
+            if ((D->Flags & (FD_CHG_KNOWN | FD_CALL_WRAPPER)) == FD_CHG_KNOWN) {
+                *Chg = D->RegChg;
+            } else {
+                *Chg = REG_ALL;
+            }
 
             /* Done */
             return FNCLS_GLOBAL;
@@ -480,6 +488,51 @@ fncls_t GetFuncInfo (const char* Name, unsigned short* Use, unsigned short* Chg)
 
 
 
+int FuncCallUsesStackParams (const char* Name)
+/* Check if a call to the given function passes any parameters on the stack.
+** True is also returned if this cannot be determined.
+*/
+{
+    SymEntry* E;
+    FuncDesc* D;
+
+    /* Only C functions can be checked against their prototype */
+    if (Name[0] != '_'                          ||
+        (E = FindGlobalSym (Name+1)) == 0       ||
+        !IsTypeFunc (E->Type)) {
+        return 1;
+    }
+    D = E->V.F.Func;
+
+    /* For variadic and old style functions the parameters are unknown, and
+    ** a wrapper may forward a call to any function.
+    */
+    if ((D->Flags & (FD_EMPTY | FD_VARIADIC | FD_OLDSTYLE |
+                     FD_UNNAMED_PARAMS | FD_CALL_WRAPPER)) != 0) {
+        return 1;
+    }
+
+    /* A function without parameters uses no stack space */
+    if (D->ParamCount == 0) {
+        return 0;
+    }
+
+    /* For a fastcall function, the last parameter is passed in registers,
+    ** so no stack space is used if it is the only one.
+    */
+    if ((AutoCDecl ?
+         IsQualFastcall (E->Type) :
+         !IsQualCDecl (E->Type))                                &&
+        D->ParamSize == CheckedSizeOf (D->LastParam->Type)) {
+        return 0;
+    }
+
+    /* Parameters are passed on the stack */
+    return 1;
+}
+
+
+
 static int CompareZPInfo (const void* Name, const void* Info)
 /* Compare function for bsearch */
 {
@@ -716,6 +769,26 @@ unsigned GetRegInfo (struct CodeSeg* S, unsigned Index, unsigned Wanted)
 
 
 
+unsigned short GetRegChangeInfo (struct CodeSeg* S)
+/* Return the set of registers that may be changed when executing the code
+** segment. The info is taken from the single entries, so calls to functions
+** with unknown register usage will result in REG_ALL.
+*/
+{
+    unsigned short Chg = REG_NONE;
+    unsigned I;
+
+    /* Walk over all entries and collect the registers changed */
+    for (I = 0; I < CS_GetEntryCount (S); ++I) {
+        Chg |= CS_GetEntry (S, I)->Chg;
+    }
+
+    /* Return the accumulated set */
+    return Chg;
+}
+
+
+
 int RegAUsed (struct CodeSeg* S, unsigned Index)
 /* Check if the value in A is used. */
 {
@@ -143,6 +143,11 @@ fncls_t GetFuncInfo (const char* Name, unsigned short* Use, unsigned short* Chg)
 ** Return the whatever category the function is in.
 */
 
+int FuncCallUsesStackParams (const char* Name);
+/* Check if a call to the given function passes any parameters on the stack.
+** True is also returned if this cannot be determined.
+*/
+
 const ZPInfo* GetZPInfo (const char* Name);
 /* If the given name is a zero page symbol, return a pointer to the info
 ** struct for this symbol, otherwise return NULL.
@@ -153,6 +158,12 @@ unsigned GetRegInfo (struct CodeSeg* S, unsigned Index, unsigned Wanted);
 ** given index.
 */
 
+unsigned short GetRegChangeInfo (struct CodeSeg* S);
+/* Return the set of registers that may be changed when executing the code
+** segment. The info is taken from the single entries, so calls to functions
+** with unknown register usage will result in REG_ALL.
+*/
+
 int RegAUsed (struct CodeSeg* S, unsigned Index);
 /* Check if the value in A is used. */
 
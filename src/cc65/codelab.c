@@ -93,12 +93,60 @@ void CL_AddRef (CodeLabel* L, struct CodeEntry* E)
     /* Replace the code entry argument with the name of the new label */
     CE_SetArg (E, L->Name);
 
-    /* Remember that in the label */
+    /* Remember that in the label, and the position in the entry */
+    E->RefIndex = CollCount (&L->JumpFrom);
     CollAppend (&L->JumpFrom, E);
 }
 
 
 
+void CL_DelRef (CodeLabel* L, struct CodeEntry* E)
+/* Remove the reference by E from the JumpFrom list of L. The JumpTo pointer
+** of E is left alone, the caller has to take care of it.
+*/
+{
+    /* Index of the last reference */
+    unsigned Last = CollCount (&L->JumpFrom) - 1;
+
+    /* Be sure the stored index is valid */
+    CHECK (CollAt (&L->JumpFrom, E->RefIndex) == E);
+
+    /* Move the last reference into the slot of the removed one, so the
+    ** deletion is cheap even for labels with many references. Entries that
+    ** don't actually jump to L (jump tables for computed gotos) may also be
+    ** listed here; their RefIndex belongs to another label and is left alone.
+    */
+    if (E->RefIndex != Last) {
+        CodeEntry* Moved = CollAt (&L->JumpFrom, Last);
+        CollReplace (&L->JumpFrom, Moved, E->RefIndex);
+        if (Moved->JumpTo == L) {
+            Moved->RefIndex = E->RefIndex;
+        }
+    }
+    CollDelete (&L->JumpFrom, Last);
+}
+
+
+
+int CL_HasNameRefs (const CodeLabel* L)
+/* Return true if the label is referenced by name from a jump table (for a
+** computed goto or a table dispatched switch). The table was output using
+** the label name, so such a label must not be deleted even if another label
+** at the same position could replace it for direct jumps.
+*/
+{
+    unsigned I;
+    for (I = 0; I < CollCount (&L->JumpFrom); ++I) {
+        const CodeEntry* E = CollConstAt (&L->JumpFrom, I);
+        if (E->JumpTo != L) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+
 void CL_MoveRefs (CodeLabel* OldLabel, CodeLabel* NewLabel)
 /* Move all references to OldLabel to point to NewLabel. OldLabel will have no
 ** more references on return.
@@ -126,9 +174,10 @@ void CL_MoveRefs (CodeLabel* OldLabel, CodeLabel* NewLabel)
 void CL_Output (const CodeLabel* L)
 /* Output the code label to the output file */
 {
-    WriteOutput ("%s:", L->Name);
+    WriteOutputStr (L->Name);
+    WriteOutputStr (":");
     if (strlen (L->Name) > 6) {
         /* Label is too long, add a linefeed */
-        WriteOutput ("\n");
+        WriteOutputStr ("\n");
     }
 }
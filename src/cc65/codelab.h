@@ -106,6 +106,18 @@ INLINE struct CodeEntry* CL_GetRef (CodeLabel* L, unsigned Index)
 void CL_AddRef (CodeLabel* L, struct CodeEntry* E);
 /* Let the CodeEntry E reference the label L */
 
+void CL_DelRef (CodeLabel* L, struct CodeEntry* E);
+/* Remove the reference by E from the JumpFrom list of L. The JumpTo pointer
+** of E is left alone, the caller has to take care of it.
+*/
+
+int CL_HasNameRefs (const CodeLabel* L);
+/* Return true if the label is referenced by name from a jump table (for a
+** computed goto or a table dispatched switch). The table was output using
+** the label name, so such a label must not be deleted even if another label
+** at the same position could replace it for direct jumps.
+*/
+
 void CL_MoveRefs (CodeLabel* OldLabel, CodeLabel* NewLabel);
 /* Move all references to OldLabel to point to NewLabel. OldLabel will have no
 ** more references on return.
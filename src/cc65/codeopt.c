@@ -36,6 +36,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
+#include <errno.h>
+#include <time.h>
 
 /* common */
 #include "abend.h"
@@ -52,10 +54,13 @@
 #include "codeent.h"
 #include "codeinfo.h"
 #include "codeopt.h"
+#include "copt816.h"
 #include "coptadd.h"
 #include "coptc02.h"
 #include "coptcmp.h"
 #include "coptind.h"
+#include "coptinline.h"
+#include "coptloop.h"
 #include "coptneg.h"
 #include "coptptrload.h"
 #include "coptptrstore.h"
@@ -68,6 +73,7 @@
 #include "copttest.h"
 #include "error.h"
 #include "global.h"
+#include "globfold.h"
 #include "output.h"
 #include "symtab.h"
 
@@ -740,6 +746,10 @@ struct OptFunc {
     unsigned long  TotalChanges;        /* Total number of changes */
     unsigned long  LastChanges;         /* Last number of changes */
     char           Disabled;            /* True if function disabled */
+    unsigned long  CleanGen;            /* Generation of last run w/o changes */
+    unsigned long  TotalTime;           /* Total time in clock ticks. Only
+                                        ** tracked with --time-passes.
+                                        */
 };
 
 
@@ -751,108 +761,118 @@ struct OptFunc {
 
 
 /* A list of all the function descriptions */
-static OptFunc DOpt65C02BitOps  = { Opt65C02BitOps,  "Opt65C02BitOps",   66, 0, 0, 0, 0, 0 };
-static OptFunc DOpt65C02Ind     = { Opt65C02Ind,     "Opt65C02Ind",     100, 0, 0, 0, 0, 0 };
-static OptFunc DOpt65C02Stores  = { Opt65C02Stores,  "Opt65C02Stores",  100, 0, 0, 0, 0, 0 };
-static OptFunc DOptAdd1         = { OptAdd1,         "OptAdd1",         125, 0, 0, 0, 0, 0 };
-static OptFunc DOptAdd2         = { OptAdd2,         "OptAdd2",         200, 0, 0, 0, 0, 0 };
-static OptFunc DOptAdd3         = { OptAdd3,         "OptAdd3",          65, 0, 0, 0, 0, 0 };
-static OptFunc DOptAdd4         = { OptAdd4,         "OptAdd4",          90, 0, 0, 0, 0, 0 };
-static OptFunc DOptAdd5         = { OptAdd5,         "OptAdd5",         100, 0, 0, 0, 0, 0 };
-static OptFunc DOptAdd6         = { OptAdd6,         "OptAdd6",          40, 0, 0, 0, 0, 0 };
-static OptFunc DOptBNegA1       = { OptBNegA1,       "OptBNegA1",       100, 0, 0, 0, 0, 0 };
-static OptFunc DOptBNegA2       = { OptBNegA2,       "OptBNegA2",       100, 0, 0, 0, 0, 0 };
-static OptFunc DOptBNegAX1      = { OptBNegAX1,      "OptBNegAX1",      100, 0, 0, 0, 0, 0 };
-static OptFunc DOptBNegAX2      = { OptBNegAX2,      "OptBNegAX2",      100, 0, 0, 0, 0, 0 };
-static OptFunc DOptBNegAX3      = { OptBNegAX3,      "OptBNegAX3",      100, 0, 0, 0, 0, 0 };
-static OptFunc DOptBNegAX4      = { OptBNegAX4,      "OptBNegAX4",      100, 0, 0, 0, 0, 0 };
-static OptFunc DOptBoolTrans    = { OptBoolTrans,    "OptBoolTrans",    100, 0, 0, 0, 0, 0 };
-static OptFunc DOptBranchDist   = { OptBranchDist,   "OptBranchDist",     0, 0, 0, 0, 0, 0 };
-static OptFunc DOptCmp1         = { OptCmp1,         "OptCmp1",          42, 0, 0, 0, 0, 0 };
-static OptFunc DOptCmp2         = { OptCmp2,         "OptCmp2",          85, 0, 0, 0, 0, 0 };
-static OptFunc DOptCmp3         = { OptCmp3,         "OptCmp3",          75, 0, 0, 0, 0, 0 };
-static OptFunc DOptCmp4         = { OptCmp4,         "OptCmp4",          75, 0, 0, 0, 0, 0 };
-static OptFunc DOptCmp5         = { OptCmp5,         "OptCmp5",         100, 0, 0, 0, 0, 0 };
-static OptFunc DOptCmp6         = { OptCmp6,         "OptCmp6",         100, 0, 0, 0, 0, 0 };
-static OptFunc DOptCmp7         = { OptCmp7,         "OptCmp7",          85, 0, 0, 0, 0, 0 };
-static OptFunc DOptCmp8         = { OptCmp8,         "OptCmp8",          50, 0, 0, 0, 0, 0 };
-static OptFunc DOptCmp9         = { OptCmp9,         "OptCmp9",          85, 0, 0, 0, 0, 0 };
-static OptFunc DOptComplAX1     = { OptComplAX1,     "OptComplAX1",      65, 0, 0, 0, 0, 0 };
-static OptFunc DOptCondBranches1= { OptCondBranches1,"OptCondBranches1", 80, 0, 0, 0, 0, 0 };
-static OptFunc DOptCondBranches2= { OptCondBranches2,"OptCondBranches2",  0, 0, 0, 0, 0, 0 };
-static OptFunc DOptDeadCode     = { OptDeadCode,     "OptDeadCode",     100, 0, 0, 0, 0, 0 };
-static OptFunc DOptDeadJumps    = { OptDeadJumps,    "OptDeadJumps",    100, 0, 0, 0, 0, 0 };
-static OptFunc DOptDecouple     = { OptDecouple,     "OptDecouple",     100, 0, 0, 0, 0, 0 };
-static OptFunc DOptDupLoads     = { OptDupLoads,     "OptDupLoads",       0, 0, 0, 0, 0, 0 };
-static OptFunc DOptGotoSPAdj    = { OptGotoSPAdj,    "OptGotoSPAdj",      0, 0, 0, 0, 0, 0 };
-static OptFunc DOptIndLoads1    = { OptIndLoads1,    "OptIndLoads1",      0, 0, 0, 0, 0, 0 };
-static OptFunc DOptIndLoads2    = { OptIndLoads2,    "OptIndLoads2",      0, 0, 0, 0, 0, 0 };
-static OptFunc DOptJumpCascades = { OptJumpCascades, "OptJumpCascades", 100, 0, 0, 0, 0, 0 };
-static OptFunc DOptJumpTarget1  = { OptJumpTarget1,  "OptJumpTarget1",  100, 0, 0, 0, 0, 0 };
-static OptFunc DOptJumpTarget2  = { OptJumpTarget2,  "OptJumpTarget2",  100, 0, 0, 0, 0, 0 };
-static OptFunc DOptJumpTarget3  = { OptJumpTarget3,  "OptJumpTarget3",  100, 0, 0, 0, 0, 0 };
-static OptFunc DOptLoad1        = { OptLoad1,        "OptLoad1",        100, 0, 0, 0, 0, 0 };
-static OptFunc DOptLoad2        = { OptLoad2,        "OptLoad2",        200, 0, 0, 0, 0, 0 };
-static OptFunc DOptLoad3        = { OptLoad3,        "OptLoad3",          0, 0, 0, 0, 0, 0 };
-static OptFunc DOptNegAX1       = { OptNegAX1,       "OptNegAX1",       165, 0, 0, 0, 0, 0 };
-static OptFunc DOptNegAX2       = { OptNegAX2,       "OptNegAX2",       200, 0, 0, 0, 0, 0 };
-static OptFunc DOptRTS          = { OptRTS,          "OptRTS",          100, 0, 0, 0, 0, 0 };
-static OptFunc DOptRTSJumps1    = { OptRTSJumps1,    "OptRTSJumps1",    100, 0, 0, 0, 0, 0 };
-static OptFunc DOptRTSJumps2    = { OptRTSJumps2,    "OptRTSJumps2",    100, 0, 0, 0, 0, 0 };
-static OptFunc DOptPrecalc      = { OptPrecalc,      "OptPrecalc",      100, 0, 0, 0, 0, 0 };
-static OptFunc DOptPtrLoad1     = { OptPtrLoad1,     "OptPtrLoad1",     100, 0, 0, 0, 0, 0 };
-static OptFunc DOptPtrLoad2     = { OptPtrLoad2,     "OptPtrLoad2",     100, 0, 0, 0, 0, 0 };
-static OptFunc DOptPtrLoad3     = { OptPtrLoad3,     "OptPtrLoad3",     100, 0, 0, 0, 0, 0 };
-static OptFunc DOptPtrLoad4     = { OptPtrLoad4,     "OptPtrLoad4",     100, 0, 0, 0, 0, 0 };
-static OptFunc DOptPtrLoad5     = { OptPtrLoad5,     "OptPtrLoad5",      50, 0, 0, 0, 0, 0 };
-static OptFunc DOptPtrLoad6     = { OptPtrLoad6,     "OptPtrLoad6",      60, 0, 0, 0, 0, 0 };
-static OptFunc DOptPtrLoad7     = { OptPtrLoad7,     "OptPtrLoad7",     140, 0, 0, 0, 0, 0 };
-static OptFunc DOptPtrLoad11    = { OptPtrLoad11,    "OptPtrLoad11",     92, 0, 0, 0, 0, 0 };
-static OptFunc DOptPtrLoad12    = { OptPtrLoad12,    "OptPtrLoad12",     50, 0, 0, 0, 0, 0 };
-static OptFunc DOptPtrLoad13    = { OptPtrLoad13,    "OptPtrLoad13",     65, 0, 0, 0, 0, 0 };
-static OptFunc DOptPtrLoad14    = { OptPtrLoad14,    "OptPtrLoad14",    108, 0, 0, 0, 0, 0 };
-static OptFunc DOptPtrLoad15    = { OptPtrLoad15,    "OptPtrLoad15",     86, 0, 0, 0, 0, 0 };
-static OptFunc DOptPtrLoad16    = { OptPtrLoad16,    "OptPtrLoad16",    100, 0, 0, 0, 0, 0 };
-static OptFunc DOptPtrLoad17    = { OptPtrLoad17,    "OptPtrLoad17",    190, 0, 0, 0, 0, 0 };
-static OptFunc DOptPtrLoad18    = { OptPtrLoad18,    "OptPtrLoad18",    100, 0, 0, 0, 0, 0 };
-static OptFunc DOptPtrLoad19    = { OptPtrLoad19,    "OptPtrLoad19",     65, 0, 0, 0, 0, 0 };
-static OptFunc DOptPtrStore1    = { OptPtrStore1,    "OptPtrStore1",     65, 0, 0, 0, 0, 0 };
-static OptFunc DOptPtrStore2    = { OptPtrStore2,    "OptPtrStore2",     65, 0, 0, 0, 0, 0 };
-static OptFunc DOptPtrStore3    = { OptPtrStore3,    "OptPtrStore3",    100, 0, 0, 0, 0, 0 };
-static OptFunc DOptPush1        = { OptPush1,        "OptPush1",         65, 0, 0, 0, 0, 0 };
-static OptFunc DOptPush2        = { OptPush2,        "OptPush2",         50, 0, 0, 0, 0, 0 };
-static OptFunc DOptPushPop      = { OptPushPop,      "OptPushPop",        0, 0, 0, 0, 0, 0 };
-static OptFunc DOptShift1       = { OptShift1,       "OptShift1",       100, 0, 0, 0, 0, 0 };
-static OptFunc DOptShift2       = { OptShift2,       "OptShift2",       100, 0, 0, 0, 0, 0 };
-static OptFunc DOptShift3       = { OptShift3,       "OptShift3",        17, 0, 0, 0, 0, 0 };
-static OptFunc DOptShift4       = { OptShift4,       "OptShift4",       100, 0, 0, 0, 0, 0 };
-static OptFunc DOptShift5       = { OptShift5,       "OptShift5",       110, 0, 0, 0, 0, 0 };
-static OptFunc DOptShift6       = { OptShift6,       "OptShift6",       200, 0, 0, 0, 0, 0 };
-static OptFunc DOptSize1        = { OptSize1,        "OptSize1",        100, 0, 0, 0, 0, 0 };
-static OptFunc DOptSize2        = { OptSize2,        "OptSize2",        100, 0, 0, 0, 0, 0 };
-static OptFunc DOptStackOps     = { OptStackOps,     "OptStackOps",     100, 0, 0, 0, 0, 0 };
-static OptFunc DOptStackPtrOps  = { OptStackPtrOps,  "OptStackPtrOps",   50, 0, 0, 0, 0, 0 };
-static OptFunc DOptStore1       = { OptStore1,       "OptStore1",        70, 0, 0, 0, 0, 0 };
-static OptFunc DOptStore2       = { OptStore2,       "OptStore2",       115, 0, 0, 0, 0, 0 };
-static OptFunc DOptStore3       = { OptStore3,       "OptStore3",       120, 0, 0, 0, 0, 0 };
-static OptFunc DOptStore4       = { OptStore4,       "OptStore4",        50, 0, 0, 0, 0, 0 };
-static OptFunc DOptStore5       = { OptStore5,       "OptStore5",       100, 0, 0, 0, 0, 0 };
-static OptFunc DOptStoreLoad    = { OptStoreLoad,    "OptStoreLoad",      0, 0, 0, 0, 0, 0 };
-static OptFunc DOptSub1         = { OptSub1,         "OptSub1",         100, 0, 0, 0, 0, 0 };
-static OptFunc DOptSub2         = { OptSub2,         "OptSub2",         100, 0, 0, 0, 0, 0 };
-static OptFunc DOptSub3         = { OptSub3,         "OptSub3",         100, 0, 0, 0, 0, 0 };
-static OptFunc DOptTest1        = { OptTest1,        "OptTest1",         65, 0, 0, 0, 0, 0 };
-static OptFunc DOptTest2        = { OptTest2,        "OptTest2",         50, 0, 0, 0, 0, 0 };
-static OptFunc DOptTransfers1   = { OptTransfers1,   "OptTransfers1",     0, 0, 0, 0, 0, 0 };
-static OptFunc DOptTransfers2   = { OptTransfers2,   "OptTransfers2",    60, 0, 0, 0, 0, 0 };
-static OptFunc DOptTransfers3   = { OptTransfers3,   "OptTransfers3",    65, 0, 0, 0, 0, 0 };
-static OptFunc DOptTransfers4   = { OptTransfers4,   "OptTransfers4",    65, 0, 0, 0, 0, 0 };
-static OptFunc DOptUnusedLoads  = { OptUnusedLoads,  "OptUnusedLoads",    0, 0, 0, 0, 0, 0 };
-static OptFunc DOptUnusedStores = { OptUnusedStores, "OptUnusedStores",   0, 0, 0, 0, 0, 0 };
+static OptFunc DOpt65816Xfr     = { Opt65816Xfr,     "Opt65816Xfr",       0, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOpt65C02BitOps  = { Opt65C02BitOps,  "Opt65C02BitOps",   66, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOpt65C02Ind     = { Opt65C02Ind,     "Opt65C02Ind",     100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOpt65C02Stores  = { Opt65C02Stores,  "Opt65C02Stores",  100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptAdd1         = { OptAdd1,         "OptAdd1",         125, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptAdd2         = { OptAdd2,         "OptAdd2",         200, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptAdd3         = { OptAdd3,         "OptAdd3",          65, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptAdd4         = { OptAdd4,         "OptAdd4",          90, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptAdd5         = { OptAdd5,         "OptAdd5",         100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptAdd6         = { OptAdd6,         "OptAdd6",          40, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptBNegA1       = { OptBNegA1,       "OptBNegA1",       100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptBNegA2       = { OptBNegA2,       "OptBNegA2",       100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptBNegAX1      = { OptBNegAX1,      "OptBNegAX1",      100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptBNegAX2      = { OptBNegAX2,      "OptBNegAX2",      100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptBNegAX3      = { OptBNegAX3,      "OptBNegAX3",      100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptBNegAX4      = { OptBNegAX4,      "OptBNegAX4",      100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptBlockMove    = { OptBlockMove,    "OptBlockMove",      0, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptBoolTrans    = { OptBoolTrans,    "OptBoolTrans",    100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptBranchDist   = { OptBranchDist,   "OptBranchDist",     0, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptCmp1         = { OptCmp1,         "OptCmp1",          42, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptCmp2         = { OptCmp2,         "OptCmp2",          85, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptCmp3         = { OptCmp3,         "OptCmp3",          75, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptCmp4         = { OptCmp4,         "OptCmp4",          75, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptCmp5         = { OptCmp5,         "OptCmp5",         100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptCmp6         = { OptCmp6,         "OptCmp6",         100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptCmp7         = { OptCmp7,         "OptCmp7",          85, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptCmp8         = { OptCmp8,         "OptCmp8",          50, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptCmp9         = { OptCmp9,         "OptCmp9",          85, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptComplAX1     = { OptComplAX1,     "OptComplAX1",      65, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptCondBranches1= { OptCondBranches1,"OptCondBranches1", 80, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptConstGlobals = { OptConstGlobals, "OptConstGlobals",   0, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptCondBranches2= { OptCondBranches2,"OptCondBranches2",  0, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptDeadCode     = { OptDeadCode,     "OptDeadCode",     100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptDeadJumps    = { OptDeadJumps,    "OptDeadJumps",    100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptDecouple     = { OptDecouple,     "OptDecouple",     100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptDupLoads     = { OptDupLoads,     "OptDupLoads",       0, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptGotoSPAdj    = { OptGotoSPAdj,    "OptGotoSPAdj",      0, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptIndLoads1    = { OptIndLoads1,    "OptIndLoads1",      0, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptIndLoads2    = { OptIndLoads2,    "OptIndLoads2",      0, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptJumpCascades = { OptJumpCascades, "OptJumpCascades", 100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptJumpTarget1  = { OptJumpTarget1,  "OptJumpTarget1",  100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptJumpTarget2  = { OptJumpTarget2,  "OptJumpTarget2",  100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptJumpTarget3  = { OptJumpTarget3,  "OptJumpTarget3",  100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptLoad1        = { OptLoad1,        "OptLoad1",        100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptLoad2        = { OptLoad2,        "OptLoad2",        200, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptLoad3        = { OptLoad3,        "OptLoad3",          0, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptLoopInvariants = { OptLoopInvariants, "OptLoopInvariants", 0, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptNegAX1       = { OptNegAX1,       "OptNegAX1",       165, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptNegAX2       = { OptNegAX2,       "OptNegAX2",       200, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptRTS          = { OptRTS,          "OptRTS",          100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptRTSJumps1    = { OptRTSJumps1,    "OptRTSJumps1",    100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptRTSJumps2    = { OptRTSJumps2,    "OptRTSJumps2",    100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPrecalc      = { OptPrecalc,      "OptPrecalc",      100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPtrLoad1     = { OptPtrLoad1,     "OptPtrLoad1",     100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPtrLoad2     = { OptPtrLoad2,     "OptPtrLoad2",     100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPtrLoad3     = { OptPtrLoad3,     "OptPtrLoad3",     100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPtrLoad4     = { OptPtrLoad4,     "OptPtrLoad4",     100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPtrLoad5     = { OptPtrLoad5,     "OptPtrLoad5",      50, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPtrLoad6     = { OptPtrLoad6,     "OptPtrLoad6",      60, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPtrLoad7     = { OptPtrLoad7,     "OptPtrLoad7",     140, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPtrLoad11    = { OptPtrLoad11,    "OptPtrLoad11",     92, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPtrLoad12    = { OptPtrLoad12,    "OptPtrLoad12",     50, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPtrLoad13    = { OptPtrLoad13,    "OptPtrLoad13",     65, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPtrLoad14    = { OptPtrLoad14,    "OptPtrLoad14",    108, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPtrLoad15    = { OptPtrLoad15,    "OptPtrLoad15",     86, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPtrLoad16    = { OptPtrLoad16,    "OptPtrLoad16",    100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPtrLoad17    = { OptPtrLoad17,    "OptPtrLoad17",    190, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPtrLoad18    = { OptPtrLoad18,    "OptPtrLoad18",    100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPtrLoad19    = { OptPtrLoad19,    "OptPtrLoad19",     65, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPtrReload    = { OptPtrReload,    "OptPtrReload",      0, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPtrStore1    = { OptPtrStore1,    "OptPtrStore1",     65, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPtrStore2    = { OptPtrStore2,    "OptPtrStore2",     65, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPtrStore3    = { OptPtrStore3,    "OptPtrStore3",    100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPush1        = { OptPush1,        "OptPush1",         65, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPush2        = { OptPush2,        "OptPush2",         50, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptPushPop      = { OptPushPop,      "OptPushPop",        0, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptShift1       = { OptShift1,       "OptShift1",       100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptShift2       = { OptShift2,       "OptShift2",       100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptShift3       = { OptShift3,       "OptShift3",        17, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptShift4       = { OptShift4,       "OptShift4",       100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptShift5       = { OptShift5,       "OptShift5",       110, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptShift6       = { OptShift6,       "OptShift6",       200, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptShift7       = { OptShift7,       "OptShift7",         0, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptSize1        = { OptSize1,        "OptSize1",        100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptSize2        = { OptSize2,        "OptSize2",        100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptStackOps     = { OptStackOps,     "OptStackOps",     100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptStackPtrOps  = { OptStackPtrOps,  "OptStackPtrOps",   50, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptStore1       = { OptStore1,       "OptStore1",        70, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptStore2       = { OptStore2,       "OptStore2",       115, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptStore3       = { OptStore3,       "OptStore3",       120, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptStore4       = { OptStore4,       "OptStore4",        50, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptStore5       = { OptStore5,       "OptStore5",       100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptStoreLoad    = { OptStoreLoad,    "OptStoreLoad",      0, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptSub1         = { OptSub1,         "OptSub1",         100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptSub2         = { OptSub2,         "OptSub2",         100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptSub3         = { OptSub3,         "OptSub3",         100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptTailCall     = { OptTailCall,     "OptTailCall",     100, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptTest1        = { OptTest1,        "OptTest1",         65, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptTest2        = { OptTest2,        "OptTest2",         50, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptTransfers1   = { OptTransfers1,   "OptTransfers1",     0, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptTransfers2   = { OptTransfers2,   "OptTransfers2",    60, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptTransfers3   = { OptTransfers3,   "OptTransfers3",    65, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptTransfers4   = { OptTransfers4,   "OptTransfers4",    65, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptUnlikelyBranches = { OptUnlikelyBranches, "OptUnlikelyBranches", 0, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptUnusedLoads  = { OptUnusedLoads,  "OptUnusedLoads",    0, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptUnusedStackStores = { OptUnusedStackStores, "OptUnusedStackStores", 0, 0, 0, 0, 0, 0, 0, 0 };
+static OptFunc DOptUnusedStores = { OptUnusedStores, "OptUnusedStores",   0, 0, 0, 0, 0, 0, 0, 0 };
 
 
 /* Table containing all the steps in alphabetical order */
 static OptFunc* OptFuncs[] = {
+    &DOpt65816Xfr,
     &DOpt65C02BitOps,
     &DOpt65C02Ind,
     &DOpt65C02Stores,
@@ -868,6 +888,7 @@ static OptFunc* OptFuncs[] = {
     &DOptBNegAX2,
     &DOptBNegAX3,
     &DOptBNegAX4,
+    &DOptBlockMove,
     &DOptBoolTrans,
     &DOptBranchDist,
     &DOptCmp1,
@@ -881,6 +902,7 @@ static OptFunc* OptFuncs[] = {
     &DOptCmp9,
     &DOptComplAX1,
     &DOptCondBranches1,
+    &DOptConstGlobals,
     &DOptCondBranches2,
     &DOptDeadCode,
     &DOptDeadJumps,
@@ -896,6 +918,7 @@ static OptFunc* OptFuncs[] = {
     &DOptLoad1,
     &DOptLoad2,
     &DOptLoad3,
+    &DOptLoopInvariants,
     &DOptNegAX1,
     &DOptNegAX2,
     &DOptPrecalc,
@@ -915,6 +938,7 @@ static OptFunc* OptFuncs[] = {
     &DOptPtrLoad5,
     &DOptPtrLoad6,
     &DOptPtrLoad7,
+    &DOptPtrReload,
     &DOptPtrStore1,
     &DOptPtrStore2,
     &DOptPtrStore3,
@@ -930,6 +954,7 @@ static OptFunc* OptFuncs[] = {
     &DOptShift4,
     &DOptShift5,
     &DOptShift6,
+    &DOptShift7,
     &DOptSize1,
     &DOptSize2,
     &DOptStackOps,
@@ -943,13 +968,16 @@ static OptFunc* OptFuncs[] = {
     &DOptSub1,
     &DOptSub2,
     &DOptSub3,
+    &DOptTailCall,
     &DOptTest1,
     &DOptTest2,
     &DOptTransfers1,
     &DOptTransfers2,
     &DOptTransfers3,
     &DOptTransfers4,
+    &DOptUnlikelyBranches,
     &DOptUnusedLoads,
+    &DOptUnusedStackStores,
     &DOptUnusedStores,
 };
 #define OPTFUNC_COUNT  (sizeof(OptFuncs) / sizeof(OptFuncs[0]))
@@ -1035,6 +1063,28 @@ void ListOptSteps (FILE* F)
 
 
 
+void PrintOptTimings (FILE* F)
+/* Print the per-pass timing statistics collected with --time-passes. The
+** output is one tab separated line per pass that did run:
+** "pass <name> <microseconds> <runs> <changes>".
+*/
+{
+    unsigned I;
+
+    for (I = 0; I < OPTFUNC_COUNT; ++I) {
+        const OptFunc* O = OptFuncs[I];
+        if (O->TotalRuns > 0) {
+            fprintf (F, "pass\t%s\t%lu\t%lu\t%lu\n",
+                     O->Name,
+                     (unsigned long) (O->TotalTime * 1000000.0 / CLOCKS_PER_SEC),
+                     O->TotalRuns,
+                     O->TotalChanges);
+        }
+    }
+}
+
+
+
 static void ReadOptStats (const char* Name)
 /* Read the optimizer statistics file */
 {
@@ -1107,6 +1157,158 @@ static void ReadOptStats (const char* Name)
 
 
 
+/*****************************************************************************/
+/*                            Execution profile                              */
+/*****************************************************************************/
+
+
+
+/* Code size factors assigned to functions classified by the profile */
+#define PROF_HOT_FACTOR         200U
+#define PROF_COLD_FACTOR        100U
+
+/* Per mille of the total cycle count needed to classify a function */
+#define PROF_HOT_PERMILLE       50UL
+#define PROF_COLD_PERMILLE      5UL
+
+/* An execution profile entry mapping a function name to a cycle count */
+typedef struct ProfEntry ProfEntry;
+struct ProfEntry {
+    char*           Name;           /* Name of the function */
+    unsigned long   Cycles;         /* Cycles spent in the function */
+};
+
+/* The execution profile */
+static ProfEntry*    ProfTab    = 0; /* Table of profile entries */
+static unsigned      ProfCount  = 0; /* Number of entries in ProfTab */
+static unsigned      ProfLimit  = 0; /* Size of the allocated table */
+static unsigned long ProfCycles = 0; /* Total number of profiled cycles */
+
+
+
+void ReadOptProfile (const char* Name)
+/* Read an execution profile that maps function names to cycle counts */
+{
+    char Buf [256];
+
+    /* Try to open the file */
+    FILE* F = fopen (Name, "r");
+    if (F == 0) {
+        AbEnd ("Cannot open profile file '%s': %s", Name, strerror (errno));
+    }
+
+    /* Read and parse the lines */
+    while (fgets (Buf, sizeof (Buf), F) != 0) {
+
+        char* B;
+        unsigned Len;
+
+        /* Fields */
+        char FuncName[64];
+        unsigned long Cycles;
+
+        /* Remove trailing white space including the line terminator */
+        B = Buf;
+        Len = strlen (B);
+        while (Len > 0 && IsSpace (B[Len-1])) {
+            --Len;
+        }
+        B[Len] = '\0';
+
+        /* Remove leading whitespace */
+        while (IsSpace (*B)) {
+            ++B;
+        }
+
+        /* Check for empty and comment lines */
+        if (*B == '\0' || *B == ';' || *B == '#') {
+            continue;
+        }
+
+        /* Parse the line */
+        if (sscanf (B, "%63s %lu", FuncName, &Cycles) != 2) {
+            /* Syntax error */
+            continue;
+        }
+
+        /* The profile contains assembler names, so strip the leading
+        ** underscore used for C symbols.
+        */
+        B = FuncName;
+        if (*B == '_') {
+            ++B;
+        }
+
+        /* Grow the table if necessary */
+        if (ProfCount >= ProfLimit) {
+            ProfLimit = ProfLimit? ProfLimit * 2 : 32;
+            ProfTab = xrealloc (ProfTab, ProfLimit * sizeof (*ProfTab));
+        }
+
+        /* Add the entry */
+        ProfTab[ProfCount].Name   = xstrdup (B);
+        ProfTab[ProfCount].Cycles = Cycles;
+        ++ProfCount;
+        ProfCycles += Cycles;
+    }
+
+    /* Close the file, ignore errors here. */
+    fclose (F);
+}
+
+
+
+static void ApplyOptProfile (CodeSeg* S)
+/* If an execution profile was read, use it to bias the optimization goal of
+** the given code segment: hot functions are optimized for speed, cold ones
+** for size. Functions missing from the profile were never executed and are
+** treated as cold.
+*/
+{
+    unsigned I;
+    unsigned long Cycles;
+    unsigned long Permille;
+
+    /* Bail out if we have no profile or no function */
+    if (ProfCount == 0 || ProfCycles == 0 || S->Func == 0) {
+        return;
+    }
+
+    /* Search the function in the profile */
+    Cycles = 0;
+    for (I = 0; I < ProfCount; ++I) {
+        if (strcmp (ProfTab[I].Name, S->Func->Name) == 0) {
+            Cycles = ProfTab[I].Cycles;
+            break;
+        }
+    }
+
+    /* Get the share of the function in per mille. Scale down first to avoid
+    ** an overflow with large cycle counts.
+    */
+    Permille = Cycles / ((ProfCycles / 1000UL) + 1UL);
+
+    if (Permille >= PROF_HOT_PERMILLE) {
+        /* Hot function - allow all speed optimizations and make sure the
+        ** full pass schedule is run, even if a pragma said otherwise.
+        */
+        if (S->CodeSizeFactor < PROF_HOT_FACTOR) {
+            S->CodeSizeFactor = PROF_HOT_FACTOR;
+        }
+        S->OptSched = OPT_SCHED_FULL;
+    } else if (Permille < PROF_COLD_PERMILLE) {
+        /* Cold function - no speed optimizations that increase code size,
+        ** and only the reduced pass schedule.
+        */
+        if (S->CodeSizeFactor > PROF_COLD_FACTOR) {
+            S->CodeSizeFactor = PROF_COLD_FACTOR;
+        }
+        S->OptSched = OPT_SCHED_COLD;
+    }
+}
+
+
+
 static void WriteOptStats (const char* Name)
 /* Write the optimizer statistics file */
 {
@@ -1185,6 +1387,19 @@ static void WriteDebugOutput (CodeSeg* S, const char* Step)
 
 
 
+/* Generation counter for the code being optimized. It is incremented
+** whenever an optimizer function changes the code, and when optimization of
+** a new function starts. Together with the CleanGen field in the OptFunc
+** descriptors it allows to skip scans that cannot find anything: If a
+** function did already run without changes, and the code wasn't changed
+** since then, running it again is pointless. Since the optimizer groups
+** repeat their function lists until a fixpoint is reached, this saves a
+** large amount of redundant full scans over the code segment.
+*/
+static unsigned long OptGeneration = 1;
+
+
+
 static unsigned RunOptFunc (CodeSeg* S, OptFunc* F, unsigned Max)
 /* Run one optimizer function Max times or until there are no more changes */
 {
@@ -1197,12 +1412,26 @@ static unsigned RunOptFunc (CodeSeg* S, OptFunc* F, unsigned Max)
         return 0;
     }
 
+    /* If the function did already run on the current code without finding
+    ** anything to change, and the code was not changed since then, it cannot
+    ** find anything now, so skip the scan.
+    */
+    if (F->CleanGen == OptGeneration) {
+        return 0;
+    }
+
     /* Run this until there are no more changes */
     Changes = 0;
     do {
 
-        /* Run the function */
-        C = F->Func (S);
+        /* Run the function, timing it if requested */
+        if (TimePasses) {
+            clock_t Start = clock ();
+            C = F->Func (S);
+            F->TotalTime += (unsigned long) (clock () - Start);
+        } else {
+            C = F->Func (S);
+        }
         Changes += C;
 
         /* Do statistics */
@@ -1218,10 +1447,19 @@ static unsigned RunOptFunc (CodeSeg* S, OptFunc* F, unsigned Max)
             }
             WriteDebugOutput (S, F->Name);
             CS_GenRegInfo (S);
+            ++OptGeneration;
         }
 
     } while (--Max && C > 0);
 
+    /* If the last run found nothing, remember that the function is clean
+    ** with respect to the current code, so it can be skipped until the code
+    ** is changed again.
+    */
+    if (C == 0) {
+        F->CleanGen = OptGeneration;
+    }
+
     /* Return the number of changes */
     return Changes;
 }
@@ -1237,6 +1475,16 @@ static unsigned RunOptGroup1 (CodeSeg* S)
 {
     unsigned Changes = 0;
 
+    /* Lay out __builtin_expect annotated branches first, while the code still
+    ** has the block structure emitted by the code generator.
+    */
+    Changes += RunOptFunc (S, &DOptUnlikelyBranches, 1);
+
+    /* Fold loads of effectively constant globals early, so the immediate
+    ** values take part in all following steps.
+    */
+    Changes += RunOptFunc (S, &DOptConstGlobals, 1);
+
     Changes += RunOptFunc (S, &DOptGotoSPAdj, 1);
     Changes += RunOptFunc (S, &DOptStackPtrOps, 5);
     Changes += RunOptFunc (S, &DOptPtrStore1, 1);
@@ -1272,6 +1520,7 @@ static unsigned RunOptGroup1 (CodeSeg* S)
     Changes += RunOptFunc (S, &DOptSub3, 1);
     Changes += RunOptFunc (S, &DOptStore4, 1);
     Changes += RunOptFunc (S, &DOptStore5, 1);
+    Changes += RunOptFunc (S, &DOptShift7, 1);
     Changes += RunOptFunc (S, &DOptShift1, 1);
     Changes += RunOptFunc (S, &DOptShift2, 1);
     Changes += RunOptFunc (S, &DOptShift5, 1);
@@ -1331,6 +1580,7 @@ static unsigned RunOptGroup3 (CodeSeg* S)
         C += RunOptFunc (S, &DOptJumpCascades, 1);
         C += RunOptFunc (S, &DOptDeadJumps, 1);
         C += RunOptFunc (S, &DOptRTS, 1);
+        C += RunOptFunc (S, &DOptTailCall, 1);
         C += RunOptFunc (S, &DOptDeadCode, 1);
         C += RunOptFunc (S, &DOptBoolTrans, 1);
         C += RunOptFunc (S, &DOptJumpTarget1, 1);
@@ -1352,8 +1602,10 @@ static unsigned RunOptGroup3 (CodeSeg* S)
         C += RunOptFunc (S, &DOptJumpTarget3, 1);       /* After OptCondBranches2 */
         C += RunOptFunc (S, &DOptUnusedLoads, 1);
         C += RunOptFunc (S, &DOptUnusedStores, 1);
+        C += RunOptFunc (S, &DOptUnusedStackStores, 1);
         C += RunOptFunc (S, &DOptDupLoads, 1);
         C += RunOptFunc (S, &DOptStoreLoad, 1);
+        C += RunOptFunc (S, &DOptPtrReload, 1);
         C += RunOptFunc (S, &DOptTransfers1, 1);
         C += RunOptFunc (S, &DOptTransfers3, 1);
         C += RunOptFunc (S, &DOptTransfers4, 1);
@@ -1390,6 +1642,11 @@ static unsigned RunOptGroup4 (CodeSeg* S)
     Changes += RunOptFunc (S, &DOptLoad3, 1);
     Changes += RunOptFunc (S, &DOptDupLoads, 1);
 
+    /* Hoist invariant register loads out of loops. This is done after the
+    ** pattern replacements above, since those may remove loads completely.
+    */
+    Changes += RunOptFunc (S, &DOptLoopInvariants, 1);
+
     /* Return the number of changes */
     return Changes;
 }
@@ -1397,7 +1654,7 @@ static unsigned RunOptGroup4 (CodeSeg* S)
 
 
 static unsigned RunOptGroup5 (CodeSeg* S)
-/* 65C02 specific optimizations. */
+/* 65C02 and 65816 specific optimizations. */
 {
     unsigned Changes = 0;
 
@@ -1414,6 +1671,10 @@ static unsigned RunOptGroup5 (CodeSeg* S)
         }
     }
 
+    if (CPUIsets[CPU] & CPU_ISET_65816) {
+        Changes += RunOptFunc (S, &DOpt65816Xfr, 1);
+    }
+
     /* Return the number of changes */
     return Changes;
 }
@@ -1453,6 +1714,20 @@ static unsigned RunOptGroup7 (CodeSeg* S)
     unsigned Changes = 0;
     unsigned C;
 
+    /* Remove redundant loads of the zero page pointer registers. This is
+    ** done here because the pointer setup code has reached its final shape
+    ** only after the preceding groups.
+    */
+    C = RunOptFunc (S, &DOptPtrReload, 1);
+    if (C) {
+        Changes += C;
+        /* Removing the stores does often leave the loads that fed them
+        ** unused, so run the load removal passes again.
+        */
+        Changes += RunOptFunc (S, &DOptUnusedLoads, 1);
+        Changes += RunOptFunc (S, &DOptUnusedStores, 1);
+    }
+
     /* Optimize for size, that is replace operations by shorter ones, even
     ** if this does hinder further optimizations (no problem since we're
     ** done soon).
@@ -1482,7 +1757,10 @@ static unsigned RunOptGroup7 (CodeSeg* S)
         Changes += RunOptFunc (S, &DOptTransfers3, 1);
     }
 
-    /* Adjust branch distances */
+    /* Make single entry blocks fall through where possible, then adjust
+    ** branch distances.
+    */
+    Changes += RunOptFunc (S, &DOptBlockMove, 5);
     Changes += RunOptFunc (S, &DOptBranchDist, 3);
 
     /* Replace conditional branches to RTS. If we had changes, we must run dead
@@ -1500,9 +1778,38 @@ static unsigned RunOptGroup7 (CodeSeg* S)
 
 
 
+/* An optimizer schedule is a list of optimization groups to run. The full
+** schedule runs all groups. The cold schedule, selectable per function with
+** #pragma opt-schedule, skips the expensive iterated group 3 with its late
+** cleanup group 4, and the decoupling group 2 whose output relies on these
+** for cleanup. This cuts most of the optimizer time for code where quality
+** doesn't matter.
+*/
+typedef unsigned (*OptGroupFunc) (CodeSeg*);
+static const OptGroupFunc FullSchedule[] = {
+    RunOptGroup1,
+    RunOptGroup2,
+    RunOptGroup3,
+    RunOptGroup4,
+    RunOptGroup5,
+    RunOptGroup6,
+    RunOptGroup7,
+    0
+};
+static const OptGroupFunc ColdSchedule[] = {
+    RunOptGroup1,
+    RunOptGroup5,
+    RunOptGroup6,
+    RunOptGroup7,
+    0
+};
+
+
+
 void RunOpt (CodeSeg* S)
 /* Run the optimizer */
 {
+    const OptGroupFunc* Group;
     const char* StatFileName;
 
     /* If we shouldn't run the optimizer, bail out */
@@ -1523,25 +1830,49 @@ void RunOpt (CodeSeg* S)
         Print (stdout, 1, "Running optimizer for global code segment\n");
     }
 
+    /* If an execution profile was given on the command line, use it to
+    ** adjust the optimization goal of this function.
+    */
+    ApplyOptProfile (S);
+
     /* If requested, open an output file */
     OpenDebugFile (S);
     WriteDebugOutput (S, 0);
 
+    /* Expand calls to small static functions that have already been
+    ** optimized, so the code is cleaned up together with the caller.
+    */
+    OptInlineCalls (S);
+
+    /* Update use/change info for calls to functions that were already
+    ** optimized, so all passes see the same, possibly more precise data.
+    */
+    CS_UpdateCallInfo (S);
+
     /* Generate register info for all instructions */
     CS_GenRegInfo (S);
 
-    /* Run groups of optimizations */
-    RunOptGroup1 (S);
-    RunOptGroup2 (S);
-    RunOptGroup3 (S);
-    RunOptGroup4 (S);
-    RunOptGroup5 (S);
-    RunOptGroup6 (S);
-    RunOptGroup7 (S);
+    /* Start a new generation, so no stale CleanGen marks from the previous
+    ** code segment are taken as valid for this one.
+    */
+    ++OptGeneration;
+
+    /* Run the groups of optimizations listed in the schedule selected for
+    ** this segment.
+    */
+    Group = (S->OptSched == OPT_SCHED_COLD)? ColdSchedule : FullSchedule;
+    while (*Group) {
+        (*Group++) (S);
+    }
 
     /* Free register info */
     CS_FreeRegInfo (S);
 
+    /* If the function is small enough, remember it for inline expansion
+    ** into callers that are optimized after it.
+    */
+    RegisterInlineFunc (S);
+
     /* Close output file if necessary */
     if (DebugOptOutput) {
         CloseOutputFile ();
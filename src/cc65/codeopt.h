@@ -58,6 +58,12 @@ void EnableOpt (const char* Name);
 void ListOptSteps (FILE* F);
 /* List all optimization steps */
 
+void PrintOptTimings (FILE* F);
+/* Print the per-pass timing statistics collected with --time-passes */
+
+void ReadOptProfile (const char* Name);
+/* Read an execution profile that maps function names to cycle counts */
+
 void RunOpt (CodeSeg* S);
 /* Run the optimizer */
 
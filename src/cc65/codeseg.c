@@ -55,6 +55,7 @@
 #include "error.h"
 #include "global.h"
 #include "ident.h"
+#include "opcodes.h"
 #include "output.h"
 #include "symentry.h"
 
@@ -76,6 +77,7 @@ static void CS_PrintFunctionHeader (const CodeSeg* S)
     if (Func) {
         WriteOutput ("; ---------------------------------------------------------------\n"
                      "; ");
+        FlushOutput ();
         PrintFuncSig (OutputFile, Func->Name, Func->Type);
         WriteOutput ("\n"
                      "; ---------------------------------------------------------------\n"
@@ -122,8 +124,10 @@ static void CS_MoveLabelsToPool (CodeSeg* S, CodeEntry* E)
 
 
 
-static CodeLabel* CS_FindLabel (CodeSeg* S, const char* Name, unsigned Hash)
-/* Find the label with the given name. Return the label or NULL if not found */
+CodeLabel* CS_FindLabel (CodeSeg* S, const char* Name, unsigned Hash)
+/* Find the label with the given name. Hash is the hash value for Name,
+** reduced modulo CS_LABEL_HASH_SIZE. Return the label or NULL if not found.
+*/
 {
     /* Get the first hash chain entry */
     CodeLabel* L = S->LabelHash[Hash];
@@ -485,6 +489,7 @@ CodeSeg* NewCodeSeg (const char* SegName, SymEntry* Func)
 
     /* Copy the global optimization settings */
     S->Optimize       = (unsigned char) IS_Get (&Optimize);
+    S->OptSched       = (unsigned char) IS_Get (&OptSchedule);
     S->CodeSizeFactor = (unsigned) IS_Get (&CodeSizeFactor);
 
     /* Return the new struct */
@@ -948,6 +953,13 @@ void CS_MergeLabels (CodeSeg* S)
             /* Get the next label */
             CodeLabel* L = CE_GetLabel (E, J);
 
+            /* A label that a jump table addresses by name must survive, so
+            ** leave it attached to the insn besides the reference label.
+            */
+            if (CL_HasNameRefs (L)) {
+                continue;
+            }
+
             /* Move all references from this label to the reference label */
             CL_MoveRefs (L, RefLab);
 
@@ -988,6 +1000,14 @@ void CS_MoveLabels (CodeSeg* S, struct CodeEntry* Old, struct CodeEntry* New)
             /* Get the next label */
             CodeLabel* OldLabel = CE_GetLabel (Old, OldLabelCount);
 
+            /* A label that a jump table addresses by name must keep its
+            ** name, so move the label itself to the new entry.
+            */
+            if (CL_HasNameRefs (OldLabel)) {
+                CE_MoveLabel (OldLabel, New);
+                continue;
+            }
+
             /* Move references */
             CL_MoveRefs (OldLabel, NewLabel);
 
@@ -1023,7 +1043,7 @@ void CS_RemoveLabelRef (CodeSeg* S, struct CodeEntry* E)
     CHECK (L != 0);
 
     /* Delete the entry from the label */
-    CollDeleteItem (&L->JumpFrom, E);
+    CL_DelRef (L, E);
 
     /* The entry jumps no longer to L */
     CE_ClearJumpTo (E);
@@ -1197,6 +1217,225 @@ void CS_DelCodeAfter (CodeSeg* S, unsigned Last)
 
 
 
+/* Saved state of one code entry within a snapshot. Since label objects are
+** deleted and recreated while optimizing, labels are saved by name, in the
+** same way the code was originally read: Attached labels are redefined
+** before the instruction, jump targets are looked up and created as forward
+** references when missing.
+*/
+typedef struct SnapEntry SnapEntry;
+struct SnapEntry {
+    Collection      Labels;         /* Names of attached labels */
+    opc_t           OPC;            /* Opcode */
+    am_t            AM;             /* Addressing mode */
+    char*           Arg;            /* Argument or jump target name */
+    int             IsJump;         /* True if Arg is a jump target label */
+    LineInfo*       LI;             /* Line info reference */
+};
+
+/* Saved state of one label within a snapshot. The references are saved by
+** entry index and in their original order, because multi target jumps (case
+** tables and computed gotos) reference all their possible targets without
+** jumping to any of them directly, so these references cannot be recreated
+** from the entries alone.
+*/
+typedef struct SnapLabel SnapLabel;
+struct SnapLabel {
+    char*           Name;           /* Label name */
+    unsigned*       Refs;           /* Indices of referencing entries */
+    unsigned        RefCount;       /* Number of references */
+};
+
+/* A snapshot is just the list of saved entries and labels */
+struct CodeSnapshot {
+    Collection      Entries;        /* List of SnapEntry structs */
+    Collection      Labels;         /* List of SnapLabel structs */
+};
+
+
+
+CodeSnapshot* CS_CreateSnapshot (CodeSeg* S)
+/* Create a snapshot of the current contents of the code segment. The snapshot
+** allows an optimizer function to apply a multi step rewrite speculatively,
+** compare the result to the original code and keep the better one: Committing
+** the rewrite simply means freeing the snapshot, undoing it means calling
+** CS_RollBack.
+*/
+{
+    unsigned I;
+
+    /* Allocate and initialize the snapshot */
+    CodeSnapshot* Snap = xmalloc (sizeof (CodeSnapshot));
+    InitCollection (&Snap->Entries);
+    InitCollection (&Snap->Labels);
+
+    /* Save the state of all entries */
+    for (I = 0; I < CS_GetEntryCount (S); ++I) {
+
+        /* Get the next entry */
+        CodeEntry* E = CS_GetEntry (S, I);
+
+        /* Allocate a saved entry and copy the data */
+        SnapEntry* SE = xmalloc (sizeof (SnapEntry));
+        unsigned J;
+        InitCollection (&SE->Labels);
+        for (J = 0; J < CE_GetLabelCount (E); ++J) {
+            CollAppend (&SE->Labels, xstrdup (CE_GetLabel (E, J)->Name));
+        }
+        SE->OPC    = E->OPC;
+        SE->AM     = E->AM;
+        SE->IsJump = (E->JumpTo != 0);
+        SE->Arg    = xstrdup (SE->IsJump? E->JumpTo->Name : E->Arg);
+        SE->LI     = UseLineInfo (E->LI);
+
+        /* Add it to the snapshot */
+        CollAppend (&Snap->Entries, SE);
+    }
+
+    /* Save all labels with their reference lists. Walking the hash chains
+    ** also finds labels not attached to an entry, which may exist for jumps
+    ** to external targets before CS_MergeLabels has run.
+    */
+    for (I = 0; I < CS_LABEL_HASH_SIZE; ++I) {
+        CodeLabel* L = S->LabelHash[I];
+        while (L) {
+            if (L->Owner != 0 || CollCount (&L->JumpFrom) > 0) {
+                SnapLabel* SL = xmalloc (sizeof (SnapLabel));
+                unsigned J;
+                SL->Name     = xstrdup (L->Name);
+                SL->RefCount = CollCount (&L->JumpFrom);
+                SL->Refs     = xmalloc (SL->RefCount * sizeof (*SL->Refs));
+                for (J = 0; J < SL->RefCount; ++J) {
+                    SL->Refs[J] = CS_GetEntryIndex (S, CollAt (&L->JumpFrom, J));
+                }
+                CollAppend (&Snap->Labels, SL);
+            }
+            L = L->Next;
+        }
+    }
+
+    /* Return the snapshot */
+    return Snap;
+}
+
+
+
+void CS_RollBack (CodeSeg* S, const CodeSnapshot* Snap)
+/* Replace the contents of the code segment by the state saved in the given
+** snapshot. The snapshot stays valid and may be rolled back to more than
+** once. Register info is not part of the snapshot; if it is needed after a
+** rollback, it must be regenerated using CS_GenRegInfo.
+*/
+{
+    unsigned I;
+
+    /* Remove the current code including all labels */
+    if (CS_GetEntryCount (S) > 0) {
+        CS_DelCodeAfter (S, 0);
+    }
+
+    /* Labels that were attached but unreferenced are left in the label pool
+    ** by CS_DelCodeAfter. Drop them, they are recreated from the snapshot.
+    */
+    while (CollCount (&S->Labels) > 0) {
+        CodeLabel* L = CollAt (&S->Labels, 0);
+        CollDelete (&S->Labels, 0);
+        CS_DelLabel (S, L);
+    }
+
+    /* Recreate the saved entries */
+    for (I = 0; I < CollCount (&Snap->Entries); ++I) {
+
+        /* Get the next saved entry */
+        const SnapEntry* SE = CollConstAt (&Snap->Entries, I);
+        CodeLabel* Label;
+        CodeEntry* E;
+        unsigned J;
+
+        /* Define the labels attached to this entry */
+        for (J = 0; J < CollCount (&SE->Labels); ++J) {
+            CS_AddLabel (S, CollConstAt (&SE->Labels, J));
+        }
+
+        /* For a jump, get the target label, creating it as a forward
+        ** reference if it does not exist yet.
+        */
+        Label = 0;
+        if (SE->IsJump) {
+            unsigned Hash = HashStr (SE->Arg) % CS_LABEL_HASH_SIZE;
+            Label = CS_FindLabel (S, SE->Arg, Hash);
+            if (Label == 0) {
+                Label = CS_NewCodeLabel (S, SE->Arg, Hash);
+            }
+        }
+
+        /* Recreate the instruction and add it */
+        E = NewCodeEntry (SE->OPC, SE->AM, SE->Arg, Label, SE->LI);
+        CS_AddEntry (S, E);
+    }
+
+    /* Rebuild the reference lists of all labels in the saved order. This
+    ** restores the references of multi target jumps, which aren't part of
+    ** the recreated entries, and makes sure the reference indices kept in
+    ** the entries match the rebuilt lists.
+    */
+    for (I = 0; I < CollCount (&Snap->Labels); ++I) {
+
+        /* Get the next saved label. It must exist after the code above */
+        const SnapLabel* SL = CollConstAt (&Snap->Labels, I);
+        unsigned Hash = HashStr (SL->Name) % CS_LABEL_HASH_SIZE;
+        CodeLabel* L = CS_FindLabel (S, SL->Name, Hash);
+        unsigned J;
+        CHECK (L != 0);
+
+        /* Replace the reference list by the saved one */
+        CollDeleteAll (&L->JumpFrom);
+        for (J = 0; J < SL->RefCount; ++J) {
+            CodeEntry* E = CS_GetEntry (S, SL->Refs[J]);
+            if (E->JumpTo == L) {
+                E->RefIndex = CollCount (&L->JumpFrom);
+            }
+            CollAppend (&L->JumpFrom, E);
+        }
+    }
+}
+
+
+
+void CS_FreeSnapshot (CodeSnapshot* Snap)
+/* Free a snapshot created by CS_CreateSnapshot */
+{
+    unsigned I;
+
+    /* Free the saved entries */
+    for (I = 0; I < CollCount (&Snap->Entries); ++I) {
+        SnapEntry* SE = CollAt (&Snap->Entries, I);
+        unsigned J;
+        for (J = 0; J < CollCount (&SE->Labels); ++J) {
+            xfree (CollAt (&SE->Labels, J));
+        }
+        DoneCollection (&SE->Labels);
+        ReleaseLineInfo (SE->LI);
+        xfree (SE->Arg);
+        xfree (SE);
+    }
+
+    /* Free the saved labels */
+    for (I = 0; I < CollCount (&Snap->Labels); ++I) {
+        SnapLabel* SL = CollAt (&Snap->Labels, I);
+        xfree (SL->Name);
+        xfree (SL->Refs);
+        xfree (SL);
+    }
+
+    /* Free the snapshot itself */
+    DoneCollection (&Snap->Entries);
+    DoneCollection (&Snap->Labels);
+    xfree (Snap);
+}
+
+
+
 void CS_ResetMarks (CodeSeg* S, unsigned First, unsigned Last)
 /* Remove all user marks from the entries in the given range */
 {
@@ -1364,6 +1603,10 @@ void CS_Output (CodeSeg* S)
 {
     unsigned I;
     const LineInfo* LI;
+    unsigned BlockBytes  = 0;   /* Byte count for the current basic block */
+    unsigned BlockCycles = 0;   /* Cycle count for the current basic block */
+    unsigned TotalBytes  = 0;   /* Byte count for the whole segment */
+    unsigned TotalCycles = 0;   /* Cycle count for the whole segment */
 
     /* Get the number of entries in this segment */
     unsigned Count = CS_GetEntryCount (S);
@@ -1419,12 +1662,40 @@ void CS_Output (CodeSeg* S)
                              GetInputName (LI), GetInputLine (LI));
             }
         }
+        /* When cycle annotations are requested, sum up size and cycle
+        ** estimates per basic block. A label starts a new block; output
+        ** the numbers for the block ending there.
+        */
+        if (AddCycles) {
+            unsigned Cycles = GetInsnCycles (E->OPC, E->AM);
+            if (CollCount (&E->Labels) > 0 && BlockBytes > 0) {
+                WriteOutput ("; block: %u bytes, ~%u cycles\n",
+                             BlockBytes, BlockCycles);
+                BlockBytes  = 0;
+                BlockCycles = 0;
+            }
+            BlockBytes  += E->Size;
+            BlockCycles += Cycles;
+            TotalBytes  += E->Size;
+            TotalCycles += Cycles;
+        }
+
         /* Output the code */
         CE_Output (E);
     }
 
+    /* Output the estimates for the last block and the whole function */
+    if (AddCycles) {
+        if (BlockBytes > 0) {
+            WriteOutput ("; block: %u bytes, ~%u cycles\n",
+                         BlockBytes, BlockCycles);
+        }
+        WriteOutput ("; total: %u bytes, ~%u cycles straight-line\n",
+                     TotalBytes, TotalCycles);
+    }
+
     /* Prettyier formatting */
-    WriteOutput ("\n");
+    WriteOutputStr ("\n");
 
     /* If debug info is enabled, terminate the last line number information */
     if (DebugInfo) {
@@ -1448,6 +1719,24 @@ void CS_FreeRegInfo (CodeSeg* S)
 
 
 
+void CS_UpdateCallInfo (CodeSeg* S)
+/* Update the use and change information for all calls in the code segment.
+** The info for functions compiled earlier in this translation unit may have
+** become more precise since the entries were created, and all analysis
+** relies on the entries being in sync with GetFuncInfo.
+*/
+{
+    unsigned I;
+    for (I = 0; I < CS_GetEntryCount (S); ++I) {
+        CodeEntry* E = CS_GetEntry (S, I);
+        if ((E->Info & (OF_UBRA | OF_CALL)) != 0 && E->JumpTo == 0) {
+            GetFuncInfo (E->Arg, &E->Use, &E->Chg);
+        }
+    }
+}
+
+
+
 void CS_GenRegInfo (CodeSeg* S)
 /* Generate register infos for all instructions */
 {
@@ -71,6 +71,11 @@ struct CodeEntry;
 /* Size of the label hash table */
 #define CS_LABEL_HASH_SIZE      29
 
+/* Opaque snapshot of a code segment's contents, used to undo speculative
+** rewrites. See CS_CreateSnapshot.
+*/
+typedef struct CodeSnapshot CodeSnapshot;
+
 /* Code segment structure */
 typedef struct CodeSeg CodeSeg;
 struct CodeSeg {
@@ -83,6 +88,7 @@ struct CodeSeg {
 
     /* Optimization settings for this segment */
     unsigned char   Optimize;                   /* On/off switch */
+    unsigned char   OptSched;                   /* Pass schedule (OPT_SCHED_xxx) */
     unsigned        CodeSizeFactor;
 };
 
@@ -204,6 +210,11 @@ INLINE int CS_HavePendingLabel (const CodeSeg* S)
 #  define CS_HavePendingLabel(S)        (CollCount (&(S)->Labels) > 0)
 #endif
 
+CodeLabel* CS_FindLabel (CodeSeg* S, const char* Name, unsigned Hash);
+/* Find the label with the given name. Hash is the hash value for Name,
+** reduced modulo CS_LABEL_HASH_SIZE. Return the label or NULL if not found.
+*/
+
 CodeLabel* CS_AddLabel (CodeSeg* S, const char* Name);
 /* Add a code label for the next instruction to follow */
 
@@ -250,6 +261,24 @@ void CS_DelCodeRange (CodeSeg* S, unsigned First, unsigned Last);
 void CS_DelCodeAfter (CodeSeg* S, unsigned Last);
 /* Delete all entries including the given one */
 
+CodeSnapshot* CS_CreateSnapshot (CodeSeg* S);
+/* Create a snapshot of the current contents of the code segment. The snapshot
+** allows an optimizer function to apply a multi step rewrite speculatively,
+** compare the result to the original code and keep the better one: Committing
+** the rewrite simply means freeing the snapshot, undoing it means calling
+** CS_RollBack.
+*/
+
+void CS_RollBack (CodeSeg* S, const CodeSnapshot* Snap);
+/* Replace the contents of the code segment by the state saved in the given
+** snapshot. The snapshot stays valid and may be rolled back to more than
+** once. Register info is not part of the snapshot; if it is needed after a
+** rollback, it must be regenerated using CS_GenRegInfo.
+*/
+
+void CS_FreeSnapshot (CodeSnapshot* Snap);
+/* Free a snapshot created by CS_CreateSnapshot */
+
 void CS_ResetMarks (CodeSeg* S, unsigned First, unsigned Last);
 /* Remove all user marks from the entries in the given range */
 
@@ -294,6 +323,13 @@ void CS_FreeRegInfo (CodeSeg* S);
 void CS_GenRegInfo (CodeSeg* S);
 /* Generate register infos for all instructions */
 
+void CS_UpdateCallInfo (CodeSeg* S);
+/* Update the use and change information for all calls in the code segment.
+** The info for functions compiled earlier in this translation unit may have
+** become more precise since the entries were created, and all analysis
+** relies on the entries being in sync with GetFuncInfo.
+*/
+
 
 
 /* End of codeseg.h */
@@ -33,6 +33,7 @@
 
 
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 
@@ -47,6 +48,7 @@
 #include "asmlabel.h"
 #include "asmstmt.h"
 #include "codegen.h"
+#include "codeinfo.h"
 #include "codeopt.h"
 #include "compile.h"
 #include "declare.h"
@@ -54,6 +56,7 @@
 #include "expr.h"
 #include "function.h"
 #include "global.h"
+#include "globfold.h"
 #include "input.h"
 #include "litpool.h"
 #include "macrotab.h"
@@ -71,6 +74,56 @@
 
 
 
+void PrintPhaseTime (const char* Name, clock_t Ticks)
+/* Print one phase timer line for --time-passes. The output is one tab
+** separated line per phase: "phase <name> <microseconds>".
+*/
+{
+    fprintf (stderr, "phase\t%s\t%lu\n",
+             Name, (unsigned long) (Ticks * 1000000.0 / CLOCKS_PER_SEC));
+}
+
+
+
+static void CheckSoaLayout (SymEntry* Entry)
+/* If #pragma soa is in effect, mark Entry so its accesses use the split
+** lo/hi byte array layout. Only arrays of int sized elements with a known
+** element count of no more than 256 can be split, and the layout must be
+** known before the first reference.
+*/
+{
+    const Type* ElementType;
+    long Count;
+
+    if (IS_Get (&SoaLayout) == 0 || !IsTypeArray (Entry->Type)) {
+        return;
+    }
+
+    /* If the array was already referenced with the standard layout, it is
+    ** too late to change it.
+    */
+    if ((Entry->Flags & (SC_SOA | SC_REF)) == SC_REF) {
+        return;
+    }
+
+    /* Check the element type. Both byte planes are indexed by the element
+    ** number, so the element count is limited by the index register, and
+    ** the elements must consist of exactly two bytes.
+    */
+    ElementType = GetElementType (Entry->Type);
+    Count       = GetElementCount (Entry->Type);
+    if (Count <= 0 || Count > 256                               ||
+        SizeOf (ElementType) != SIZEOF_INT                      ||
+        (!IsClassInt (ElementType) && !IsTypePtr (ElementType)) ||
+        IsQualVolatile (ElementType)) {
+        return;
+    }
+
+    Entry->Flags |= SC_SOA;
+}
+
+
+
 static void Parse (void)
 /* Top level parser routine. */
 {
@@ -183,6 +236,11 @@ static void Parse (void)
             /* Add declaration attributes */
             SymUseAttr (Entry, &Decl);
 
+            /* If #pragma soa is in effect, check if the variable can use
+            ** the split lo/hi byte array layout.
+            */
+            CheckSoaLayout (Entry);
+
             /* Reserve storage for the variable if we need to */
             if (Decl.StorageClass & SC_STORAGE) {
 
@@ -199,6 +257,16 @@ static void Parse (void)
                     }
                     Entry->Flags |= SC_DEF;
 
+                    /* The split lo/hi byte layout works for uninitialized
+                    ** data only, since initializers are emitted with the
+                    ** standard layout.
+                    */
+                    if ((Entry->Flags & SC_SOA) != 0) {
+                        Error ("Array '%s' with split layout cannot be initialized",
+                               Entry->Name);
+                        Entry->Flags &= ~SC_SOA;
+                    }
+
                     /* We cannot initialize types of unknown size, or
                     ** void types in ISO modes.
                     */
@@ -230,8 +298,12 @@ static void Parse (void)
                     /* Skip the '=' */
                     NextToken ();
 
-                    /* Parse the initialization */
+                    /* Parse the initialization, recording the data so loads
+                    ** of effectively constant variables can be folded later.
+                    */
+                    GF_InitBegin (Entry);
                     ParseInit (Entry->Type);
+                    GF_InitEnd ();
                 } else {
 
                     if (IsTypeVoid (Decl.Type)) {
@@ -401,8 +473,15 @@ void Compile (const char* FileName)
 
     } else {
 
-        /* Ok, start the ball rolling... */
+        /* Ok, start the ball rolling... Parsing and code generation happen
+        ** in one pass, so this timer covers both.
+        */
+        clock_t Start = clock ();
         Parse ();
+        if (TimePasses) {
+            PrintPhaseTime ("parse", clock () - Start);
+            xmemreport (stderr, "parse");
+        }
 
     }
 
@@ -420,12 +499,19 @@ void FinishCompile (void)
 /* Emit literals, externals, debug info, do cleanup and optimizations */
 {
     SymEntry* Entry;
+    clock_t Start = clock ();
 
     /* Reset the BSS segment name to its default; so that the below strcmp()
     ** will work as expected, at the beginning of the list of variables
     */
     SetSegName (SEG_BSS, SEGNAME_BSS);
 
+    /* Now that the code of all functions is known, determine which global
+    ** variables are effectively constant, so OptConstGlobals can fold loads
+    ** of their values.
+    */
+    GF_Analyze ();
+
     /* Walk over all global symbols:
     ** - for functions, do clean-up and optimizations
     ** - generate code for uninitialized global variables
@@ -433,9 +519,28 @@ void FinishCompile (void)
     for (Entry = GetGlobalSymTab ()->SymHead; Entry; Entry = Entry->NextSym) {
         if (SymIsOutputFunc (Entry)) {
             /* Function which is defined and referenced or extern */
+
+            /* If this is a static function whose return value is never used
+            ** by any caller, tell the optimizer that no registers are live
+            ** on function exit, so the code materializing the return value
+            ** can be removed.
+            */
+            if ((Entry->Flags & (SC_STATIC | SC_EXTERN)) == SC_STATIC   &&
+                Entry->FuncRefs > 0                                     &&
+                Entry->FuncVoidCalls == Entry->FuncRefs) {
+                Entry->V.F.Seg->Code->ExitRegs = REG_NONE;
+            }
+
             MoveLiteralPool (Entry->V.F.LitPool);
             CS_MergeLabels (Entry->V.F.Seg->Code);
             RunOpt (Entry->V.F.Seg->Code);
+
+            /* Remember which registers the final code can change. Functions
+            ** handled later in this translation unit then don't need to
+            ** assume that a call to this one destroys all registers.
+            */
+            Entry->V.F.Func->RegChg = GetRegChangeInfo (Entry->V.F.Seg->Code);
+            Entry->V.F.Func->Flags |= FD_CHG_KNOWN;
         } else if ((Entry->Flags & (SC_STORAGE | SC_DEF | SC_STATIC)) == (SC_STORAGE | SC_STATIC)) {
             /* Assembly definition of uninitialized global variable */
 
@@ -463,4 +568,10 @@ void FinishCompile (void)
 
     /* Leave the main lexical level */
     LeaveGlobalLevel ();
+
+    /* This phase is dominated by the optimizer runs */
+    if (TimePasses) {
+        PrintPhaseTime ("opt", clock () - Start);
+        xmemreport (stderr, "opt");
+    }
 }
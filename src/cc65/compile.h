@@ -38,6 +38,10 @@
 
 
 
+#include <time.h>
+
+
+
 /*****************************************************************************/
 /*                                   Code                                    */
 /*****************************************************************************/
@@ -50,6 +54,9 @@ void Compile (const char* FileName);
 void FinishCompile (void);
 /* Emit literals, externals, do cleanup and optimizations */
 
+void PrintPhaseTime (const char* Name, clock_t Ticks);
+/* Print one phase timer line for --time-passes */
+
 
 
 /* End of compile.h */
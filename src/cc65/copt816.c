@@ -0,0 +1,100 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                 copt816.c                                 */
+/*                                                                           */
+/*                       65816 specific optimizations                        */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+/* cc65 */
+#include "codeent.h"
+#include "codeinfo.h"
+#include "copt816.h"
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+unsigned Opt65816Xfr (CodeSeg* S)
+/* Use the direct index register transfers of the 65816 */
+{
+    unsigned Changes = 0;
+    unsigned I;
+
+    /* Walk over the entries */
+    I = 0;
+    while (I < CS_GetEntryCount (S)) {
+
+        CodeEntry* N;
+        CodeEntry* X;
+
+        /* Get next entry */
+        CodeEntry* E = CS_GetEntry (S, I);
+
+        /* Check for an index register transfer done via the accumulator
+        ** where the accumulator is not used later. The replacement sets
+        ** the flags from the same value, so the flags stay valid.
+        */
+        if (E->OPC == OP65_TXA                  &&
+            (N = CS_GetNextEntry (S, I)) != 0   &&
+            N->OPC == OP65_TAY                  &&
+            !CE_HasLabel (N)                    &&
+            !RegAUsed (S, I+2)) {
+
+            /* Replace the sequence by txy */
+            X = NewCodeEntry (OP65_TXY, AM65_IMP, 0, 0, E->LI);
+            CS_InsertEntry (S, X, I+2);
+            CS_DelEntries (S, I, 2);
+
+            /* We had changes */
+            ++Changes;
+
+        } else if (E->OPC == OP65_TYA           &&
+            (N = CS_GetNextEntry (S, I)) != 0   &&
+            N->OPC == OP65_TAX                  &&
+            !CE_HasLabel (N)                    &&
+            !RegAUsed (S, I+2)) {
+
+            /* Replace the sequence by tyx */
+            X = NewCodeEntry (OP65_TYX, AM65_IMP, 0, 0, E->LI);
+            CS_InsertEntry (S, X, I+2);
+            CS_DelEntries (S, I, 2);
+
+            /* We had changes */
+            ++Changes;
+
+        }
+
+        /* Next entry */
+        ++I;
+
+    }
+
+    /* Return the number of changes made */
+    return Changes;
+}
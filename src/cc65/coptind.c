@@ -567,6 +567,102 @@ NextEntry:
 
 
 
+unsigned OptBlockMove (CodeSeg* S)
+/* Move basic blocks that are reachable only through one unconditional jump
+** directly behind that jump, so the jump can be removed and the code simply
+** falls through into the block. The moved block must not be reachable by
+** fall through from the entry above it, and must end in an instruction that
+** doesn't continue execution, so moving it cannot change any other control
+** flow. Other jumps into the moved range are by label and therefore move
+** with it.
+*/
+{
+    unsigned Changes = 0;
+
+    /* Walk over the entries */
+    unsigned I = 0;
+    while (I < CS_GetEntryCount (S)) {
+
+        unsigned TI, TE, Count;
+        CodeEntry* P;
+
+        /* Get next entry */
+        CodeEntry* E = CS_GetEntry (S, I);
+
+        /* Check for an unconditional jump to a local label that has no
+        ** other references.
+        */
+        if ((E->Info & OF_UBRA) != 0                    &&
+            E->JumpTo != 0                              &&
+            E->JumpTo->Owner != 0                       &&
+            CollCount (&E->JumpTo->JumpFrom) == 1) {
+
+            /* Index of the block start */
+            TI = CS_GetEntryIndex (S, E->JumpTo->Owner);
+
+            /* The block may not start the segment, since the segment entry
+            ** is reached by fall through, and may not directly follow the
+            ** jump (this case is handled by OptDeadJumps).
+            */
+            if (TI == 0 || TI == I + 1) {
+                goto NextEntry;
+            }
+
+            /* The entry before the block must not fall through into it */
+            P = CS_GetEntry (S, TI - 1);
+            if ((P->Info & OF_DEAD) == 0) {
+                goto NextEntry;
+            }
+
+            /* Find the end of the block: The first instruction that does
+            ** not continue execution.
+            */
+            TE = TI;
+            while ((CS_GetEntry (S, TE)->Info & OF_DEAD) == 0) {
+                if (++TE >= CS_GetEntryCount (S)) {
+                    /* Unterminated tail, don't touch it */
+                    goto NextEntry;
+                }
+            }
+
+            /* Skip backward jumps into their own block */
+            if (I >= TI && I <= TE) {
+                goto NextEntry;
+            }
+
+            /* Move the block behind the jump, then delete the jump. Since
+            ** the jump held the only reference, deleting it will also
+            ** remove the target label, and any labels attached to the jump
+            ** itself move to the block start.
+            */
+            Count = TE - TI + 1;
+            if (TI > I) {
+                CS_MoveEntries (S, TI, Count, I + 1);
+                CS_DelEntry (S, I);
+            } else {
+                CS_MoveEntries (S, TI, Count, I + 1 - Count);
+                CS_DelEntry (S, I - Count);
+            }
+
+            /* Remember, we had changes, then look at the same position
+            ** again, which now holds the block start.
+            */
+            ++Changes;
+            continue;
+        }
+
+NextEntry:
+        /* Next entry */
+        ++I;
+
+    }
+
+    /* Return the number of changes made */
+    return Changes;
+}
+
+
+
 /*****************************************************************************/
 /*                             Optimize jsr/rts                              */
 /*****************************************************************************/
@@ -615,6 +711,79 @@ unsigned OptRTS (CodeSeg* S)
 
 
 
+unsigned OptTailCall (CodeSeg* S)
+/* Turn a subroutine call followed by a stack cleanup jump into a tail call.
+** The sequence
+**
+**      jsr     func
+**      jmp     incspN
+**
+** is replaced by
+**
+**      jsr     incspN
+**      jmp     func
+**
+** so the caller's stack frame is dropped before the call instead of staying
+** on the stack while func runs, and func returns directly to the caller's
+** caller. This is possible if func doesn't take parameters on the stack and
+** doesn't use the Y register, which is the only register changed by the
+** incsp routines.
+*/
+{
+    unsigned Changes = 0;
+
+    /* Walk over all entries minus the last one */
+    unsigned I = 0;
+    while (I < CS_GetEntryCount (S)) {
+
+        CodeEntry* N;
+        unsigned short Use, Chg;
+
+        /* Get this entry */
+        CodeEntry* E = CS_GetEntry (S, I);
+
+        /* Check for a subroutine call followed by a cleanup jump. The jump
+        ** must not have a label, since code jumping there expects just the
+        ** stack cleanup.
+        */
+        if (E->OPC == OP65_JSR                          &&
+            (N = CS_GetNextEntry (S, I)) != 0           &&
+            !CE_HasLabel (N)                            &&
+            N->OPC == OP65_JMP                          &&
+            N->JumpTo == 0                              &&
+            strncmp (N->Arg, "incsp", 5) == 0           &&
+            !FuncCallUsesStackParams (E->Arg)) {
+
+            /* Get the register usage of the called function and check that
+            ** it does not use the Y register, which is changed by incsp.
+            */
+            GetFuncInfo (E->Arg, &Use, &Chg);
+            if ((Use & REG_Y) == 0) {
+
+                /* Swap the call targets. The argument strings are interned,
+                ** so the old one stays valid.
+                */
+                const char* Func = E->Arg;
+                CE_SetArg (E, N->Arg);
+                CE_SetArg (N, Func);
+
+                /* Remember, we had changes */
+                ++Changes;
+
+            }
+        }
+
+        /* Next entry */
+        ++I;
+
+    }
+
+    /* Return the number of changes made */
+    return Changes;
+}
+
+
+
 /*****************************************************************************/
 /*                           Optimize jump targets                           */
 /*****************************************************************************/
@@ -1016,6 +1185,95 @@ unsigned OptCondBranches2 (CodeSeg* S)
 
 
 
+unsigned OptUnlikelyBranches (CodeSeg* S)
+/* Rearrange the code around conditional branches that were marked as likely
+** taken by __builtin_expect. The code generator emits the sequence
+**
+**      jxx  L1         <- branch likely taken
+**      <cold code>
+**      jmp  L2
+** L1:  <hot code>
+** L2:
+**
+** which makes the frequent path take the conditional branch. Inverting the
+** branch and exchanging both blocks lets the hot code fall through:
+**
+**      j!xx LC
+**      <hot code>
+**      jmp  L2
+** LC:  <cold code>
+** L2:
+*/
+{
+    unsigned Changes = 0;
+
+    /* Walk over the entries */
+    unsigned I = 0;
+    while (I < CS_GetEntryCount (S)) {
+
+        CodeLabel* L1;
+        CodeEntry* J;
+        unsigned   IL1;
+        unsigned   IL2;
+        unsigned   IJ;
+
+        /* Get next entry */
+        CodeEntry* E = CS_GetEntry (S, I);
+
+        /* Check for a conditional branch marked by the code generator */
+        if ((E->Flags & CEF_UNLIKELY) != 0        &&  /* Fall through is cold */
+            (E->Info & OF_CBRA) != 0              &&  /* It's a conditional branch */
+            (L1 = E->JumpTo) != 0                 &&  /* ..referencing a local label */
+            CL_GetRefCount (L1) == 1              &&  /* ..that has no other callers */
+            (IL1 = CS_GetEntryIndex (S, L1->Owner)) > I+2 &&  /* Cold code is not empty */
+            (J = CS_GetEntry (S, IL1-1)) != 0     &&  /* Last cold insn.. */
+            J->OPC == OP65_JMP                    &&  /* ..is a jump.. */
+            J->JumpTo != 0                        &&  /* ..to a local label.. */
+            (IL2 = CS_GetEntryIndex (S, J->JumpTo->Owner)) > IL1) { /* ..behind the hot code */
+
+            /* Index of the jump terminating the cold block */
+            IJ = IL1 - 1;
+
+            /* Invert the branch condition, so the cold code is the branch
+            ** target and the hot code is reached by falling through.
+            */
+            CE_ReplaceOPC (E, GetInverseBranch (E->OPC));
+
+            /* Retarget the branch to the start of the cold code. The label
+            ** on the hot code gets deleted with its last reference.
+            */
+            CS_MoveLabelRef (S, E, CS_GenLabel (S, CS_GetEntry (S, I+1)));
+
+            /* Move the cold code behind the hot code, in front of the entry
+            ** carrying the common label. Attached labels move with their
+            ** entries.
+            */
+            CS_MoveEntries (S, I+1, IJ - (I+1), IL2);
+
+            /* Move the terminating jump behind the hot code, so the cold
+            ** code ends with the jump to the common continuation as before.
+            */
+            CS_MoveEntries (S, I+1, 1, I+2 + (IL2 - IL1));
+
+            /* Reset the flag so the blocks aren't swapped back on a later run */
+            E->Flags &= ~CEF_UNLIKELY;
+
+            /* Remember, we had changes */
+            ++Changes;
+
+        }
+
+        /* Next entry */
+        ++I;
+
+    }
+
+    /* Return the number of changes made */
+    return Changes;
+}
+
+
+
 /*****************************************************************************/
 /*                      Remove unused loads and stores                       */
 /*****************************************************************************/
@@ -1162,6 +1420,13 @@ unsigned OptDupLoads (CodeSeg* S)
                     (N = CS_GetNextEntry (S, I)) != 0 && /* There is a next entry */
                     !CE_UseLoadFlags (N)) {              /* Which does not use the flags */
                     Delete = 1;
+                } else if (
+                    RegValIsKnown (In->RegA)          && /* Value of A is known */
+                    E->AM == AM65_ZP                  && /* Load from a zp register */
+                    In->RegA == ZPRegVal (E->Use, In) && /* Which has the same value */
+                    (N = CS_GetNextEntry (S, I)) != 0 && /* There is a next entry */
+                    !CE_UseLoadFlags (N)) {              /* Which does not use the flags */
+                    Delete = 1;
                 }
                 break;
 
@@ -1171,6 +1436,13 @@ unsigned OptDupLoads (CodeSeg* S)
                     (N = CS_GetNextEntry (S, I)) != 0 && /* There is a next entry */
                     !CE_UseLoadFlags (N)) {              /* Which does not use the flags */
                     Delete = 1;
+                } else if (
+                    RegValIsKnown (In->RegX)          && /* Value of X is known */
+                    E->AM == AM65_ZP                  && /* Load from a zp register */
+                    In->RegX == ZPRegVal (E->Use, In) && /* Which has the same value */
+                    (N = CS_GetNextEntry (S, I)) != 0 && /* There is a next entry */
+                    !CE_UseLoadFlags (N)) {              /* Which does not use the flags */
+                    Delete = 1;
                 }
                 break;
 
@@ -1180,6 +1452,13 @@ unsigned OptDupLoads (CodeSeg* S)
                     (N = CS_GetNextEntry (S, I)) != 0 && /* There is a next entry */
                     !CE_UseLoadFlags (N)) {              /* Which does not use the flags */
                     Delete = 1;
+                } else if (
+                    RegValIsKnown (In->RegY)          && /* Value of Y is known */
+                    E->AM == AM65_ZP                  && /* Load from a zp register */
+                    In->RegY == ZPRegVal (E->Use, In) && /* Which has the same value */
+                    (N = CS_GetNextEntry (S, I)) != 0 && /* There is a next entry */
+                    !CE_UseLoadFlags (N)) {              /* Which does not use the flags */
+                    Delete = 1;
                 }
                 break;
 
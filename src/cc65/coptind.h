@@ -63,6 +63,12 @@ unsigned OptDeadCode (CodeSeg* S);
 ** and has no label)
 */
 
+unsigned OptBlockMove (CodeSeg* S);
+/* Move basic blocks that are reachable only through one unconditional jump
+** directly behind that jump, so the jump can be removed and the code simply
+** falls through into the block.
+*/
+
 unsigned OptJumpCascades (CodeSeg* S);
 /* Optimize jump cascades (jumps to jumps). In such a case, the jump is
 ** replaced by a jump to the final location. This will in some cases produce
@@ -77,6 +83,12 @@ unsigned OptRTS (CodeSeg* S);
 ** label, the dead code elimination should take care of it.
 */
 
+unsigned OptTailCall (CodeSeg* S);
+/* Turn a subroutine call followed by a stack cleanup jump into a tail call
+** by doing the stack cleanup first and jumping to the function, if the
+** function doesn't take parameters on the stack.
+*/
+
 unsigned OptJumpTarget1 (CodeSeg* S);
 /* If the instruction preceeding an unconditional branch is the same as the
 ** instruction preceeding the jump target, the jump target may be moved
@@ -106,6 +118,12 @@ unsigned OptCondBranches2 (CodeSeg* S);
 ** we can remove the rol and branch on the state of the carry.
 */
 
+unsigned OptUnlikelyBranches (CodeSeg* S);
+/* Rearrange the code around conditional branches that were marked as likely
+** taken by __builtin_expect, so that the frequently executed code becomes the
+** fall through path and the cold code is moved out of line.
+*/
+
 unsigned OptUnusedLoads (CodeSeg* S);
 /* Remove loads of registers where the value loaded is not used later. */
 
@@ -0,0 +1,298 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                               coptinline.c                                */
+/*                                                                           */
+/*              Inline expansion of small static function calls              */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#include <string.h>
+
+/* common */
+#include "chartype.h"
+#include "check.h"
+#include "coll.h"
+#include "xmalloc.h"
+
+/* cc65 */
+#include "codeent.h"
+#include "codelab.h"
+#include "coptinline.h"
+#include "funcdesc.h"
+#include "opcodes.h"
+#include "symentry.h"
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* Maximum number of insns in an inline candidate, not counting the final
+** return. Code size is limited separately, see OptInlineCalls.
+*/
+#define INLINE_MAX_ENTRIES      16U
+
+/* One inline candidate. Since function code segments are kept until the
+** final output is written (see FinishCompile), the entries can be copied
+** directly from the optimized segment when a call is expanded.
+*/
+typedef struct InlineFunc InlineFunc;
+struct InlineFunc {
+    const char* Name;           /* Assembler name of the function */
+    CodeSeg*    Seg;            /* Optimized code for the function */
+    unsigned    Bytes;          /* Code size without the final return */
+};
+
+/* List of all inline candidates */
+static Collection InlineFuncs = STATIC_COLLECTION_INITIALIZER;
+
+
+
+/*****************************************************************************/
+/*                                 Helpers                                   */
+/*****************************************************************************/
+
+
+
+static InlineFunc* FindInlineFunc (const char* Name)
+/* Search for an inline candidate with the given assembler name. Return the
+** candidate or NULL if not found.
+*/
+{
+    unsigned I;
+    for (I = 0; I < CollCount (&InlineFuncs); ++I) {
+        InlineFunc* IF = CollAtUnchecked (&InlineFuncs, I);
+        if (strcmp (IF->Name, Name) == 0) {
+            return IF;
+        }
+    }
+    return 0;
+}
+
+
+
+static int UnsafeInlineArg (const char* Arg)
+/* Return true if an insn with the given argument cannot be copied into
+** another function. This is the case if the argument references the
+** parameter stack or the register bank save area, or if it references a
+** local label, since those are scoped to the .proc of their function.
+*/
+{
+    const char* P;
+
+    if (strstr (Arg, "sp") != 0         ||
+        strstr (Arg, "regsave") != 0    ||
+        strstr (Arg, "regbank") != 0) {
+        return 1;
+    }
+
+    /* Check for something that looks like a local label. Branch targets
+    ** don't get here, they are renamed when the body is copied.
+    */
+    for (P = Arg; *P != '\0'; ++P) {
+        if (P[0] == 'L'          && IsXDigit (P[1]) &&
+            IsXDigit (P[2])      && IsXDigit (P[3]) &&
+            IsXDigit (P[4])) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+
+static unsigned ExpandInlineCall (CodeSeg* S, unsigned Index, const InlineFunc* IF)
+/* Replace the jsr at Index by a copy of the body of IF. The entry behind
+** the call must exist. Return the number of entries inserted.
+*/
+{
+    CodeEntry* Clones[INLINE_MAX_ENTRIES];
+    CodeSeg*   B = IF->Seg;
+    unsigned   N = CS_GetEntryCount (B) - 1;    /* Don't copy the return */
+    LineInfo*  LI = CS_GetEntry (S, Index)->LI;
+    unsigned   J;
+
+    /* Insert copies of the body insns behind the call. Branches within the
+    ** body may have been shortened; insert them in their long form again,
+    ** the branch distance pass of the caller will shorten them back where
+    ** possible.
+    */
+    for (J = 0; J < N; ++J) {
+        CodeEntry* BE = CS_GetEntry (B, J);
+        opc_t OPC = BE->OPC;
+        if ((BE->Info & OF_BRA) != 0 && BE->JumpTo != 0) {
+            OPC = MakeLongBranch (OPC);
+        }
+        Clones[J] = NewCodeEntry (OPC, BE->AM, BE->Arg, 0, LI);
+        CS_InsertEntry (S, Clones[J], Index + 1 + J);
+    }
+
+    /* Remove the call insn. Labels attached to it are moved to the first
+    ** body insn, which does not have any labels yet, so the labels and
+    ** their references stay intact.
+    */
+    CS_DelEntry (S, Index);
+
+    /* Transfer the branch targets. A branch to the final return of the
+    ** body is replaced by a branch behind the inlined code.
+    */
+    for (J = 0; J < N; ++J) {
+        CodeEntry* BE = CS_GetEntry (B, J);
+        if (BE->JumpTo != 0) {
+            CodeEntry* Owner = BE->JumpTo->Owner;
+            CodeLabel* L;
+            if (Owner == CS_GetEntry (B, N)) {
+                L = CS_GenLabel (S, CS_GetEntry (S, Index + N));
+            } else {
+                unsigned K = 0;
+                while (K < N && CS_GetEntry (B, K) != Owner) {
+                    ++K;
+                }
+                CHECK (K < N);
+                L = CS_GenLabel (S, Clones[K]);
+            }
+            CL_AddRef (L, Clones[J]);
+        }
+    }
+
+    /* Done */
+    return N;
+}
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+unsigned OptInlineCalls (CodeSeg* S)
+/* Replace calls to already optimized small static functions by a copy of
+** the function body. Return the number of expanded calls.
+*/
+{
+    unsigned Expansions = 0;
+    unsigned I = 0;
+
+    /* A call insn is three bytes, allow the body to be larger by an amount
+    ** that depends on how much we are allowed to optimize for speed.
+    */
+    unsigned MaxBytes = 3U + (3U * S->CodeSizeFactor) / 100U;
+
+    /* Inserted bodies are not rescanned, a candidate body can only contain
+    ** calls to candidates that were registered after it.
+    */
+    while (I + 1 < CS_GetEntryCount (S)) {
+        CodeEntry* E = CS_GetEntry (S, I);
+        InlineFunc* IF;
+        if (E->OPC == OP65_JSR                  &&
+            E->JumpTo == 0                      &&
+            (IF = FindInlineFunc (E->Arg)) != 0 &&
+            IF->Bytes <= MaxBytes               &&
+            IF->Seg != S) {
+            I += ExpandInlineCall (S, I, IF);
+            ++Expansions;
+        } else {
+            ++I;
+        }
+    }
+
+    return Expansions;
+}
+
+
+
+void RegisterInlineFunc (CodeSeg* S)
+/* Remember the given optimized code segment for inline expansion into its
+** callers if the function is a suitable candidate.
+*/
+{
+    const FuncDesc* D;
+    InlineFunc*     IF;
+    CodeEntry*      E;
+    unsigned        Count;
+    unsigned        Bytes;
+    unsigned        I;
+
+    /* Candidates are static functions without parameters, so the inlined
+    ** body does not access the parameter stack. Functions with external
+    ** linkage may be replaced by another definition at link time.
+    */
+    if (S->Func == 0 || (S->Func->Flags & SC_EXTERN) != 0) {
+        return;
+    }
+    D = GetFuncDesc (S->Func->Type);
+    if (D->ParamCount > 0 || (D->Flags & (FD_EMPTY | FD_VARIADIC)) != 0) {
+        return;
+    }
+
+    /* The body must be small and must end with the one and only return */
+    Count = CS_GetEntryCount (S);
+    if (Count < 2 || Count > INLINE_MAX_ENTRIES + 1) {
+        return;
+    }
+    if (CS_GetEntry (S, Count-1)->OPC != OP65_RTS) {
+        return;
+    }
+
+    /* Check the body insns and determine the code size */
+    Bytes = 0;
+    for (I = 0; I < Count-1; ++I) {
+
+        E = CS_GetEntry (S, I);
+
+        /* No other returns or insns changing the hardware stack pointer */
+        if ((E->Info & OF_RET) != 0     ||
+            E->OPC == OP65_BRK          ||
+            E->OPC == OP65_TXS          ||
+            E->OPC == OP65_TSX) {
+            return;
+        }
+
+        if ((E->Info & OF_BRA) != 0 || E->JumpTo != 0) {
+            /* Branches must go to a label within the function. This also
+            ** rejects tail jumps to other functions and jump tables.
+            */
+            if (E->JumpTo == 0 || E->JumpTo->Owner == 0) {
+                return;
+            }
+        } else if (E->Arg[0] != '\0' && UnsafeInlineArg (E->Arg)) {
+            return;
+        }
+
+        Bytes += E->Size;
+    }
+
+    /* Remember the function as an inline candidate */
+    IF = xmalloc (sizeof (InlineFunc));
+    IF->Name  = S->Func->AsmName;
+    IF->Seg   = S;
+    IF->Bytes = Bytes;
+    CollAppend (&InlineFuncs, IF);
+}
@@ -0,0 +1,60 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                               coptinline.h                                */
+/*                                                                           */
+/*              Inline expansion of small static function calls              */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#ifndef COPTINLINE_H
+#define COPTINLINE_H
+
+
+
+/* cc65 */
+#include "codeseg.h"
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+unsigned OptInlineCalls (CodeSeg* S);
+/* Replace calls to already optimized small static functions by a copy of
+** the function body. Return the number of expanded calls.
+*/
+
+void RegisterInlineFunc (CodeSeg* S);
+/* Remember the given optimized code segment for inline expansion into its
+** callers if the function is a suitable candidate.
+*/
+
+
+
+/* End of coptinline.h */
+
+#endif
@@ -0,0 +1,334 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                coptloop.c                                 */
+/*                                                                           */
+/*                      Loop invariant code optimizations                    */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#include <string.h>
+
+/* common */
+#include "coll.h"
+
+/* cc65 */
+#include "codeent.h"
+#include "codeinfo.h"
+#include "codelab.h"
+#include "coptloop.h"
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* Register loads that may be hoisted, together with the register changed */
+static const struct {
+    opc_t           OPC;        /* Load instruction */
+    unsigned short  Reg;        /* Register changed by the load */
+} LoadTab[] = {
+    { OP65_LDA, REG_A },
+    { OP65_LDX, REG_X },
+    { OP65_LDY, REG_Y },
+};
+
+
+
+/*****************************************************************************/
+/*                              Helper functions                             */
+/*****************************************************************************/
+
+
+
+static int CheckLoopRegion (CodeSeg* S, unsigned Head, unsigned Back)
+/* Check if the entries in the range Head..Back form a loop region that is
+** entered by fall-through into Head only. This is the case if all labels
+** within the range are referenced exclusively by real branches from within
+** the range, and if the range contains neither return instructions nor
+** jumps to external symbols. Return true if the range is such a region.
+*/
+{
+    unsigned I;
+
+    for (I = Head; I <= Back; ++I) {
+
+        unsigned LabelCount;
+        unsigned J;
+
+        /* Get the next entry */
+        CodeEntry* E = CS_GetEntry (S, I);
+
+        /* Return instructions and jumps to external symbols leave the
+        ** function with unknown register use, so reject the region.
+        */
+        if (E->Info & OF_RET) {
+            return 0;
+        }
+        if ((E->Info & OF_BRA) != 0 &&
+            (E->JumpTo == 0 || E->JumpTo->Owner == 0)) {
+            return 0;
+        }
+
+        /* Check the references to all labels of this entry */
+        LabelCount = CE_GetLabelCount (E);
+        for (J = 0; J < LabelCount; ++J) {
+
+            CodeLabel* L = CE_GetLabel (E, J);
+            unsigned K;
+
+            for (K = 0; K < CollCount (&L->JumpFrom); ++K) {
+
+                unsigned RefIndex;
+
+                /* Get the referencing entry */
+                CodeEntry* Ref = CollAtUnchecked (&L->JumpFrom, K);
+
+                /* Data references (as for jump tables) may come from
+                ** anywhere, so be safe and reject the region.
+                */
+                if (Ref->JumpTo != L) {
+                    return 0;
+                }
+
+                /* The branch must come from within the region */
+                RefIndex = CS_GetEntryIndex (S, Ref);
+                if (RefIndex < Head || RefIndex > Back) {
+                    return 0;
+                }
+            }
+        }
+    }
+
+    /* Region is ok */
+    return 1;
+}
+
+
+
+static int RegDeadAtExits (CodeSeg* S, unsigned Head, unsigned Back, unsigned Reg)
+/* Check if the register Reg is dead at all exits of the loop region in
+** Head..Back, so a changed register value on early iterations cannot be
+** observed outside of the loop. Return true if this is the case.
+*/
+{
+    unsigned I;
+
+    for (I = Head; I <= Back; ++I) {
+
+        /* Get the next entry */
+        CodeEntry* E = CS_GetEntry (S, I);
+
+        /* We're only interested in branches that leave the region */
+        if ((E->Info & OF_BRA) != 0 && E->JumpTo != 0) {
+            unsigned Target = CS_GetEntryIndex (S, E->JumpTo->Owner);
+            if (Target < Head || Target > Back) {
+                /* Branch to the outside - check liveness at the target */
+                if ((GetRegInfo (S, Target, Reg) & Reg) != 0) {
+                    return 0;
+                }
+            }
+        }
+    }
+
+    /* If the back edge branch is conditional, the loop also exits by falling
+    ** through behind it.
+    */
+    if ((CS_GetEntry (S, Back)->Info & OF_UBRA) == 0) {
+        if (Back + 1 >= CS_GetEntryCount (S) ||
+            (GetRegInfo (S, Back + 1, Reg) & Reg) != 0) {
+            return 0;
+        }
+    }
+
+    /* Register is dead at all exits */
+    return 1;
+}
+
+
+
+static int HoistRegLoad (CodeSeg* S, unsigned Head, unsigned Back,
+                         opc_t OPC, unsigned Reg)
+/* Try to hoist an invariant immediate load of the given register out of the
+** loop region in Head..Back. Return true if code was changed.
+*/
+{
+    CodeEntry* Load = 0;
+    unsigned First = 0;
+    unsigned I;
+    CodeEntry* X;
+
+    /* Walk over the region and check that all changes of the register are
+    ** loads of one and the same immediate value.
+    */
+    for (I = Head; I <= Back; ++I) {
+
+        /* Get the next entry */
+        CodeEntry* E = CS_GetEntry (S, I);
+
+        /* Skip entries that don't change the register */
+        if ((E->Chg & Reg) == 0) {
+            continue;
+        }
+
+        /* Check for an immediate load of the register */
+        if (E->OPC != OPC || E->AM != AM65_IMM) {
+            return 0;
+        }
+        if (Load == 0) {
+            /* First load found */
+            Load = E;
+            First = I;
+        } else if (strcmp (E->Arg, Load->Arg) != 0) {
+            /* Load of a different value */
+            return 0;
+        }
+
+        /* Deleting the load must not invalidate a flag use in the following
+        ** instruction.
+        */
+        if (CE_UseLoadFlags (CS_GetEntry (S, I + 1))) {
+            return 0;
+        }
+    }
+
+    /* Bail out if there is nothing to hoist */
+    if (Load == 0) {
+        return 0;
+    }
+
+    /* On the first iteration, the register does still contain its pre loop
+    ** value until the first load is executed, so the code before the first
+    ** load must not use the register.
+    */
+    for (I = Head; I < First; ++I) {
+        if ((CS_GetEntry (S, I)->Use & Reg) != 0) {
+            return 0;
+        }
+    }
+
+    /* For the same reason, the register must be dead at all loop exits */
+    if (!RegDeadAtExits (S, Head, Back, Reg)) {
+        return 0;
+    }
+
+    /* The load placed in front of the loop changes the flags, so the loop
+    ** header must not consume flags set by the preceding code.
+    */
+    if (CE_UseLoadFlags (CS_GetEntry (S, Head))) {
+        return 0;
+    }
+
+    /* Insert a copy of the load into the preheader. The loop label stays
+    ** attached to the old header entry, so branches within the loop will
+    ** not reexecute the load.
+    */
+    X = NewCodeEntry (Load->OPC, Load->AM, Load->Arg, 0, Load->LI);
+    CS_InsertEntry (S, X, Head);
+
+    /* Remove the loads within the loop. Go backwards, since deletion will
+    ** move down the following entries. All region indices have moved up by
+    ** one because of the insertion above.
+    */
+    for (I = Back + 1; I > Head + 1; --I) {
+        CodeEntry* E = CS_GetEntry (S, I - 1);
+        if ((E->Chg & Reg) != 0) {
+            CS_DelEntry (S, I - 1);
+        }
+    }
+
+    /* Remember we had changes */
+    return 1;
+}
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+unsigned OptLoopInvariants (CodeSeg* S)
+/* Search for loops that reload a register with the same immediate value on
+** every iteration and hoist the load into a preheader in front of the loop.
+*/
+{
+    unsigned Changes = 0;
+    unsigned I;
+
+    /* Walk over the entries searching for back edges */
+    I = 0;
+    while (I < CS_GetEntryCount (S)) {
+
+        unsigned Head;
+        unsigned J;
+
+        /* Get next entry */
+        CodeEntry* E = CS_GetEntry (S, I);
+
+        /* Check for a backward branch to a label within the function */
+        if ((E->Info & OF_BRA) == 0 ||
+            E->JumpTo == 0          ||
+            E->JumpTo->Owner == 0) {
+            ++I;
+            continue;
+        }
+        Head = CS_GetEntryIndex (S, E->JumpTo->Owner);
+        if (Head >= I) {
+            ++I;
+            continue;
+        }
+
+        /* The region between the branch target and the branch is a loop if
+        ** it can only be entered by falling into its first entry.
+        */
+        if (!CheckLoopRegion (S, Head, I)) {
+            ++I;
+            continue;
+        }
+
+        /* Try to hoist invariant loads for each of the registers */
+        for (J = 0; J < sizeof (LoadTab) / sizeof (LoadTab[0]); ++J) {
+            if (HoistRegLoad (S, Head, I, LoadTab[J].OPC, LoadTab[J].Reg)) {
+                /* Hoisting did insert and delete entries, so recalculate
+                ** the region boundaries before trying the next register.
+                */
+                Head = CS_GetEntryIndex (S, E->JumpTo->Owner);
+                I    = CS_GetEntryIndex (S, E);
+                ++Changes;
+            }
+        }
+
+        /* Next entry. Deleted loads lie before the back edge, so the branch
+        ** index can only have moved down and the scan may simply continue.
+        */
+        ++I;
+    }
+
+    /* Return the number of changes made */
+    return Changes;
+}
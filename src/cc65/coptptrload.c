@@ -1671,3 +1671,286 @@ unsigned OptPtrLoad19 (CodeSeg* S)
     /* Return the number of changes made */
     return Changes;
 }
+
+
+
+/* Zero page pointer bytes tracked by OptPtrReload */
+static const char* const PtrBytes[4] = {
+    "ptr1", "ptr1+1", "ptr2", "ptr2+1"
+};
+
+/* Source of a value loaded into the accumulator or stored into one of the
+** tracked zero page pointer bytes. Index is the known value of the index
+** register used by the addressing mode, or -1 if the mode is not indexed.
+*/
+typedef struct LoadSrc LoadSrc;
+struct LoadSrc {
+    int         Valid;          /* True if the source is known */
+    am_t        AM;             /* Addressing mode of the load */
+    const char* Arg;            /* Argument of the load */
+    int         Index;          /* Index register value or -1 */
+};
+
+
+
+static int FindPtrByte (const char* Arg)
+/* Return the tracking slot for the given argument or -1 if it is not one of
+** the tracked zero page pointer bytes.
+*/
+{
+    int I;
+    for (I = 0; I < 4; ++I) {
+        if (strcmp (Arg, PtrBytes[I]) == 0) {
+            return I;
+        }
+    }
+    return -1;
+}
+
+
+
+static int IsMemWrite (const CodeEntry* E)
+/* Check if E writes to a memory location */
+{
+    switch (E->OPC) {
+        case OP65_STA:
+        case OP65_STX:
+        case OP65_STY:
+        case OP65_STZ:
+            return 1;
+        case OP65_ASL:
+        case OP65_DEC:
+        case OP65_INC:
+        case OP65_LSR:
+        case OP65_ROL:
+        case OP65_ROR:
+        case OP65_TRB:
+        case OP65_TSB:
+            return (E->AM != AM65_ACC && E->AM != AM65_IMP);
+        default:
+            return 0;
+    }
+}
+
+
+
+unsigned OptPtrReload (CodeSeg* S)
+/* Track the contents of the zero page pointer registers and remove a store
+** to such a register if it does already contain the stored value. This
+** removes the redundant pointer setup done for consecutive accesses through
+** the same pointer; the loads feeding the removed stores are left to the
+** unused load removal passes. Tracking is conservative: it is reset at
+** labels and subroutine calls, and memory sources are invalidated by stores
+** that may alias them.
+*/
+{
+    unsigned Changes = 0;
+    unsigned I;
+    int J;
+
+    LoadSrc ASrc;               /* Source of the accumulator contents */
+    LoadSrc XSrc;               /* Source of the X register contents */
+    LoadSrc Ptr[4];             /* Source of the tracked pointer bytes */
+
+    /* Start with unknown contents */
+    ASrc.Valid = 0;
+    XSrc.Valid = 0;
+    for (J = 0; J < 4; ++J) {
+        Ptr[J].Valid = 0;
+    }
+
+    /* Walk over the entries */
+    I = 0;
+    while (I < CS_GetEntryCount (S)) {
+
+        int B;
+        LoadSrc* Src;
+
+        /* Get next entry */
+        CodeEntry* E = CS_GetEntry (S, I);
+
+        /* A label is a control flow join, so forget all we know */
+        if (CE_HasLabel (E)) {
+            ASrc.Valid = 0;
+            XSrc.Valid = 0;
+            for (J = 0; J < 4; ++J) {
+                Ptr[J].Valid = 0;
+            }
+        }
+
+        if (E->OPC == OP65_JSR || (E->Info & (OF_UBRA | OF_RET)) != 0) {
+
+            /* A subroutine may change the pointer registers and memory,
+            ** and behind an unconditional flow change the state is void.
+            */
+            ASrc.Valid = 0;
+            XSrc.Valid = 0;
+            for (J = 0; J < 4; ++J) {
+                Ptr[J].Valid = 0;
+            }
+
+        } else if (E->OPC == OP65_LDA || E->OPC == OP65_LDX) {
+
+            /* Remember where the register contents came from if the source
+            ** is one we can compare later.
+            */
+            Src = (E->OPC == OP65_LDA)? &ASrc : &XSrc;
+            switch (E->AM) {
+
+                case AM65_IMM:
+                case AM65_ZP:
+                case AM65_ABS:
+                    Src->Valid = 1;
+                    Src->AM    = E->AM;
+                    Src->Arg   = E->Arg;
+                    Src->Index = -1;
+                    break;
+
+                case AM65_ZPX:
+                case AM65_ABSX:
+                    Src->Valid = RegValIsKnown (E->RI->In.RegX);
+                    Src->AM    = E->AM;
+                    Src->Arg   = E->Arg;
+                    Src->Index = E->RI->In.RegX;
+                    break;
+
+                case AM65_ZPY:
+                case AM65_ABSY:
+                case AM65_ZP_INDY:
+                    Src->Valid = RegValIsKnown (E->RI->In.RegY);
+                    Src->AM    = E->AM;
+                    Src->Arg   = E->Arg;
+                    Src->Index = E->RI->In.RegY;
+                    break;
+
+                default:
+                    Src->Valid = 0;
+                    break;
+            }
+
+        } else if ((E->OPC == OP65_STA || E->OPC == OP65_STX)    &&
+                   E->AM == AM65_ZP                              &&
+                   (B = FindPtrByte (E->Arg)) >= 0) {
+
+            /* Store to a tracked pointer byte. If the byte does already
+            ** contain the value, the store is redundant.
+            */
+            Src = (E->OPC == OP65_STA)? &ASrc : &XSrc;
+            if (Src->Valid                  &&
+                Ptr[B].Valid                &&
+                Src->AM == Ptr[B].AM        &&
+                Src->Index == Ptr[B].Index  &&
+                strcmp (Src->Arg, Ptr[B].Arg) == 0) {
+
+                /* Remove the store. The loads that feed it will be
+                ** removed by OptUnusedLoads if they are unused.
+                */
+                CS_DelEntry (S, I);
+
+                /* Remember, we had changes */
+                ++Changes;
+
+                /* Don't skip the entry moved into this slot */
+                continue;
+            }
+
+            /* Remember the new contents of this pointer byte. A value that
+            ** was loaded from this location is invalidated by the store.
+            */
+            Ptr[B] = *Src;
+            for (J = 0; J < 4; ++J) {
+                if (J != B                          &&
+                    Ptr[J].Valid                    &&
+                    Ptr[J].AM == AM65_ZP            &&
+                    strcmp (Ptr[J].Arg, E->Arg) == 0) {
+                    Ptr[J].Valid = 0;
+                }
+            }
+            if (ASrc.Valid && ASrc.AM == AM65_ZP && strcmp (ASrc.Arg, E->Arg) == 0) {
+                ASrc.Valid = 0;
+            }
+            if (XSrc.Valid && XSrc.AM == AM65_ZP && strcmp (XSrc.Arg, E->Arg) == 0) {
+                XSrc.Valid = 0;
+            }
+
+        } else if (IsMemWrite (E)) {
+
+            /* A write to memory may change the source locations of the
+            ** values we track. The zero page registers and the data the
+            ** program may point to don't overlap, so a write to a named
+            ** zero page location aliases only a source with the same name,
+            ** and a write to static data aliases only sources in static
+            ** data. Indirect writes may go anywhere, and an indexed write
+            ** into the zero page may also hit the pointer registers.
+            */
+            LoadSrc* Srcs[6];
+            Srcs[0] = &ASrc;
+            Srcs[1] = &XSrc;
+            for (J = 0; J < 4; ++J) {
+                Srcs[J+2] = &Ptr[J];
+            }
+
+            switch (E->AM) {
+
+                case AM65_ZP:
+                    if ((B = FindPtrByte (E->Arg)) >= 0) {
+                        Ptr[B].Valid = 0;
+                    }
+                    for (J = 0; J < 6; ++J) {
+                        if (Srcs[J]->Valid &&
+                            ((Srcs[J]->AM == AM65_ZP &&
+                              strcmp (Srcs[J]->Arg, E->Arg) == 0) ||
+                             (Srcs[J]->AM == AM65_ZP_INDY &&
+                              strncmp (E->Arg, Srcs[J]->Arg, strlen (Srcs[J]->Arg)) == 0))) {
+                            Srcs[J]->Valid = 0;
+                        }
+                    }
+                    break;
+
+                case AM65_ABS:
+                case AM65_ABSX:
+                case AM65_ABSY:
+                    for (J = 0; J < 6; ++J) {
+                        if (Srcs[J]->Valid &&
+                            (Srcs[J]->AM == AM65_ABS || Srcs[J]->AM == AM65_ABSX ||
+                             Srcs[J]->AM == AM65_ABSY)) {
+                            Srcs[J]->Valid = 0;
+                        }
+                    }
+                    break;
+
+                default:
+                    /* Indirect or indexed zero page write */
+                    if (E->AM == AM65_ZPX || E->AM == AM65_ZPY || E->AM == AM65_ZPX_IND) {
+                        for (J = 0; J < 4; ++J) {
+                            Ptr[J].Valid = 0;
+                        }
+                    }
+                    for (J = 0; J < 6; ++J) {
+                        if (Srcs[J]->Valid && Srcs[J]->AM != AM65_IMM) {
+                            Srcs[J]->Valid = 0;
+                        }
+                    }
+                    break;
+            }
+
+        } else {
+
+            /* Register contents change in ways we don't track */
+            if ((E->Chg & REG_A) != 0) {
+                ASrc.Valid = 0;
+            }
+            if ((E->Chg & REG_X) != 0) {
+                XSrc.Valid = 0;
+            }
+
+        }
+
+        /* Next entry */
+        ++I;
+
+    }
+
+    /* Return the number of changes made */
+    return Changes;
+}
@@ -404,6 +404,13 @@ unsigned OptPtrLoad19 (CodeSeg* S);
 **      ldx     label+1,y
 */
 
+unsigned OptPtrReload (CodeSeg* S);
+/* Track the contents of the zero page pointer registers and remove a store
+** to such a register if it does already contain the stored value. This
+** removes the redundant pointer setup done for consecutive accesses through
+** the same pointer.
+*/
+
 
 /* End of coptptrload.h */
 
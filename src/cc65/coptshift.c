@@ -768,3 +768,66 @@ NextEntry:
     /* Return the number of changes made */
     return Changes;
 }
+
+
+
+unsigned OptShift7 (CodeSeg* S)
+/* Search for consecutive calls to a left shift subroutine and combine them
+** into one call with the summed shift count, if such a routine exists. This
+** folds the chains left behind by the shift/add decomposition of constant
+** multiplications (e.g. 5 << 6 emits shlax4 followed by shlax2).
+*/
+{
+    unsigned Changes = 0;
+
+    /* Walk over the entries */
+    unsigned I = 0;
+    while (I < CS_GetEntryCount (S)) {
+
+        unsigned   Shift1;
+        unsigned   Shift2;
+        unsigned   Count;
+        CodeEntry* N;
+
+        /* Get next entry */
+        CodeEntry* E = CS_GetEntry (S, I);
+
+        /* Check for two consecutive calls to left shift routines of the
+        ** same type. The second one must not have a label, since code
+        ** jumping there expects only one of the shifts.
+        */
+        if (E->OPC == OP65_JSR                                  &&
+            (Shift1 = GetShift (E->Arg)) != SHIFT_NONE          &&
+            SHIFT_DIR (Shift1) == SHIFT_DIR_LEFT                &&
+            SHIFT_COUNT (Shift1) != SHIFT_COUNT_Y               &&
+            (N = CS_GetNextEntry (S, I)) != 0                   &&
+            !CE_HasLabel (N)                                    &&
+            N->OPC == OP65_JSR                                  &&
+            (Shift2 = GetShift (N->Arg)) != SHIFT_NONE          &&
+            SHIFT_TYPE (Shift2) == SHIFT_TYPE (Shift1)          &&
+            SHIFT_COUNT (Shift2) != SHIFT_COUNT_Y               &&
+            (Count = SHIFT_COUNT (Shift1) + SHIFT_COUNT (Shift2)) <= 7) {
+
+            /* Build the name of the combined routine */
+            char Name[7];
+            memcpy (Name, E->Arg, 5);
+            Name[5] = (char) ('0' + Count);
+            Name[6] = '\0';
+
+            /* Replace the first call and remove the second one */
+            CE_SetArg (E, Name);
+            CS_DelEntry (S, I+1);
+
+            /* Remember, we had changes */
+            ++Changes;
+
+        }
+
+        /* Next entry */
+        ++I;
+
+    }
+
+    /* Return the number of changes made */
+    return Changes;
+}
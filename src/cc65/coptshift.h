@@ -122,6 +122,11 @@ unsigned OptShift5 (CodeSeg* S);
 unsigned OptShift6 (CodeSeg* S);
 /* Inline the shift subroutines. */
 
+unsigned OptShift7 (CodeSeg* S);
+/* Combine consecutive calls to left shift subroutines into one call with
+** the summed shift count.
+*/
+
 
 
 /* End of coptshift.h */
@@ -34,9 +34,11 @@
 
 
 #include <stdlib.h>
+#include <string.h>
 
 /* common */
 #include "chartype.h"
+#include "xmalloc.h"
 
 /* cc65 */
 #include "codeent.h"
@@ -2199,6 +2201,7 @@ unsigned OptStackOps (CodeSeg* S)
     unsigned            PushedRegs;     /* Track if the same regs are used after the push */
     int                 RhsALoadIndex;  /* Track if rhs is changed more than once */
     int                 RhsXLoadIndex;  /* Track if rhs is changed more than once */
+    unsigned short*     ZPRegUsage;     /* Cached zero page usage by index */
 
     enum {
         Initialize,
@@ -2211,6 +2214,16 @@ unsigned OptStackOps (CodeSeg* S)
     /* Remember the code segment in the info struct */
     Data.Code = S;
 
+    /* The zero page usage beyond a given index depends only on the code,
+    ** which doesn't change while searching. Since a failed match restarts
+    ** after the push and will often find the same op again, cache the
+    ** results of the forward scans until the code is actually changed.
+    ** 0xFFFF means "not computed yet", which cannot be a valid result,
+    ** since GetRegInfo masks its result by the registers asked for.
+    */
+    ZPRegUsage = xmalloc (CS_GetEntryCount (S) * sizeof (*ZPRegUsage));
+    memset (ZPRegUsage, 0xFF, CS_GetEntryCount (S) * sizeof (*ZPRegUsage));
+
     /* Look for a call to pushax followed by a call to some other function
     ** that takes it's first argument on the stack, and the second argument
     ** in the primary register.
@@ -2387,7 +2400,11 @@ unsigned OptStackOps (CodeSeg* S)
 
             case FoundOp:
                 /* Track zero page location usage beyond this point */
-                Data.ZPUsage |= GetRegInfo (S, I, REG_SREG | REG_PTR1 | REG_PTR2);
+                if (ZPRegUsage[I] == 0xFFFF) {
+                    ZPRegUsage[I] = (unsigned short)
+                        GetRegInfo (S, I, REG_SREG | REG_PTR1 | REG_PTR2);
+                }
+                Data.ZPUsage |= ZPRegUsage[I];
 
                 /* Finalize the load info */
                 FinalizeLoadInfo (&Data.Lhs, S);
@@ -2462,6 +2479,11 @@ unsigned OptStackOps (CodeSeg* S)
                 /* Regenerate register info */
                 CS_GenRegInfo (S);
 
+                /* The code has changed, so the cached usage info is stale */
+                xfree (ZPRegUsage);
+                ZPRegUsage = xmalloc (CS_GetEntryCount (S) * sizeof (*ZPRegUsage));
+                memset (ZPRegUsage, 0xFF, CS_GetEntryCount (S) * sizeof (*ZPRegUsage));
+
                 /* Done */
                 State = Initialize;
                 continue;
@@ -2473,6 +2495,9 @@ unsigned OptStackOps (CodeSeg* S)
 
     }
 
+    /* Free the usage cache */
+    xfree (ZPRegUsage);
+
     /* Return the number of changes made */
     return Changes;
 }
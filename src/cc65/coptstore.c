@@ -434,3 +434,95 @@ unsigned OptStore5 (CodeSeg* S)
     /* Return the number of changes made */
     return Changes;
 }
+
+
+
+unsigned OptUnusedStackStores (CodeSeg* S)
+/* Remove a "sta (sp),y" store into a stack slot, if the same slot is
+** overwritten by a second store before the value can be read. Such dead
+** stores remain for temporary subexpression results that other steps have
+** replaced by direct operations.
+*/
+{
+    unsigned Changes = 0;
+
+    /* Walk over the entries */
+    unsigned I = 0;
+    while (I < CS_GetEntryCount (S)) {
+
+        /* Get next entry */
+        CodeEntry* E = CS_GetEntry (S, I);
+
+        /* Check for a store into a stack slot with known offset */
+        if (E->OPC == OP65_STA              &&
+            E->AM == AM65_ZP_INDY           &&
+            strcmp (E->Arg, "sp") == 0      &&
+            RegValIsKnown (E->RI->In.RegY)) {
+
+            /* Offset of the slot that is written */
+            short Slot = E->RI->In.RegY;
+
+            /* Walk over the following straight line code and check if the
+            ** slot is overwritten before it can be read.
+            */
+            unsigned J = I + 1;
+            while (J < CS_GetEntryCount (S)) {
+
+                CodeEntry* N = CS_GetEntry (S, J);
+
+                /* A label or a change of control flow terminates the search,
+                ** since code reached that way may read the slot. This does
+                ** also cover subroutine calls, which may access the stack or
+                ** adjust the stack pointer.
+                */
+                if (CE_HasLabel (N) ||
+                    (N->Info & (OF_BRA | OF_CALL | OF_RET)) != 0) {
+                    break;
+                }
+
+                /* If the stack pointer itself is changed, the slot offsets
+                ** are no longer valid.
+                */
+                if ((N->Chg & REG_SP) != 0) {
+                    break;
+                }
+
+                /* Check accesses that go through the stack pointer */
+                if (N->AM == AM65_ZP_INDY && strcmp (N->Arg, "sp") == 0) {
+                    if (RegValIsKnown (N->RI->In.RegY) &&
+                        N->RI->In.RegY != Slot) {
+                        /* Access to another slot, ignore it */
+                        ++J;
+                        continue;
+                    }
+                    if (N->OPC == OP65_STA && RegValIsKnown (N->RI->In.RegY)) {
+                        /* The slot is overwritten before it is read, so the
+                        ** first store is dead. Since sta doesn't change any
+                        ** flags, it can simply be removed.
+                        */
+                        CS_DelEntry (S, I);
+                        ++Changes;
+                    }
+                    /* Otherwise this may be a read of the slot */
+                    break;
+                }
+
+                /* Any other indirect access may alias the slot if the
+                ** address of a local variable was taken, so play safe.
+                */
+                if (N->AM == AM65_ZPX_IND || N->AM == AM65_ZP_IND) {
+                    break;
+                }
+
+                /* Next entry */
+                ++J;
+            }
+        }
+
+        /* Next entry */
+        ++I;
+    }
+
+    /* Return the number of changes made */
+    return Changes;
+}
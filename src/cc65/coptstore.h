@@ -104,6 +104,11 @@ unsigned OptStore5 (CodeSeg* S);
 ** but it keeps the value of X, which may be reused later.
 */
 
+unsigned OptUnusedStackStores (CodeSeg* S);
+/* Remove a "sta (sp),y" store into a stack slot, if the same slot is
+** overwritten by a second store before the value can be read.
+*/
+
 
 
 /* End of coptstore.h */
@@ -33,6 +33,8 @@
 
 
 
+#include <string.h>
+
 /* common */
 #include "check.h"
 #include "xmalloc.h"
@@ -51,6 +53,19 @@
 
 
 
+/* A run of raw bytes within a data segment. The run is output before the
+** line with the index Pos, so the raw data keeps its position between the
+** lines of the segment.
+*/
+typedef struct ByteRun ByteRun;
+struct ByteRun {
+    unsigned            Pos;            /* Index of the line the run precedes */
+    unsigned            Offs;           /* First byte in the data buffer */
+    unsigned            Count;          /* Number of bytes in the run */
+};
+
+
+
 DataSeg* NewDataSeg (const char* Name, SymEntry* Func)
 /* Create a new data segment, initialize and return it */
 {
@@ -61,6 +76,10 @@ DataSeg* NewDataSeg (const char* Name, SymEntry* Func)
     S->SegName  = xstrdup (Name);
     S->Func     = Func;
     InitCollection (&S->Lines);
+    InitCollection (&S->ByteRuns);
+    S->Bytes     = 0;
+    S->ByteCount = 0;
+    S->ByteAlloc = 0;
 
     /* Return the new struct */
     return S;
@@ -73,11 +92,32 @@ void DS_Append (DataSeg* Target, const DataSeg* Source)
 {
     unsigned I;
 
+    /* Remember the line and byte counts of the target */
+    unsigned LineCount = CollCount (&Target->Lines);
+    unsigned ByteCount = Target->ByteCount;
+
     /* Append all lines from Source to Target */
     unsigned Count = CollCount (&Source->Lines);
     for (I = 0; I < Count; ++I) {
         CollAppend (&Target->Lines, xstrdup (CollConstAt (&Source->Lines, I)));
     }
+
+    /* Append the raw data and the runs describing it */
+    if (Source->ByteCount > 0) {
+        DS_AddBytes (Target, Source->Bytes, Source->ByteCount);
+        Target->ByteCount = ByteCount;          /* Undo the run bookkeeping */
+        CollDelete (&Target->ByteRuns, CollCount (&Target->ByteRuns) - 1);
+        Count = CollCount (&Source->ByteRuns);
+        for (I = 0; I < Count; ++I) {
+            const ByteRun* R = CollConstAt (&Source->ByteRuns, I);
+            ByteRun* N = xmalloc (sizeof (ByteRun));
+            N->Pos   = R->Pos + LineCount;
+            N->Offs  = R->Offs + ByteCount;
+            N->Count = R->Count;
+            CollAppend (&Target->ByteRuns, N);
+        }
+        Target->ByteCount = ByteCount + Source->ByteCount;
+    }
 }
 
 
@@ -106,27 +146,139 @@ void DS_AddLine (DataSeg* S, const char* Format, ...)
 
 
 
+void DS_AddBytes (DataSeg* S, const void* Data, unsigned Size)
+/* Add raw data bytes to the given data segment. The bytes keep their
+** position relative to the lines of the segment and are formatted as
+** .byte lines in one step when the segment is output.
+*/
+{
+    ByteRun* R;
+
+    /* Get the run the bytes are added to. A new run is started if there is
+    ** none, or if lines were added after the last one.
+    */
+    unsigned RunCount = CollCount (&S->ByteRuns);
+    if (RunCount > 0) {
+        R = CollAtUnchecked (&S->ByteRuns, RunCount - 1);
+        if (R->Pos != CollCount (&S->Lines)) {
+            R = 0;
+        }
+    } else {
+        R = 0;
+    }
+    if (R == 0) {
+        R = xmalloc (sizeof (ByteRun));
+        R->Pos   = CollCount (&S->Lines);
+        R->Offs  = S->ByteCount;
+        R->Count = 0;
+        CollAppend (&S->ByteRuns, R);
+    }
+
+    /* Grow the buffer if needed */
+    if (S->ByteCount + Size > S->ByteAlloc) {
+        unsigned NewAlloc = (S->ByteAlloc == 0)? 1024 : S->ByteAlloc;
+        while (S->ByteCount + Size > NewAlloc) {
+            NewAlloc *= 2;
+        }
+        S->Bytes = xrealloc (S->Bytes, NewAlloc);
+        S->ByteAlloc = NewAlloc;
+    }
+
+    /* Add the bytes to the buffer and the run */
+    memcpy (S->Bytes + S->ByteCount, Data, Size);
+    S->ByteCount += Size;
+    R->Count += Size;
+}
+
+
+
+static void DS_OutputBytes (const DataSeg* S, const ByteRun* R)
+/* Output one run of raw data as .byte lines. The output is formatted into
+** one buffer that is sized up front from the byte count of the run.
+*/
+{
+    static const char HexVal[16] = "0123456789ABCDEF";
+
+    unsigned I;
+    unsigned Chunk;
+    char* Buf;
+    char* B;
+
+    /* Pointer to the data of the run */
+    const unsigned char* Data = S->Bytes + R->Offs;
+    unsigned Count = R->Count;
+
+    /* Allocate the output buffer. Each byte needs four characters at most
+    ** ("$XX" plus a separator), and each line of 16 bytes a seven character
+    ** directive prefix.
+    */
+    Buf = xmalloc ((unsigned long) Count * 4 + ((Count + 15) / 16) * 7 + 1);
+    B = Buf;
+
+    /* Format the data */
+    while (Count) {
+
+        /* How many go into this line? */
+        if ((Chunk = Count) > 16) {
+            Chunk = 16;
+        }
+        Count -= Chunk;
+
+        /* Format one line */
+        memcpy (B, "\t.byte\t", 7);
+        B += 7;
+        for (I = 0; I < Chunk; ++I) {
+            *B++ = '$';
+            *B++ = HexVal[*Data >> 4];
+            *B++ = HexVal[*Data & 0x0F];
+            ++Data;
+            *B++ = (I + 1 < Chunk)? ',' : '\n';
+        }
+    }
+    *B = '\0';
+
+    /* Write the formatted data and free the buffer */
+    WriteOutputStr (Buf);
+    xfree (Buf);
+}
+
+
+
 void DS_Output (const DataSeg* S)
 /* Output the data segment data to the output file */
 {
     unsigned I;
+    unsigned NextRun;
+    unsigned RunCount;
 
     /* Get the number of entries in this segment */
     unsigned Count = CollCount (&S->Lines);
 
     /* If the segment is actually empty, bail out */
-    if (Count == 0) {
+    if (Count == 0 && CollCount (&S->ByteRuns) == 0) {
         return;
     }
 
     /* Output the segment directive */
     WriteOutput (".segment\t\"%s\"\n\n", S->SegName);
 
-    /* Output all entries */
-    for (I = 0; I < Count; ++I) {
-        WriteOutput ("%s\n", (const char*) CollConstAt (&S->Lines, I));
+    /* Output all entries with the raw data runs in between */
+    NextRun = 0;
+    RunCount = CollCount (&S->ByteRuns);
+    for (I = 0; I <= Count; ++I) {
+        while (NextRun < RunCount) {
+            const ByteRun* R = CollConstAt (&S->ByteRuns, NextRun);
+            if (R->Pos != I) {
+                break;
+            }
+            DS_OutputBytes (S, R);
+            ++NextRun;
+        }
+        if (I < Count) {
+            WriteOutput ("%s\n", (const char*) CollConstAt (&S->Lines, I));
+        }
     }
 
     /* Add an additional newline after the segment output */
-    WriteOutput ("\n");
+    WriteOutputStr ("\n");
 }
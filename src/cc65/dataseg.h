@@ -60,6 +60,10 @@ struct DataSeg {
     char*               SegName;        /* Segment name */
     SymEntry*           Func;           /* Owner function */
     Collection          Lines;          /* List of code lines */
+    Collection          ByteRuns;       /* List of raw data runs */
+    unsigned char*      Bytes;          /* Buffer for raw data */
+    unsigned            ByteCount;      /* Bytes used in the buffer */
+    unsigned            ByteAlloc;      /* Size of the buffer */
 };
 
 
@@ -82,6 +86,12 @@ void DS_AddVLine (DataSeg* S, const char* Format, va_list ap) attribute ((format
 void DS_AddLine (DataSeg* S, const char* Format, ...) attribute ((format(printf,2,3)));
 /* Add a line to the given data segment */
 
+void DS_AddBytes (DataSeg* S, const void* Data, unsigned Size);
+/* Add raw data bytes to the given data segment. The bytes keep their
+** position relative to the lines of the segment and are formatted as
+** .byte lines in one step when the segment is output.
+*/
+
 void DS_Output (const DataSeg* S);
 /* Output the data segment data to the output file */
 
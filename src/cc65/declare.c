@@ -41,6 +41,7 @@
 /* common */
 #include "addrsize.h"
 #include "mmodel.h"
+#include "strbuf.h"
 #include "xmalloc.h"
 
 /* cc65 */
@@ -1771,6 +1772,14 @@ static void ClosingCurlyBraces (unsigned BracesExpected)
 static void DefineData (ExprDesc* Expr)
 /* Output a data definition for the given expression */
 {
+    /* The address of an array with split lo/hi byte layout must not be used
+    ** in an initializer, since the elements are not stored in the layout a
+    ** pointer access would expect.
+    */
+    if (Expr->Sym != 0 && (Expr->Sym->Flags & SC_SOA) != 0) {
+        Error ("Cannot take address of an array with split layout");
+    }
+
     switch (ED_GetLoc (Expr)) {
 
         case E_LOC_NONE:
@@ -1961,6 +1970,12 @@ static unsigned ParseArrayInit (Type* T, int AllowFlexibleMembers)
 
     } else {
 
+        /* Buffer for consecutive constant bytes. They are output as one
+        ** chunk instead of one .byte line per element, which is a lot
+        ** faster for the large constant tables generated from binary data.
+        */
+        StrBuf Bytes = STATIC_STRBUF_INITIALIZER;
+
         /* Curly brace */
         ConsumeLCurly ();
 
@@ -1971,13 +1986,44 @@ static unsigned ParseArrayInit (Type* T, int AllowFlexibleMembers)
             ** an array (because the size of each element may differ
             ** otherwise).
             */
-            ParseInitInternal (ElementType, 0);
+            if (IsTypeChar (ElementType) && CurTok.Tok != TOK_LCURLY) {
+                /* Fast path for char arrays: constant numeric elements are
+                ** collected and output en bloc below.
+                */
+                ExprDesc ED;
+                ParseScalarInitInternal (ElementType, &ED);
+                if (ED_GetLoc (&ED) == E_LOC_NONE) {
+                    SB_AppendChar (&Bytes, (char) (ED.IVal & 0xFF));
+                } else {
+                    /* Not a numeric constant. Flush the buffered bytes,
+                    ** then output this element the usual way.
+                    */
+                    if (SB_NotEmpty (&Bytes)) {
+                        g_defbytes (SB_GetConstBuf (&Bytes), SB_GetLen (&Bytes));
+                        SB_Clear (&Bytes);
+                    }
+                    DefineData (&ED);
+                }
+            } else {
+                /* Flush the buffered bytes so the data stays in order */
+                if (SB_NotEmpty (&Bytes)) {
+                    g_defbytes (SB_GetConstBuf (&Bytes), SB_GetLen (&Bytes));
+                    SB_Clear (&Bytes);
+                }
+                ParseInitInternal (ElementType, 0);
+            }
             ++Count;
             if (CurTok.Tok != TOK_COMMA)
                 break;
             NextToken ();
         }
 
+        /* Output any bytes still buffered */
+        if (SB_NotEmpty (&Bytes)) {
+            g_defbytes (SB_GetConstBuf (&Bytes), SB_GetLen (&Bytes));
+        }
+        SB_Done (&Bytes);
+
         /* Closing curly braces */
         ConsumeRCurly ();
     }
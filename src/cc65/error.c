@@ -38,7 +38,9 @@
 #include <stdarg.h>
 
 /* common */
+#include "diagfile.h"
 #include "print.h"
+#include "strbuf.h"
 
 /* cc65 */
 #include "global.h"
@@ -94,6 +96,68 @@ static WarnMapEntry WarnMap[] = {
 
 
 
+/*****************************************************************************/
+/*                             Helper functions                              */
+/*****************************************************************************/
+
+
+
+static void VOutputMsg (const char* Filename, unsigned LineNo, const char* Desc,
+                        const char* Format, va_list ap)
+/* Format a diagnostic and write it to stderr with a single call, so that
+** each diagnostic results in one write even on an unbuffered stream. The
+** diagnostic is also passed to the machine readable diagnostic file if one
+** was requested.
+*/
+{
+    StrBuf S   = STATIC_STRBUF_INITIALIZER;
+    StrBuf Msg = STATIC_STRBUF_INITIALIZER;
+
+    /* Format the actual message */
+    SB_VPrintf (&Msg, Format, ap);
+    SB_Terminate (&Msg);
+
+    /* Prepend the message header */
+    SB_Printf (&S, "%s(%u): %s: %s\n",
+               Filename, LineNo, Desc, SB_GetConstBuf (&Msg));
+
+    /* Append the current input line if requested */
+    if (Line && Verbosity > 0) {
+        StrBuf In = STATIC_STRBUF_INITIALIZER;
+        SB_Printf (&In, "Input: %.*s\n",
+                   (int) SB_GetLen (Line), SB_GetConstBuf (Line));
+        SB_Append (&S, &In);
+        SB_Done (&In);
+    }
+
+    /* Output the full message with one write */
+    SB_Terminate (&S);
+    fputs (SB_GetConstBuf (&S), stderr);
+
+    /* Pass the unformatted message to the diagnostic file */
+    DiagnosticRecord (Desc, Filename, LineNo, SB_GetConstBuf (&Msg));
+
+    /* Delete the buffers */
+    SB_Done (&Msg);
+    SB_Done (&S);
+}
+
+
+
+static void GetCurrentPos (const char** Filename, unsigned* LineNo)
+/* Return the current input position for a diagnostic */
+{
+    if (CurTok.LI) {
+        *Filename = GetInputName (CurTok.LI);
+        *LineNo   = GetInputLine (CurTok.LI);
+    } else {
+        *Filename = GetCurrentFile ();
+        *LineNo   = GetCurrentLine ();
+    }
+}
+
+
+
 /*****************************************************************************/
 /*                         Handling of fatal errors                          */
 /*****************************************************************************/
@@ -107,24 +171,12 @@ void Fatal (const char* Format, ...)
 
     const char* FileName;
     unsigned    LineNum;
-    if (CurTok.LI) {
-        FileName = GetInputName (CurTok.LI);
-        LineNum  = GetInputLine (CurTok.LI);
-    } else {
-        FileName = GetCurrentFile ();
-        LineNum  = GetCurrentLine ();
-    }
-
-    fprintf (stderr, "%s(%u): Fatal: ", FileName, LineNum);
+    GetCurrentPos (&FileName, &LineNum);
 
     va_start (ap, Format);
-    vfprintf (stderr, Format, ap);
+    VOutputMsg (FileName, LineNum, "Fatal", Format, ap);
     va_end (ap);
-    fprintf (stderr, "\n");
 
-    if (Line) {
-        Print (stderr, 1, "Input: %.*s\n", (int) SB_GetLen (Line), SB_GetConstBuf (Line));
-    }
     exit (EXIT_FAILURE);
 }
 
@@ -137,21 +189,11 @@ void Internal (const char* Format, ...)
 
     const char* FileName;
     unsigned    LineNum;
-    if (CurTok.LI) {
-        FileName = GetInputName (CurTok.LI);
-        LineNum  = GetInputLine (CurTok.LI);
-    } else {
-        FileName = GetCurrentFile ();
-        LineNum  = GetCurrentLine ();
-    }
-
-    fprintf (stderr, "%s(%u): Internal compiler error:\n",
-             FileName, LineNum);
+    GetCurrentPos (&FileName, &LineNum);
 
     va_start (ap, Format);
-    vfprintf (stderr, Format, ap);
+    VOutputMsg (FileName, LineNum, "Internal compiler error", Format, ap);
     va_end (ap);
-    fprintf (stderr, "\n");
 
     if (Line) {
         fprintf (stderr, "\nInput: %.*s\n", (int) SB_GetLen (Line), SB_GetConstBuf (Line));
@@ -172,13 +214,8 @@ void Internal (const char* Format, ...)
 static void IntError (const char* Filename, unsigned LineNo, const char* Msg, va_list ap)
 /* Print an error message - internal function*/
 {
-    fprintf (stderr, "%s(%u): Error: ", Filename, LineNo);
-    vfprintf (stderr, Msg, ap);
-    fprintf (stderr, "\n");
+    VOutputMsg (Filename, LineNo, "Error", Msg, ap);
 
-    if (Line) {
-        Print (stderr, 1, "Input: %.*s\n", (int) SB_GetLen (Line), SB_GetConstBuf (Line));
-    }
     ++ErrorCount;
     if (ErrorCount > 10) {
         Fatal ("Too many errors");
@@ -236,13 +273,11 @@ static void IntWarning (const char* Filename, unsigned LineNo, const char* Msg,
 
     } else if (IS_Get (&WarnEnable)) {
 
-        fprintf (stderr, "%s(%u): Warning: ", Filename, LineNo);
-        vfprintf (stderr, Msg, ap);
-        fprintf (stderr, "\n");
-
-        if (Line) {
-            Print (stderr, 1, "Input: %.*s\n", (int) SB_GetLen (Line), SB_GetConstBuf (Line));
-        }
+        /* The formatting is only done after the warning is known to be
+        ** enabled, so suppressed warnings cost no more than the check
+        ** at the call site.
+        */
+        VOutputMsg (Filename, LineNo, "Warning", Msg, ap);
         ++WarningCount;
 
     }
@@ -71,6 +71,41 @@ static GenDesc GenAASGN  = { TOK_AND_ASSIGN,    GEN_NOPUSH,     g_and };
 static GenDesc GenXOASGN = { TOK_XOR_ASSIGN,    GEN_NOPUSH,     g_xor };
 static GenDesc GenOASGN  = { TOK_OR_ASSIGN,     GEN_NOPUSH,     g_or  };
 
+/* Descriptors for the binary operators of the precedence levels handled by
+** hieBinary. The tables are shared between the hie* level functions and the
+** token dispatch in hieBinary.
+*/
+static const GenDesc hie9_ops[] = {
+    { TOK_STAR,     GEN_NOPUSH | GEN_COMM,  g_mul   },
+    { TOK_DIV,      GEN_NOPUSH,             g_div   },
+    { TOK_MOD,      GEN_NOPUSH,             g_mod   },
+    { TOK_INVALID,  0,                      0       }
+};
+static const GenDesc hie6_ops [] = {
+    { TOK_LT,       GEN_NOPUSH | GEN_NOFUNC,     g_lt    },
+    { TOK_LE,       GEN_NOPUSH | GEN_NOFUNC,     g_le    },
+    { TOK_GE,       GEN_NOPUSH | GEN_NOFUNC,     g_ge    },
+    { TOK_GT,       GEN_NOPUSH | GEN_NOFUNC,     g_gt    },
+    { TOK_INVALID,  0,                           0       }
+};
+static const GenDesc hie5_ops[] = {
+    { TOK_EQ,       GEN_NOPUSH,     g_eq    },
+    { TOK_NE,       GEN_NOPUSH,     g_ne    },
+    { TOK_INVALID,  0,              0       }
+};
+static const GenDesc hie4_ops[] = {
+    { TOK_AND,      GEN_NOPUSH | GEN_COMM,  g_and   },
+    { TOK_INVALID,  0,                      0       }
+};
+static const GenDesc hie3_ops[] = {
+    { TOK_XOR,      GEN_NOPUSH | GEN_COMM,  g_xor   },
+    { TOK_INVALID,  0,                      0       }
+};
+static const GenDesc hie2_ops[] = {
+    { TOK_OR,       GEN_NOPUSH | GEN_COMM,  g_or    },
+    { TOK_INVALID,  0,                      0       }
+};
+
 
 
 /*****************************************************************************/
@@ -477,6 +512,7 @@ static void FunctionCall (ExprDesc* Expr)
     int           IsFastcall = 0; /* True if it's a fast-call function */
     int           PtrOnStack = 0; /* True if a pointer copy is on stack */
     Type*         ReturnType;
+    SymEntry*     CalleeSym;      /* Called function if called by name */
 
     /* Skip the left paren */
     NextToken ();
@@ -484,6 +520,9 @@ static void FunctionCall (ExprDesc* Expr)
     /* Get a pointer to the function descriptor from the type string */
     Func = GetFuncDesc (Expr->Type);
 
+    /* Remember the called function before the expression is changed below */
+    CalleeSym = Expr->Sym;
+
     /* Handle function pointers transparently */
     IsFuncPtr = IsTypeFuncPtr (Expr->Type);
     if (IsFuncPtr) {
@@ -668,6 +707,16 @@ static void FunctionCall (ExprDesc* Expr)
     }
 
     Expr->Type = ReturnType;
+
+    /* Remember the callee for return value usage tracking. Calls through
+    ** function pointers and wrapped calls are not tracked.
+    */
+    if (!IsFuncPtr                  &&
+        Func->WrappedCall == 0      &&
+        CalleeSym != 0              &&
+        (CalleeSym->Flags & SC_FUNC) == SC_FUNC) {
+        Expr->Callee = CalleeSym;
+    }
 }
 
 
@@ -779,7 +828,10 @@ static void Primary (ExprDesc* E)
                     E->Flags = E_LOC_NONE | E_RTYPE_RVAL;
                     E->IVal = Sym->V.ConstVal;
                 } else if ((Sym->Flags & SC_FUNC) == SC_FUNC) {
-                    /* Function */
+                    /* Function. Count the reference for return value usage
+                    ** tracking.
+                    */
+                    ++Sym->FuncRefs;
                     E->Flags = E_LOC_GLOBAL | E_RTYPE_LVAL;
                     E->Name = (uintptr_t) Sym->Name;
                 } else if ((Sym->Flags & SC_AUTO) == SC_AUTO) {
@@ -878,6 +930,25 @@ static void Primary (ExprDesc* E)
             E->Type  = type_void;
             break;
 
+        case TOK_BUILTIN_EXPECT:
+            /* __builtin_expect (expr, value). The result is the value of
+            ** the first argument. An expected value of zero marks the
+            ** expression as unlikely, which is used to direct the layout
+            ** of conditional branches.
+            */
+            NextToken ();
+            ConsumeLParen ();
+            hie1 (E);
+            if (ConsumeComma ()) {
+                ExprDesc Expected;
+                ConstAbsIntExpr (hie1, &Expected);
+                if (Expected.IVal == 0) {
+                    ED_MarkAsUnlikely (E);
+                }
+            }
+            ConsumeRParen ();
+            break;
+
         case TOK_A:
             /* Register pseudo variable */
             E->Type  = type_uchar;
@@ -1197,6 +1268,75 @@ static void ArrayRef (ExprDesc* Expr)
 
 
 
+static void SoaArrayRef (ExprDesc* Expr)
+/* Handle an array reference to an array with split lo/hi byte layout (see
+** #pragma soa). The lo and hi bytes of the elements are kept in two parallel
+** byte planes, so instead of doing address arithmetic, the element index is
+** loaded into the primary register and used to index both planes. The result
+** is an lvalue marked with E_SOA that may only be read or be the target of a
+** plain assignment.
+*/
+{
+    ExprDesc    Subscript;
+    SymEntry*   Sym = Expr->Sym;
+    long        Count = GetElementCount (Expr->Type);
+    TypeCode    Qualifiers;
+    Type*       ElementType;
+
+    /* Skip the bracket */
+    NextToken ();
+
+    /* Get the subscript */
+    MarkedExprWithCheck (hie0, &Subscript);
+    if (!IsClassInt (Subscript.Type)) {
+        Error ("Array subscript is not an integer");
+        /* To avoid any compiler errors, make the expression a valid int */
+        ED_MakeConstAbsInt (&Subscript, 0);
+    }
+
+    /* The element type has the combined qualifiers from itself and the array */
+    Qualifiers  = GetQualifier (Expr->Type);
+    ElementType = Indirect (Expr->Type);
+    if (GetQualifier (ElementType) != (GetQualifier (ElementType) | Qualifiers)) {
+        ElementType = TypeDup (ElementType);
+        ElementType->C |= Qualifiers;
+    }
+
+    /* If the subscript is a bit-field, load it and make it an rvalue */
+    if (ED_IsBitField (&Subscript)) {
+        LoadExpr (CF_NONE, &Subscript);
+        ED_FinalizeRValLoad (&Subscript);
+    }
+
+    /* A constant subscript must address an existing element, since an access
+    ** beyond the lo byte plane would hit the hi bytes of other elements.
+    */
+    if (ED_IsConstAbs (&Subscript) &&
+        (Subscript.IVal < 0 || Subscript.IVal >= Count)) {
+        Error ("Array subscript out of range");
+        Subscript.IVal = 0;
+    }
+
+    /* Load the element index into the primary */
+    LoadExpr (CF_NONE, &Subscript);
+
+    /* The primary register now holds the index instead of an address. Make
+    ** Expr an lvalue reference and remember the array symbol, so LoadExpr
+    ** and Assignment can generate the accesses to the two byte planes.
+    */
+    ED_FinalizeRValLoad (Expr);
+    ED_IndExpr (Expr);
+    Expr->Sym    = Sym;
+    Expr->Name   = (uintptr_t) Sym->Name;
+    Expr->Type   = ElementType;
+    Expr->Flags |= E_SOA;
+
+    /* Consume the closing bracket */
+    ConsumeRBrack ();
+}
+
+
+
 static void StructRef (ExprDesc* Expr)
 /* Process struct/union field after . or ->. */
 {
@@ -1366,8 +1506,16 @@ static void hie11 (ExprDesc *Expr)
         switch (CurTok.Tok) {
 
             case TOK_LBRACK:
-                /* Array reference */
-                ArrayRef (Expr);
+                /* Array reference. Arrays with split lo/hi byte layout get
+                ** a special treatment.
+                */
+                if (Expr->Sym != 0                          &&
+                    (Expr->Sym->Flags & SC_SOA) != 0        &&
+                    IsTypeArray (Expr->Type)) {
+                    SoaArrayRef (Expr);
+                } else {
+                    ArrayRef (Expr);
+                }
                 break;
 
             case TOK_LPAREN:
@@ -1502,6 +1650,12 @@ static void PreInc (ExprDesc* Expr)
         Error ("Increment of read-only variable");
     }
 
+    /* Elements of arrays with split layout can only be read or assigned */
+    if (ED_IsSoa (Expr)) {
+        Error ("Invalid operation for an array with split layout");
+        return;
+    }
+
     /* Get the data type */
     Flags = TypeOf (Expr->Type) | GlobalModeFlags (Expr) | CF_FORCECHAR | CF_CONST;
 
@@ -1578,6 +1732,12 @@ static void PreDec (ExprDesc* Expr)
         Error ("Decrement of read-only variable");
     }
 
+    /* Elements of arrays with split layout can only be read or assigned */
+    if (ED_IsSoa (Expr)) {
+        Error ("Invalid operation for an array with split layout");
+        return;
+    }
+
     /* Get the data type */
     Flags = TypeOf (Expr->Type) | GlobalModeFlags (Expr) | CF_FORCECHAR | CF_CONST;
 
@@ -1651,6 +1811,12 @@ static void PostInc (ExprDesc* Expr)
         Error ("Increment of read-only variable");
     }
 
+    /* Elements of arrays with split layout can only be read or assigned */
+    if (ED_IsSoa (Expr)) {
+        Error ("Invalid operation for an array with split layout");
+        return;
+    }
+
     /* Get the data type */
     Flags = TypeOf (Expr->Type);
 
@@ -1707,6 +1873,12 @@ static void PostDec (ExprDesc* Expr)
         Error ("Decrement of read-only variable");
     }
 
+    /* Elements of arrays with split layout can only be read or assigned */
+    if (ED_IsSoa (Expr)) {
+        Error ("Invalid operation for an array with split layout");
+        return;
+    }
+
     /* Get the data type */
     Flags = TypeOf (Expr->Type);
 
@@ -1880,6 +2052,14 @@ void hie10 (ExprDesc* Expr)
                     /* Do it anyway, just to avoid further warnings */
                     ED_DisBitField (Expr);
                 }
+                if (ED_IsSoa (Expr)) {
+                    /* The element bytes are not adjacent, so there is no
+                    ** address that could represent the element.
+                    */
+                    Error ("Cannot take address of an array with split layout");
+                    /* Continue anyway, just to avoid further errors */
+                    Expr->Flags &= ~E_SOA;
+                }
                 /* The & operator yields an rvalue address */
                 ED_AddrExpr (Expr);
             }
@@ -1943,11 +2123,13 @@ void hie10 (ExprDesc* Expr)
 
 
 
-static void hie_internal (const GenDesc* Ops,   /* List of generators */
-                          ExprDesc* Expr,
-                          void (*hienext) (ExprDesc*),
-                          int* UsedGen)
-/* Helper function */
+static void hie_internal_ops (const GenDesc* Ops,       /* List of generators */
+                              ExprDesc* Expr,
+                              void (*hienext) (ExprDesc*),
+                              int* UsedGen)
+/* Handle the operators of one precedence level for an already parsed left
+** hand side.
+*/
 {
     ExprDesc Expr2;
     CodeMark Mark1;
@@ -1956,12 +2138,10 @@ static void hie_internal (const GenDesc* Ops,   /* List of generators */
     token_t Tok;                        /* The operator token */
     unsigned ltype, type;
     int lconst;                         /* Left operand is a constant */
+    int ldeferred;                      /* Push of left operand is deferred */
     int rconst;                         /* Right operand is a constant */
 
 
-    ExprWithCheck (hienext, Expr);
-
-    *UsedGen = 0;
     while ((Gen = FindGen (CurTok.Tok, Ops)) != 0) {
 
         /* Tell the caller that we handled it's ops */
@@ -1982,14 +2162,26 @@ static void hie_internal (const GenDesc* Ops,   /* List of generators */
         GetCodePos (&Mark1);
         ltype = TypeOf (Expr->Type);
         lconst = ED_IsConstAbs (Expr);
+        ldeferred = 0;
         if (lconst) {
-            /* Constant value */
-            GetCodePos (&Mark2);
-            /* If the operator is commutative, don't push the left side, if
-            ** it's a constant, since we will exchange both operands.
+            /* Constant value. Don't push it yet: if the rhs turns out to be
+            ** constant too, the operation is folded without any code having
+            ** been generated, and for a commutative operator the operands
+            ** are exchanged anyway. Otherwise the push is emitted later and
+            ** moved before the rhs code. Adjust the stack pointer as if the
+            ** push had happened, so stack relative addressing within the
+            ** rhs stays correct. If a label is pending at the current
+            ** position, it must get attached to the push, so the push
+            ** cannot be deferred in this case.
             */
+            GetCodePos (&Mark2);
             if ((Gen->Flags & GEN_COMM) == 0) {
-                g_push (ltype | CF_CONST, Expr->IVal);
+                if (HavePendingCodeLabel ()) {
+                    g_push (ltype | CF_CONST, Expr->IVal);
+                } else {
+                    ldeferred = 1;
+                    StackPtr -= sizeofarg (ltype | CF_CONST);
+                }
             }
         } else {
             /* Value not constant */
@@ -2133,6 +2325,20 @@ static void hie_internal (const GenDesc* Ops,   /* List of generators */
             */
             unsigned rtype = TypeOf (Expr2.Type);
             type = 0;
+            if (ldeferred) {
+                /* The push of the constant lhs was deferred above. Since the
+                ** rhs is not constant, it is needed after all: undo the stack
+                ** pointer adjustment, emit the push and move it before the
+                ** code for the rhs.
+                */
+                CodeMark PushStart;
+                CodeMark PushEnd;
+                StackPtr += sizeofarg (ltype | CF_CONST);
+                GetCodePos (&PushStart);
+                g_push (ltype | CF_CONST, Expr->IVal);
+                GetCodePos (&PushEnd);
+                MoveCode (&PushStart, &PushEnd, &Mark2);
+            }
             if (rconst) {
                 /* Second value is constant - check for div */
                 type |= CF_CONST;
@@ -2163,24 +2369,37 @@ static void hie_internal (const GenDesc* Ops,   /* List of generators */
 
 
 
-static void hie_compare (const GenDesc* Ops,    /* List of generators */
-                         ExprDesc* Expr,
-                         void (*hienext) (ExprDesc*))
-/* Helper function for the compare operators */
+static void hie_internal (const GenDesc* Ops,   /* List of generators */
+                          ExprDesc* Expr,
+                          void (*hienext) (ExprDesc*),
+                          int* UsedGen)
+/* Helper function */
+{
+    ExprWithCheck (hienext, Expr);
+
+    *UsedGen = 0;
+    hie_internal_ops (Ops, Expr, hienext, UsedGen);
+}
+
+
+static void hie_compare_ops (const GenDesc* Ops,        /* List of generators */
+                             ExprDesc* Expr,
+                             void (*hienext) (ExprDesc*))
+/* Handle the comparison operators of one precedence level for an already
+** parsed left hand side.
+*/
 {
     ExprDesc Expr2;
-    CodeMark Mark0;
     CodeMark Mark1;
     CodeMark Mark2;
     const GenDesc* Gen;
     token_t Tok;                        /* The operator token */
     unsigned ltype;
+    int lconst;                         /* Left operand is a constant */
+    int ldeferred;                      /* Push of left operand is deferred */
     int rconst;                         /* Operand is a constant */
 
 
-    GetCodePos (&Mark0);
-    ExprWithCheck (hienext, Expr);
-
     while ((Gen = FindGen (CurTok.Tok, Ops)) != 0) {
 
         /* Remember the generator function */
@@ -2198,10 +2417,25 @@ static void hie_compare (const GenDesc* Ops,    /* List of generators */
         /* Get the lhs on stack */
         GetCodePos (&Mark1);
         ltype = TypeOf (Expr->Type);
-        if (ED_IsConstAbs (Expr)) {
-            /* Constant value */
+        lconst = ED_IsConstAbs (Expr);
+        ldeferred = 0;
+        if (lconst) {
+            /* Constant value. Don't push it yet: if the rhs turns out to be
+            ** constant too, the comparison is folded without any code having
+            ** been generated. Otherwise the push is emitted later and moved
+            ** before the rhs code. Adjust the stack pointer as if the push
+            ** had happened, so stack relative addressing within the rhs
+            ** stays correct. If a label is pending at the current position,
+            ** it must get attached to the push, so the push cannot be
+            ** deferred in this case.
+            */
             GetCodePos (&Mark2);
-            g_push (ltype | CF_CONST, Expr->IVal);
+            if (HavePendingCodeLabel ()) {
+                g_push (ltype | CF_CONST, Expr->IVal);
+            } else {
+                ldeferred = 1;
+                StackPtr -= sizeofarg (ltype | CF_CONST);
+            }
         } else {
             /* Value not constant */
             LoadExpr (CF_NONE, Expr);
@@ -2316,6 +2550,20 @@ static void hie_compare (const GenDesc* Ops,    /* List of generators */
             ** now.
             */
             unsigned flags = 0;
+            if (ldeferred) {
+                /* The push of the constant lhs was deferred above. Since the
+                ** rhs is not constant, it is needed after all: undo the stack
+                ** pointer adjustment, emit the push and move it before the
+                ** code for the rhs.
+                */
+                CodeMark PushStart;
+                CodeMark PushEnd;
+                StackPtr += sizeofarg (ltype | CF_CONST);
+                GetCodePos (&PushStart);
+                g_push (ltype | CF_CONST, Expr->IVal);
+                GetCodePos (&PushEnd);
+                MoveCode (&PushStart, &PushEnd, &Mark2);
+            }
             if (rconst) {
                 flags |= CF_CONST;
                 if ((Gen->Flags & GEN_NOPUSH) != 0) {
@@ -2509,15 +2757,20 @@ Done:   /* Condition codes are set */
 
 
 
+static void hie_compare (const GenDesc* Ops,    /* List of generators */
+                         ExprDesc* Expr,
+                         void (*hienext) (ExprDesc*))
+/* Helper function for the compare operators */
+{
+    ExprWithCheck (hienext, Expr);
+
+    hie_compare_ops (Ops, Expr, hienext);
+}
+
+
 static void hie9 (ExprDesc *Expr)
 /* Process * and / operators. */
 {
-    static const GenDesc hie9_ops[] = {
-        { TOK_STAR,     GEN_NOPUSH | GEN_COMM,  g_mul   },
-        { TOK_DIV,      GEN_NOPUSH,             g_div   },
-        { TOK_MOD,      GEN_NOPUSH,             g_mod   },
-        { TOK_INVALID,  0,                      0       }
-    };
     int UsedGen;
 
     hie_internal (hie9_ops, Expr, hie10, &UsedGen);
@@ -2703,6 +2956,33 @@ static void parseadd (ExprDesc* Expr)
             /* Generate code for the add */
             g_inc (flags | CF_CONST, Expr2.IVal);
 
+        } else if (ED_CodeRangeIsEmpty (&Expr2)         &&
+                   ED_IsLVal (&Expr2)                   &&
+                   !ED_IsBitField (&Expr2)              &&
+                   (ED_GetLoc (&Expr2) & (E_LOC_GLOBAL | E_LOC_STATIC | E_LOC_LITERAL)) != 0 &&
+                   IsClassInt (lhst)                    &&
+                   IsClassInt (Expr2.Type)              &&
+                   SizeOf (lhst) == SIZEOF_INT          &&
+                   SizeOf (Expr2.Type) == SIZEOF_INT) {
+
+            /* The rhs is an int sized variable at a constant address that
+            ** needed no code of its own. Add it to the primary directly
+            ** instead of taking the long way over the stack. Besides being
+            ** faster, this saves the optimizer the work of removing the
+            ** push/tosaddax pair later.
+            */
+
+            /* Remove pushed value from stack */
+            RemoveCode (&Mark);
+
+            /* Determine the type of the operation. The lhs is in the
+            ** primary, so pass NoPush. See the note about CF_CONST below.
+            */
+            flags = typeadjust (Expr, &Expr2, 1) & ~CF_CONST;
+
+            /* Add the variable to the primary */
+            g_addstatic (flags | GlobalModeFlags (&Expr2), Expr2.Name, Expr2.IVal);
+
         } else {
 
             /* Not constant, load into the primary */
@@ -2942,10 +3222,9 @@ static void parsesub (ExprDesc* Expr)
 
 
 
-void hie8 (ExprDesc* Expr)
-/* Process + and - binary operators. */
+static void hie8_ops (ExprDesc* Expr)
+/* Handle the + and - binary operators for an already parsed left hand side */
 {
-    ExprWithCheck (hie9, Expr);
     while (CurTok.Tok == TOK_PLUS || CurTok.Tok == TOK_MINUS) {
         if (CurTok.Tok == TOK_PLUS) {
             parseadd (Expr);
@@ -2957,16 +3236,18 @@ void hie8 (ExprDesc* Expr)
 
 
 
+void hie8 (ExprDesc* Expr)
+/* Process + and - binary operators. */
+{
+    ExprWithCheck (hie9, Expr);
+    hie8_ops (Expr);
+}
+
+
+
 static void hie6 (ExprDesc* Expr)
 /* Handle greater-than type comparators */
 {
-    static const GenDesc hie6_ops [] = {
-        { TOK_LT,       GEN_NOPUSH | GEN_NOFUNC,     g_lt    },
-        { TOK_LE,       GEN_NOPUSH | GEN_NOFUNC,     g_le    },
-        { TOK_GE,       GEN_NOPUSH | GEN_NOFUNC,     g_ge    },
-        { TOK_GT,       GEN_NOPUSH | GEN_NOFUNC,     g_gt    },
-        { TOK_INVALID,  0,                           0       }
-    };
     hie_compare (hie6_ops, Expr, ShiftExpr);
 }
 
@@ -2975,11 +3256,6 @@ static void hie6 (ExprDesc* Expr)
 static void hie5 (ExprDesc* Expr)
 /* Handle == and != */
 {
-    static const GenDesc hie5_ops[] = {
-        { TOK_EQ,       GEN_NOPUSH,     g_eq    },
-        { TOK_NE,       GEN_NOPUSH,     g_ne    },
-        { TOK_INVALID,  0,              0       }
-    };
     hie_compare (hie5_ops, Expr, hie6);
 }
 
@@ -2988,10 +3264,6 @@ static void hie5 (ExprDesc* Expr)
 static void hie4 (ExprDesc* Expr)
 /* Handle & (bitwise and) */
 {
-    static const GenDesc hie4_ops[] = {
-        { TOK_AND,      GEN_NOPUSH | GEN_COMM,  g_and   },
-        { TOK_INVALID,  0,                      0       }
-    };
     int UsedGen;
 
     hie_internal (hie4_ops, Expr, hie5, &UsedGen);
@@ -3002,10 +3274,6 @@ static void hie4 (ExprDesc* Expr)
 static void hie3 (ExprDesc* Expr)
 /* Handle ^ (bitwise exclusive or) */
 {
-    static const GenDesc hie3_ops[] = {
-        { TOK_XOR,      GEN_NOPUSH | GEN_COMM,  g_xor   },
-        { TOK_INVALID,  0,                      0       }
-    };
     int UsedGen;
 
     hie_internal (hie3_ops, Expr, hie4, &UsedGen);
@@ -3016,10 +3284,6 @@ static void hie3 (ExprDesc* Expr)
 static void hie2 (ExprDesc* Expr)
 /* Handle | (bitwise or) */
 {
-    static const GenDesc hie2_ops[] = {
-        { TOK_OR,       GEN_NOPUSH | GEN_COMM,  g_or    },
-        { TOK_INVALID,  0,                      0       }
-    };
     int UsedGen;
 
     hie_internal (hie2_ops, Expr, hie3, &UsedGen);
@@ -3027,6 +3291,73 @@ static void hie2 (ExprDesc* Expr)
 
 
 
+static void hieBinary (ExprDesc* Expr)
+/* Process the binary operators of the precedence levels handled by hie2 to
+** hie9. Instead of descending through all levels for every operand, the
+** leftmost operand is parsed once, and the operators found after it are
+** dispatched directly to the handler for their precedence level. Each
+** handler consumes all operators of its level and parses its right hand
+** sides through the regular hie* levels, so the precedence rules and the
+** generated code are the same as with the full descent.
+*/
+{
+    int UsedGen = 0;
+
+    /* Parse the leftmost operand */
+    ExprWithCheck (hie10, Expr);
+
+    /* Dispatch on the operators following it */
+    while (1) {
+        switch (CurTok.Tok) {
+
+            case TOK_OR:
+                hie_internal_ops (hie2_ops, Expr, hie3, &UsedGen);
+                break;
+
+            case TOK_XOR:
+                hie_internal_ops (hie3_ops, Expr, hie4, &UsedGen);
+                break;
+
+            case TOK_AND:
+                hie_internal_ops (hie4_ops, Expr, hie5, &UsedGen);
+                break;
+
+            case TOK_EQ:
+            case TOK_NE:
+                hie_compare_ops (hie5_ops, Expr, hie6);
+                break;
+
+            case TOK_LT:
+            case TOK_LE:
+            case TOK_GE:
+            case TOK_GT:
+                hie_compare_ops (hie6_ops, Expr, ShiftExpr);
+                break;
+
+            case TOK_SHL:
+            case TOK_SHR:
+                ShiftExprOps (Expr);
+                break;
+
+            case TOK_PLUS:
+            case TOK_MINUS:
+                hie8_ops (Expr);
+                break;
+
+            case TOK_STAR:
+            case TOK_DIV:
+            case TOK_MOD:
+                hie_internal_ops (hie9_ops, Expr, hie10, &UsedGen);
+                break;
+
+            default:
+                return;
+        }
+    }
+}
+
+
+
 static void hieAndPP (ExprDesc* Expr)
 /* Process "exp && exp" in preprocessor mode (that is, when the parser is
 ** called recursively from the preprocessor.
@@ -3079,7 +3410,7 @@ static void hieAnd (ExprDesc* Expr, unsigned TrueLab, int* BoolOp)
     int FalseLab;
     ExprDesc Expr2;
 
-    ExprWithCheck (hie2, Expr);
+    ExprWithCheck (hieBinary, Expr);
     if (CurTok.Tok == TOK_BOOL_AND) {
 
         /* Tell our caller that we're evaluating a boolean */
@@ -3106,7 +3437,7 @@ static void hieAnd (ExprDesc* Expr, unsigned TrueLab, int* BoolOp)
             NextToken ();
 
             /* Get rhs */
-            hie2 (&Expr2);
+            hieBinary (&Expr2);
             if (!ED_IsTested (&Expr2)) {
                 ED_MarkForTest (&Expr2);
             }
@@ -3354,6 +3685,12 @@ static void opeq (const GenDesc* Gen, ExprDesc* Expr, const char* Op)
         return;
     }
 
+    /* Elements of arrays with split layout can only be read or assigned */
+    if (ED_IsSoa (Expr)) {
+        Error ("Invalid operation for an array with split layout");
+        return;
+    }
+
     /* The left side must not be const qualified */
     if (IsQualConst (Expr->Type)) {
         Error ("Assignment to const");
@@ -57,6 +57,7 @@ ExprDesc* ED_Init (ExprDesc* Expr)
 /* Initialize an ExprDesc */
 {
     Expr->Sym       = 0;
+    Expr->Callee    = 0;
     Expr->Type      = 0;
     Expr->Flags     = 0;
     Expr->Name      = 0;
@@ -204,7 +205,8 @@ int ED_GetStackOffs (const ExprDesc* Expr, int Offs)
 ExprDesc* ED_MakeConstAbs (ExprDesc* Expr, long Value, Type* Type)
 /* Replace Expr with an absolute const with the given value and type */
 {
-    Expr->Sym   = 0;
+    Expr->Sym    = 0;
+    Expr->Callee = 0;
     Expr->Type  = Type;
     Expr->Flags = E_LOC_NONE | E_RTYPE_RVAL | (Expr->Flags & E_HAVE_MARKS);
     Expr->Name  = 0;
@@ -218,7 +220,8 @@ ExprDesc* ED_MakeConstAbs (ExprDesc* Expr, long Value, Type* Type)
 ExprDesc* ED_MakeConstAbsInt (ExprDesc* Expr, long Value)
 /* Replace Expr with a constant integer expression with the given value */
 {
-    Expr->Sym   = 0;
+    Expr->Sym    = 0;
+    Expr->Callee = 0;
     Expr->Type  = type_int;
     Expr->Flags = E_LOC_NONE | E_RTYPE_RVAL | (Expr->Flags & E_HAVE_MARKS);
     Expr->Name  = 0;
@@ -232,8 +235,9 @@ ExprDesc* ED_MakeConstAbsInt (ExprDesc* Expr, long Value)
 ExprDesc* ED_FinalizeRValLoad (ExprDesc* Expr)
 /* Finalize the result of LoadExpr to be an rvalue in the primary register */
 {
-    Expr->Sym   = 0;
-    Expr->Flags &= ~(E_MASK_LOC | E_MASK_RTYPE | E_BITFIELD | E_ADDRESS_OF);
+    Expr->Sym    = 0;
+    Expr->Callee = 0;
+    Expr->Flags &= ~(E_MASK_LOC | E_MASK_RTYPE | E_BITFIELD | E_ADDRESS_OF | E_SOA);
     Expr->Flags &= ~(E_NEED_TEST | E_CC_SET);
     Expr->Flags |= (E_LOC_PRIMARY | E_RTYPE_RVAL);
     Expr->Name  = 0;
@@ -247,6 +251,8 @@ ExprDesc* ED_FinalizeRValLoad (ExprDesc* Expr)
 ExprDesc* ED_AddrExpr (ExprDesc* Expr)
 /* Take address of Expr. The result is always an rvalue */
 {
+    Expr->Callee = 0;
+
     switch (Expr->Flags & E_MASK_LOC) {
         case E_LOC_NONE:
             Error ("Cannot get the address of a numeric constant");
@@ -281,6 +287,9 @@ ExprDesc* ED_AddrExpr (ExprDesc* Expr)
 ExprDesc* ED_IndExpr (ExprDesc* Expr)
 /* Dereference Expr */
 {
+    /* The value is used if the expression is dereferenced */
+    Expr->Callee = 0;
+
     switch (Expr->Flags & E_MASK_LOC) {
         case E_LOC_NONE:
             Expr->Flags &= ~(E_MASK_LOC | E_MASK_RTYPE);
@@ -123,10 +123,21 @@ enum {
 
     E_HAVE_MARKS        = 0x1000,       /* Code marks are valid */
 
+    E_UNLIKELY          = 0x2000,       /* Expression is expected to be false */
+
     E_LOADED            = 0x4000,       /* Expression is loaded in primary */
 
     E_ADDRESS_OF        = 0x8000,       /* Expression is the address of the lvalue */
 
+    E_SOA               = 0x10000,      /* Reference to an element of an array
+                                        ** with split lo/hi byte layout (see
+                                        ** #pragma soa). The element index -
+                                        ** not an address - is in the primary
+                                        ** register. Such an expression may
+                                        ** only be read or be the target of a
+                                        ** plain assignment.
+                                        */
+
 };
 
 /* Forward */
@@ -136,6 +147,10 @@ struct Literal;
 typedef struct ExprDesc ExprDesc;
 struct ExprDesc {
     struct SymEntry*    Sym;            /* Symbol table entry if known */
+    struct SymEntry*    Callee;         /* Called function if the expression
+                                        ** is the untouched result of a direct
+                                        ** function call
+                                        */
     Type*               Type;           /* Type array of expression */
     unsigned            Flags;
     uintptr_t           Name;           /* Name pointer or label number */
@@ -278,6 +293,18 @@ INLINE int ED_IsBitField (const ExprDesc* Expr)
 #  define ED_IsBitField(Expr)   (((Expr)->Flags & E_BITFIELD) != 0)
 #endif
 
+#if defined(HAVE_INLINE)
+INLINE int ED_IsSoa (const ExprDesc* Expr)
+/* Return true if the expression refers to an element of an array with split
+** lo/hi byte layout
+*/
+{
+    return (Expr->Flags & E_SOA) != 0;
+}
+#else
+#  define ED_IsSoa(Expr)        (((Expr)->Flags & E_SOA) != 0)
+#endif
+
 #if defined(HAVE_INLINE)
 INLINE void ED_DisBitField (ExprDesc* Expr)
 /* Make the expression no longer a bit field */
@@ -332,6 +359,26 @@ INLINE int ED_IsTested (const ExprDesc* Expr)
 #  define ED_IsTested(Expr)   (((Expr)->Flags & E_CC_SET) != 0)
 #endif
 
+#if defined(HAVE_INLINE)
+INLINE void ED_MarkAsUnlikely (ExprDesc* Expr)
+/* Mark the expression as expected to be false. */
+{
+    Expr->Flags |= E_UNLIKELY;
+}
+#else
+#  define ED_MarkAsUnlikely(Expr)  do { (Expr)->Flags |= E_UNLIKELY; } while (0)
+#endif
+
+#if defined(HAVE_INLINE)
+INLINE int ED_IsUnlikely (const ExprDesc* Expr)
+/* Check if the expression is expected to be false. */
+{
+    return (Expr->Flags & E_UNLIKELY) != 0;
+}
+#else
+#  define ED_IsUnlikely(Expr)   (((Expr)->Flags & E_UNLIKELY) != 0)
+#endif
+
 #if defined(HAVE_INLINE)
 INLINE void ED_MarkAsUntested (ExprDesc* Expr)
 /* Mark the expression as not tested (condition codes not set). */
@@ -62,6 +62,7 @@ FuncDesc* NewFuncDesc (void)
     F->LastParam  = 0;
     F->WrappedCall = 0;
     F->WrappedCallData = 0;
+    F->RegChg     = 0;
 
     /* Return the new struct */
     return F;
@@ -53,9 +53,10 @@
 #define FD_OLDSTYLE_INTRET      0x0020U /* K&R func has implicit int return  */
 #define FD_UNNAMED_PARAMS       0x0040U /* Function has unnamed params       */
 #define FD_CALL_WRAPPER         0x0080U /* This function is used as a wrapper */
+#define FD_CHG_KNOWN            0x0100U /* RegChg field is valid             */
 
 /* Bits that must be ignored when comparing funcs */
-#define FD_IGNORE       (FD_OLDSTYLE | FD_OLDSTYLE_INTRET | FD_UNNAMED_PARAMS | FD_CALL_WRAPPER)
+#define FD_IGNORE       (FD_OLDSTYLE | FD_OLDSTYLE_INTRET | FD_UNNAMED_PARAMS | FD_CALL_WRAPPER | FD_CHG_KNOWN)
 
 
 
@@ -70,6 +71,8 @@ struct FuncDesc {
     struct SymEntry*    LastParam;      /* Pointer to last parameter         */
     struct SymEntry*    WrappedCall;    /* Pointer to the WrappedCall        */
     unsigned char       WrappedCallData;/* The WrappedCall's user data       */
+    unsigned short      RegChg;         /* Registers changed by the final    */
+                                        /* code, valid if FD_CHG_KNOWN       */
 };
 
 
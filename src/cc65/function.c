@@ -33,9 +33,14 @@
 
 
 
+#include <string.h>
+
 /* common */
 #include "check.h"
+#include "optdefs.h"
+#include "strbuf.h"
 #include "xmalloc.h"
+#include "xsprintf.h"
 
 /* cc65 */
 #include "asmcode.h"
@@ -47,6 +52,7 @@
 #include "litpool.h"
 #include "locals.h"
 #include "scanner.h"
+#include "segments.h"
 #include "stackptr.h"
 #include "standard.h"
 #include "stmt.h"
@@ -64,6 +70,15 @@
 /* Pointer to current function */
 Function* CurrentFunc = 0;
 
+/* A function called by the current function, together with the worst case
+** stack depth at any of the call sites. Used for the stack usage annotation.
+*/
+typedef struct Callee Callee;
+struct Callee {
+    unsigned    Depth;          /* Stack depth at the call */
+    char        Name[1];        /* Name of the called function */
+};
+
 
 
 /*****************************************************************************/
@@ -87,8 +102,10 @@ static Function* NewFunction (struct SymEntry* Sym)
     F->TopLevelSP = 0;
     F->RegOffs    = RegisterSpace;
     F->Flags      = IsTypeVoid (F->ReturnType) ? FF_VOID_RETURN : FF_NONE;
+    F->MaxStack   = 0;
 
     InitCollection (&F->LocalsBlockStack);
+    InitCollection (&F->Callees);
 
     /* Return the new structure */
     return F;
@@ -99,6 +116,11 @@ static Function* NewFunction (struct SymEntry* Sym)
 static void FreeFunction (Function* F)
 /* Free a function activation structure */
 {
+    unsigned I;
+    for (I = 0; I < CollCount (&F->Callees); ++I) {
+        xfree (CollAtUnchecked (&F->Callees, I));
+    }
+    DoneCollection (&F->Callees);
     DoneCollection (&F->LocalsBlockStack);
     xfree (F);
 }
@@ -243,6 +265,11 @@ void F_AllocLocalSpace (Function* F)
         /* Correct the stack pointer */
         StackPtr -= F->Reserved;
 
+        /* Track the worst case stack usage */
+        if ((unsigned) -StackPtr > F->MaxStack) {
+            F->MaxStack = (unsigned) -StackPtr;
+        }
+
         /* Nothing more reserved */
         F->Reserved = 0;
     }
@@ -250,6 +277,89 @@ void F_AllocLocalSpace (Function* F)
 
 
 
+void F_RecordCall (Function* F, const char* Name)
+/* Record a call to the given function together with the current stack depth
+** for the stack usage annotation. Name is the assembler name of the callee;
+** the pseudo name "*" stands for an indirect call with unknown target. The
+** function may be called with F set to NULL (calls in initializers).
+*/
+{
+    unsigned I;
+    unsigned Depth;
+    Callee*  C;
+
+    /* Nothing to do outside of functions or without the annotation option */
+    if (F == 0 || !StackUsage) {
+        return;
+    }
+
+    /* The stack pointer still includes the pushed arguments here, so this
+    ** is the worst case depth for this call site.
+    */
+    Depth = (StackPtr < 0)? (unsigned) -StackPtr : 0;
+    if (Depth > F->MaxStack) {
+        F->MaxStack = Depth;
+    }
+
+    /* If we have seen this callee before, just remember the worst depth */
+    for (I = 0; I < CollCount (&F->Callees); ++I) {
+        C = CollAtUnchecked (&F->Callees, I);
+        if (strcmp (C->Name, Name) == 0) {
+            if (Depth > C->Depth) {
+                C->Depth = Depth;
+            }
+            return;
+        }
+    }
+
+    /* First call to this function, create a new entry */
+    I = strlen (Name);
+    C = xmalloc (sizeof (Callee) + I);
+    C->Depth = Depth;
+    memcpy (C->Name, Name, I+1);
+    CollAppend (&F->Callees, C);
+}
+
+
+
+static void F_EmitStackUsage (const Function* F)
+/* Emit a file option into the output that describes the worst case stack
+** usage of the function and lists its callees together with the stack depth
+** at the calls. The linker uses these records for its stack depth analysis.
+*/
+{
+    unsigned I;
+    char NumBuf[32];
+    StrBuf Buf = AUTO_STRBUF_INITIALIZER;
+
+    /* Without an assembler name there is nothing to annotate */
+    const char* AsmName = SymGetAsmName (F->FuncEntry);
+    if (AsmName == 0) {
+        return;
+    }
+
+    /* Function name and own worst case usage */
+    SB_Printf (&Buf, "%s %u", AsmName, F->MaxStack);
+
+    /* Append the callees with the stack depth at the call */
+    for (I = 0; I < CollCount (&F->Callees); ++I) {
+        const Callee* C = CollConstAt (&F->Callees, I);
+        SB_AppendChar (&Buf, ' ');
+        SB_AppendStr (&Buf, C->Name);
+        xsprintf (NumBuf, sizeof (NumBuf), " %u", C->Depth);
+        SB_AppendStr (&Buf, NumBuf);
+    }
+    SB_Terminate (&Buf);
+
+    /* Output the annotation as a file option */
+    AddTextLine ("\t.fopt\t\t%u, \"%s\"",
+                 (unsigned) OPT_STACKUSE, SB_GetConstBuf (&Buf));
+
+    SB_Done (&Buf);
+}
+
+
+
 int F_AllocRegVar (Function* F, const Type* Type)
 /* Allocate a register variable for the given variable type. If the allocation
 ** was successful, return the offset of the register variable in the register
@@ -593,6 +703,11 @@ void NewFunc (SymEntry* Func)
     F_EmitDebugInfo ();
     EmitDebugInfo ();
 
+    /* Emit the stack usage annotation if requested */
+    if (StackUsage) {
+        F_EmitStackUsage (CurrentFunc);
+    }
+
     /* Leave the lexical level */
     LeaveFunctionLevel ();
 
@@ -62,6 +62,8 @@ struct Function {
     unsigned            RegOffs;          /* Register variable space offset */
     funcflags_t         Flags;            /* Function flags */
     Collection          LocalsBlockStack; /* Stack of blocks with local vars */
+    unsigned            MaxStack;         /* Worst case stack usage in bytes */
+    Collection          Callees;          /* Called functions w/ stack depth */
 };
 
 /* Structure that holds all data needed for function activation */
@@ -132,6 +134,13 @@ void F_AllocLocalSpace (Function* F);
 ** nothing if there is no reserved local space.
 */
 
+void F_RecordCall (Function* F, const char* Name);
+/* Record a call to the given function together with the current stack depth
+** for the stack usage annotation. Name is the assembler name of the callee;
+** the pseudo name "*" stands for an indirect call with unknown target. The
+** function may be called with F set to NULL (calls in initializers).
+*/
+
 int F_AllocRegVar (Function* F, const Type* Type);
 /* Allocate a register variable for the given variable type. If the allocation
 ** was successful, return the offset of the register variable in the register
@@ -44,10 +44,13 @@
 
 
 unsigned char AddSource         = 0;    /* Add source lines as comments */
+unsigned char AddCycles         = 0;    /* Add cycle estimates as comments */
 unsigned char AutoCDecl         = 0;    /* Make functions default to __cdecl__ */
 unsigned char DebugInfo         = 0;    /* Add debug info to the obj */
 unsigned char PreprocessOnly    = 0;    /* Just preprocess the input */
 unsigned char DebugOptOutput    = 0;    /* Output debug stuff */
+unsigned char TimePasses        = 0;    /* Output per-pass timing */
+unsigned char StackUsage        = 0;    /* Emit stack usage annotations */
 unsigned      RegisterSpace     = 6;    /* Space available for register vars */
 
 /* Stackable options */
@@ -56,13 +59,16 @@ IntStack LocalStrings       = INTSTACK(0);  /* Emit string literals immediately
 IntStack InlineStdFuncs     = INTSTACK(0);  /* Inline some standard functions */
 IntStack EagerlyInlineFuncs = INTSTACK(0);  /* Eagerly inline some known functions */
 IntStack EnableRegVars      = INTSTACK(0);  /* Enable register variables */
+IntStack EnableAutoRegVars  = INTSTACK(0);  /* Make plain locals register vars */
 IntStack AllowRegVarAddr    = INTSTACK(0);  /* Allow taking addresses of register vars */
 IntStack RegVarsToCallStack = INTSTACK(0);  /* Save reg variables on call stack */
+IntStack SoaLayout          = INTSTACK(0);  /* Split lo/hi byte layout for arrays */
 IntStack StaticLocals       = INTSTACK(0);  /* Make local variables static */
 IntStack SignedChars        = INTSTACK(0);  /* Make characters signed by default */
 IntStack CheckStack         = INTSTACK(0);  /* Generate stack overflow checks */
 IntStack Optimize           = INTSTACK(0);  /* Optimize flag */
 IntStack CodeSizeFactor     = INTSTACK(100);/* Size factor for generated code */
+IntStack OptSchedule        = INTSTACK(OPT_SCHED_FULL); /* Optimizer schedule in use */
 IntStack DataAlignment      = INTSTACK(1);  /* Alignment for data */
 
 /* File names */
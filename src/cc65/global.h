@@ -52,10 +52,13 @@
 
 /* Options */
 extern unsigned char    AddSource;              /* Add source lines as comments */
+extern unsigned char    AddCycles;              /* Add cycle estimates as comments */
 extern unsigned char    AutoCDecl;              /* Make functions default to __cdecl__ */
 extern unsigned char    DebugInfo;              /* Add debug info to the obj */
 extern unsigned char    PreprocessOnly;         /* Just preprocess the input */
 extern unsigned char    DebugOptOutput;         /* Output debug stuff */
+extern unsigned char    TimePasses;             /* Output per-pass timing */
+extern unsigned char    StackUsage;             /* Emit stack usage annotations */
 extern unsigned         RegisterSpace;          /* Space available for register vars */
 
 /* Stackable options */
@@ -64,13 +67,23 @@ extern IntStack         LocalStrings;           /* Emit string literals immediat
 extern IntStack         InlineStdFuncs;         /* Inline some standard functions */
 extern IntStack         EagerlyInlineFuncs;     /* Eagerly inline some known functions */
 extern IntStack         EnableRegVars;          /* Enable register variables */
+extern IntStack         EnableAutoRegVars;      /* Make plain locals register vars */
 extern IntStack         AllowRegVarAddr;        /* Allow taking addresses of register vars */
 extern IntStack         RegVarsToCallStack;     /* Save reg variables on call stack */
+extern IntStack         SoaLayout;              /* Split lo/hi byte layout for arrays */
 extern IntStack         StaticLocals;           /* Make local variables static */
 extern IntStack         SignedChars;            /* Make characters signed by default */
 extern IntStack         CheckStack;             /* Generate stack overflow checks */
 extern IntStack         Optimize;               /* Optimize flag */
 extern IntStack         CodeSizeFactor;         /* Size factor for generated code */
+
+/* Optimizer schedules, selectable with #pragma opt-schedule. The cold
+** schedule runs a reduced list of optimizer groups, trading some code
+** quality for compile time.
+*/
+#define OPT_SCHED_FULL  0L              /* Run all optimizer groups */
+#define OPT_SCHED_COLD  1L              /* Reduced schedule for cold code */
+extern IntStack         OptSchedule;            /* Optimizer schedule in use */
 extern IntStack         DataAlignment;          /* Alignment for data */
 
 /* File names */
@@ -0,0 +1,447 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                globfold.c                                 */
+/*                                                                           */
+/*              Fold loads of effectively constant global data               */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#include <stdlib.h>
+#include <string.h>
+
+/* common */
+#include "chartype.h"
+#include "coll.h"
+#include "strbuf.h"
+#include "xmalloc.h"
+
+/* cc65 */
+#include "codeent.h"
+#include "datatype.h"
+#include "globfold.h"
+#include "segments.h"
+#include "symtab.h"
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* One recorded file scope variable */
+typedef struct GFSym GFSym;
+struct GFSym {
+    const SymEntry* Sym;        /* Symbol table entry */
+    char*           Label;      /* Assembler label including underline */
+    StrBuf          Data;       /* Initialization data */
+    StrBuf          Known;      /* One flag per data byte: value known? */
+    char            ConstQual;  /* Variable is const qualified */
+    char            Eligible;   /* Loads may be folded */
+};
+
+/* All recorded variables */
+static Collection GFSyms = STATIC_COLLECTION_INITIALIZER;
+
+/* Names of symbols whose address was used in an initializer */
+static Collection AddrRefs = STATIC_COLLECTION_INITIALIZER;
+
+/* The variable whose initializer is currently recorded */
+static GFSym* Recording = 0;
+
+/* True once GF_Analyze has run */
+static int Analyzed = 0;
+
+
+
+/*****************************************************************************/
+/*                             Helper functions                              */
+/*****************************************************************************/
+
+
+
+static int ParseOffs (const char* Arg, const GFSym* G, unsigned* Offs)
+/* If Arg is the label of G, optionally followed by a positive offset as
+** generated by the code generator, return true and place the offset in
+** Offs. Return false otherwise.
+*/
+{
+    unsigned Len = strlen (G->Label);
+    if (strncmp (Arg, G->Label, Len) != 0) {
+        return 0;
+    }
+    if (Arg[Len] == '\0') {
+        *Offs = 0;
+        return 1;
+    }
+    if (Arg[Len] == '+' && IsDigit (Arg[Len+1])) {
+        char* End;
+        unsigned long Val = strtoul (Arg+Len+1, &End, 10);
+        if (*End == '\0') {
+            *Offs = (unsigned) Val;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+
+static int HasVolatileData (const Type* T)
+/* Check if T is volatile qualified or contains a volatile qualified member.
+** Looks through arrays and recurses into struct and union field lists, so
+** qualifiers on aggregate members are seen, too.
+*/
+{
+    /* An array of X must be read like an X */
+    T = GetBaseElementType ((Type*) T);
+
+    /* Check the type itself */
+    if (IsQualVolatile (T)) {
+        return 1;
+    }
+
+    /* For structs and unions check all fields */
+    if (IsClassStruct (T)) {
+        const SymEntry* Field;
+        const SymTable* Tab = GetSymEntry (T)->V.S.SymTab;
+        if (Tab == 0) {
+            /* Incomplete type - be conservative */
+            return 1;
+        }
+        for (Field = Tab->SymHead; Field != 0; Field = Field->NextSym) {
+            if (HasVolatileData (Field->Type)) {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+
+
+static int IsReadOPC (opc_t OPC)
+/* Check if the insn just reads its memory operand. Note that read modify
+** write insns like inc or asl are not in this list.
+*/
+{
+    switch (OPC) {
+        case OP65_ADC:
+        case OP65_AND:
+        case OP65_BIT:
+        case OP65_CMP:
+        case OP65_CPX:
+        case OP65_CPY:
+        case OP65_EOR:
+        case OP65_LDA:
+        case OP65_LDX:
+        case OP65_LDY:
+        case OP65_ORA:
+        case OP65_SBC:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+
+
+static int IsFoldableRead (const CodeEntry* E, const GFSym* G)
+/* Check if E is a plain absolute read of the data of G */
+{
+    unsigned Offs;
+    return IsReadOPC (E->OPC)           &&
+           E->AM == AM65_ABS            &&
+           ParseOffs (E->Arg, G, &Offs) &&
+           Offs < SB_GetLen (&G->Data);
+}
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+void GF_InitBegin (struct SymEntry* Sym)
+/* Called before the initializer of the file scope variable Sym is parsed.
+** Starts recording the emitted data if the variable may be a candidate for
+** load folding.
+*/
+{
+    GFSym* G;
+    unsigned Len;
+
+    /* Be sure a dangling recording is never continued */
+    Recording = 0;
+
+    /* Volatile variables - including aggregates with a volatile qualified
+    ** member - must be read from memory. Variables that are neither const
+    ** qualified nor of internal linkage can be changed by other translation
+    ** units, so recording their data is pointless.
+    */
+    if (Sym == 0                                                ||
+        HasVolatileData (Sym->Type)                             ||
+        (!IsQualConst (GetBaseElementType (Sym->Type)) &&
+         (Sym->Flags & (SC_STATIC | SC_EXTERN)) != SC_STATIC)) {
+        return;
+    }
+
+    /* Create a new record */
+    G = xmalloc (sizeof (GFSym));
+    G->Sym = Sym;
+    Len = strlen (Sym->Name);
+    G->Label = xmalloc (Len + 2);
+    G->Label[0] = '_';
+    memcpy (G->Label+1, Sym->Name, Len+1);
+    SB_Init (&G->Data);
+    SB_Init (&G->Known);
+    G->ConstQual = IsQualConst (GetBaseElementType (Sym->Type));
+    G->Eligible  = 0;
+
+    /* Add it to the list and start recording */
+    CollAppend (&GFSyms, G);
+    Recording = G;
+}
+
+
+
+void GF_InitEnd (void)
+/* Called after the initializer has been parsed. Stops recording. */
+{
+    Recording = 0;
+}
+
+
+
+void GF_InitData (unsigned long Val, unsigned Size)
+/* Record Size bytes of constant initialization data (little endian) */
+{
+    if (Recording) {
+        while (Size--) {
+            SB_AppendChar (&Recording->Data, (char) (Val & 0xFF));
+            SB_AppendChar (&Recording->Known, 1);
+            Val >>= 8;
+        }
+    }
+}
+
+
+
+void GF_InitBytes (const void* Data, unsigned Count)
+/* Record a row of constant initialization bytes */
+{
+    if (Recording) {
+        const unsigned char* P = Data;
+        while (Count--) {
+            SB_AppendChar (&Recording->Data, (char) *P++);
+            SB_AppendChar (&Recording->Known, 1);
+        }
+    }
+}
+
+
+
+void GF_InitZero (unsigned Count)
+/* Record Count bytes of zero initialization data */
+{
+    if (Recording) {
+        while (Count--) {
+            SB_AppendChar (&Recording->Data, 0);
+            SB_AppendChar (&Recording->Known, 1);
+        }
+    }
+}
+
+
+
+void GF_InitUnknown (unsigned Count)
+/* Record Count bytes of initialization data with an unknown value, for
+** example a relocatable address.
+*/
+{
+    if (Recording) {
+        while (Count--) {
+            SB_AppendChar (&Recording->Data, 0);
+            SB_AppendChar (&Recording->Known, 0);
+        }
+    }
+}
+
+
+
+void GF_InitAddrRef (const char* Name)
+/* Record that the address of the global symbol with the given name is used
+** in an initializer. The variable may then be written through a pointer, so
+** it is disqualified from load folding unless it is const qualified.
+*/
+{
+    CollAppend (&AddrRefs, xstrdup (Name));
+}
+
+
+
+void GF_Analyze (void)
+/* Determine which of the recorded variables are effectively constant. Must
+** be called when the complete translation unit has been parsed, but before
+** the optimizer is run, since the code of all functions is searched for
+** stores into the recorded variables.
+*/
+{
+    unsigned I, J;
+    unsigned Pending;
+    SymEntry* Entry;
+
+    /* Start out optimistic: Const qualified variables cannot legally be
+    ** written at all. The others have internal linkage (see GF_InitBegin),
+    ** so all accesses are visible here; assume eligibility unless the
+    ** address was used in an initializer, and revoke it below when a
+    ** disqualifying reference is found in the code.
+    */
+    Pending = 0;
+    for (I = 0; I < CollCount (&GFSyms); ++I) {
+        GFSym* G = CollAt (&GFSyms, I);
+        if (G->ConstQual) {
+            G->Eligible = 1;
+        } else {
+            G->Eligible = 1;
+            for (J = 0; J < CollCount (&AddrRefs); ++J) {
+                if (strcmp (G->Label+1, CollConstAt (&AddrRefs, J)) == 0) {
+                    G->Eligible = 0;
+                    break;
+                }
+            }
+            if (G->Eligible) {
+                ++Pending;
+            }
+        }
+    }
+
+    /* Search the code of all functions for references to the non const
+    ** candidates. Anything but a plain absolute read - a store, a read
+    ** modify write insn, an indexed access or a use of the address as an
+    ** immediate operand - disqualifies the variable.
+    */
+    for (Entry = GetGlobalSymTab ()->SymHead; Pending > 0 && Entry; Entry = Entry->NextSym) {
+        CodeSeg* S;
+        if (!SymIsOutputFunc (Entry)) {
+            continue;
+        }
+        S = Entry->V.F.Seg->Code;
+        for (I = 0; I < CS_GetEntryCount (S); ++I) {
+            const CodeEntry* E = CS_GetEntry (S, I);
+            for (J = 0; J < CollCount (&GFSyms); ++J) {
+                GFSym* G = CollAt (&GFSyms, J);
+                const char* P;
+                unsigned Len;
+                if (G->ConstQual || !G->Eligible) {
+                    continue;
+                }
+                Len = strlen (G->Label);
+                P = strstr (E->Arg, G->Label);
+                while (P != 0) {
+                    char T = P[Len];
+                    if (!IsAlNum (T) && T != '_') {
+                        /* A real reference to the symbol */
+                        if (P != E->Arg || !IsFoldableRead (E, G)) {
+                            G->Eligible = 0;
+                            --Pending;
+                            break;
+                        }
+                    }
+                    P = strstr (P+1, G->Label);
+                }
+            }
+        }
+    }
+
+    Analyzed = 1;
+}
+
+
+
+unsigned OptConstGlobals (CodeSeg* S)
+/* Replace absolute address loads of effectively constant global data by
+** immediate loads of the known values.
+*/
+{
+    unsigned Changes = 0;
+    unsigned I;
+
+    /* Without analysis results there is nothing to do */
+    if (!Analyzed || CollCount (&GFSyms) == 0) {
+        return 0;
+    }
+
+    /* Walk over the entries */
+    I = 0;
+    while (I < CS_GetEntryCount (S)) {
+
+        /* Get next entry */
+        CodeEntry* E = CS_GetEntry (S, I);
+
+        /* Check for an absolute read of a global symbol. BIT is excluded
+        ** since the 6502 has no immediate addressing mode for it.
+        */
+        if (IsReadOPC (E->OPC)      &&
+            E->OPC != OP65_BIT      &&
+            E->AM == AM65_ABS       &&
+            E->Arg[0] == '_') {
+
+            unsigned J;
+            for (J = 0; J < CollCount (&GFSyms); ++J) {
+
+                GFSym* G = CollAt (&GFSyms, J);
+                unsigned Offs;
+
+                if (G->Eligible                     &&
+                    ParseOffs (E->Arg, G, &Offs)    &&
+                    Offs < SB_GetLen (&G->Data)     &&
+                    SB_AtUnchecked (&G->Known, Offs) != 0) {
+
+                    /* The value of the loaded byte is known, replace the
+                    ** load by an immediate load of that value.
+                    */
+                    const char* Arg = MakeHexArg ((unsigned char) SB_AtUnchecked (&G->Data, Offs));
+                    CodeEntry* X = NewCodeEntry (E->OPC, AM65_IMM, Arg, 0, E->LI);
+                    CS_InsertEntry (S, X, I+1);
+                    CS_DelEntry (S, I);
+
+                    /* Remember, we had changes */
+                    ++Changes;
+                    break;
+                }
+            }
+        }
+
+        /* Next entry */
+        ++I;
+    }
+
+    /* Return the number of changes made */
+    return Changes;
+}
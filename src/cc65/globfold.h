@@ -0,0 +1,101 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                globfold.h                                 */
+/*                                                                           */
+/*              Fold loads of effectively constant global data               */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#ifndef GLOBFOLD_H
+#define GLOBFOLD_H
+
+
+
+/* cc65 */
+#include "codeseg.h"
+#include "symentry.h"
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+/* The module records the initialization data of file scope variables while
+** it is parsed. Since all functions are optimized at the end of the
+** translation unit, the collected data allows a whole program (in the sense
+** of: whole translation unit) analysis there: Variables that are const
+** qualified, or that have internal linkage and are provably never written,
+** hold their initial value forever. Absolute address loads of such values
+** can then be replaced by immediate loads.
+*/
+
+void GF_InitBegin (struct SymEntry* Sym);
+/* Called before the initializer of the file scope variable Sym is parsed.
+** Starts recording the emitted data if the variable may be a candidate for
+** load folding.
+*/
+
+void GF_InitEnd (void);
+/* Called after the initializer has been parsed. Stops recording. */
+
+void GF_InitData (unsigned long Val, unsigned Size);
+/* Record Size bytes of constant initialization data (little endian) */
+
+void GF_InitBytes (const void* Data, unsigned Count);
+/* Record a row of constant initialization bytes */
+
+void GF_InitZero (unsigned Count);
+/* Record Count bytes of zero initialization data */
+
+void GF_InitUnknown (unsigned Count);
+/* Record Count bytes of initialization data with an unknown value, for
+** example a relocatable address.
+*/
+
+void GF_InitAddrRef (const char* Name);
+/* Record that the address of the global symbol with the given name is used
+** in an initializer. The variable may then be written through a pointer, so
+** it is disqualified from load folding unless it is const qualified.
+*/
+
+void GF_Analyze (void);
+/* Determine which of the recorded variables are effectively constant. Must
+** be called when the complete translation unit has been parsed, but before
+** the optimizer is run, since the code of all functions is searched for
+** stores into the recorded variables.
+*/
+
+unsigned OptConstGlobals (CodeSeg* S);
+/* Replace absolute address loads of effectively constant global data by
+** immediate loads of the known values.
+*/
+
+
+
+/* End of globfold.h */
+
+#endif
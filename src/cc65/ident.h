@@ -38,6 +38,12 @@
 
 
 
+/* common */
+#include "chartype.h"
+#include "inline.h"
+
+
+
 /*****************************************************************************/
 /*                                   Data                                    */
 /*****************************************************************************/
@@ -59,8 +65,15 @@ typedef char ident [IDENTSIZE];
 
 
 
-int IsIdent (char c);
+#if defined(HAVE_INLINE)
+INLINE int IsIdent (char c)
 /* Return true if the given char may start an identifier */
+{
+    return IsClass (c, CT_IDENT);
+}
+#else
+#  define IsIdent(c)            IsClass (c, CT_IDENT)
+#endif
 
 
 
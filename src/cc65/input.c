@@ -50,9 +50,11 @@
 #include "codegen.h"
 #include "error.h"
 #include "global.h"
+#include "ident.h"
 #include "incpath.h"
 #include "input.h"
 #include "lineinfo.h"
+#include "macrotab.h"
 #include "output.h"
 
 
@@ -73,6 +75,16 @@ char NextC = '\0';
 /* Maximum count of nested includes */
 #define MAX_INC_NESTING         16
 
+/* States of the include guard detection. A file is wrapped in an include
+** guard if it contains nothing but an #ifndef/#endif pair around the whole
+** contents. The preprocessor reports the interesting events via the
+** InputGuard functions below, and the state is tracked per active file.
+*/
+#define GS_START        0U      /* Nothing seen yet, #ifndef may open a guard */
+#define GS_ACTIVE       1U      /* Inside the guard conditional */
+#define GS_CLOSED       2U      /* Guard closed, must be followed by EOF */
+#define GS_NONE         3U      /* File has no include guard */
+
 /* Struct that describes an input file */
 typedef struct IFile IFile;
 struct IFile {
@@ -81,6 +93,7 @@ struct IFile {
     unsigned long   Size;       /* File size */
     unsigned long   MTime;      /* Time of last modification */
     InputType       Type;       /* Type of input file */
+    char*           GuardMacro; /* Include guard macro or NULL */
     char            Name[1];    /* Name of file (dynamically allocated) */
 };
 
@@ -88,14 +101,33 @@ struct IFile {
 typedef struct AFile AFile;
 struct AFile {
     unsigned    Line;           /* Line number for this file */
-    FILE*       F;              /* Input file stream */
+    char*       Buf;            /* Contents of the file */
+    unsigned long BufSize;      /* Size of the contents */
+    unsigned long BufPos;       /* Read position in the contents */
     IFile*      Input;          /* Points to corresponding IFile */
     int         SearchPath;     /* True if we've added a path for this file */
+    unsigned    GuardState;     /* Include guard detection state */
+    int         GuardIf;        /* #if stack index of the guard clause */
+    ident       GuardName;      /* Candidate include guard macro */
+};
+
+/* Entry in the system include resolution cache */
+typedef struct IncRes IncRes;
+struct IncRes {
+    IFile*      File;           /* File the name resolved to */
+    char        Name[1];        /* Name as spelled in the directive */
 };
 
 /* List of all input files */
 static Collection IFiles = STATIC_COLLECTION_INITIALIZER;
 
+/* Cache of resolved system include names. The system include search path is
+** fixed for the whole compilation, so the file a name resolves to may be
+** remembered on first use. User includes are not cached, because their
+** search path changes with the directory of the including file.
+*/
+static Collection SysIncCache = STATIC_COLLECTION_INITIALIZER;
+
 /* List of all active files */
 static Collection AFiles = STATIC_COLLECTION_INITIALIZER;
 
@@ -125,6 +157,7 @@ static IFile* NewIFile (const char* Name, InputType Type)
     IF->Size  = 0;
     IF->MTime = 0;
     IF->Type  = Type;
+    IF->GuardMacro = 0;
     memcpy (IF->Name, Name, Len+1);
 
     /* Insert the new structure into the IFile collection */
@@ -145,18 +178,42 @@ static IFile* NewIFile (const char* Name, InputType Type)
 static AFile* NewAFile (IFile* IF, FILE* F)
 /* Create a new AFile, push it onto the stack, add the path of the file to
 ** the path search list, and finally return a pointer to the new AFile struct.
+** The contents of the file are read as a whole and the stream is closed, so
+** line splitting can later work on memory without any stdio overhead.
 */
 {
     StrBuf Path = AUTO_STRBUF_INITIALIZER;
+    long Size;
 
     /* Allocate a AFile structure */
     AFile* AF = (AFile*) xmalloc (sizeof (AFile));
 
     /* Initialize the fields */
     AF->Line  = 0;
-    AF->F     = F;
     AF->Input = IF;
 
+    /* Determine the file size */
+    if (fseek (F, 0, SEEK_END) != 0 || (Size = ftell (F)) < 0) {
+        Fatal ("Cannot seek in '%s': %s", IF->Name, strerror (errno));
+    }
+    rewind (F);
+
+    /* Read the contents of the file in one chunk. Since the file is read
+    ** in text mode, the data read may be smaller than the file size.
+    */
+    AF->Buf = xmalloc ((size_t) Size + 1);
+    AF->BufSize = (unsigned long) fread (AF->Buf, 1, (size_t) Size, F);
+    AF->BufPos  = 0;
+    if (ferror (F)) {
+        Fatal ("Cannot read from '%s': %s", IF->Name, strerror (errno));
+    }
+
+    /* The stream is no longer needed (we're just reading so no error check) */
+    fclose (F);
+    AF->GuardState   = GS_START;
+    AF->GuardIf      = -1;
+    AF->GuardName[0] = '\0';
+
     /* Increment the usage counter of the corresponding IFile. If this
     ** is the first use, set the file data and output debug info if
     ** requested.
@@ -204,6 +261,7 @@ static AFile* NewAFile (IFile* IF, FILE* F)
 static void FreeAFile (AFile* AF)
 /* Free an AFile structure */
 {
+    xfree (AF->Buf);
     xfree (AF);
 }
 
@@ -215,6 +273,108 @@ static void FreeAFile (AFile* AF)
 
 
 
+static AFile* CurrentAFile (void)
+/* Return the currently active input file or NULL if there is none */
+{
+    unsigned AFileCount = CollCount (&AFiles);
+    return (AFileCount > 0)? (AFile*) CollAt (&AFiles, AFileCount-1) : 0;
+}
+
+
+
+void InputGuardIfNDef (const char* Name, int Index)
+/* Called by the preprocessor for a processed #ifndef. Index is the position
+** of the new clause on the #if stack. If this is the first thing seen in the
+** current file, Name is a candidate include guard macro.
+*/
+{
+    AFile* AF = CurrentAFile ();
+    if (AF == 0) {
+        return;
+    }
+    switch (AF->GuardState) {
+        case GS_START:
+            /* This may be the include guard of the file */
+            strcpy (AF->GuardName, Name);
+            AF->GuardIf    = Index;
+            AF->GuardState = GS_ACTIVE;
+            break;
+        case GS_ACTIVE:
+            /* Nested conditional inside the guard, ignore */
+            break;
+        default:
+            /* Conditional before or after the guard */
+            AF->GuardState = GS_NONE;
+            break;
+    }
+}
+
+
+
+void InputGuardElse (int Index)
+/* Called by the preprocessor for a processed #else or #elif. Index is the
+** position of the affected clause on the #if stack.
+*/
+{
+    AFile* AF = CurrentAFile ();
+    if (AF == 0) {
+        return;
+    }
+    if (AF->GuardState == GS_ACTIVE) {
+        if (Index == AF->GuardIf) {
+            /* An #else/#elif on the guard conditional means the file has
+            ** contents when the guard macro is defined, so it's no guard.
+            */
+            AF->GuardState = GS_NONE;
+        }
+    } else if (AF->GuardState != GS_NONE) {
+        AF->GuardState = GS_NONE;
+    }
+}
+
+
+
+void InputGuardEndIf (int Index)
+/* Called by the preprocessor for a processed #endif. Index is the new top
+** of the #if stack.
+*/
+{
+    AFile* AF = CurrentAFile ();
+    if (AF == 0) {
+        return;
+    }
+    if (AF->GuardState == GS_ACTIVE) {
+        if (Index == AF->GuardIf - 1) {
+            /* The guard conditional was closed. If nothing follows but the
+            ** end of the file, the file is guarded.
+            */
+            AF->GuardState = GS_CLOSED;
+        } else if (Index < AF->GuardIf - 1) {
+            /* Popped beyond the guard clause, something is fishy */
+            AF->GuardState = GS_NONE;
+        }
+    } else if (AF->GuardState != GS_NONE) {
+        AF->GuardState = GS_NONE;
+    }
+}
+
+
+
+void InputGuardContent (void)
+/* Called by the preprocessor for anything that has an effect outside of a
+** conditional: Ordinary text lines and directives other than the guard
+** pattern itself. Content inside the guard conditional is harmless, content
+** before or after it means the file has no include guard.
+*/
+{
+    AFile* AF = CurrentAFile ();
+    if (AF != 0 && (AF->GuardState == GS_START || AF->GuardState == GS_CLOSED)) {
+        AF->GuardState = GS_NONE;
+    }
+}
+
+
+
 static IFile* FindFile (const char* Name)
 /* Find the file with the given name in the list of all files. Since the list
 ** is not large (usually less than 10), I don't care about using hashes or
@@ -268,6 +428,23 @@ void OpenMainFile (const char* Name)
 
 
 
+static IFile* FindSysInclude (const char* Name)
+/* Search the system include resolution cache. Returns the file the name
+** resolved to earlier or NULL if the name wasn't seen before.
+*/
+{
+    unsigned I;
+    for (I = 0; I < CollCount (&SysIncCache); ++I) {
+        IncRes* R = (IncRes*) CollAt (&SysIncCache, I);
+        if (strcmp (Name, R->Name) == 0) {
+            return R->File;
+        }
+    }
+    return 0;
+}
+
+
+
 void OpenIncludeFile (const char* Name, InputType IT)
 /* Open an include file and insert it into the tables. */
 {
@@ -281,23 +458,47 @@ void OpenIncludeFile (const char* Name, InputType IT)
         return;
     }
 
-    /* Search for the file */
-    N = SearchFile ((IT == IT_SYSINC)? SysIncSearchPath : UsrIncSearchPath, Name);
-    if (N == 0) {
-        PPError ("Include file '%s' not found", Name);
-        return;
-    }
-
-    /* Search the list of all input files for this file. If we don't find
-    ** it, create a new IFile object.
+    /* For repeated system includes, the resolution cache saves the path
+    ** search below.
     */
-    IF = FindFile (N);
+    IF = (IT == IT_SYSINC)? FindSysInclude (Name) : 0;
     if (IF == 0) {
-        IF = NewIFile (N, IT);
+
+        /* Search for the file */
+        N = SearchFile ((IT == IT_SYSINC)? SysIncSearchPath : UsrIncSearchPath, Name);
+        if (N == 0) {
+            PPError ("Include file '%s' not found", Name);
+            return;
+        }
+
+        /* Search the list of all input files for this file. If we don't find
+        ** it, create a new IFile object.
+        */
+        IF = FindFile (N);
+        if (IF == 0) {
+            IF = NewIFile (N, IT);
+        }
+
+        /* Remember the resolution for later inclusions */
+        if (IT == IT_SYSINC) {
+            unsigned Len = strlen (Name);
+            IncRes* R = (IncRes*) xmalloc (sizeof (IncRes) + Len);
+            R->File = IF;
+            memcpy (R->Name, Name, Len+1);
+            CollAppend (&SysIncCache, R);
+        }
+
+        /* We don't need N any longer, since we may now use IF->Name */
+        xfree (N);
     }
 
-    /* We don't need N any longer, since we may now use IF->Name */
-    xfree (N);
+    /* If the file is wrapped in an include guard and the guard macro is
+    ** defined, including it again has no effect. Don't even open it.
+    */
+    if (IF->GuardMacro != 0 && IsMacro (IF->GuardMacro)) {
+        Print (stdout, 1, "Skipping guarded include file '%s'\n", IF->Name);
+        return;
+    }
 
     /* Open the file */
     F = fopen (IF->Name, "r");
@@ -332,8 +533,13 @@ static void CloseIncludeFile (void)
     /* Get the current active input file */
     Input = (AFile*) CollLast (&AFiles);
 
-    /* Close the current input file (we're just reading so no error check) */
-    fclose (Input->F);
+    /* If the complete file was wrapped in an include guard, remember the
+    ** guard macro, so later inclusions may be skipped while the macro is
+    ** still defined.
+    */
+    if (Input->GuardState == GS_CLOSED && Input->Input->GuardMacro == 0) {
+        Input->Input->GuardMacro = xstrdup (Input->GuardName);
+    }
 
     /* Delete the last active file from the active file collection */
     CollDelete (&AFiles, AFileCount-1);
@@ -449,16 +655,21 @@ int NextLine (void)
     }
     Input = CollLast (&AFiles);
 
-    /* Read characters until we have one complete line */
+    /* The contents of the file are in memory, so a line is just a slice of
+    ** the file buffer. Searching the newline with memchr touches the data
+    ** with a wide scan instead of per character processing, and the line is
+    ** moved into the line buffer with one copy.
+    */
     while (1) {
 
-        /* Read the next character */
-        int C = fgetc (Input->F);
+        const char* Start;
+        const char* NL;
 
-        /* Check for EOF */
-        if (C == EOF) {
+        /* Get the data left in the current file */
+        unsigned long Avail = Input->BufSize - Input->BufPos;
+        if (Avail == 0) {
 
-            /* Accept files without a newline at the end */
+            /* End of file. Accept files without a newline at the end. */
             if (SB_NotEmpty (Line)) {
                 ++Input->Line;
                 break;
@@ -477,34 +688,40 @@ int NextLine (void)
             continue;
         }
 
-        /* Check for end of line */
-        if (C == '\n') {
+        /* Search for the end of the line */
+        Start = Input->Buf + Input->BufPos;
+        NL = memchr (Start, '\n', Avail);
 
-            /* We got a new line */
-            ++Input->Line;
-
-            /* If the \n is preceeded by a \r, remove the \r, so we can read
-            ** DOS/Windows files under *nix.
-            */
-            if (SB_LookAtLast (Line) == '\r') {
-                SB_Drop (Line, 1);
-            }
-
-            /* If we don't have a line continuation character at the end,
-            ** we're done with this line. Otherwise replace the character
-            ** by a newline and continue reading.
-            */
-            if (SB_LookAtLast (Line) == '\\') {
-                Line->Buf[Line->Len-1] = '\n';
-            } else {
-                break;
-            }
+        /* If there is no newline, the file ends without one. Add the rest
+        ** of the file, the end of file handling above will terminate the
+        ** line.
+        */
+        if (NL == 0) {
+            SB_AppendBuf (Line, Start, Avail);
+            Input->BufPos += Avail;
+            continue;
+        }
 
-        } else if (C != '\0') {         /* Ignore embedded NULs */
+        /* We got a new line. Add it without the newline. */
+        ++Input->Line;
+        SB_AppendBuf (Line, Start, (unsigned) (NL - Start));
+        Input->BufPos += (unsigned long) (NL - Start) + 1;
 
-            /* Just some character, add it to the line */
-            SB_AppendChar (Line, C);
+        /* If the \n is preceeded by a \r, remove the \r, so we can read
+        ** DOS/Windows files under *nix.
+        */
+        if (SB_LookAtLast (Line) == '\r') {
+            SB_Drop (Line, 1);
+        }
 
+        /* If we don't have a line continuation character at the end,
+        ** we're done with this line. Otherwise replace the character
+        ** by a newline and continue reading.
+        */
+        if (SB_LookAtLast (Line) == '\\') {
+            Line->Buf[Line->Len-1] = '\n';
+        } else {
+            break;
         }
     }
 
@@ -531,6 +748,22 @@ const char* GetInputFile (const struct IFile* IF)
 
 
 
+unsigned GetInputFileCount (void)
+/* Return the total count of input files read so far */
+{
+    return CollCount (&IFiles);
+}
+
+
+
+const char* GetInputFileName (unsigned Index)
+/* Return the name of the input file with the given index */
+{
+    return ((const IFile*) CollAt (&IFiles, Index))->Name;
+}
+
+
+
 const char* GetCurrentFile (void)
 /* Return the name of the current input file */
 {
@@ -84,6 +84,28 @@ void OpenMainFile (const char* Name);
 void OpenIncludeFile (const char* Name, InputType IT);
 /* Open an include file and insert it into the tables. */
 
+void InputGuardIfNDef (const char* Name, int Index);
+/* Called by the preprocessor for a processed #ifndef. Index is the position
+** of the new clause on the #if stack. If this is the first thing seen in the
+** current file, Name is a candidate include guard macro.
+*/
+
+void InputGuardElse (int Index);
+/* Called by the preprocessor for a processed #else or #elif. Index is the
+** position of the affected clause on the #if stack.
+*/
+
+void InputGuardEndIf (int Index);
+/* Called by the preprocessor for a processed #endif. Index is the new top
+** of the #if stack.
+*/
+
+void InputGuardContent (void);
+/* Called by the preprocessor for anything that has an effect outside of a
+** conditional: Ordinary text lines and directives other than the guard
+** pattern itself.
+*/
+
 void NextChar (void);
 /* Read the next character from the input stream and make CurC and NextC
 ** valid. If end of line is reached, both are set to NUL, no more lines
@@ -104,6 +126,12 @@ int NextLine (void);
 const char* GetInputFile (const struct IFile* IF);
 /* Return a filename from an IFile struct */
 
+unsigned GetInputFileCount (void);
+/* Return the total count of input files read so far */
+
+const char* GetInputFileName (unsigned Index);
+/* Return the name of the input file with the given index */
+
 const char* GetCurrentFile (void);
 /* Return the name of the current input file */
 
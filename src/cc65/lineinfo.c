@@ -56,6 +56,14 @@
 /* Global pointer to line information for the current line */
 static LineInfo* CurLineInfo = 0;
 
+/* One entry cache of a freed line info. A line info is allocated for every
+** input line and freed again with the next line if nothing did reference it,
+** so keeping the last freed record around for reuse avoids an alloc/free
+** cycle per line. The larger of two freed records is cached, so the cached
+** buffer will fit most lines after a short while.
+*/
+static LineInfo* FreeLI = 0;
+
 
 
 /*****************************************************************************/
@@ -82,8 +90,16 @@ static LineInfo* NewLineInfo (struct IFile* F, unsigned LineNum, const StrBuf* L
         --Len;
     }
 
-    /* Allocate memory for the line info and the input line */
-    LI = xmalloc (sizeof (LineInfo) + Len);
+    /* Reuse the cached free record if its buffer is large enough, otherwise
+    ** allocate memory for the line info and the input line.
+    */
+    if (FreeLI != 0 && FreeLI->BufSize >= Len) {
+        LI = FreeLI;
+        FreeLI = 0;
+    } else {
+        LI = xmalloc (sizeof (LineInfo) + Len);
+        LI->BufSize = Len;
+    }
 
     /* Initialize the fields */
     LI->RefCount  = 1;
@@ -117,7 +133,15 @@ static LineInfo* NewLineInfo (struct IFile* F, unsigned LineNum, const StrBuf* L
 static void FreeLineInfo (LineInfo* LI)
 /* Free a LineInfo structure */
 {
-    xfree (LI);
+    /* Keep the record with the larger buffer for reuse by NewLineInfo */
+    if (FreeLI == 0) {
+        FreeLI = LI;
+    } else if (LI->BufSize > FreeLI->BufSize) {
+        xfree (FreeLI);
+        FreeLI = LI;
+    } else {
+        xfree (LI);
+    }
 }
 
 
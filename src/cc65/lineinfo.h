@@ -68,6 +68,7 @@ struct LineInfo {
     unsigned        RefCount;             /* Reference counter */
     struct IFile*   InputFile;            /* Input file for this line */
     unsigned        LineNum;              /* Line number */
+    unsigned        BufSize;              /* Allocated size of Line */
     char            Line[1];              /* Source code line */
 };
 
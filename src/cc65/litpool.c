@@ -40,6 +40,7 @@
 #include "attrib.h"
 #include "check.h"
 #include "coll.h"
+#include "hashfunc.h"
 #include "tgttrans.h"
 #include "xmalloc.h"
 
@@ -63,6 +64,9 @@ struct Literal {
     unsigned    Label;                  /* Asm label for this literal */
     int         RefCount;               /* Reference count */
     int         Output;                 /* True if output has been generated */
+    int         Indexed;                /* True if in the emitted literal index */
+    unsigned    Hash;                   /* Hash over the literal data */
+    Literal*    Next;                   /* Next literal in hash chain */
     StrBuf      Data;                   /* Literal data */
 };
 
@@ -84,6 +88,16 @@ static LiteralPool*     LP         = 0;
 */
 static Collection       LPStack  = STATIC_COLLECTION_INITIALIZER;
 
+/* Index of all readonly literals emitted so far, keyed by a hash over their
+** data. The index persists over the single literal pools, so a literal may
+** also share storage with one emitted for another function.
+*/
+#define LIT_HASH_SIZE   1024U           /* Must be a power of two */
+static Literal*         LitHashTab[LIT_HASH_SIZE];
+
+/* Emitted literals in emission order, used for suffix merging */
+static Collection       EmittedLits = STATIC_COLLECTION_INITIALIZER;
+
 
 
 /*****************************************************************************/
@@ -102,6 +116,9 @@ static Literal* NewLiteral (const void* Buf, unsigned Len)
     L->Label    = GetLocalLabel ();
     L->RefCount = 0;
     L->Output   = 0;
+    L->Indexed  = 0;
+    L->Hash     = 0;
+    L->Next     = 0;
     SB_Init (&L->Data);
     SB_AppendBuf (&L->Data, Buf, Len);
 
@@ -301,11 +318,12 @@ static void MoveLiterals (Collection* Source, Collection* Target)
         Literal* L = CollAt (Source, I);
 
         /* If it is referenced and not output, add it to the Target pool,
-        ** otherwise free it
+        ** otherwise free it. Literals in the emitted literal index must
+        ** stay alive, since later literals may get merged with them.
         */
         if (L->RefCount && !L->Output) {
             CollAppend (Target, L);
-        } else {
+        } else if (!L->Indexed) {
             FreeLiteral (L);
         }
     }
@@ -390,32 +408,49 @@ static void OutputReadOnlyLiterals (Collection* Literals)
         /* Translate the literal into the target charset */
         TranslateLiteral (L);
 
-        /* Check if this literal is part of another one. Since the literals
-        ** are sorted by size (larger ones first), it can only be part of a
-        ** literal with a smaller index.
-        ** Beware: Only check literals that have actually been referenced.
+        /* Hash the literal data */
+        L->Hash = HashBuf (&L->Data);
+
+        /* Check the emitted literal index for an exact duplicate first.
+        ** This catches the common case of the same string used all over
+        ** the place with one probe instead of a pairwise scan.
         */
         C = 0;
-        for (J = 0; J < I; ++J) {
+        for (C = LitHashTab[L->Hash & (LIT_HASH_SIZE - 1)]; C != 0; C = C->Next) {
+            if (C->Hash == L->Hash                          &&
+                SB_GetLen (&C->Data) == SB_GetLen (&L->Data) &&
+                memcmp (SB_GetConstBuf (&C->Data),
+                        SB_GetConstBuf (&L->Data),
+                        SB_GetLen (&L->Data)) == 0) {
+                break;
+            }
+        }
 
-            const void* D;
+        /* No duplicate. Check if the literal is the tail of an already
+        ** emitted one, which may also belong to another function.
+        */
+        if (C == 0) {
+            for (J = 0; J < CollCount (&EmittedLits); ++J) {
 
-            /* Get a pointer to the compare literal */
-            Literal* L2 = CollAt (Literals, J);
+                const void* D;
 
-            /* Ignore literals that have no reference */
-            if (L2->RefCount == 0) {
-                continue;
-            }
+                /* Get a pointer to the compare literal */
+                Literal* L2 = CollAt (&EmittedLits, J);
 
-            /* Get a pointer to the data */
-            D = SB_GetConstBuf (&L2->Data) + SB_GetLen (&L2->Data) - SB_GetLen (&L->Data);
+                /* The literal can only be part of a longer one */
+                if (SB_GetLen (&L2->Data) < SB_GetLen (&L->Data)) {
+                    continue;
+                }
 
-            /* Compare the data */
-            if (memcmp (D, SB_GetConstBuf (&L->Data), SB_GetLen (&L->Data)) == 0) {
-                /* Remember the literal and terminate the loop */
-                C = L2;
-                break;
+                /* Get a pointer to the data */
+                D = SB_GetConstBuf (&L2->Data) + SB_GetLen (&L2->Data) - SB_GetLen (&L->Data);
+
+                /* Compare the data */
+                if (memcmp (D, SB_GetConstBuf (&L->Data), SB_GetLen (&L->Data)) == 0) {
+                    /* Remember the literal and terminate the loop */
+                    C = L2;
+                    break;
+                }
             }
         }
 
@@ -433,6 +468,14 @@ static void OutputReadOnlyLiterals (Collection* Literals)
             /* Output the literal data */
             g_defbytes (SB_GetConstBuf (&L->Data), SB_GetLen (&L->Data));
 
+            /* Add the literal to the emitted literal index, so later
+            ** literals can share its storage.
+            */
+            L->Next = LitHashTab[L->Hash & (LIT_HASH_SIZE - 1)];
+            LitHashTab[L->Hash & (LIT_HASH_SIZE - 1)] = L;
+            L->Indexed = 1;
+            CollAppend (&EmittedLits, L);
+
         }
 
         /* Mark the literal */
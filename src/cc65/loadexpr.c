@@ -35,10 +35,12 @@
 
 /* cc65 */
 #include "codegen.h"
+#include "datatype.h"
 #include "error.h"
 #include "exprdesc.h"
 #include "global.h"
 #include "loadexpr.h"
+#include "symentry.h"
 
 
 
@@ -107,6 +109,24 @@ void LoadExpr (unsigned Flags, struct ExprDesc* Expr)
 ** unfortunately.
 */
 {
+    /* Elements of arrays with split lo/hi byte layout are read from the two
+    ** byte planes, using the element index that is in the primary register.
+    */
+    if (ED_IsSoa (Expr)) {
+        if ((Flags & CF_TYPEMASK) == 0) {
+            Flags |= TypeOf (Expr->Type);
+        }
+        if (ED_NeedsTest (Expr)) {
+            Flags |= CF_TEST;
+        }
+        g_soa_getind (Flags | CF_EXTERNAL, Expr->Name,
+                      (unsigned) GetElementCount (Expr->Sym->Type));
+
+        /* Expression was tested */
+        ED_TestDone (Expr);
+        return;
+    }
+
     if (!ED_IsAddrExpr (Expr)) {
 
         /* Lvalue. If this is a bit field its type is unsigned. But if the
@@ -207,7 +227,13 @@ void LoadExpr (unsigned Flags, struct ExprDesc* Expr)
         ED_TestDone (Expr);
 
     } else {
-        /* An address */
+        /* An address. An array with split lo/hi byte layout must not decay
+        ** into a pointer, since the elements are not stored in the layout a
+        ** pointer access would expect.
+        */
+        if (Expr->Sym != 0 && (Expr->Sym->Flags & SC_SOA) != 0) {
+            Error ("Cannot take address of an array with split layout");
+        }
         Flags |= CF_INT | CF_UNSIGNED;
         /* Constant of some sort, load it into the primary */
         LoadAddress (Flags, Expr);
@@ -454,6 +454,20 @@ static void ParseOneDecl (const DeclSpec* Spec)
         ** convert the declaration to "auto" if this is not possible.
         */
         int Reg = 0;    /* Initialize to avoid gcc complains */
+
+        /* If requested, try to use register storage for plain auto scalars
+        ** as if they had been declared 'register'. The usual register
+        ** variable restrictions apply, especially that the address of such
+        ** a variable cannot be taken, so this needs to be enabled
+        ** explicitly. Variables that don't get a register are handled as
+        ** ordinary auto variables below.
+        */
+        if (IS_Get (&EnableAutoRegVars)                 &&
+            (Decl.StorageClass & SC_AUTO) == SC_AUTO    &&
+            (IsClassInt (Decl.Type) || IsTypePtr (Decl.Type))) {
+            Decl.StorageClass = (Decl.StorageClass & ~SC_AUTO) | SC_REGISTER;
+        }
+
         if ((Decl.StorageClass & SC_REGISTER) != 0 &&
             (Reg = F_AllocRegVar (CurrentFunc, Decl.Type)) < 0) {
             /* No space for this register variable, convert to auto */
@@ -52,9 +52,14 @@
 
 
 
-/* The macro hash table */
-#define MACRO_TAB_SIZE  211
-static Macro* MacroTab[MACRO_TAB_SIZE];
+/* The macro hash table. The table is allocated on first use and grows with
+** the number of macros, so the chains stay short even if a project defines
+** many thousands of macros. The size is always a power of two.
+*/
+#define MACRO_TAB_INITIAL_SIZE  256U
+static Macro**  MacroTab     = 0;
+static unsigned MacroTabSize = 0;
+static unsigned MacroCount   = 0;
 
 
 
@@ -77,11 +82,14 @@ Macro* NewMacro (const char* Name)
 
     /* Initialize the data */
     M->Next        = 0;
+    M->Hash        = HashStr (Name);
     M->Expanding   = 0;
     M->ArgCount    = -1;        /* Flag: Not a function like macro */
     M->MaxArgs     = 0;
     InitCollection (&M->FormalArgs);
     SB_Init (&M->Replacement);
+    InitCollection (&M->Body);
+    M->BodyParsed  = 0;
     M->Variadic    = 0;
     memcpy (M->Name, Name, Len+1);
 
@@ -103,6 +111,12 @@ void FreeMacro (Macro* M)
     }
     DoneCollection (&M->FormalArgs);
     SB_Done (&M->Replacement);
+    for (I = 0; I < CollCount (&M->Body); ++I) {
+        MacroSeg* S = CollAtUnchecked (&M->Body, I);
+        SB_Done (&S->Text);
+        xfree (S);
+    }
+    DoneCollection (&M->Body);
     xfree (M);
 }
 
@@ -137,15 +151,53 @@ void DefineTextMacro (const char* Name, const char* Val)
 
 
 
+static void GrowMacroTab (void)
+/* Allocate the macro table or double its size */
+{
+    Macro**  NewTab;
+    unsigned NewSize;
+    unsigned I;
+
+    /* Get the new size and allocate a cleared table */
+    NewSize = (MacroTabSize == 0)? MACRO_TAB_INITIAL_SIZE : MacroTabSize * 2;
+    NewTab  = xmalloc (NewSize * sizeof (Macro*));
+    memset (NewTab, 0, NewSize * sizeof (Macro*));
+
+    /* Move the existing macros over into the new table */
+    for (I = 0; I < MacroTabSize; ++I) {
+        Macro* M = MacroTab[I];
+        while (M) {
+            Macro*   Next = M->Next;
+            unsigned Slot = M->Hash & (NewSize - 1);
+            M->Next       = NewTab[Slot];
+            NewTab[Slot]  = M;
+            M = Next;
+        }
+    }
+
+    /* Replace the old table */
+    xfree (MacroTab);
+    MacroTab     = NewTab;
+    MacroTabSize = NewSize;
+}
+
+
+
 void InsertMacro (Macro* M)
 /* Insert the given macro into the macro table. */
 {
-    /* Get the hash value of the macro name */
-    unsigned Hash = HashStr (M->Name) % MACRO_TAB_SIZE;
+    unsigned Slot;
+
+    /* Grow the table if the load gets too high */
+    if (MacroCount >= MacroTabSize) {
+        GrowMacroTab ();
+    }
 
     /* Insert the macro */
-    M->Next = MacroTab[Hash];
-    MacroTab[Hash] = M;
+    Slot = M->Hash & (MacroTabSize - 1);
+    M->Next = MacroTab[Slot];
+    MacroTab[Slot] = M;
+    ++MacroCount;
 }
 
 
@@ -157,24 +209,34 @@ int UndefineMacro (const char* Name)
 */
 {
     /* Get the hash value of the macro name */
-    unsigned Hash = HashStr (Name) % MACRO_TAB_SIZE;
+    unsigned Hash = HashStr (Name);
+    unsigned Slot;
+    Macro*   L;
+    Macro*   M;
+
+    /* Bail out early if there are no macros at all */
+    if (MacroCount == 0) {
+        return 0;
+    }
 
     /* Search the hash chain */
-    Macro* L = 0;
-    Macro* M = MacroTab[Hash];
+    Slot = Hash & (MacroTabSize - 1);
+    L = 0;
+    M = MacroTab[Slot];
     while (M) {
-        if (strcmp (M->Name, Name) == 0) {
+        if (M->Hash == Hash && strcmp (M->Name, Name) == 0) {
 
             /* Found it */
             if (L == 0) {
                 /* First in chain */
-                MacroTab[Hash] = M->Next;
+                MacroTab[Slot] = M->Next;
             } else {
                 L->Next = M->Next;
             }
 
             /* Delete the macro */
             FreeMacro (M);
+            --MacroCount;
 
             /* Done */
             return 1;
@@ -194,13 +256,23 @@ int UndefineMacro (const char* Name)
 Macro* FindMacro (const char* Name)
 /* Find a macro with the given name. Return the macro definition or NULL */
 {
+    unsigned Hash;
+    Macro*   M;
+
+    /* Bail out early if there are no macros at all */
+    if (MacroCount == 0) {
+        return 0;
+    }
+
     /* Get the hash value of the macro name */
-    unsigned Hash = HashStr (Name) % MACRO_TAB_SIZE;
+    Hash = HashStr (Name);
 
-    /* Search the hash chain */
-    Macro* M = MacroTab[Hash];
+    /* Search the hash chain. Comparing the full hash values first makes the
+    ** string comparison a rare event even for names that share a slot.
+    */
+    M = MacroTab[Hash & (MacroTabSize - 1)];
     while (M) {
-        if (strcmp (M->Name, Name) == 0) {
+        if (M->Hash == Hash && strcmp (M->Name, Name) == 0) {
             /* Found it */
             return M;
         }
@@ -257,6 +329,25 @@ void AddMacroArg (Macro* M, const char* Arg)
 
 
 
+MacroSeg* AddMacroSeg (Macro* M, unsigned char Type, unsigned Arg)
+/* Append a segment of the given type to the pre-parsed replacement list of
+** the macro and return it.
+*/
+{
+    /* Allocate and initialize a new segment */
+    MacroSeg* S = xmalloc (sizeof (MacroSeg));
+    S->Type     = Type;
+    S->AddSpace = 0;
+    S->Arg      = Arg;
+    SB_Init (&S->Text);
+
+    /* Add it to the list and return it */
+    CollAppend (&M->Body, S);
+    return S;
+}
+
+
+
 int MacroCmp (const Macro* M1, const Macro* M2)
 /* Compare two macros and return zero if both are identical. */
 {
@@ -288,7 +379,7 @@ void PrintMacroStats (FILE* F)
     Macro* M;
 
     fprintf (F, "\n\nMacro Hash Table Summary\n");
-    for (I = 0; I < MACRO_TAB_SIZE; ++I) {
+    for (I = 0; I < MacroTabSize; ++I) {
         fprintf (F, "%3u : ", I);
         M = MacroTab [I];
         if (M) {
@@ -51,15 +51,41 @@
 
 
 
+/* Segment types of a pre-parsed macro replacement list */
+enum {
+    MS_TEXT,                    /* Literal text, copied verbatim */
+    MS_ARG,                     /* Argument, macro replaced when inserted */
+    MS_RAWARG,                  /* Argument inserted as is (## operand) */
+    MS_STRARG,                  /* Argument converted to a string (# operand) */
+    MS_PASTE                    /* ## operator */
+};
+
+/* Segment of a pre-parsed macro replacement list. The replacement text of a
+** macro is scanned just once, when the macro is expanded for the first time,
+** and stored as a list of segments with the argument references resolved to
+** indices. Later expansions splice the actual arguments between the literal
+** parts instead of re-scanning the text.
+*/
+typedef struct MacroSeg MacroSeg;
+struct MacroSeg {
+    unsigned char Type;         /* Segment type (MS_xxx) */
+    unsigned char AddSpace;     /* Append a space after insertion */
+    unsigned      Arg;          /* Argument index for the argument types */
+    StrBuf        Text;         /* Literal text for MS_TEXT */
+};
+
 /* Structure describing a macro */
 typedef struct Macro Macro;
 struct Macro {
     Macro*        Next;         /* Next macro with same hash value */
+    unsigned      Hash;         /* Hash value of the name */
     int           Expanding;    /* Are we currently expanding this macro? */
     int           ArgCount;     /* Number of parameters, -1 = no parens */
     unsigned      MaxArgs;      /* Size of formal argument list */
     Collection    FormalArgs;   /* Formal argument list (char*) */
     StrBuf        Replacement;  /* Replacement text */
+    Collection    Body;         /* Pre-parsed replacement (MacroSeg) */
+    unsigned char BodyParsed;   /* True if Body is valid */
     unsigned char Variadic;     /* C99 variadic macro */
     char          Name[1];      /* Name, dynamically allocated */
 };
@@ -118,6 +144,11 @@ int FindMacroArg (Macro* M, const char* Arg);
 void AddMacroArg (Macro* M, const char* Arg);
 /* Add a formal macro argument. */
 
+MacroSeg* AddMacroSeg (Macro* M, unsigned char Type, unsigned Arg);
+/* Append a segment of the given type to the pre-parsed replacement list of
+** the macro and return it.
+*/
+
 int MacroCmp (const Macro* M1, const Macro* M2);
 /* Compare two macros and return zero if both are identical. */
 
@@ -37,6 +37,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <time.h>
 
 /* common */
 #include "abend.h"
@@ -44,6 +45,7 @@
 #include "cmdline.h"
 #include "cpu.h"
 #include "debugflag.h"
+#include "diagfile.h"
 #include "fname.h"
 #include "mmodel.h"
 #include "print.h"
@@ -56,6 +58,7 @@
 
 /* cc65 */
 #include "asmcode.h"
+#include "cache.h"
 #include "compile.h"
 #include "codeopt.h"
 #include "error.h"
@@ -103,9 +106,12 @@ static void Usage (void)
             "  -v\t\t\t\tIncrease verbosity\n"
             "\n"
             "Long options:\n"
+            "  --add-cycles\t\t\tInclude size/cycle estimates as comments\n"
             "  --add-source\t\t\tInclude source as comment\n"
             "  --all-cdecl\t\t\tMake functions default to __cdecl__\n"
+            "  --auto-register-vars\t\tMake plain locals register variables\n"
             "  --bss-name seg\t\tSet the name of the BSS segment\n"
+            "  --cache dir\t\t\tUse dir as a compilation cache\n"
             "  --check-stack\t\t\tGenerate stack overflow checks\n"
             "  --code-name seg\t\tSet the name of the CODE segment\n"
             "  --codesize x\t\t\tAccept larger code by factor x\n"
@@ -118,6 +124,7 @@ static void Usage (void)
             "  --debug-opt name\t\tDebug optimization steps\n"
             "  --debug-opt-output\t\tDebug output of each optimization step\n"
             "  --dep-target target\t\tUse this dependency target\n"
+            "  --diagnostics name\t\tWrite machine readable diagnostics to a file\n"
             "  --disable-opt name\t\tDisable an optimization step\n"
             "  --eagerly-inline-funcs\tEagerly inline some known functions\n"
             "  --enable-opt name\t\tEnable an optimization step\n"
@@ -128,13 +135,16 @@ static void Usage (void)
             "  --list-warnings\t\tList available warning types for -W\n"
             "  --local-strings\t\tEmit string literals immediately\n"
             "  --memory-model model\t\tSet the memory model\n"
+            "  --opt-profile file\t\tUse an execution profile to guide the optimizer\n"
             "  --register-space b\t\tSet space available for register variables\n"
             "  --register-vars\t\tEnable register variables\n"
             "  --rodata-name seg\t\tSet the name of the RODATA segment\n"
             "  --signed-chars\t\tDefault characters are signed\n"
+            "  --stack-usage\t\t\tEmit stack usage annotations\n"
             "  --standard std\t\tLanguage standard (c89, c99, cc65)\n"
             "  --static-locals\t\tMake local variables static\n"
             "  --target sys\t\t\tSet the target system\n"
+            "  --time-passes\t\t\tReport per-phase and per-pass timing\n"
             "  --verbose\t\t\tIncrease verbosity\n"
             "  --version\t\t\tPrint the compiler version number\n"
             "  --writable-strings\t\tMake string literals writable\n",
@@ -373,6 +383,15 @@ static void CheckSegName (const char* Seg)
 
 
 
+static void OptAddCycles (const char* Opt attribute ((unused)),
+                          const char* Arg attribute ((unused)))
+/* Add size and cycle estimates as comments in generated assembler file */
+{
+    AddCycles = 1;
+}
+
+
+
 static void OptAddSource (const char* Opt attribute ((unused)),
                           const char* Arg attribute ((unused)))
 /* Add source lines as comments in generated assembler file */
@@ -391,6 +410,16 @@ static void OptAllCDecl (const char* Opt attribute ((unused)),
 
 
 
+static void OptAutoRegVars (const char* Opt attribute ((unused)),
+                            const char* Arg attribute ((unused)))
+/* Handle the --auto-register-vars option */
+{
+    IS_Set (&EnableAutoRegVars, 1);
+    IS_Set (&EnableRegVars, 1);
+}
+
+
+
 static void OptBssName (const char* Opt attribute ((unused)), const char* Arg)
 /* Handle the --bss-name option */
 {
@@ -403,6 +432,14 @@ static void OptBssName (const char* Opt attribute ((unused)), const char* Arg)
 
 
 
+static void OptCache (const char* Opt attribute ((unused)), const char* Arg)
+/* Handle the --cache option */
+{
+    CacheDir = Arg;
+}
+
+
+
 static void OptCheckStack (const char* Opt attribute ((unused)),
                            const char* Arg attribute ((unused)))
 /* Handle the --check-stack option */
@@ -584,6 +621,14 @@ static void OptDepTarget (const char* Opt attribute ((unused)), const char* Arg)
 
 
 
+static void OptDiagnostics (const char* Opt attribute ((unused)), const char* Arg)
+/* Handle the --diagnostics option */
+{
+    SetDiagnosticFile (Arg);
+}
+
+
+
 static void OptDisableOpt (const char* Opt attribute ((unused)), const char* Arg)
 /* Disable an optimization step */
 {
@@ -673,6 +718,15 @@ static void OptLocalStrings (const char* Opt attribute ((unused)),
 
 
 
+static void OptOptProfile (const char* Opt attribute ((unused)),
+                           const char* Arg)
+/* Use an execution profile to guide the optimizer */
+{
+    ReadOptProfile (Arg);
+}
+
+
+
 static void OptMemoryModel (const char* Opt, const char* Arg)
 /* Set the memory model */
 {
@@ -738,6 +792,15 @@ static void OptSignedChars (const char* Opt attribute ((unused)),
 
 
 
+static void OptStackUsage (const char* Opt attribute ((unused)),
+                           const char* Arg attribute ((unused)))
+/* Emit stack usage annotations for the linker stack depth check */
+{
+    StackUsage = 1;
+}
+
+
+
 static void OptStandard (const char* Opt, const char* Arg)
 /* Handle the --standard option */
 {
@@ -763,6 +826,15 @@ static void OptStaticLocals (const char* Opt attribute ((unused)),
 
 
 
+static void OptTimePasses (const char* Opt attribute ((unused)),
+                           const char* Arg attribute ((unused)))
+/* Report per-phase and per-pass timing */
+{
+    TimePasses = 1;
+}
+
+
+
 static void OptTarget (const char* Opt attribute ((unused)), const char* Arg)
 /* Set the target system */
 {
@@ -849,9 +921,12 @@ int main (int argc, char* argv[])
 {
     /* Program long options */
     static const LongOpt OptTab[] = {
+        { "--add-cycles",           0,      OptAddCycles            },
         { "--add-source",           0,      OptAddSource            },
         { "--all-cdecl",            0,      OptAllCDecl             },
+        { "--auto-register-vars",   0,      OptAutoRegVars          },
         { "--bss-name",             1,      OptBssName              },
+        { "--cache",                1,      OptCache                },
         { "--check-stack",          0,      OptCheckStack           },
         { "--code-name",            1,      OptCodeName             },
         { "--codesize",             1,      OptCodeSize             },
@@ -864,6 +939,7 @@ int main (int argc, char* argv[])
         { "--debug-opt",            1,      OptDebugOpt             },
         { "--debug-opt-output",     0,      OptDebugOptOutput       },
         { "--dep-target",           1,      OptDepTarget            },
+        { "--diagnostics",          1,      OptDiagnostics          },
         { "--disable-opt",          1,      OptDisableOpt           },
         { "--eagerly-inline-funcs", 0,      OptEagerlyInlineFuncs   },
         { "--enable-opt",           1,      OptEnableOpt            },
@@ -874,19 +950,23 @@ int main (int argc, char* argv[])
         { "--list-warnings",        0,      OptListWarnings         },
         { "--local-strings",        0,      OptLocalStrings         },
         { "--memory-model",         1,      OptMemoryModel          },
+        { "--opt-profile",          1,      OptOptProfile           },
         { "--register-space",       1,      OptRegisterSpace        },
         { "--register-vars",        0,      OptRegisterVars         },
         { "--rodata-name",          1,      OptRodataName           },
         { "--signed-chars",         0,      OptSignedChars          },
+        { "--stack-usage",          0,      OptStackUsage           },
         { "--standard",             1,      OptStandard             },
         { "--static-locals",        0,      OptStaticLocals         },
         { "--target",               1,      OptTarget               },
+        { "--time-passes",          0,      OptTimePasses           },
         { "--verbose",              0,      OptVerbose              },
         { "--version",              0,      OptVersion              },
         { "--writable-strings",     0,      OptWritableStrings      },
     };
 
     unsigned I;
+    clock_t Start;
 
     /* Initialize the input file name */
     const char* InputFile  = 0;
@@ -1060,6 +1140,19 @@ int main (int argc, char* argv[])
         IS_Set (&Standard, STD_DEFAULT);
     }
 
+    /* If a compilation cache was given, check if the output for unchanged
+    ** input is already known. Dependency file generation is skipped on a
+    ** cache hit, so the cache stays out of the way when it is requested.
+    */
+    if (CacheDir != 0 && PreprocessOnly == 0 &&
+        SB_GetLen (&DepName) == 0 && SB_GetLen (&FullDepName) == 0) {
+        CacheSetKey (InputFile);
+        if (CacheLookup ()) {
+            Print (stdout, 1, "Wrote output to '%s'\n", OutputFilename);
+            return EXIT_SUCCESS;
+        }
+    }
+
     /* Go! */
     Compile (InputFile);
 
@@ -1073,14 +1166,27 @@ int main (int argc, char* argv[])
         OpenOutputFile ();
 
         /* Write the output to the file */
+        Start = clock ();
         WriteAsmOutput ();
         Print (stdout, 1, "Wrote output to '%s'\n", OutputFilename);
 
         /* Close the file, check for errors */
         CloseOutputFile ();
 
+        /* Report the timing statistics if requested */
+        if (TimePasses) {
+            PrintPhaseTime ("output", clock () - Start);
+            xmemreport (stderr, "output");
+            PrintOptTimings (stderr);
+        }
+
         /* Create dependencies if requested */
         CreateDependencies ();
+
+        /* Store the output in the compilation cache */
+        if (ErrorCount == 0) {
+            CacheStore ();
+        }
     }
 
     /* Return an apropriate exit code */
@@ -579,6 +579,13 @@ const OPCDesc OPCTable[OP65_COUNT] = {
         REG_NONE,                               /* chg */
         OF_XFR                                  /* flags */
     },
+    {   OP65_TXY,                               /* opcode */
+        "txy",                                  /* mnemonic */
+        1,                                      /* size */
+        REG_X,                                  /* use */
+        REG_Y,                                  /* chg */
+        OF_XFR | OF_SETF                        /* flags */
+    },
     {   OP65_TYA,                               /* opcode */
         "tya",                                  /* mnemonic */
         1,                                      /* size */
@@ -586,6 +593,13 @@ const OPCDesc OPCTable[OP65_COUNT] = {
         REG_A,                                  /* chg */
         OF_XFR | OF_SETF                        /* flags */
     },
+    {   OP65_TYX,                               /* opcode */
+        "tyx",                                  /* mnemonic */
+        1,                                      /* size */
+        REG_Y,                                  /* use */
+        REG_X,                                  /* chg */
+        OF_XFR | OF_SETF                        /* flags */
+    },
 };
 
 
@@ -663,6 +677,115 @@ unsigned GetInsnSize (opc_t OPC, am_t AM)
 
 
 
+unsigned GetInsnCycles (opc_t OPC, am_t AM)
+/* Return an estimate of the execution cycles for the given instruction.
+** The estimate assumes no page crossing and taken branches; long branches
+** are counted as a taken short branch plus a jump.
+*/
+{
+    switch (OPC) {
+
+        /* Stack operations */
+        case OP65_PHA:
+        case OP65_PHP:
+        case OP65_PHX:
+        case OP65_PHY:
+            return 3;
+        case OP65_PLA:
+        case OP65_PLP:
+        case OP65_PLX:
+        case OP65_PLY:
+            return 4;
+
+        /* Control flow */
+        case OP65_BRK:
+            return 7;
+        case OP65_JSR:
+            return 6;
+        case OP65_RTS:
+        case OP65_RTI:
+            return 6;
+        case OP65_JMP:
+            return (AM == AM65_ABS)? 3 : 5;
+        case OP65_BRA:
+        case OP65_BCC:
+        case OP65_BCS:
+        case OP65_BEQ:
+        case OP65_BMI:
+        case OP65_BNE:
+        case OP65_BPL:
+        case OP65_BVC:
+        case OP65_BVS:
+            return 3;
+        case OP65_JCC:
+        case OP65_JCS:
+        case OP65_JEQ:
+        case OP65_JMI:
+        case OP65_JNE:
+        case OP65_JPL:
+        case OP65_JVC:
+        case OP65_JVS:
+            return 4;
+
+        /* Read/modify/write operations */
+        case OP65_ASL:
+        case OP65_LSR:
+        case OP65_ROL:
+        case OP65_ROR:
+        case OP65_INC:
+        case OP65_DEC:
+        case OP65_TRB:
+        case OP65_TSB:
+            switch (AM) {
+                case AM65_IMP:
+                case AM65_ACC:     return 2;
+                case AM65_ZP:      return 5;
+                case AM65_ZPX:     return 6;
+                case AM65_ABS:     return 6;
+                case AM65_ABSX:    return 7;
+                default:           return 6;
+            }
+
+        /* Stores */
+        case OP65_STA:
+        case OP65_STX:
+        case OP65_STY:
+        case OP65_STZ:
+            switch (AM) {
+                case AM65_ZP:      return 3;
+                case AM65_ZPX:
+                case AM65_ZPY:
+                case AM65_ABS:     return 4;
+                case AM65_ABSX:
+                case AM65_ABSY:
+                case AM65_ZP_IND:  return 5;
+                case AM65_ZPX_IND:
+                case AM65_ZP_INDY: return 6;
+                default:           return 4;
+            }
+
+        /* All other operations: loads, ALU and implied instructions */
+        default:
+            switch (AM) {
+                case AM65_IMP:
+                case AM65_ACC:
+                case AM65_IMM:     return 2;
+                case AM65_ZP:      return 3;
+                case AM65_ZPX:
+                case AM65_ZPY:
+                case AM65_ABS:
+                case AM65_ABSX:
+                case AM65_ABSY:    return 4;
+                case AM65_ZP_IND:
+                case AM65_ZP_INDY: return 5;
+                case AM65_ZPX_IND: return 6;
+                default:           return 2;
+            }
+    }
+}
+
+
+
 unsigned char GetAMUseInfo (am_t AM)
 /* Get usage info for the given addressing mode (addressing modes that use
 ** index registers return REG_r info for these registers).
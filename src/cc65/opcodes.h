@@ -125,7 +125,9 @@ typedef enum {
     OP65_TSX,
     OP65_TXA,
     OP65_TXS,
+    OP65_TXY,                   /* 65816 */
     OP65_TYA,
+    OP65_TYX,                   /* 65816 */
 
     /* Number of opcodes available */
     OP65_COUNT
@@ -210,6 +212,12 @@ const OPCDesc* FindOP65 (const char* OPC);
 unsigned GetInsnSize (opc_t OPC, am_t AM);
 /* Return the size of the given instruction */
 
+unsigned GetInsnCycles (opc_t OPC, am_t AM);
+/* Return an estimate of the execution cycles for the given instruction.
+** The estimate assumes no page crossing and taken branches; long branches
+** are counted as a taken short branch plus a jump.
+*/
+
 #if defined(HAVE_INLINE)
 INLINE const OPCDesc* GetOPCDesc (opc_t OPC)
 /* Get an opcode description */
@@ -42,6 +42,7 @@
 #include "check.h"
 #include "fname.h"
 #include "print.h"
+#include "strbuf.h"
 #include "xmalloc.h"
 
 /* cc65 */
@@ -63,6 +64,18 @@ const char* OutputFilename = 0;
 /* Output file handle */
 FILE* OutputFile = 0;
 
+/* Buffer for the output. Text written by WriteOutput is collected here and
+** flushed to the file in large blocks, which is a lot cheaper than one
+** fprintf call per output line.
+*/
+static StrBuf OutputBuf = STATIC_STRBUF_INITIALIZER;
+
+/* Scratch buffer used to format the arguments of WriteOutput */
+static StrBuf FormatBuf = STATIC_STRBUF_INITIALIZER;
+
+/* Flush the output buffer when it has grown to this size */
+#define OUTPUT_BUF_LIMIT        0x10000U
+
 
 
 /*****************************************************************************/
@@ -133,6 +146,9 @@ void CloseOutputFile ()
     /* Output file must be open */
     PRECONDITION (OutputFile != 0);
 
+    /* Write any remaining buffered output */
+    FlushOutput ();
+
     /* Close the file, check for errors */
     if (fclose (OutputFile) != 0) {
         remove (OutputFilename);
@@ -145,22 +161,75 @@ void CloseOutputFile ()
 
 
 
+void FlushOutput (void)
+/* Write buffered output to the output file. Must be called before accessing
+** OutputFile directly.
+*/
+{
+    /* Output file must be open */
+    PRECONDITION (OutputFile != 0);
+
+    /* Write the buffer contents if there are any */
+    if (SB_NotEmpty (&OutputBuf)) {
+        unsigned Len = SB_GetLen (&OutputBuf);
+        if (fwrite (SB_GetConstBuf (&OutputBuf), 1, Len, OutputFile) != Len) {
+            remove (OutputFilename);
+            Fatal ("Cannot write to output file (disk full?)");
+        }
+        SB_Clear (&OutputBuf);
+    }
+}
+
+
+
 int WriteOutput (const char* Format, ...)
 /* Write to the output file using printf like formatting. Returns the number
 ** of chars written.
 */
 {
     va_list ap;
-    int CharCount;
 
     /* Must have an output file */
     PRECONDITION (OutputFile != 0);
 
-    /* Output formatted */
+    /* Format into the scratch buffer, then append that to the output
+    ** buffer. SB_VPrintf replaces the contents of its target, so we cannot
+    ** format into the output buffer directly.
+    */
     va_start (ap, Format);
-    CharCount = vfprintf (OutputFile, Format, ap);
+    SB_VPrintf (&FormatBuf, Format, ap);
     va_end (ap);
+    SB_Append (&OutputBuf, &FormatBuf);
+
+    /* Flush the buffer if it has grown large enough */
+    if (SB_GetLen (&OutputBuf) >= OUTPUT_BUF_LIMIT) {
+        FlushOutput ();
+    }
+
+    /* Return the number of chars written */
+    return (int) SB_GetLen (&FormatBuf);
+}
+
+
+
+int WriteOutputStr (const char* S)
+/* Write a plain string to the output file, avoiding the formatting overhead
+** of WriteOutput. Returns the number of chars written.
+*/
+{
+    size_t Len = strlen (S);
+
+    /* Must have an output file */
+    PRECONDITION (OutputFile != 0);
+
+    /* Copy the string into the output buffer */
+    SB_AppendBuf (&OutputBuf, S, Len);
+
+    /* Flush the buffer if it has grown large enough */
+    if (SB_GetLen (&OutputBuf) >= OUTPUT_BUF_LIMIT) {
+        FlushOutput ();
+    }
 
     /* Return the number of chars written */
-    return CharCount;
+    return (int) Len;
 }
@@ -54,7 +54,9 @@
 /* Name of the output file. Dynamically allocated and read only. */
 extern const char* OutputFilename;
 
-/* Output file handle. Use WriteOutput if possible. Read only. */
+/* Output file handle. Use WriteOutput if possible and call FlushOutput
+** before writing to the handle directly. Read only.
+*/
 extern FILE* OutputFile;
 
 
@@ -84,11 +86,21 @@ void OpenDebugOutputFile (const char* Name);
 void CloseOutputFile ();
 /* Close the output file. Will call Fatal() in case of failures. */
 
+void FlushOutput (void);
+/* Write buffered output to the output file. Must be called before accessing
+** OutputFile directly.
+*/
+
 int WriteOutput (const char* Format, ...) attribute ((format (printf, 1, 2)));
 /* Write to the output file using printf like formatting. Returns the number
 ** of chars written.
 */
 
+int WriteOutputStr (const char* S);
+/* Write a plain string to the output file, avoiding the formatting overhead
+** of WriteOutput. Returns the number of chars written.
+*/
+
 
 /* End of output.h */
 
@@ -66,6 +66,7 @@ typedef enum {
     PRAGMA_ILLEGAL = -1,
     PRAGMA_ALIGN,
     PRAGMA_ALLOW_EAGER_INLINE,
+    PRAGMA_AUTO_REGISTER_VARS,
     PRAGMA_BSS_NAME,
     PRAGMA_BSSSEG,                                      /* obsolete */
     PRAGMA_CHARMAP,
@@ -79,6 +80,7 @@ typedef enum {
     PRAGMA_INLINE_STDFUNCS,
     PRAGMA_LOCAL_STRINGS,
     PRAGMA_MESSAGE,
+    PRAGMA_OPT_SCHEDULE,
     PRAGMA_OPTIMIZE,
     PRAGMA_REGISTER_VARS,
     PRAGMA_REGVARADDR,
@@ -87,6 +89,7 @@ typedef enum {
     PRAGMA_RODATASEG,                                   /* obsolete */
     PRAGMA_SIGNED_CHARS,
     PRAGMA_SIGNEDCHARS,                                 /* obsolete */
+    PRAGMA_SOA,
     PRAGMA_STATIC_LOCALS,
     PRAGMA_STATICLOCALS,                                /* obsolete */
     PRAGMA_WARN,
@@ -103,6 +106,7 @@ static const struct Pragma {
 } Pragmas[PRAGMA_COUNT] = {
     { "align",                  PRAGMA_ALIGN              },
     { "allow-eager-inline",     PRAGMA_ALLOW_EAGER_INLINE },
+    { "auto-register-vars",     PRAGMA_AUTO_REGISTER_VARS },
     { "bss-name",               PRAGMA_BSS_NAME           },
     { "bssseg",                 PRAGMA_BSSSEG             },      /* obsolete */
     { "charmap",                PRAGMA_CHARMAP            },
@@ -116,6 +120,7 @@ static const struct Pragma {
     { "inline-stdfuncs",        PRAGMA_INLINE_STDFUNCS    },
     { "local-strings",          PRAGMA_LOCAL_STRINGS      },
     { "message",                PRAGMA_MESSAGE            },
+    { "opt-schedule",           PRAGMA_OPT_SCHEDULE       },
     { "optimize",               PRAGMA_OPTIMIZE           },
     { "register-vars",          PRAGMA_REGISTER_VARS      },
     { "regvaraddr",             PRAGMA_REGVARADDR         },
@@ -124,6 +129,7 @@ static const struct Pragma {
     { "rodataseg",              PRAGMA_RODATASEG          },      /* obsolete */
     { "signed-chars",           PRAGMA_SIGNED_CHARS       },
     { "signedchars",            PRAGMA_SIGNEDCHARS        },      /* obsolete */
+    { "soa",                    PRAGMA_SOA                },
     { "static-locals",          PRAGMA_STATIC_LOCALS      },
     { "staticlocals",           PRAGMA_STATICLOCALS       },      /* obsolete */
     { "warn",                   PRAGMA_WARN               },
@@ -700,6 +706,59 @@ ExitPoint:
 
 
 
+static void SchedPragma (StrBuf* B, IntStack* Stack)
+/* Handle the "opt-schedule" pragma that expects a schedule name */
+{
+    StrBuf Ident = AUTO_STRBUF_INITIALIZER;
+    long   Val;
+    int    Push;
+
+
+    /* Try to read an identifier */
+    int IsIdent = SB_GetSym (B, &Ident, 0);
+
+    /* Check if we have a first argument named "pop" */
+    if (IsIdent && SB_CompareStr (&Ident, "pop") == 0) {
+        PopInt (Stack);
+        /* No other arguments allowed */
+        return;
+    }
+
+    /* Check if we have a first argument named "push" */
+    if (IsIdent && SB_CompareStr (&Ident, "push") == 0) {
+        Push = 1;
+        if (!GetComma (B)) {
+            goto ExitPoint;
+        }
+        IsIdent = SB_GetSym (B, &Ident, 0);
+    } else {
+        Push = 0;
+    }
+
+    /* Schedule name follows */
+    if (IsIdent && SB_CompareStr (&Ident, "full") == 0) {
+        Val = OPT_SCHED_FULL;
+    } else if (IsIdent && SB_CompareStr (&Ident, "cold") == 0) {
+        Val = OPT_SCHED_COLD;
+    } else {
+        Error ("Pragma argument must be one of 'full' or 'cold'");
+        goto ExitPoint;
+    }
+
+    /* Set/push the new value */
+    if (Push) {
+        PushInt (Stack, Val);
+    } else {
+        IS_Set (Stack, Val);
+    }
+
+ExitPoint:
+    /* Free the identifier */
+    SB_Done (&Ident);
+}
+
+
+
 static void IntPragma (StrBuf* B, IntStack* Stack, long Low, long High)
 /* Handle a pragma that expects an int paramater */
 {
@@ -814,6 +873,10 @@ static void ParsePragma (void)
             FlagPragma (&B, &EagerlyInlineFuncs);
             break;
 
+        case PRAGMA_AUTO_REGISTER_VARS:
+            FlagPragma (&B, &EnableAutoRegVars);
+            break;
+
         case PRAGMA_BSSSEG:
             Warning ("#pragma bssseg is obsolete, please use #pragma bss-name instead");
             /* FALLTHROUGH */
@@ -862,6 +925,10 @@ static void ParsePragma (void)
             StringPragma (&B, MakeMessage);
             break;
 
+        case PRAGMA_OPT_SCHEDULE:
+            SchedPragma (&B, &OptSchedule);
+            break;
+
         case PRAGMA_OPTIMIZE:
             FlagPragma (&B, &Optimize);
             break;
@@ -891,6 +958,10 @@ static void ParsePragma (void)
             FlagPragma (&B, &SignedChars);
             break;
 
+        case PRAGMA_SOA:
+            FlagPragma (&B, &SoaLayout);
+            break;
+
         case PRAGMA_STATICLOCALS:
             Warning ("#pragma staticlocals is obsolete, please use #pragma static-locals instead");
             /* FALLTHROUGH */
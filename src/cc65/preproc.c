@@ -393,6 +393,59 @@ static void CopyQuotedString (StrBuf* Target)
 
 
 
+/* Table of characters the preprocessor passes through without special
+** handling: no whitespace, no identifier start, no quotes and no comment
+** introducing slash. Used to copy whole spans of such characters at once
+** instead of char by char. The table is set up on first use.
+*/
+static unsigned char PlainChar[256];
+static int PlainCharValid = 0;
+
+
+
+static void InitPlainChar (void)
+/* Set up the table of plain characters */
+{
+    unsigned I;
+    for (I = 1; I < 256; ++I) {
+        char C = (char) I;
+        PlainChar[I] = !IsSpace (C) && !IsIdent (C) && !IsQuote (C) && C != '/';
+    }
+    PlainCharValid = 1;
+}
+
+
+
+static void CopyPlainSpan (StrBuf* Target)
+/* Copy the current character plus any directly following plain characters
+** from the input line to Target in one piece.
+*/
+{
+    unsigned Start = SB_GetIndex (Line);
+    unsigned Len   = SB_GetLen (Line);
+    unsigned I     = Start + 1;
+
+    if (!PlainCharValid) {
+        InitPlainChar ();
+    }
+
+    /* Find the end of the span */
+    while (I < Len && PlainChar[(unsigned char) SB_AtUnchecked (Line, I)]) {
+        ++I;
+    }
+
+    /* Copy the span in one piece */
+    SB_AppendBuf (Target, SB_GetConstBuf (Line) + Start, I - Start);
+
+    /* Move the input to the last character of the span and skip it the
+    ** regular way, so CurC and NextC are maintained correctly.
+    */
+    SB_SetIndex (Line, I - 1);
+    NextChar ();
+}
+
+
+
 /*****************************************************************************/
 /*                                Macro stuff                                */
 /*****************************************************************************/
@@ -508,63 +561,76 @@ static void ReadMacroArgs (MacroExp* E)
 
 
 
-static void MacroArgSubst (MacroExp* E)
-/* Argument substitution according to ISO/IEC 9899:1999 (E), 6.10.3.1ff */
+static StrBuf* MacroSegText (Macro* M)
+/* Return the literal text buffer of the last body segment of the macro.
+** A new MS_TEXT segment is added if the last one has another type.
+*/
+{
+    MacroSeg* S = 0;
+    if (CollCount (&M->Body) > 0) {
+        S = CollLast (&M->Body);
+    }
+    if (S == 0 || S->Type != MS_TEXT) {
+        S = AddMacroSeg (M, MS_TEXT, 0);
+    }
+    return &S->Text;
+}
+
+
+
+static void ParseMacroBody (Macro* M)
+/* Scan the replacement text of the macro and build the pre-parsed segment
+** list with all argument references resolved to indices. This is done just
+** once, when the macro is expanded for the first time. Later expansions
+** splice the actual arguments between the literal parts in MacroArgSubst
+** without re-scanning the text.
+*/
 {
     ident       Ident;
     int         ArgIdx;
     StrBuf*     OldSource;
-    StrBuf*     Arg;
     int         HaveSpace;
-
+    MacroSeg*   S;
 
     /* Remember the current input and switch to the macro replacement. */
-    int OldIndex = SB_GetIndex (&E->M->Replacement);
-    SB_Reset (&E->M->Replacement);
-    OldSource = InitLine (&E->M->Replacement);
+    int OldIndex = SB_GetIndex (&M->Replacement);
+    SB_Reset (&M->Replacement);
+    OldSource = InitLine (&M->Replacement);
 
-    /* Argument handling loop */
+    /* Scan the replacement text */
     while (CurC != '\0') {
 
-        /* If we have an identifier, check if it's a macro */
+        /* If we have an identifier, check if it's a macro argument */
         if (IsSym (Ident)) {
 
             /* Check if it's a macro argument */
-            if ((ArgIdx = FindMacroArg (E->M, Ident)) >= 0) {
-
-                /* A macro argument. Get the corresponding actual argument. */
-                Arg = ME_GetActual (E, ArgIdx);
+            if ((ArgIdx = FindMacroArg (M, Ident)) >= 0) {
 
-                /* Copy any following whitespace */
+                /* Skip any following whitespace */
                 HaveSpace = SkipWhitespace (0);
 
-                /* If a ## operator follows, we have to insert the actual
-                ** argument as is, otherwise it must be macro replaced.
+                /* If a ## operator follows, the actual argument is inserted
+                ** as is, otherwise it is macro replaced on insertion.
                 */
                 if (CurC == '#' && NextC == '#') {
 
                     /* ### Add placemarker if necessary */
-                    SB_Append (&E->Replacement, Arg);
+                    AddMacroSeg (M, MS_RAWARG, ArgIdx);
 
                 } else {
 
-                    /* Replace the formal argument by a macro replaced copy
-                    ** of the actual.
-                    */
-                    SB_Reset (Arg);
-                    MacroReplacement (Arg, &E->Replacement);
+                    S = AddMacroSeg (M, MS_ARG, ArgIdx);
 
-                    /* If we skipped whitespace before, re-add it now */
-                    if (HaveSpace) {
-                        SB_AppendChar (&E->Replacement, ' ');
-                    }
+                    /* If we skipped whitespace, it is re-added after the
+                    ** replaced argument.
+                    */
+                    S->AddSpace = (HaveSpace != 0);
                 }
 
-
             } else {
 
                 /* An identifier, keep it */
-                SB_AppendStr (&E->Replacement, Ident);
+                SB_AppendStr (MacroSegText (M), Ident);
 
             }
 
@@ -575,34 +641,31 @@ static void MacroArgSubst (MacroExp* E)
             NextChar ();
             SkipWhitespace (0);
 
-            /* Since we need to concatenate the token sequences, remove
-            ** any whitespace that was added to target, since it must come
-            ** from the input.
+            /* On expansion, the paste segment removes any whitespace that
+            ** was added to the target, since it must come from the input.
             */
-            while (IsSpace (SB_LookAtLast (&E->Replacement))) {
-                SB_Drop (&E->Replacement, 1);
-            }
+            AddMacroSeg (M, MS_PASTE, 0);
 
             /* If the next token is an identifier which is a macro argument,
-            ** replace it, otherwise do nothing.
+            ** it is inserted as is, otherwise do nothing.
             */
             if (IsSym (Ident)) {
 
                 /* Check if it's a macro argument */
-                if ((ArgIdx = FindMacroArg (E->M, Ident)) >= 0) {
+                if ((ArgIdx = FindMacroArg (M, Ident)) >= 0) {
 
-                    /* Get the corresponding actual argument and add it. */
-                    SB_Append (&E->Replacement, ME_GetActual (E, ArgIdx));
+                    /* Insert the corresponding actual argument. */
+                    AddMacroSeg (M, MS_RAWARG, ArgIdx);
 
                 } else {
 
                     /* Just an ordinary identifier - add as is */
-                    SB_AppendStr (&E->Replacement, Ident);
+                    SB_AppendStr (MacroSegText (M), Ident);
 
                 }
             }
 
-        } else if (CurC == '#' && E->M->ArgCount >= 0) {
+        } else if (CurC == '#' && M->ArgCount >= 0) {
 
             /* A # operator within a macro expansion of a function like
             ** macro. Read the following identifier and check if it's a
@@ -610,33 +673,94 @@ static void MacroArgSubst (MacroExp* E)
             */
             NextChar ();
             SkipWhitespace (0);
-            if (!IsSym (Ident) || (ArgIdx = FindMacroArg (E->M, Ident)) < 0) {
+            if (!IsSym (Ident) || (ArgIdx = FindMacroArg (M, Ident)) < 0) {
                 PPError ("'#' is not followed by a macro parameter");
             } else {
-                /* Make a valid string from Replacement */
-                Arg = ME_GetActual (E, ArgIdx);
-                SB_Reset (Arg);
-                Stringize (Arg, &E->Replacement);
+                AddMacroSeg (M, MS_STRARG, ArgIdx);
             }
 
         } else if (IsQuote (CurC)) {
-            CopyQuotedString (&E->Replacement);
+            CopyQuotedString (MacroSegText (M));
         } else {
-            SB_AppendChar (&E->Replacement, CurC);
+            SB_AppendChar (MacroSegText (M), CurC);
             NextChar ();
         }
     }
 
-#if 0
-    /* Remove whitespace from the end of the line */
-    while (IsSpace (SB_LookAtLast (&E->Replacement))) {
-        SB_Drop (&E->Replacement, 1);
-    }
-#endif
-
     /* Switch back the input */
     InitLine (OldSource);
-    SB_SetIndex (&E->M->Replacement, OldIndex);
+    SB_SetIndex (&M->Replacement, OldIndex);
+
+    /* Remember that the body is valid now */
+    M->BodyParsed = 1;
+}
+
+
+
+static void MacroArgSubst (MacroExp* E)
+/* Argument substitution according to ISO/IEC 9899:1999 (E), 6.10.3.1ff */
+{
+    Macro*      M = E->M;
+    StrBuf*     Arg;
+    unsigned    I;
+
+    /* Parse the replacement text on first use */
+    if (!M->BodyParsed) {
+        ParseMacroBody (M);
+    }
+
+    /* Walk over the pre-parsed body and splice the parts together */
+    for (I = 0; I < CollCount (&M->Body); ++I) {
+
+        MacroSeg* S = CollAtUnchecked (&M->Body, I);
+        switch (S->Type) {
+
+            case MS_TEXT:
+                /* Literal text, copy it verbatim */
+                SB_Append (&E->Replacement, &S->Text);
+                break;
+
+            case MS_ARG:
+                /* Replace the formal argument by a macro replaced copy
+                ** of the actual.
+                */
+                Arg = ME_GetActual (E, S->Arg);
+                SB_Reset (Arg);
+                MacroReplacement (Arg, &E->Replacement);
+
+                /* If whitespace followed the formal argument, re-add it */
+                if (S->AddSpace) {
+                    SB_AppendChar (&E->Replacement, ' ');
+                }
+                break;
+
+            case MS_RAWARG:
+                /* Operand of the ## operator, insert the actual argument
+                ** as is.
+                */
+                SB_Append (&E->Replacement, ME_GetActual (E, S->Arg));
+                break;
+
+            case MS_STRARG:
+                /* Operand of the # operator, insert the stringized actual
+                ** argument.
+                */
+                Arg = ME_GetActual (E, S->Arg);
+                SB_Reset (Arg);
+                Stringize (Arg, &E->Replacement);
+                break;
+
+            case MS_PASTE:
+                /* Since we need to concatenate the token sequences, remove
+                ** any whitespace that was added to target, since it must
+                ** come from the input.
+                */
+                while (IsSpace (SB_LookAtLast (&E->Replacement))) {
+                    SB_Drop (&E->Replacement, 1);
+                }
+                break;
+        }
+    }
 }
 
 
@@ -926,8 +1050,7 @@ static unsigned Pass1 (StrBuf* Source, StrBuf* Target)
             }
             NewStyleComment ();
         } else {
-            SB_AppendChar (Target, CurC);
-            NextChar ();
+            CopyPlainSpan (Target);
         }
     }
 
@@ -969,8 +1092,7 @@ static void MacroReplacement (StrBuf* Source, StrBuf* Target)
             }
             NextChar ();
         } else {
-            SB_AppendChar (Target, CurC);
-            NextChar ();
+            CopyPlainSpan (Target);
         }
     }
 
@@ -1001,6 +1123,20 @@ static void PreprocessLine (void)
 
 
 
+static int LineIsBlank (void)
+/* Check if the current line contains only whitespace */
+{
+    unsigned I;
+    for (I = 0; I < SB_GetLen (Line); ++I) {
+        if (!IsSpace (SB_AtUnchecked (Line, I))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+
 static int PushIf (int Skip, int Invert, int Cond)
 /* Push a new if level onto the if stack */
 {
@@ -1102,7 +1238,12 @@ static int DoIfDef (int skip, int flag)
     if (MacName (Ident) == 0) {
         return 0;
     } else {
-        return PushIf (skip, flag, IsMacro(Ident));
+        int NewSkip = PushIf (skip, flag, IsMacro(Ident));
+        if (flag == 0 && !skip) {
+            /* This #ifndef may open the include guard of the file */
+            InputGuardIfNDef (Ident, IfIndex);
+        }
+        return NewSkip;
     }
 }
 
@@ -1259,6 +1400,7 @@ void Preprocess (void)
 
                     case PP_DEFINE:
                         if (!Skip) {
+                            InputGuardContent ();
                             DefineMacro ();
                         }
                         break;
@@ -1267,6 +1409,8 @@ void Preprocess (void)
                         if (IfIndex >= 0) {
                             if ((IfStack[IfIndex] & IFCOND_ELSE) == 0) {
 
+                                InputGuardElse (IfIndex);
+
                                 /* Handle as #else/#if combination */
                                 if ((IfStack[IfIndex] & IFCOND_SKIP) == 0) {
                                     Skip = !Skip;
@@ -1287,6 +1431,7 @@ void Preprocess (void)
                     case PP_ELSE:
                         if (IfIndex >= 0) {
                             if ((IfStack[IfIndex] & IFCOND_ELSE) == 0) {
+                                InputGuardElse (IfIndex);
                                 if ((IfStack[IfIndex] & IFCOND_SKIP) == 0) {
                                     Skip = !Skip;
                                 }
@@ -1313,6 +1458,7 @@ void Preprocess (void)
 
                             /* Remove the clause that needs a terminator */
                             Skip = (IfStack[IfIndex--] & IFCOND_SKIP) != 0;
+                            InputGuardEndIf (IfIndex);
                         } else {
                             PPError ("Unexpected '#endif'");
                         }
@@ -1320,15 +1466,22 @@ void Preprocess (void)
 
                     case PP_ERROR:
                         if (!Skip) {
+                            InputGuardContent ();
                             DoError ();
                         }
                         break;
 
                     case PP_IF:
+                        if (!Skip) {
+                            InputGuardContent ();
+                        }
                         Skip = DoIf (Skip);
                         break;
 
                     case PP_IFDEF:
+                        if (!Skip) {
+                            InputGuardContent ();
+                        }
                         Skip = DoIfDef (Skip, 1);
                         break;
 
@@ -1338,6 +1491,7 @@ void Preprocess (void)
 
                     case PP_INCLUDE:
                         if (!Skip) {
+                            InputGuardContent ();
                             DoInclude ();
                         }
                         break;
@@ -1345,12 +1499,14 @@ void Preprocess (void)
                     case PP_LINE:
                         /* Should do something in C99 at least, but we ignore it */
                         if (!Skip) {
+                            InputGuardContent ();
                             ClearLine ();
                         }
                         break;
 
                     case PP_PRAGMA:
                         if (!Skip) {
+                            InputGuardContent ();
                             DoPragma ();
                             goto Done;
                         }
@@ -1358,6 +1514,7 @@ void Preprocess (void)
 
                     case PP_UNDEF:
                         if (!Skip) {
+                            InputGuardContent ();
                             DoUndef ();
                         }
                         break;
@@ -1366,6 +1523,7 @@ void Preprocess (void)
                         /* #warning is a non standard extension */
                         if (IS_Get (&Standard) > STD_C99) {
                             if (!Skip) {
+                                InputGuardContent ();
                                 DoWarning ();
                             }
                         } else {
@@ -1396,6 +1554,13 @@ void Preprocess (void)
 
     PreprocessLine ();
 
+    /* If anything is left after translation, the line is content for the
+    ** include guard detection. Lines holding only comments are not.
+    */
+    if (!LineIsBlank ()) {
+        InputGuardContent ();
+    }
+
 Done:
     if (Verbosity > 1 && SB_NotEmpty (Line)) {
         printf ("%s(%u): %.*s\n", GetCurrentFile (), GetCurrentLine (),
@@ -41,6 +41,23 @@
 
 
 
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* Free list of register info structs. The register info for a code segment
+** is regenerated after each optimizer function that did changes, which means
+** that the structs for all entries are freed and allocated again many times
+** while optimizing one function. Recycling them here avoids the heap
+** traffic. The memory of a struct in the list is used to hold the link to
+** the next one.
+*/
+static RegInfo* FreeList = 0;
+
+
+
 /*****************************************************************************/
 /*                                   Code                                    */
 /*****************************************************************************/
@@ -108,8 +125,14 @@ RegInfo* NewRegInfo (const RegContents* RC)
 ** registers. If the pointer is NULL, all registers are set to unknown.
 */
 {
-    /* Allocate memory */
-    RegInfo* RI = xmalloc (sizeof (RegInfo));
+    /* Allocate memory, reusing a recycled struct if possible */
+    RegInfo* RI;
+    if (FreeList) {
+        RI = FreeList;
+        FreeList = *((RegInfo**) RI);
+    } else {
+        RI = xmalloc (sizeof (RegInfo));
+    }
 
     /* Initialize the registers */
     if (RC) {
@@ -131,7 +154,8 @@ RegInfo* NewRegInfo (const RegContents* RC)
 void FreeRegInfo (RegInfo* RI)
 /* Free a RegInfo struct */
 {
-    xfree (RI);
+    *((RegInfo**) RI) = FreeList;
+    FreeList = RI;
 }
 
 
@@ -42,8 +42,11 @@
 
 /* common */
 #include "chartype.h"
+#include "check.h"
+#include "coll.h"
 #include "fp.h"
 #include "tgttrans.h"
+#include "xmalloc.h"
 
 /* cc65 */
 #include "datatype.h"
@@ -70,6 +73,22 @@
 Token CurTok;           /* The current token */
 Token NextTok;          /* The next token */
 
+/* A recorded token sequence. While a recording is active, every token that
+** enters CurTok is appended to it. A replay later feeds the recorded tokens
+** through NextToken again, so the parser can process a source region twice
+** without touching the input files or the preprocessor.
+*/
+struct TokenSeq {
+    Collection      Tokens;     /* The recorded tokens */
+};
+
+/* The active recording and replay. Only one of each may be in progress. */
+static TokenSeq* Recording = 0;
+static TokenSeq* Replay = 0;
+static unsigned  ReplayNext = 0;        /* Next token to fetch from Replay */
+static Token     ReplaySavedCur;        /* Stream position before the replay */
+static Token     ReplaySavedNext;
+
 
 
 /* Token types */
@@ -93,6 +112,7 @@ static const struct Keyword {
     { "__Y__",          TOK_Y,          TT_C89 | TT_C99 | TT_CC65  },
     { "__asm__",        TOK_ASM,        TT_C89 | TT_C99 | TT_CC65  },
     { "__attribute__",  TOK_ATTRIBUTE,  TT_C89 | TT_C99 | TT_CC65  },
+    { "__builtin_expect", TOK_BUILTIN_EXPECT, TT_C89 | TT_C99 | TT_CC65 },
     { "__cdecl__",      TOK_CDECL,      TT_C89 | TT_C99 | TT_CC65  },
     { "__far__",        TOK_FAR,        TT_C89 | TT_C99 | TT_CC65  },
     { "__fastcall__",   TOK_FASTCALL,   TT_C89 | TT_C99 | TT_CC65  },
@@ -193,6 +213,25 @@ static int SkipWhite (void)
             Preprocess ();
         }
         if (IsSpace (CurC)) {
+            /* Skip the whole run of white space directly in the line buffer
+            ** instead of fetching one character at a time. Eight characters
+            ** are tested per round as long as the line is long enough, the
+            ** remainder is handled one by one.
+            */
+            const char* Buf = SB_GetConstBuf (Line);
+            unsigned    Len = SB_GetLen (Line);
+            unsigned    I   = SB_GetIndex (Line) + 1;
+            while (I + 8 <= Len &&
+                   IsSpace (Buf[I])   && IsSpace (Buf[I+1]) &&
+                   IsSpace (Buf[I+2]) && IsSpace (Buf[I+3]) &&
+                   IsSpace (Buf[I+4]) && IsSpace (Buf[I+5]) &&
+                   IsSpace (Buf[I+6]) && IsSpace (Buf[I+7])) {
+                I += 8;
+            }
+            while (I < Len && IsSpace (Buf[I])) {
+                ++I;
+            }
+            SB_SetIndex (Line, I - 1);
             NextChar ();
         } else {
             return 1;
@@ -398,8 +437,11 @@ static void CharConst (void)
 static void StringConst (void)
 /* Parse a quoted string */
 {
-    /* String buffer */
-    StrBuf S = AUTO_STRBUF_INITIALIZER;
+    /* String buffer. It is static, so the allocated memory is reused for
+    ** all string constants.
+    */
+    static StrBuf S = STATIC_STRBUF_INITIALIZER;
+    SB_Clear (&S);
 
     /* Assume next token is a string constant */
     NextTok.Tok  = TOK_SCONST;
@@ -446,9 +488,6 @@ static void StringConst (void)
 
     /* Add the whole string to the literal pool */
     NextTok.SVal = AddLiteralStr (&S);
-
-    /* Free the buffer */
-    SB_Done (&S);
 }
 
 
@@ -458,12 +497,17 @@ static void NumericConst (void)
 {
     unsigned Base;              /* Temporary number base */
     unsigned Prefix;            /* Base according to prefix */
-    StrBuf   S = STATIC_STRBUF_INITIALIZER;
+    static StrBuf S = STATIC_STRBUF_INITIALIZER;
     int      IsFloat;
     char     C;
     unsigned DigitVal;
     unsigned long IVal;         /* Value */
 
+    /* Clear the string buffer. It is static, so the allocated memory is
+    ** reused for all numeric constants.
+    */
+    SB_Clear (&S);
+
     /* Check for a leading hex, octal or binary prefix and determine the
     ** possible integer types.
     */
@@ -523,9 +567,6 @@ static void NumericConst (void)
         IVal = (IVal * Base) + DigitVal;
     }
 
-    /* We don't need the string buffer any longer */
-    SB_Done (&S);
-
     /* Distinguish between integer and floating point constants */
     if (!IsFloat) {
 
@@ -705,17 +746,135 @@ static void NumericConst (void)
 
 
 
+static void RecordToken (const Token* T)
+/* Append a copy of the given token to the active recording */
+{
+    Token* Copy = xmalloc (sizeof (*Copy));
+    *Copy = *T;
+    if (Copy->LI) {
+        /* The recording holds its own reference to the line info */
+        UseLineInfo (Copy->LI);
+    }
+    CollAppend (&Recording->Tokens, Copy);
+}
+
+
+
+static void ReplayFetch (void)
+/* Place the next token of the active replay into NextTok. After the last
+** recorded token, the tokens saved when the replay was started follow, so
+** the stream continues where it was left.
+*/
+{
+    unsigned Count = CollCount (&Replay->Tokens);
+    if (ReplayNext < Count) {
+        NextTok = *(const Token*) CollAtUnchecked (&Replay->Tokens, ReplayNext);
+        if (NextTok.LI) {
+            /* The token slot needs its own reference */
+            UseLineInfo (NextTok.LI);
+        }
+    } else if (ReplayNext == Count) {
+        NextTok = ReplaySavedCur;
+    } else {
+        NextTok = ReplaySavedNext;
+        /* The replay is complete */
+        Replay = 0;
+    }
+    ++ReplayNext;
+}
+
+
+
+TokenSeq* StartTokenSeqRecording (void)
+/* Start recording the token stream. The current token is the first one
+** recorded. Returns the handle for the recording.
+*/
+{
+    PRECONDITION (Recording == 0 && Replay == 0);
+    Recording = xmalloc (sizeof (*Recording));
+    InitCollection (&Recording->Tokens);
+    RecordToken (&CurTok);
+    return Recording;
+}
+
+
+
+void StopTokenSeqRecording (void)
+/* Stop the active token recording */
+{
+    PRECONDITION (Recording != 0);
+    Recording = 0;
+}
+
+
+
+void ReplayTokenSeq (TokenSeq* Seq)
+/* Feed the tokens of the given recording through NextToken again, starting
+** with the current token. When the recording is exhausted, the stream
+** continues at the position it had when the replay was started.
+*/
+{
+    PRECONDITION (Recording == 0 && Replay == 0 && CollCount (&Seq->Tokens) > 0);
+
+    /* Remember the stream position. The token slots pass their line info
+    ** references on to the saved copies.
+    */
+    ReplaySavedCur  = CurTok;
+    ReplaySavedNext = NextTok;
+
+    /* Make the first recorded token the current one and fetch the next */
+    Replay = Seq;
+    ReplayNext = 0;
+    ReplayFetch ();
+    CurTok = NextTok;
+    ReplayFetch ();
+}
+
+
+
+void FreeTokenSeq (TokenSeq* Seq)
+/* Delete a token recording. It must not be in use. */
+{
+    unsigned I;
+
+    PRECONDITION (Seq != Recording && Seq != Replay);
+    for (I = 0; I < CollCount (&Seq->Tokens); ++I) {
+        Token* T = CollAtUnchecked (&Seq->Tokens, I);
+        if (T->LI) {
+            ReleaseLineInfo (T->LI);
+        }
+        xfree (T);
+    }
+    DoneCollection (&Seq->Tokens);
+    xfree (Seq);
+}
+
+
+
 void NextToken (void)
 /* Get next token from input stream */
 {
     ident token;
+    int GotEOF;
+
+    /* If a replay is active, serve the tokens from the recording instead
+    ** of scanning the input.
+    */
+    if (Replay != 0) {
+        if (CurTok.LI) {
+            ReleaseLineInfo (CurTok.LI);
+        }
+        CurTok = NextTok;
+        ReplayFetch ();
+        return;
+    }
 
     /* We have to skip white space here before shifting tokens, since the
     ** tokens and the current line info is invalid at startup and will get
     ** initialized by reading the first time from the file. Remember if
     ** we were at end of input and handle that later.
     */
-    int GotEOF = (SkipWhite() == 0);
+    GotEOF = (SkipWhite() == 0);
 
     /* Current token is the lookahead token */
     if (CurTok.LI) {
@@ -731,6 +890,11 @@ void NextToken (void)
         CurTok.LI = UseLineInfo (GetCurLineInfo ());
     }
 
+    /* If a recording is active, it gets a copy of every consumed token */
+    if (Recording != 0) {
+        RecordToken (&CurTok);
+    }
+
     /* Remember the starting position of the next token */
     NextTok.LI = UseLineInfo (GetCurLineInfo ());
 
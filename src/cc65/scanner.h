@@ -181,6 +181,7 @@ typedef enum token_t {
     TOK_AX,
     TOK_EAX,
 
+    TOK_BUILTIN_EXPECT,
     TOK_PRAGMA
 } token_t;
 
@@ -210,6 +211,9 @@ struct Token {
 extern Token CurTok;            /* The current token */
 extern Token NextTok;           /* The next token */
 
+/* A recorded token sequence, see StartTokenSeqRecording */
+typedef struct TokenSeq TokenSeq;
+
 
 
 /*****************************************************************************/
@@ -264,6 +268,23 @@ int IsSym (char* S);
 void NextToken (void);
 /* Get next token from input stream */
 
+TokenSeq* StartTokenSeqRecording (void);
+/* Start recording the token stream. The current token is the first one
+** recorded. Returns the handle for the recording.
+*/
+
+void StopTokenSeqRecording (void);
+/* Stop the active token recording */
+
+void ReplayTokenSeq (TokenSeq* Seq);
+/* Feed the tokens of the given recording through NextToken again, starting
+** with the current token. When the recording is exhausted, the stream
+** continues at the position it had when the replay was started.
+*/
+
+void FreeTokenSeq (TokenSeq* Seq);
+/* Delete a token recording. It must not be in use. */
+
 void SkipTokens (const token_t* TokenList, unsigned TokenCount);
 /* Skip tokens until we reach TOK_CEOF or a token in the given token list.
 ** This routine is used for error recovery.
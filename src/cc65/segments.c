@@ -264,6 +264,15 @@ void AddDataLine (const char* Format, ...)
 
 
 
+void AddDataBytes (const void* Data, unsigned Size)
+/* Add raw data bytes to the current data segment */
+{
+    CHECK (CS != 0);
+    DS_AddBytes (GetDataSeg(), Data, Size);
+}
+
+
+
 int HaveGlobalCode (void)
 /* Return true if the global code segment contains entries (which is an error) */
 {
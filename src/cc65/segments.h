@@ -144,6 +144,9 @@ void AddCode (opc_t OPC, am_t AM, const char* Arg, struct CodeLabel* JumpTo);
 void AddDataLine (const char* Format, ...) attribute ((format (printf, 1, 2)));
 /* Add a line of data to the current data segment */
 
+void AddDataBytes (const void* Data, unsigned Size);
+/* Add raw data bytes to the current data segment */
+
 int HaveGlobalCode (void);
 /* Return true if the global code segment contains entries (which is an error) */
 
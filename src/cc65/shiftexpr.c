@@ -58,8 +58,8 @@
 
 
 
-void ShiftExpr (struct ExprDesc* Expr)
-/* Parse the << and >> operators. */
+void ShiftExprOps (struct ExprDesc* Expr)
+/* Handle the << and >> operators for an already parsed left hand side */
 {
     ExprDesc Expr2;
     CodeMark Mark1;
@@ -73,9 +73,6 @@ void ShiftExpr (struct ExprDesc* Expr)
     int rconst;                         /* Operand is a constant */
 
 
-    /* Evaluate the lhs */
-    ExprWithCheck (hie8, Expr);
-
     while (CurTok.Tok == TOK_SHL || CurTok.Tok == TOK_SHR) {
 
         /* All operators that call this function expect an int on the lhs */
@@ -235,3 +232,15 @@ Next:
         Expr->Type = ResultType;
     }
 }
+
+
+
+void ShiftExpr (struct ExprDesc* Expr)
+/* Parse the << and >> operators. */
+{
+    /* Evaluate the lhs */
+    ExprWithCheck (hie8, Expr);
+
+    /* Handle the operators */
+    ShiftExprOps (Expr);
+}
@@ -63,6 +63,9 @@ struct ExprDesc;
 void ShiftExpr (struct ExprDesc* Expr);
 /* Parse the << and >> operators. */
 
+void ShiftExprOps (struct ExprDesc* Expr);
+/* Handle the << and >> operators for an already parsed left hand side */
+
 
 
 /* End of shiftexpr.h */
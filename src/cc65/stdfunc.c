@@ -63,6 +63,7 @@
 
 
 
+static void StdFunc_fastcopy (FuncDesc*, ExprDesc*);
 static void StdFunc_memcpy (FuncDesc*, ExprDesc*);
 static void StdFunc_memset (FuncDesc*, ExprDesc*);
 static void StdFunc_strcmp (FuncDesc*, ExprDesc*);
@@ -84,6 +85,7 @@ static struct StdFuncDesc {
     const char*         Name;
     void                (*Handler) (FuncDesc*, ExprDesc*);
 } StdFuncs[] = {
+    {   "__fastcopy",   StdFunc_fastcopy        },
     {   "memcpy",       StdFunc_memcpy          },
     {   "memset",       StdFunc_memset          },
     {   "strcmp",       StdFunc_strcmp          },
@@ -198,6 +200,167 @@ void AddCmpCodeIfSizeNot256 (const char* Code, long Size)
 
 
 
+/*****************************************************************************/
+/*                                __fastcopy                                 */
+/*****************************************************************************/
+
+
+
+static void StdFunc_fastcopy (FuncDesc* F attribute ((unused)), ExprDesc* Expr)
+/* Handle the __fastcopy function. It has the same semantics as memcpy, but
+** when the addresses and the count are compile time constants, the copy is
+** always expanded inline, regardless of its size. Blocks larger than one
+** page are copied with one indexed loop that handles all pages in its body,
+** which is the fastest way to move memory on the 6502 without resorting to
+** self modifying code. Anything that cannot be expanded is compiled into a
+** plain call to memcpy.
+*/
+{
+    /* Argument types: (void*, const void*, size_t) */
+    static Type Arg1Type[] = { TYPE(T_PTR), TYPE(T_VOID), TYPE(T_END) };
+    static Type Arg2Type[] = { TYPE(T_PTR), TYPE(T_VOID|T_QUAL_CONST), TYPE(T_END) };
+    static Type Arg3Type[] = { TYPE(T_SIZE_T), TYPE(T_END) };
+
+    ArgDesc  Arg1, Arg2, Arg3;
+    unsigned ParamSize = 0;
+    unsigned Label;
+    long     Pages;
+    long     Rem;
+    long     I;
+
+    /* Argument #1 */
+    ParseArg (&Arg1, Arg1Type);
+    g_push (Arg1.Flags, Arg1.Expr.IVal);
+    GetCodePos (&Arg1.End);
+    ParamSize += SizeOf (Arg1Type);
+    ConsumeComma ();
+
+    /* Argument #2 */
+    ParseArg (&Arg2, Arg2Type);
+    g_push (Arg2.Flags, Arg2.Expr.IVal);
+    GetCodePos (&Arg2.End);
+    ParamSize += SizeOf (Arg2Type);
+    ConsumeComma ();
+
+    /* Argument #3. The count is passed in the primary, so load it there if
+    ** it is not a constant that was left in the expression.
+    */
+    ParseArg (&Arg3, Arg3Type);
+    if (Arg3.Flags & CF_CONST) {
+        LoadExpr (CF_NONE, &Arg3.Expr);
+    }
+
+    /* Emit the fallback call. This will also cleanup the stack. */
+    g_call (CF_FIXARGC, Func_memcpy, ParamSize);
+
+    if (ED_IsConstAbsInt (&Arg3.Expr) && Arg3.Expr.IVal == 0) {
+
+        /* __fastcopy has been called with a count argument of zero */
+        Warning ("Call to __fastcopy has no effect");
+
+        /* Remove all of the generated code but the load of the first
+        ** argument, which is what __fastcopy returns.
+        */
+        RemoveCode (&Arg1.Push);
+
+        /* Set the function result to the first argument */
+        *Expr = Arg1.Expr;
+
+        /* Bail out, no need for further improvements */
+        goto ExitPoint;
+    }
+
+    /* Check for a copy of constant size between two constant addresses. The
+    ** addresses may not be in the register space or below 256, since adding
+    ** the page offsets to such an address could overflow in the linker.
+    */
+    if (ED_IsConstAbsInt (&Arg3.Expr) &&
+        Arg3.Expr.IVal > 0 && Arg3.Expr.IVal < 0x10000 &&
+        ED_IsRVal (&Arg2.Expr) && ED_IsLocConst (&Arg2.Expr) &&
+        !ED_IsLocRegister (&Arg2.Expr) &&
+        !(ED_IsLocNone (&Arg2.Expr) && Arg2.Expr.IVal < 256) &&
+        ED_IsRVal (&Arg1.Expr) && ED_IsLocConst (&Arg1.Expr) &&
+        !ED_IsLocRegister (&Arg1.Expr) &&
+        !(ED_IsLocNone (&Arg1.Expr) && Arg1.Expr.IVal < 256)) {
+
+        /* Split the count into full pages and a remainder */
+        Pages = Arg3.Expr.IVal / 256;
+        Rem   = Arg3.Expr.IVal % 256;
+
+        /* Drop the generated code */
+        RemoveCode (&Arg1.Expr.Start);
+
+        if (Arg3.Expr.IVal <= 8) {
+
+            /* For a handful of bytes an unrolled sequence of load/store
+            ** instructions is the fastest possible code.
+            */
+            for (I = 0; I < Arg3.Expr.IVal; ++I) {
+                AddCodeLine ("lda %s", ED_GetLabelName (&Arg2.Expr, I));
+                AddCodeLine ("sta %s", ED_GetLabelName (&Arg1.Expr, I));
+            }
+
+        } else {
+
+            /* Copy all full pages with one loop. The body handles one byte
+            ** of every page per iteration, so the loop overhead is paid only
+            ** once per 256 bytes no matter how many pages are moved.
+            */
+            if (Pages > 0) {
+                Label = GetLocalLabel ();
+                AddCodeLine ("ldy #$00");
+                g_defcodelabel (Label);
+                for (I = 0; I < Pages; ++I) {
+                    AddCodeLine ("lda %s,y", ED_GetLabelName (&Arg2.Expr, I * 256));
+                    AddCodeLine ("sta %s,y", ED_GetLabelName (&Arg1.Expr, I * 256));
+                }
+                AddCodeLine ("iny");
+                AddCodeLine ("bne %s", LocalLabelName (Label));
+            }
+
+            /* Copy the remainder with the usual byte loop */
+            if (Rem > 0) {
+                Label = GetLocalLabel ();
+                if (Rem <= 129) {
+                    AddCodeLine ("ldy #$%02X", (unsigned char) (Rem-1));
+                    g_defcodelabel (Label);
+                    AddCodeLine ("lda %s,y", ED_GetLabelName (&Arg2.Expr, Pages * 256));
+                    AddCodeLine ("sta %s,y", ED_GetLabelName (&Arg1.Expr, Pages * 256));
+                    AddCodeLine ("dey");
+                    AddCodeLine ("bpl %s", LocalLabelName (Label));
+                } else {
+                    AddCodeLine ("ldy #$00");
+                    g_defcodelabel (Label);
+                    AddCodeLine ("lda %s,y", ED_GetLabelName (&Arg2.Expr, Pages * 256));
+                    AddCodeLine ("sta %s,y", ED_GetLabelName (&Arg1.Expr, Pages * 256));
+                    AddCodeLine ("iny");
+                    AddCodeLine ("cpy #$%02X", (unsigned char) Rem);
+                    AddCodeLine ("bne %s", LocalLabelName (Label));
+                }
+            }
+
+        }
+
+        /* __fastcopy returns the address, so the result is actually
+        ** identical to the first argument.
+        */
+        *Expr = Arg1.Expr;
+
+        /* Bail out, no need for further processing */
+        goto ExitPoint;
+    }
+
+    /* The function result is an rvalue in the primary register */
+    ED_FinalizeRValLoad (Expr);
+    Expr->Type = GetFuncReturn (Expr->Type);
+
+ExitPoint:
+    /* We expect the closing brace */
+    ConsumeRParen ();
+}
+
+
+
 /*****************************************************************************/
 /*                                  memcpy                                   */
 /*****************************************************************************/
@@ -216,6 +379,7 @@ static void StdFunc_memcpy (FuncDesc* F attribute ((unused)), ExprDesc* Expr)
     unsigned ParamSize = 0;
     unsigned Label;
     int      Offs;
+    long     I;
 
     /* Argument #1 */
     ParseArg (&Arg1, Arg1Type);
@@ -268,6 +432,41 @@ static void StdFunc_memcpy (FuncDesc* F attribute ((unused)), ExprDesc* Expr)
         ** be generated. If such a situation is detected, throw away the
         ** generated, and emit better code.
         */
+        /* For a very small constant size and both addresses constant, an
+        ** unrolled sequence of load/store instructions beats the copy loop
+        ** in speed, and for up to two bytes also in size. Allow more
+        ** unrolling when optimizing for speed. Addresses in the register
+        ** space or below 256 are not handled, since adding the offset to
+        ** such an address could overflow in the linker.
+        */
+        if (ED_IsConstAbsInt (&Arg3.Expr) && Arg3.Expr.IVal > 0 &&
+            (Arg3.Expr.IVal <= 2 ||
+             (Arg3.Expr.IVal <= 8 && IS_Get (&CodeSizeFactor) >= 200)) &&
+            ED_IsRVal (&Arg2.Expr) && ED_IsLocConst (&Arg2.Expr) &&
+            !ED_IsLocRegister (&Arg2.Expr) &&
+            !(ED_IsLocNone (&Arg2.Expr) && Arg2.Expr.IVal < 256) &&
+            ED_IsRVal (&Arg1.Expr) && ED_IsLocConst (&Arg1.Expr) &&
+            !ED_IsLocRegister (&Arg1.Expr) &&
+            !(ED_IsLocNone (&Arg1.Expr) && Arg1.Expr.IVal < 256)) {
+
+            /* Drop the generated code */
+            RemoveCode (&Arg1.Expr.Start);
+
+            /* Generate unrolled memcpy code */
+            for (I = 0; I < Arg3.Expr.IVal; ++I) {
+                AddCodeLine ("lda %s", ED_GetLabelName (&Arg2.Expr, I));
+                AddCodeLine ("sta %s", ED_GetLabelName (&Arg1.Expr, I));
+            }
+
+            /* memcpy returns the address, so the result is actually identical
+            ** to the first argument.
+            */
+            *Expr = Arg1.Expr;
+
+            /* Bail out, no need for further processing */
+            goto ExitPoint;
+        }
+
         if (ED_IsConstAbsInt (&Arg3.Expr) && Arg3.Expr.IVal <= 256 &&
             ((ED_IsRVal (&Arg2.Expr) && ED_IsLocConst (&Arg2.Expr)) ||
              (ED_IsLVal (&Arg2.Expr) && ED_IsLocRegister (&Arg2.Expr))) &&
@@ -526,6 +725,76 @@ static void StdFunc_memcpy (FuncDesc* F attribute ((unused)), ExprDesc* Expr)
             /* Bail out, no need for further processing */
             goto ExitPoint;
         }
+
+        /* Catch-all for a constant size: Even if both pointers are arbitrary
+        ** expressions, the copy can be done by an inline loop over zero page
+        ** pointers. Both pointers have already been pushed, so fetch them
+        ** into ptr1/ptr2 and drop them from the stack afterwards as the
+        ** library function would do. The code is quite a bit larger than the
+        ** jsr, so do this only if optimizing for speed.
+        */
+        if (ED_IsConstAbsInt (&Arg3.Expr) && Arg3.Expr.IVal <= 256 &&
+            (Arg3.Flags & CF_CONST) != 0 &&
+            IS_Get (&CodeSizeFactor) > 200) {
+
+            /* Remove the load of the count and the function call, but keep
+            ** the code that evaluates and pushes both pointers.
+            */
+            RemoveCode (&Arg2.End);
+
+            /* We need a label */
+            Label = GetLocalLabel ();
+
+            /* Fetch the source pointer (top of stack) and the destination
+            ** pointer below it.
+            */
+            AddCodeLine ("ldy #$00");
+            AddCodeLine ("lda (sp),y");
+            AddCodeLine ("sta ptr1");
+            AddCodeLine ("iny");
+            AddCodeLine ("lda (sp),y");
+            AddCodeLine ("sta ptr1+1");
+            AddCodeLine ("iny");
+            AddCodeLine ("lda (sp),y");
+            AddCodeLine ("sta ptr2");
+            AddCodeLine ("iny");
+            AddCodeLine ("lda (sp),y");
+            AddCodeLine ("sta ptr2+1");
+
+            /* Generate memcpy code */
+            if (Arg3.Expr.IVal <= 129) {
+                AddCodeLine ("ldy #$%02X", (unsigned char) (Arg3.Expr.IVal - 1));
+                g_defcodelabel (Label);
+                AddCodeLine ("lda (ptr1),y");
+                AddCodeLine ("sta (ptr2),y");
+                AddCodeLine ("dey");
+                AddCodeLine ("bpl %s", LocalLabelName (Label));
+            } else {
+                AddCodeLine ("ldy #$00");
+                g_defcodelabel (Label);
+                AddCodeLine ("lda (ptr1),y");
+                AddCodeLine ("sta (ptr2),y");
+                AddCodeLine ("iny");
+                AddCmpCodeIfSizeNot256 ("cpy #$%02X", Arg3.Expr.IVal);
+                AddCodeLine ("bne %s", LocalLabelName (Label));
+            }
+
+            /* Drop the pointer arguments */
+            g_drop (4);
+            pop (CF_PTR);
+            pop (CF_PTR);
+
+            /* Load the result, which is the destination pointer */
+            AddCodeLine ("lda ptr2");
+            AddCodeLine ("ldx ptr2+1");
+
+            /* The function result is an rvalue in the primary register */
+            ED_FinalizeRValLoad (Expr);
+            Expr->Type = GetFuncReturn (Expr->Type);
+
+            /* Bail out, no need for further processing */
+            goto ExitPoint;
+        }
     }
 
     /* The function result is an rvalue in the primary register */
@@ -427,8 +427,7 @@ static void ForStatement (void)
     ExprDesc lval1;
     ExprDesc lval3;
     int HaveIncExpr;
-    CodeMark IncExprStart;
-    CodeMark IncExprEnd;
+    TokenSeq* IncSeq = 0;
     int PendingToken;
 
     /* Get several local labels needed later */
@@ -466,24 +465,33 @@ static void ForStatement (void)
     }
     ConsumeSemi ();
 
-    /* Remember the start of the increment expression */
-    GetCodePos (&IncExprStart);
-
-    /* Label for the increment expression */
-    g_defcodelabel (IncLabel);
-
-    /* Parse the increment expression */
+    /* Check for an increment expression. It belongs to the bottom of the
+    ** loop, so it is not parsed here: its tokens are recorded and replayed
+    ** after the loop body, which generates the code directly in place
+    ** instead of moving it there afterwards.
+    */
     HaveIncExpr = (CurTok.Tok != TOK_RPAREN);
     if (HaveIncExpr) {
-        Expression0 (&lval3);
+        unsigned Depth = 0;
+        IncSeq = StartTokenSeqRecording ();
+        while (CurTok.Tok != TOK_CEOF) {
+            if (CurTok.Tok == TOK_LPAREN) {
+                ++Depth;
+            } else if (CurTok.Tok == TOK_RPAREN) {
+                if (Depth == 0) {
+                    break;
+                }
+                --Depth;
+            }
+            NextToken ();
+        }
+        StopTokenSeqRecording ();
+    } else {
+        /* No increment expression, jump from here back to the test */
+        g_defcodelabel (IncLabel);
+        g_jump (TestLabel);
     }
 
-    /* Jump to the test */
-    g_jump (TestLabel);
-
-    /* Remember the end of the increment expression */
-    GetCodePos (&IncExprEnd);
-
     /* Skip the closing paren */
     ConsumeRParen ();
 
@@ -491,14 +499,18 @@ static void ForStatement (void)
     g_defcodelabel (BodyLabel);
     Statement (&PendingToken);
 
-    /* If we had an increment expression, move the code to the bottom of
-    ** the loop. In this case we don't need to jump there at the end of
-    ** the loop body.
+    /* If we had an increment expression, replay and parse it now, followed
+    ** by the jump back to the test. Otherwise jump to the increment label
+    ** at the top of the loop.
     */
     if (HaveIncExpr) {
-        CodeMark Here;
-        GetCodePos (&Here);
-        MoveCode (&IncExprStart, &IncExprEnd, &Here);
+        g_defcodelabel (IncLabel);
+        ReplayTokenSeq (IncSeq);
+        Expression0 (&lval3);
+        /* Skip the replayed closing paren */
+        NextToken ();
+        FreeTokenSeq (IncSeq);
+        g_jump (TestLabel);
     } else {
         /* Jump back to the increment expression */
         g_jump (IncLabel);
@@ -669,6 +681,12 @@ int Statement (int* PendingToken)
             GetCodePos (&Start);
             /* Actual statement */
             ExprWithCheck (hie0, &Expr);
+            /* The result is discarded. If it is the untouched return value
+            ** of a direct function call, remember that for the callee.
+            */
+            if (Expr.Callee != 0) {
+                ++Expr.Callee->FuncVoidCalls;
+            }
             /* Load the result only if it is an lvalue and the type is
             ** marked as volatile. Otherwise the load is useless.
             */
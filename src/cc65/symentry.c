@@ -43,6 +43,7 @@
 #include "declare.h"
 #include "error.h"
 #include "symentry.h"
+#include "symtab.h"
 
 
 
@@ -58,8 +59,10 @@ SymEntry* NewSymEntry (const char* Name, unsigned Flags)
     /* Get the length of the name */
     unsigned Len = strlen (Name);
 
-    /* Allocate memory for the symbol entry */
-    SymEntry* E = xmalloc (sizeof (SymEntry) + Len);
+    /* Allocate memory for the symbol entry. Entries live until the end of
+    ** the compile, so they come from the symbol arena.
+    */
+    SymEntry* E = SymArenaAlloc (sizeof (SymEntry) + Len);
 
     /* Initialize the entry */
     E->NextHash = 0;
@@ -71,6 +74,8 @@ SymEntry* NewSymEntry (const char* Name, unsigned Flags)
     E->Type     = 0;
     E->Attr     = 0;
     E->AsmName  = 0;
+    E->FuncRefs = 0;
+    E->FuncVoidCalls = 0;
     E->V.BssName = 0;
     memcpy (E->Name, Name, Len+1);
 
@@ -96,7 +101,7 @@ void FreeSymEntry (SymEntry* E)
         DoneCollection (E->V.L.DefsOrRefs);
     }
 
-    xfree (E);
+    /* The entry itself belongs to the symbol arena and is not returned */
 }
 
 
@@ -103,6 +103,8 @@ struct CodeEntry;
 #define SC_SPADJUSTMENT 0x40000U
 #define SC_GOTO_IND     0x80000U        /* Indirect goto */
 
+#define SC_SOA          0x100000U       /* Array with split lo/hi byte layout */
+
 
 
 
@@ -129,6 +131,8 @@ struct SymEntry {
     Type*                       Type;     /* Symbol type */
     Collection*                 Attr;     /* Attribute list if any */
     char*                       AsmName;  /* Assembler name if any */
+    unsigned                    FuncRefs; /* For functions: Number of references */
+    unsigned                    FuncVoidCalls; /* For functions: Calls with unused result */
 
     /* Data that differs for the different symbol types */
     union {
@@ -53,6 +53,7 @@
 #include "error.h"
 #include "funcdesc.h"
 #include "global.h"
+#include "ident.h"
 #include "stackptr.h"
 #include "symentry.h"
 #include "typecmp.h"
@@ -68,6 +69,9 @@
 
 
 
+/* Hash bucket for the empty symbol table */
+static SymEntry* EmptyTab[1] = { 0 };
+
 /* An empty symbol table */
 SymTable        EmptySymTab = {
     0,          /* PrevTab */
@@ -75,7 +79,7 @@ SymTable        EmptySymTab = {
     0,          /* SymTail */
     0,          /* SymCount */
     1,          /* Size */
-    { 0 }       /* Tab[1] */
+    EmptyTab    /* Tab */
 };
 
 /* Symbol table sizes */
@@ -94,6 +98,32 @@ static SymTable*        TagTab          = 0;
 static SymTable*        LabelTab        = 0;
 static SymTable*        SPAdjustTab     = 0;
 
+/* Memo for FindSym. Tight function bodies look up the same names over and
+** over again, so the result of a scope chain walk is remembered here until
+** a scope is entered or left or a symbol is added, which is signalled by
+** bumping SymCacheGeneration. Slots from older generations are stale.
+*/
+#define SYM_CACHE_SIZE  256U    /* Must be a power of two */
+typedef struct SymCacheEntry SymCacheEntry;
+struct SymCacheEntry {
+    unsigned long   Generation;     /* Generation the slot is valid for */
+    SymEntry*       Sym;            /* Cached search result or NULL */
+    ident           Name;           /* Name the result belongs to */
+};
+static SymCacheEntry    SymCache[SYM_CACHE_SIZE];
+static unsigned long    SymCacheGeneration = 1;
+
+/* Arena for symbol tables and symbol entries. Both live until the end of
+** the compile (popped scopes keep their entries, since types and generated
+** code reference them), so they are allocated tightly packed from larger
+** blocks instead of doing one xmalloc per object. This keeps the entries
+** of a scope contiguous and makes entering a block scope little more than
+** a pointer bump.
+*/
+static char*            ArenaPtr  = 0;
+static unsigned         ArenaLeft = 0;
+#define ARENA_BLOCK_SIZE 16384U
+
 
 /*****************************************************************************/
 /*                              struct SymTable                              */
@@ -101,13 +131,41 @@ static SymTable*        SPAdjustTab     = 0;
 
 
 
+void* SymArenaAlloc (unsigned Size)
+/* Allocate memory for a symbol table or symbol entry from the arena */
+{
+    void* P;
+
+    /* Keep the blocks aligned */
+    Size = (Size + sizeof (void*) - 1) & ~(sizeof (void*) - 1);
+
+    /* Start a new block if the request doesn't fit the current one */
+    if (Size > ArenaLeft) {
+        if (Size >= ARENA_BLOCK_SIZE) {
+            /* Doesn't pay off, use a separate allocation */
+            return xmalloc (Size);
+        }
+        ArenaPtr  = xmalloc (ARENA_BLOCK_SIZE);
+        ArenaLeft = ARENA_BLOCK_SIZE;
+    }
+
+    /* Cut the request from the current block */
+    P = ArenaPtr;
+    ArenaPtr  += Size;
+    ArenaLeft -= Size;
+    return P;
+}
+
+
+
 static SymTable* NewSymTable (unsigned Size)
 /* Create and return a symbol table for the given lexical level */
 {
     unsigned I;
 
-    /* Allocate memory for the table */
-    SymTable* S = xmalloc (sizeof (SymTable) + (Size-1) * sizeof (SymEntry*));
+    /* Allocate memory for the table and the hash buckets */
+    SymTable* S = SymArenaAlloc (sizeof (SymTable));
+    S->Tab = SymArenaAlloc (Size * sizeof (SymEntry*));
 
     /* Initialize the symbol table structure */
     S->PrevTab  = 0;
@@ -128,16 +186,15 @@ static SymTable* NewSymTable (unsigned Size)
 static void FreeSymTable (SymTable* S)
 /* Free the given symbo table including all symbols */
 {
-    /* Free all symbols */
+    /* Free all symbols. The entry and table memory itself belongs to the
+    ** arena and is not returned.
+    */
     SymEntry* Sym = S->SymHead;
     while (Sym) {
         SymEntry* NextSym = Sym->NextSym;
         FreeSymEntry (Sym);
         Sym = NextSym;
     }
-
-    /* Free the table itself */
-    xfree (S);
 }
 
 
@@ -259,6 +316,9 @@ void EnterFunctionLevel (void)
 {
     SymTable* S;
 
+    /* Invalidate the symbol lookup memo */
+    ++SymCacheGeneration;
+
     /* New lexical level */
     ++LexicalLevel;
 
@@ -283,6 +343,9 @@ void EnterFunctionLevel (void)
 void RememberFunctionLevel (struct FuncDesc* F)
 /* Remember the symbol tables for the level and leave the level without checks */
 {
+    /* Invalidate the symbol lookup memo */
+    ++SymCacheGeneration;
+
     /* Leave the lexical level */
     --LexicalLevel;
 
@@ -301,6 +364,9 @@ void RememberFunctionLevel (struct FuncDesc* F)
 void ReenterFunctionLevel (struct FuncDesc* F)
 /* Reenter the function lexical level using the existing tables from F */
 {
+    /* Invalidate the symbol lookup memo */
+    ++SymCacheGeneration;
+
     /* New lexical level */
     ++LexicalLevel;
 
@@ -320,6 +386,9 @@ void ReenterFunctionLevel (struct FuncDesc* F)
 void LeaveFunctionLevel (void)
 /* Leave function lexical level */
 {
+    /* Invalidate the symbol lookup memo */
+    ++SymCacheGeneration;
+
     /* Leave the lexical level */
     --LexicalLevel;
 
@@ -345,6 +414,9 @@ void EnterBlockLevel (void)
 {
     SymTable* S;
 
+    /* Invalidate the symbol lookup memo */
+    ++SymCacheGeneration;
+
     /* New lexical level */
     ++LexicalLevel;
 
@@ -364,6 +436,9 @@ void EnterBlockLevel (void)
 void LeaveBlockLevel (void)
 /* Leave a nested block in a function */
 {
+    /* Invalidate the symbol lookup memo */
+    ++SymCacheGeneration;
+
     /* Leave the lexical level */
     --LexicalLevel;
 
@@ -382,6 +457,9 @@ void EnterStructLevel (void)
 {
     SymTable* S;
 
+    /* Invalidate the symbol lookup memo */
+    ++SymCacheGeneration;
+
     /* Get a new symbol table and make it current. Note: Structs and enums
     ** nested in struct scope are NOT local to the struct but visible in the
     ** outside scope. So we will NOT create a new struct or enum table.
@@ -396,6 +474,9 @@ void EnterStructLevel (void)
 void LeaveStructLevel (void)
 /* Leave a nested block for a struct definition */
 {
+    /* Invalidate the symbol lookup memo */
+    ++SymCacheGeneration;
+
     /* Don't delete the table */
     SymTab = SymTab->PrevTab;
 }
@@ -458,7 +539,26 @@ static SymEntry* FindSymInTree (const SymTable* Tab, const char* Name)
 SymEntry* FindSym (const char* Name)
 /* Find the symbol with the given name */
 {
-    return FindSymInTree (SymTab, Name);
+    unsigned        Hash = HashStr (Name);
+    SymCacheEntry*  C    = &SymCache[Hash & (SYM_CACHE_SIZE - 1)];
+    SymEntry*       E;
+
+    /* Check the memo first */
+    if (C->Generation == SymCacheGeneration && strcmp (C->Name, Name) == 0) {
+        return C->Sym;
+    }
+
+    /* Walk the scope chain */
+    E = FindSymInTree (SymTab, Name);
+
+    /* Remember the result, negative ones included */
+    if (strlen (Name) < sizeof (C->Name)) {
+        C->Generation = SymCacheGeneration;
+        C->Sym        = E;
+        strcpy (C->Name, Name);
+    }
+
+    return E;
 }
 
 
@@ -523,6 +623,39 @@ SymEntry* FindStructField (const Type* T, const char* Name)
 
 
 
+static void GrowSymTable (SymTable* T)
+/* Double the bucket count of a symbol table and rehash all symbols. Keeps
+** the hash chains short for structs and scopes with many symbols, where the
+** initial table size would otherwise make every lookup a list walk.
+*/
+{
+    SymEntry*  Sym;
+    unsigned   I;
+    unsigned   NewSize = 2 * T->Size + 1;
+    SymEntry** NewTab  = SymArenaAlloc (NewSize * sizeof (SymEntry*));
+
+    /* Clear the new buckets */
+    for (I = 0; I < NewSize; ++I) {
+        NewTab[I] = 0;
+    }
+
+    /* All symbols are on the level list, so the chains can be rebuilt from
+    ** there. The order within one bucket doesn't matter, since names are
+    ** unique within one table.
+    */
+    for (Sym = T->SymHead; Sym != 0; Sym = Sym->NextSym) {
+        unsigned Hash = HashStr (Sym->Name) % NewSize;
+        Sym->NextHash = NewTab[Hash];
+        NewTab[Hash]  = Sym;
+    }
+
+    /* Activate the new buckets. The old array stays in the arena. */
+    T->Tab  = NewTab;
+    T->Size = NewSize;
+}
+
+
+
 static void AddSymEntry (SymTable* T, SymEntry* S)
 /* Add a symbol to a symbol table */
 {
@@ -545,6 +678,14 @@ static void AddSymEntry (SymTable* T, SymEntry* S)
     S->NextHash  = T->Tab[Hash];
     T->Tab[Hash] = S;
 
+    /* The new symbol may shadow results in the lookup memo */
+    ++SymCacheGeneration;
+
+    /* Rehash into a larger bucket array when the chains grow too long */
+    if (T->SymCount > 2 * T->Size) {
+        GrowSymTable (T);
+    }
+
     /* Tell the symbol in which table it is */
     S->Owner = T;
 }
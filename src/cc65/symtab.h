@@ -59,7 +59,7 @@ struct SymTable {
     SymEntry*           SymTail;        /* Double linked list of symbols */
     unsigned            SymCount;       /* Count of symbols in this table */
     unsigned            Size;           /* Size of table */
-    SymEntry*           Tab[1];         /* Actual table, dynamically allocated */
+    SymEntry**          Tab;            /* Hash buckets, dynamically allocated */
 };
 
 /* An empty symbol table */
@@ -80,6 +80,9 @@ struct FuncDesc;
 
 
 
+void* SymArenaAlloc (unsigned Size);
+/* Allocate memory for a symbol table or symbol entry from the arena */
+
 unsigned GetLexicalLevel (void);
 /* Return the current lexical level */
 
@@ -7,7 +7,7 @@
 /*                                                                           */
 /*                                                                           */
 /* (C) 2004      Ullrich von Bassewitz                                       */
-/*               R�merstra�e 52                                              */
+/*               R�merstra�e 52                                              */
 /*               D-70794 Filderstadt                                         */
 /* EMail:        uz@cc65.org                                                 */
 /*                                                                           */
@@ -34,6 +34,7 @@
 
                      
 /* cc65 */
+#include "asmcode.h"
 #include "codegen.h"
 #include "error.h"
 #include "expr.h"
@@ -93,6 +94,16 @@ unsigned Test (unsigned Label, int Invert)
             g_truejump (CF_NONE, Label);
         } else {
             g_falsejump (CF_NONE, Label);
+
+            /* If the expression was marked as unlikely by __builtin_expect,
+            ** the branch to Label is the hot one and the fall through code
+            ** is cold. Flag the branch so the optimizer can move the cold
+            ** code out of line. The inverted case is used for loop bottom
+            ** tests where the layout is fixed anyway.
+            */
+            if (ED_IsUnlikely (&Expr)) {
+                MarkUnlikelyBranch ();
+            }
         }
     }
 
@@ -114,5 +114,5 @@ void TS_Output (const TextSeg* S)
     }
 
     /* Add an additional newline after the segment output */
-    WriteOutput ("\n");
+    WriteOutputStr ("\n");
 }
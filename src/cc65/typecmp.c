@@ -431,6 +431,18 @@ typecmp_t TypeCmp (const Type* lhs, const Type* rhs)
 
     /* Recursively compare the types if they aren't identical */
     if (rhs != lhs) {
+
+        /* A type string that matches the other one bit for bit describes
+        ** the identical type, so the expensive structural walk is only
+        ** needed when the raw strings differ. This catches the bulk of
+        ** the repeated compares for assignments and parameter checks.
+        */
+        unsigned Len = TypeLen (lhs);
+        if (Len == TypeLen (rhs) &&
+            memcmp (lhs, rhs, (Len + 1) * sizeof (Type)) == 0) {
+            return Result;
+        }
+
         DoCompare (lhs, rhs, &Result);
     }
 
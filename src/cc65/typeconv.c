@@ -190,6 +190,19 @@ void TypeConversion (ExprDesc* Expr, Type* NewType)
     PrintRawType (stdout, NewType);
 #endif
 
+    /* Shortcut: Two basic integer types with the same type code describe
+    ** the same type, so neither a conversion nor any checking is needed.
+    ** Pairs like int/int and char/char cover the bulk of all operator
+    ** applications, so this saves the structural type compare below for
+    ** them. Enums carry their symbol as an attribute and are left to the
+    ** full compare.
+    */
+    if (Expr->Type->C == NewType->C   &&
+        IsClassInt (NewType)          &&
+        GetType (NewType) != T_TYPE_ENUM) {
+        return;
+    }
+
     /* First, do some type checking */
     if (IsTypeVoid (NewType) || IsTypeVoid (Expr->Type)) {
         /* If one of the sides are of type void, output a more apropriate
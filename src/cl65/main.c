@@ -70,6 +70,7 @@
 /* common */
 #include "attrib.h"
 #include "cmdline.h"
+#include "filestat.h"
 #include "filetype.h"
 #include "fname.h"
 #include "mmodel.h"
@@ -143,6 +144,25 @@ static int Module = 0;
 /* Name of the target specific runtime library */
 static char* TargetLib   = 0;
 static int   NoTargetLib = 0;
+static int   SpeedLib    = 0;
+
+/* Maximum number of parallel compile jobs. Values above one are honoured
+** only if the spawn module supports background jobs.
+*/
+static unsigned MaxJobs = 1;
+
+/* Pipe the generated assembly directly into the assembler instead of
+** writing it to disk. Honoured only if the spawn module supports pipes.
+*/
+static int UsePipe = 0;
+
+/* Skip the compile/assemble steps for files whose object file is already up
+** to date. In this mode the object files are kept instead of being removed
+** as temporary files, and a dependency file (source name with the extension
+** replaced by ".d") is maintained per source file, so included files are
+** checked, too.
+*/
+static int IfChanged = 0;
 
 
 
@@ -410,10 +430,15 @@ static void SetTargetFiles (void)
     const char* TargetName = GetTargetName (Target);
     unsigned    TargetNameLen = strlen (TargetName);
 
+    /* Get the library suffix. The speed-optimized variant of the library
+    ** lives besides the normal one under a different name.
+    */
+    const char* LibSuffix = SpeedLib? "-speed.lib" : ".lib";
+
     /* Set the library file */
-    TargetLib = xmalloc (TargetNameLen + 4 + 1);
+    TargetLib = xmalloc (TargetNameLen + strlen (LibSuffix) + 1);
     memcpy (TargetLib, TargetName, TargetNameLen);
-    strcpy (TargetLib + TargetNameLen, ".lib");
+    strcpy (TargetLib + TargetNameLen, LibSuffix);
 }
 
 
@@ -465,6 +490,158 @@ static void RemoveTempFiles (void)
 
 
 
+static unsigned long GetModTime (const char* Path)
+/* Return the modification time of a file or zero if it cannot be statted */
+{
+    struct stat StatBuf;
+    if (FileStat (Path, &StatBuf) != 0) {
+        return 0;
+    }
+    return (unsigned long) StatBuf.st_mtime;
+}
+
+
+
+static int DepsUpToDate (const char* DepFile, unsigned long ObjTime)
+/* Read a make style dependency file as written by the compiler or assembler
+** and check that no file listed there is newer than ObjTime. Returns true
+** if the dependency file exists and all listed files are older.
+*/
+{
+    StrBuf Name = AUTO_STRBUF_INITIALIZER;
+    int UpToDate = 1;
+    int C;
+
+    /* Open the dependency file */
+    FILE* F = fopen (DepFile, "r");
+    if (F == 0) {
+        return 0;
+    }
+
+    /* Skip the rule target */
+    while ((C = fgetc (F)) != EOF && C != ':') ;
+
+    /* Read the space separated prerequisites of the first rule. Spaces in
+    ** file names are escaped with a backslash.
+    */
+    while (UpToDate) {
+        C = fgetc (F);
+        if (C == '\\') {
+            int Next = fgetc (F);
+            if (Next == '\n') {
+                /* Line continuation */
+                continue;
+            } else if (Next != EOF) {
+                /* Escaped character */
+                SB_AppendChar (&Name, Next);
+                continue;
+            }
+            C = EOF;
+        }
+        if (C == ' ' || C == '\t' || C == '\n' || C == EOF) {
+            /* End of a file name, check its time */
+            if (SB_NotEmpty (&Name)) {
+                unsigned long T;
+                SB_Terminate (&Name);
+                T = GetModTime (SB_GetConstBuf (&Name));
+                if (T == 0 || T > ObjTime) {
+                    UpToDate = 0;
+                }
+                SB_Clear (&Name);
+            }
+            /* The first rule ends with the line */
+            if (C == '\n' || C == EOF) {
+                break;
+            }
+        } else {
+            SB_AppendChar (&Name, C);
+        }
+    }
+
+    /* Close the file and free the buffer */
+    (void) fclose (F);
+    SB_Done (&Name);
+
+    return UpToDate;
+}
+
+
+
+static int ObjUpToDate (const char* Source, const char* Obj)
+/* Check for --if-changed if the object file Obj is up to date: it must be
+** newer than Source and than every file recorded in the dependency file of
+** a previous run. Without a dependency file the object is never considered
+** up to date, since included files cannot be checked then.
+*/
+{
+    char* DepFile;
+    int UpToDate;
+
+    /* Check the source file against the object file first */
+    unsigned long ObjTime = GetModTime (Obj);
+    if (ObjTime == 0 || GetModTime (Source) > ObjTime) {
+        return 0;
+    }
+
+    /* Check the files from the dependency file */
+    DepFile = MakeFilename (Source, ".d");
+    UpToDate = DepsUpToDate (DepFile, ObjTime);
+    xfree (DepFile);
+
+    return UpToDate;
+}
+
+
+
+static int SkipIfUnchanged (const char* Source)
+/* Check for --if-changed if the translation of Source can be skipped. If so,
+** add the existing object file to the linker files if we are linking, and
+** return true.
+*/
+{
+    char* ObjName;
+    int Skip;
+
+    /* The check only applies if an object file is produced */
+    if (!IfChanged || !DoAssemble) {
+        return 0;
+    }
+
+    /* Get the name of the object file */
+    if (!DoLink && OutputName) {
+        ObjName = xstrdup (OutputName);
+    } else {
+        ObjName = MakeFilename (Source, ".o");
+    }
+
+    /* Check if it is up to date */
+    Skip = ObjUpToDate (Source, ObjName);
+    if (Skip) {
+        if (Debug) {
+            printf ("Skipping '%s', '%s' is up to date\n", Source, ObjName);
+        }
+        /* Use the existing object file for the link */
+        if (DoLink) {
+            CmdAddFile (&LD65, ObjName);
+        }
+    }
+
+    xfree (ObjName);
+    return Skip;
+}
+
+
+
+static void AddDepArgs (CmdDesc* Cmd, const char* Source)
+/* Add the dependency file options for --if-changed to the given command */
+{
+    char* DepFile = MakeFilename (Source, ".d");
+    CmdAddArg2 (Cmd, "--create-dep", DepFile);
+    xfree (DepFile);
+}
+
+
+
 static void Link (void)
 /* Link the resulting executable */
 {
@@ -543,8 +720,12 @@ static void AssembleFile (const char* File, unsigned ArgCount)
         */
         char* ObjName = MakeFilename (File, ".o");
         CmdAddFile (&LD65, ObjName);
-        /* This is just a temporary file, schedule it for removal */
-        CmdAddFile (&RM, ObjName);
+        /* This is just a temporary file, schedule it for removal. With
+        ** --if-changed the object is kept for the next run instead.
+        */
+        if (!IfChanged) {
+            CmdAddFile (&RM, ObjName);
+        }
         xfree (ObjName);
     } else {
         /* This is the final step. If an output name is given, set it */
@@ -600,12 +781,20 @@ static void Assemble (const char* File)
     /* Remember the current assembler argument count */
     unsigned ArgCount = CA65.ArgCount;
 
+    /* If the object file is up to date, don't assemble at all */
+    if (SkipIfUnchanged (File)) {
+        return;
+    }
+
     /* We aren't assembling an intermediate file, but one requested by the
     ** user. So add a few options here if they were given on the command
     ** line.
     */
     if (DepName && *DepName) {
         CmdAddArg2 (&CA65, "--create-dep", DepName);
+    } else if (IfChanged) {
+        /* Maintain the dependency file for the next --if-changed run */
+        AddDepArgs (&CA65, File);
     }
     if (FullDepName && *FullDepName) {
         CmdAddArg2 (&CA65, "--create-full-dep", FullDepName);
@@ -617,12 +806,113 @@ static void Assemble (const char* File)
 
 
 
+#if defined(HAVE_PIPE)
+static void CompilePiped (const char* File)
+/* Compile the given file with the generated assembly piped directly into
+** the assembler, so no intermediate file is written to disk and both
+** programs run at the same time.
+*/
+{
+    int Status;
+    char* ObjName;
+    unsigned CCArgCount = CC65.ArgCount;
+    unsigned CAArgCount = CA65.ArgCount;
+
+    /* Set the target system for both programs */
+    CmdSetTarget (&CC65, Target);
+    CmdSetTarget (&CA65, Target);
+
+    /* The compiler writes to the pipe */
+    CmdSetOutput (&CC65, SPAWN_PIPE_NAME);
+
+    /* Maintain the dependency file for the next --if-changed run */
+    if (IfChanged && !DepName) {
+        AddDepArgs (&CC65, File);
+    }
+
+    /* If a dependency file is to be generated, set the dependency target
+    ** to be the final object file as Compile() does.
+    */
+    if (DepName || FullDepName || IfChanged) {
+        if (!DoLink && OutputName) {
+            CmdAddArg2 (&CC65, "--dep-target", OutputName);
+        } else {
+            ObjName = MakeFilename (File, ".o");
+            CmdAddArg2 (&CC65, "--dep-target", ObjName);
+            xfree (ObjName);
+        }
+    }
+
+    /* The assembler reads from the pipe, so its output name cannot be
+    ** derived from the input file and is always set explicitly.
+    */
+    if (!DoLink && OutputName) {
+        CmdSetOutput (&CA65, OutputName);
+    } else {
+        ObjName = MakeFilename (File, ".o");
+        CmdSetOutput (&CA65, ObjName);
+        if (DoLink) {
+            /* Add the object file to the linker files and schedule the
+            ** temporary file for removal. With --if-changed the object is
+            ** kept for the next run instead.
+            */
+            CmdAddFile (&LD65, ObjName);
+            if (!IfChanged) {
+                CmdAddFile (&RM, ObjName);
+            }
+        }
+        xfree (ObjName);
+    }
+
+    /* Add the input files and terminate the argument lists */
+    CmdAddArg (&CC65, File);
+    CmdAddArg (&CC65, 0);
+    CmdAddArg (&CA65, SPAWN_PIPE_NAME);
+    CmdAddArg (&CA65, 0);
+
+    /* If in debug mode, output the pipeline we will execute */
+    if (Debug) {
+        printf ("Executing: ");
+        CmdPrint (&CC65, stdout);
+        printf ("| ");
+        CmdPrint (&CA65, stdout);
+        printf ("\n");
+    }
+
+    /* Run both programs connected by a pipe */
+    Status = spawnpipe (CC65.Name, SPAWN_ARGV_CONST_CAST CC65.Args,
+                        CA65.Name, SPAWN_ARGV_CONST_CAST CA65.Args);
+    if (Status != 0) {
+        exit (Status);
+    }
+
+    /* Remove the excess arguments */
+    CmdDelArgs (&CC65, CCArgCount);
+    CmdDelArgs (&CA65, CAArgCount);
+}
+#endif
+
+
+
 static void Compile (const char* File)
 /* Compile the given file */
 {
     /* Remember the current compiler argument count */
     unsigned ArgCount = CC65.ArgCount;
 
+    /* If the object file is up to date, don't compile at all */
+    if (SkipIfUnchanged (File)) {
+        return;
+    }
+
+#if defined(HAVE_PIPE)
+    /* If requested, pipe the assembly directly into the assembler */
+    if (UsePipe && DoAssemble) {
+        CompilePiped (File);
+        return;
+    }
+#endif
+
     /* Set the target system */
     CmdSetTarget (&CC65, Target);
 
@@ -633,7 +923,12 @@ static void Compile (const char* File)
         ** not the intermediate assembler file. But beware: There may be an
         ** output name specified for the assembler.
         */
-        if (DepName || FullDepName) {
+        /* Maintain the dependency file for the next --if-changed run */
+        if (IfChanged && !DepName) {
+            AddDepArgs (&CC65, File);
+        }
+
+        if (DepName || FullDepName || IfChanged) {
             /* Was an output name for the assembler specified? */
             if (!DoLink && OutputName) {
                 /* Use this name as the dependency target */
@@ -677,6 +972,30 @@ static void Compile (const char* File)
 
 
 
+#if defined(HAVE_JOBS)
+static void CompileInBackground (const char* File)
+/* Compile and assemble the given file in a background job */
+{
+    /* Run the compile/assemble pipeline for the file in the background */
+    JobStart (Compile, File);
+
+    /* The job tracks the object file only in its own address space, so if
+    ** we are linking, add it to the linker files and schedule it for
+    ** removal here, too.
+    */
+    if (DoLink) {
+        char* ObjName = MakeFilename (File, ".o");
+        CmdAddFile (&LD65, ObjName);
+        if (!IfChanged) {
+            CmdAddFile (&RM, ObjName);
+        }
+        xfree (ObjName);
+    }
+}
+#endif
+
+
+
 static void CompileRes (const char* File)
 /* Compile the given geos resource file */
 {
@@ -814,9 +1133,12 @@ static void Usage (void)
             "  --debug\t\t\tDebug mode\n"
             "  --debug-info\t\t\tAdd debug info\n"
             "  --feature name\t\tSet an emulation feature\n"
+            "  --forbid-import sym\t\tFail if symbol 'sym' is imported\n"
             "  --force-import sym\t\tForce an import of symbol 'sym'\n"
             "  --help\t\t\tHelp (this text)\n"
+            "  --if-changed\t\t\tSkip files whose object file is up to date\n"
             "  --include-dir dir\t\tSet a compiler include directory path\n"
+            "  --jobs n\t\t\tCompile up to n files in parallel\n"
             "  --ld-args options\t\tPass options to the linker\n"
             "  --lib-path path\t\tSpecify a library search path\n"
             "  --list-targets\t\tList all available targets\n"
@@ -830,11 +1152,13 @@ static void Usage (void)
             "  --o65-model model\t\tOverride the o65 model\n"
             "  --obj file\t\t\tLink this object file\n"
             "  --obj-path path\t\tSpecify an object file search path\n"
+            "  --pipe\t\t\tPipe the assembly directly into the assembler\n"
             "  --print-target-path\t\tPrint the target file path\n"
             "  --register-space b\t\tSet space available for register variables\n"
             "  --register-vars\t\tEnable register variables\n"
             "  --rodata-name seg\t\tSet the name of the RODATA segment\n"
             "  --signed-chars\t\tDefault characters are signed\n"
+            "  --speed-lib\t\t\tLink the speed-optimized target library\n"
             "  --standard std\t\tLanguage standard (c89, c99, cc65)\n"
             "  --start-addr addr\t\tSet the default start address\n"
             "  --static-locals\t\tMake local variables static\n"
@@ -1056,6 +1380,14 @@ static void OptFeature (const char* Opt attribute ((unused)), const char* Arg)
 
 
 
+static void OptForbidImport (const char* Opt attribute ((unused)), const char* Arg)
+/* Fail the link if the given symbol is imported */
+{
+    CmdAddArg2 (&LD65, "--forbid-import", Arg);
+}
+
+
+
 static void OptForceImport (const char* Opt attribute ((unused)), const char* Arg)
 /* Emulation features for the assembler */
 {
@@ -1074,6 +1406,15 @@ static void OptHelp (const char* Opt attribute ((unused)),
 
 
 
+static void OptIfChanged (const char* Opt attribute ((unused)),
+                          const char* Arg attribute ((unused)))
+/* Only compile/assemble files whose object file is not up to date */
+{
+    IfChanged = 1;
+}
+
+
+
 static void OptIncludeDir (const char* Opt attribute ((unused)), const char* Arg)
 /* Include directory (compiler) */
 {
@@ -1082,6 +1423,25 @@ static void OptIncludeDir (const char* Opt attribute ((unused)), const char* Arg
 
 
 
+static void OptJobs (const char* Opt, const char* Arg)
+/* Set the maximum number of parallel compile jobs */
+{
+    int Jobs = atoi (Arg);
+    if (Jobs < 1) {
+        Error ("Argument for %s is invalid", Opt);
+    }
+    MaxJobs = Jobs;
+#if !defined(HAVE_JOBS)
+    /* Without background job support the files are done one by one */
+    if (MaxJobs > 1) {
+        Warning ("Parallel jobs are not supported on this system");
+        MaxJobs = 1;
+    }
+#endif
+}
+
+
+
 static void OptLdArgs (const char* Opt attribute ((unused)), const char* Arg)
 /* Pass arguments to the linker */
 {
@@ -1207,6 +1567,20 @@ static void OptObjPath (const char* Opt attribute ((unused)), const char* Arg)
 
 
 
+static void OptPipe (const char* Opt attribute ((unused)),
+                     const char* Arg attribute ((unused)))
+/* Pipe the assembly directly into the assembler */
+{
+#if defined(HAVE_PIPE)
+    UsePipe = 1;
+#else
+    /* Without pipe support the intermediate file is used */
+    Warning ("Pipes are not supported on this system");
+#endif
+}
+
+
+
 static void OptPrintTargetPath (const char* Opt attribute ((unused)),
                                 const char* Arg attribute ((unused)))
 /* Print the target file path */
@@ -1268,6 +1642,15 @@ static void OptSignedChars (const char* Opt attribute ((unused)),
 
 
 
+static void OptSpeedLib (const char* Opt attribute ((unused)),
+                         const char* Arg attribute ((unused)))
+/* Link the speed-optimized variant of the target library */
+{
+    SpeedLib = 1;
+}
+
+
+
 static void OptStandard (const char* Opt attribute ((unused)), const char* Arg)
 /* Set the language standard */
 {
@@ -1372,9 +1755,12 @@ int main (int argc, char* argv [])
         { "--debug",             0, OptDebug          },
         { "--debug-info",        0, OptDebugInfo      },
         { "--feature",           1, OptFeature        },
+        { "--forbid-import",     1, OptForbidImport   },
         { "--force-import",      1, OptForceImport    },
         { "--help",              0, OptHelp           },
+        { "--if-changed",        0, OptIfChanged      },
         { "--include-dir",       1, OptIncludeDir     },
+        { "--jobs",              1, OptJobs           },
         { "--ld-args",           1, OptLdArgs         },
         { "--lib-path",          1, OptLibPath        },
         { "--list-targets",      0, OptListTargets    },
@@ -1388,11 +1774,13 @@ int main (int argc, char* argv [])
         { "--o65-model",         1, OptO65Model       },
         { "--obj",               1, OptObj            },
         { "--obj-path",          1, OptObjPath        },
+        { "--pipe",              0, OptPipe           },
         { "--print-target-path", 0, OptPrintTargetPath},
         { "--register-space",    1, OptRegisterSpace  },
         { "--register-vars",     0, OptRegisterVars   },
         { "--rodata-name",       1, OptRodataName     },
         { "--signed-chars",      0, OptSignedChars    },
+        { "--speed-lib",         0, OptSpeedLib       },
         { "--standard",          1, OptStandard       },
         { "--start-addr",        1, OptStartAddr      },
         { "--static-locals",     0, OptStaticLocals   },
@@ -1605,6 +1993,12 @@ int main (int argc, char* argv [])
 
                 case FILETYPE_C:
                     /* Compile the file */
+#if defined(HAVE_JOBS)
+                    if (MaxJobs > 1 && DoAssemble) {
+                        CompileInBackground (Arg);
+                        break;
+                    }
+#endif
                     Compile (Arg);
                     break;
 
@@ -1642,6 +2036,11 @@ int main (int argc, char* argv [])
         ++I;
     }
 
+#if defined(HAVE_JOBS)
+    /* Wait for background jobs before using their output files */
+    JobsDone ();
+#endif
+
     /* Check if we had any input files */
     if (FirstInput == 0) {
         Warning ("No input files");
@@ -276,8 +276,23 @@ static void ConvertSeg (FILE* F, const O65Data* D, const Collection* Relocs,
             }
 
         } else {
-            /* Just a constant value */
-            fprintf (F, "\t.byte\t$%02X\n", Data[Byte++]);
+            /* A run of constant values up to the next relocation or the
+            ** end of the segment. Batch them into .byte lines with several
+            ** values each, instead of one line per byte, so ca65 has far
+            ** less text to read back in.
+            */
+            unsigned long End = (R != 0 && R->Offs < Size)? R->Offs : Size;
+            while (Byte < End) {
+                unsigned Chunk = 16;
+                if (End - Byte < Chunk) {
+                    Chunk = (unsigned) (End - Byte);
+                }
+                fprintf (F, "\t.byte\t$%02X", Data[Byte++]);
+                while (--Chunk > 0) {
+                    fprintf (F, ",$%02X", Data[Byte++]);
+                }
+                fputc ('\n', F);
+            }
         }
     }
 
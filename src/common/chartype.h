@@ -55,23 +55,98 @@
 
 
 
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* Classification bits in CharClassTab */
+#define CT_SPACE        0x01    /* Any white space character */
+#define CT_BLANK        0x02    /* Space or tab */
+#define CT_DIGIT        0x04    /* Decimal digit */
+#define CT_LOWER        0x08    /* Lower case letter */
+#define CT_UPPER        0x10    /* Upper case letter */
+#define CT_XDIGIT       0x20    /* Hexadecimal digit */
+#define CT_QUOTE        0x40    /* Single or double quote */
+#define CT_IDENT        0x80    /* Letter or underscore */
+
+/* Combined classification bits */
+#define CT_ALPHA        (CT_LOWER | CT_UPPER)
+#define CT_ALNUM        (CT_ALPHA | CT_DIGIT)
+
+/* Character classification table with one entry of CT_xxx bits per
+** character. The functions below test it with a single indexed load, which
+** replaces the chained compares of the previous implementation on the
+** scanner hot paths.
+*/
+extern const unsigned char CharClassTab[256];
+
+/* Case mapping tables. They map lower case letters to their upper case
+** counterparts and vice versa and are the identity for all other
+** characters, so a conversion is one unconditional table load without the
+** case check and locale machinery of toupper/tolower.
+*/
+extern const unsigned char CharUpperTab[256];
+extern const unsigned char CharLowerTab[256];
+
+
+
 /*****************************************************************************/
 /*                                   Code                                    */
 /*****************************************************************************/
 
 
 
-int IsAlpha (char C);
+#if defined(HAVE_INLINE)
+INLINE int IsClass (char C, unsigned char Bits)
+/* Check the classification bits for a character */
+{
+    return (CharClassTab[(unsigned char) C] & Bits) != 0;
+}
+#else
+#  define IsClass(C, Bits)      ((CharClassTab[(unsigned char) (C)] & (Bits)) != 0)
+#endif
+
+#if defined(HAVE_INLINE)
+INLINE int IsAlpha (char C)
 /* Check for a letter */
+{
+    return IsClass (C, CT_ALPHA);
+}
+#else
+#  define IsAlpha(C)            IsClass (C, CT_ALPHA)
+#endif
 
-int IsAlNum (char C);
+#if defined(HAVE_INLINE)
+INLINE int IsAlNum (char C)
 /* Check for letter or digit */
+{
+    return IsClass (C, CT_ALNUM);
+}
+#else
+#  define IsAlNum(C)            IsClass (C, CT_ALNUM)
+#endif
 
-int IsAscii (char C);
+#if defined(HAVE_INLINE)
+INLINE int IsAscii (char C)
 /* Check for an ASCII character */
+{
+    return (C & ~0x7F) == 0;
+}
+#else
+#  define IsAscii(C)            (((C) & ~0x7F) == 0)
+#endif
 
-int IsBlank (char C);
+#if defined(HAVE_INLINE)
+INLINE int IsBlank (char C)
 /* Check for a space or tab */
+{
+    return IsClass (C, CT_BLANK);
+}
+#else
+#  define IsBlank(C)            IsClass (C, CT_BLANK)
+#endif
 
 #if defined(HAVE_INLINE)
 INLINE int IsControl (char C)
@@ -83,29 +158,105 @@ INLINE int IsControl (char C)
 #  define IsControl(C)          iscntrl (C)
 #endif
 
-int IsSpace (char C);
+#if defined(HAVE_INLINE)
+INLINE int IsSpace (char C)
 /* Check for any white space characters */
+{
+    return IsClass (C, CT_SPACE);
+}
+#else
+#  define IsSpace(C)            IsClass (C, CT_SPACE)
+#endif
 
-int IsDigit (char C);
+#if defined(HAVE_INLINE)
+INLINE int IsDigit (char C)
 /* Check for a digit */
+{
+    return IsClass (C, CT_DIGIT);
+}
+#else
+#  define IsDigit(C)            IsClass (C, CT_DIGIT)
+#endif
 
-int IsLower (char C);
+#if defined(HAVE_INLINE)
+INLINE int IsLower (char C)
 /* Check for a lower case char */
+{
+    return IsClass (C, CT_LOWER);
+}
+#else
+#  define IsLower(C)            IsClass (C, CT_LOWER)
+#endif
 
-int IsUpper (char C);
+#if defined(HAVE_INLINE)
+INLINE int IsUpper (char C)
 /* Check for upper case characters */
+{
+    return IsClass (C, CT_UPPER);
+}
+#else
+#  define IsUpper(C)            IsClass (C, CT_UPPER)
+#endif
 
-int IsBDigit (char C);
+#if defined(HAVE_INLINE)
+INLINE int IsBDigit (char C)
 /* Check for binary digits (0/1) */
+{
+    return (C == '0' || C == '1');
+}
+#else
+#  define IsBDigit(C)           ((C) == '0' || (C) == '1')
+#endif
 
-int IsODigit (char C);
+#if defined(HAVE_INLINE)
+INLINE int IsODigit (char C)
 /* Check for octal digits (0..7) */
+{
+    return (C >= '0' && C <= '7');
+}
+#else
+#  define IsODigit(C)           ((C) >= '0' && (C) <= '7')
+#endif
 
-int IsXDigit (char C);
+#if defined(HAVE_INLINE)
+INLINE int IsXDigit (char C)
 /* Check for hexadecimal digits */
+{
+    return IsClass (C, CT_XDIGIT);
+}
+#else
+#  define IsXDigit(C)           IsClass (C, CT_XDIGIT)
+#endif
 
-int IsQuote (char C);
+#if defined(HAVE_INLINE)
+INLINE int IsQuote (char C)
 /* Check for a single or double quote */
+{
+    return IsClass (C, CT_QUOTE);
+}
+#else
+#  define IsQuote(C)            IsClass (C, CT_QUOTE)
+#endif
+
+#if defined(HAVE_INLINE)
+INLINE char CharToUpper (char C)
+/* Convert a lower case letter to upper case */
+{
+    return (char) CharUpperTab[(unsigned char) C];
+}
+#else
+#  define CharToUpper(C)        ((char) CharUpperTab[(unsigned char) (C)])
+#endif
+
+#if defined(HAVE_INLINE)
+INLINE char CharToLower (char C)
+/* Convert an upper case letter to lower case */
+{
+    return (char) CharLowerTab[(unsigned char) C];
+}
+#else
+#  define CharToLower(C)        ((char) CharLowerTab[(unsigned char) (C)])
+#endif
 
 
 
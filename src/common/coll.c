@@ -137,10 +137,13 @@ void CollInsert (Collection* C, void* Item, unsigned Index)
     /* Check for invalid indices */
     PRECONDITION (Index <= C->Count);
 
-    /* Grow the array if necessary */
+    /* Grow the array if necessary. Most collections hold only very few
+    ** items, so the first allocation is kept small, and geometric growth
+    ** is used from there on.
+    */
     if (C->Count >= C->Size) {
         /* Must grow */
-        CollGrow (C, (C->Size == 0)? 4 : C->Size * 2);
+        CollGrow (C, (C->Size == 0)? 2 : C->Size * 2);
     }
 
     /* Move the existing elements if needed */
@@ -320,7 +323,7 @@ void CollReplaceExpand (Collection* C, void* Item, unsigned Index)
         /* Must expand the collection */
         unsigned Size = C->Size;
         if (Size == 0) {
-            Size = 4;
+            Size = 2;
         }
         while (Index >= Size) {
             Size *= 2;
@@ -438,6 +441,27 @@ static void QuickSort (Collection* C, int Lo, int Hi,
     while (Hi > Lo) {
         int I = Lo + 1;
         int J = Hi;
+
+        /* Use the median of the first, middle and last item as pivot and
+        ** move it to the front. With the first item alone, sorted or nearly
+        ** sorted input (which is common for the callers) degrades the sort
+        ** to quadratic time.
+        */
+        if (Hi > Lo + 1) {
+            int Mid = Lo + (Hi - Lo) / 2;
+            void* Tmp;
+            if (Compare (Data, Items[Lo], Items[Mid]) > 0) {
+                Tmp = Items[Lo]; Items[Lo] = Items[Mid]; Items[Mid] = Tmp;
+            }
+            if (Compare (Data, Items[Lo], Items[Hi]) > 0) {
+                Tmp = Items[Lo]; Items[Lo] = Items[Hi]; Items[Hi] = Tmp;
+            }
+            if (Compare (Data, Items[Mid], Items[Hi]) > 0) {
+                Tmp = Items[Mid]; Items[Mid] = Items[Hi]; Items[Hi] = Tmp;
+            }
+            Tmp = Items[Lo]; Items[Lo] = Items[Mid]; Items[Mid] = Tmp;
+        }
+
         while (I <= J) {
             while (I <= J && Compare (Data, Items[Lo], Items[I]) >= 0) {
                 ++I;
@@ -147,6 +147,17 @@ INLINE void* CollAtUnchecked (const Collection* C, unsigned Index)
 #  define CollAtUnchecked(C, Index)     ((C)->Items[(Index)])
 #endif
 
+/* Iterate over all items in a collection. This macro expands to the head of
+** a for loop; the statement or block following it is executed once per item,
+** with Item set to the current item cast to the given pointer type. Index
+** must be a declared unsigned variable. In contrast to a callback based
+** iteration, no function call per item is needed.
+*/
+#define CollForEach(C, Index, Item, Type)                                     \
+    for ((Index) = 0;                                                         \
+         (Index) < (C)->Count && ((Item) = (Type) (C)->Items[(Index)], 1);    \
+         ++(Index))
+
 #if defined(HAVE_INLINE)
 INLINE const void* CollConstAt (const Collection* C, unsigned Index)
 /* Return the item at the given index */
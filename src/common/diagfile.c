@@ -0,0 +1,104 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                diagfile.c                                 */
+/*                                                                           */
+/*                 Machine readable diagnostic output file                   */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#include <stdio.h>
+
+/* common */
+#include "diagfile.h"
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* Name of the diagnostic file. NULL if machine readable diagnostics are
+** not requested.
+*/
+static const char* DiagName = 0;
+
+/* The diagnostic file, opened on the first record */
+static FILE* DiagFile = 0;
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+void SetDiagnosticFile (const char* Name)
+/* Enable machine readable diagnostics and set the name of the output file.
+** The file is created when the first diagnostic is written.
+*/
+{
+    DiagName = Name;
+}
+
+
+
+void DiagnosticRecord (const char* Type, const char* File, unsigned long Line,
+                       const char* Msg)
+/* Write one record to the diagnostic file. The call is a no-op if no
+** diagnostic file was set.
+*/
+{
+    /* Bail out early if machine readable diagnostics aren't requested. This
+    ** is the common case, so diagnostics that are suppressed or go only to
+    ** stderr don't pay for the feature.
+    */
+    if (DiagName == 0) {
+        return;
+    }
+
+    /* Open the file when the first record is written */
+    if (DiagFile == 0) {
+        DiagFile = fopen (DiagName, "w");
+        if (DiagFile == 0) {
+            /* We cannot use the error functions of the tool here, since
+            ** they would end up calling us again. Complain and disable the
+            ** diagnostic file.
+            */
+            fprintf (stderr, "Cannot open '%s'\n", DiagName);
+            DiagName = 0;
+            return;
+        }
+    }
+
+    /* One line per diagnostic with tab separated fields */
+    fprintf (DiagFile, "%s\t%s\t%lu\t%s\n", Type, File, Line, Msg);
+
+    /* Some error paths terminate by abort, which doesn't flush the streams,
+    ** so make sure the record hits the file right away.
+    */
+    fflush (DiagFile);
+}
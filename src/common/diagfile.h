@@ -0,0 +1,70 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                diagfile.h                                 */
+/*                                                                           */
+/*                 Machine readable diagnostic output file                   */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#ifndef DIAGFILE_H
+#define DIAGFILE_H
+
+
+
+/* Besides the human readable messages on stderr, the tools can write each
+** diagnostic to a separate file in a fixed format that other programs can
+** parse without scraping stderr. Each diagnostic is one line with four
+** fields separated by tab characters:
+**
+**      type <tab> file <tab> line <tab> message
+**
+** where type is the diagnostic class as it appears in the stderr message,
+** for example "Error", "Warning", "Fatal" or "Note". For diagnostics
+** without a source position, file is empty and line is zero.
+*/
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+void SetDiagnosticFile (const char* Name);
+/* Enable machine readable diagnostics and set the name of the output file.
+** The file is created when the first diagnostic is written.
+*/
+
+void DiagnosticRecord (const char* Type, const char* File, unsigned long Line,
+                       const char* Msg);
+/* Write one record to the diagnostic file. The call is a no-op if no
+** diagnostic file was set.
+*/
+
+
+
+/* End of diagfile.h */
+
+#endif
@@ -89,3 +89,20 @@ unsigned HashBuf (const StrBuf* S)
     }
     return H;
 }
+
+
+
+unsigned HashData (const void* Buf, unsigned Size, unsigned H)
+/* Return a hash value for the given raw data. H is the running hash value:
+** Pass HASHDATA_INITIAL for the first block and feed the result back in for
+** data that arrives in several blocks. The function uses the 32 bit FNV-1a
+** scheme, which mixes each byte into the full hash and is therefore suited
+** for checksumming binary data.
+*/
+{
+    const unsigned char* P = Buf;
+    while (Size--) {
+        H = (H ^ *P++) * 0x01000193U;
+    }
+    return H;
+}
@@ -44,6 +44,17 @@
 
 
 
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* Initial value for the running hash passed to HashData */
+#define HASHDATA_INITIAL        0x811C9DC5U
+
+
+
 /*****************************************************************************/
 /*                                   Code                                    */
 /*****************************************************************************/
@@ -59,6 +70,12 @@ unsigned HashStr (const char* S) attribute ((const));
 unsigned HashBuf (const StrBuf* S) attribute ((const));
 /* Return a hash value for the given string buffer */
 
+unsigned HashData (const void* Buf, unsigned Size, unsigned H) attribute ((const));
+/* Return a hash value for the given raw data. H is the running hash value:
+** Pass HASHDATA_INITIAL for the first block and feed the result back in for
+** data that arrives in several blocks.
+*/
+
 
 
 /* End of hashfunc.h */
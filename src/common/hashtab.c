@@ -101,6 +101,40 @@ static void HT_Alloc (HashTable* T)
 
 
 
+static void HT_Grow (HashTable* T)
+/* Grow the table and redistribute the entries. Since the full hash value is
+** stored in each node, no hashes need to be recalculated.
+*/
+{
+    HashNode**  OldTable = T->Table;
+    unsigned    OldSlots = T->Slots;
+    unsigned    I;
+
+    /* Choose a larger slot count and allocate a new table. The slot count
+    ** is kept odd, so that hash values with a bias in the low bits don't
+    ** all end up in the same slots.
+    */
+    T->Slots = OldSlots * 2 + 1;
+    HT_Alloc (T);
+
+    /* Move the nodes from the old chains into the new table */
+    for (I = 0; I < OldSlots; ++I) {
+        HashNode* N = OldTable[I];
+        while (N) {
+            HashNode* Next  = N->Next;
+            unsigned  RHash = N->Hash % T->Slots;
+            N->Next         = T->Table[RHash];
+            T->Table[RHash] = N;
+            N = Next;
+        }
+    }
+
+    /* Delete the old table */
+    xfree (OldTable);
+}
+
+
+
 HashNode* HT_FindHash (const HashTable* T, const void* Key, unsigned Hash)
 /* Find the node with the given key. Differs from HT_Find in that the hash
 ** for the key is precalculated and passed to the function.
@@ -171,6 +205,14 @@ void HT_Insert (HashTable* T, void* Entry)
 
     /* One more entry */
     ++T->Count;
+
+    /* If the load factor has become too large, grow the table, so the
+    ** chains stay short even if the initial slot count was guessed too
+    ** small for the input.
+    */
+    if (T->Count >= 2 * T->Slots) {
+        HT_Grow (T);
+    }
 }
 
 
@@ -158,7 +158,10 @@ void* HT_Find (const HashTable* T, const void* Key);
 /* Find the entry with the given key and return it */
 
 void HT_Insert (HashTable* T, void* Entry);
-/* Insert an entry into the given hash table */
+/* Insert an entry into the given hash table. The table grows automatically
+** if the load factor becomes too large, so the initial slot count is just a
+** hint for the expected number of entries.
+*/
 
 void HT_Remove (HashTable* T, void* Entry);
 /* Remove an entry from the given hash table */
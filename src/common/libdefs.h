@@ -51,6 +51,36 @@
 /* Size of an library file header */
 #define LIB_HDR_SIZE    12
 
+/* Defines for the Flags field. If LIB_FLAG_EXPINDEX is set, the member
+** index is followed by an export index: The total number of exports as a
+** variable sized value, then for each export its name as a string and the
+** number of the member that exports it as a variable sized value. The
+** linker may use this index to select members without parsing the headers
+** of members that aren't needed. Readers ignore the flag (and the index)
+** if they don't know it, so the library version stays the same.
+*/
+#define LIB_FLAG_EXPINDEX 0x0001
+
+/* If LIB_FLAG_HASHTAB is set, the member index is followed by a checksum
+** table (placed before the export index if both flags are set): For each
+** member in index order one flag byte that is non zero if the checksum is
+** valid, then a 32 bit checksum of the member data. The archiver uses the
+** table to verify the integrity of the library members.
+*/
+#define LIB_FLAG_HASHTAB  0x0002
+
+/* If LIB_FLAG_STRPOOL is set, the library has a shared string pool, placed
+** between the checksum table and the export index: The number of strings as
+** a variable sized value, then each string. The string pool sections of the
+** members don't contain the strings themselves but reference the shared
+** pool: The string count as a variable sized value, then for each string
+** its index in the shared pool. Since segment and symbol names repeat
+** across the members of a library, sharing them shrinks the library
+** considerably. Unlike the other flags this one changes the member
+** encoding, so readers must know the flag to use the library.
+*/
+#define LIB_FLAG_STRPOOL  0x0004
+
 
 
 /* Header structure for the library */
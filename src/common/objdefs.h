@@ -55,6 +55,17 @@
 #define OBJ_FLAGS_DBGINFO       0x0001  /* File has debug info */
 #define OBJ_HAS_DBGINFO(x)      (((x) & OBJ_FLAGS_DBGINFO) != 0)
 
+/* If OBJ_FLAGS_LILISTS is set, the lists of line info indices that are part
+** of fragments, imports, exports, debug symbols and assertions aren't stored
+** inline. Instead, each occurrence is just an index into a table of such
+** lists that follows the line infos in the line info section. Since the
+** same lists are repeated over and over for code generated by macros, this
+** makes the object files a lot smaller. The flag exists so that object
+** files written without the table are still accepted.
+*/
+#define OBJ_FLAGS_LILISTS       0x0002  /* Line info lists are interned */
+#define OBJ_HAS_LILISTS(x)      (((x) & OBJ_FLAGS_LILISTS) != 0)
+
 
 
 /* Header structure */
@@ -7,7 +7,7 @@
 /*                                                                           */
 /*                                                                           */
 /* (C) 1998-2003 Ullrich von Bassewitz                                       */
-/*               R�merstrasse 52                                             */
+/*               R�merstrasse 52                                             */
 /*               D-70794 Filderstadt                                         */
 /* EMail:        uz@cc65.org                                                 */
 /*                                                                           */
@@ -54,6 +54,7 @@
 #define OPT_TRANSLATOR  (OPT_ARGSTR+2)  /* Translator specification */
 #define OPT_COMPILER    (OPT_ARGSTR+3)  /* Compiler specification */
 #define OPT_OS          (OPT_ARGSTR+4)  /* Operating system specification */
+#define OPT_STACKUSE    (OPT_ARGSTR+5)  /* Stack usage annotation */
 
 #define OPT_DATETIME    (OPT_ARGNUM+0)  /* Date/time of translation */
 
@@ -33,6 +33,7 @@
 
 
 
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
 #if defined(_WIN32)
@@ -45,15 +46,153 @@
 /* Anyone else */
 #  include <unistd.h>
 #endif
+#if !defined(_WIN32) && !defined(_MSC_VER)
+#  include <dirent.h>
+#  define HAVE_DIR_CACHE
+#endif
 
 /* common */
 #include "coll.h"
+#include "hashfunc.h"
+#include "hashtab.h"
 #include "searchpath.h"
 #include "strbuf.h"
 #include "xmalloc.h"
 
 
 
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+#if defined(HAVE_DIR_CACHE)
+
+/* Since the search directories are checked over and over for the same small
+** set of files, each directory is read just once and the contents are kept
+** in memory. Later searches are then resolved against the in-memory listing,
+** which also serves as a negative lookup cache: a name that is not in the
+** listing is rejected without touching the disk.
+*/
+
+/* A file name within a cached directory */
+typedef struct FileEntry FileEntry;
+struct FileEntry {
+    HashNode    Node;           /* Node for the hash table */
+    char        Name[1];        /* The file name, dynamically sized */
+};
+
+/* A cached directory */
+typedef struct DirCache DirCache;
+struct DirCache {
+    HashTable   Files;          /* Names of the files in the directory */
+    int         Valid;          /* True if the directory could be read */
+    char        Name[1];        /* Directory name, dynamically sized */
+};
+
+/* Hash table functions */
+static unsigned HT_GenHash (const void* Key);
+static const void* HT_GetKey (const void* Entry);
+static int HT_Compare (const void* Key1, const void* Key2);
+static const HashFunctions HashFunc = {
+    HT_GenHash,
+    HT_GetKey,
+    HT_Compare
+};
+
+/* The directories read so far */
+static Collection DirCaches = STATIC_COLLECTION_INITIALIZER;
+
+#endif
+
+
+
+/*****************************************************************************/
+/*                           Hash table functions                            */
+/*****************************************************************************/
+
+
+
+#if defined(HAVE_DIR_CACHE)
+
+static unsigned HT_GenHash (const void* Key)
+/* Generate the hash over a key. */
+{
+    return HashStr (Key);
+}
+
+
+
+static const void* HT_GetKey (const void* Entry)
+/* Given a pointer to the user entry data, return a pointer to the key */
+{
+    return ((const FileEntry*) Entry)->Name;
+}
+
+
+
+static int HT_Compare (const void* Key1, const void* Key2)
+/* Compare two keys for equality */
+{
+    return strcmp (Key1, Key2);
+}
+
+
+
+static const DirCache* ReadDirContents (const char* Dir)
+/* Return the cache entry for the given directory, reading the directory on
+** first use.
+*/
+{
+    unsigned I;
+    unsigned Len;
+    DirCache* D;
+    DIR* Handle;
+
+    /* Search for an existing entry. The number of search directories is
+    ** small, so a linear search will do.
+    */
+    for (I = 0; I < CollCount (&DirCaches); ++I) {
+        D = CollAtUnchecked (&DirCaches, I);
+        if (strcmp (D->Name, Dir) == 0) {
+            return D;
+        }
+    }
+
+    /* Not found, create a new entry */
+    Len = strlen (Dir);
+    D = xmalloc (sizeof (DirCache) + Len);
+    memcpy (D->Name, Dir, Len + 1);
+    InitHashTable (&D->Files, 128, &HashFunc);
+    D->Valid = 0;
+
+    /* Read the directory contents. An empty path element means the current
+    ** directory.
+    */
+    Handle = opendir (Dir[0] != '\0'? Dir : ".");
+    if (Handle != 0) {
+        const struct dirent* E;
+        while ((E = readdir (Handle)) != 0) {
+            unsigned NameLen = strlen (E->d_name);
+            FileEntry* F = xmalloc (sizeof (FileEntry) + NameLen);
+            memcpy (F->Name, E->d_name, NameLen + 1);
+            InitHashNode (&F->Node);
+            HT_Insert (&D->Files, F);
+        }
+        closedir (Handle);
+        D->Valid = 1;
+    }
+
+    /* Remember and return the new entry */
+    CollAppend (&DirCaches, D);
+    return D;
+}
+
+#endif
+
+
+
 /*****************************************************************************/
 /*                                   Code                                    */
 /*****************************************************************************/
@@ -258,10 +397,32 @@ char* SearchFile (const SearchPaths* P, const char* File)
     char* Name = 0;
     StrBuf PathName = AUTO_STRBUF_INITIALIZER;
 
+#if defined(HAVE_DIR_CACHE)
+    /* The directory cache can only answer lookups for plain file names. If
+    ** the name has a directory component, it must be checked on disk.
+    */
+    int UseCache = (strchr (File, '/') == 0 && strchr (File, '\\') == 0);
+#endif
+
     /* Start the search */
     unsigned I;
     for (I = 0; I < CollCount (P); ++I) {
 
+#if defined(HAVE_DIR_CACHE)
+        if (UseCache) {
+            /* Check the cached directory listing first, so directories that
+            ** don't contain the file are rejected without a system call.
+            ** Hits fall through to the access check below, which also covers
+            ** the case of a listed but inaccessible file.
+            */
+            const DirCache* D = ReadDirContents (CollConstAt (P, I));
+            if (D->Valid && HT_Find (&D->Files, File) == 0) {
+                /* The directory doesn't contain the file */
+                continue;
+            }
+        }
+#endif
+
         /* Copy the next path element into the buffer */
         SB_CopyStr (&PathName, CollConstAt (P, I));
 
@@ -280,6 +441,14 @@ char* SearchFile (const SearchPaths* P, const char* File)
         }
     }
 
+    /* If nothing was found, make sure errno reflects this, since the cache
+    ** may have answered the search without a failing system call and some
+    ** callers use errno in their error messages.
+    */
+    if (Name == 0) {
+        errno = ENOENT;
+    }
+
     /* Cleanup and return the result of the search */
     SB_Done (&PathName);
     return Name;
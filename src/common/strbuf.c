@@ -129,10 +129,13 @@ void SB_Realloc (StrBuf* B, unsigned NewSize)
 ** available.
 */
 {
-    /* Get the current size, use a minimum of 8 bytes */
+    /* Get the current size, use a minimum of 32 bytes. The minimum covers
+    ** nearly all identifiers and literals, so the usual grow-by-appending
+    ** loops get by with a single allocation.
+    */
     unsigned NewAllocated = B->Allocated;
     if (NewAllocated == 0) {
-        NewAllocated = 8;
+        NewAllocated = 32;
     }
 
     /* Round up to the next power of two */
@@ -164,10 +167,10 @@ static void SB_CheapRealloc (StrBuf* B, unsigned NewSize)
 ** buffer and may be used if the old contents are overwritten later.
 */
 {
-    /* Get the current size, use a minimum of 8 bytes */
+    /* Get the current size, use a minimum of 32 bytes (see SB_Realloc) */
     unsigned NewAllocated = B->Allocated;
     if (NewAllocated == 0) {
-        NewAllocated = 8;
+        NewAllocated = 32;
     }
 
     /* Round up to the next power of two */
@@ -287,6 +290,44 @@ void SB_AppendBuf (StrBuf* B, const char* S, unsigned Size)
 
 
 
+void SB_AppendUnsigned (StrBuf* B, unsigned long V)
+/* Append an unsigned number in decimal notation to the string buffer */
+{
+    /* Convert the number into the buffer, starting with the last digit */
+    char Buf [32];
+    char* S = Buf + sizeof (Buf);
+    do {
+        *--S = '0' + (char) (V % 10);
+        V /= 10;
+    } while (V != 0);
+
+    /* Append the converted digits */
+    SB_AppendBuf (B, S, (unsigned) (Buf + sizeof (Buf) - S));
+}
+
+
+
+void SB_AppendHex (StrBuf* B, unsigned long V)
+/* Append an unsigned number in upper case hex notation to the string buffer */
+{
+    static const char HexTab [16] = {
+        '0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F'
+    };
+
+    /* Convert the number into the buffer, starting with the last digit */
+    char Buf [32];
+    char* S = Buf + sizeof (Buf);
+    do {
+        *--S = HexTab [V & 0x0F];
+        V >>= 4;
+    } while (V != 0);
+
+    /* Append the converted digits */
+    SB_AppendBuf (B, S, (unsigned) (Buf + sizeof (Buf) - S));
+}
+
+
+
 #if !defined(HAVE_INLINE)
 void SB_AppendStr (StrBuf* B, const char* S)
 /* Append a string to the end of the string buffer */
@@ -375,9 +416,7 @@ void SB_ToLower (StrBuf* S)
     unsigned I;
     char* B = S->Buf;
     for (I = 0; I < S->Len; ++I, ++B) {
-        if (IsUpper (*B)) {
-            *B = tolower (*B);
-        }
+        *B = CharToLower (*B);
     }
 }
 
@@ -389,9 +428,7 @@ void SB_ToUpper (StrBuf* S)
     unsigned I;
     char* B = S->Buf;
     for (I = 0; I < S->Len; ++I, ++B) {
-        if (IsLower (*B)) {
-            *B = toupper (*B);
-        }
+        *B = CharToUpper (*B);
     }
 }
 
@@ -339,6 +339,12 @@ void SB_AppendChar (StrBuf* B, int C);
 void SB_AppendBuf (StrBuf* B, const char* S, unsigned Size);
 /* Append a character buffer to the end of the string buffer */
 
+void SB_AppendUnsigned (StrBuf* B, unsigned long V);
+/* Append an unsigned number in decimal notation to the string buffer */
+
+void SB_AppendHex (StrBuf* B, unsigned long V);
+/* Append an unsigned number in upper case hex notation to the string buffer */
+
 #if defined(HAVE_INLINE)
 INLINE void SB_AppendStr (StrBuf* B, const char* S)
 /* Append a string to the end of the string buffer */
@@ -87,11 +87,28 @@ struct StringPoolEntry {
     StrBuf              Buf;    /* The string itself */
 };
 
+/* Block for entry and string storage. Entries and their string data are
+** carved out of large blocks by bump allocation, so interning a string
+** needs no allocation of its own in most cases, and the whole pool is
+** freed by freeing the block list.
+*/
+typedef struct StringPoolBlock StringPoolBlock;
+struct StringPoolBlock {
+    StringPoolBlock*    Next;   /* Next block in list */
+    unsigned            Used;   /* Number of bytes in use */
+    unsigned            Size;   /* Size of Data */
+    char                Data[1];/* Block memory, dynamically sized */
+};
+
+/* Size of the data area of a newly allocated block */
+#define SP_BLOCK_SIZE   0x10000U
+
 /* A string pool */
 struct StringPool {
     Collection          Entries;        /* Entries sorted by number */
     unsigned            TotalSize;      /* Total size of all string data */
     HashTable           Tab;            /* Hash table */
+    StringPoolBlock*    Blocks;         /* List of storage blocks */
 };
 
 /* Hash table functions */
@@ -109,20 +126,57 @@ static const HashFunctions HashFunc = {
 
 
 
-static StringPoolEntry* NewStringPoolEntry (const StrBuf* S, unsigned Id)
+static void* SP_AllocMem (StringPool* P, unsigned Size)
+/* Allocate a piece of memory from the block storage of the pool */
+{
+    void* Mem;
+
+    /* Round the size up, so following allocations stay aligned */
+    Size = (Size + sizeof (void*) - 1) & ~(sizeof (void*) - 1);
+
+    /* Allocate a new block if the request doesn't fit the current one */
+    if (P->Blocks == 0 || P->Blocks->Used + Size > P->Blocks->Size) {
+        unsigned BlockSize = SP_BLOCK_SIZE;
+        StringPoolBlock* B;
+        if (BlockSize < Size) {
+            BlockSize = Size;
+        }
+        B = xmalloc (sizeof (StringPoolBlock) - 1 + BlockSize);
+        B->Next   = P->Blocks;
+        B->Used   = 0;
+        B->Size   = BlockSize;
+        P->Blocks = B;
+    }
+
+    /* Carve the memory out of the current block */
+    Mem = P->Blocks->Data + P->Blocks->Used;
+    P->Blocks->Used += Size;
+    return Mem;
+}
+
+
+
+static StringPoolEntry* NewStringPoolEntry (StringPool* P, const StrBuf* S, unsigned Id)
 /* Create a new string pool entry and return it. */
 {
-    /* Allocate memory */
-    StringPoolEntry* E = xmalloc (sizeof (StringPoolEntry));
+    /* Carve the entry and its string data out of the pool's block storage */
+    unsigned Len = SB_GetLen (S);
+    StringPoolEntry* E = SP_AllocMem (P, sizeof (StringPoolEntry));
+    char* Data = SP_AllocMem (P, Len + 1);
 
-    /* Initialize the fields */
-    InitHashNode (&E->Node);
-    E->Id   = Id;
-    SB_Init (&E->Buf);
-    SB_Copy (&E->Buf, S);
+    /* Copy the string and zero terminate it */
+    memcpy (Data, SB_GetConstBuf (S), Len);
+    Data[Len] = '\0';
 
-    /* Always zero terminate the string */
-    SB_Terminate (&E->Buf);
+    /* Initialize the fields. Allocated is left at zero, since the string
+    ** data is owned by the block storage, not by the string buffer.
+    */
+    InitHashNode (&E->Node);
+    E->Id            = Id;
+    E->Buf.Buf       = Data;
+    E->Buf.Len       = Len;
+    E->Buf.Index     = 0;
+    E->Buf.Allocated = 0;
 
     /* Return the new entry */
     return E;
@@ -178,6 +232,7 @@ StringPool* NewStringPool (unsigned HashSlots)
     /* Initialize the fields */
     P->Entries   = EmptyCollection;
     P->TotalSize = 0;
+    P->Blocks    = 0;
     InitHashTable (&P->Tab, HashSlots, &HashFunc);
 
     /* Return a pointer to the new pool */
@@ -189,21 +244,18 @@ StringPool* NewStringPool (unsigned HashSlots)
 void FreeStringPool (StringPool* P)
 /* Free a string pool */
 {
-    unsigned I;
-
-    /* Free all entries and clear the entry collection */
-    for (I = 0; I < CollCount (&P->Entries); ++I) {
-
-        /* Get a pointer to the entry */
-        StringPoolEntry* E = CollAtUnchecked (&P->Entries, I);
-
-        /* Free string buffer memory */
-        SB_Done (&E->Buf);
-
-        /* Free the memory for the entry itself */
-        xfree (E);
+    /* The entries and their string data live in the block storage, so
+    ** freeing the block list frees them all.
+    */
+    StringPoolBlock* B = P->Blocks;
+    while (B) {
+        StringPoolBlock* Next = B->Next;
+        xfree (B);
+        B = Next;
     }
-    CollDeleteAll (&P->Entries);
+
+    /* Free the entry collection */
+    DoneCollection (&P->Entries);
 
     /* Free the hash table */
     DoneHashTable (&P->Tab);
@@ -239,7 +291,7 @@ unsigned SP_Add (StringPool* P, const StrBuf* S)
     if (E == 0) {
 
         /* We didn't find the entry, so create a new one */
-        E = NewStringPoolEntry (S, CollCount (&P->Entries));
+        E = NewStringPoolEntry (P, S, CollCount (&P->Entries));
 
         /* Insert the new entry into the entries collection */
         CollAppend (&P->Entries, E);
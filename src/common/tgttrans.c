@@ -48,8 +48,8 @@
 
 
 
-/* Translation table actually used. Default is no translation */
-static unsigned char Tab[256] = {
+/* Translation table with no translation, used until a target is selected */
+static const unsigned char IdentityTab[256] = {
     0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08,0x09,0x0A,0x0B,0x0C,0x0D,0x0E,0x0F,
     0x10,0x11,0x12,0x13,0x14,0x15,0x16,0x17,0x18,0x19,0x1A,0x1B,0x1C,0x1D,0x1E,0x1F,
     0x20,0x21,0x22,0x23,0x24,0x25,0x26,0x27,0x28,0x29,0x2A,0x2B,0x2C,0x2D,0x2E,0x2F,
@@ -68,6 +68,16 @@ static unsigned char Tab[256] = {
     0xF0,0xF1,0xF2,0xF3,0xF4,0xF5,0xF6,0xF7,0xF8,0xF9,0xFA,0xFB,0xFC,0xFD,0xFE,0xFF,
 };
 
+/* Translation table actually used. This points to the constant table of the
+** selected target, so selecting a target is just a pointer assignment. The
+** table is only copied into MutableTab if the translation is changed via
+** TgtTranslateSet.
+*/
+static const unsigned char* Tab = IdentityTab;
+
+/* Copy of the table used after TgtTranslateSet has changed an entry */
+static unsigned char MutableTab[256];
+
 
 
 /*****************************************************************************/
@@ -79,8 +89,8 @@ static unsigned char Tab[256] = {
 void TgtTranslateInit (void)
 /* Initialize the translation tables */
 {
-    /* Copy the translation for the selected target */
-    memcpy (Tab, GetTargetProperties (Target)->CharMap, sizeof (Tab));
+    /* Use the translation for the selected target */
+    Tab = GetTargetProperties (Target)->CharMap;
 }
 
 
@@ -124,6 +134,14 @@ void TgtTranslateStrBuf (StrBuf* Buf)
 void TgtTranslateSet (unsigned Index, unsigned char C)
 /* Set the translation code for the given character */
 {
-    CHECK (Index < sizeof (Tab));
-    Tab[Index] = C;
+    CHECK (Index < sizeof (MutableTab));
+
+    /* The translation tables of the targets are constant, so get a private
+    ** copy before changing an entry.
+    */
+    if (Tab != MutableTab) {
+        memcpy (MutableTab, Tab, sizeof (MutableTab));
+        Tab = MutableTab;
+    }
+    MutableTab[Index] = C;
 }
@@ -7,7 +7,7 @@
 /*                                                                           */
 /*                                                                           */
 /* (C) 2000-2006 Ullrich von Bassewitz                                       */
-/*               R�merstrasse 52                                             */
+/*               R�merstrasse 52                                             */
 /*               D-70794 Filderstadt                                         */
 /* EMail:        uz@cc65.org                                                 */
 /*                                                                           */
@@ -33,6 +33,7 @@
 
 
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -43,12 +44,100 @@
 
 
 
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* Define XMALLOC_STATS when compiling to collect allocation statistics.
+** Every block gets a small header carrying its size, so the current and
+** peak heap usage can be tracked. The statistics are written to stderr at
+** program exit if the debug flag is set (-d or --debug with most tools).
+** Since the headers cost memory for every allocation, this is a compile
+** time option that is disabled by default.
+*/
+#if defined(XMALLOC_STATS)
+
+/* Block header. The union forces the alignment of the user data */
+typedef union BlockHeader BlockHeader;
+union BlockHeader {
+    size_t      Size;           /* Requested size of the block */
+    double      Align;          /* Force maximum alignment */
+};
+
+/* Statistics counters */
+static unsigned long    AllocCount;     /* Number of xmalloc calls */
+static unsigned long    ReallocCount;   /* Number of xrealloc calls */
+static unsigned long    FreeCount;      /* Number of xfree calls */
+static size_t           HeapBytes;      /* Bytes currently allocated */
+static size_t           PeakBytes;      /* High water mark */
+static int              StatsRegistered;/* True if exit handler registered */
+
+#endif
+
+
+
 /*****************************************************************************/
 /*                                   code                                    */
 /*****************************************************************************/
 
 
 
+#if defined(XMALLOC_STATS)
+static void PrintStats (void)
+/* Exit handler that prints the allocation statistics */
+{
+    if (Debug) {
+        fprintf (stderr,
+                 "xmalloc statistics:\n"
+                 "  xmalloc calls:  %10lu\n"
+                 "  xrealloc calls: %10lu\n"
+                 "  xfree calls:    %10lu\n"
+                 "  leaked bytes:   %10lu\n"
+                 "  peak heap:      %10lu\n",
+                 AllocCount, ReallocCount, FreeCount,
+                 (unsigned long) HeapBytes, (unsigned long) PeakBytes);
+    }
+}
+
+
+
+static void RecordBytes (size_t Size)
+/* Account for Size allocated bytes and register the exit handler */
+{
+    HeapBytes += Size;
+    if (HeapBytes > PeakBytes) {
+        PeakBytes = HeapBytes;
+    }
+    if (!StatsRegistered) {
+        StatsRegistered = 1;
+        atexit (PrintStats);
+    }
+}
+#endif
+
+
+
+void xmemreport (FILE* F, const char* Name)
+/* Print one heap usage line for the phase with the given name. The output
+** is one tab separated line: "heap <name> <live bytes> <peak bytes>". The
+** function is a no-op when compiled without XMALLOC_STATS, so the phase
+** timer code in the tools may call it unconditionally.
+*/
+{
+#if defined(XMALLOC_STATS)
+    fprintf (F, "heap\t%s\t%lu\t%lu\n", Name,
+             (unsigned long) HeapBytes, (unsigned long) PeakBytes);
+#else
+    /* Statistics not compiled in, see XMALLOC_STATS above */
+    (void) F;
+    (void) Name;
+#endif
+}
+
+
+
 void* xmalloc (size_t Size)
 /* Allocate memory, check for out of memory condition. Do some debugging */
 {
@@ -57,8 +146,19 @@ void* xmalloc (size_t Size)
     /* Allow zero sized requests and return NULL in this case */
     if (Size) {
 
+#if defined(XMALLOC_STATS)
+        /* Allocate memory including the header */
+        BlockHeader* B = malloc (sizeof (BlockHeader) + Size);
+        if (B) {
+            B->Size = Size;
+            P = B + 1;
+            ++AllocCount;
+            RecordBytes (Size);
+        }
+#else
         /* Allocate memory */
         P = malloc (Size);
+#endif
 
         /* Check for errors */
         if (P == 0) {
@@ -76,6 +176,25 @@ void* xmalloc (size_t Size)
 void* xrealloc (void* P, size_t Size)
 /* Reallocate a memory block, check for out of memory */
 {
+#if defined(XMALLOC_STATS)
+    /* Reallocate the block including its header */
+    BlockHeader* B = (P == 0)? 0 : ((BlockHeader*) P) - 1;
+    BlockHeader* N;
+    if (B) {
+        HeapBytes -= B->Size;
+    }
+    N = realloc (B, (Size == 0)? 0 : sizeof (BlockHeader) + Size);
+    if (N == 0 && Size != 0) {
+        AbEnd ("Out of memory in realloc - requested block size = %lu", (unsigned long) Size);
+    }
+    ++ReallocCount;
+    if (Size == 0) {
+        return 0;
+    }
+    N->Size = Size;
+    RecordBytes (Size);
+    return N + 1;
+#else
     /* Reallocate the block */
     void* N = realloc (P, Size);
 
@@ -86,6 +205,7 @@ void* xrealloc (void* P, size_t Size)
 
     /* Return the pointer to the new block */
     return N;
+#endif
 }
 
 
@@ -93,7 +213,16 @@ void* xrealloc (void* P, size_t Size)
 void xfree (void* Block)
 /* Free the block, do some debugging */
 {
+#if defined(XMALLOC_STATS)
+    if (Block) {
+        BlockHeader* B = ((BlockHeader*) Block) - 1;
+        HeapBytes -= B->Size;
+        ++FreeCount;
+        free (B);
+    }
+#else
     free (Block);
+#endif
 }
 
 
@@ -7,7 +7,7 @@
 /*                                                                           */
 /*                                                                           */
 /* (C) 2000-2006 Ullrich von Bassewitz                                       */
-/*               R�merstra�e 52                                              */
+/*               R�merstra�e 52                                              */
 /*               D-70794 Filderstadt                                         */
 /* EMail:        uz@cc65.org                                                 */
 /*                                                                           */
@@ -39,6 +39,7 @@
 
 
 #include <stddef.h>
+#include <stdio.h>
 
 
 
@@ -48,6 +49,13 @@
 
 
 
+void xmemreport (FILE* F, const char* Name);
+/* Print one heap usage line for the phase with the given name. The output
+** is one tab separated line: "heap <name> <live bytes> <peak bytes>". The
+** function is a no-op when compiled without XMALLOC_STATS, so the phase
+** timer code in the tools may call it unconditionally.
+*/
+
 void* xmalloc (size_t Size);
 /* Allocate memory, check for out of memory condition. Do some debugging */
 
@@ -145,6 +145,35 @@ static void AddPadding (PrintfCtrl* P, char C, unsigned Count)
 
 
 
+static void AddBuf (PrintfCtrl* P, const char* S, size_t Count)
+/* Store a block of characters in the output buffer if there's enough room. */
+{
+    size_t Room = (P->BufFill < P->BufSize)? P->BufSize - P->BufFill : 0;
+    if (Room > Count) {
+        Room = Count;
+    }
+    memcpy (P->Buf, S, Room);
+    P->Buf     += Room;
+    P->BufFill += Count;
+}
+
+
+
+static void AddUnsigned (PrintfCtrl* P, unsigned long Val, unsigned Base,
+                         const char* CharTable)
+/* Output an unsigned value without flags, width or precision */
+{
+    char Buf[32];
+    char* S = Buf + sizeof (Buf);
+    do {
+        *--S = CharTable[Val % Base];
+        Val /= Base;
+    } while (Val != 0);
+    AddBuf (P, S, (size_t) (Buf + sizeof (Buf) - S));
+}
+
+
+
 static intmax_t NextIVal (PrintfCtrl*P)
 /* Read the next integer value from the variable argument list */
 {
@@ -388,8 +417,15 @@ int xvsnprintf (char* Buf, size_t Size, const char* Format, va_list ap)
     while ((F = *Format++) != '\0') {
 
         if (F != '%') {
-            /* Not a format specifier, just copy */
-            AddChar (&P, F);
+            /* Not a format specifier. Copy the whole literal run in one go
+            ** instead of storing it char by char.
+            */
+            const char* S = Format - 1;
+            Format = strchr (Format, '%');
+            if (Format == 0) {
+                Format = S + strlen (S);
+            }
+            AddBuf (&P, S, (size_t) (Format - S));
             continue;
         }
 
@@ -400,6 +436,55 @@ int xvsnprintf (char* Buf, size_t Size, const char* Format, va_list ap)
             continue;
         }
 
+        /* Fast paths for the most common specifiers used without flags,
+        ** width, precision or length modifiers. These make up nearly all
+        ** calls, and skipping the full parser below for them is a big win
+        ** for callers that format many small records.
+        */
+        switch (*Format) {
+
+            case 's':
+                ++Format;
+                SPtr = va_arg (P.ap, const char*);
+                CHECK (SPtr != 0);
+                AddBuf (&P, SPtr, strlen (SPtr));
+                continue;
+
+            case 'c':
+                ++Format;
+                AddChar (&P, (char) va_arg (P.ap, int));
+                continue;
+
+            case 'd':
+            case 'i': {
+                int IVal = va_arg (P.ap, int);
+                ++Format;
+                if (IVal < 0) {
+                    AddChar (&P, '-');
+                    AddUnsigned (&P, -(unsigned long) IVal, 10, "0123456789");
+                } else {
+                    AddUnsigned (&P, (unsigned long) IVal, 10, "0123456789");
+                }
+                continue;
+            }
+
+            case 'u':
+                ++Format;
+                AddUnsigned (&P, va_arg (P.ap, unsigned), 10, "0123456789");
+                continue;
+
+            case 'x':
+                ++Format;
+                AddUnsigned (&P, va_arg (P.ap, unsigned), 16, "0123456789abcdef");
+                continue;
+
+            case 'X':
+                ++Format;
+                AddUnsigned (&P, va_arg (P.ap, unsigned), 16, "0123456789ABCDEF");
+                continue;
+
+        }
+
         /* It's a format specifier. Check for flags. */
         F = *Format++;
         P.Flags = fNone;
@@ -46,7 +46,7 @@
 
 
 /* Attribute table */
-static unsigned short AttrTab[0x10000];
+unsigned short AttrTab[0x10000];
 
 
 
@@ -66,18 +66,6 @@ void AddrCheck (unsigned Addr)
 
 
 
-attr_t GetAttr (unsigned Addr)
-/* Return the attribute for the given address */
-{
-    /* Check the given address */
-    AddrCheck (Addr);
-
-    /* Return the attribute */
-    return AttrTab[Addr];
-}
-
-
-
 int SegmentDefined (unsigned Start, unsigned End)
 /* Return true if the atSegment bit is set somewhere in the given range */
 {
@@ -91,22 +79,6 @@ int SegmentDefined (unsigned Start, unsigned End)
 
 
 
-int IsSegmentEnd (unsigned Addr)
-/* Return true if a segment ends at the given address */
-{
-    return (GetAttr (Addr) & atSegmentEnd) != 0x0000;
-}
-
-
-
-int IsSegmentStart (unsigned Addr)
-/* Return true if a segment starts at the given address */
-{
-    return (GetAttr (Addr) & atSegmentStart) != 0x0000;
-}
-
-
-
 unsigned GetGranularity (attr_t Style)
 /* Get the granularity for the given style */
 {
@@ -134,9 +106,24 @@ unsigned GetGranularity (attr_t Style)
 void MarkRange (unsigned Start, unsigned End, attr_t Attr)
 /* Mark a range with the given attribute */
 {
-    /* Do it easy here... */
-    while (Start <= End) {
-        MarkAddr (Start++, Attr);
+    unsigned Addr;
+
+    /* Check the given addresses once instead of per byte */
+    AddrCheck (Start);
+    AddrCheck (End);
+
+    if (Attr & atStyleMask) {
+        /* We must not have more than one style bit per address */
+        for (Addr = Start; Addr <= End; ++Addr) {
+            if (AttrTab[Addr] & atStyleMask) {
+                Error ("Duplicate style for address %04X", Addr);
+            }
+            AttrTab[Addr] |= Attr;
+        }
+    } else {
+        for (Addr = Start; Addr <= End; ++Addr) {
+            AttrTab[Addr] |= Attr;
+        }
     }
 }
 
@@ -161,24 +148,3 @@ void MarkAddr (unsigned Addr, attr_t Attr)
 
 
 
-attr_t GetStyleAttr (unsigned Addr)
-/* Return the style attribute for the given address */
-{
-    /* Check the given address */
-    AddrCheck (Addr);
-
-    /* Return the attribute */
-    return (AttrTab[Addr] & atStyleMask);
-}
-
-
-
-attr_t GetLabelAttr (unsigned Addr)
-/* Return the label attribute for the given address */
-{
-    /* Check the given address */
-    AddrCheck (Addr);
-
-    /* Return the attribute */
-    return (AttrTab[Addr] & atLabelMask);
-}
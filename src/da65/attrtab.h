@@ -77,6 +77,9 @@ typedef enum attr_t {
     atSegmentStart = 0x0400,    /* Segment start */
 } attr_t;
 
+/* Attribute table */
+extern unsigned short AttrTab[0x10000];
+
 
 
 /*****************************************************************************/
@@ -88,17 +91,22 @@ typedef enum attr_t {
 void AddrCheck (unsigned Addr);
 /* Check if the given address has a valid range */
 
-attr_t GetAttr (unsigned Addr);
+/* The attribute lookups are macros, so the passes don't pay for a function
+** call and a range check per access. Beware: The argument may be evaluated
+** more than once! Addresses wrap at 64K like the CPU address space.
+*/
+
 /* Return the attribute for the given address */
+#define GetAttr(Addr)       ((attr_t) AttrTab[(Addr) & 0xFFFF])
 
 int SegmentDefined (unsigned Start, unsigned End);
 /* Return true if the atSegment bit is set somewhere in the given range */
 
-int IsSegmentEnd (unsigned Addr);
 /* Return true if a segment ends at the given address */
+#define IsSegmentEnd(Addr)   ((GetAttr (Addr) & atSegmentEnd) != 0x0000)
 
-int IsSegmentStart (unsigned Addr);
 /* Return true if a segment starts at the given address */
+#define IsSegmentStart(Addr) ((GetAttr (Addr) & atSegmentStart) != 0x0000)
 
 unsigned GetGranularity (attr_t Style);
 /* Get the granularity for the given style */
@@ -109,11 +117,11 @@ void MarkRange (unsigned Start, unsigned End, attr_t Attr);
 void MarkAddr (unsigned Addr, attr_t Attr);
 /* Mark an address with an attribute */
 
-attr_t GetStyleAttr (unsigned Addr);
 /* Return the style attribute for the given address */
+#define GetStyleAttr(Addr)  ((attr_t) (AttrTab[(Addr) & 0xFFFF] & atStyleMask))
 
-attr_t GetLabelAttr (unsigned Addr);
 /* Return the label attribute for the given address */
+#define GetLabelAttr(Addr)  ((attr_t) (AttrTab[(Addr) & 0xFFFF] & atLabelMask))
 
 
 
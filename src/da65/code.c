@@ -155,45 +155,6 @@ void LoadCode (void)
 
 
 
-unsigned char GetCodeByte (unsigned Addr)
-/* Get a byte from the given address */
-{
-    PRECONDITION (Addr <= CodeEnd);
-    return CodeBuf [Addr];
-}
-
-
-
-unsigned GetCodeDByte (unsigned Addr)
-/* Get a dbyte from the given address */
-{
-    unsigned Lo = GetCodeByte (Addr);
-    unsigned Hi = GetCodeByte (Addr+1);
-    return (Lo <<8) | Hi;
-}
-
-
-
-unsigned GetCodeWord (unsigned Addr)
-/* Get a word from the given address */
-{
-    unsigned Lo = GetCodeByte (Addr);
-    unsigned Hi = GetCodeByte (Addr+1);
-    return Lo | (Hi << 8);
-}
-
-
-
-unsigned long GetCodeDWord (unsigned Addr)
-/* Get a dword from the given address */
-{
-    unsigned long Lo = GetCodeWord (Addr);
-    unsigned long Hi = GetCodeWord (Addr+2);
-    return Lo | (Hi << 16);
-}
-
-
-
 unsigned GetRemainingBytes (void)
 /* Return the number of remaining code bytes */
 {
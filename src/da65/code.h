@@ -7,7 +7,7 @@
 /*                                                                           */
 /*                                                                           */
 /* (C) 2000-2003 Ullrich von Bassewitz                                       */
-/*               R�merstrasse 52                                             */
+/*               R�merstrasse 52                                             */
 /*               D-70794 Filderstadt                                         */
 /* EMail:        uz@cc65.org                                                 */
 /*                                                                           */
@@ -60,17 +60,25 @@ extern unsigned long PC;                        /* Current PC */
 void LoadCode (void);
 /* Load the code from the given file */
 
-unsigned char GetCodeByte (unsigned Addr);
+/* The code accessors are macros, so the passes don't pay for a function
+** call per byte. Beware: The argument may be evaluated more than once!
+** Addresses wrap at 64K like the CPU address space.
+*/
+
 /* Get a byte from the given address */
+#define GetCodeByte(Addr)   (CodeBuf[(Addr) & 0xFFFF])
 
-unsigned GetCodeDByte (unsigned Addr);
 /* Get a dbyte from the given address */
+#define GetCodeDByte(Addr)  (((unsigned) GetCodeByte (Addr) << 8) |     \
+                             (unsigned) GetCodeByte ((Addr)+1))
 
-unsigned GetCodeWord (unsigned Addr);
 /* Get a word from the given address */
+#define GetCodeWord(Addr)   ((unsigned) GetCodeByte (Addr) |            \
+                             ((unsigned) GetCodeByte ((Addr)+1) << 8))
 
-unsigned long GetCodeDWord (unsigned Addr);
 /* Get a dword from the given address */
+#define GetCodeDWord(Addr)  ((unsigned long) GetCodeWord (Addr) |       \
+                             ((unsigned long) GetCodeWord ((Addr)+2) << 16))
 
 unsigned GetRemainingBytes (void);
 /* Return the number of remaining code bytes */
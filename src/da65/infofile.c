@@ -59,6 +59,7 @@
 #include "opctable.h"
 #include "scanner.h"
 #include "segment.h"
+#include "trace.h"
 #include "handler.h"
 
 
@@ -373,6 +374,64 @@ static void GlobalSection (void)
 
 
 
+static void EntrySection (void)
+/* Parse an entry section */
+{
+    static const IdentTok EntryDefs[] = {
+        {   "ADDR",         INFOTOK_ADDR        },
+    };
+
+    /* Locals - initialize to avoid gcc warnings */
+    long Value = -1;
+
+    /* Skip the token */
+    InfoNextTok ();
+
+    /* Expect the opening curly brace */
+    InfoConsumeLCurly ();
+
+    /* Look for section tokens */
+    while (InfoTok != INFOTOK_RCURLY) {
+
+        /* Convert to special token */
+        InfoSpecialToken (EntryDefs, ENTRY_COUNT (EntryDefs), "Entry attribute");
+
+        /* Look at the token */
+        switch (InfoTok) {
+
+            case INFOTOK_ADDR:
+                InfoNextTok ();
+                if (Value >= 0) {
+                    InfoError ("Value already given");
+                }
+                InfoAssureInt ();
+                InfoRangeCheck (0, 0xFFFF);
+                Value = InfoIVal;
+                InfoNextTok ();
+                break;
+
+            default:
+                Internal ("Unexpected token: %u", InfoTok);
+        }
+
+        /* Directive is followed by a semicolon */
+        InfoConsumeSemi ();
+    }
+
+    /* Did we get the necessary data */
+    if (Value < 0) {
+        InfoError ("Entry address is missing");
+    }
+
+    /* Remember the entry point for code flow tracing */
+    AddEntryPoint ((unsigned) Value);
+
+    /* Consume the closing brace */
+    InfoConsumeRCurly ();
+}
+
+
+
 static void LabelSection (void)
 /* Parse a label section */
 {
@@ -791,6 +850,7 @@ static void InfoParse (void)
 {
     static const IdentTok Globals[] = {
         {   "ASMINC",   INFOTOK_ASMINC  },
+        {   "ENTRY",    INFOTOK_ENTRY   },
         {   "GLOBAL",   INFOTOK_GLOBAL  },
         {   "LABEL",    INFOTOK_LABEL   },
         {   "RANGE",    INFOTOK_RANGE   },
@@ -809,6 +869,10 @@ static void InfoParse (void)
                 AsmIncSection ();
                 break;
 
+            case INFOTOK_ENTRY:
+                EntrySection ();
+                break;
+
             case INFOTOK_GLOBAL:
                 GlobalSection ();
                 break;
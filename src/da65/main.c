@@ -61,6 +61,7 @@
 #include "output.h"
 #include "scanner.h"
 #include "segment.h"
+#include "trace.h"
 
 
 
@@ -665,6 +666,13 @@ int main (int argc, char* argv [])
     /* Load the input file */
     LoadCode ();
 
+    /* If the info file defined entry points, trace the code flow from them
+    ** and treat everything that was not reached as data.
+    */
+    if (HaveEntryPoints ()) {
+        TraceCode ();
+    }
+
     /* Open the output file */
     OpenOutput (OutFile);
 
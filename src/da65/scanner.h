@@ -66,6 +66,7 @@ typedef enum token_t {
     INFOTOK_LABEL,
     INFOTOK_ASMINC,
     INFOTOK_SEGMENT,
+    INFOTOK_ENTRY,
 
     /* Global section */
     INFOTOK_ARGUMENT_COLUMN,
@@ -0,0 +1,239 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                  trace.c                                  */
+/*                                                                           */
+/*                Code flow tracing for the da65 disassembler                */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* (C) 1998-2014, Ullrich von Bassewitz                                      */
+/*                Roemerstrasse 52                                           */
+/*                D-70794 Filderstadt                                        */
+/* EMail:         uz@cc65.org                                                */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#include <string.h>
+
+/* common */
+#include "xmalloc.h"
+
+/* da65 */
+#include "attrtab.h"
+#include "code.h"
+#include "handler.h"
+#include "opctable.h"
+#include "trace.h"
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* Worklist with addresses that are reachable but not yet traced. The entry
+** points from the info file are its initial contents.
+*/
+static unsigned*        Work      = 0;
+static unsigned         WorkCount = 0;
+static unsigned         WorkSize  = 0;
+
+/* Number of entry points given in the info file */
+static unsigned         EntryCount = 0;
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+static void PushAddr (unsigned Addr)
+/* Add an address to the worklist */
+{
+    /* Grow the worklist if needed */
+    if (WorkCount >= WorkSize) {
+        WorkSize = (WorkSize == 0)? 64 : WorkSize * 2;
+        Work = xrealloc (Work, WorkSize * sizeof (Work[0]));
+    }
+
+    /* Add the address */
+    Work[WorkCount++] = Addr;
+}
+
+
+
+void AddEntryPoint (unsigned Addr)
+/* Remember an entry point for code flow tracing */
+{
+    PushAddr (Addr);
+    ++EntryCount;
+}
+
+
+
+int HaveEntryPoints (void)
+/* Return true if at least one entry point was given */
+{
+    return EntryCount > 0;
+}
+
+
+
+void TraceCode (void)
+/* Trace the code flow from all entry points, marking reached bytes as code.
+** Bytes that are neither reached nor covered by an explicit range are
+** marked as data.
+*/
+{
+    unsigned Addr;
+
+    while (WorkCount > 0) {
+
+        /* Get the next address from the worklist */
+        Addr = Work[--WorkCount];
+
+        /* Follow the code flow starting at this address. Tracing ends when
+        ** it runs out of the loaded code or into an address that already
+        ** has a style - either one declared in the info file or code
+        ** reached on another path.
+        */
+        while (Addr >= CodeStart && Addr <= CodeEnd &&
+               GetStyleAttr (Addr) == atDefault) {
+
+            unsigned I;
+
+            /* Get the opcode description */
+            const OpcDesc* D = &OpcTable[GetCodeByte (Addr)];
+
+            /* Instructions that are invalid for the selected CPU end the
+            ** flow. The same is done for brk and stp, which are usually
+            ** found in padding areas, not in real code.
+            */
+            if ((D->Flags & flIllegal) != 0    ||
+                strcmp (D->Mnemo, "brk") == 0  ||
+                strcmp (D->Mnemo, "stp") == 0) {
+                break;
+            }
+
+            /* The instruction must fit into the loaded code, and its
+            ** operand bytes must not reach into an area that already has
+            ** a style.
+            */
+            if (Addr + D->Size - 1 > CodeEnd) {
+                break;
+            }
+            for (I = 1; I < D->Size; ++I) {
+                if (GetStyleAttr (Addr + I) != atDefault) {
+                    break;
+                }
+            }
+            if (I < D->Size) {
+                break;
+            }
+
+            /* Mark the instruction bytes as code */
+            MarkRange (Addr, Addr + D->Size - 1, atCode);
+
+            /* Follow the control flow of the instruction. The handler in
+            ** the opcode description tells us the addressing mode, which
+            ** in turn tells us where execution may continue.
+            */
+            if (D->Handler == OH_Rts) {
+
+                /* rts/rti: The flow ends here */
+                break;
+
+            } else if (D->Handler == OH_JmpAbsoluteIndirect  ||
+                       D->Handler == OH_JmpAbsoluteXIndirect ||
+                       D->Handler == OH_JmpDirectIndirect) {
+
+                /* Indirect jump: The target is unknown */
+                break;
+
+            } else if (D->Handler == OH_JmpAbsolute) {
+
+                /* Continue tracing at the jump target */
+                Addr = GetCodeWord (Addr+1);
+
+            } else if (D->Handler == OH_JsrAbsolute) {
+
+                /* Trace the subroutine, then continue behind the call */
+                PushAddr (GetCodeWord (Addr+1));
+                Addr += D->Size;
+
+            } else if (D->Handler == OH_Relative) {
+
+                /* Trace the branch target. All branches except bra are
+                ** conditional, so the flow continues behind them.
+                */
+                PushAddr ((((int) Addr + 2) + (signed char) GetCodeByte (Addr+1)) & 0xFFFF);
+                if (strcmp (D->Mnemo, "bra") == 0) {
+                    break;
+                }
+                Addr += D->Size;
+
+            } else if (D->Handler == OH_RelativeLong4510) {
+
+                /* Long branches of the 4510. bsr is a call and lbra is
+                ** unconditional, the others are conditional branches.
+                */
+                PushAddr ((((int) Addr + 2) + (signed short) GetCodeWord (Addr+1)) & 0xFFFF);
+                if (strcmp (D->Mnemo, "lbra") == 0) {
+                    break;
+                }
+                Addr += D->Size;
+
+            } else if (D->Handler == OH_BitBranch) {
+
+                /* bbr/bbs: Conditional branch on a zero page bit */
+                PushAddr ((((int) Addr + 3) + (signed char) GetCodeByte (Addr+2)) & 0xFFFF);
+                Addr += D->Size;
+
+            } else if (D->Handler == OH_AccumulatorBitBranch) {
+
+                /* bbc/bbs of the m740: Conditional branch on an accu bit */
+                PushAddr ((((int) Addr + 3) + (signed char) GetCodeByte (Addr+1)) & 0xFFFF);
+                Addr += D->Size;
+
+            } else {
+
+                /* All other instructions continue with the next one */
+                Addr += D->Size;
+
+            }
+        }
+    }
+
+    /* Everything that was not reached and has no style from the info file
+    ** is data.
+    */
+    for (Addr = CodeStart; Addr <= CodeEnd; ++Addr) {
+        if (GetStyleAttr (Addr) == atDefault) {
+            MarkAddr (Addr, atByteTab);
+        }
+    }
+}
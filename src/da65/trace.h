@@ -0,0 +1,63 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                  trace.h                                  */
+/*                                                                           */
+/*                Code flow tracing for the da65 disassembler                */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* (C) 1998-2014, Ullrich von Bassewitz                                      */
+/*                Roemerstrasse 52                                           */
+/*                D-70794 Filderstadt                                        */
+/* EMail:         uz@cc65.org                                                */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#ifndef TRACE_H
+#define TRACE_H
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+void AddEntryPoint (unsigned Addr);
+/* Remember an entry point for code flow tracing */
+
+int HaveEntryPoints (void);
+/* Return true if at least one entry point was given */
+
+void TraceCode (void);
+/* Trace the code flow from all entry points, marking reached bytes as code.
+** Bytes that are neither reached nor covered by an explicit range are
+** marked as data.
+*/
+
+
+
+/* End of trace.h */
+
+#endif
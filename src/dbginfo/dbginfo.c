@@ -226,7 +226,9 @@ struct InputData {
     cc65_line           SLine;          /* Line number at start of token */
     unsigned            SCol;           /* Column number at start of token */
     unsigned            Errors;         /* Number of errors */
-    FILE*               F;              /* Input file */
+    const char*         Buf;            /* Contents of input file */
+    size_t              Size;           /* Size of the input file */
+    size_t              Pos;            /* Read position in Buf */
     int                 C;              /* Input character */
     Token               Tok;            /* Token from input stream */
     unsigned long       IVal;           /* Integer constant */
@@ -2511,7 +2513,11 @@ static void NextChar (InputData* D)
             ++D->Line;
             D->Col = 0;
         }
-        D->C = fgetc (D->F);
+        if (D->Pos < D->Size) {
+            D->C = (unsigned char) D->Buf[D->Pos++];
+        } else {
+            D->C = EOF;
+        }
         ++D->Col;
     }
 }
@@ -5597,15 +5603,23 @@ cc65_dbginfo cc65_read_dbginfo (const char* FileName, cc65_errorfunc ErrFunc)
 ** read successfully, NULL is returned.
 */
 {
+    FILE*  F;
+    char*  Buf;
+    size_t Allocated;
+    size_t Size;
+    size_t BytesRead;
+
     /* Data structure used to control scanning and parsing */
     InputData D = {
         0,                      /* Name of input file */
         1,                      /* Line number */
-        0,                      /* Input file */
+        0,                      /* Column number */
         0,                      /* Line at start of current token */
         0,                      /* Column at start of current token */
         0,                      /* Number of errors */
-        0,                      /* Input file */
+        0,                      /* Contents of input file */
+        0,                      /* Size of the input file */
+        0,                      /* Read position in Buf */
         ' ',                    /* Input character */
         TOK_INVALID,            /* Input token */
         0,                      /* Integer constant */
@@ -5617,8 +5631,8 @@ cc65_dbginfo cc65_read_dbginfo (const char* FileName, cc65_errorfunc ErrFunc)
     D.Error    = ErrFunc;
 
     /* Open the input file */
-    D.F = fopen (FileName, "rt");
-    if (D.F == 0) {
+    F = fopen (FileName, "rt");
+    if (F == 0) {
         /* Cannot open */
         ParseError (&D, CC65_ERROR,
                     "Cannot open input file \"%s\": %s",
@@ -5626,6 +5640,36 @@ cc65_dbginfo cc65_read_dbginfo (const char* FileName, cc65_errorfunc ErrFunc)
         return 0;
     }
 
+    /* Read the file into memory. Scanning a memory buffer is a lot faster
+    ** than reading the file character by character using the stdio
+    ** functions.
+    */
+    Allocated = 0x10000;
+    Buf       = xmalloc (Allocated);
+    Size      = 0;
+    while ((BytesRead = fread (Buf + Size, 1, Allocated - Size, F)) > 0) {
+        Size += BytesRead;
+        if (Size == Allocated) {
+            Allocated *= 2;
+            Buf = xrealloc (Buf, Allocated);
+        }
+    }
+    if (ferror (F)) {
+        ParseError (&D, CC65_ERROR,
+                    "Error reading input file \"%s\": %s",
+                    FileName, strerror (errno));
+        fclose (F);
+        xfree (Buf);
+        return 0;
+    }
+
+    /* The file is completely in memory now, so close it and parse the
+    ** buffer.
+    */
+    fclose (F);
+    D.Buf  = Buf;
+    D.Size = Size;
+
     /* Create a new debug info struct */
     D.Info = NewDbgInfo (FileName);
 
@@ -5746,8 +5790,8 @@ cc65_dbginfo cc65_read_dbginfo (const char* FileName, cc65_errorfunc ErrFunc)
     }
 
 CloseAndExit:
-    /* Close the file */
-    fclose (D.F);
+    /* Free the memory holding the file contents */
+    xfree (Buf);
 
     /* Free memory allocated for SVal */
     SB_Done (&D.SVal);
@@ -6526,6 +6570,70 @@ const cc65_spaninfo* cc65_span_byaddr (cc65_dbginfo Handle, unsigned long Addr)
 
 
 
+const cc65_spaninfo* cc65_span_byaddrs (cc65_dbginfo Handle,
+                                        const cc65_addr* Addrs,
+                                        unsigned Count)
+/* Return span information for a list of addresses in one call. The spans
+** for each address are returned in the order of the addresses given, so
+** the caller can match them using their start and end addresses. Addresses
+** not covered by a span contribute no entries. The function returns NULL
+** if no spans were found at all.
+*/
+{
+    const DbgInfo*      Info;
+    cc65_spaninfo*      D;
+    unsigned            Total;
+    unsigned            Next;
+    unsigned            I, J;
+
+    /* Check the parameters */
+    assert (Handle != 0);
+    assert (Addrs != 0 || Count == 0);
+
+    /* The handle is actually a pointer to a debug info struct */
+    Info = Handle;
+
+    /* First pass: Count the spans for all addresses, so the result can be
+    ** allocated in one chunk.
+    */
+    Total = 0;
+    for (I = 0; I < Count; ++I) {
+        const SpanInfoListEntry* E = FindSpanInfoByAddr (&Info->SpanInfoByAddr, Addrs[I]);
+        if (E != 0) {
+            Total += E->Count;
+        }
+    }
+
+    /* Bail out if we have no spans at all */
+    if (Total == 0) {
+        return 0;
+    }
+
+    /* Prepare the struct we will return to the caller */
+    D = new_cc65_spaninfo (Total);
+
+    /* Second pass: Fill in the data */
+    Next = 0;
+    for (I = 0; I < Count; ++I) {
+        const SpanInfoListEntry* E = FindSpanInfoByAddr (&Info->SpanInfoByAddr, Addrs[I]);
+        if (E == 0) {
+            continue;
+        }
+        if (E->Count == 1) {
+            CopySpanInfo (D->data + Next++, E->Data);
+        } else {
+            for (J = 0; J < E->Count; ++J) {
+                CopySpanInfo (D->data + Next++, ((SpanInfo**) E->Data)[J]);
+            }
+        }
+    }
+
+    /* Return the struct we've created */
+    return D;
+}
+
+
+
 const cc65_spaninfo* cc65_span_byline (cc65_dbginfo Handle, unsigned LineId)
 /* Return span information for the given source line. The function returns NULL
 ** if the line id is invalid, otherwise the spans for this line (possibly zero).
@@ -371,6 +371,16 @@ const cc65_spaninfo* cc65_span_byaddr (cc65_dbginfo handle,
 ** if no spans were found for this address.
 */
 
+const cc65_spaninfo* cc65_span_byaddrs (cc65_dbginfo handle,
+                                        const cc65_addr* addrs,
+                                        unsigned count);
+/* Return span information for a list of addresses in one call. The spans
+** for each address are returned in the order of the addresses given, so
+** the caller can match them using their start and end addresses. Addresses
+** not covered by a span contribute no entries. The function returns NULL
+** if no spans were found at all.
+*/
+
 const cc65_spaninfo* cc65_span_byline (cc65_dbginfo handle, unsigned line_id);
 /* Return span information for the given source line. The function returns NULL
 ** if the line id is invalid, otherwise the spans for this line (possibly zero).
@@ -45,6 +45,7 @@
 #include "chartype.h"
 #include "cmdline.h"
 #include "coll.h"
+#include "xmalloc.h"
 
 /* dbginfo */
 #include "dbginfo.h"
@@ -57,12 +58,24 @@
 
 
 
+static void CmdAddr (Collection* Args);
+/* Map code addresses to symbols */
+
+static void CmdBatch (Collection* Args);
+/* Execute commands from a file */
+
+static void CmdCoverage (Collection* Args);
+/* Report per line coverage from a sim65 coverage bitmap */
+
 static void CmdHelp (Collection* Args attribute ((unused)));
 /* Output a help text */
 
 static void CmdLoad (Collection* Args);
 /* Load a debug info file */
 
+static void CmdProfile (Collection* Args);
+/* Map an execution profile to symbols */
+
 static void CmdQuit (Collection* Args attribute ((unused)));
 /* Terminate the application */
 
@@ -162,6 +175,21 @@ struct CmdEntry {
 /* Table with main commands */
 static const CmdEntry MainCmds[] = {
     {
+        "addr",
+        "Map code addresses to symbol and offset. Output is tab separated.",
+        -2,
+        CmdAddr
+    }, {
+        "batch",
+        "Execute commands from a file. Use '-' to read from stdin.",
+        2,
+        CmdBatch
+    }, {
+        "coverage",
+        "Report per line coverage from a sim65 coverage bitmap.",
+        2,
+        CmdCoverage
+    }, {
         "exit",
         0,
         1,
@@ -176,6 +204,11 @@ static const CmdEntry MainCmds[] = {
         "Load a debug info file",
         2,
         CmdLoad
+    }, {
+        "profile",
+        "Map a sim65 execution profile to symbols",
+        2,
+        CmdProfile
     }, {
         "quit",
         "Terminate the shell",
@@ -911,10 +944,106 @@ ExitPoint:
 
 
 
+/* One entry in the label index used for address queries */
+typedef struct AddrSym AddrSym;
+struct AddrSym {
+    const char*         Name;           /* Name of the label */
+    long                Value;          /* Address of the label */
+};
+
+/* The label index, sorted by address. It is built once on the first address
+** query and reused by all following ones. The symbol list is kept since the
+** index contains pointers to the names.
+*/
+static const cc65_symbolinfo* AddrSymInfo = 0;
+static AddrSym*         AddrIndex      = 0;
+static unsigned         AddrIndexCount = 0;
+
+
+
+static int CmpAddrSym (const void* L, const void* R)
+/* qsort helper that compares two AddrSym entries by address */
+{
+    long Left  = ((const AddrSym*) L)->Value;
+    long Right = ((const AddrSym*) R)->Value;
+    return (Left > Right) - (Left < Right);
+}
+
+
+
+static void FreeAddrIndex (void)
+/* Free the label index. Must be called before the file is unloaded. */
+{
+    if (AddrIndex) {
+        xfree (AddrIndex);
+        AddrIndex      = 0;
+        AddrIndexCount = 0;
+        cc65_free_symbolinfo (Info, AddrSymInfo);
+        AddrSymInfo    = 0;
+    }
+}
+
+
+
+static int BuildAddrIndex (void)
+/* Build the label index if it doesn't exist. Return true if the index is
+** available, return false and print a diagnostic if not.
+*/
+{
+    unsigned I;
+
+    /* Nothing to do if the index exists */
+    if (AddrIndex) {
+        return 1;
+    }
+
+    /* Fetch all labels */
+    AddrSymInfo = cc65_symbol_inrange (Info, 0, 0xFFFF);
+    if (AddrSymInfo == 0 || AddrSymInfo->count == 0) {
+        PrintLine ("Debug info file contains no labels");
+        return 0;
+    }
+
+    /* Build a table of labels sorted by address */
+    AddrIndexCount = AddrSymInfo->count;
+    AddrIndex = xmalloc (AddrIndexCount * sizeof (*AddrIndex));
+    for (I = 0; I < AddrIndexCount; ++I) {
+        AddrIndex[I].Name  = AddrSymInfo->data[I].symbol_name;
+        AddrIndex[I].Value = AddrSymInfo->data[I].symbol_value;
+    }
+    qsort (AddrIndex, AddrIndexCount, sizeof (*AddrIndex), CmpAddrSym);
+
+    /* Ok */
+    return 1;
+}
+
+
+
+static const AddrSym* FindAddrSym (long Addr)
+/* Search the label index for the closest label at or below the given
+** address. Returns the label or NULL if there is none.
+*/
+{
+    unsigned Lo = 0;
+    unsigned Hi = AddrIndexCount;
+    while (Lo < Hi) {
+        unsigned Mid = (Lo + Hi) / 2;
+        if (AddrIndex[Mid].Value <= Addr) {
+            Lo = Mid + 1;
+        } else {
+            Hi = Mid;
+        }
+    }
+    return (Lo > 0)? AddrIndex + (Lo - 1) : 0;
+}
+
+
+
 static void UnloadFile (void)
 /* Unload the debug info file */
 {
     if (Info) {
+        FreeAddrIndex ();
         cc65_free_dbginfo (Info);
         Info = 0;
     }
@@ -956,6 +1085,243 @@ static int FileIsLoaded (void)
 
 
 
+static int Parse (char* CmdLine, Collection* Args);
+/* Parse the command line and store the arguments in Args. Return true if ok,
+** false on error.
+*/
+
+
+
+static void CmdAddr (Collection* Args)
+/* Map code addresses to the closest label at or below them. One line is
+** output per address, containing the address, the label and the offset of
+** the address from the label, separated by tabs. Addresses without a label
+** get a question mark instead. The format is meant to be processed by other
+** programs, which feed the addresses in via the batch command.
+*/
+{
+    unsigned I;
+
+    /* Be sure a file is loaded */
+    if (!FileIsLoaded ()) {
+        return;
+    }
+
+    /* Be sure the label index exists */
+    if (!BuildAddrIndex ()) {
+        return;
+    }
+
+    /* Map all arguments */
+    for (I = 0; I < CollCount (Args); ++I) {
+
+        /* Parse the argument. Allow '$' and '0x' prefixes for hex numbers,
+        ** anything without a prefix is hex, too, since that is what address
+        ** dumps usually contain.
+        */
+        const char* Arg = CollConstAt (Args, I);
+        unsigned long Addr;
+        char C;
+        if (*Arg == '$') {
+            ++Arg;
+        }
+        if (sscanf (Arg, "%lx%c", &Addr, &C) != 1) {
+            PrintLine ("Invalid address '%s'", (const char*) CollConstAt (Args, I));
+            continue;
+        }
+
+        /* Search for the label and output the result */
+        {
+            const AddrSym* S = FindAddrSym ((long) Addr);
+            if (S) {
+                PrintLine ("$%04lX\t%s\t%lu", Addr, S->Name, Addr - (unsigned long) S->Value);
+            } else {
+                PrintLine ("$%04lX\t?\t0", Addr);
+            }
+        }
+    }
+}
+
+
+
+static void CmdBatch (Collection* Args)
+/* Execute commands from a file. Empty lines are ignored, the commands are
+** the ones known from interactive mode, but no prompt is output. A file
+** named '-' reads from stdin, so queries may be piped into the shell.
+*/
+{
+    char Input[256];
+    Collection BatchArgs = STATIC_COLLECTION_INITIALIZER;
+    FILE* F;
+
+    /* Open the input file */
+    const char* Name = CollAt (Args, 0);
+    if (strcmp (Name, "-") == 0) {
+        F = stdin;
+    } else {
+        F = fopen (Name, "r");
+        if (F == 0) {
+            PrintLine ("Cannot open '%s': %s", Name, strerror (errno));
+            return;
+        }
+    }
+
+    /* Read and execute the commands */
+    while (!Terminate && fgets (Input, sizeof (Input), F) != 0) {
+
+        /* Parse the command line */
+        if (Parse (Input, &BatchArgs) == 0 || CollCount (&BatchArgs) == 0) {
+            continue;
+        }
+
+        /* Search for the command, check number of args, then execute it */
+        ExecCmd (&BatchArgs, MainCmds, sizeof (MainCmds) / sizeof (MainCmds[0]));
+    }
+
+    /* Close the file and free the arguments */
+    if (F != stdin) {
+        fclose (F);
+    }
+    DoneCollection (&BatchArgs);
+}
+
+
+
+static void CmdCoverage (Collection* Args)
+/* Join a coverage bitmap written by the sim65 --coverage option against the
+** line and span tables of the debug info file and report per line coverage.
+** One tab separated record is output for every source line that owns code:
+**
+**      line <TAB> source file <TAB> line number <TAB> 0 or 1
+**
+** where 1 means the line was executed. Each source file is followed by a
+** summary record:
+**
+**      file <TAB> source file <TAB> covered lines <TAB> lines with code
+*/
+{
+    unsigned char Bitmap[0x10000 / 8];
+    const cc65_sourceinfo* Sources;
+    FILE* F;
+    unsigned I;
+
+    /* Be sure a file is loaded */
+    if (!FileIsLoaded ()) {
+        return;
+    }
+
+    /* Read the coverage bitmap */
+    F = fopen (CollAt (Args, 0), "rb");
+    if (F == 0) {
+        PrintLine ("Cannot open '%s': %s", (const char*) CollAt (Args, 0),
+                   strerror (errno));
+        return;
+    }
+    if (fread (Bitmap, 1, sizeof (Bitmap), F) != sizeof (Bitmap)) {
+        PrintLine ("'%s' is not a coverage bitmap", (const char*) CollAt (Args, 0));
+        fclose (F);
+        return;
+    }
+    fclose (F);
+
+    /* Fetch the list of source files */
+    Sources = cc65_get_sourcelist (Info);
+    if (Sources == 0) {
+        return;
+    }
+
+    /* Walk over all source files */
+    for (I = 0; I < Sources->count; ++I) {
+
+        const cc65_sourcedata* Source = Sources->data + I;
+        const cc65_lineinfo* L;
+        unsigned char* State;
+        cc65_line MaxLine = 0;
+        cc65_line Line;
+        unsigned long Covered = 0;
+        unsigned long Total   = 0;
+        unsigned J;
+
+        /* Fetch the lines of this file */
+        L = cc65_line_bysource (Info, Source->source_id);
+        if (L == 0 || L->count == 0) {
+            if (L) {
+                cc65_free_lineinfo (Info, L);
+            }
+            continue;
+        }
+
+        /* Find the highest line number. There may be more than one line
+        ** record per source line, so the results are accumulated per source
+        ** line before they're output.
+        */
+        for (J = 0; J < L->count; ++J) {
+            if (L->data[J].source_line > MaxLine) {
+                MaxLine = L->data[J].source_line;
+            }
+        }
+
+        /* Per line state: 0 = no code, 1 = has code, 2 = code was executed */
+        State = xmalloc (MaxLine + 1);
+        memset (State, 0, MaxLine + 1);
+
+        /* Check the spans of each line record against the bitmap */
+        for (J = 0; J < L->count; ++J) {
+
+            const cc65_spaninfo* S = cc65_span_byline (Info, L->data[J].line_id);
+            unsigned K;
+            if (S == 0) {
+                continue;
+            }
+
+            Line = L->data[J].source_line;
+            for (K = 0; K < S->count; ++K) {
+                cc65_addr Addr;
+                if (State[Line] == 0) {
+                    State[Line] = 1;
+                }
+                for (Addr = S->data[K].span_start;
+                     Addr <= S->data[K].span_end && Addr <= 0xFFFF;
+                     ++Addr) {
+                    if (Bitmap[Addr >> 3] & (0x01 << (Addr & 0x07))) {
+                        State[Line] = 2;
+                        break;
+                    }
+                }
+            }
+            cc65_free_spaninfo (Info, S);
+        }
+
+        /* Output the per line records followed by the file summary */
+        for (Line = 1; Line <= MaxLine; ++Line) {
+            if (State[Line] == 0) {
+                continue;
+            }
+            ++Total;
+            if (State[Line] == 2) {
+                ++Covered;
+            }
+            PrintLine ("line\t%s\t%lu\t%c",
+                       Source->source_name,
+                       (unsigned long) Line,
+                       (State[Line] == 2)? '1' : '0');
+        }
+        if (Total > 0) {
+            PrintLine ("file\t%s\t%lu\t%lu",
+                       Source->source_name, Covered, Total);
+        }
+
+        /* Free the allocated data */
+        xfree (State);
+        cc65_free_lineinfo (Info, L);
+    }
+
+    /* Free the source file list */
+    cc65_free_sourceinfo (Info, Sources);
+}
+
+
+
 static void CmdHelp (Collection* Args attribute ((unused)))
 /* Output a help text */
 {
@@ -989,6 +1355,111 @@ static void CmdLoad (Collection* Args)
 
 
 
+/* One entry in the symbol table used for profile mapping */
+typedef struct ProfSym ProfSym;
+struct ProfSym {
+    const char*         Name;           /* Name of the label */
+    long                Value;          /* Address of the label */
+    unsigned long       Cycles;         /* Accumulated cycles */
+};
+
+static int CmpProfSymValue (const void* L, const void* R)
+/* qsort helper that compares two ProfSym entries by address */
+{
+    long Left  = ((const ProfSym*) L)->Value;
+    long Right = ((const ProfSym*) R)->Value;
+    return (Left > Right) - (Left < Right);
+}
+
+static int CmpProfSymCycles (const void* L, const void* R)
+/* qsort helper that compares two ProfSym entries by cycles, descending */
+{
+    unsigned long Left  = ((const ProfSym*) L)->Cycles;
+    unsigned long Right = ((const ProfSym*) R)->Cycles;
+    return (Left < Right) - (Left > Right);
+}
+
+static void CmdProfile (Collection* Args)
+/* Map an execution profile to symbols. Read the address/cycle pairs written
+** by the sim65 --profile option, attribute the cycles of each address to the
+** closest label at or below it, and print the per label cycle counts.
+*/
+{
+    const cc65_symbolinfo* S;
+    ProfSym* Syms;
+    unsigned Count;
+    unsigned I;
+    FILE* F;
+    unsigned long Addr;
+    unsigned long Cycles;
+
+    /* Be sure a file is loaded */
+    if (!FileIsLoaded ()) {
+        return;
+    }
+
+    /* Fetch all labels */
+    S = cc65_symbol_inrange (Info, 0, 0xFFFF);
+    if (S == 0 || S->count == 0) {
+        PrintLine ("Debug info file contains no labels");
+        return;
+    }
+
+    /* Build a table of labels sorted by address */
+    Count = S->count;
+    Syms = xmalloc (Count * sizeof (*Syms));
+    for (I = 0; I < Count; ++I) {
+        Syms[I].Name   = S->data[I].symbol_name;
+        Syms[I].Value  = S->data[I].symbol_value;
+        Syms[I].Cycles = 0;
+    }
+    qsort (Syms, Count, sizeof (*Syms), CmpProfSymValue);
+
+    /* Open the profile dump */
+    F = fopen (CollAt (Args, 0), "r");
+    if (F == 0) {
+        PrintLine ("Cannot open '%s': %s", (const char*) CollAt (Args, 0),
+                   strerror (errno));
+        xfree (Syms);
+        cc65_free_symbolinfo (Info, S);
+        return;
+    }
+
+    /* Attribute each address to the closest label at or below it */
+    while (fscanf (F, "%lx %lu", &Addr, &Cycles) == 2) {
+        unsigned Lo = 0;
+        unsigned Hi = Count;
+        while (Lo < Hi) {
+            unsigned Mid = (Lo + Hi) / 2;
+            if (Syms[Mid].Value <= (long) Addr) {
+                Lo = Mid + 1;
+            } else {
+                Hi = Mid;
+            }
+        }
+        if (Lo > 0) {
+            Syms[Lo-1].Cycles += Cycles;
+        }
+    }
+    fclose (F);
+
+    /* Print the labels that account for cycles, sorted descending, in a
+    ** format that may be fed into the cc65 --opt-profile option.
+    */
+    qsort (Syms, Count, sizeof (*Syms), CmpProfSymCycles);
+    for (I = 0; I < Count; ++I) {
+        if (Syms[I].Cycles != 0) {
+            PrintLine ("%-24s %10lu", Syms[I].Name, Syms[I].Cycles);
+        }
+    }
+
+    /* Free the allocated data */
+    xfree (Syms);
+    cc65_free_symbolinfo (Info, S);
+}
+
+
+
 static void CmdQuit (Collection* Args attribute ((unused)))
 /* Terminate the application */
 {
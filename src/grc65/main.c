@@ -102,6 +102,7 @@ const unsigned char icon1[] = {255, 255, 255, 128,   0,   1, 128,   0,   1,
 
 const char *outputCName = NULL;
 const char *outputSName = NULL;
+int outputCGiven = 0, outputSGiven = 0;
 FILE *outputCFile, *outputSFile;
 int CFnum = 0, SFnum = 0;
 int apple = 0;
@@ -112,7 +113,7 @@ char outputSMode[2] = "w";
 static void Usage (void)
 {
     printf (
-        "Usage: %s [options] file\n"
+        "Usage: %s [options] file [file ...]\n"
         "Short options:\n"
         "  -V\t\t\tPrint the version number\n"
         "  -h\t\t\tHelp (this text)\n"
@@ -204,6 +205,9 @@ static void openCFile (void)
         AbEnd ("Can't open file %s for writing: %s", outputCName, strerror (errno));
     }
 
+    /* Use a large output buffer */
+    setvbuf (outputCFile, NULL, _IOFBF, 0x10000);
+
     if (CFnum == 0) {
         outputCMode[0] = 'a';
         printCHeader ();
@@ -218,6 +222,9 @@ static void openSFile (void)
         AbEnd ("Can't open file %s for writing: %s", outputSName, strerror (errno));
     }
 
+    /* Use a large output buffer */
+    setvbuf (outputSFile, NULL, _IOFBF, 0x10000);
+
     if (SFnum == 0) {
         outputSMode[0] = 'a';
         printSHeader ();
@@ -903,6 +910,7 @@ static void processFile (const char *filename)
     }
 
     str = filterInput (F, xmalloc (BLOODY_BIG_BUFFER));
+    fclose (F);
 
     token = strtok (str, " ");
 
@@ -935,6 +943,9 @@ static void processFile (const char *filename)
         }
         token = nextWord ();
     } while (token != NULL);
+
+    /* Release the parse buffer */
+    xfree (str);
 }
 
 
@@ -970,10 +981,12 @@ int main (int argc, char *argv[])
 
                 case 'o':
                     outputCName = GetArg (&I, 2);
+                    outputCGiven = 1;
                     break;
 
                 case 's':
                     outputSName = GetArg (&I, 2);
+                    outputSGiven = 1;
                     break;
 
                 case 't':
@@ -996,8 +1009,21 @@ int main (int argc, char *argv[])
         } else {
             ffile++;
 
-            if (outputCName == NULL) outputCName = MakeFilename (Arg, ".h");
-            if (outputSName == NULL) outputSName = MakeFilename (Arg, ".s");
+            /* Derive the default output names per input file, so several
+            ** resource scripts can be converted in one invocation. Names
+            ** given with -o/-s are kept; all inputs are then combined into
+            ** those files as before.
+            */
+            if (!outputCGiven) {
+                outputCName = MakeFilename (Arg, ".h");
+                outputCMode[0] = 'w';
+                CFnum = 0;
+            }
+            if (!outputSGiven) {
+                outputSName = MakeFilename (Arg, ".s");
+                outputSMode[0] = 'w';
+                SFnum = 0;
+            }
 
             processFile (Arg);
         }
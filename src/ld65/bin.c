@@ -67,6 +67,7 @@ struct BinDesc {
     unsigned    Undef;          /* Count of undefined externals */
     FILE*       F;              /* Output file */
     const char* Filename;       /* Name of output file */
+    const char* Compressed;     /* Name of compressed segment written, if any */
 };
 
 
@@ -84,9 +85,10 @@ BinDesc* NewBinDesc (void)
     BinDesc* D = xmalloc (sizeof (BinDesc));
 
     /* Initialize the fields */
-    D->Undef    = 0;
-    D->F        = 0;
-    D->Filename = 0;
+    D->Undef      = 0;
+    D->F          = 0;
+    D->Filename   = 0;
+    D->Compressed = 0;
 
     /* Return the created struct */
     return D;
@@ -115,6 +117,103 @@ static unsigned BinWriteExpr (ExprNode* E, int Signed, unsigned Size,
 
 
 
+static unsigned long RLEncode (const unsigned char* Data, unsigned long Size,
+                               unsigned char* Enc)
+/* Run length encode Size bytes from Data into Enc and return the encoded
+** size. The output is a sequence of chunks, each introduced by a control
+** byte C: C in 1..127 means C literal bytes follow, C in 128..255 means that
+** the following byte is repeated C-125 (3..130) times, and C == 0 ends the
+** stream. Runs shorter than three bytes aren't worth a chunk of their own
+** and go into the surrounding literals.
+*/
+{
+    unsigned long I   = 0;
+    unsigned long Out = 0;
+
+    while (I < Size) {
+
+        /* Determine the length of the byte run starting at I */
+        unsigned long Run = 1;
+        while (Run < 130 && I + Run < Size && Data[I+Run] == Data[I]) {
+            ++Run;
+        }
+
+        if (Run >= 3) {
+            /* Emit a repeat chunk */
+            Enc[Out++] = (unsigned char) (Run + 125);
+            Enc[Out++] = Data[I];
+            I += Run;
+        } else {
+            /* Collect literal bytes up to the next run of three or more */
+            unsigned long Start = I;
+            while (I < Size && I - Start < 127) {
+                if (I + 2 < Size && Data[I] == Data[I+1] && Data[I] == Data[I+2]) {
+                    break;
+                }
+                ++I;
+            }
+            Enc[Out++] = (unsigned char) (I - Start);
+            memcpy (Enc + Out, Data + Start, (size_t) (I - Start));
+            Out += I - Start;
+        }
+    }
+
+    /* End the stream */
+    Enc[Out++] = 0;
+    return Out;
+}
+
+
+
+static void BinWriteCompressed (BinDesc* D, SegDesc* S)
+/* Write the data of a COMPRESSED segment to the output file. The segment is
+** first written to a temporary file, so expressions are resolved exactly as
+** for a plain segment, then read back and run length encoded.
+*/
+{
+    FILE*          Out = D->F;
+    FILE*          Tmp;
+    unsigned char* Data;
+    unsigned char* Enc;
+    unsigned long  Size;
+    unsigned long  EncSize;
+
+    /* Write the raw segment data to a temporary file */
+    Tmp = tmpfile ();
+    if (Tmp == 0) {
+        Error ("Cannot create temporary file: %s", strerror (errno));
+    }
+    D->F = Tmp;
+    SegWrite (D->Filename, Tmp, S->Seg, BinWriteExpr, D);
+    D->F = Out;
+
+    /* Read the raw data back */
+    Size = ftell (Tmp);
+    Data = xmalloc (Size);
+    rewind (Tmp);
+    if (Size > 0 && fread (Data, 1, (size_t) Size, Tmp) != Size) {
+        Error ("Cannot read temporary file: %s", strerror (errno));
+    }
+    (void) fclose (Tmp);
+
+    /* Encode the data. The worst case is all literal chunks, which need one
+    ** control byte per 127 data bytes, plus the end marker.
+    */
+    Enc = xmalloc (Size + Size / 127 + 2);
+    EncSize = RLEncode (Data, Size, Enc);
+
+    /* Write the encoded data and release the buffers */
+    WriteData (D->F, Enc, (unsigned) EncSize);
+    xfree (Enc);
+    xfree (Data);
+
+    /* Keep the user happy */
+    Print (stdout, 1, "    Compressed '%s': %lu into %lu bytes\n",
+           GetString (S->Name), Size, EncSize);
+}
+
+
+
 static void PrintBoolVal (const char* Name, int B)
 /* Print a boolean value for debugging */
 {
@@ -139,6 +238,14 @@ static void BinWriteMem (BinDesc* D, MemoryArea* M)
     /* Get the start address of this memory area */
     unsigned long Addr = M->Start;
 
+    /* Anything written after a compressed segment would end up at the wrong
+    ** file offset, since the raw segment size was used to lay out the file.
+    */
+    if (D->Compressed != 0) {
+        Error ("Compressed segment '%s' must be the last data in file '%s'",
+               D->Compressed, D->Filename);
+    }
+
     /* Debugging: Check that the file offset is correct */
     if (ftell (D->F) != (long)M->FileOffs) {
         Internal ("Invalid file offset for memory area %s: %ld/%lu",
@@ -161,6 +268,12 @@ static void BinWriteMem (BinDesc* D, MemoryArea* M)
                    S->Load == M                 &&      /* LOAD segment */
                    S->Seg->Dumped == 0;                 /* Not already written */
 
+        /* See above - nothing may follow a compressed segment in the file */
+        if (D->Compressed != 0 && (DoWrite || (M->Flags & MF_FILL) != 0)) {
+            Error ("Compressed segment '%s' must be the last data in file '%s'",
+                   D->Compressed, D->Filename);
+        }
+
         /* Output debugging stuff */
         PrintBoolVal ("bss", S->Flags & SF_BSS);
         PrintBoolVal ("LoadArea", S->Load == M);
@@ -224,7 +337,12 @@ static void BinWriteMem (BinDesc* D, MemoryArea* M)
         */
         if (DoWrite) {
             unsigned long P = ftell (D->F);
-            SegWrite (D->Filename, D->F, S->Seg, BinWriteExpr, D);
+            if (S->Flags & SF_COMPRESSED) {
+                BinWriteCompressed (D, S);
+                D->Compressed = GetString (S->Name);
+            } else {
+                SegWrite (D->Filename, D->F, S->Seg, BinWriteExpr, D);
+            }
             PrintNumVal ("Wrote", (unsigned long) (ftell (D->F) - P));
             /* If we have just written an OVERWRITE segement, move position to the
             ** end of file, so that subsequent segments are written in the correct
@@ -250,6 +368,10 @@ static void BinWriteMem (BinDesc* D, MemoryArea* M)
     /* If a fill was requested, fill the remaining space */
     if ((M->Flags & MF_FILL) != 0 && M->FillLevel < M->Size) {
         unsigned long ToFill = M->Size - M->FillLevel;
+        if (D->Compressed != 0) {
+            Error ("Compressed segment '%s' must be the last data in file '%s'",
+                   D->Compressed, D->Filename);
+        }
         Print (stdout, 2, "    Filling 0x%lx bytes with 0x%02x\n",
                ToFill, M->FillVal);
         WriteMult (D->F, M->FillVal, ToFill);
@@ -278,7 +400,8 @@ void BinWriteTarget (BinDesc* D, struct File* F)
     unsigned I;
 
     /* Place the filename in the control structure */
-    D->Filename = GetString (F->Name);
+    D->Filename   = GetString (F->Name);
+    D->Compressed = 0;
 
     /* Check for unresolved symbols. The function BinUnresolved is called
     ** if we get an unresolved symbol.
@@ -295,6 +418,7 @@ void BinWriteTarget (BinDesc* D, struct File* F)
     if (D->F == 0) {
         Error ("Cannot open '%s': %s", D->Filename, strerror (errno));
     }
+    FileSetBigBuf (D->F);
 
     /* Keep the user happy */
     Print (stdout, 1, "Opened '%s'...\n", D->Filename);
@@ -62,6 +62,7 @@
 #include "error.h"
 #include "exports.h"
 #include "expr.h"
+#include "farcall.h"
 #include "global.h"
 #include "memarea.h"
 #include "o65.h"
@@ -106,6 +107,7 @@ static Collection       MemoryAreas = STATIC_COLLECTION_INITIALIZER;
 #define MA_FILL         0x0020
 #define MA_FILLVAL      0x0040
 #define MA_BANK         0x0080
+#define MA_PACK         0x0100
 
 /* Segment list */
 static Collection       SegDescList = STATIC_COLLECTION_INITIALIZER;
@@ -121,6 +123,9 @@ static Collection       SegDescList = STATIC_COLLECTION_INITIALIZER;
 #define SA_START        0x0080
 #define SA_OPTIONAL     0x0100
 #define SA_FILLVAL      0x0200
+#define SA_MAXSIZE      0x0400
+#define SA_COMPRESSED   0x0800
+#define SA_COLD         0x1000
 
 /* Symbol types used in the CfgSymbol structure */
 typedef enum {
@@ -235,7 +240,7 @@ static MemoryArea* CfgGetMemory (unsigned Name)
 
 
 
-static SegDesc* CfgFindSegDesc (unsigned Name)
+SegDesc* CfgFindSegDesc (unsigned Name)
 /* Find the segment descriptor with the given name, return NULL if not found. */
 {
     unsigned I;
@@ -360,6 +365,8 @@ static SegDesc* NewSegDesc (unsigned Name)
     S->FillVal       = 0;
     S->RunAlignment  = 1;
     S->LoadAlignment = 1;
+    S->MaxSize       = 0;
+    S->ColdName      = INVALID_STRING_ID;
 
     /* Insert the struct into the list ... */
     CollAppend (&SegDescList, S);
@@ -417,6 +424,7 @@ static void ParseMemory (void)
         {   "FILE",     CFGTOK_FILE     },
         {   "FILL",     CFGTOK_FILL     },
         {   "FILLVAL",  CFGTOK_FILLVAL  },
+        {   "PACK",     CFGTOK_PACK     },
         {   "SIZE",     CFGTOK_SIZE     },
         {   "START",    CFGTOK_START    },
         {   "TYPE",     CFGTOK_TYPE     },
@@ -488,6 +496,16 @@ static void ParseMemory (void)
                     M->FillVal = (unsigned char) CfgCheckedConstExpr (0, 0xFF);
                     break;
 
+                case CFGTOK_PACK:
+                    FlagAttr (&M->Attr, MA_PACK, "PACK");
+                    /* Map the token to a boolean */
+                    CfgBoolToken ();
+                    if (CfgTok == CFGTOK_TRUE) {
+                        M->Flags |= MF_PACK;
+                    }
+                    CfgNextTok ();
+                    break;
+
                 case CFGTOK_SIZE:
                     FlagAttr (&M->Attr, MA_SIZE, "SIZE");
                     M->SizeExpr = CfgExpr ();
@@ -646,9 +664,12 @@ static void ParseSegments (void)
     static const IdentTok Attributes [] = {
         {   "ALIGN",            CFGTOK_ALIGN            },
         {   "ALIGN_LOAD",       CFGTOK_ALIGN_LOAD       },
+        {   "COLD",             CFGTOK_COLD             },
+        {   "COMPRESSED",       CFGTOK_COMPRESSED       },
         {   "DEFINE",           CFGTOK_DEFINE           },
         {   "FILLVAL",          CFGTOK_FILLVAL          },
         {   "LOAD",             CFGTOK_LOAD             },
+        {   "MAXSIZE",          CFGTOK_MAXSIZE          },
         {   "OFFSET",           CFGTOK_OFFSET           },
         {   "OPTIONAL",         CFGTOK_OPTIONAL         },
         {   "RUN",              CFGTOK_RUN              },
@@ -708,6 +729,22 @@ static void ParseSegments (void)
                     S->Flags |= SF_ALIGN_LOAD;
                     break;
 
+                case CFGTOK_COLD:
+                    FlagAttr (&S->Attr, SA_COLD, "COLD");
+                    S->ColdName = GetStrBufId (&CfgSVal);
+                    S->Flags |= SF_COLD;
+                    CfgNextTok ();
+                    break;
+
+                case CFGTOK_COMPRESSED:
+                    FlagAttr (&S->Attr, SA_COMPRESSED, "COMPRESSED");
+                    CfgBoolToken ();
+                    if (CfgTok == CFGTOK_TRUE) {
+                        S->Flags |= SF_COMPRESSED;
+                    }
+                    CfgNextTok ();
+                    break;
+
                 case CFGTOK_DEFINE:
                     FlagAttr (&S->Attr, SA_DEFINE, "DEFINE");
                     /* Map the token to a boolean */
@@ -730,6 +767,12 @@ static void ParseSegments (void)
                     CfgNextTok ();
                     break;
 
+                case CFGTOK_MAXSIZE:
+                    FlagAttr (&S->Attr, SA_MAXSIZE, "MAXSIZE");
+                    S->MaxSize = CfgCheckedConstExpr (1, 0x1000000);
+                    S->Flags |= SF_MAXSIZE;
+                    break;
+
                 case CFGTOK_OFFSET:
                     FlagAttr (&S->Attr, SA_OFFSET, "OFFSET");
                     S->Addr   = CfgCheckedConstExpr (0, 0x1000000);
@@ -809,6 +852,48 @@ static void ParseSegments (void)
                         "memory areas assigned");
         }
 
+        /* A compressed segment holds run length encoded data that a program
+        ** supplied decompressor expands at run time. It must contain data,
+        ** needs separate LOAD and RUN memory areas - references into the
+        ** segment resolve to the run addresses where the expanded data will
+        ** live - and cannot be combined with OVERWRITE, which seeks within
+        ** the file already written.
+        */
+        if (S->Flags & SF_COMPRESSED) {
+            if (S->Flags & SF_BSS) {
+                CfgError (&CfgErrorPos,
+                          "Segment '%s' with type 'bss' or 'zp' cannot be "
+                          "COMPRESSED", GetString (S->Name));
+            }
+            if (S->Flags & SF_OVERWRITE) {
+                CfgError (&CfgErrorPos,
+                          "Segment '%s' with type 'overwrite' cannot be "
+                          "COMPRESSED", GetString (S->Name));
+            }
+            if (S->Load == S->Run) {
+                CfgError (&CfgErrorPos,
+                          "COMPRESSED segment '%s' needs separate LOAD and "
+                          "RUN memory areas", GetString (S->Name));
+            }
+        }
+
+        /* A cold spill segment receives the sections that an execution
+        ** profile showed to be unused, so it must be a different segment
+        ** and the parent segment must have contents to move.
+        */
+        if (S->Flags & SF_COLD) {
+            if (S->ColdName == S->Name) {
+                CfgError (&CfgErrorPos,
+                          "Segment '%s' cannot be its own COLD spill segment",
+                          GetString (S->Name));
+            }
+            if (S->Flags & SF_BSS) {
+                CfgError (&CfgErrorPos,
+                          "Segment '%s' with type 'bss' or 'zp' cannot have "
+                          "a COLD spill segment", GetString (S->Name));
+            }
+        }
+
         /* Don't allow read/write data to be put into a readonly area */
         if ((S->Flags & SF_RO) == 0) {
             if (S->Run->Flags & MF_RO) {
@@ -1304,6 +1389,90 @@ static void ParseConDes (void)
 
 
 
+static void ParseFarCall (void)
+/* Parse the FARCALL feature */
+{
+    static const IdentTok Attributes [] = {
+        {   "DISPATCH",         CFGTOK_DISPATCH         },
+        {   "SEGMENT",          CFGTOK_SEGMENT          },
+    };
+
+    /* Attribute values. */
+    unsigned SegName  = INVALID_STRING_ID;
+    unsigned Dispatch = INVALID_STRING_ID;
+
+    /* Bitmask to remember the attributes we got already */
+    enum {
+        atNone          = 0x0000,
+        atDispatch      = 0x0001,
+        atSegName       = 0x0002,
+    };
+    unsigned AttrFlags = atNone;
+
+    /* Parse the attributes */
+    while (1) {
+
+        /* Map the identifier to a token */
+        cfgtok_t AttrTok;
+        CfgSpecialToken (Attributes, ENTRY_COUNT (Attributes), "Attribute");
+        AttrTok = CfgTok;
+
+        /* An optional assignment follows */
+        CfgNextTok ();
+        CfgOptionalAssign ();
+
+        /* Check which attribute was given */
+        switch (AttrTok) {
+
+            case CFGTOK_DISPATCH:
+                /* Don't allow this twice */
+                FlagAttr (&AttrFlags, atDispatch, "DISPATCH");
+                /* We expect an identifier */
+                CfgAssureIdent ();
+                /* Remember the value for later */
+                Dispatch = GetStrBufId (&CfgSVal);
+                break;
+
+            case CFGTOK_SEGMENT:
+                /* Don't allow this twice */
+                FlagAttr (&AttrFlags, atSegName, "SEGMENT");
+                /* We expect an identifier */
+                CfgAssureIdent ();
+                /* Remember the value for later */
+                SegName = GetStrBufId (&CfgSVal);
+                break;
+
+            default:
+                FAIL ("Unexpected attribute token");
+
+        }
+
+        /* Skip the attribute value */
+        CfgNextTok ();
+
+        /* Semicolon ends the decl, otherwise accept an optional comma */
+        if (CfgTok == CFGTOK_SEMI) {
+            break;
+        } else if (CfgTok == CFGTOK_COMMA) {
+            CfgNextTok ();
+        }
+    }
+
+    /* Check if we have all mandatory attributes */
+    AttrCheck (AttrFlags, atSegName, "SEGMENT");
+    AttrCheck (AttrFlags, atDispatch, "DISPATCH");
+
+    /* The feature may only be declared once */
+    if (FarCallDeclared ()) {
+        CfgError (&CfgErrorPos, "FARCALL feature already defined");
+    }
+
+    /* Define the attributes */
+    FarCallSetup (SegName, Dispatch);
+}
+
+
+
 static void ParseStartAddress (void)
 /* Parse the STARTADDRESS feature */
 {
@@ -1375,6 +1544,7 @@ static void ParseFeatures (void)
 {
     static const IdentTok Features [] = {
         {   "CONDES",       CFGTOK_CONDES       },
+        {   "FARCALL",      CFGTOK_FARCALL      },
         {   "STARTADDRESS", CFGTOK_STARTADDRESS },
     };
 
@@ -1396,6 +1566,10 @@ static void ParseFeatures (void)
                 ParseConDes ();
                 break;
 
+            case CFGTOK_FARCALL:
+                ParseFarCall ();
+                break;
+
             case CFGTOK_STARTADDRESS:
                 ParseStartAddress ();
                 break;
@@ -1864,6 +2038,87 @@ static void CreateLoadDefines (SegDesc* S, unsigned long SegAddr)
 
 
 
+static unsigned long SegPackAlignment (const SegDesc* S, const MemoryArea* M)
+/* Return the alignment that applies to the given segment in the given
+** memory area.
+*/
+{
+    if (S->Run == M && (S->Flags & SF_ALIGN) != 0) {
+        return S->RunAlignment;
+    }
+    if (S->Load == M && S->Run != M && (S->Flags & SF_ALIGN_LOAD) != 0) {
+        return S->LoadAlignment;
+    }
+    return 1;
+}
+
+
+
+static void PackSegments (MemoryArea* M)
+/* Reorder the segments in the given memory area so that less fill bytes are
+** needed for alignment. Called for areas with the PACK attribute after the
+** start address and the segment sizes are known, but before the segments are
+** placed. The final layout is visible in the map file as usual.
+*/
+{
+    unsigned      Count = CollCount (&M->SegList);
+    unsigned long Addr  = M->Start;
+    unsigned      I, J;
+
+    /* Segments with a fixed address cannot be moved, and moving other
+    ** segments across them would change the layout in unexpected ways, so
+    ** areas containing them aren't packed.
+    */
+    for (I = 0; I < Count; ++I) {
+        const SegDesc* S = CollConstAt (&M->SegList, I);
+        if (S->Flags & (SF_OFFSET | SF_START | SF_OVERWRITE)) {
+            CfgWarning (GetSourcePos (M->LI),
+                        "Cannot pack memory area '%s': segment '%s' has a "
+                        "fixed address",
+                        GetString (M->Name), GetString (S->Name));
+            return;
+        }
+    }
+
+    /* Greedy packing: for each slot pick the segment that needs the least
+    ** fill at the current address. On a tie prefer the larger alignment,
+    ** so strictly aligned segments are placed while the address still
+    ** satisfies them, then the original order.
+    */
+    for (I = 0; I < Count; ++I) {
+
+        unsigned      Best          = I;
+        unsigned long BestFill      = ~0UL;
+        unsigned long BestAlignment = 0;
+        SegDesc*      S;
+
+        for (J = I; J < Count; ++J) {
+            const SegDesc* T = CollConstAt (&M->SegList, J);
+            unsigned long Alignment = SegPackAlignment (T, M);
+            unsigned long Fill = AlignAddr (Addr, Alignment) - Addr;
+            if (Fill < BestFill ||
+                (Fill == BestFill && Alignment > BestAlignment)) {
+                Best          = J;
+                BestFill      = Fill;
+                BestAlignment = Alignment;
+            }
+        }
+
+        /* Move the chosen segment into the current slot keeping the order
+        ** of the others.
+        */
+        if (Best != I) {
+            CollMove (&M->SegList, Best, I);
+        }
+
+        /* Account for the placed segment */
+        S = CollAtUnchecked (&M->SegList, I);
+        Addr += BestFill + S->Seg->Size;
+    }
+}
+
+
+
 unsigned CfgProcess (void)
 /* Process the config file, after reading in object files and libraries. This
 ** includes postprocessing of the config file data; but also assigning segments,
@@ -1937,6 +2192,11 @@ unsigned CfgProcess (void)
         }
         M->Size = GetExprVal (M->SizeExpr);
 
+        /* If requested, reorder the segments to reduce alignment fill */
+        if (M->Flags & MF_PACK) {
+            PackSegments (M);
+        }
+
         /* Walk through the segments in this memory area */
         for (J = 0; J < CollCount (&M->SegList); ++J) {
             /* Get the segment */
@@ -2091,6 +2351,20 @@ unsigned CfgProcess (void)
                             M->FillLevel - M->Size, (M->FillLevel - M->Size == 1) ? ' ' : 's');
             }
 
+            /* If the segment has a size budget, check it. The check is done
+            ** when the run area is processed, so it happens exactly once for
+            ** segments with separate run and load areas. The message has a
+            ** fixed form, so build tools can match it without parsing the
+            ** map file.
+            */
+            if (S->Run == M && (S->Flags & SF_MAXSIZE) != 0 &&
+                S->Seg->Size > S->MaxSize) {
+                ++Overflows;
+                CfgWarning (GetSourcePos (S->LI),
+                            "Segment '%s' exceeds budget: size = %lu, maxsize = %lu",
+                            GetString (S->Name), S->Seg->Size, S->MaxSize);
+            }
+
             /* If requested, define symbols for the start and size of the
             ** segment.
             */
@@ -81,6 +81,8 @@ struct SegDesc {
     unsigned long       Addr;           /* Start address or offset into segment */
     unsigned long       RunAlignment;   /* Run area alignment if given */
     unsigned long       LoadAlignment;  /* Load area alignment if given */
+    unsigned long       MaxSize;        /* Size budget if given */
+    unsigned            ColdName;       /* Name of the cold spill segment */
 };
 
 /* Segment flags */
@@ -97,6 +99,9 @@ struct SegDesc {
 #define SF_LOAD_DEF     0x0400          /* LOAD symbols already defined */
 #define SF_FILLVAL      0x0800          /* Segment has separate fill value */
 #define SF_OVERWRITE    0x1000          /* Segment can overwrite (part of) another one */
+#define SF_MAXSIZE      0x2000          /* Segment has a size budget */
+#define SF_COMPRESSED   0x4000          /* Run length encode the segment data */
+#define SF_COLD         0x8000          /* Segment has a cold spill segment */
 
 
 
@@ -106,6 +111,9 @@ struct SegDesc {
 
 
 
+SegDesc* CfgFindSegDesc (unsigned Name);
+/* Find the segment descriptor with the given name, return NULL if not found. */
+
 void CfgRead (void);
 /* Read the configuration */
 
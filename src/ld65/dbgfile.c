@@ -110,6 +110,11 @@ void CreateDbgFile (void)
         Error ("Cannot create debug file '%s': %s", DbgFileName, strerror (errno));
     }
 
+    /* Use a large output buffer, so the many small records end up on disk
+    ** in large blocks.
+    */
+    setvbuf (F, 0, _IOFBF, 65536);
+
     /* Output version information */
     fprintf (F, "version\tmajor=2,minor=0\n");
 
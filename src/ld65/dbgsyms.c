@@ -40,6 +40,7 @@
 #include "attrib.h"
 #include "check.h"
 #include "hlldbgsym.h"
+#include "strbuf.h"
 #include "symdefs.h"
 #include "xmalloc.h"
 
@@ -294,16 +295,18 @@ static long GetDbgSymVal (const DbgSym* D)
 
 
 
-static void PrintLineInfo (FILE* F, const Collection* LineInfos, const char* Format)
-/* Output an attribute with line infos */
+static void AppendLineInfo (StrBuf* B, const Collection* LineInfos, const char* Attr)
+/* Append an attribute with line infos to a string buffer */
 {
     if (CollCount (LineInfos) > 0) {
         unsigned I;
         const LineInfo* LI = CollConstAt (LineInfos, 0);
-        fprintf (F, Format, LI->Id);
+        SB_AppendStr (B, Attr);
+        SB_AppendUnsigned (B, LI->Id);
         for (I = 1; I < CollCount (LineInfos); ++I) {
             LI = CollConstAt (LineInfos, I);
-            fprintf (F, "+%u", LI->Id);
+            SB_AppendChar (B, '+');
+            SB_AppendUnsigned (B, LI->Id);
         }
     }
 }
@@ -352,6 +355,8 @@ void PrintDbgSyms (FILE* F)
 /* Print the debug symbols in a debug file */
 {
     unsigned I, J;
+    const DbgSym* S;
+    StrBuf Line = STATIC_STRBUF_INITIALIZER;
 
     for (I = 0; I < CollCount (&ObjDataList); ++I) {
 
@@ -359,35 +364,42 @@ void PrintDbgSyms (FILE* F)
         ObjData* O = CollAtUnchecked (&ObjDataList, I);
 
         /* Walk through all debug symbols in this module */
-        for (J = 0; J < CollCount (&O->DbgSyms); ++J) {
+        CollForEach (&O->DbgSyms, J, S, const DbgSym*) {
 
-            /* Get the next debug symbol */
-            const DbgSym* S = CollConstAt (&O->DbgSyms, J);
+            /* Format the record in memory, then write it with one call.
+            ** This is cheaper than using fprintf for each field, since the
+            ** format string doesn't need to be parsed over and over again.
+            */
+            SB_Clear (&Line);
 
             /* Emit the base data for the entry */
-            fprintf (F,
-                     "sym\tid=%u,name=\"%s\",addrsize=%s",
-                     O->SymBaseId + J,
-                     GetString (S->Name),
-                     AddrSizeToStr ((unsigned char) S->AddrSize));
+            SB_AppendStr (&Line, "sym\tid=");
+            SB_AppendUnsigned (&Line, O->SymBaseId + J);
+            SB_AppendStr (&Line, ",name=\"");
+            SB_AppendStr (&Line, GetString (S->Name));
+            SB_AppendStr (&Line, "\",addrsize=");
+            SB_AppendStr (&Line, AddrSizeToStr ((unsigned char) S->AddrSize));
 
             /* Emit the size only if we know it */
             if (S->Size != 0) {
-                fprintf (F, ",size=%u", S->Size);
+                SB_AppendStr (&Line, ",size=");
+                SB_AppendUnsigned (&Line, S->Size);
             }
 
             /* For cheap local symbols, add the owner symbol, for others,
             ** add the owner scope.
             */
             if (SYM_IS_STD (S->Type)) {
-                fprintf (F, ",scope=%u", O->ScopeBaseId + S->OwnerId);
+                SB_AppendStr (&Line, ",scope=");
+                SB_AppendUnsigned (&Line, O->ScopeBaseId + S->OwnerId);
             } else {
-                fprintf (F, ",parent=%u", O->SymBaseId + S->OwnerId);
+                SB_AppendStr (&Line, ",parent=");
+                SB_AppendUnsigned (&Line, O->SymBaseId + S->OwnerId);
             }
 
             /* Output line infos */
-            PrintLineInfo (F, &S->DefLines, ",def=%u");
-            PrintLineInfo (F, &S->RefLines, ",ref=%u");
+            AppendLineInfo (&Line, &S->DefLines, ",def=");
+            AppendLineInfo (&Line, &S->RefLines, ",ref=");
 
             /* If this is an import, output the id of the matching export.
             ** If this is not an import, output its value and - if we have
@@ -402,14 +414,15 @@ void PrintDbgSyms (FILE* F)
                 const Export* Exp = Imp->Exp;
 
                 /* Output the type */
-                fputs (",type=imp", F);
+                SB_AppendStr (&Line, ",type=imp");
 
                 /* If this is not a linker generated symbol, and the module
                 ** that contains the export has debug info, output the debug
                 ** symbol id for the export
                 */
                 if (Exp->Obj && OBJ_HAS_DBGINFO (Exp->Obj->Header.Flags)) {
-                    fprintf (F, ",exp=%u", Exp->Obj->SymBaseId + Exp->DbgSymId);
+                    SB_AppendStr (&Line, ",exp=");
+                    SB_AppendUnsigned (&Line, Exp->Obj->SymBaseId + Exp->DbgSymId);
                 }
 
             } else {
@@ -420,24 +433,30 @@ void PrintDbgSyms (FILE* F)
                 long Val = GetDbgSymVal (S);
 
                 /* Output it */
-                fprintf (F, ",val=0x%lX", Val);
+                SB_AppendStr (&Line, ",val=0x");
+                SB_AppendHex (&Line, (unsigned long) Val);
 
                 /* Check for a segmented expression and add the segment id to
                 ** the debug info if we have one.
                 */
                 GetSegExprVal (S->Expr, &D);
                 if (!D.TooComplex && D.Seg != 0) {
-                    fprintf (F, ",seg=%u", D.Seg->Id);
+                    SB_AppendStr (&Line, ",seg=");
+                    SB_AppendUnsigned (&Line, D.Seg->Id);
                 }
 
                 /* Output the type */
-                fprintf (F, ",type=%s", SYM_IS_LABEL (S->Type)? "lab" : "equ");
+                SB_AppendStr (&Line, SYM_IS_LABEL (S->Type)? ",type=lab" : ",type=equ");
             }
 
-            /* Terminate the output line */
-            fputc ('\n', F);
+            /* Terminate and output the line */
+            SB_AppendChar (&Line, '\n');
+            fwrite (SB_GetConstBuf (&Line), 1, SB_GetLen (&Line), F);
         }
     }
+
+    /* Free the string buffer */
+    SB_Done (&Line);
 }
 
 
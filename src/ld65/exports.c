@@ -78,12 +78,16 @@ static unsigned         ImpOpen  = 0;           /* Count of open imports */
 static unsigned         ExpCount = 0;           /* Export count */
 static Export**         ExpPool  = 0;           /* Exports array */
 
+/* Symbols that must not be imported into the output file */
+static Collection       ForbiddenImports = STATIC_COLLECTION_INITIALIZER;
+
 /* Defines for the flags in Import */
 #define IMP_INLIST      0x0001U                 /* Import is in exports list */
 
 /* Defines for the flags in Export */
 #define EXP_INLIST      0x0001U                 /* Export is in exports list */
 #define EXP_USERMARK    0x0002U                 /* User setable flag */
+#define EXP_HAVE_VAL    0x0004U                 /* Cached value is valid */
 
 
 
@@ -303,6 +307,7 @@ static Export* NewExport (unsigned Type, unsigned char AddrSize,
     E->ImpCount  = 0;
     E->ImpList   = 0;
     E->Expr      = 0;
+    E->Val       = 0;
     E->Size      = 0;
     E->DefLines  = EmptyCollection;
     E->RefLines  = EmptyCollection;
@@ -626,6 +631,23 @@ Export* FindExport (unsigned Name)
 
 
 
+void VisitExports (void (*V) (Export* E, void* Data), void* Data)
+/* Call V for each export in the table, passing Data unchanged */
+{
+    unsigned I;
+
+    /* Walk over the hash table */
+    for (I = 0; I < HASHTAB_SIZE; ++I) {
+        Export* E = HashTab[I];
+        while (E) {
+            V (E, Data);
+            E = E->Next;
+        }
+    }
+}
+
+
+
 int IsUnresolved (unsigned Name)
 /* Check if this symbol is an unresolved export */
 {
@@ -657,14 +679,47 @@ int IsConstExport (const Export* E)
 
 
 
+/* Flag that marks export values as final. Set once segment placement is
+** done, so repeated evaluations can be served from the cache.
+*/
+static unsigned char ExportValsFrozen = 0;
+
+
+
+void FreezeExportVals (void)
+/* Mark the export values as final. Called after segment placement; from
+** then on GetExportVal caches the value of each export, so the thousands
+** of fragment expressions referencing the same symbol don't re-evaluate
+** the export expression over and over during relocation.
+*/
+{
+    ExportValsFrozen = 1;
+}
+
+
+
 long GetExportVal (const Export* E)
 /* Get the value of this export */
 {
+    long Val;
+
     if (E->Expr == 0) {
         /* OOPS */
         Internal ("'%s' is an undefined external", GetString (E->Name));
     }
-    return GetExprVal (E->Expr);
+
+    /* Use the cached value if we have one */
+    if (E->Flags & EXP_HAVE_VAL) {
+        return E->Val;
+    }
+
+    /* Evaluate the expression and cache the result if values are final */
+    Val = GetExprVal (E->Expr);
+    if (ExportValsFrozen) {
+        ((Export*) E)->Val    = Val;
+        ((Export*) E)->Flags |= EXP_HAVE_VAL;
+    }
+    return Val;
 }
 
 
@@ -858,6 +913,66 @@ void CheckUnresolvedImports (ExpCheckFunc F, void* Data)
 
 
 
+void ForbidImport (const char* Name)
+/* Mark the symbol with the given name as forbidden. If such a symbol is
+** imported anywhere in the linked program, the link will fail.
+*/
+{
+    CollAppend (&ForbiddenImports, xstrdup (Name));
+}
+
+
+
+void CheckForbiddenImports (void)
+/* Check if any symbols marked as forbidden were imported and bail out with
+** an error in this case.
+*/
+{
+    unsigned I;
+    unsigned Count = 0;
+
+    /* Walk over all forbidden symbols */
+    for (I = 0; I < CollCount (&ForbiddenImports); ++I) {
+
+        /* Search for an export with this name. An unreferenced name doesn't
+        ** have one, so the symbol wasn't dragged into the output file.
+        */
+        const char* Name = CollConstAt (&ForbiddenImports, I);
+        const Export* E = FindExport (GetStringId (Name));
+        if (E == 0 || E->ImpCount == 0) {
+            continue;
+        }
+
+        /* The symbol is imported. Print all references. */
+        fprintf (stderr,
+                 "Forbidden symbol '%s' referenced in:\n",
+                 Name);
+        {
+            const Import* Imp = E->ImpList;
+            while (Imp) {
+                unsigned J;
+                for (J = 0; J < CollCount (&Imp->RefLines); ++J) {
+                    const LineInfo* LI = CollConstAt (&Imp->RefLines, J);
+                    fprintf (stderr,
+                         "  %s(%u)\n",
+                         GetSourceName (LI),
+                         GetSourceLine (LI));
+                }
+                Imp = Imp->Next;
+            }
+        }
+        ++Count;
+    }
+
+    /* If we had any references to forbidden symbols, bail out */
+    if (Count > 0) {
+        Error ("%u forbidden symbol%s referenced",
+               Count, (Count == 1) ? "" : "s");
+    }
+}
+
+
+
 static char GetAddrSizeCode (unsigned char AddrSize)
 /* Get a one char code for the address size */
 {
@@ -962,6 +1077,69 @@ void PrintExportMapByValue (FILE* F)
 
 
 
+void WriteBinExports (FILE* F)
+/* Write the export list in binary map file format to the given file */
+{
+    unsigned I;
+
+    /* Write the export records, using the existing pool which is already
+    ** sorted by name. All exports are written, the consumer can filter by
+    ** the flags if needed.
+    */
+    WriteVar (F, ExpCount);
+    for (I = 0; I < ExpCount; ++I) {
+        const Export* E = ExpPool [I];
+        unsigned char Flags = 0;
+        if (E->ImpCount > 0) {
+            Flags |= 0x01;              /* Referenced */
+        }
+        if (SYM_IS_LABEL (E->Type)) {
+            Flags |= 0x02;              /* Label, not equate */
+        }
+        if (SYM_IS_CONDES (E->Type)) {
+            Flags |= 0x04;              /* Constructor/destructor */
+        }
+        WriteStr (F, GetString (E->Name));
+        Write32 (F, GetExportVal (E));
+        Write8 (F, E->AddrSize);
+        Write8 (F, Flags);
+    }
+}
+
+
+
+void PrintExportStats (FILE* F)
+/* Print hash table fill statistics for --stats. The output is one tab
+** separated line:
+** "exports <count> <imports> <slots> <used-slots> <max-chain>".
+*/
+{
+    unsigned I;
+    unsigned Used = 0;
+    unsigned MaxChain = 0;
+
+    /* Walk the hash chains */
+    for (I = 0; I < HASHTAB_SIZE; ++I) {
+        unsigned Chain = 0;
+        const Export* E;
+        for (E = HashTab[I]; E != 0; E = E->Next) {
+            ++Chain;
+        }
+        if (Chain > 0) {
+            ++Used;
+        }
+        if (Chain > MaxChain) {
+            MaxChain = Chain;
+        }
+    }
+
+    /* Output the line */
+    fprintf (F, "exports\t%u\t%u\t%u\t%u\t%u\n",
+             ExpCount, ImpCount, (unsigned) HASHTAB_SIZE, Used, MaxChain);
+}
+
+
+
 void PrintImportMap (FILE* F)
 /* Print an import map to the given file */
 {
@@ -84,6 +84,7 @@ struct Export {
     unsigned            ImpCount;       /* How many imports for this symbol? */
     Import*             ImpList;        /* List of imports for this symbol */
     ExprNode*           Expr;           /* Expression (0 if not def'd) */
+    long                Val;            /* Cached value once frozen */
     unsigned            Size;           /* Size of the symbol if any */
     Collection          DefLines;       /* Line infos of definition */
     Collection          RefLines;       /* Line infos of reference */
@@ -164,6 +165,9 @@ Export* FindExport (unsigned Name);
 ** return a pointer to the export.
 */
 
+void VisitExports (void (*V) (Export* E, void* Data), void* Data);
+/* Call V for each export in the table, passing Data unchanged */
+
 int IsUnresolved (unsigned Name);
 /* Check if this symbol is an unresolved export */
 
@@ -173,6 +177,11 @@ int IsUnresolvedExport (const Export* E);
 int IsConstExport (const Export* E);
 /* Return true if the expression associated with this export is const */
 
+void FreezeExportVals (void);
+/* Mark the export values as final. Called after segment placement; from
+** then on GetExportVal caches the value of each export.
+*/
+
 long GetExportVal (const Export* E);
 /* Get the value of this export */
 
@@ -186,12 +195,28 @@ void CheckUnresolvedImports (ExpCheckFunc F, void* Data);
 ** called (see the comments on ExpCheckFunc in the data section).
 */
 
+void ForbidImport (const char* Name);
+/* Mark the symbol with the given name as forbidden. If such a symbol is
+** imported anywhere in the linked program, the link will fail.
+*/
+
+void CheckForbiddenImports (void);
+/* Check if any symbols marked as forbidden were imported and bail out with
+** an error in this case.
+*/
+
 void PrintExportMapByName (FILE* F);
 /* Print an export map to the given file (sorted by symbol name) */
 
 void PrintExportMapByValue (FILE* F);
 /* Print an export map to the given file (sorted by export value) */
 
+void WriteBinExports (FILE* F);
+/* Write the export list in binary map file format to the given file */
+
+void PrintExportStats (FILE* F);
+/* Print hash table fill statistics for --stats */
+
 void PrintImportMap (FILE* F);
 /* Print an import map to the given file */
 
@@ -0,0 +1,325 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                 farcall.c                                 */
+/*                                                                           */
+/*            Far call trampoline generation for the ld65 linker             */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+/* common */
+#include "addrsize.h"
+#include "coll.h"
+#include "exprdefs.h"
+#include "fragdefs.h"
+#include "print.h"
+#include "xmalloc.h"
+
+/* ld65 */
+#include "config.h"
+#include "error.h"
+#include "exports.h"
+#include "expr.h"
+#include "farcall.h"
+#include "fragment.h"
+#include "memarea.h"
+#include "objdata.h"
+#include "segments.h"
+#include "spool.h"
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* 6502 opcodes used in the trampoline template */
+#define OPC_JSR         0x20U
+#define OPC_JMP         0x4CU
+#define OPC_LDX_IMM     0xA2U
+#define OPC_LDA_IMM     0xA9U
+#define OPC_LDY_IMM     0xA0U
+
+/* Size of one trampoline: ldy #bank, lda #<target, ldx #>target, jmp disp */
+#define TRAMPOLINE_SIZE 9U
+
+/* Attributes of the FARCALL feature from the config file */
+static unsigned SegName     = INVALID_STRING_ID;  /* Trampoline segment */
+static unsigned Dispatch    = INVALID_STRING_ID;  /* Dispatch routine */
+static Import*  DispatchImp = 0;                  /* Its forced import */
+
+/* One synthesized trampoline */
+typedef struct Trampoline Trampoline;
+struct Trampoline {
+    Export*     Exp;            /* Call target */
+    unsigned    Offs;           /* Offset of the trampoline in its section */
+};
+
+/* All synthesized trampolines */
+static Collection Trampolines = STATIC_COLLECTION_INITIALIZER;
+
+
+
+/*****************************************************************************/
+/*                             Helper functions                              */
+/*****************************************************************************/
+
+
+
+static int GetSegBank (Segment* Seg, long* Bank)
+/* Determine the bank of the memory area the given segment will run in.
+** Return true and place the bank value in Bank if the area has a bank
+** attribute, return false if the segment is unbanked, that is, visible
+** no matter which bank is mapped in.
+*/
+{
+    /* Find the placement of the segment in the config */
+    SegDesc* S = CfgFindSegDesc (Seg->Name);
+    if (S == 0) {
+        /* Not placed by the config - treat as always visible */
+        return 0;
+    }
+
+    /* The run area is the one the code executes in */
+    if (S->Run->BankExpr == 0) {
+        return 0;
+    }
+
+    /* The trampolines load the bank as an immediate, so it must be known */
+    if (!IsConstExpr (S->Run->BankExpr)) {
+        Error ("Bank attribute of memory area '%s' is not constant",
+               GetString (S->Run->Name));
+    }
+    *Bank = GetExprVal (S->Run->BankExpr);
+    return 1;
+}
+
+
+
+static unsigned GetTrampoline (Export* E, long Bank, Section* Sec)
+/* Return the section offset of the trampoline for the given call target,
+** creating it if this is the first call to the target.
+*/
+{
+    unsigned    I;
+    Trampoline* T;
+    Fragment*   F;
+    ExprNode*   N;
+
+    /* One trampoline per target serves all callers */
+    for (I = 0; I < CollCount (&Trampolines); ++I) {
+        T = CollAtUnchecked (&Trampolines, I);
+        if (T->Exp == E) {
+            return T->Offs;
+        }
+    }
+
+    /* The bank is loaded as an immediate, so it must fit into a byte */
+    if (Bank < 0 || Bank > 0xFF) {
+        Error ("Bank %ld of far call target '%s' does not fit into a byte",
+               Bank, GetString (E->Name));
+    }
+
+    /* Create a new trampoline behind the existing ones */
+    T = xmalloc (sizeof (Trampoline));
+    T->Exp  = E;
+    T->Offs = CollCount (&Trampolines) * TRAMPOLINE_SIZE;
+    CollAppend (&Trampolines, T);
+
+    /* Generate the code. The target expression is shared with the export,
+    ** the same way the condes tables share it.
+    **
+    ** ldy #bank, lda #<target
+    */
+    F = NewFragment (FRAG_LITERAL, 3, Sec);
+    F->LitBuf[0] = OPC_LDY_IMM;
+    F->LitBuf[1] = (unsigned char) Bank;
+    F->LitBuf[2] = OPC_LDA_IMM;
+    F = NewFragment (FRAG_EXPR, 1, Sec);
+    N = NewExprNode (0, EXPR_BYTE0);
+    N->Left = E->Expr;
+    F->Expr = N;
+
+    /* ldx #>target */
+    F = NewFragment (FRAG_LITERAL, 1, Sec);
+    F->LitBuf[0] = OPC_LDX_IMM;
+    F = NewFragment (FRAG_EXPR, 1, Sec);
+    N = NewExprNode (0, EXPR_BYTE1);
+    N->Left = E->Expr;
+    F->Expr = N;
+
+    /* jmp dispatch */
+    F = NewFragment (FRAG_LITERAL, 1, Sec);
+    F->LitBuf[0] = OPC_JMP;
+    F = NewFragment (FRAG_EXPR, 2, Sec);
+    N = NewExprNode (0, EXPR_SYMBOL);
+    N->V.Imp = DispatchImp;
+    F->Expr = N;
+
+    return T->Offs;
+}
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+int FarCallDeclared (void)
+/* Return true if the FARCALL feature was declared in the config file */
+{
+    return SegName != INVALID_STRING_ID;
+}
+
+
+
+void FarCallSetup (unsigned SegmentName, unsigned DispatchName)
+/* Set the attributes of the FARCALL feature: The name of the segment the
+** trampolines go into and the name of the dispatch routine they jump to.
+** Called from the config file parser, so the forced import of the dispatch
+** routine is inserted before the input files are processed and drags the
+** routine in from a library like any referenced module.
+*/
+{
+    SegName     = SegmentName;
+    Dispatch    = DispatchName;
+    DispatchImp = InsertImport (GenImport (Dispatch, ADDR_SIZE_ABS));
+}
+
+
+
+void CreateFarCallTrampolines (void)
+/* Scan the code for jsr instructions whose target runs in a different bank
+** than the caller and redirect them through trampolines that are generated
+** into the configured segment. Must be called after all input files have
+** been read, but before segment placement.
+*/
+{
+    unsigned I, J;
+    Section* TrampSec = 0;
+    unsigned Count;
+
+    /* Nothing to do if the feature wasn't requested */
+    if (SegName == INVALID_STRING_ID) {
+        return;
+    }
+
+    /* Walk over the sections of all object files. Like with --relax-jsr,
+    ** finding the calls is a byte pattern match on the fragment lists,
+    ** since the object format has no notion of instruction boundaries: The
+    ** operand of a jsr to a relocatable target is a two byte expression
+    ** fragment and the jsr opcode itself is the last byte of the preceding
+    ** literal fragment. Data that matches the pattern and references a
+    ** banked symbol would be redirected as well, which is documented as a
+    ** limitation of the feature.
+    */
+    for (I = 0; I < CollCount (&ObjDataList); ++I) {
+        ObjData* O = CollAtUnchecked (&ObjDataList, I);
+        for (J = 0; J < CollCount (&O->Sections); ++J) {
+
+            Section*  Sec = CollAtUnchecked (&O->Sections, J);
+            Fragment* F;
+            long      CallerBank = 0;
+            int       CallerBanked;
+
+            /* Determine the bank the calling code runs in */
+            CallerBanked = GetSegBank (Sec->Seg, &CallerBank);
+
+            for (F = Sec->FragRoot; F; F = F->Next) {
+
+                Fragment*   Operand;
+                Import*     Imp;
+                Export*     E;
+                SegExprDesc D;
+                long        TargetBank = 0;
+
+                /* The fragment must be a literal ending with a jsr opcode,
+                ** followed by a two byte expression for a plain symbol.
+                */
+                if (F->Type != FRAG_LITERAL || F->Size < 1 ||
+                    F->LitBuf[F->Size-1] != OPC_JSR) {
+                    continue;
+                }
+                Operand = F->Next;
+                if (Operand == 0 || Operand->Type != FRAG_EXPR ||
+                    Operand->Size != 2 || Operand->Expr->Op != EXPR_SYMBOL) {
+                    continue;
+                }
+
+                /* Get the export for the call target. Unresolved imports
+                ** are reported later by the export check, local targets
+                ** live in the caller's section and therefore in its bank.
+                */
+                Imp = GetExprImport (Operand->Expr);
+                E = Imp->Exp;
+                if (E == 0) {
+                    continue;
+                }
+
+                /* Determine the segment the target lives in. Targets with
+                ** an absolute value - hardware entry points - are visible
+                ** in every bank.
+                */
+                GetSegExprVal (E->Expr, &D);
+                if (D.TooComplex || D.Seg == 0) {
+                    continue;
+                }
+
+                /* A trampoline is needed if the target is banked and the
+                ** caller runs in a different bank or in none at all.
+                */
+                if (!GetSegBank (D.Seg, &TargetBank)) {
+                    continue;
+                }
+                if (CallerBanked && CallerBank == TargetBank) {
+                    continue;
+                }
+
+                /* Create the section for the trampolines when the first
+                ** one is needed.
+                */
+                if (TrampSec == 0) {
+                    Segment* Seg = GetSegment (SegName, ADDR_SIZE_ABS, 0);
+                    TrampSec = NewSection (Seg, 1, ADDR_SIZE_ABS);
+                }
+
+                /* Redirect the call site to the trampoline. The object
+                ** pointer must be NULL, so the section is taken from the
+                ** expression itself instead of the object's section list.
+                */
+                Operand->Expr = SectionExpr (TrampSec,
+                                             GetTrampoline (E, TargetBank, TrampSec),
+                                             0);
+            }
+        }
+    }
+
+    /* Print a summary if verbose */
+    Count = CollCount (&Trampolines);
+    Print (stdout, 1, "Created %u far call trampoline%s\n", Count,
+           (Count == 1)? "" : "s");
+}
@@ -0,0 +1,63 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                 farcall.h                                 */
+/*                                                                           */
+/*            Far call trampoline generation for the ld65 linker             */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#ifndef FARCALL_H
+#define FARCALL_H
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+int FarCallDeclared (void);
+/* Return true if the FARCALL feature was declared in the config file */
+
+void FarCallSetup (unsigned SegName, unsigned Dispatch);
+/* Set the attributes of the FARCALL feature: The name of the segment the
+** trampolines go into and the name of the dispatch routine they jump to.
+** Called from the config file parser, so the forced import of the dispatch
+** routine is inserted before the input files are processed and drags the
+** routine in from a library like any referenced module.
+*/
+
+void CreateFarCallTrampolines (void);
+/* Scan the code for jsr instructions whose target runs in a different bank
+** than the caller and redirect them through trampolines that are generated
+** into the configured segment. Must be called after all input files have
+** been read, but before segment placement.
+*/
+
+
+
+/* End of farcall.h */
+
+#endif
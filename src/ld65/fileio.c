@@ -42,16 +42,44 @@
 /* ld65 */
 #include "error.h"
 #include "fileio.h"
+#include "global.h"
 #include "spool.h"
 
 
 
+/*****************************************************************************/
+/*                             Helper functions                              */
+/*****************************************************************************/
+
+
+
+static void ReadError (FILE* F)
+/* Bail out with a read error */
+{
+    long Pos = ftell (F);
+    Error ("Read error at position %ld (file corrupt?)", Pos);
+}
+
+
+
 /*****************************************************************************/
 /*                                   Code                                    */
 /*****************************************************************************/
 
 
 
+void FileSetBigBuf (FILE* F)
+/* Give the file a big I/O buffer. Called right after opening the binary
+** output files, which are written as a long stream of small and medium
+** sized chunks, so fewer and larger transfers to the OS help. Errors are
+** ignored, since the default buffer works as well, just slower.
+*/
+{
+    (void) setvbuf (F, 0, _IOFBF, 64 * 1024U);
+}
+
+
+
 void FileSetPos (FILE* F, unsigned long Pos)
 /* Seek to the given absolute position, fail on errors */
 {
@@ -87,8 +115,10 @@ void Write8 (FILE* F, unsigned Val)
 void Write16 (FILE* F, unsigned Val)
 /* Write a 16 bit value to the file */
 {
-    Write8 (F, (unsigned char) Val);
-    Write8 (F, (unsigned char) (Val >> 8));
+    unsigned char Buf[2];
+    Buf[0] = (unsigned char) Val;
+    Buf[1] = (unsigned char) (Val >> 8);
+    WriteData (F, Buf, sizeof (Buf));
 }
 
 
@@ -96,9 +126,11 @@ void Write16 (FILE* F, unsigned Val)
 void Write24 (FILE* F, unsigned long Val)
 /* Write a 24 bit value to the file */
 {
-    Write8 (F, (unsigned char) Val);
-    Write8 (F, (unsigned char) (Val >> 8));
-    Write8 (F, (unsigned char) (Val >> 16));
+    unsigned char Buf[3];
+    Buf[0] = (unsigned char) Val;
+    Buf[1] = (unsigned char) (Val >> 8);
+    Buf[2] = (unsigned char) (Val >> 16);
+    WriteData (F, Buf, sizeof (Buf));
 }
 
 
@@ -106,10 +138,12 @@ void Write24 (FILE* F, unsigned long Val)
 void Write32 (FILE* F, unsigned long Val)
 /* Write a 32 bit value to the file */
 {
-    Write8 (F, (unsigned char) Val);
-    Write8 (F, (unsigned char) (Val >> 8));
-    Write8 (F, (unsigned char) (Val >> 16));
-    Write8 (F, (unsigned char) (Val >> 24));
+    unsigned char Buf[4];
+    Buf[0] = (unsigned char) Val;
+    Buf[1] = (unsigned char) (Val >> 8);
+    Buf[2] = (unsigned char) (Val >> 16);
+    Buf[3] = (unsigned char) (Val >> 24);
+    WriteData (F, Buf, sizeof (Buf));
 }
 
 
@@ -186,7 +220,35 @@ void WriteData (FILE* F, const void* Data, unsigned Size)
 void WriteMult (FILE* F, unsigned char Val, unsigned long Count)
 /* Write one byte several times to the file */
 {
-    while (Count--) {
+    unsigned char Buf[1024];
+
+    /* If requested, encode long stretches of zero fill as a seek, which
+    ** produces sparse files on file systems that support them. Seeking to
+    ** the last byte of the stretch and writing it keeps the file size
+    ** correct even when the stretch ends the file.
+    */
+    if (SparseFiles && Val == 0 && Count > sizeof (Buf)) {
+        if (fseek (F, (long) (Count - 1), SEEK_CUR) != 0) {
+            Error ("Seek error (disk full?)");
+        }
+        Write8 (F, Val);
+        return;
+    }
+
+    /* Fill areas are written in buffer sized chunks instead of one byte at
+    ** a time, since they may be very large (fill bytes for whole memory
+    ** areas).
+    */
+    if (Count > 1) {
+        memset (Buf, Val, (size_t) (Count < sizeof (Buf)? Count : sizeof (Buf)));
+        while (Count >= sizeof (Buf)) {
+            WriteData (F, Buf, sizeof (Buf));
+            Count -= sizeof (Buf);
+        }
+        if (Count > 0) {
+            WriteData (F, Buf, (unsigned) Count);
+        }
+    } else if (Count == 1) {
         Write8 (F, Val);
     }
 }
@@ -198,8 +260,7 @@ unsigned Read8 (FILE* F)
 {
     int C = getc (F);
     if (C == EOF) {
-        long Pos = ftell (F);
-        Error ("Read error at position %ld (file corrupt?)", Pos);
+        ReadError (F);
     }
     return C;
 }
@@ -209,9 +270,11 @@ unsigned Read8 (FILE* F)
 unsigned Read16 (FILE* F)
 /* Read a 16 bit value from the file */
 {
-    unsigned Lo = Read8 (F);
-    unsigned Hi = Read8 (F);
-    return (Hi << 8) | Lo;
+    unsigned char Buf[2];
+    if (fread (Buf, 1, sizeof (Buf), F) != sizeof (Buf)) {
+        ReadError (F);
+    }
+    return ((unsigned) Buf[1] << 8) | Buf[0];
 }
 
 
@@ -219,9 +282,12 @@ unsigned Read16 (FILE* F)
 unsigned long Read24 (FILE* F)
 /* Read a 24 bit value from the file */
 {
-    unsigned long Lo = Read16 (F);
-    unsigned long Hi = Read8 (F);
-    return (Hi << 16) | Lo;
+    unsigned char Buf[3];
+    if (fread (Buf, 1, sizeof (Buf), F) != sizeof (Buf)) {
+        ReadError (F);
+    }
+    return ((unsigned long) Buf[2] << 16) |
+           ((unsigned long) Buf[1] <<  8) | Buf[0];
 }
 
 
@@ -229,9 +295,13 @@ unsigned long Read24 (FILE* F)
 unsigned long Read32 (FILE* F)
 /* Read a 32 bit value from the file */
 {
-    unsigned long Lo = Read16 (F);
-    unsigned long Hi = Read16 (F);
-    return (Hi << 16) | Lo;
+    unsigned char Buf[4];
+    if (fread (Buf, 1, sizeof (Buf), F) != sizeof (Buf)) {
+        ReadError (F);
+    }
+    return ((unsigned long) Buf[3] << 24) |
+           ((unsigned long) Buf[2] << 16) |
+           ((unsigned long) Buf[1] <<  8) | Buf[0];
 }
 
 
@@ -326,8 +396,7 @@ void* ReadData (FILE* F, void* Data, unsigned Size)
     /* Explicitly allow reading zero bytes */
     if (Size > 0) {
         if (fread (Data, 1, Size, F) != Size) {
-            long Pos = ftell (F);
-            Error ("Read error at position %ld (file corrupt?)", Pos);
+            ReadError (F);
         }
     }
     return Data;
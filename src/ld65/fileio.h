@@ -51,6 +51,13 @@
 
 
 
+void FileSetBigBuf (FILE* F);
+/* Give the file a big I/O buffer. Called right after opening the binary
+** output files, which are written as a long stream of small and medium
+** sized chunks, so fewer and larger transfers to the OS help. Errors are
+** ignored, since the default buffer works as well, just slower.
+*/
+
 void FileSetPos (FILE* F, unsigned long Pos);
 /* Seek to the given absolute position, fail on errors */
 
@@ -0,0 +1,317 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                   gc.c                                    */
+/*                                                                           */
+/*              Dead section elimination for the ld65 linker                 */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#include <string.h>
+
+/* common */
+#include "attrib.h"
+#include "cddefs.h"
+#include "coll.h"
+#include "exprdefs.h"
+#include "fragdefs.h"
+#include "xmalloc.h"
+
+/* ld65 */
+#include "exports.h"
+#include "expr.h"
+#include "fragment.h"
+#include "gc.h"
+#include "objdata.h"
+#include "segments.h"
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* List of exports marked during the mark phase. The exports are marked using
+** the generic export mark, which is also used for circular reference
+** detection, so all marks must be removed before the gc is done.
+*/
+static Collection       MarkedExports = STATIC_COLLECTION_INITIALIZER;
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+/* Forwards */
+static void GcMarkExpr (ExprNode* E);
+
+
+
+static void GcMarkExport (Export* E)
+/* Mark an export and everything reachable from its value as live */
+{
+    /* Ignore unresolved externals - they are diagnosed later */
+    if (E == 0 || ExportHasMark (E)) {
+        return;
+    }
+
+    /* Mark the export and remember it, so the mark can be removed later */
+    MarkExport (E);
+    CollAppend (&MarkedExports, E);
+
+    /* The value of the export references the section it lives in */
+    if (E->Expr) {
+        GcMarkExpr (E->Expr);
+    }
+}
+
+
+
+static void GcMarkSection (Section* S)
+/* Mark a section and everything referenced by its fragments as live */
+{
+    Fragment* F;
+
+    /* Bail out if the section was already visited */
+    if (S->Live) {
+        return;
+    }
+    S->Live = 1;
+
+    /* Walk over all fragments and follow the expressions */
+    for (F = S->FragRoot; F; F = F->Next) {
+        if (F->Type == FRAG_EXPR || F->Type == FRAG_SEXPR) {
+            GcMarkExpr (F->Expr);
+        }
+    }
+}
+
+
+
+static void GcMarkExpr (ExprNode* E)
+/* Mark everything that is referenced by the given expression as live */
+{
+    if (E == 0) {
+        return;
+    }
+
+    if (EXPR_IS_LEAF (E->Op)) {
+        switch (E->Op) {
+
+            case EXPR_SYMBOL:
+                /* Follow the import to the matching export */
+                GcMarkExport (GetExprImport (E)->Exp);
+                break;
+
+            case EXPR_SECTION:
+                /* Direct reference to a section */
+                GcMarkSection (GetExprSection (E));
+                break;
+
+            default:
+                /* Literals, segments and memory areas don't reference
+                ** sections.
+                */
+                break;
+        }
+    } else {
+        GcMarkExpr (E->Left);
+        GcMarkExpr (E->Right);
+    }
+}
+
+
+
+static void GcMarkExportModule (const Export* E)
+/* Mark all sections of the module that contains the given export as live.
+** Used for imports that exist to force linkage of a whole module: the
+** export may be an absolute marker symbol (like __EXEHDR__) that doesn't
+** reference the sections of its module at all.
+*/
+{
+    if (E != 0 && E->Obj != 0) {
+        unsigned I;
+        for (I = 0; I < CollCount (&E->Obj->Sections); ++I) {
+            GcMarkSection (CollAtUnchecked (&E->Obj->Sections, I));
+        }
+    }
+}
+
+
+
+static void GcCollectImportRefs (ExprNode* E, const ObjData* O, unsigned char* Ref)
+/* Walk over the given expression and flag all imports of the object file O
+** that are referenced by it.
+*/
+{
+    if (E == 0) {
+        return;
+    }
+
+    if (EXPR_IS_LEAF (E->Op)) {
+        if (E->Op == EXPR_SYMBOL && E->Obj == O) {
+            Ref[E->V.ImpNum] = 1;
+        }
+    } else {
+        GcCollectImportRefs (E->Left, O, Ref);
+        GcCollectImportRefs (E->Right, O, Ref);
+    }
+}
+
+
+
+static void GcMarkForcedImports (void)
+/* Mark the exports of all forced imports as gc roots. A forced import
+** (.FORCEIMPORT in the assembler) is an import that is not referenced by
+** any fragment expression of the importing module. It exists for the sole
+** purpose of dragging in another module, so the section it refers to must
+** be kept.
+*/
+{
+    unsigned I, J;
+
+    /* Walk over all object files */
+    for (I = 0; I < CollCount (&ObjDataList); ++I) {
+
+        unsigned char* Ref;
+
+        /* Get the object file */
+        ObjData* O = CollAtUnchecked (&ObjDataList, I);
+
+        /* Ignore object files without imports */
+        unsigned Count = CollCount (&O->Imports);
+        if (Count == 0) {
+            continue;
+        }
+
+        /* Flag all imports that are referenced by fragment expressions */
+        Ref = xmalloc (Count);
+        memset (Ref, 0, Count);
+        for (J = 0; J < CollCount (&O->Sections); ++J) {
+            const Section* Sec = CollAtUnchecked (&O->Sections, J);
+            const Fragment* F;
+            for (F = Sec->FragRoot; F; F = F->Next) {
+                if (F->Type == FRAG_EXPR || F->Type == FRAG_SEXPR) {
+                    GcCollectImportRefs (F->Expr, O, Ref);
+                }
+            }
+        }
+
+        /* The exports of all unreferenced imports are roots. Since the
+        ** import was made to force linkage of the exporting module, keep
+        ** the complete module.
+        */
+        for (J = 0; J < Count; ++J) {
+            if (!Ref[J]) {
+                const Import* Imp = CollAtUnchecked (&O->Imports, J);
+                GcMarkExport (Imp->Exp);
+                GcMarkExportModule (Imp->Exp);
+            }
+        }
+        xfree (Ref);
+    }
+}
+
+
+
+static void GcMarkRootExport (Export* E, void* Data attribute ((unused)))
+/* Mark the given export as a gc root if it must stay in the output file
+** even without a reference from live code.
+*/
+{
+    Import*  I;
+    unsigned Type;
+
+    /* Exports imported by the linker itself (--force-import, imports from
+    ** the config file) are roots.
+    */
+    for (I = E->ImpList; I; I = I->Next) {
+        if (I->Obj == 0) {
+            GcMarkExport (E);
+            GcMarkExportModule (E);
+            return;
+        }
+    }
+
+    /* Constructors and destructors are called via the condes tables, so
+    ** there is never an explicit reference to them.
+    */
+    for (Type = 0; Type < CD_TYPE_COUNT; ++Type) {
+        if (E->ConDes[Type] != CD_PRIO_NONE) {
+            GcMarkExport (E);
+            return;
+        }
+    }
+}
+
+
+
+void RemoveDeadSections (void)
+/* Mark all sections that are reachable from one of the root sections
+** (sections from object files given on the command line, the condes tables,
+** and sections containing symbols imported by the linker itself) and remove
+** the contents of all others. Called when --gc-sections is in effect, after
+** all input files have been read and before the segments are placed.
+*/
+{
+    unsigned I, J;
+
+    /* Object files given on the command line are fully linked, so all of
+    ** their sections are roots. Only sections from library modules may get
+    ** removed.
+    */
+    for (I = 0; I < CollCount (&ObjDataList); ++I) {
+        ObjData* O = CollAtUnchecked (&ObjDataList, I);
+        if (O->Lib == 0) {
+            for (J = 0; J < CollCount (&O->Sections); ++J) {
+                GcMarkSection (CollAtUnchecked (&O->Sections, J));
+            }
+        }
+    }
+
+    /* Mark the exports that are roots by themselves. Everything else is
+    ** reached transitively: the condes tables generated by the linker are
+    ** referenced via their table labels, and live code references the
+    ** sections of the symbols it imports.
+    */
+    VisitExports (GcMarkRootExport, 0);
+
+    /* Forced imports drag in sections without referencing them */
+    GcMarkForcedImports ();
+
+    /* Remove the contents of all sections not marked live */
+    SweepDeadSections ();
+
+    /* Remove the marks from the exports, since the export mark is shared
+    ** with the circular reference detection.
+    */
+    for (I = 0; I < CollCount (&MarkedExports); ++I) {
+        UnmarkExport (CollAtUnchecked (&MarkedExports, I));
+    }
+    DoneCollection (&MarkedExports);
+}
@@ -0,0 +1,53 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                   gc.h                                    */
+/*                                                                           */
+/*              Dead section elimination for the ld65 linker                 */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#ifndef GC_H
+#define GC_H
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+void RemoveDeadSections (void);
+/* Mark all sections that are reachable from one of the root sections
+** (sections from object files given on the command line, the condes tables,
+** and sections containing symbols imported by the linker itself) and remove
+** the contents of all others. Called when --gc-sections is in effect, after
+** all input files have been read and before the segments are placed.
+*/
+
+
+
+/* End of gc.h */
+
+#endif
@@ -53,9 +53,18 @@ unsigned char HaveStartAddr = 0;        /* Start address not given */
 unsigned long StartAddr     = 0x200;    /* Start address */
 
 unsigned char VerboseMap     = 0;       /* Verbose map file */
+unsigned char BinMapFile     = 0;       /* Use the binary map file format */
+unsigned char Stats          = 0;       /* Print link statistics */
 unsigned char AllowMultDef   = 0;       /* Allow multiple definitions */
 unsigned char LargeAlignment = 0;       /* Don't warn about large alignments */
+unsigned char GcSections     = 0;       /* Remove unreferenced sections */
+unsigned char Icf            = 0;       /* Fold identical sections */
+unsigned char PackSegs       = 0;       /* Pack sections within segments */
+unsigned char RelaxJsr       = 0;       /* Rewrite jsr/rts into jmp */
+long          StackBudget    = -1;      /* Stack depth budget, < 0 = no check */
+unsigned char SparseFiles    = 0;       /* Use seeks for zero fill areas */
 
+const char* ProfileName     = 0;        /* Name of the execution profile */
 const char* MapFileName     = 0;        /* Name of the map file */
 const char* LabelFileName   = 0;        /* Name of the label file */
 const char* DbgFileName     = 0;        /* Name of the debug file */
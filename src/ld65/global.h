@@ -53,9 +53,18 @@ extern unsigned char    HaveStartAddr;  /* True if start address was given */
 extern unsigned long    StartAddr;      /* Start address */
 
 extern unsigned char    VerboseMap;     /* Verbose map file */
+extern unsigned char    BinMapFile;     /* Use the binary map file format */
+extern unsigned char    Stats;          /* Print link statistics */
 extern unsigned char    AllowMultDef;   /* Allow multiple definitions */
 extern unsigned char    LargeAlignment; /* Don't warn about large alignments */
-
+extern unsigned char    GcSections;     /* Remove unreferenced sections */
+extern unsigned char    Icf;            /* Fold identical sections */
+extern unsigned char    PackSegs;       /* Pack sections within segments */
+extern unsigned char    RelaxJsr;       /* Rewrite jsr/rts into jmp */
+extern long             StackBudget;    /* Stack depth budget, < 0 = no check */
+extern unsigned char    SparseFiles;    /* Use seeks for zero fill areas */
+
+extern const char*      ProfileName;    /* Name of the execution profile */
 extern const char*      MapFileName;    /* Name of the map file */
 extern const char*      LabelFileName;  /* Name of the label file */
 extern const char*      DbgFileName;    /* Name of the debug file */
@@ -0,0 +1,309 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                   icf.c                                   */
+/*                                                                           */
+/*              Identical section folding for the ld65 linker                */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#include <string.h>
+
+/* common */
+#include "check.h"
+#include "coll.h"
+#include "exprdefs.h"
+#include "fragdefs.h"
+#include "print.h"
+#include "xmalloc.h"
+
+/* ld65 */
+#include "exports.h"
+#include "expr.h"
+#include "fragment.h"
+#include "icf.h"
+#include "objdata.h"
+#include "segments.h"
+#include "spool.h"
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+static unsigned HashSection (const Section* Sec)
+/* Calculate a hash value over the fragment structure and the literal bytes
+** of a section. Relocation targets are not hashed, they are checked in the
+** full comparison, so the hash stays valid when references get redirected.
+*/
+{
+    unsigned  H = Sec->Size;
+    Fragment* F;
+
+    for (F = Sec->FragRoot; F; F = F->Next) {
+        H = H * 33 + F->Type;
+        H = H * 33 + F->Size;
+        if (F->Type == FRAG_LITERAL) {
+            unsigned I;
+            for (I = 0; I < F->Size; ++I) {
+                H = H * 33 + F->LitBuf[I];
+            }
+        }
+    }
+    return H;
+}
+
+
+
+static int EqualSectionExpr (ExprNode* E1, ExprNode* E2)
+/* Compare two fragment expressions. Other than EqualExpr, symbol references
+** are compared by the export they resolve to, so imports of the same symbol
+** from different modules are recognized as identical.
+*/
+{
+    /* If one pointer is NULL, both must be NULL */
+    if ((E1 == 0) ^ (E2 == 0)) {
+        return 0;
+    }
+    if (E1 == 0) {
+        return 1;
+    }
+
+    /* Both pointers not NULL, check OP */
+    if (E1->Op != E2->Op) {
+        return 0;
+    }
+
+    /* OPs are identical, check data for leafs, or subtrees */
+    switch (E1->Op) {
+
+        case EXPR_LITERAL:
+            return (E1->V.IVal == E2->V.IVal);
+
+        case EXPR_SYMBOL:
+            /* Compare the exports the imports are resolved to. Unresolved
+            ** imports are never considered identical.
+            */
+            {
+                const Export* Exp = GetExprImport (E1)->Exp;
+                return (Exp != 0 && Exp == GetExprImport (E2)->Exp);
+            }
+
+        case EXPR_SECTION:
+            return (GetExprSection (E1) == GetExprSection (E2));
+
+        case EXPR_SEGMENT:
+            return (E1->V.Seg == E2->V.Seg);
+
+        case EXPR_MEMAREA:
+            return (E1->V.Mem == E2->V.Mem);
+
+        default:
+            /* Not a leaf node */
+            return EqualSectionExpr (E1->Left, E2->Left) &&
+                   EqualSectionExpr (E1->Right, E2->Right);
+    }
+}
+
+
+
+static int EqualSections (const Section* A, const Section* B)
+/* Compare the contents of two sections byte for byte, including the targets
+** of the contained expressions.
+*/
+{
+    const Fragment* FA = A->FragRoot;
+    const Fragment* FB = B->FragRoot;
+
+    while (FA != 0 && FB != 0) {
+
+        /* Type and size of each fragment must match */
+        if (FA->Type != FB->Type || FA->Size != FB->Size) {
+            return 0;
+        }
+
+        switch (FA->Type) {
+
+            case FRAG_LITERAL:
+                if (memcmp (FA->LitBuf, FB->LitBuf, FA->Size) != 0) {
+                    return 0;
+                }
+                break;
+
+            case FRAG_EXPR:
+            case FRAG_SEXPR:
+                if (!EqualSectionExpr (FA->Expr, FB->Expr)) {
+                    return 0;
+                }
+                break;
+
+            case FRAG_FILL:
+                /* Sizes are equal, that's all there is */
+                break;
+        }
+
+        FA = FA->Next;
+        FB = FB->Next;
+    }
+
+    /* Both lists must end here */
+    return (FA == 0 && FB == 0);
+}
+
+
+
+static void FoldSection (Section* B, Section* A)
+/* Redirect all references to section B to section A and drop the contents
+** of B. Expressions reference sections by an index into the section list of
+** their object file, so replacing B by A there redirects everything,
+** including the exports and debug info of B's module.
+*/
+{
+    int Idx = CollIndex (&B->Obj->Sections, B);
+    CHECK (Idx >= 0);
+    CollReplace (&B->Obj->Sections, A, Idx);
+
+    /* Drop the contents of B. The section stays in the segment list with a
+    ** size of zero. The expressions may be shared with exports, so the
+    ** fragments aren't freed.
+    */
+    B->FragRoot  = 0;
+    B->FragLast  = 0;
+    B->Size      = 0;
+    B->Alignment = 1;
+}
+
+
+
+static unsigned FoldSegment (Segment* Seg, unsigned long* Bytes)
+/* Fold the identical sections of one segment. Returns the number of folded
+** sections and adds the folded bytes to *Bytes.
+*/
+{
+    unsigned  Folded = 0;
+    unsigned  Count  = CollCount (&Seg->Sections);
+    unsigned* Hash;
+    unsigned  I, J;
+
+    if (Count < 2) {
+        return 0;
+    }
+
+    /* Hash all sections once */
+    Hash = xmalloc (Count * sizeof (unsigned));
+    for (I = 0; I < Count; ++I) {
+        Hash[I] = HashSection (CollConstAt (&Seg->Sections, I));
+    }
+
+    /* Compare all candidate pairs */
+    for (I = 0; I < Count; ++I) {
+
+        Section* A = CollAtUnchecked (&Seg->Sections, I);
+
+        /* Skip empty sections and linker generated ones */
+        if (A->Size == 0 || A->Obj == 0) {
+            continue;
+        }
+
+        for (J = I + 1; J < Count; ++J) {
+
+            Section* B = CollAtUnchecked (&Seg->Sections, J);
+
+            if (B->Size == 0 || B->Obj == 0 ||
+                Hash[J] != Hash[I]          ||
+                B->Size != A->Size) {
+                continue;
+            }
+
+            /* A fold must not lower the alignment of the folded section */
+            if (B->Alignment != 1 && (A->Alignment % B->Alignment) != 0) {
+                continue;
+            }
+
+            /* Do the full comparison and fold B into A on a match */
+            if (EqualSections (A, B)) {
+                Print (stdout, 2, "Folding section '%s' of module '%s' into "
+                       "module '%s'\n", GetString (Seg->Name),
+                       GetObjFileName (B->Obj), GetObjFileName (A->Obj));
+                *Bytes += B->Size;
+                FoldSection (B, A);
+                ++Folded;
+            }
+        }
+    }
+
+    xfree (Hash);
+    return Folded;
+}
+
+
+
+void FoldIdenticalSections (void)
+/* Find sections in the CODE and RODATA segments that are byte for byte
+** identical, including the targets of their relocations, keep one copy of
+** each and redirect all references to the others to it. Only used with
+** --icf. Must be called after all input files have been read and before the
+** segments are placed.
+*/
+{
+    /* Segments that are candidates for folding. Both are read only and are
+    ** never written to the output more than once.
+    */
+    static const char* const SegNames[] = { "CODE", "RODATA" };
+
+    unsigned      Folded = 0;
+    unsigned long Bytes  = 0;
+    unsigned      I;
+    unsigned      Changes;
+
+    /* Folding one pair may turn sections that referenced the two copies
+    ** into identical ones, so repeat until nothing changes.
+    */
+    do {
+        Changes = 0;
+        for (I = 0; I < sizeof (SegNames) / sizeof (SegNames[0]); ++I) {
+            Segment* Seg = SegFind (GetStringId (SegNames[I]));
+            if (Seg != 0) {
+                Changes += FoldSegment (Seg, &Bytes);
+            }
+        }
+        Folded += Changes;
+    } while (Changes > 0);
+
+    /* Reassign the offsets in the changed segments */
+    if (Folded > 0) {
+        for (I = 0; I < sizeof (SegNames) / sizeof (SegNames[0]); ++I) {
+            Segment* Seg = SegFind (GetStringId (SegNames[I]));
+            if (Seg != 0) {
+                SegRecalcOffsets (Seg);
+            }
+        }
+    }
+
+    /* Print a summary if verbose */
+    Print (stdout, 1, "Folded %u identical section%s (%lu bytes)\n",
+           Folded, (Folded == 1)? "" : "s", Bytes);
+}
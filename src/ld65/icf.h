@@ -0,0 +1,53 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                   icf.h                                   */
+/*                                                                           */
+/*              Identical section folding for the ld65 linker                */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#ifndef ICF_H
+#define ICF_H
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+void FoldIdenticalSections (void);
+/* Find sections in the CODE and RODATA segments that are byte for byte
+** identical, including the targets of their relocations, keep one copy of
+** each and redirect all references to the others to it. Only used with
+** --icf. Must be called after all input files have been read and before the
+** segments are placed.
+*/
+
+
+
+/* End of icf.h */
+
+#endif
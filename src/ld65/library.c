@@ -70,6 +70,19 @@ struct Library {
     FILE*       F;              /* Open file stream */
     LibHeader   Header;         /* Library header */
     Collection  Modules;        /* Modules */
+    Collection  Exports;        /* Export index read from the library */
+    unsigned*   StrPool;        /* Shared string pool (global string ids) */
+    unsigned    StrPoolCount;   /* Number of strings in the shared pool */
+};
+
+/* One entry of the export index of a library. The entries are created from
+** the export index that ar65 writes behind the member index, so the linker
+** knows which module exports which name without reading the modules.
+*/
+typedef struct LibExport LibExport;
+struct LibExport {
+    unsigned    Name;           /* Global string id of the export name */
+    ObjData*    O;              /* Module that exports the name */
 };
 
 /* List of open libraries */
@@ -100,6 +113,9 @@ static Library* NewLibrary (FILE* F, const char* Name)
     L->Name     = GetStringId (Name);
     L->F        = F;
     L->Modules  = EmptyCollection;
+    L->Exports  = EmptyCollection;
+    L->StrPool  = 0;
+    L->StrPoolCount = 0;
 
     /* Return the new struct */
     return L;
@@ -115,6 +131,11 @@ static void CloseLibrary (Library* L)
         Error ("Error closing '%s': %s", GetString (L->Name), strerror (errno));
     }
     L->F = 0;
+
+    /* The shared string pool is only needed while reading members */
+    xfree (L->StrPool);
+    L->StrPool = 0;
+    L->StrPoolCount = 0;
 }
 
 
@@ -128,6 +149,9 @@ static void FreeLibrary (Library* L)
     /* Free the module index */
     DoneCollection (&L->Modules);
 
+    /* Free the export index */
+    DoneCollection (&L->Exports);
+
     /* Free the library structure */
     xfree (L);
 }
@@ -230,6 +254,31 @@ static ObjData* ReadIndexEntry (Library* L)
 
 
 
+static void LibReadObjStrPool (Library* L, ObjData* O)
+/* Read the string pool of a member that references the shared string pool
+** of the library instead of carrying the strings itself.
+*/
+{
+    unsigned I;
+
+    /* Seek to the string pool section of the member */
+    LibSeek (L, O->Start + O->Header.StrPoolOffs);
+
+    /* Read the pool indices and resolve them against the shared pool */
+    O->StringCount = ReadVar (L->F);
+    O->Strings = xmalloc (O->StringCount * sizeof (O->Strings[0]));
+    for (I = 0; I < O->StringCount; ++I) {
+        unsigned Id = ReadVar (L->F);
+        if (Id >= L->StrPoolCount) {
+            Error ("Invalid string pool index in library '%s'",
+                   GetString (L->Name));
+        }
+        O->Strings[I] = L->StrPool[Id];
+    }
+}
+
+
+
 static void ReadBasicData (Library* L, ObjData* O)
 /* Read basic data for an object file that is necessary to resolve external
 ** references.
@@ -239,8 +288,14 @@ static void ReadBasicData (Library* L, ObjData* O)
     LibSeek (L, O->Start);
     LibReadObjHeader (L, O);
 
-    /* Read the string pool */
-    ObjReadStrPool (L->F, O->Start + O->Header.StrPoolOffs, O);
+    /* Read the string pool. Members of a library with a shared string pool
+    ** reference the shared pool instead of carrying the strings.
+    */
+    if ((L->Header.Flags & LIB_FLAG_STRPOOL) != 0) {
+        LibReadObjStrPool (L, O);
+    } else {
+        ObjReadStrPool (L->F, O->Start + O->Header.StrPoolOffs, O);
+    }
 
     /* Read the files list */
     ObjReadFiles (L->F, O->Start + O->Header.FileOffs, O);
@@ -253,6 +308,9 @@ static void ReadBasicData (Library* L, ObjData* O)
 
     /* Read the exports */
     ObjReadExports (L->F, O->Start + O->Header.ExportOffs, O);
+
+    /* Remember that we have the basic data */
+    O->Flags |= OBJ_BASICDATA;
 }
 
 
@@ -274,8 +332,50 @@ static void LibReadIndex (Library* L)
         CollAppend (&L->Modules, ReadIndexEntry (L));
     }
 
-    /* Walk over the index and read basic data for all object files in the
-    ** library.
+    /* If the library has a checksum table, it follows the member index with
+    ** one flag byte and a 32 bit checksum per member. Only the archiver
+    ** evaluates the checksums, so just read over the table.
+    */
+    if ((L->Header.Flags & LIB_FLAG_HASHTAB) != 0) {
+        for (I = 0; I < CollCount (&L->Modules); ++I) {
+            Read8 (L->F);
+            Read32 (L->F);
+        }
+    }
+
+    /* If the library has a shared string pool, it follows the checksum
+    ** table. The string pool sections of the members hold indices into this
+    ** pool instead of the strings themselves. ReadStr interns the strings
+    ** into the global string pool, so the table maps pool indices to global
+    ** string ids.
+    */
+    if ((L->Header.Flags & LIB_FLAG_STRPOOL) != 0) {
+        L->StrPoolCount = ReadVar (L->F);
+        L->StrPool = xmalloc (L->StrPoolCount * sizeof (L->StrPool[0]));
+        for (I = 0; I < L->StrPoolCount; ++I) {
+            L->StrPool[I] = ReadStr (L->F);
+        }
+    }
+
+    /* If the library has an export index, read it. It follows the member
+    ** index and tells us which module exports which name, so basic data is
+    ** needed only for the modules that are actually used and is read on
+    ** demand when a module is added to the link.
+    */
+    if ((L->Header.Flags & LIB_FLAG_EXPINDEX) != 0) {
+        unsigned Count = ReadVar (L->F);
+        CollGrow (&L->Exports, Count);
+        while (Count--) {
+            LibExport* E = xmalloc (sizeof (*E));
+            E->Name = ReadStr (L->F);
+            E->O    = CollAt (&L->Modules, ReadVar (L->F));
+            CollAppend (&L->Exports, E);
+        }
+        return;
+    }
+
+    /* No export index: Walk over the index and read basic data for all
+    ** object files in the library.
     */
     for (I = 0; I < CollCount (&L->Modules); ++I) {
         ReadBasicData (L, CollAtUnchecked (&L->Modules, I));
@@ -290,21 +390,104 @@ static void LibReadIndex (Library* L)
 
 
 
-static void LibCheckExports (ObjData* O)
-/* Check if the exports from this file can satisfy any import requests. If so,
-** insert the imports and exports from this file and mark the file as added.
+/* Export index used while resolving. It maps the name id of an export to
+** the first module in search order that exports it, so the module that
+** satisfies an unresolved import can be found directly instead of walking
+** all modules of all open libraries again and again.
+*/
+typedef struct ExportIndexNode ExportIndexNode;
+struct ExportIndexNode {
+    ExportIndexNode*    Next;           /* Next node in hash chain */
+    unsigned            Name;           /* Name id of the export */
+    ObjData*            O;              /* Module exporting the name */
+};
+
+/* The export index hash table. Only valid while LibResolve runs. */
+#define EXP_INDEX_SLOTS 1024U           /* Must be a power of two */
+static ExportIndexNode* ExpIndex[EXP_INDEX_SLOTS];
+
+
+
+static void ExpIndexInsert (unsigned Name, ObjData* O)
+/* Insert one export into the index. If the name is already known, the entry
+** is left alone, so the first module in search order wins.
+*/
+{
+    ExportIndexNode** Slot = &ExpIndex[Name & (EXP_INDEX_SLOTS - 1)];
+    ExportIndexNode* N;
+    for (N = *Slot; N != 0; N = N->Next) {
+        if (N->Name == Name) {
+            return;
+        }
+    }
+    N = xmalloc (sizeof (*N));
+    N->Next = *Slot;
+    N->Name = Name;
+    N->O    = O;
+    *Slot   = N;
+}
+
+
+
+static ObjData* ExpIndexFind (unsigned Name)
+/* Return the module exporting the given name or NULL if there is none */
+{
+    const ExportIndexNode* N = ExpIndex[Name & (EXP_INDEX_SLOTS - 1)];
+    while (N != 0) {
+        if (N->Name == Name) {
+            return N->O;
+        }
+        N = N->Next;
+    }
+    return 0;
+}
+
+
+
+static void ExpIndexFree (void)
+/* Free all nodes of the export index */
+{
+    unsigned I;
+    for (I = 0; I < EXP_INDEX_SLOTS; ++I) {
+        ExportIndexNode* N = ExpIndex[I];
+        while (N != 0) {
+            ExportIndexNode* Next = N->Next;
+            xfree (N);
+            N = Next;
+        }
+        ExpIndex[I] = 0;
+    }
+}
+
+
+
+static void LibAddModule (ObjData* O)
+/* Add a module to the link: Mark it as referenced and insert its imports and
+** exports into the global lists. Modules needed to satisfy this module's own
+** imports are added transitively using the export index.
 */
 {
     unsigned I;
 
-    /* Check all exports */
-    for (I = 0; I < CollCount (&O->Exports); ++I) {
-        const Export* E = CollConstAt (&O->Exports, I);
-        if (IsUnresolved (E->Name)) {
-           /* We need this module, insert the imports and exports */
-            O->Flags |= OBJ_REF;
-            InsertObjGlobals (O);
-            break;
+    /* If the library has an export index, basic data is read on demand for
+    ** the modules that are used, so read it now if we don't have it.
+    */
+    if ((O->Flags & OBJ_BASICDATA) == 0) {
+        ReadBasicData (O->Lib, O);
+    }
+
+    /* Add the module itself */
+    O->Flags |= OBJ_REF;
+    InsertObjGlobals (O);
+
+    /* Satisfy the imports of the added module */
+    for (I = 0; I < CollCount (&O->Imports); ++I) {
+        const Import* Imp = CollConstAt (&O->Imports, I);
+        if (IsUnresolved (Imp->Name)) {
+            ObjData* P = ExpIndexFind (Imp->Name);
+            if (P != 0 && (P->Flags & OBJ_REF) == 0) {
+                LibAddModule (P);
+            }
         }
     }
 }
@@ -332,43 +515,87 @@ static void LibOpen (FILE* F, const char* Name)
 static void LibResolve (void)
 /* Resolve all externals from the list of all currently open libraries */
 {
-    unsigned I, J;
-    unsigned Additions;
+    unsigned I, J, K;
 
-    /* Walk repeatedly over all open libraries until there's nothing more
-    ** to add.
-    */
-    do {
+    /* Build the export index over all modules that weren't added before */
+    for (I = 0; I < CollCount (&OpenLibs); ++I) {
+        Library* L = CollAt (&OpenLibs, I);
+        if (CollCount (&L->Exports) > 0) {
+            /* Use the export index read from the library */
+            for (J = 0; J < CollCount (&L->Exports); ++J) {
+                const LibExport* E = CollConstAt (&L->Exports, J);
+                if ((E->O->Flags & OBJ_REF) == 0) {
+                    ExpIndexInsert (E->Name, E->O);
+                }
+            }
+            continue;
+        }
+        for (J = 0; J < CollCount (&L->Modules); ++J) {
+            ObjData* O = CollAtUnchecked (&L->Modules, J);
+            if ((O->Flags & OBJ_REF) == 0) {
+                for (K = 0; K < CollCount (&O->Exports); ++K) {
+                    const Export* E = CollConstAt (&O->Exports, K);
+                    ExpIndexInsert (E->Name, O);
+                }
+            }
+        }
+    }
 
-        Additions = 0;
+    /* Walk the modules once in search order. Each module that satisfies a
+    ** currently unresolved import is added, together with the modules that
+    ** its own imports need, which are found through the export index. This
+    ** replaces repeated full scans over all modules until a fixpoint was
+    ** reached.
+    */
+    for (I = 0; I < CollCount (&OpenLibs); ++I) {
 
-        /* Walk over all libraries */
-        for (I = 0; I < CollCount (&OpenLibs); ++I) {
+        /* Get the next library */
+        Library* L = CollAt (&OpenLibs, I);
 
-            /* Get the next library */
-            Library* L = CollAt (&OpenLibs, I);
+        if (CollCount (&L->Exports) > 0) {
 
-            /* Walk through all modules in this library and check for each
-            ** module if there are unresolved externals in existing modules
-            ** that may be resolved by adding the module.
+            /* Walk the export index, which lists the exports in module
+            ** order, so the search order stays the same.
             */
-            for (J = 0; J < CollCount (&L->Modules); ++J) {
+            for (J = 0; J < CollCount (&L->Exports); ++J) {
+                const LibExport* E = CollConstAt (&L->Exports, J);
+                if ((E->O->Flags & OBJ_REF) == 0 && IsUnresolved (E->Name)) {
+                    /* We need this module */
+                    LibAddModule (E->O);
+                }
+            }
+            continue;
+        }
 
-                /* Get the next module */
-                ObjData* O = CollAtUnchecked (&L->Modules, J);
+        /* Walk through all modules in this library */
+        for (J = 0; J < CollCount (&L->Modules); ++J) {
 
-                /* We only need to check this module if it wasn't added before */
-                if ((O->Flags & OBJ_REF) == 0) {
-                    LibCheckExports (O);
-                    if (O->Flags & OBJ_REF) {
-                        /* The routine added the file */
-                        ++Additions;
+            /* Get the next module */
+            ObjData* O = CollAtUnchecked (&L->Modules, J);
+
+            /* We only need to check this module if it wasn't added before */
+            if ((O->Flags & OBJ_REF) == 0) {
+                for (K = 0; K < CollCount (&O->Exports); ++K) {
+                    const Export* E = CollConstAt (&O->Exports, K);
+                    if (IsUnresolved (E->Name)) {
+                        /* We need this module */
+                        LibAddModule (O);
+                        break;
                     }
                 }
             }
         }
+    }
 
-    } while (Additions > 0);
+    /* The indices aren't needed any longer */
+    ExpIndexFree ();
+    for (I = 0; I < CollCount (&OpenLibs); ++I) {
+        Library* L = CollAt (&OpenLibs, I);
+        for (J = 0; J < CollCount (&L->Exports); ++J) {
+            xfree (CollAt (&L->Exports, J));
+        }
+        CollDeleteAll (&L->Exports);
+    }
 
     /* We do know now which modules must be added, so we can load the data
     ** for these modues into memory. Since we're walking over all modules
@@ -397,6 +624,9 @@ static void LibResolve (void)
                 /* Read the assertions from the object file */
                 ObjReadAssertions (L->F, O->Start + O->Header.AssertOffs, O);
 
+                /* Read the options from the object file */
+                ObjReadOptions (L->F, O->Start + O->Header.OptionOffs, O);
+
                 /* Seek to the start of the segment list and read the segments.
                 ** This must be late, since the data here may reference other
                 ** stuff.
@@ -36,6 +36,7 @@
 /* common */
 #include "check.h"
 #include "lidefs.h"
+#include "strbuf.h"
 #include "xmalloc.h"
 
 /* ld65 */
@@ -141,13 +142,82 @@ LineInfo* ReadLineInfo (FILE* F, ObjData* O)
 
 
 
+void ReadLineInfoLists (FILE* F, ObjData* O)
+/* Read the table of interned line info lists from the object file. The table
+** follows the line infos, which must have been read before.
+*/
+{
+    /* Read the number of lists that follow */
+    unsigned ListCount = ReadVar (F);
+
+    /* Grow the collection as needed */
+    CollGrow (&O->LineInfoLists, ListCount);
+
+    /* Read the lists and resolve the indices */
+    while (ListCount--) {
+
+        /* Read the number of line info indices in this list */
+        unsigned LineInfoCount = ReadVar (F);
+
+        /* Create a new list and fill it */
+        Collection* List = NewCollection ();
+        CollGrow (List, LineInfoCount);
+        while (LineInfoCount--) {
+
+            /* Read an index */
+            unsigned LineInfoIndex = ReadVar (F);
+
+            /* The line info index was written by the assembler and must
+            ** therefore be part of the line infos read from the object file.
+            */
+            if (LineInfoIndex >= CollCount (&O->LineInfos)) {
+                Internal ("Invalid line info index %u in module '%s' - max is %u",
+                          LineInfoIndex,
+                          GetObjFileName (O),
+                          CollCount (&O->LineInfos));
+            }
+
+            /* Add the line info to the list */
+            CollAppend (List, CollAt (&O->LineInfos, LineInfoIndex));
+        }
+
+        /* Add the list to the table */
+        CollAppend (&O->LineInfoLists, List);
+    }
+}
+
+
+
 void ReadLineInfoList (FILE* F, ObjData* O, Collection* LineInfos)
 /* Read a list of line infos stored as a list of indices in the object file,
 ** make real line infos from them and place them into the passed collection.
 */
 {
+    unsigned LineInfoCount;
+
+    /* If the object file has interned line info lists, only an index into
+    ** the table of lists is stored.
+    */
+    if (OBJ_HAS_LILISTS (O->Header.Flags)) {
+
+        /* Read the index of the list */
+        unsigned ListIndex = ReadVar (F);
+
+        /* The index must be part of the table read from the object file */
+        if (ListIndex >= CollCount (&O->LineInfoLists)) {
+            Internal ("Invalid line info list index %u in module '%s' - max is %u",
+                      ListIndex,
+                      GetObjFileName (O),
+                      CollCount (&O->LineInfoLists));
+        }
+
+        /* Copy the line infos from the list */
+        CollTransfer (LineInfos, CollAt (&O->LineInfoLists, ListIndex));
+        return;
+    }
+
     /* Read the number of line info indices that follow */
-    unsigned LineInfoCount = ReadVar (F);
+    LineInfoCount = ReadVar (F);
 
     /* Grow the collection as needed */
     CollGrow (LineInfos, LineInfoCount);
@@ -246,6 +316,8 @@ void PrintDbgLineInfo (FILE* F)
 /* Output the line infos to a debug info file */
 {
     unsigned I, J;
+    const LineInfo* LI;
+    StrBuf Line = STATIC_STRBUF_INITIALIZER;
 
     /* Print line infos from all modules we have linked into the output file */
     for (I = 0; I < CollCount (&ObjDataList); ++I) {
@@ -254,33 +326,43 @@ void PrintDbgLineInfo (FILE* F)
         const ObjData* O = CollAtUnchecked (&ObjDataList, I);
 
         /* Output the line infos */
-        for (J = 0; J < CollCount (&O->LineInfos); ++J) {
-
-            /* Get this line info */
-            const LineInfo* LI = CollConstAt (&O->LineInfos, J);
+        CollForEach (&O->LineInfos, J, LI, const LineInfo*) {
 
             /* Get the line info type and count */
             unsigned Type  = LI_GET_TYPE (LI->Type);
             unsigned Count = LI_GET_COUNT (LI->Type);
 
-            /* Print the start of the line */
-            fprintf (F,
-                     "line\tid=%u,file=%u,line=%u",
-                     LI->Id, LI->File->Id, GetSourceLine (LI));
+            /* Format the record in memory, then write it with one call.
+            ** This is cheaper than using fprintf for each field, since the
+            ** format string doesn't need to be parsed over and over again.
+            */
+            SB_Clear (&Line);
+            SB_AppendStr (&Line, "line\tid=");
+            SB_AppendUnsigned (&Line, LI->Id);
+            SB_AppendStr (&Line, ",file=");
+            SB_AppendUnsigned (&Line, LI->File->Id);
+            SB_AppendStr (&Line, ",line=");
+            SB_AppendUnsigned (&Line, GetSourceLine (LI));
 
             /* Print type if not LI_TYPE_ASM and count if not zero */
             if (Type != LI_TYPE_ASM) {
-                fprintf (F, ",type=%u", Type);
+                SB_AppendStr (&Line, ",type=");
+                SB_AppendUnsigned (&Line, Type);
             }
             if (Count != 0) {
-                fprintf (F, ",count=%u", Count);
+                SB_AppendStr (&Line, ",count=");
+                SB_AppendUnsigned (&Line, Count);
             }
 
             /* Add spans if the line info has it */
-            PrintDbgSpanList (F, O, LI->Spans);
+            AppendDbgSpanList (&Line, O, LI->Spans);
 
-            /* Terminate line */
-            fputc ('\n', F);
+            /* Terminate and output the line */
+            SB_AppendChar (&Line, '\n');
+            fwrite (SB_GetConstBuf (&Line), 1, SB_GetLen (&Line), F);
         }
     }
+
+    /* Free the string buffer */
+    SB_Done (&Line);
 }
@@ -100,6 +100,11 @@ void FreeLineInfo (LineInfo* LI);
 LineInfo* DupLineInfo (const LineInfo* LI);
 /* Creates a duplicate of a line info structure */
 
+void ReadLineInfoLists (FILE* F, struct ObjData* O);
+/* Read the table of interned line info lists from the object file. The table
+** follows the line infos, which must have been read before.
+*/
+
 void ReadLineInfoList (FILE* F, struct ObjData* O, Collection* LineInfos);
 /* Read a list of line infos stored as a list of indices in the object file,
 ** make real line infos from them and place them into the passed collection.
@@ -37,6 +37,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <time.h>
 
 /* common */
 #include "addrsize.h"
@@ -58,15 +59,22 @@
 #include "dbgfile.h"
 #include "error.h"
 #include "exports.h"
+#include "farcall.h"
 #include "fileio.h"
 #include "filepath.h"
+#include "gc.h"
 #include "global.h"
+#include "icf.h"
 #include "library.h"
 #include "mapfile.h"
 #include "objfile.h"
+#include "pack.h"
+#include "profile.h"
+#include "relax.h"
 #include "scanner.h"
 #include "segments.h"
 #include "spool.h"
+#include "stackuse.h"
 #include "tpool.h"
 
 
@@ -134,17 +142,27 @@ static void Usage (void)
             "  --dbgfile name\t\tGenerate debug information\n"
             "  --define sym=val\t\tDefine a symbol\n"
             "  --end-group\t\t\tEnd a library group\n"
+            "  --forbid-import sym\t\tFail if symbol 'sym' is imported\n"
             "  --force-import sym\t\tForce an import of symbol 'sym'\n"
+            "  --gc-sections\t\t\tRemove unreferenced sections\n"
             "  --help\t\t\tHelp (this text)\n"
+            "  --icf\t\t\t\tFold identical sections\n"
             "  --large-alignment\t\tDon't warn about large alignments\n"
             "  --lib file\t\t\tLink this library\n"
             "  --lib-path path\t\tSpecify a library search path\n"
+            "  --map-format fmt\t\tSelect the map file format (text, binary)\n"
             "  --mapfile name\t\tCreate a map file\n"
             "  --module-id id\t\tSpecify a module id\n"
             "  --obj file\t\t\tLink this object file\n"
             "  --obj-path path\t\tSpecify an object file search path\n"
+            "  --pack-segs\t\t\tReorder sections to cut alignment padding\n"
+            "  --profile name\t\tReorder sections by an execution profile\n"
+            "  --relax-jsr\t\t\tRewrite jsr/rts sequences to jmp\n"
+            "  --sparse\t\t\tWrite zero filled areas as sparse file holes\n"
+            "  --stack-budget n\t\tFail if the worst case stack depth exceeds n\n"
             "  --start-addr addr\t\tSet the default start address\n"
             "  --start-group\t\t\tStart a library group\n"
+            "  --stats\t\t\tPrint link statistics\n"
             "  --target sys\t\t\tSet the target system\n"
             "  --version\t\t\tPrint the linker version\n",
             ProgName);
@@ -179,12 +197,32 @@ static unsigned long CvtNumber (const char* Arg, const char* Number)
 
 
 
+/* Separate read timers for object files and libraries, filled in LinkFile
+** and reported with --stats.
+*/
+static clock_t ObjReadTime;
+static clock_t LibReadTime;
+
+
+
+static void PrintPhaseTime (const char* Name, clock_t Ticks)
+/* Print one phase timer line for --stats. The output is one tab separated
+** line per phase: "phase <name> <microseconds>".
+*/
+{
+    fprintf (stderr, "phase\t%s\t%lu\n",
+             Name, (unsigned long) (Ticks * 1000000.0 / CLOCKS_PER_SEC));
+}
+
+
+
 static void LinkFile (const char* Name, FILETYPE Type)
 /* Handle one file */
 {
     char*         PathName;
     FILE*         F;
     unsigned long Magic;
+    clock_t       Start;
 
 
     /* If we don't know the file type, determine it from the extension */
@@ -225,6 +263,11 @@ static void LinkFile (const char* Name, FILETYPE Type)
         Error ("Cannot open '%s': %s", PathName, strerror (errno));
     }
 
+    /* Reading object files and library members means lots of small reads,
+    ** so use a large input buffer.
+    */
+    (void) setvbuf (F, 0, _IOFBF, 0x10000);
+
     /* Read the magic word */
     Magic = Read32 (F);
 
@@ -237,12 +280,16 @@ static void LinkFile (const char* Name, FILETYPE Type)
     switch (Magic) {
 
         case OBJ_MAGIC:
+            Start = clock ();
             ObjAdd (F, PathName);
+            ObjReadTime += clock () - Start;
             ++ObjFiles;
             break;
 
         case LIB_MAGIC:
+            Start = clock ();
             LibAdd (F, PathName);
+            LibReadTime += clock () - Start;
             ++LibFiles;
             break;
 
@@ -359,6 +406,14 @@ static void OptEndGroup (const char* Opt attribute ((unused)),
 
 
 
+static void OptForbidImport (const char* Opt attribute ((unused)), const char* Arg)
+/* Fail the link if the given symbol is imported */
+{
+    ForbidImport (Arg);
+}
+
+
+
 static void OptForceImport (const char* Opt attribute ((unused)), const char* Arg)
 /* Force an import of a symbol */
 {
@@ -407,6 +462,24 @@ static void OptHelp (const char* Opt attribute ((unused)),
 
 
 
+static void OptGcSections (const char* Opt attribute ((unused)),
+                           const char* Arg attribute ((unused)))
+/* Remove unreferenced sections */
+{
+    GcSections = 1;
+}
+
+
+
+static void OptIcf (const char* Opt attribute ((unused)),
+                    const char* Arg attribute ((unused)))
+/* Fold identical sections */
+{
+    Icf = 1;
+}
+
+
+
 static void OptLargeAlignment (const char* Opt attribute ((unused)),
                                const char* Arg attribute ((unused)))
 /* Don't warn about large alignments */
@@ -445,6 +518,20 @@ static void OptMapFile (const char* Opt attribute ((unused)), const char* Arg)
 
 
 
+static void OptMapFormat (const char* Opt attribute ((unused)), const char* Arg)
+/* Select the format of the map file */
+{
+    if (strcmp (Arg, "text") == 0) {
+        BinMapFile = 0;
+    } else if (strcmp (Arg, "binary") == 0) {
+        BinMapFile = 1;
+    } else {
+        Error ("Invalid map file format: '%s'", Arg);
+    }
+}
+
+
+
 static void OptModuleId (const char* Opt, const char* Arg)
 /* Specify a module id */
 {
@@ -489,6 +576,49 @@ static void OptOutputName (const char* Opt attribute ((unused)), const char* Arg
 
 
 
+static void OptPackSegs (const char* Opt attribute ((unused)),
+                         const char* Arg attribute ((unused)))
+/* Reorder sections within segments to cut alignment padding */
+{
+    PackSegs = 1;
+}
+
+
+
+static void OptProfile (const char* Opt attribute ((unused)), const char* Arg)
+/* Give the name of an execution profile used to reorder sections */
+{
+    ProfileName = Arg;
+}
+
+
+
+static void OptRelaxJsr (const char* Opt attribute ((unused)),
+                         const char* Arg attribute ((unused)))
+/* Rewrite jsr/rts sequences to jmp */
+{
+    RelaxJsr = 1;
+}
+
+
+
+static void OptSparse (const char* Opt attribute ((unused)),
+                       const char* Arg attribute ((unused)))
+/* Write zero filled areas as sparse file holes */
+{
+    SparseFiles = 1;
+}
+
+
+
+static void OptStackBudget (const char* Opt, const char* Arg)
+/* Set the stack depth budget for the stack usage check */
+{
+    StackBudget = (long) CvtNumber (Opt, Arg);
+}
+
+
+
 static void OptStartAddr (const char* Opt, const char* Arg)
 /* Set the default start address */
 {
@@ -510,6 +640,15 @@ static void OptStartGroup (const char* Opt attribute ((unused)),
 
 
 
+static void OptStats (const char* Opt attribute ((unused)),
+                      const char* Arg attribute ((unused)))
+/* Print link statistics */
+{
+    Stats = 1;
+}
+
+
+
 static void OptTarget (const char* Opt attribute ((unused)), const char* Arg)
 /* Set the target system */
 {
@@ -624,17 +763,27 @@ static void ParseCommandLine(void)
         { "--dbgfile",                   1,      OptDbgFile              },
         { "--define",                    1,      OptDefine               },
         { "--end-group",                 0,      CmdlOptEndGroup         },
+        { "--forbid-import",             1,      OptForbidImport         },
         { "--force-import",              1,      OptForceImport          },
+        { "--gc-sections",               0,      OptGcSections           },
         { "--help",                      0,      OptHelp                 },
+        { "--icf",                       0,      OptIcf                  },
         { "--large-alignment",           0,      OptLargeAlignment       },
         { "--lib",                       1,      OptLib                  },
         { "--lib-path",                  1,      OptLibPath              },
+        { "--map-format",                1,      OptMapFormat            },
         { "--mapfile",                   1,      OptMapFile              },
         { "--module-id",                 1,      OptModuleId             },
         { "--obj",                       1,      OptObj                  },
         { "--obj-path",                  1,      OptObjPath              },
+        { "--pack-segs",                 0,      OptPackSegs             },
+        { "--profile",                   1,      OptProfile              },
+        { "--relax-jsr",                 0,      OptRelaxJsr             },
+        { "--sparse",                    0,      OptSparse               },
+        { "--stack-budget",              1,      OptStackBudget          },
         { "--start-addr",                1,      OptStartAddr            },
         { "--start-group",               0,      CmdlOptStartGroup       },
+        { "--stats",                     0,      OptStats                },
         { "--target",                    1,      CmdlOptTarget           },
         { "--version",                   0,      OptVersion              },
     };
@@ -789,6 +938,7 @@ int main (int argc, char* argv [])
 /* Linker main program */
 {
     unsigned MemoryAreaOverflows;
+    clock_t Start;
 
     /* Initialize the cmdline module */
     InitCmdLine (&argc, &argv, "ld65");
@@ -818,21 +968,76 @@ int main (int argc, char* argv [])
     /* Check if we have open library groups */
     LibCheckGroup ();
 
+    /* Report the input phase timers */
+    if (Stats) {
+        PrintPhaseTime ("objread", ObjReadTime);
+        PrintPhaseTime ("libscan", LibReadTime);
+        xmemreport (stderr, "input");
+    }
+
     /* Create the condes tables if requested */
+    Start = clock ();
     ConDesCreate ();
 
+    /* Remove unreferenced sections if requested */
+    if (GcSections) {
+        RemoveDeadSections ();
+    }
+
+    /* Fold identical sections if requested */
+    if (Icf) {
+        FoldIdenticalSections ();
+    }
+
+    /* Create far call trampolines if requested. This must happen before
+    ** tail call relaxation, which would otherwise hide cross bank calls.
+    */
+    CreateFarCallTrampolines ();
+
+    /* Rewrite jsr/rts sequences if requested */
+    if (RelaxJsr) {
+        RelaxTailCalls ();
+    }
+
+    /* Reorder sections by execution profile if one was given */
+    ApplyProfile ();
+
+    /* Reorder sections within segments to cut alignment padding if
+    ** requested. Must run after the profile, whose weight order it keeps.
+    */
+    if (PackSegs) {
+        PackSegments ();
+    }
+
     /* Process data from the config file. Assign start addresses for the
     ** segments, define linker symbols. The function will return the number
     ** of memory area overflows (zero on success).
     */
     MemoryAreaOverflows = CfgProcess ();
 
+    /* Placement is done, so export values are final and may be cached */
+    FreezeExportVals ();
+
     /* Check module assertions */
     CheckAssertions ();
 
     /* Check for import/export mismatches */
     CheckExports ();
 
+    /* Check for imports of forbidden symbols */
+    CheckForbiddenImports ();
+
+    /* Check the worst case stack depth if a budget was given */
+    CheckStackUse ();
+
+    /* Report the config processing phase, which includes symbol resolution
+    ** and the expression evaluation done for segment placement.
+    */
+    if (Stats) {
+        PrintPhaseTime ("config", clock () - Start);
+        xmemreport (stderr, "config");
+    }
+
     /* If we had a memory area overflow before, we cannot generate the output
     ** file. However, we will generate a short map file if requested, since
     ** this will help the user to rearrange segments and fix the overflow.
@@ -846,11 +1051,20 @@ int main (int argc, char* argv [])
     }
 
     /* Create the output file */
+    Start = clock ();
     CfgWriteTarget ();
 
     /* Check for segments not written to the output file */
     CheckSegments ();
 
+    /* Report the output phase, which includes the expression evaluation
+    ** done for relocation.
+    */
+    if (Stats) {
+        PrintPhaseTime ("output", clock () - Start);
+        xmemreport (stderr, "output");
+    }
+
     /* If requested, create a map file and a label file for VICE */
     if (MapFileName) {
         CreateMapFile (LONG_MAPFILE);
@@ -862,6 +1076,12 @@ int main (int argc, char* argv [])
         CreateDbgFile ();
     }
 
+    /* Print the remaining statistics */
+    if (Stats) {
+        PrintObjStats (stderr);
+        PrintExportStats (stderr);
+    }
+
     /* Dump the data for debugging */
     if (Verbosity > 1) {
         SegDump ();
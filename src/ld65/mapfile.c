@@ -43,6 +43,7 @@
 #include "exports.h"
 #include "global.h"
 #include "error.h"
+#include "fileio.h"
 #include "library.h"
 #include "mapfile.h"
 #include "objdata.h"
@@ -51,25 +52,79 @@
 
 
 
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* Magic number and version of the binary map file format */
+#define MAP_MAGIC       0x3570614DUL    /* "Map5" */
+#define MAP_VERSION     1U
+
+
+
 /*****************************************************************************/
 /*                                   Code                                    */
 /*****************************************************************************/
 
 
 
+static void CreateBinMapFile (void)
+/* Create a map file in the binary format. The file starts with a header
+** (32 bit magic, 16 bit version), followed by the segment and export
+** lists. Counts and strings use the same variable length encoding as the
+** object file format, fixed sized values are little endian.
+*/
+{
+    /* Open the map file */
+    FILE* F = fopen (MapFileName, "wb");
+    if (F == 0) {
+        Error ("Cannot create map file '%s': %s", MapFileName, strerror (errno));
+    }
+    FileSetBigBuf (F);
+
+    /* Write the header */
+    Write32 (F, MAP_MAGIC);
+    Write16 (F, MAP_VERSION);
+
+    /* Write the segment and export lists */
+    WriteBinSegments (F);
+    WriteBinExports (F);
+
+    /* Close the file */
+    if (fclose (F) != 0) {
+        Error ("Error closing map file '%s': %s", MapFileName, strerror (errno));
+    }
+}
+
+
+
 void CreateMapFile (int ShortMap)
 /* Create a map file. If ShortMap is true, only the segment lists are
 ** generated, not the import/export lists.
 */
 {
     unsigned I;
+    FILE* F;
+
+    /* Use the binary format if requested */
+    if (BinMapFile) {
+        CreateBinMapFile ();
+        return;
+    }
 
     /* Open the map file */
-    FILE* F = fopen (MapFileName, "w");
+    F = fopen (MapFileName, "w");
     if (F == 0) {
         Error ("Cannot create map file '%s': %s", MapFileName, strerror (errno));
     }
 
+    /* The map file is written as many small lines, so give it a larger
+    ** output buffer.
+    */
+    FileSetBigBuf (F);
+
     /* Write a modules list */
     fprintf (F, "Modules list:\n"
                 "-------------\n");
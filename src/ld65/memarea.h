@@ -82,6 +82,7 @@ struct MemoryArea {
 #define MF_RO           0x0004          /* Read only memory area */
 #define MF_OVERFLOW     0x0008          /* Memory area overflow */
 #define MF_PLACED       0x0010          /* Memory area was placed */
+#define MF_PACK         0x0020          /* Reorder segments to reduce fill */
 
 
 
@@ -1242,6 +1242,12 @@ static void O65SetupSegments (O65Desc* D, File* F)
             /* Get the segment */
             SegDesc* S = CollAtUnchecked (&M->SegList, J);
 
+            /* Compressed segments are only supported in the binary format */
+            if (S->Flags & SF_COMPRESSED) {
+                Error ("o65 format does not support compression for segment '%s'",
+                       GetString (S->Name));
+            }
+
             /* Check the segment type. */
             switch (O65SegType (S)) {
                 case O65SEG_TEXT:   D->TextCount++; break;
@@ -1374,6 +1380,7 @@ void O65WriteTarget (O65Desc* D, File* F)
     if (D->F == 0) {
         Error ("Cannot open '%s': %s", D->Filename, strerror (errno));
     }
+    FileSetBigBuf (D->F);
 
     /* Keep the user happy */
     Print (stdout, 1, "Opened '%s'...\n", D->Filename);
@@ -43,8 +43,10 @@
 #include "error.h"
 #include "exports.h"
 #include "fileinfo.h"
+#include "fragment.h"
 #include "library.h"
 #include "objdata.h"
+#include "segments.h"
 #include "spool.h"
 
 
@@ -90,9 +92,11 @@ ObjData* NewObjData (void)
     O->DbgSyms          = EmptyCollection;
     O->HLLDbgSyms       = EmptyCollection;
     O->LineInfos        = EmptyCollection;
+    O->LineInfoLists    = EmptyCollection;
     O->StringCount      = 0;
     O->Strings          = 0;
     O->Assertions       = EmptyCollection;
+    O->StackUses        = EmptyCollection;
     O->Scopes           = EmptyCollection;
     O->Spans            = EmptyCollection;
 
@@ -130,8 +134,13 @@ void FreeObjData (ObjData* O)
         FreeLineInfo (CollAtUnchecked (&O->LineInfos, I));
     }
     DoneCollection (&O->LineInfos);
+    for (I = 0; I < CollCount (&O->LineInfoLists); ++I) {
+        FreeCollection (CollAtUnchecked (&O->LineInfoLists, I));
+    }
+    DoneCollection (&O->LineInfoLists);
     xfree (O->Strings);
     DoneCollection (&O->Assertions);
+    DoneCollection (&O->StackUses);
     DoneCollection (&O->Scopes);
     for (I = 0; I < CollCount (&O->Spans); ++I) {
         FreeSpan (CollAtUnchecked (&O->Spans, I));
@@ -309,3 +318,42 @@ void PrintDbgModules (FILE* F)
     }
 
 }
+
+
+
+void PrintObjStats (FILE* F)
+/* Print input file statistics for --stats. The output is one tab separated
+** line per module:
+** "module <name> <bytes> <sections> <fragments> <imports> <exports>".
+*/
+{
+    unsigned I;
+
+    for (I = 0; I < CollCount (&ObjDataList); ++I) {
+
+        /* Get this object file */
+        const ObjData* O = CollConstAt (&ObjDataList, I);
+
+        /* Sum up the section sizes and fragment counts */
+        unsigned long Bytes = 0;
+        unsigned long Frags = 0;
+        unsigned J;
+        for (J = 0; J < CollCount (&O->Sections); ++J) {
+            const Section* S = CollConstAt (&O->Sections, J);
+            const Fragment* Frag;
+            Bytes += S->Size;
+            for (Frag = S->FragRoot; Frag != 0; Frag = Frag->Next) {
+                ++Frags;
+            }
+        }
+
+        /* Output the line for the module */
+        fprintf (F, "module\t%s\t%lu\t%u\t%lu\t%u\t%u\n",
+                 GetObjFileName (O),
+                 Bytes,
+                 CollCount (&O->Sections),
+                 Frags,
+                 CollCount (&O->Imports),
+                 CollCount (&O->Exports));
+    }
+}
@@ -61,6 +61,7 @@ struct StrBuf;
 
 /* Values for the Flags field */
 #define OBJ_REF         0x0001          /* We have a reference to this file */
+#define OBJ_BASICDATA   0x0002          /* Basic data was read from the file */
 
 /* Internal structure holding object file data */
 typedef struct ObjData ObjData;
@@ -86,9 +87,11 @@ struct ObjData {
     Collection          DbgSyms;        /* List of debug symbols */
     Collection          HLLDbgSyms;     /* List of hll debug symbols */
     Collection          LineInfos;      /* List of line infos */
+    Collection          LineInfoLists;  /* Interned lists of line infos */
     unsigned            StringCount;    /* Count of strings */
     unsigned*           Strings;        /* List of global string indices */
     Collection          Assertions;     /* List of module assertions */
+    Collection          StackUses;      /* Stack usage annotations */
     Collection          Scopes;         /* List of scopes */
     Collection          Spans;          /* List of spans */
 };
@@ -170,6 +173,9 @@ unsigned ObjDataCount (void);
 void PrintDbgModules (FILE* F);
 /* Output the modules to a debug info file */
 
+void PrintObjStats (FILE* F);
+/* Print input file statistics for --stats */
+
 
 
 /* End of objdata.h */
@@ -37,6 +37,7 @@
 
 /* common */
 #include "fname.h"
+#include "optdefs.h"
 #include "xmalloc.h"
 
 /* ld65 */
@@ -46,6 +47,7 @@
 #include "exports.h"
 #include "fileinfo.h"
 #include "fileio.h"
+#include "global.h"
 #include "lineinfo.h"
 #include "objdata.h"
 #include "objfile.h"
@@ -191,6 +193,15 @@ void ObjReadDbgSyms (FILE* F, unsigned long Pos, ObjData* O)
     unsigned I;
     unsigned DbgSymCount;
 
+    /* Debug symbols are only used for the debug info and label files, so
+    ** don't waste time and memory parsing them if neither was requested.
+    ** All tables in the object file are located via stored offsets, so
+    ** nothing needs to skip over the unread data.
+    */
+    if (DbgFileName == 0 && LabelFileName == 0) {
+        return;
+    }
+
     /* Seek to the correct position */
     FileSetPos (F, Pos);
 
@@ -226,6 +237,13 @@ void ObjReadLineInfos (FILE* F, unsigned long Pos, ObjData* O)
     for (I = 0; I < LineInfoCount; ++I) {
         CollAppend (&O->LineInfos, ReadLineInfo (F, O));
     }
+
+    /* If the file has interned line info lists, read the table with the
+    ** lists that follows, since other sections reference it.
+    */
+    if (OBJ_HAS_LILISTS (O->Header.Flags)) {
+        ReadLineInfoLists (F, O);
+    }
 }
 
 
@@ -248,6 +266,35 @@ void ObjReadStrPool (FILE* F, unsigned long Pos, ObjData* O)
 
 
 
+void ObjReadOptions (FILE* F, unsigned long Pos, ObjData* O)
+/* Read the options from a file at the given position */
+{
+    unsigned I;
+    unsigned OptionCount;
+
+    /* Options are used only for the stack depth check, so don't waste time
+    ** parsing them if no check was requested.
+    */
+    if (StackBudget < 0) {
+        return;
+    }
+
+    /* Seek to the correct position */
+    FileSetPos (F, Pos);
+
+    /* Read the data, keeping only stack usage annotations */
+    OptionCount = ReadVar (F);
+    for (I = 0; I < OptionCount; ++I) {
+        unsigned char Type = Read8 (F);
+        unsigned long Val  = ReadVar (F);
+        if (Type == OPT_STACKUSE) {
+            CollAppend (&O->StackUses, (void*) GetObjString (O, Val));
+        }
+    }
+}
+
+
+
 void ObjReadAssertions (FILE* F, unsigned long Pos, ObjData* O)
 /* Read the assertions from a file at the given offset */
 {
@@ -273,6 +320,13 @@ void ObjReadScopes (FILE* F, unsigned long Pos, ObjData* O)
     unsigned I;
     unsigned ScopeCount;
 
+    /* Scopes are used only when generating a debug info file, so don't
+    ** waste time and memory parsing them if none was requested.
+    */
+    if (DbgFileName == 0) {
+        return;
+    }
+
     /* Seek to the correct position */
     FileSetPos (F, Pos);
 
@@ -292,6 +346,13 @@ void ObjReadSpans (FILE* F, unsigned long Pos, ObjData* O)
     unsigned I;
     unsigned SpanCount;
 
+    /* Like scopes, spans are used only when generating a debug info file,
+    ** so don't waste time and memory parsing them if none was requested.
+    */
+    if (DbgFileName == 0) {
+        return;
+    }
+
     /* Seek to the correct position */
     FileSetPos (F, Pos);
 
@@ -341,6 +402,9 @@ void ObjAdd (FILE* Obj, const char* Name)
     /* Read the assertions from the object file */
     ObjReadAssertions (Obj, O->Header.AssertOffs, O);
 
+    /* Read the options from the object file */
+    ObjReadOptions (Obj, O->Header.OptionOffs, O);
+
     /* Read the segment list from the object file. This must be late, since
     ** the expressions stored in the code may reference segments or imported
     ** symbols.
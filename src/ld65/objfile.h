@@ -78,6 +78,9 @@ void ObjReadStrPool (FILE* F, unsigned long Pos, ObjData* O);
 void ObjReadAssertions (FILE* F, unsigned long Pos, ObjData* O);
 /* Read the assertions from a file at the given offset */
 
+void ObjReadOptions (FILE* F, unsigned long Pos, ObjData* O);
+/* Read the options from a file at the given offset */
+
 void ObjReadScopes (FILE* F, unsigned long Pos, ObjData* O);
 /* Read the scope table from a file at the given offset */
 
@@ -0,0 +1,166 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                  pack.c                                   */
+/*                                                                           */
+/*             Alignment aware section packing for the ld65 linker           */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+/* common */
+#include "alignment.h"
+#include "coll.h"
+#include "print.h"
+#include "xmalloc.h"
+
+/* ld65 */
+#include "pack.h"
+#include "segments.h"
+#include "spool.h"
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+static unsigned long PackOneSegment (Segment* Seg)
+/* Pack the sections of one segment and return the number of saved fill
+** bytes. The segment is left untouched if no order with less padding is
+** found.
+*/
+{
+    unsigned      I, J;
+    unsigned long OldPadding, NewPadding;
+    unsigned long Size;
+    unsigned      Count = CollCount (&Seg->Sections);
+    Section**     Order;
+    unsigned char* Used;
+
+    /* The current amount of padding. If there is none, no order can be
+    ** better than the current one.
+    */
+    OldPadding = SegPadding (Seg);
+    if (Count < 2 || OldPadding == 0) {
+        return 0;
+    }
+
+    /* Build a new section order greedily: In each step place the section
+    ** that needs the fewest fill bytes at the current size. Hotter sections
+    ** are always placed before colder ones and the original order breaks
+    ** ties, so a reorder done by --profile is preserved and the result is
+    ** deterministic. The loop also adds up the padding of the new order,
+    ** using the same calculation as SegRecalcOffsets.
+    */
+    Order = xmalloc (Count * sizeof (Order[0]));
+    Used  = xmalloc (Count);
+    for (J = 0; J < Count; ++J) {
+        Used[J] = 0;
+    }
+    Size = 0;
+    NewPadding = 0;
+    for (I = 0; I < Count; ++I) {
+
+        unsigned      Best     = Count;
+        unsigned long BestFill = 0;
+
+        for (J = 0; J < Count; ++J) {
+            Section* Sec;
+            unsigned long Fill;
+            if (Used[J]) {
+                continue;
+            }
+            Sec  = CollAtUnchecked (&Seg->Sections, J);
+            Fill = AlignCount (Size, Sec->Alignment);
+            if (Best == Count) {
+                Best     = J;
+                BestFill = Fill;
+            } else {
+                const Section* BestSec = CollConstAt (&Seg->Sections, Best);
+                if (Sec->Weight > BestSec->Weight ||
+                    (Sec->Weight == BestSec->Weight && Fill < BestFill)) {
+                    Best     = J;
+                    BestFill = Fill;
+                }
+            }
+        }
+
+        /* Place the best candidate */
+        Used[Best]  = 1;
+        Order[I]    = CollAtUnchecked (&Seg->Sections, Best);
+        Size       += BestFill + Order[I]->Size;
+        NewPadding += BestFill;
+    }
+
+    /* Apply the new order only if it actually saves something */
+    if (NewPadding < OldPadding) {
+        for (I = 0; I < Count; ++I) {
+            CollReplace (&Seg->Sections, Order[I], I);
+        }
+        SegRecalcOffsets (Seg);
+    } else {
+        NewPadding = OldPadding;
+    }
+
+    /* Cleanup */
+    xfree (Order);
+    xfree (Used);
+
+    /* Return the saved bytes */
+    return OldPadding - NewPadding;
+}
+
+
+
+void PackSegments (void)
+/* Reorder the sections within each segment so that as few alignment fill
+** bytes as possible are needed. Sections keep their order relative to
+** sections of the same weight, so a reorder done by --profile is preserved.
+** Must be called after all link time optimizations, but before segment
+** placement.
+*/
+{
+    unsigned      I;
+    unsigned      Packed = 0;
+    unsigned long Saved  = 0;
+
+    /* Walk over all segments and pack each one */
+    for (I = 0; I < SegmentCount (); ++I) {
+
+        Segment* Seg = SegByIndex (I);
+        unsigned long SegSaved = PackOneSegment (Seg);
+
+        if (SegSaved > 0) {
+            Print (stdout, 2, "Packing segment '%s' saved %lu byte%s\n",
+                   GetString (Seg->Name), SegSaved, (SegSaved == 1)? "" : "s");
+            ++Packed;
+            Saved += SegSaved;
+        }
+    }
+
+    /* Print a summary if verbose */
+    Print (stdout, 1, "Packed %u segment%s, saved %lu alignment byte%s\n",
+           Packed, (Packed == 1)? "" : "s", Saved, (Saved == 1)? "" : "s");
+}
@@ -0,0 +1,53 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                  pack.h                                   */
+/*                                                                           */
+/*             Alignment aware section packing for the ld65 linker           */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#ifndef PACK_H
+#define PACK_H
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+void PackSegments (void);
+/* Reorder the sections within each segment so that as few alignment fill
+** bytes as possible are needed. Sections keep their order relative to
+** sections of the same weight, so a reorder done by --profile is preserved.
+** Must be called after all link time optimizations, but before segment
+** placement.
+*/
+
+
+
+/* End of pack.h */
+
+#endif
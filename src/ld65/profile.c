@@ -0,0 +1,308 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                 profile.c                                 */
+/*                                                                           */
+/*            Profile guided section placement for the ld65 linker           */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+/* common */
+#include "attrib.h"
+#include "coll.h"
+#include "exprdefs.h"
+#include "print.h"
+#include "xmalloc.h"
+
+/* ld65 */
+#include "config.h"
+#include "error.h"
+#include "exports.h"
+#include "expr.h"
+#include "global.h"
+#include "profile.h"
+#include "segments.h"
+#include "spool.h"
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* One symbol weight read from the profile */
+typedef struct ProfSym ProfSym;
+struct ProfSym {
+    char*           Name;       /* Name of the symbol */
+    unsigned long   Cycles;     /* Cycles spent in the symbol */
+};
+
+/* The symbol weights, sorted by name */
+static ProfSym* ProfSyms     = 0;
+static unsigned ProfSymCount = 0;
+
+
+
+/*****************************************************************************/
+/*                             Helper functions                              */
+/*****************************************************************************/
+
+
+
+static int CmpProfSym (const void* K1, const void* K2)
+/* Compare function for qsort and bsearch */
+{
+    return strcmp (((const ProfSym*) K1)->Name, ((const ProfSym*) K2)->Name);
+}
+
+
+
+static void ReadProfile (void)
+/* Read the symbol weights from the profile. The file is the one written by
+** sim65 with --profile and --profile-labels, of which only the symbol rollup
+** section is used: Lines of the form "name executions cycles" following a
+** comment line that announces the symbols. The per address sections are
+** skipped, since their addresses stem from a previous link and would be
+** invalidated by the very reordering they are read for.
+*/
+{
+    char Line[512];
+    char Name[256];
+    unsigned long Execs, Cycles;
+    int InSymbols = 0;
+    unsigned Size = 0;
+
+    /* Open the profile */
+    FILE* F = fopen (ProfileName, "r");
+    if (F == 0) {
+        Error ("Cannot open profile '%s': %s", ProfileName, strerror (errno));
+    }
+
+    /* Read the symbol lines */
+    while (fgets (Line, sizeof (Line), F) != 0) {
+        if (Line[0] == ';') {
+            /* A comment line starts a new section of the profile */
+            InSymbols = (strstr (Line, "symbols:") != 0);
+            continue;
+        }
+        if (!InSymbols ||
+            sscanf (Line, "%255s %lu %lu", Name, &Execs, &Cycles) != 3) {
+            continue;
+        }
+        if (ProfSymCount >= Size) {
+            Size = (Size == 0)? 256 : Size * 2;
+            ProfSyms = xrealloc (ProfSyms, Size * sizeof (*ProfSyms));
+        }
+        ProfSyms[ProfSymCount].Name   = xstrdup (Name);
+        ProfSyms[ProfSymCount].Cycles = Cycles;
+        ++ProfSymCount;
+    }
+    fclose (F);
+
+    /* Warn if there was nothing usable in the file */
+    if (ProfSymCount == 0) {
+        Warning ("Profile '%s' contains no symbol data - was sim65 run "
+                 "with --profile-labels?", ProfileName);
+    }
+
+    /* Sort the weights by name, so the exports can use a binary search */
+    qsort (ProfSyms, ProfSymCount, sizeof (*ProfSyms), CmpProfSym);
+}
+
+
+
+static Section* ExprSection (ExprNode* E)
+/* Return the section a symbol expression refers to, or NULL if it cannot be
+** determined. The expression of a relocatable export is a section offset,
+** possibly with a constant added.
+*/
+{
+    Section* S;
+
+    switch (E->Op) {
+
+        case EXPR_SECTION:
+            return GetExprSection (E);
+
+        case EXPR_PLUS:
+            S = ExprSection (E->Left);
+            return S? S : ExprSection (E->Right);
+
+        default:
+            return 0;
+
+    }
+}
+
+
+
+static void WeightExport (Export* E, void* Data attribute ((unused)))
+/* Add the cycles recorded for an export to the section that defines it */
+{
+    Section* Sec;
+    ProfSym  Key;
+    ProfSym* Sym;
+
+    /* Ignore undefined exports and exports with an absolute or otherwise
+    ** complex value - they don't name a section to reorder.
+    */
+    if (E->Expr == 0 || (Sec = ExprSection (E->Expr)) == 0) {
+        return;
+    }
+
+    /* Look up the weight of the symbol */
+    Key.Name = (char*) GetString (E->Name);
+    Sym = bsearch (&Key, ProfSyms, ProfSymCount, sizeof (*ProfSyms), CmpProfSym);
+    if (Sym) {
+        Sec->Weight += Sym->Cycles;
+    }
+}
+
+
+
+static int CmpSecWeight (void* Data attribute ((unused)),
+                         const void* S1, const void* S2)
+/* Compare function for CollSort. Hotter sections sort towards the start of
+** the segment. The original section order breaks ties, so the result is
+** deterministic.
+*/
+{
+    const Section* Sec1 = S1;
+    const Section* Sec2 = S2;
+
+    if (Sec1->Weight != Sec2->Weight) {
+        return (Sec1->Weight > Sec2->Weight)? -1 : 1;
+    }
+    if (Sec1->Offs != Sec2->Offs) {
+        return (Sec1->Offs < Sec2->Offs)? -1 : 1;
+    }
+    return 0;
+}
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+void ApplyProfile (void)
+/* If an execution profile was given on the command line, weight all sections
+** by the cycles their symbols collected, sort the sections within each
+** affected segment hottest first and move sections that were never executed
+** into the cold spill segments given in the config file. Must be called
+** after all link time optimizations, but before segment placement.
+*/
+{
+    unsigned I, J;
+    unsigned Reordered = 0;
+    unsigned Moved     = 0;
+
+    /* Nothing to do if no profile was given */
+    if (ProfileName == 0) {
+        return;
+    }
+
+    /* Read the profile and bail out if it is empty */
+    ReadProfile ();
+    if (ProfSymCount == 0) {
+        return;
+    }
+
+    /* Attribute the weights to the sections via the exports defined in
+    ** them. Static symbols aren't visible to the linker, so their cycles
+    ** are billed to the enclosing exported symbol by the sim65 rollup.
+    */
+    VisitExports (WeightExport, 0);
+
+    /* Walk over all segments and reorder the affected ones */
+    for (I = 0; I < SegmentCount (); ++I) {
+
+        Segment* Seg = SegByIndex (I);
+        SegDesc* D   = CfgFindSegDesc (Seg->Name);
+        int      Cold = (D != 0 && (D->Flags & SF_COLD) != 0);
+        int      Hot  = 0;
+
+        /* Untouched segments keep their original section order, so a
+        ** profile that doesn't cover a segment cannot disturb it.
+        */
+        for (J = 0; J < CollCount (&Seg->Sections); ++J) {
+            Section* Sec = CollAtUnchecked (&Seg->Sections, J);
+            if (Sec->Weight != 0) {
+                Hot = 1;
+                break;
+            }
+        }
+        if (!Hot && !Cold) {
+            continue;
+        }
+
+        /* Sort the sections, hottest first */
+        CollSort (&Seg->Sections, CmpSecWeight, 0);
+
+        /* If the segment has a cold spill segment, move the sections that
+        ** were never executed over there. Sections generated by the linker
+        ** itself - jump tables and the like - stay where the config placed
+        ** them.
+        */
+        if (Cold) {
+            Segment* ColdSeg = 0;
+            J = 0;
+            while (J < CollCount (&Seg->Sections)) {
+                Section* Sec = CollAtUnchecked (&Seg->Sections, J);
+                if (Sec->Weight != 0 || Sec->Obj == 0) {
+                    ++J;
+                    continue;
+                }
+                if (ColdSeg == 0) {
+                    ColdSeg = GetSegment (D->ColdName, Seg->AddrSize, 0);
+                }
+                CollDelete (&Seg->Sections, J);
+                CollAppend (&ColdSeg->Sections, Sec);
+                Sec->Seg = ColdSeg;
+                ++Moved;
+            }
+            if (ColdSeg) {
+                SegRecalcOffsets (ColdSeg);
+            }
+        }
+
+        /* Reassign the section offsets */
+        SegRecalcOffsets (Seg);
+        ++Reordered;
+    }
+
+    /* Print a summary if verbose */
+    Print (stdout, 1,
+           "Applied profile '%s': %u segment%s reordered, %u section%s moved\n",
+           ProfileName, Reordered, (Reordered == 1)? "" : "s",
+           Moved, (Moved == 1)? "" : "s");
+}
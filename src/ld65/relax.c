@@ -0,0 +1,145 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                  relax.c                                  */
+/*                                                                           */
+/*               Link time code relaxation for the ld65 linker               */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+/* common */
+#include "coll.h"
+#include "fragdefs.h"
+#include "print.h"
+
+/* ld65 */
+#include "fragment.h"
+#include "objdata.h"
+#include "relax.h"
+#include "segments.h"
+#include "spool.h"
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* 6502 opcodes handled here */
+#define OPC_JSR         0x20U
+#define OPC_JMP         0x4CU
+#define OPC_RTS         0x60U
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+static unsigned RelaxSection (Section* Sec)
+/* Rewrite tail calls in one section, return the number of rewrites */
+{
+    unsigned  Count = 0;
+    Fragment* F;
+
+    /* Walk over the fragment list. The operand of a jsr to a relocatable
+    ** target is a two byte expression fragment, the jsr opcode itself is
+    ** the last byte of the preceding literal fragment, and the rts is the
+    ** first byte of the following one.
+    */
+    for (F = Sec->FragRoot; F; F = F->Next) {
+
+        Fragment* Operand;
+        Fragment* Tail;
+
+        /* The fragment must be a literal ending with a jsr opcode */
+        if (F->Type != FRAG_LITERAL || F->Size < 1 ||
+            F->LitBuf[F->Size-1] != OPC_JSR) {
+            continue;
+        }
+
+        /* Followed by a two byte expression (the call target) */
+        Operand = F->Next;
+        if (Operand == 0 || Operand->Type != FRAG_EXPR || Operand->Size != 2) {
+            continue;
+        }
+
+        /* Followed by a literal starting with an rts opcode */
+        Tail = Operand->Next;
+        if (Tail == 0 || Tail->Type != FRAG_LITERAL || Tail->Size < 1 ||
+            Tail->LitBuf[0] != OPC_RTS) {
+            continue;
+        }
+
+        /* Replace the jsr by a jmp. The rts is kept, since it may be the
+        ** target of a branch; being directly behind a jmp, it is never
+        ** reached from the rewritten call.
+        */
+        F->LitBuf[F->Size-1] = OPC_JMP;
+        ++Count;
+    }
+
+    /* Return the number of rewrites in this section */
+    return Count;
+}
+
+
+
+void RelaxTailCalls (void)
+/* Rewrite "jsr sym" directly followed by "rts" into "jmp sym", leaving the
+** now unreachable rts in place so that section sizes and branch targets are
+** unchanged. Only used with --relax-jsr. Must be called after all input
+** files have been read.
+*/
+{
+    unsigned I, J;
+    unsigned Count = 0;
+
+    /* The rewrite is a byte pattern match on the fragment lists, since the
+    ** object format has no notion of instruction boundaries. To keep data
+    ** that happens to match the pattern safe, only the segment named CODE
+    ** is processed - data placed there by hand written assembler is the
+    ** documented limitation of --relax-jsr.
+    */
+    unsigned CodeName = GetStringId ("CODE");
+
+    /* Walk over the sections of all object files. Linker generated sections
+    ** contain tables, not code, and are left alone.
+    */
+    for (I = 0; I < CollCount (&ObjDataList); ++I) {
+        ObjData* O = CollAtUnchecked (&ObjDataList, I);
+        for (J = 0; J < CollCount (&O->Sections); ++J) {
+            Section* Sec = CollAtUnchecked (&O->Sections, J);
+            if (Sec->Seg->Name == CodeName) {
+                Count += RelaxSection (Sec);
+            }
+        }
+    }
+
+    /* Print a summary if verbose */
+    Print (stdout, 1, "Relaxed %u tail call%s\n", Count, (Count == 1)? "" : "s");
+}
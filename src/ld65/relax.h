@@ -0,0 +1,52 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                  relax.h                                  */
+/*                                                                           */
+/*               Link time code relaxation for the ld65 linker               */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#ifndef RELAX_H
+#define RELAX_H
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+void RelaxTailCalls (void);
+/* Rewrite "jsr sym" directly followed by "rts" into "jmp sym", leaving the
+** now unreachable rts in place so that section sizes and branch targets are
+** unchanged. Only used with --relax-jsr. Must be called after all input
+** files have been read.
+*/
+
+
+
+/* End of relax.h */
+
+#endif
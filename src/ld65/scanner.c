@@ -42,6 +42,7 @@
 /* common */
 #include "chartype.h"
 #include "strbuf.h"
+#include "xmalloc.h"
 #include "xsprintf.h"
 
 /* ld65 */
@@ -72,7 +73,13 @@ static const char*      CfgName         = 0;
 /* Other input stuff */
 static int              C               = ' ';
 static FilePos          InputPos;
-static FILE*            InputFile       = 0;
+
+/* The config is read into memory as a whole, so the scanner can fetch
+** characters without going through stdio for each of them.
+*/
+static char*            InputBuf        = 0;
+static const char*      InputNext       = 0;
+static const char*      InputEnd        = 0;
 
 
 
@@ -123,10 +130,14 @@ void CfgError (const FilePos* Pos, const char* Format, ...)
 
 
 static void NextChar (void)
-/* Read the next character from the input file */
+/* Read the next character from the input buffer */
 {
-    /* Read from the file */
-    C = getc (InputFile);
+    /* Read from the buffer */
+    if (InputNext < InputEnd) {
+        C = (unsigned char) *InputNext++;
+    } else {
+        C = EOF;
+    }
 
     /* Count columns */
     if (C != EOF) {
@@ -555,12 +566,33 @@ int CfgAvail (void)
 void CfgOpenInput (void)
 /* Open the input file if we have one */
 {
+    long Size;
+    size_t Len;
+
     /* Open the file */
-    InputFile = fopen (CfgName, "r");
-    if (InputFile == 0) {
+    FILE* F = fopen (CfgName, "r");
+    if (F == 0) {
         Error ("Cannot open '%s': %s", CfgName, strerror (errno));
     }
 
+    /* Determine the file size and read the complete config into memory. In
+    ** text mode the amount actually read may be smaller than the file size,
+    ** so the fread result is what counts.
+    */
+    fseek (F, 0, SEEK_END);
+    Size = ftell (F);
+    rewind (F);
+    InputBuf = xmalloc (Size + 1);
+    Len = fread (InputBuf, 1, (size_t) Size, F);
+    if (ferror (F)) {
+        Error ("Cannot read '%s': %s", CfgName, strerror (errno));
+    }
+    (void) fclose (F);
+
+    /* Setup the scan pointers */
+    InputNext = InputBuf;
+    InputEnd  = InputBuf + Len;
+
     /* Initialize variables */
     C         = ' ';
     InputPos.Line = 1;
@@ -576,9 +608,11 @@ void CfgOpenInput (void)
 void CfgCloseInput (void)
 /* Close the input file if we have one */
 {
-    /* Close the input file if we had one */
-    if (InputFile) {
-        (void) fclose (InputFile);
-        InputFile = 0;
+    /* Release the buffer if we had one */
+    if (InputBuf) {
+        xfree (InputBuf);
+        InputBuf  = 0;
+        InputNext = 0;
+        InputEnd  = 0;
     }
 }
@@ -87,6 +87,7 @@ typedef enum {
     CFGTOK_BANK,
     CFGTOK_FILL,
     CFGTOK_FILLVAL,
+    CFGTOK_PACK,
     CFGTOK_EXPORT,
     CFGTOK_IMPORT,
     CFGTOK_OS,
@@ -102,6 +103,9 @@ typedef enum {
     CFGTOK_ALIGN_LOAD,
     CFGTOK_OFFSET,
     CFGTOK_OPTIONAL,
+    CFGTOK_MAXSIZE,
+    CFGTOK_COMPRESSED,
+    CFGTOK_COLD,
 
     CFGTOK_RO,
     CFGTOK_RW,
@@ -126,6 +130,8 @@ typedef enum {
 
     CFGTOK_CONDES,
     CFGTOK_STARTADDRESS,
+    CFGTOK_FARCALL,
+    CFGTOK_DISPATCH,
 
     CFGTOK_ADDRSIZE,
     CFGTOK_VALUE,
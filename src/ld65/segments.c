@@ -169,7 +169,9 @@ Section* NewSection (Segment* Seg, unsigned long Alignment, unsigned char AddrSi
     S->FragLast = 0;
     S->Size     = 0;
     S->Alignment= Alignment;
+    S->Weight   = 0;
     S->AddrSize = AddrSize;
+    S->Live     = 0;
 
     /* Calculate the alignment bytes needed for the section */
     S->Fill = AlignCount (Seg->Size, S->Alignment);
@@ -342,6 +344,99 @@ int IsBSSType (Segment* S)
 
 
 
+void SegRecalcOffsets (Segment* Seg)
+/* Recalculate the section offsets and the total size of the given segment.
+** Used after section contents have been dropped by one of the link time
+** optimizations.
+*/
+{
+    unsigned J;
+
+    Seg->Size = 0;
+    for (J = 0; J < CollCount (&Seg->Sections); ++J) {
+
+        Section* Sec = CollAtUnchecked (&Seg->Sections, J);
+
+        /* Calculate the alignment bytes needed for the section */
+        Sec->Fill = AlignCount (Seg->Size, Sec->Alignment);
+
+        /* Adjust the segment size and set the section offset */
+        Seg->Size += Sec->Fill;
+        Sec->Offs  = Seg->Size;
+        Seg->Size += Sec->Size;
+    }
+}
+
+
+
+void SweepDeadSections (void)
+/* Remove the contents of all object file sections that have not been marked
+** live and recalculate the section offsets and segment sizes. Sections
+** generated by the linker itself are never removed. Must be called before
+** the segments are placed in memory areas.
+*/
+{
+    unsigned      I, J;
+    unsigned      Removed = 0;
+    unsigned long Bytes   = 0;
+
+    /* Walk over all segments */
+    for (I = 0; I < CollCount (&SegmentList); ++I) {
+
+        /* Get the next segment */
+        Segment* Seg = CollAtUnchecked (&SegmentList, I);
+
+        /* Check if the segment contains dead sections. If not, the offsets
+        ** don't need to be recalculated.
+        */
+        int Dead = 0;
+        for (J = 0; J < CollCount (&Seg->Sections); ++J) {
+            Section* Sec = CollAtUnchecked (&Seg->Sections, J);
+            if (!Sec->Live && Sec->Obj != 0) {
+                Dead = 1;
+                break;
+            }
+        }
+        if (!Dead) {
+            continue;
+        }
+
+        /* Empty the dead sections. They are kept in the lists with a size
+        ** of zero, so all references to them (exports, debug symbols,
+        ** spans) stay valid.
+        */
+        for (J = 0; J < CollCount (&Seg->Sections); ++J) {
+
+            Section* Sec = CollAtUnchecked (&Seg->Sections, J);
+
+            if (!Sec->Live && Sec->Obj != 0) {
+                /* Print the name of the section if verbose */
+                Print (stdout, 2, "Removing section '%s' from module '%s'\n",
+                       GetString (Seg->Name), GetObjFileName (Sec->Obj));
+
+                /* Drop the fragment list. The expressions in the fragments
+                ** may be shared with exports, so the fragments aren't freed.
+                */
+                Sec->FragRoot  = 0;
+                Sec->FragLast  = 0;
+                Bytes         += Sec->Size;
+                Sec->Size      = 0;
+                Sec->Alignment = 1;
+                ++Removed;
+            }
+        }
+
+        /* Reassign the offsets of the remaining sections */
+        SegRecalcOffsets (Seg);
+    }
+
+    /* Print a summary if verbose */
+    Print (stdout, 1, "Removed %u unreferenced section%s (%lu bytes)\n",
+           Removed, (Removed == 1)? "" : "s", Bytes);
+}
+
+
+
 void SegDump (void)
 /* Dump the segments and it's contents */
 {
@@ -545,6 +640,22 @@ void SegWrite (const char* TgtName, FILE* Tgt, Segment* S, SegWriteFunc F, void*
 
 
 
+unsigned long SegPadding (const Segment* S)
+/* Return the number of alignment fill bytes between the sections of the
+** given segment.
+*/
+{
+    unsigned I;
+    unsigned long Padding = 0;
+    for (I = 0; I < CollCount (&S->Sections); ++I) {
+        const Section* Sec = CollConstAt (&S->Sections, I);
+        Padding += Sec->Fill;
+    }
+    return Padding;
+}
+
+
+
 unsigned SegmentCount (void)
 /* Return the total number of segments */
 {
@@ -553,6 +664,14 @@ unsigned SegmentCount (void)
 
 
 
+Segment* SegByIndex (unsigned Index)
+/* Return the segment with the given index. The index must be valid. */
+{
+    return CollAt (&SegmentList, Index);
+}
+
+
+
 static int CmpSegStart (const void* K1, const void* K2)
 /* Compare function for qsort */
 {
@@ -590,8 +709,8 @@ void PrintSegmentMap (FILE* F)
     qsort (SegPool, CollCount (&SegmentList), sizeof (Segment*), CmpSegStart);
 
     /* Print a header */
-    fprintf (F, "Name                   Start     End    Size  Align\n"
-                "----------------------------------------------------\n");
+    fprintf (F, "Name                   Start     End    Size  Align    Pad\n"
+                "-----------------------------------------------------------\n");
 
     /* Print the segments */
     for (I = 0; I < CollCount (&SegmentList); ++I) {
@@ -607,8 +726,9 @@ void PrintSegmentMap (FILE* F)
                 /* Point to last element addressed */
                 --End;
             }
-            fprintf (F, "%-20s  %06lX  %06lX  %06lX  %05lX\n",
-                     GetString (S->Name), S->PC, End, S->Size, S->Alignment);
+            fprintf (F, "%-20s  %06lX  %06lX  %06lX  %05lX  %05lX\n",
+                     GetString (S->Name), S->PC, End, S->Size, S->Alignment,
+                     SegPadding (S));
         }
     }
 
@@ -618,6 +738,41 @@ void PrintSegmentMap (FILE* F)
 
 
 
+void WriteBinSegments (FILE* F)
+/* Write the segment list in binary map file format to the given file */
+{
+    unsigned I;
+    unsigned Count = CollCount (&SegmentList);
+
+    /* Allocate memory for the segment pool and sort it by start address,
+    ** so the binary map lists the segments in the same order as the text
+    ** one.
+    */
+    Segment** SegPool = xmalloc (Count * sizeof (Segment*));
+    for (I = 0; I < Count; ++I) {
+        SegPool[I] = CollAtUnchecked (&SegmentList, I);
+    }
+    qsort (SegPool, Count, sizeof (Segment*), CmpSegStart);
+
+    /* Write the segment records. Unlike the text map, empty segments are
+    ** always included, so the consumer sees the complete list.
+    */
+    WriteVar (F, Count);
+    for (I = 0; I < Count; ++I) {
+        const Segment* S = SegPool[I];
+        WriteStr (F, GetString (S->Name));
+        Write32 (F, S->PC);
+        Write32 (F, S->Size);
+        Write32 (F, S->Alignment);
+        Write8 (F, S->AddrSize);
+    }
+
+    /* Free the segment pool */
+    xfree (SegPool);
+}
+
+
+
 void PrintDbgSegments (FILE* F)
 /* Output the segments to the debug file */
 {
@@ -89,7 +89,9 @@ struct Section {
     unsigned long       Size;           /* Size of the section */
     unsigned long       Fill;           /* Fill bytes for alignment */
     unsigned long       Alignment;      /* Alignment */
+    unsigned long       Weight;         /* Profiled cycles (only used by --profile) */
     unsigned char       AddrSize;       /* Address size of segment */
+    unsigned char       Live;           /* Referenced (only used by --gc-sections) */
 };
 
 
@@ -136,6 +138,19 @@ int IsBSSType (Segment* S);
 ** contain non-zero data.
 */
 
+void SegRecalcOffsets (Segment* Seg);
+/* Recalculate the section offsets and the total size of the given segment.
+** Used after section contents have been dropped by one of the link time
+** optimizations.
+*/
+
+void SweepDeadSections (void);
+/* Remove the contents of all object file sections that have not been marked
+** live and recalculate the section offsets and segment sizes. Sections
+** generated by the linker itself are never removed. Must be called before
+** the segments are placed in memory areas.
+*/
+
 void SegDump (void);
 /* Dump the segments and it's contents */
 
@@ -149,12 +164,23 @@ void SegWrite (const char* TgtName, FILE* Tgt, Segment* S, SegWriteFunc F, void*
 ** called (see description of SegWriteFunc above).
 */
 
+unsigned long SegPadding (const Segment* S);
+/* Return the number of alignment fill bytes between the sections of the
+** given segment.
+*/
+
 unsigned SegmentCount (void);
 /* Return the total number of segments */
 
+Segment* SegByIndex (unsigned Index);
+/* Return the segment with the given index. The index must be valid. */
+
 void PrintSegmentMap (FILE* F);
 /* Print a segment map to the given file */
 
+void WriteBinSegments (FILE* F);
+/* Write the segment list in binary map file format to the given file */
+
 void PrintDbgSegments (FILE* F);
 /* Output the segments to the debug file */
 
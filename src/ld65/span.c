@@ -35,6 +35,7 @@
 
 /* common */
 #include "gentype.h"
+#include "strbuf.h"
 #include "xmalloc.h"
 
 /* ld65 */
@@ -203,11 +204,32 @@ void PrintDbgSpanList (FILE* F, const ObjData* O, const unsigned* List)
 
 
 
+void AppendDbgSpanList (StrBuf* B, const ObjData* O, const unsigned* List)
+/* Append a string ",span=x[+y...]" for the given list to the string buffer.
+** If the list is empty or NULL, append nothing. This is the string buffer
+** variant of PrintDbgSpanList, used by modules that format whole records in
+** memory before writing them out.
+*/
+{
+    if (List && *List) {
+        unsigned I;
+        SB_AppendStr (B, ",span=");
+        SB_AppendUnsigned (B, O->SpanBaseId + List[1]);
+        for (I = 1; I < *List; ++I) {
+            SB_AppendChar (B, '+');
+            SB_AppendUnsigned (B, O->SpanBaseId + List[I+1]);
+        }
+    }
+}
+
+
+
 void PrintDbgSpans (FILE* F)
 /* Output the spans to a debug info file */
 {
     unsigned I, J;
-    StrBuf SpanType = STATIC_STRBUF_INITIALIZER;
+    const Span* S;
+    StrBuf Line = STATIC_STRBUF_INITIALIZER;
 
 
     /* Walk over all object files */
@@ -217,31 +239,37 @@ void PrintDbgSpans (FILE* F)
         ObjData* O = CollAtUnchecked (&ObjDataList, I);
 
         /* Walk over all spans in this object file */
-        for (J = 0; J < CollCount (&O->Spans); ++J) {
-
-            /* Get this span */
-            const Span* S = CollAtUnchecked (&O->Spans, J);
+        CollForEach (&O->Spans, J, S, const Span*) {
 
             /* Get the section for this span */
             const Section* Sec = GetObjSection (O, S->Sec);
 
-            /* Output the data */
-            fprintf (F, "span\tid=%u,seg=%u,start=%lu,size=%lu",
-                     O->SpanBaseId + S->Id,
-                     Sec->Seg->Id,
-                     Sec->Offs + S->Offs,
-                     S->Size);
+            /* Format the record in memory, then write it with one call.
+            ** This is cheaper than using fprintf for each field, since the
+            ** format string doesn't need to be parsed over and over again.
+            */
+            SB_Clear (&Line);
+            SB_AppendStr (&Line, "span\tid=");
+            SB_AppendUnsigned (&Line, O->SpanBaseId + S->Id);
+            SB_AppendStr (&Line, ",seg=");
+            SB_AppendUnsigned (&Line, Sec->Seg->Id);
+            SB_AppendStr (&Line, ",start=");
+            SB_AppendUnsigned (&Line, Sec->Offs + S->Offs);
+            SB_AppendStr (&Line, ",size=");
+            SB_AppendUnsigned (&Line, S->Size);
 
             /* If we have a type, add it */
             if (S->Type != INVALID_TYPE_ID) {
-                fprintf (F, ",type=%u", S->Type);
+                SB_AppendStr (&Line, ",type=");
+                SB_AppendUnsigned (&Line, S->Type);
             }
 
-            /* Terminate the output line */
-            fputc ('\n', F);
+            /* Terminate and output the line */
+            SB_AppendChar (&Line, '\n');
+            fwrite (SB_GetConstBuf (&Line), 1, SB_GetLen (&Line), F);
         }
     }
 
     /* Free the string buffer */
-    SB_Done (&SpanType);
+    SB_Done (&Line);
 }
@@ -42,6 +42,7 @@
 
 /* common */
 #include "coll.h"
+#include "strbuf.h"
 
 
 
@@ -97,6 +98,13 @@ void PrintDbgSpanList (FILE* F, const struct ObjData* O, const unsigned* List);
 ** print a list of spans read by ReadSpanList to the debug info file.
 */
 
+void AppendDbgSpanList (StrBuf* B, const struct ObjData* O, const unsigned* List);
+/* Append a string ",span=x[+y...]" for the given list to the string buffer.
+** If the list is empty or NULL, append nothing. This is the string buffer
+** variant of PrintDbgSpanList, used by modules that format whole records in
+** memory before writing them out.
+*/
+
 void PrintDbgSpans (FILE* F);
 /* Output the spans to a debug info file */
 
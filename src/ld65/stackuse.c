@@ -0,0 +1,287 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                stackuse.c                                 */
+/*                                                                           */
+/*                Stack depth analysis for the ld65 linker                   */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* common */
+#include "coll.h"
+#include "print.h"
+#include "strbuf.h"
+#include "xmalloc.h"
+
+/* ld65 */
+#include "error.h"
+#include "global.h"
+#include "objdata.h"
+#include "stackuse.h"
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* Traversal states for the depth computation */
+#define FI_UNVISITED    0U
+#define FI_ACTIVE       1U
+#define FI_DONE         2U
+
+/* A function with a stack usage annotation */
+typedef struct FuncInfo FuncInfo;
+struct FuncInfo {
+    const char*         Name;           /* Name of the function */
+    unsigned            Own;            /* Own worst case stack usage */
+    unsigned            Depth;          /* Computed worst case total depth */
+    unsigned char       State;          /* Traversal state */
+    unsigned char       IsCallee;       /* Called from annotated code */
+    Collection          Calls;          /* List of call edges */
+};
+
+/* A call edge in the annotated call graph */
+typedef struct CallEdge CallEdge;
+struct CallEdge {
+    const char*         Name;           /* Name of the callee */
+    FuncInfo*           Callee;         /* Annotation of the callee if any */
+    unsigned            Depth;          /* Caller stack depth at the call */
+};
+
+/* List of all annotated functions */
+static Collection FuncInfos = STATIC_COLLECTION_INITIALIZER;
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+static FuncInfo* FindFuncInfo (const char* Name)
+/* Find the annotation for the function with the given name. The list is
+** small enough to make a linear search acceptable.
+*/
+{
+    unsigned I;
+    for (I = 0; I < CollCount (&FuncInfos); ++I) {
+        FuncInfo* F = CollAtUnchecked (&FuncInfos, I);
+        if (strcmp (Name, F->Name) == 0) {
+            return F;
+        }
+    }
+    return 0;
+}
+
+
+
+static void ParseStackUse (const StrBuf* B)
+/* Parse one stack usage annotation. The format written by the compiler is
+** "name own [callee depth ...]" with decimal numbers. Malformed records
+** are flagged but don't abort the link.
+*/
+{
+    FuncInfo* F;
+    char* Name;
+    char* Num;
+
+    /* Work on a writable copy. The copy is not freed, since the parsed
+    ** records reference the names within it.
+    */
+    char* S = xstrdup (SB_GetConstBuf (B));
+
+    /* Function name and own usage */
+    Name = strtok (S, " ");
+    Num  = (Name != 0)? strtok (0, " ") : 0;
+    if (Num == 0) {
+        Warning ("Invalid stack usage record '%s'", SB_GetConstBuf (B));
+        xfree (S);
+        return;
+    }
+
+    /* Create the function annotation */
+    F = xmalloc (sizeof (FuncInfo));
+    F->Name     = Name;
+    F->Own      = (unsigned) atol (Num);
+    F->Depth    = 0;
+    F->State    = FI_UNVISITED;
+    F->IsCallee = 0;
+    F->Calls    = EmptyCollection;
+    CollAppend (&FuncInfos, F);
+
+    /* Parse the call edges */
+    while ((Name = strtok (0, " ")) != 0) {
+        CallEdge* E;
+        Num = strtok (0, " ");
+        if (Num == 0) {
+            Warning ("Invalid stack usage record for '%s'", F->Name);
+            return;
+        }
+        E = xmalloc (sizeof (CallEdge));
+        E->Name   = Name;
+        E->Callee = 0;
+        E->Depth  = (unsigned) atol (Num);
+        CollAppend (&F->Calls, E);
+    }
+}
+
+
+
+static unsigned GetDepth (FuncInfo* F)
+/* Recursively compute the worst case stack depth of the given function */
+{
+    unsigned D;
+    unsigned I;
+
+    /* Was the depth computed before, or are we in a cycle? */
+    if (F->State == FI_DONE) {
+        return F->Depth;
+    }
+    if (F->State == FI_ACTIVE) {
+        Warning ("Recursion involving '%s'; stack depth estimate may be low",
+                 F->Name);
+        return 0;
+    }
+    F->State = FI_ACTIVE;
+
+    /* The depth is the own usage or the depth through one of the calls,
+    ** whichever is larger. The depth recorded for an edge is the stack use
+    ** of the caller at the call site, so the callee depth simply adds up.
+    */
+    D = F->Own;
+    for (I = 0; I < CollCount (&F->Calls); ++I) {
+        CallEdge* E = CollAtUnchecked (&F->Calls, I);
+        unsigned ED = E->Depth;
+        if (E->Name[0] == '*') {
+            Warning ("'%s' performs indirect calls; stack depth estimate "
+                     "may be low", F->Name);
+        } else if (E->Callee != 0) {
+            ED += GetDepth (E->Callee);
+        }
+        if (ED > D) {
+            D = ED;
+        }
+    }
+
+    /* Remember and return the result */
+    F->Depth = D;
+    F->State = FI_DONE;
+    return D;
+}
+
+
+
+void CheckStackUse (void)
+/* Compute the worst case parameter stack depth from the stack usage
+** annotations in the object files and compare it against the configured
+** budget. Does nothing if no budget was given on the command line.
+*/
+{
+    unsigned I;
+    unsigned J;
+    unsigned Max = 0;
+    const char* MaxName = 0;
+    int HaveRoot = 0;
+
+    /* Bail out if no stack check was requested */
+    if (StackBudget < 0) {
+        return;
+    }
+
+    /* Collect the annotations from all object files */
+    for (I = 0; I < CollCount (&ObjDataList); ++I) {
+        const ObjData* O = CollConstAt (&ObjDataList, I);
+        for (J = 0; J < CollCount (&O->StackUses); ++J) {
+            ParseStackUse (CollConstAt (&O->StackUses, J));
+        }
+    }
+
+    /* Complain if there is nothing to check */
+    if (CollCount (&FuncInfos) == 0) {
+        Warning ("Stack budget given, but no stack usage annotations found "
+                 "(compile with --stack-usage)");
+        return;
+    }
+
+    /* Resolve the call edges. Functions without annotations (assembler
+    ** code, runtime library) are assumed to use no parameter stack.
+    */
+    for (I = 0; I < CollCount (&FuncInfos); ++I) {
+        FuncInfo* F = CollAtUnchecked (&FuncInfos, I);
+        for (J = 0; J < CollCount (&F->Calls); ++J) {
+            CallEdge* E = CollAtUnchecked (&F->Calls, J);
+            if (E->Name[0] != '*') {
+                E->Callee = FindFuncInfo (E->Name);
+                if (E->Callee != 0) {
+                    E->Callee->IsCallee = 1;
+                }
+            }
+        }
+    }
+
+    /* Compute the depth for all functions */
+    for (I = 0; I < CollCount (&FuncInfos); ++I) {
+        GetDepth (CollAtUnchecked (&FuncInfos, I));
+    }
+
+    /* The worst case is the maximum over all entry points, that is,
+    ** functions not called from annotated code. If everything takes part
+    ** in a cycle, fall back to the maximum over all functions.
+    */
+    for (I = 0; I < CollCount (&FuncInfos); ++I) {
+        const FuncInfo* F = CollConstAt (&FuncInfos, I);
+        if (!F->IsCallee) {
+            HaveRoot = 1;
+            if (F->Depth > Max) {
+                Max     = F->Depth;
+                MaxName = F->Name;
+            }
+        }
+    }
+    if (!HaveRoot) {
+        for (I = 0; I < CollCount (&FuncInfos); ++I) {
+            const FuncInfo* F = CollConstAt (&FuncInfos, I);
+            if (F->Depth > Max) {
+                Max     = F->Depth;
+                MaxName = F->Name;
+            }
+        }
+    }
+
+    Print (stdout, 1, "Worst case stack depth: %u bytes ('%s')\n",
+           Max, MaxName);
+
+    /* Fail the link if the budget is exceeded */
+    if ((long) Max > StackBudget) {
+        Error ("Worst case stack depth of %u bytes ('%s') exceeds the "
+               "budget of %ld bytes", Max, MaxName, StackBudget);
+    }
+}
@@ -0,0 +1,51 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                stackuse.h                                 */
+/*                                                                           */
+/*                Stack depth analysis for the ld65 linker                   */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#ifndef STACKUSE_H
+#define STACKUSE_H
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+void CheckStackUse (void);
+/* Compute the worst case parameter stack depth from the stack usage
+** annotations in the object files and compare it against the configured
+** budget. Does nothing if no budget was given on the command line.
+*/
+
+
+
+/* End of stackuse.h */
+
+#endif
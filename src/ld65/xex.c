@@ -75,6 +75,7 @@ struct XexDesc {
     unsigned long HeadPos;      /* Position in the file of current header */
     unsigned long HeadEnd;      /* End address of current header */
     unsigned long HeadSize;     /* Last header size, can be removed if zero */
+    unsigned char HeadDirty;    /* End address in the file is stale */
 };
 
 
@@ -99,6 +100,7 @@ XexDesc* NewXexDesc (void)
     D->HeadPos  = 0;
     D->HeadEnd  = 0;
     D->HeadSize = 0;
+    D->HeadDirty = 0;
 
     /* Return the created struct */
     return D;
@@ -170,6 +172,25 @@ static void PrintNumVal (const char* Name, unsigned long V)
 
 
 
+static void XexFlushHeader (XexDesc *D)
+/* If the end address of the current segment header is stale, patch it in
+** the file. The patch is deferred until the header is closed, since each
+** seek on the output file flushes the big output buffer; patching on every
+** segment that extends the header made XEX output visibly slower than the
+** raw binary format.
+*/
+{
+    if (D->HeadDirty) {
+        unsigned long Pos = ftell (D->F);
+        fseek (D->F, D->HeadPos + 2, SEEK_SET);
+        Write16 (D->F, D->HeadEnd);
+        fseek (D->F, Pos, SEEK_SET);
+        D->HeadDirty = 0;
+    }
+}
+
+
+
 static void XexStartSegment (XexDesc *D, unsigned long Addr, unsigned long Size)
 {
     /* Skip segment without size */
@@ -182,16 +203,18 @@ static void XexStartSegment (XexDesc *D, unsigned long Addr, unsigned long Size)
 
     /* See if last header can be expanded into this one */
     if (D->HeadPos && ((D->HeadEnd + 1) == Addr)) {
-        /* Expand current header */
+        /* Expand current header. The end address in the file is patched
+        ** when the header is closed.
+        */
         D->HeadEnd = End;
         D->HeadSize += Size;
-        fseek (D->F, D->HeadPos + 2, SEEK_SET);
-        Write16 (D->F, End);
-        /* Seek to old position */
-        fseek (D->F, Pos, SEEK_SET);
+        D->HeadDirty = 1;
     }
     else
     {
+        /* The current header is closed, patch its end address if needed */
+        XexFlushHeader (D);
+
         if (D->HeadSize == 0) {
             /* Last header had no data, replace */
             Pos = D->HeadPos;
@@ -219,6 +242,9 @@ static void XexFakeSegment (XexDesc *D, unsigned long Addr)
     if (D->HeadPos && ((D->HeadEnd + 1) == Addr))
         return;
 
+    /* The current header is closed, patch its end address if needed */
+    XexFlushHeader (D);
+
     /* If we are at start of file, write XEX heder */
     if (ftell (D->F) == 0)
         Write16 (D->F, 0xFFFF);
@@ -260,6 +286,12 @@ static unsigned long XexWriteMem (XexDesc* D, MemoryArea* M)
                    S->Load == M                 &&      /* LOAD segment */
                    S->Seg->Dumped == 0;                 /* Not already written */
 
+        /* Compressed segments are only supported in the binary format */
+        if (DoWrite && (S->Flags & SF_COMPRESSED) != 0) {
+            Error ("ATARI file format does not support compression for segment '%s'.",
+                   GetString (S->Name));
+        }
+
         /* If this is the run memory area, we must apply run alignment. If
         ** this is not the run memory area but the load memory area (which
         ** means that both are different), we must apply load alignment.
@@ -351,6 +383,9 @@ static unsigned long XexWriteMem (XexDesc* D, MemoryArea* M)
         M->FillLevel = M->Size;
     }
 
+    /* The memory area is done, patch the current header if needed */
+    XexFlushHeader (D);
+
     /* If the last segment is empty, remove */
     if (D->HeadSize == 0 && D->HeadPos) {
         fseek (D->F, D->HeadPos, SEEK_SET);
@@ -397,6 +432,7 @@ void XexWriteTarget (XexDesc* D, struct File* F)
     if (D->F == 0) {
         Error ("Cannot open `%s': %s", D->Filename, strerror (errno));
     }
+    FileSetBigBuf (D->F);
     D->HeadPos = 0;
 
     /* Keep the user happy */
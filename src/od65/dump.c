@@ -42,6 +42,7 @@
 #include "coll.h"
 #include "exprdefs.h"
 #include "filepos.h"
+#include "hashfunc.h"
 #include "lidefs.h"
 #include "objdefs.h"
 #include "optdefs.h"
@@ -121,11 +122,21 @@ static char* TimeToStr (unsigned long Time)
 
 
 
-static void SkipLineInfoList (FILE* F)
+static void SkipLineInfoList (FILE* F, const ObjHeader* H)
 /* Skip a line info list from the given file */
 {
+    unsigned long Count;
+
+    /* If the file has interned line info lists, only an index into the list
+    ** table is stored.
+    */
+    if (OBJ_HAS_LILISTS (H->Flags)) {
+        (void) ReadVar (F);
+        return;
+    }
+
     /* Count preceeds the list */
-    unsigned long Count = ReadVar (F);
+    Count = ReadVar (F);
 
     /* Skip indices */
     while (Count--) {
@@ -373,6 +384,7 @@ void DumpObjOptions (FILE* F, unsigned long Offset)
             case OPT_TRANSLATOR:TypeDesc = "OPT_TRANSLATOR";    break;
             case OPT_COMPILER:  TypeDesc = "OPT_COMPILER";      break;
             case OPT_OS:        TypeDesc = "OPT_OS";            break;
+            case OPT_STACKUSE:  TypeDesc = "OPT_STACKUSE";      break;
             case OPT_DATETIME:  TypeDesc = "OPT_DATETIME";      break;
             default:            TypeDesc = "OPT_UNKNOWN";       break;
         }
@@ -561,8 +573,8 @@ void DumpObjImports (FILE* F, unsigned long Offset)
         unsigned      Len      = strlen (Name);
 
         /* Skip both line info lists */
-        SkipLineInfoList (F);
-        SkipLineInfoList (F);
+        SkipLineInfoList (F, &H);
+        SkipLineInfoList (F, &H);
 
         /* Print the header */
         printf ("    Index:%27u\n", I);
@@ -631,8 +643,8 @@ void DumpObjExports (FILE* F, unsigned long Offset)
         }
 
         /* Skip both line infos lists */
-        SkipLineInfoList (F);
-        SkipLineInfoList (F);
+        SkipLineInfoList (F, &H);
+        SkipLineInfoList (F, &H);
 
         /* Print the header */
         printf ("    Index:%27u\n", I);
@@ -719,8 +731,8 @@ void DumpObjDbgSyms (FILE* F, unsigned long Offset)
         }
 
         /* Skip both line info lists */
-        SkipLineInfoList (F);
-        SkipLineInfoList (F);
+        SkipLineInfoList (F, &H);
+        SkipLineInfoList (F, &H);
 
         /* Print the header */
         printf ("    Index:%27u\n", I);
@@ -810,6 +822,33 @@ void DumpObjLineInfo (FILE* F, unsigned long Offset)
         printf ("      Name:%26u\n", Pos.Name);
     }
 
+    /* Dump the interned line info lists if the file has them */
+    if (OBJ_HAS_LILISTS (H.Flags)) {
+
+        /* Read the number of lists and print it */
+        Count = ReadVar (F);
+        printf ("  Line info lists:\n");
+        printf ("    Count:%27u\n", Count);
+
+        /* Read and print all lists */
+        for (I = 0; I < Count; ++I) {
+
+            /* Number of ids in this list */
+            unsigned IdCount = ReadVar (F);
+
+            /* Print the header */
+            printf ("    Index:%27u\n", I);
+            printf ("      Count:%25u\n", IdCount);
+
+            /* Print the ids */
+            printf ("      Ids:");
+            while (IdCount--) {
+                printf (" %lu", ReadVar (F));
+            }
+            printf ("\n");
+        }
+    }
+
     /* Destroy the string pool */
     DestroyStrPool (&StrPool);
 }
@@ -951,3 +990,236 @@ void DumpObjSegSize (FILE* F, unsigned long Offset)
     /* Destroy the string pool */
     DestroyStrPool (&StrPool);
 }
+
+
+
+void DumpObjSummary (FILE* F, unsigned long Offset)
+/* Dump a machine readable summary of the object file. Only the header, the
+** string pool and the table counts are read, everything else is skipped.
+*/
+{
+    ObjHeader   H;
+    Collection  StrPool = AUTO_COLLECTION_INITIALIZER;
+    unsigned    Count;
+
+    /* Seek to the header position and read the header */
+    FileSetPos (F, Offset);
+    ReadObjHeader (F, &H);
+
+    /* Seek to the start of the string pool and read it */
+    FileSetPos (F, Offset + H.StrPoolOffs);
+    ReadStrPool (F, &StrPool);
+
+    /* Seek to the start of the segments and read the segment count */
+    FileSetPos (F, Offset + H.SegOffs);
+    Count = ReadVar (F);
+
+    /* Print the name and size of all segments, skipping the fragment data */
+    while (Count--) {
+
+        /* Read the data for one segment */
+        unsigned long DataSize = Read32 (F);
+        unsigned long NextSeg  = ftell (F) + DataSize;
+        const char*   Name     = GetString (&StrPool, ReadVar (F));
+        unsigned long Size;
+
+        /* Skip segment flags, read size */
+        (void) ReadVar (F);
+        Size = ReadVar (F);
+
+        /* Print name and size for this segment */
+        printf ("segment %s %lu\n", Name, Size);
+
+        /* Seek to the end of the segment data (start of next) */
+        FileSetPos (F, NextSeg);
+    }
+
+    /* Print the import and export counts, which precede their tables */
+    FileSetPos (F, Offset + H.ImportOffs);
+    printf ("imports %lu\n", ReadVar (F));
+    FileSetPos (F, Offset + H.ExportOffs);
+    printf ("exports %lu\n", ReadVar (F));
+
+    /* Destroy the string pool */
+    DestroyStrPool (&StrPool);
+}
+
+
+
+/* One segment digest, see ReadSegDigests */
+typedef struct SegDigest SegDigest;
+struct SegDigest {
+    unsigned long Size;         /* Segment size */
+    unsigned      Hash;         /* Content hash over the fragment records */
+    char          Name[1];      /* Segment name, dynamically sized */
+};
+
+
+
+static unsigned HashRange (FILE* F, unsigned long End)
+/* Hash the file contents from the current position up to End */
+{
+    char Buf[4096];
+    unsigned H = HASHDATA_INITIAL;
+    unsigned long Pos = ftell (F);
+    while (Pos < End) {
+        unsigned Chunk = sizeof (Buf);
+        if (End - Pos < Chunk) {
+            Chunk = (unsigned) (End - Pos);
+        }
+        ReadData (F, Buf, Chunk);
+        H = HashData (Buf, Chunk, H);
+        Pos += Chunk;
+    }
+    return H;
+}
+
+
+
+static void ReadSegDigests (FILE* F, unsigned long Offset, Collection* Digests)
+/* Read the name, size and content hash of all segments in an object file.
+** The hash covers the stored fragment records, so it reacts to any change
+** in the segment data or its relocations.
+*/
+{
+    ObjHeader  H;
+    Collection StrPool = AUTO_COLLECTION_INITIALIZER;
+    unsigned   Count;
+
+    /* Seek to the header position and read the header */
+    FileSetPos (F, Offset);
+    ReadObjHeader (F, &H);
+
+    /* Seek to the start of the string pool and read it */
+    FileSetPos (F, Offset + H.StrPoolOffs);
+    ReadStrPool (F, &StrPool);
+
+    /* Seek to the start of the segments and read the segment count */
+    FileSetPos (F, Offset + H.SegOffs);
+    Count = ReadVar (F);
+
+    /* Digest all segments */
+    while (Count--) {
+
+        /* Read the data for one segment */
+        unsigned long DataSize = Read32 (F);
+        unsigned long NextSeg  = ftell (F) + DataSize;
+        const char*   Name     = GetString (&StrPool, ReadVar (F));
+        unsigned long Size;
+        SegDigest*    D;
+
+        /* Skip segment flags, read size */
+        (void) ReadVar (F);
+        Size = ReadVar (F);
+
+        /* Skip alignment, address size and fragment count */
+        (void) ReadVar (F);
+        (void) Read8 (F);
+        (void) ReadVar (F);
+
+        /* Create the digest entry. The fragment records follow up to the
+        ** start of the next segment.
+        */
+        D = xmalloc (sizeof (*D) + strlen (Name));
+        D->Size = Size;
+        D->Hash = HashRange (F, NextSeg);
+        strcpy (D->Name, Name);
+        CollAppend (Digests, D);
+    }
+
+    /* Destroy the string pool */
+    DestroyStrPool (&StrPool);
+}
+
+
+
+static void FreeSegDigests (Collection* Digests)
+/* Delete the entries of a segment digest collection */
+{
+    unsigned I;
+    for (I = 0; I < CollCount (Digests); ++I) {
+        xfree (CollAtUnchecked (Digests, I));
+    }
+    DoneCollection (Digests);
+}
+
+
+
+static const SegDigest* FindSegDigest (const Collection* Digests, const char* Name)
+/* Find a segment digest by name. Returns NULL if there is none. */
+{
+    unsigned I;
+    for (I = 0; I < CollCount (Digests); ++I) {
+        const SegDigest* D = CollConstAt (Digests, I);
+        if (strcmp (D->Name, Name) == 0) {
+            return D;
+        }
+    }
+    return 0;
+}
+
+
+
+void DumpObjDigest (FILE* F, unsigned long Offset)
+/* Dump per-segment content digests of the object file */
+{
+    Collection Digests = AUTO_COLLECTION_INITIALIZER;
+    unsigned   I;
+
+    /* Read the digests */
+    ReadSegDigests (F, Offset, &Digests);
+
+    /* Print name, size and hash for all segments */
+    for (I = 0; I < CollCount (&Digests); ++I) {
+        const SegDigest* D = CollConstAt (&Digests, I);
+        printf ("segment %s %lu %08X\n", D->Name, D->Size, D->Hash);
+    }
+
+    FreeSegDigests (&Digests);
+}
+
+
+
+unsigned CompareObjFiles (FILE* F1, const char* Name1, FILE* F2, const char* Name2)
+/* Compare two object files segment by segment using content digests. Any
+** difference is reported on stdout. Returns the number of differences.
+*/
+{
+    Collection D1 = AUTO_COLLECTION_INITIALIZER;
+    Collection D2 = AUTO_COLLECTION_INITIALIZER;
+    unsigned   I;
+    unsigned   Diffs = 0;
+
+    /* Read the digests of both files */
+    ReadSegDigests (F1, 0, &D1);
+    ReadSegDigests (F2, 0, &D2);
+
+    /* Compare the segments of the first file against the second */
+    for (I = 0; I < CollCount (&D1); ++I) {
+        const SegDigest* L = CollConstAt (&D1, I);
+        const SegDigest* R = FindSegDigest (&D2, L->Name);
+        if (R == 0) {
+            printf ("segment %s only in %s\n", L->Name, Name1);
+            ++Diffs;
+        } else if (L->Size != R->Size) {
+            printf ("segment %s size %lu != %lu\n", L->Name, L->Size, R->Size);
+            ++Diffs;
+        } else if (L->Hash != R->Hash) {
+            printf ("segment %s contents differ\n", L->Name);
+            ++Diffs;
+        }
+    }
+
+    /* Report segments that exist only in the second file */
+    for (I = 0; I < CollCount (&D2); ++I) {
+        const SegDigest* R = CollConstAt (&D2, I);
+        if (FindSegDigest (&D1, R->Name) == 0) {
+            printf ("segment %s only in %s\n", R->Name, Name2);
+            ++Diffs;
+        }
+    }
+
+    FreeSegDigests (&D1);
+    FreeSegDigests (&D2);
+    return Diffs;
+}
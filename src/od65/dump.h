@@ -78,6 +78,19 @@ void DumpObjScopes (FILE* F, unsigned long Offset);
 void DumpObjSegSize (FILE* F, unsigned long Offset);
 /* Dump the sizes of the segment in the object file */
 
+void DumpObjSummary (FILE* F, unsigned long Offset);
+/* Dump a machine readable summary of the object file. Only the header, the
+** string pool and the table counts are read, everything else is skipped.
+*/
+
+void DumpObjDigest (FILE* F, unsigned long Offset);
+/* Dump per-segment content digests of the object file */
+
+unsigned CompareObjFiles (FILE* F1, const char* Name1, FILE* F2, const char* Name2);
+/* Compare two object files segment by segment using content digests. Any
+** difference is reported on stdout. Returns the number of differences.
+*/
+
 
 
 /* End of dump.h */
@@ -56,6 +56,12 @@
 #define D_SEGSIZE       0x0200U         /* Dump segment sizes */
 #define D_ALL           0xFFFFU         /* Dump anything */
 
+/* The summary and the digest are query modes, not dumps, so they are not
+** part of D_ALL.
+*/
+#define D_SUMMARY       0x10000U        /* Dump machine readable summary */
+#define D_DIGEST        0x20000U        /* Dump per segment content digests */
+
 
 
 extern unsigned         What;           /* What should get dumped? */
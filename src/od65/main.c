@@ -59,6 +59,13 @@
 
 static unsigned FilesProcessed = 0;
 
+/* Compare mode: Instead of dumping, the two files given on the command
+** line are compared segment by segment.
+*/
+static int         Compare = 0;
+static const char* CompareName[2];
+static unsigned    CompareCount = 0;
+
 
 
 /*****************************************************************************/
@@ -78,6 +85,8 @@ static void Usage (void)
             "  -V\t\t\tPrint the version number and exit\n"
             "\n"
             "Long options:\n"
+            "  --compare\t\tCompare two object files segment by segment\n"
+            "  --digest\t\tDump per-segment content digests\n"
             "  --dump-all\t\tDump all object file information\n"
             "  --dump-dbgsyms\tDump debug symbols\n"
             "  --dump-exports\tDump exported symbols\n"
@@ -88,6 +97,7 @@ static void Usage (void)
             "  --dump-options\tDump object file options\n"
             "  --dump-segments\tDump the segments in the file\n"
             "  --dump-segsize\tDump segments sizes\n"
+            "  --dump-summary\tDump machine readable summary\n"
             "  --help\t\tHelp (this text)\n"
             "  --version\t\tPrint the version number and exit\n",
             ProgName);
@@ -194,6 +204,33 @@ static void OptDumpSegSize (const char* Opt attribute ((unused)),
 
 
 
+static void OptDumpSummary (const char* Opt attribute ((unused)),
+                            const char* Arg attribute ((unused)))
+/* Dump a machine readable summary of the object file */
+{
+    What |= D_SUMMARY;
+}
+
+
+
+static void OptDigest (const char* Opt attribute ((unused)),
+                       const char* Arg attribute ((unused)))
+/* Dump per-segment content digests of the object file */
+{
+    What |= D_DIGEST;
+}
+
+
+
+static void OptCompare (const char* Opt attribute ((unused)),
+                        const char* Arg attribute ((unused)))
+/* Compare the two object files given on the command line */
+{
+    Compare = 1;
+}
+
+
+
 static void OptHelp (const char* Opt attribute ((unused)),
                      const char* Arg attribute ((unused)))
 /* Print usage information and exit */
@@ -275,6 +312,12 @@ static void DumpFile (const char* Name)
         if (What & D_SEGSIZE) {
             DumpObjSegSize (F, 0);
         }
+        if (What & D_SUMMARY) {
+            DumpObjSummary (F, 0);
+        }
+        if (What & D_DIGEST) {
+            DumpObjDigest (F, 0);
+        }
     }
 
     /* Close the file */
@@ -283,11 +326,52 @@ static void DumpFile (const char* Name)
 
 
 
+static FILE* OpenObjFile (const char* Name)
+/* Open an object file for comparison and check the magic word. Errors are
+** fatal.
+*/
+{
+    FILE* F = fopen (Name, "rb");
+    if (F == 0) {
+        Error ("Cannot open '%s': %s", Name, strerror (errno));
+    }
+    if (Read32 (F) != OBJ_MAGIC) {
+        Error ("'%s' is not an xo65 object file", Name);
+    }
+    return F;
+}
+
+
+
+static int CompareFiles (const char* Name1, const char* Name2)
+/* Compare two object files. Returns the program exit code. */
+{
+    unsigned Diffs;
+
+    /* Open both files */
+    FILE* F1 = OpenObjFile (Name1);
+    FILE* F2 = OpenObjFile (Name2);
+
+    /* Compare them segment by segment */
+    Diffs = CompareObjFiles (F1, Name1, F2, Name2);
+
+    /* Close the files */
+    fclose (F1);
+    fclose (F2);
+
+    /* Signal differences in the exit code, like cmp and diff do */
+    return (Diffs == 0)? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+
 int main (int argc, char* argv [])
 /* Assembler main program */
 {
     /* Program long options */
     static const LongOpt OptTab[] = {
+        { "--compare",          0,      OptCompare              },
+        { "--digest",           0,      OptDigest               },
         { "--dump-all",         0,      OptDumpAll              },
         { "--dump-dbgsyms",     0,      OptDumpDbgSyms          },
         { "--dump-exports",     0,      OptDumpExports          },
@@ -299,6 +383,7 @@ int main (int argc, char* argv [])
         { "--dump-scopes",      0,      OptDumpScopes           },
         { "--dump-segments",    0,      OptDumpSegments         },
         { "--dump-segsize",     0,      OptDumpSegSize          },
+        { "--dump-summary",     0,      OptDumpSummary          },
         { "--help",             0,      OptHelp                 },
         { "--version",          0,      OptVersion              },
     };
@@ -344,6 +429,12 @@ int main (int argc, char* argv [])
                     break;
 
             }
+        } else if (Compare) {
+            /* Filename. Remember it for the comparison. */
+            if (CompareCount < 2) {
+                CompareName[CompareCount] = Arg;
+            }
+            ++CompareCount;
         } else {
             /* Filename. Dump it. */
             DumpFile (Arg);
@@ -354,6 +445,14 @@ int main (int argc, char* argv [])
         ++I;
     }
 
+    /* In compare mode, exactly two files are needed */
+    if (Compare) {
+        if (CompareCount != 2) {
+            Error ("Option --compare needs exactly two files");
+        }
+        return CompareFiles (CompareName[0], CompareName[1]);
+    }
+
     /* Print a message if we did not process any files */
     if (FilesProcessed == 0) {
         fprintf (stderr, "%s: No input files\n", ProgName);
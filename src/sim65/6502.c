@@ -39,6 +39,15 @@
    6502)
 */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+/* common */
+#include "xmalloc.h"
+
+/* sim65 */
 #include "memory.h"
 #include "error.h"
 #include "6502.h"
@@ -73,9 +82,37 @@ static unsigned HaveNMIRequest;
 /* IRQ request active */
 static unsigned HaveIRQRequest;
 
+/* CPU state snapshot for batch mode */
+static CPURegs SavedRegs;
+static unsigned long SavedCycles;
+static unsigned SavedNMIRequest;
+static unsigned SavedIRQRequest;
+
 /* flag to print cycles at program termination */
 int PrintCycles;
 
+/* name of file to write the execution profile to */
+const char* ProfileName;
+
+/* name of a VICE label file used for the per symbol profile rollup */
+const char* ProfileLabelsName;
+
+/* per address cycle counters, allocated when profiling is enabled */
+static unsigned long* ProfileBuf;
+
+/* per address execution counters, allocated when profiling is enabled */
+static unsigned long* ProfileCount;
+
+/* per address branch taken/not taken counters */
+static unsigned long* ProfileTaken;
+static unsigned long* ProfileNotTaken;
+
+/* name of file to write the coverage bitmap to */
+const char* CoverageName;
+
+/* coverage bitmap, one bit per address, allocated when coverage is enabled */
+static unsigned char* CoverageBuf;
+
 
 /*****************************************************************************/
 /*                        Helper functions and macros                        */
@@ -274,6 +311,9 @@ int PrintCycles;
     if (cond) {                                                 \
         signed char Offs;                                       \
         unsigned char OldPCH;                                   \
+        if (ProfileTaken) {                                     \
+            ++ProfileTaken[Regs.PC & 0xFFFF];                   \
+        }                                                       \
         ++Cycles;                                               \
         Offs = (signed char) MemReadByte (Regs.PC+1);           \
         OldPCH = PCH;                                           \
@@ -282,6 +322,9 @@ int PrintCycles;
             ++Cycles;                                           \
         }                                                       \
     } else {                                                    \
+        if (ProfileNotTaken) {                                  \
+            ++ProfileNotTaken[Regs.PC & 0xFFFF];                \
+        }                                                       \
         Regs.PC += 2;                                           \
     }
 
@@ -2664,537 +2707,1790 @@ static void OPC_6502_FE (void)
 
 
 /*****************************************************************************/
-/*                           Opcode handler tables                           */
+/*                      65816 opcode handling functions                      */
 /*****************************************************************************/
 
 
 
-/* Opcode handler table for the 6502 */
-static const OPFunc OP6502Table[256] = {
-    OPC_6502_00,
-    OPC_6502_01,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_6502_05,
-    OPC_6502_06,
-    OPC_Illegal,
-    OPC_6502_08,
-    OPC_6502_09,
-    OPC_6502_0A,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_6502_0D,
-    OPC_6502_0E,
-    OPC_Illegal,
-    OPC_6502_10,
-    OPC_6502_11,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_6502_15,
-    OPC_6502_16,
-    OPC_Illegal,
-    OPC_6502_18,
-    OPC_6502_19,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_6502_1D,
-    OPC_6502_1E,
-    OPC_Illegal,
-    OPC_6502_20,
-    OPC_6502_21,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_6502_24,
-    OPC_6502_25,
-    OPC_6502_26,
-    OPC_Illegal,
-    OPC_6502_28,
-    OPC_6502_29,
-    OPC_6502_2A,
-    OPC_Illegal,
-    OPC_6502_2C,
-    OPC_6502_2D,
-    OPC_6502_2E,
-    OPC_Illegal,
-    OPC_6502_30,
-    OPC_6502_31,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_6502_35,
-    OPC_6502_36,
-    OPC_Illegal,
-    OPC_6502_38,
-    OPC_6502_39,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_6502_3D,
-    OPC_6502_3E,
-    OPC_Illegal,
-    OPC_6502_40,
-    OPC_6502_41,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_6502_45,
-    OPC_6502_46,
-    OPC_Illegal,
-    OPC_6502_48,
-    OPC_6502_49,
-    OPC_6502_4A,
-    OPC_Illegal,
-    OPC_6502_4C,
-    OPC_6502_4D,
-    OPC_6502_4E,
-    OPC_Illegal,
-    OPC_6502_50,
-    OPC_6502_51,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_6502_55,
-    OPC_6502_56,
-    OPC_Illegal,
-    OPC_6502_58,
-    OPC_6502_59,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_6502_5D,
-    OPC_6502_5E,
-    OPC_Illegal,
-    OPC_6502_60,
-    OPC_6502_61,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_6502_65,
-    OPC_6502_66,
-    OPC_Illegal,
-    OPC_6502_68,
-    OPC_6502_69,
-    OPC_6502_6A,
-    OPC_Illegal,
-    OPC_6502_6C,
-    OPC_6502_6D,
-    OPC_6502_6E,
-    OPC_Illegal,
-    OPC_6502_70,
-    OPC_6502_71,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_6502_75,
-    OPC_6502_76,
-    OPC_Illegal,
-    OPC_6502_78,
-    OPC_6502_79,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_6502_7D,
-    OPC_6502_7E,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_6502_81,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_6502_84,
-    OPC_6502_85,
-    OPC_6502_86,
-    OPC_Illegal,
-    OPC_6502_88,
-    OPC_Illegal,
-    OPC_6502_8A,
-    OPC_Illegal,
-    OPC_6502_8C,
-    OPC_6502_8D,
-    OPC_6502_8E,
-    OPC_Illegal,
-    OPC_6502_90,
-    OPC_6502_91,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_6502_94,
-    OPC_6502_95,
-    OPC_6502_96,
-    OPC_Illegal,
-    OPC_6502_98,
-    OPC_6502_99,
-    OPC_6502_9A,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_6502_9D,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_6502_A0,
-    OPC_6502_A1,
-    OPC_6502_A2,
-    OPC_Illegal,
-    OPC_6502_A4,
-    OPC_6502_A5,
-    OPC_6502_A6,
-    OPC_Illegal,
-    OPC_6502_A8,
-    OPC_6502_A9,
-    OPC_6502_AA,
-    OPC_Illegal,
-    OPC_6502_AC,
-    OPC_6502_AD,
-    OPC_6502_AE,
-    OPC_Illegal,
-    OPC_6502_B0,
-    OPC_6502_B1,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_6502_B4,
-    OPC_6502_B5,
-    OPC_6502_B6,
-    OPC_Illegal,
-    OPC_6502_B8,
-    OPC_6502_B9,
-    OPC_6502_BA,
-    OPC_Illegal,
-    OPC_6502_BC,
-    OPC_6502_BD,
-    OPC_6502_BE,
-    OPC_Illegal,
-    OPC_6502_C0,
-    OPC_6502_C1,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_6502_C4,
-    OPC_6502_C5,
-    OPC_6502_C6,
-    OPC_Illegal,
-    OPC_6502_C8,
-    OPC_6502_C9,
-    OPC_6502_CA,
-    OPC_Illegal,
-    OPC_6502_CC,
-    OPC_6502_CD,
-    OPC_6502_CE,
-    OPC_Illegal,
-    OPC_6502_D0,
-    OPC_6502_D1,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_6502_D5,
-    OPC_6502_D6,
-    OPC_Illegal,
-    OPC_6502_D8,
-    OPC_6502_D9,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_6502_DD,
-    OPC_6502_DE,
-    OPC_Illegal,
-    OPC_6502_E0,
-    OPC_6502_E1,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_6502_E4,
-    OPC_6502_E5,
-    OPC_6502_E6,
-    OPC_Illegal,
-    OPC_6502_E8,
-    OPC_6502_E9,
-    OPC_6502_EA,
-    OPC_Illegal,
-    OPC_6502_EC,
-    OPC_6502_ED,
-    OPC_6502_EE,
-    OPC_Illegal,
-    OPC_6502_F0,
+/* The 65816 core emulates the CPU in emulation mode: The M and X bits are
+** forced to one, so the registers have a width of 8 bits, and the stack
+** stays in page one. The hidden B accumulator, the direct page and the data
+** bank register are maintained so code may save, restore and swap them, but
+** since the simulator provides a single 64KB bank, any attempt to relocate
+** the direct page, to switch to another bank or to enter native mode aborts
+** with an error.
+*/
+
+
+
+static void CheckBank (unsigned char Bank)
+/* Check the bank byte of a long address or a bank register. The simulator
+** has just 64KB of memory, so only bank zero is valid.
+*/
+{
+    if (Bank != 0) {
+        Error ("Memory bank $%02X out of range at $%04X", Bank, Regs.PC);
+    }
+}
+
+
+
+static unsigned EA_AbsLong (void)
+/* Return the effective address for the absolute long addressing mode */
+{
+    unsigned Addr = MemReadWord (Regs.PC+1);
+    CheckBank (MemReadByte (Regs.PC+3));
+    return Addr;
+}
+
+
+
+static unsigned EA_AbsLongX (void)
+/* Return the effective address for the absolute long,x addressing mode */
+{
+    return (EA_AbsLong () + Regs.XR) & 0xFFFF;
+}
+
+
+
+static unsigned EA_StackRel (void)
+/* Return the effective address for the stack relative addressing mode */
+{
+    return (0x0100 + (Regs.SP & 0xFF) + MemReadByte (Regs.PC+1)) & 0xFFFF;
+}
+
+
+
+static unsigned EA_StackRelY (void)
+/* Return the effective address for the stack relative indirect indexed
+** addressing mode
+*/
+{
+    return (MemReadWord (EA_StackRel ()) + Regs.YR) & 0xFFFF;
+}
+
+
+
+static unsigned EA_DirectIndLong (void)
+/* Return the effective address for the direct page indirect long
+** addressing mode
+*/
+{
+    unsigned char ZPAddr = MemReadByte (Regs.PC+1);
+    unsigned Addr = MemReadZPWord (ZPAddr);
+    CheckBank (MemReadByte ((unsigned char) (ZPAddr + 2)));
+    return Addr;
+}
+
+
+
+static unsigned EA_DirectIndLongY (void)
+/* Return the effective address for the direct page indirect long indexed
+** addressing mode
+*/
+{
+    return (EA_DirectIndLong () + Regs.YR) & 0xFFFF;
+}
+
+
+
+static void OPC_65816_02 (void)
+/* Opcode $02: COP sig */
+{
+    Cycles = 7;
+    Regs.PC += 2;
+    PUSH (PCH);
+    PUSH (PCL);
+    PUSH (Regs.SR);
+    SET_IF (1);
+    SET_DF (0);
+    Regs.PC = MemReadWord (0xFFF4);
+}
+
+
+
+static void OPC_65816_03 (void)
+/* Opcode $03: ORA sr,S */
+{
+    Cycles = 4;
+    Regs.AC |= MemReadByte (EA_StackRel ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_07 (void)
+/* Opcode $07: ORA [zp] */
+{
+    Cycles = 6;
+    Regs.AC |= MemReadByte (EA_DirectIndLong ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_0B (void)
+/* Opcode $0B: PHD */
+{
+    Cycles = 4;
+    PUSH ((Regs.DR >> 8) & 0xFF);
+    PUSH (Regs.DR & 0xFF);
+    Regs.PC += 1;
+}
+
+
+
+static void OPC_65816_0F (void)
+/* Opcode $0F: ORA long */
+{
+    Cycles = 5;
+    Regs.AC |= MemReadByte (EA_AbsLong ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 4;
+}
+
+
+
+static void OPC_65816_13 (void)
+/* Opcode $13: ORA (sr,S),y */
+{
+    Cycles = 7;
+    Regs.AC |= MemReadByte (EA_StackRelY ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_17 (void)
+/* Opcode $17: ORA [zp],y */
+{
+    Cycles = 6;
+    Regs.AC |= MemReadByte (EA_DirectIndLongY ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_1B (void)
+/* Opcode $1B: TCS */
+{
+    Cycles = 2;
+    /* In emulation mode the stack stays in page one */
+    Regs.SP = Regs.AC & 0xFF;
+    Regs.PC += 1;
+}
+
+
+
+static void OPC_65816_1F (void)
+/* Opcode $1F: ORA long,x */
+{
+    Cycles = 5;
+    Regs.AC |= MemReadByte (EA_AbsLongX ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 4;
+}
+
+
+
+static void OPC_65816_22 (void)
+/* Opcode $22: JSL long */
+{
+    unsigned Addr;
+    Cycles = 8;
+    Addr = EA_AbsLong ();
+    /* The return address pushed is that of the last insn byte */
+    Regs.PC += 3;
+    PUSH (0);                   /* Program bank is always zero */
+    PUSH (PCH);
+    PUSH (PCL);
+    Regs.PC = Addr;
+}
+
+
+
+static void OPC_65816_23 (void)
+/* Opcode $23: AND sr,S */
+{
+    Cycles = 4;
+    Regs.AC &= MemReadByte (EA_StackRel ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_27 (void)
+/* Opcode $27: AND [zp] */
+{
+    Cycles = 6;
+    Regs.AC &= MemReadByte (EA_DirectIndLong ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_2B (void)
+/* Opcode $2B: PLD */
+{
+    Cycles = 5;
+    Regs.DR = POP ();
+    Regs.DR |= (POP () << 8);
+    SET_ZF (Regs.DR == 0);
+    SET_SF ((Regs.DR & 0x8000) != 0);
+    if (Regs.DR != 0) {
+        Error ("Cannot relocate the direct page at $%04X", Regs.PC);
+    }
+    Regs.PC += 1;
+}
+
+
+
+static void OPC_65816_2F (void)
+/* Opcode $2F: AND long */
+{
+    Cycles = 5;
+    Regs.AC &= MemReadByte (EA_AbsLong ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 4;
+}
+
+
+
+static void OPC_65816_33 (void)
+/* Opcode $33: AND (sr,S),y */
+{
+    Cycles = 7;
+    Regs.AC &= MemReadByte (EA_StackRelY ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_37 (void)
+/* Opcode $37: AND [zp],y */
+{
+    Cycles = 6;
+    Regs.AC &= MemReadByte (EA_DirectIndLongY ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_3B (void)
+/* Opcode $3B: TSC */
+{
+    Cycles = 2;
+    /* The stack pointer high byte is always $01, so the result is
+    ** neither zero nor negative.
+    */
+    Regs.AH = 0x01;
+    Regs.AC = Regs.SP & 0xFF;
+    SET_ZF (0);
+    SET_SF (0);
+    Regs.PC += 1;
+}
+
+
+
+static void OPC_65816_3F (void)
+/* Opcode $3F: AND long,x */
+{
+    Cycles = 5;
+    Regs.AC &= MemReadByte (EA_AbsLongX ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 4;
+}
+
+
+
+static void OPC_65816_42 (void)
+/* Opcode $42: WDM sig */
+{
+    Cycles = 2;
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_43 (void)
+/* Opcode $43: EOR sr,S */
+{
+    Cycles = 4;
+    Regs.AC ^= MemReadByte (EA_StackRel ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_44 (void)
+/* Opcode $44: MVP src,dst */
+{
+    unsigned Count = (((Regs.AH << 8) | Regs.AC) + 1) & 0xFFFF;
+    CheckBank (MemReadByte (Regs.PC+1));        /* Destination bank */
+    CheckBank (MemReadByte (Regs.PC+2));        /* Source bank */
+    Cycles = 7 * Count;
+    while (Count--) {
+        MemWriteByte (Regs.YR, MemReadByte (Regs.XR));
+        Regs.XR = (Regs.XR - 1) & 0xFF;
+        Regs.YR = (Regs.YR - 1) & 0xFF;
+    }
+    Regs.AC = 0xFF;
+    Regs.AH = 0xFF;
+    Regs.PC += 3;
+}
+
+
+
+static void OPC_65816_47 (void)
+/* Opcode $47: EOR [zp] */
+{
+    Cycles = 6;
+    Regs.AC ^= MemReadByte (EA_DirectIndLong ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_4B (void)
+/* Opcode $4B: PHK */
+{
+    Cycles = 3;
+    PUSH (0);                   /* Program bank is always zero */
+    Regs.PC += 1;
+}
+
+
+
+static void OPC_65816_4F (void)
+/* Opcode $4F: EOR long */
+{
+    Cycles = 5;
+    Regs.AC ^= MemReadByte (EA_AbsLong ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 4;
+}
+
+
+
+static void OPC_65816_53 (void)
+/* Opcode $53: EOR (sr,S),y */
+{
+    Cycles = 7;
+    Regs.AC ^= MemReadByte (EA_StackRelY ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_54 (void)
+/* Opcode $54: MVN src,dst */
+{
+    unsigned Count = (((Regs.AH << 8) | Regs.AC) + 1) & 0xFFFF;
+    CheckBank (MemReadByte (Regs.PC+1));        /* Destination bank */
+    CheckBank (MemReadByte (Regs.PC+2));        /* Source bank */
+    Cycles = 7 * Count;
+    while (Count--) {
+        MemWriteByte (Regs.YR, MemReadByte (Regs.XR));
+        Regs.XR = (Regs.XR + 1) & 0xFF;
+        Regs.YR = (Regs.YR + 1) & 0xFF;
+    }
+    Regs.AC = 0xFF;
+    Regs.AH = 0xFF;
+    Regs.PC += 3;
+}
+
+
+
+static void OPC_65816_57 (void)
+/* Opcode $57: EOR [zp],y */
+{
+    Cycles = 6;
+    Regs.AC ^= MemReadByte (EA_DirectIndLongY ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_5B (void)
+/* Opcode $5B: TCD */
+{
+    Cycles = 2;
+    Regs.DR = ((Regs.AH << 8) | Regs.AC) & 0xFFFF;
+    SET_ZF (Regs.DR == 0);
+    SET_SF ((Regs.DR & 0x8000) != 0);
+    if (Regs.DR != 0) {
+        Error ("Cannot relocate the direct page at $%04X", Regs.PC);
+    }
+    Regs.PC += 1;
+}
+
+
+
+static void OPC_65816_5C (void)
+/* Opcode $5C: JML long */
+{
+    Cycles = 4;
+    Regs.PC = EA_AbsLong ();
+}
+
+
+
+static void OPC_65816_5F (void)
+/* Opcode $5F: EOR long,x */
+{
+    Cycles = 5;
+    Regs.AC ^= MemReadByte (EA_AbsLongX ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 4;
+}
+
+
+
+static void OPC_65816_62 (void)
+/* Opcode $62: PER rel16 */
+{
+    unsigned Addr;
+    Cycles = 6;
+    Addr = (Regs.PC + 3 + (signed short) MemReadWord (Regs.PC+1)) & 0xFFFF;
+    PUSH ((Addr >> 8) & 0xFF);
+    PUSH (Addr & 0xFF);
+    Regs.PC += 3;
+}
+
+
+
+static void OPC_65816_63 (void)
+/* Opcode $63: ADC sr,S */
+{
+    Cycles = 4;
+    ADC (MemReadByte (EA_StackRel ()));
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_67 (void)
+/* Opcode $67: ADC [zp] */
+{
+    Cycles = 6;
+    ADC (MemReadByte (EA_DirectIndLong ()));
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_6B (void)
+/* Opcode $6B: RTL */
+{
+    Cycles = 6;
+    Regs.PC = POP ();
+    Regs.PC |= (POP () << 8);
+    Regs.PC = (Regs.PC + 1) & 0xFFFF;
+    CheckBank (POP ());
+}
+
+
+
+static void OPC_65816_6F (void)
+/* Opcode $6F: ADC long */
+{
+    Cycles = 5;
+    ADC (MemReadByte (EA_AbsLong ()));
+    Regs.PC += 4;
+}
+
+
+
+static void OPC_65816_73 (void)
+/* Opcode $73: ADC (sr,S),y */
+{
+    Cycles = 7;
+    ADC (MemReadByte (EA_StackRelY ()));
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_77 (void)
+/* Opcode $77: ADC [zp],y */
+{
+    Cycles = 6;
+    ADC (MemReadByte (EA_DirectIndLongY ()));
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_7B (void)
+/* Opcode $7B: TDC */
+{
+    Cycles = 2;
+    Regs.AC = Regs.DR & 0xFF;
+    Regs.AH = (Regs.DR >> 8) & 0xFF;
+    SET_ZF (Regs.DR == 0);
+    SET_SF ((Regs.DR & 0x8000) != 0);
+    Regs.PC += 1;
+}
+
+
+
+static void OPC_65816_7F (void)
+/* Opcode $7F: ADC long,x */
+{
+    Cycles = 5;
+    ADC (MemReadByte (EA_AbsLongX ()));
+    Regs.PC += 4;
+}
+
+
+
+static void OPC_65816_82 (void)
+/* Opcode $82: BRL rel16 */
+{
+    Cycles = 4;
+    Regs.PC = (Regs.PC + 3 + (signed short) MemReadWord (Regs.PC+1)) & 0xFFFF;
+}
+
+
+
+static void OPC_65816_83 (void)
+/* Opcode $83: STA sr,S */
+{
+    Cycles = 4;
+    MemWriteByte (EA_StackRel (), Regs.AC);
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_87 (void)
+/* Opcode $87: STA [zp] */
+{
+    Cycles = 6;
+    MemWriteByte (EA_DirectIndLong (), Regs.AC);
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_8B (void)
+/* Opcode $8B: PHB */
+{
+    Cycles = 3;
+    PUSH (Regs.BR);
+    Regs.PC += 1;
+}
+
+
+
+static void OPC_65816_8F (void)
+/* Opcode $8F: STA long */
+{
+    Cycles = 5;
+    MemWriteByte (EA_AbsLong (), Regs.AC);
+    Regs.PC += 4;
+}
+
+
+
+static void OPC_65816_93 (void)
+/* Opcode $93: STA (sr,S),y */
+{
+    Cycles = 7;
+    MemWriteByte (EA_StackRelY (), Regs.AC);
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_97 (void)
+/* Opcode $97: STA [zp],y */
+{
+    Cycles = 6;
+    MemWriteByte (EA_DirectIndLongY (), Regs.AC);
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_9B (void)
+/* Opcode $9B: TXY */
+{
+    Cycles = 2;
+    Regs.YR = Regs.XR & 0xFF;
+    TEST_ZF (Regs.YR);
+    TEST_SF (Regs.YR);
+    Regs.PC += 1;
+}
+
+
+
+static void OPC_65816_9F (void)
+/* Opcode $9F: STA long,x */
+{
+    Cycles = 5;
+    MemWriteByte (EA_AbsLongX (), Regs.AC);
+    Regs.PC += 4;
+}
+
+
+
+static void OPC_65816_A3 (void)
+/* Opcode $A3: LDA sr,S */
+{
+    Cycles = 4;
+    Regs.AC = MemReadByte (EA_StackRel ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_A7 (void)
+/* Opcode $A7: LDA [zp] */
+{
+    Cycles = 6;
+    Regs.AC = MemReadByte (EA_DirectIndLong ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_AB (void)
+/* Opcode $AB: PLB */
+{
+    Cycles = 4;
+    Regs.BR = POP ();
+    TEST_ZF (Regs.BR);
+    TEST_SF (Regs.BR);
+    CheckBank ((unsigned char) Regs.BR);
+    Regs.PC += 1;
+}
+
+
+
+static void OPC_65816_AF (void)
+/* Opcode $AF: LDA long */
+{
+    Cycles = 5;
+    Regs.AC = MemReadByte (EA_AbsLong ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 4;
+}
+
+
+
+static void OPC_65816_B3 (void)
+/* Opcode $B3: LDA (sr,S),y */
+{
+    Cycles = 7;
+    Regs.AC = MemReadByte (EA_StackRelY ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_B7 (void)
+/* Opcode $B7: LDA [zp],y */
+{
+    Cycles = 6;
+    Regs.AC = MemReadByte (EA_DirectIndLongY ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_BB (void)
+/* Opcode $BB: TYX */
+{
+    Cycles = 2;
+    Regs.XR = Regs.YR & 0xFF;
+    TEST_ZF (Regs.XR);
+    TEST_SF (Regs.XR);
+    Regs.PC += 1;
+}
+
+
+
+static void OPC_65816_BF (void)
+/* Opcode $BF: LDA long,x */
+{
+    Cycles = 5;
+    Regs.AC = MemReadByte (EA_AbsLongX ());
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 4;
+}
+
+
+
+static void OPC_65816_C2 (void)
+/* Opcode $C2: REP #imm */
+{
+    Cycles = 3;
+    /* In emulation mode the M and X bits are forced to one */
+    Regs.SR &= ~(MemReadByte (Regs.PC+1) & 0xCF);
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_C3 (void)
+/* Opcode $C3: CMP sr,S */
+{
+    Cycles = 4;
+    CMP (Regs.AC, MemReadByte (EA_StackRel ()));
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_C7 (void)
+/* Opcode $C7: CMP [zp] */
+{
+    Cycles = 6;
+    CMP (Regs.AC, MemReadByte (EA_DirectIndLong ()));
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_CB (void)
+/* Opcode $CB: WAI */
+{
+    Cycles = 3;
+    if (!HaveIRQRequest && !HaveNMIRequest) {
+        Error ("WAI with no pending interrupt at $%04X", Regs.PC);
+    }
+    Regs.PC += 1;
+}
+
+
+
+static void OPC_65816_CF (void)
+/* Opcode $CF: CMP long */
+{
+    Cycles = 5;
+    CMP (Regs.AC, MemReadByte (EA_AbsLong ()));
+    Regs.PC += 4;
+}
+
+
+
+static void OPC_65816_D3 (void)
+/* Opcode $D3: CMP (sr,S),y */
+{
+    Cycles = 7;
+    CMP (Regs.AC, MemReadByte (EA_StackRelY ()));
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_D4 (void)
+/* Opcode $D4: PEI (zp) */
+{
+    unsigned Val;
+    Cycles = 6;
+    Val = MemReadZPWord (MemReadByte (Regs.PC+1));
+    PUSH ((Val >> 8) & 0xFF);
+    PUSH (Val & 0xFF);
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_D7 (void)
+/* Opcode $D7: CMP [zp],y */
+{
+    Cycles = 6;
+    CMP (Regs.AC, MemReadByte (EA_DirectIndLongY ()));
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_DB (void)
+/* Opcode $DB: STP */
+{
+    Error ("STP at $%04X stopped the CPU", Regs.PC);
+}
+
+
+
+static void OPC_65816_DC (void)
+/* Opcode $DC: JML (ind) */
+{
+    unsigned Ptr;
+    Cycles = 6;
+    Ptr = MemReadWord (Regs.PC+1);
+    CheckBank (MemReadByte ((Ptr + 2) & 0xFFFF));
+    Regs.PC = MemReadWord (Ptr);
+}
+
+
+
+static void OPC_65816_DF (void)
+/* Opcode $DF: CMP long,x */
+{
+    Cycles = 5;
+    CMP (Regs.AC, MemReadByte (EA_AbsLongX ()));
+    Regs.PC += 4;
+}
+
+
+
+static void OPC_65816_E2 (void)
+/* Opcode $E2: SEP #imm */
+{
+    Cycles = 3;
+    Regs.SR |= MemReadByte (Regs.PC+1);
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_E3 (void)
+/* Opcode $E3: SBC sr,S */
+{
+    Cycles = 4;
+    SBC (MemReadByte (EA_StackRel ()));
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_E7 (void)
+/* Opcode $E7: SBC [zp] */
+{
+    Cycles = 6;
+    SBC (MemReadByte (EA_DirectIndLong ()));
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_EB (void)
+/* Opcode $EB: XBA */
+{
+    unsigned char Tmp;
+    Cycles = 3;
+    Tmp = (unsigned char) Regs.AC;
+    Regs.AC = Regs.AH;
+    Regs.AH = Tmp;
+    TEST_ZF (Regs.AC);
+    TEST_SF (Regs.AC);
+    Regs.PC += 1;
+}
+
+
+
+static void OPC_65816_EF (void)
+/* Opcode $EF: SBC long */
+{
+    Cycles = 5;
+    SBC (MemReadByte (EA_AbsLong ()));
+    Regs.PC += 4;
+}
+
+
+
+static void OPC_65816_F3 (void)
+/* Opcode $F3: SBC (sr,S),y */
+{
+    Cycles = 7;
+    SBC (MemReadByte (EA_StackRelY ()));
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_F4 (void)
+/* Opcode $F4: PEA #imm16 */
+{
+    Cycles = 5;
+    PUSH (MemReadByte (Regs.PC+2));
+    PUSH (MemReadByte (Regs.PC+1));
+    Regs.PC += 3;
+}
+
+
+
+static void OPC_65816_F7 (void)
+/* Opcode $F7: SBC [zp],y */
+{
+    Cycles = 6;
+    SBC (MemReadByte (EA_DirectIndLongY ()));
+    Regs.PC += 2;
+}
+
+
+
+static void OPC_65816_FB (void)
+/* Opcode $FB: XCE */
+{
+    Cycles = 2;
+    if (!GET_CF ()) {
+        Error ("XCE into native mode at $%04X: 16 bit mode is not supported",
+               Regs.PC);
+    }
+    /* With the carry set the CPU stays in emulation mode, and the carry
+    ** keeps its value since the emulation bit was already set.
+    */
+    Regs.PC += 1;
+}
+
+
+
+static void OPC_65816_FF (void)
+/* Opcode $FF: SBC long,x */
+{
+    Cycles = 5;
+    SBC (MemReadByte (EA_AbsLongX ()));
+    Regs.PC += 4;
+}
+
+
+
+/*****************************************************************************/
+/*                           Opcode handler tables                           */
+/*****************************************************************************/
+
+
+
+/* Opcode handler table for the 6502 */
+static const OPFunc OP6502Table[256] = {
+    OPC_6502_00,
+    OPC_6502_01,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_05,
+    OPC_6502_06,
+    OPC_Illegal,
+    OPC_6502_08,
+    OPC_6502_09,
+    OPC_6502_0A,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_0D,
+    OPC_6502_0E,
+    OPC_Illegal,
+    OPC_6502_10,
+    OPC_6502_11,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_15,
+    OPC_6502_16,
+    OPC_Illegal,
+    OPC_6502_18,
+    OPC_6502_19,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_1D,
+    OPC_6502_1E,
+    OPC_Illegal,
+    OPC_6502_20,
+    OPC_6502_21,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_24,
+    OPC_6502_25,
+    OPC_6502_26,
+    OPC_Illegal,
+    OPC_6502_28,
+    OPC_6502_29,
+    OPC_6502_2A,
+    OPC_Illegal,
+    OPC_6502_2C,
+    OPC_6502_2D,
+    OPC_6502_2E,
+    OPC_Illegal,
+    OPC_6502_30,
+    OPC_6502_31,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_35,
+    OPC_6502_36,
+    OPC_Illegal,
+    OPC_6502_38,
+    OPC_6502_39,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_3D,
+    OPC_6502_3E,
+    OPC_Illegal,
+    OPC_6502_40,
+    OPC_6502_41,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_45,
+    OPC_6502_46,
+    OPC_Illegal,
+    OPC_6502_48,
+    OPC_6502_49,
+    OPC_6502_4A,
+    OPC_Illegal,
+    OPC_6502_4C,
+    OPC_6502_4D,
+    OPC_6502_4E,
+    OPC_Illegal,
+    OPC_6502_50,
+    OPC_6502_51,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_55,
+    OPC_6502_56,
+    OPC_Illegal,
+    OPC_6502_58,
+    OPC_6502_59,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_5D,
+    OPC_6502_5E,
+    OPC_Illegal,
+    OPC_6502_60,
+    OPC_6502_61,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_65,
+    OPC_6502_66,
+    OPC_Illegal,
+    OPC_6502_68,
+    OPC_6502_69,
+    OPC_6502_6A,
+    OPC_Illegal,
+    OPC_6502_6C,
+    OPC_6502_6D,
+    OPC_6502_6E,
+    OPC_Illegal,
+    OPC_6502_70,
+    OPC_6502_71,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_75,
+    OPC_6502_76,
+    OPC_Illegal,
+    OPC_6502_78,
+    OPC_6502_79,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_7D,
+    OPC_6502_7E,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_81,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_84,
+    OPC_6502_85,
+    OPC_6502_86,
+    OPC_Illegal,
+    OPC_6502_88,
+    OPC_Illegal,
+    OPC_6502_8A,
+    OPC_Illegal,
+    OPC_6502_8C,
+    OPC_6502_8D,
+    OPC_6502_8E,
+    OPC_Illegal,
+    OPC_6502_90,
+    OPC_6502_91,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_94,
+    OPC_6502_95,
+    OPC_6502_96,
+    OPC_Illegal,
+    OPC_6502_98,
+    OPC_6502_99,
+    OPC_6502_9A,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_9D,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_A0,
+    OPC_6502_A1,
+    OPC_6502_A2,
+    OPC_Illegal,
+    OPC_6502_A4,
+    OPC_6502_A5,
+    OPC_6502_A6,
+    OPC_Illegal,
+    OPC_6502_A8,
+    OPC_6502_A9,
+    OPC_6502_AA,
+    OPC_Illegal,
+    OPC_6502_AC,
+    OPC_6502_AD,
+    OPC_6502_AE,
+    OPC_Illegal,
+    OPC_6502_B0,
+    OPC_6502_B1,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_B4,
+    OPC_6502_B5,
+    OPC_6502_B6,
+    OPC_Illegal,
+    OPC_6502_B8,
+    OPC_6502_B9,
+    OPC_6502_BA,
+    OPC_Illegal,
+    OPC_6502_BC,
+    OPC_6502_BD,
+    OPC_6502_BE,
+    OPC_Illegal,
+    OPC_6502_C0,
+    OPC_6502_C1,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_C4,
+    OPC_6502_C5,
+    OPC_6502_C6,
+    OPC_Illegal,
+    OPC_6502_C8,
+    OPC_6502_C9,
+    OPC_6502_CA,
+    OPC_Illegal,
+    OPC_6502_CC,
+    OPC_6502_CD,
+    OPC_6502_CE,
+    OPC_Illegal,
+    OPC_6502_D0,
+    OPC_6502_D1,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_D5,
+    OPC_6502_D6,
+    OPC_Illegal,
+    OPC_6502_D8,
+    OPC_6502_D9,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_DD,
+    OPC_6502_DE,
+    OPC_Illegal,
+    OPC_6502_E0,
+    OPC_6502_E1,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_E4,
+    OPC_6502_E5,
+    OPC_6502_E6,
+    OPC_Illegal,
+    OPC_6502_E8,
+    OPC_6502_E9,
+    OPC_6502_EA,
+    OPC_Illegal,
+    OPC_6502_EC,
+    OPC_6502_ED,
+    OPC_6502_EE,
+    OPC_Illegal,
+    OPC_6502_F0,
+    OPC_6502_F1,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_F5,
+    OPC_6502_F6,
+    OPC_Illegal,
+    OPC_6502_F8,
+    OPC_6502_F9,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_Illegal,
+    OPC_6502_FD,
+    OPC_6502_FE,
+    OPC_Illegal,
+};
+
+
+
+/* Opcode handler table for the 65C02 */
+static const OPFunc OP65C02Table[256] = {
+    OPC_6502_00,
+    OPC_6502_01,
+    OPC_65C02_NOP22,    // $02
+    OPC_65C02_NOP11,    // $03
+    OPC_65SC02_04,
+    OPC_6502_05,
+    OPC_6502_06,
+    OPC_Illegal,        // $07: RMB0 currently unsupported
+    OPC_6502_08,
+    OPC_6502_09,
+    OPC_6502_0A,
+    OPC_65C02_NOP11,    // $0B
+    OPC_65SC02_0C,
+    OPC_6502_0D,
+    OPC_6502_0E,
+    OPC_Illegal,        // $0F: BBR0 currently unsupported
+    OPC_6502_10,
+    OPC_6502_11,
+    OPC_65SC02_12,
+    OPC_65C02_NOP11,    // $13
+    OPC_65SC02_14,
+    OPC_6502_15,
+    OPC_6502_16,
+    OPC_Illegal,        // $17: RMB1 currently unsupported
+    OPC_6502_18,
+    OPC_6502_19,
+    OPC_65SC02_1A,
+    OPC_65C02_NOP11,    // $1B
+    OPC_65SC02_1C,
+    OPC_6502_1D,
+    OPC_6502_1E,
+    OPC_Illegal,        // $1F: BBR1 currently unsupported
+    OPC_6502_20,
+    OPC_6502_21,
+    OPC_65C02_NOP22,    // $22
+    OPC_65C02_NOP11,    // $23
+    OPC_6502_24,
+    OPC_6502_25,
+    OPC_6502_26,
+    OPC_Illegal,        // $27: RMB2 currently unsupported
+    OPC_6502_28,
+    OPC_6502_29,
+    OPC_6502_2A,
+    OPC_65C02_NOP11,    // $2B
+    OPC_6502_2C,
+    OPC_6502_2D,
+    OPC_6502_2E,
+    OPC_Illegal,        // $2F: BBR2 currently unsupported
+    OPC_6502_30,
+    OPC_6502_31,
+    OPC_65SC02_32,
+    OPC_65C02_NOP11,    // $33
+    OPC_65SC02_34,
+    OPC_6502_35,
+    OPC_6502_36,
+    OPC_Illegal,        // $37: RMB3 currently unsupported
+    OPC_6502_38,
+    OPC_6502_39,
+    OPC_65SC02_3A,
+    OPC_65C02_NOP11,    // $3B
+    OPC_65SC02_3C,
+    OPC_6502_3D,
+    OPC_6502_3E,
+    OPC_Illegal,        // $3F: BBR3 currently unsupported
+    OPC_6502_40,
+    OPC_6502_41,
+    OPC_65C02_NOP22,    // $42
+    OPC_65C02_NOP11,    // $43
+    OPC_65C02_44,       // $44
+    OPC_6502_45,
+    OPC_6502_46,
+    OPC_Illegal,        // $47: RMB4 currently unsupported
+    OPC_6502_48,
+    OPC_6502_49,
+    OPC_6502_4A,
+    OPC_65C02_NOP11,    // $4B
+    OPC_6502_4C,
+    OPC_6502_4D,
+    OPC_6502_4E,
+    OPC_Illegal,        // $4F: BBR4 currently unsupported
+    OPC_6502_50,
+    OPC_6502_51,
+    OPC_65SC02_52,
+    OPC_65C02_NOP11,    // $53
+    OPC_65C02_NOP24,    // $54
+    OPC_6502_55,
+    OPC_6502_56,
+    OPC_Illegal,        // $57: RMB5 currently unsupported
+    OPC_6502_58,
+    OPC_6502_59,
+    OPC_65SC02_5A,
+    OPC_65C02_NOP11,    // $5B
+    OPC_65C02_5C,
+    OPC_6502_5D,
+    OPC_6502_5E,
+    OPC_Illegal,        // $5F: BBR5 currently unsupported
+    OPC_6502_60,
+    OPC_6502_61,
+    OPC_65C02_NOP22,    // $62
+    OPC_65C02_NOP11,    // $63
+    OPC_65SC02_64,
+    OPC_6502_65,
+    OPC_6502_66,
+    OPC_Illegal,        // $67: RMB6 currently unsupported
+    OPC_6502_68,
+    OPC_6502_69,
+    OPC_6502_6A,
+    OPC_65C02_NOP11,    // $6B
+    OPC_65C02_6C,
+    OPC_6502_6D,
+    OPC_6502_6E,
+    OPC_Illegal,        // $6F: BBR6 currently unsupported
+    OPC_6502_70,
+    OPC_6502_71,
+    OPC_65SC02_72,
+    OPC_65C02_NOP11,    // $73
+    OPC_65SC02_74,
+    OPC_6502_75,
+    OPC_6502_76,
+    OPC_Illegal,        // $77: RMB7 currently unsupported
+    OPC_6502_78,
+    OPC_6502_79,
+    OPC_65SC02_7A,
+    OPC_65C02_NOP11,    // $7B
+    OPC_65SC02_7C,
+    OPC_6502_7D,
+    OPC_6502_7E,
+    OPC_Illegal,        // $7F: BBR7 currently unsupported
+    OPC_65SC02_80,
+    OPC_6502_81,
+    OPC_65C02_NOP22,    // $82
+    OPC_65C02_NOP11,    // $83
+    OPC_6502_84,
+    OPC_6502_85,
+    OPC_6502_86,
+    OPC_Illegal,        // $87: SMB0 currently unsupported
+    OPC_6502_88,
+    OPC_65SC02_89,
+    OPC_6502_8A,
+    OPC_65C02_NOP11,    // $8B
+    OPC_6502_8C,
+    OPC_6502_8D,
+    OPC_6502_8E,
+    OPC_Illegal,        // $8F: BBS0 currently unsupported
+    OPC_6502_90,
+    OPC_6502_91,
+    OPC_65SC02_92,
+    OPC_65C02_NOP11,    // $93
+    OPC_6502_94,
+    OPC_6502_95,
+    OPC_6502_96,
+    OPC_Illegal,        // $97: SMB1 currently unsupported
+    OPC_6502_98,
+    OPC_6502_99,
+    OPC_6502_9A,
+    OPC_65C02_NOP11,    // $9B
+    OPC_65SC02_9C,
+    OPC_6502_9D,
+    OPC_65SC02_9E,
+    OPC_Illegal,        // $9F: BBS1 currently unsupported
+    OPC_6502_A0,
+    OPC_6502_A1,
+    OPC_6502_A2,
+    OPC_65C02_NOP11,    // $A3
+    OPC_6502_A4,
+    OPC_6502_A5,
+    OPC_6502_A6,
+    OPC_Illegal,        // $A7: SMB2 currently unsupported
+    OPC_6502_A8,
+    OPC_6502_A9,
+    OPC_6502_AA,
+    OPC_65C02_NOP11,    // $AB
+    OPC_6502_AC,
+    OPC_6502_AD,
+    OPC_6502_AE,
+    OPC_Illegal,        // $AF: BBS2 currently unsupported
+    OPC_6502_B0,
+    OPC_6502_B1,
+    OPC_65SC02_B2,
+    OPC_65C02_NOP11,    // $B3
+    OPC_6502_B4,
+    OPC_6502_B5,
+    OPC_6502_B6,
+    OPC_Illegal,        // $B7: SMB3 currently unsupported
+    OPC_6502_B8,
+    OPC_6502_B9,
+    OPC_6502_BA,
+    OPC_65C02_NOP11,    // $BB
+    OPC_6502_BC,
+    OPC_6502_BD,
+    OPC_6502_BE,
+    OPC_Illegal,        // $BF: BBS3 currently unsupported
+    OPC_6502_C0,
+    OPC_6502_C1,
+    OPC_65C02_NOP22,    // $C2
+    OPC_65C02_NOP11,    // $C3
+    OPC_6502_C4,
+    OPC_6502_C5,
+    OPC_6502_C6,
+    OPC_Illegal,        // $C7: SMB4 currently unsupported
+    OPC_6502_C8,
+    OPC_6502_C9,
+    OPC_6502_CA,
+    OPC_Illegal,        // $CB: WAI currently unsupported
+    OPC_6502_CC,
+    OPC_6502_CD,
+    OPC_6502_CE,
+    OPC_Illegal,        // $CF: BBS4 currently unsupported
+    OPC_6502_D0,
+    OPC_6502_D1,
+    OPC_65SC02_D2,
+    OPC_65C02_NOP11,    // $D3
+    OPC_65C02_NOP24,    // $D4
+    OPC_6502_D5,
+    OPC_6502_D6,
+    OPC_Illegal,        // $D7: SMB5 currently unsupported
+    OPC_6502_D8,
+    OPC_6502_D9,
+    OPC_65SC02_DA,
+    OPC_Illegal,        // $DB: STP currently unsupported
+    OPC_65C02_NOP34,    // $DC
+    OPC_6502_DD,
+    OPC_6502_DE,
+    OPC_Illegal,        // $DF: BBS5 currently unsupported
+    OPC_6502_E0,
+    OPC_6502_E1,
+    OPC_65C02_NOP22,    // $E2
+    OPC_65C02_NOP11,    // $E3
+    OPC_6502_E4,
+    OPC_6502_E5,
+    OPC_6502_E6,
+    OPC_Illegal,        // $E7: SMB6 currently unsupported
+    OPC_6502_E8,
+    OPC_6502_E9,
+    OPC_6502_EA,
+    OPC_65C02_NOP11,    // $EB
+    OPC_6502_EC,
+    OPC_6502_ED,
+    OPC_6502_EE,
+    OPC_Illegal,        // $EF: BBS6 currently unsupported
+    OPC_6502_F0,
     OPC_6502_F1,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_Illegal,
+    OPC_65SC02_F2,
+    OPC_65C02_NOP11,    // $F3
+    OPC_65C02_NOP24,    // $F4
     OPC_6502_F5,
     OPC_6502_F6,
-    OPC_Illegal,
+    OPC_Illegal,        // $F7: SMB7 currently unsupported
     OPC_6502_F8,
     OPC_6502_F9,
-    OPC_Illegal,
-    OPC_Illegal,
-    OPC_Illegal,
+    OPC_65SC02_FA,
+    OPC_65C02_NOP11,    // $FB
+    OPC_65C02_NOP34,    // $FC
     OPC_6502_FD,
     OPC_6502_FE,
-    OPC_Illegal,
+    OPC_Illegal,        // $FF: BBS7 currently unsupported
 };
 
 
 
-/* Opcode handler table for the 65C02 */
-static const OPFunc OP65C02Table[256] = {
+/* Opcode handler table for the 65816. The core runs in emulation mode;
+** see the comment at the 65816 opcode handlers.
+*/
+static const OPFunc OP65816Table[256] = {
     OPC_6502_00,
     OPC_6502_01,
-    OPC_65C02_NOP22,    // $02
-    OPC_65C02_NOP11,    // $03
+    OPC_65816_02,       // $02: COP sig
+    OPC_65816_03,       // $03: ORA sr,S
     OPC_65SC02_04,
     OPC_6502_05,
     OPC_6502_06,
-    OPC_Illegal,        // $07: RMB0 currently unsupported
+    OPC_65816_07,       // $07: ORA [zp]
     OPC_6502_08,
     OPC_6502_09,
     OPC_6502_0A,
-    OPC_65C02_NOP11,    // $0B
+    OPC_65816_0B,       // $0B: PHD
     OPC_65SC02_0C,
     OPC_6502_0D,
     OPC_6502_0E,
-    OPC_Illegal,        // $0F: BBR0 currently unsupported
+    OPC_65816_0F,       // $0F: ORA long
     OPC_6502_10,
     OPC_6502_11,
     OPC_65SC02_12,
-    OPC_65C02_NOP11,    // $13
+    OPC_65816_13,       // $13: ORA (sr,S),y
     OPC_65SC02_14,
     OPC_6502_15,
     OPC_6502_16,
-    OPC_Illegal,        // $17: RMB1 currently unsupported
+    OPC_65816_17,       // $17: ORA [zp],y
     OPC_6502_18,
     OPC_6502_19,
     OPC_65SC02_1A,
-    OPC_65C02_NOP11,    // $1B
+    OPC_65816_1B,       // $1B: TCS
     OPC_65SC02_1C,
     OPC_6502_1D,
     OPC_6502_1E,
-    OPC_Illegal,        // $1F: BBR1 currently unsupported
+    OPC_65816_1F,       // $1F: ORA long,x
     OPC_6502_20,
     OPC_6502_21,
-    OPC_65C02_NOP22,    // $22
-    OPC_65C02_NOP11,    // $23
+    OPC_65816_22,       // $22: JSL long
+    OPC_65816_23,       // $23: AND sr,S
     OPC_6502_24,
     OPC_6502_25,
     OPC_6502_26,
-    OPC_Illegal,        // $27: RMB2 currently unsupported
+    OPC_65816_27,       // $27: AND [zp]
     OPC_6502_28,
     OPC_6502_29,
     OPC_6502_2A,
-    OPC_65C02_NOP11,    // $2B
+    OPC_65816_2B,       // $2B: PLD
     OPC_6502_2C,
     OPC_6502_2D,
     OPC_6502_2E,
-    OPC_Illegal,        // $2F: BBR2 currently unsupported
+    OPC_65816_2F,       // $2F: AND long
     OPC_6502_30,
     OPC_6502_31,
     OPC_65SC02_32,
-    OPC_65C02_NOP11,    // $33
+    OPC_65816_33,       // $33: AND (sr,S),y
     OPC_65SC02_34,
     OPC_6502_35,
     OPC_6502_36,
-    OPC_Illegal,        // $37: RMB3 currently unsupported
+    OPC_65816_37,       // $37: AND [zp],y
     OPC_6502_38,
     OPC_6502_39,
     OPC_65SC02_3A,
-    OPC_65C02_NOP11,    // $3B
+    OPC_65816_3B,       // $3B: TSC
     OPC_65SC02_3C,
     OPC_6502_3D,
     OPC_6502_3E,
-    OPC_Illegal,        // $3F: BBR3 currently unsupported
+    OPC_65816_3F,       // $3F: AND long,x
     OPC_6502_40,
     OPC_6502_41,
-    OPC_65C02_NOP22,    // $42
-    OPC_65C02_NOP11,    // $43
-    OPC_65C02_44,       // $44
+    OPC_65816_42,       // $42: WDM sig
+    OPC_65816_43,       // $43: EOR sr,S
+    OPC_65816_44,       // $44: MVP src,dst
     OPC_6502_45,
     OPC_6502_46,
-    OPC_Illegal,        // $47: RMB4 currently unsupported
+    OPC_65816_47,       // $47: EOR [zp]
     OPC_6502_48,
     OPC_6502_49,
     OPC_6502_4A,
-    OPC_65C02_NOP11,    // $4B
+    OPC_65816_4B,       // $4B: PHK
     OPC_6502_4C,
     OPC_6502_4D,
     OPC_6502_4E,
-    OPC_Illegal,        // $4F: BBR4 currently unsupported
+    OPC_65816_4F,       // $4F: EOR long
     OPC_6502_50,
     OPC_6502_51,
     OPC_65SC02_52,
-    OPC_65C02_NOP11,    // $53
-    OPC_65C02_NOP24,    // $54
+    OPC_65816_53,       // $53: EOR (sr,S),y
+    OPC_65816_54,       // $54: MVN src,dst
     OPC_6502_55,
     OPC_6502_56,
-    OPC_Illegal,        // $57: RMB5 currently unsupported
+    OPC_65816_57,       // $57: EOR [zp],y
     OPC_6502_58,
     OPC_6502_59,
     OPC_65SC02_5A,
-    OPC_65C02_NOP11,    // $5B
-    OPC_65C02_5C,
+    OPC_65816_5B,       // $5B: TCD
+    OPC_65816_5C,       // $5C: JML long
     OPC_6502_5D,
     OPC_6502_5E,
-    OPC_Illegal,        // $5F: BBR5 currently unsupported
+    OPC_65816_5F,       // $5F: EOR long,x
     OPC_6502_60,
     OPC_6502_61,
-    OPC_65C02_NOP22,    // $62
-    OPC_65C02_NOP11,    // $63
+    OPC_65816_62,       // $62: PER rel16
+    OPC_65816_63,       // $63: ADC sr,S
     OPC_65SC02_64,
     OPC_6502_65,
     OPC_6502_66,
-    OPC_Illegal,        // $67: RMB6 currently unsupported
+    OPC_65816_67,       // $67: ADC [zp]
     OPC_6502_68,
     OPC_6502_69,
     OPC_6502_6A,
-    OPC_65C02_NOP11,    // $6B
+    OPC_65816_6B,       // $6B: RTL
     OPC_65C02_6C,
     OPC_6502_6D,
     OPC_6502_6E,
-    OPC_Illegal,        // $6F: BBR6 currently unsupported
+    OPC_65816_6F,       // $6F: ADC long
     OPC_6502_70,
     OPC_6502_71,
     OPC_65SC02_72,
-    OPC_65C02_NOP11,    // $73
+    OPC_65816_73,       // $73: ADC (sr,S),y
     OPC_65SC02_74,
     OPC_6502_75,
     OPC_6502_76,
-    OPC_Illegal,        // $77: RMB7 currently unsupported
+    OPC_65816_77,       // $77: ADC [zp],y
     OPC_6502_78,
     OPC_6502_79,
     OPC_65SC02_7A,
-    OPC_65C02_NOP11,    // $7B
+    OPC_65816_7B,       // $7B: TDC
     OPC_65SC02_7C,
     OPC_6502_7D,
     OPC_6502_7E,
-    OPC_Illegal,        // $7F: BBR7 currently unsupported
+    OPC_65816_7F,       // $7F: ADC long,x
     OPC_65SC02_80,
     OPC_6502_81,
-    OPC_65C02_NOP22,    // $82
-    OPC_65C02_NOP11,    // $83
+    OPC_65816_82,       // $82: BRL rel16
+    OPC_65816_83,       // $83: STA sr,S
     OPC_6502_84,
     OPC_6502_85,
     OPC_6502_86,
-    OPC_Illegal,        // $87: SMB0 currently unsupported
+    OPC_65816_87,       // $87: STA [zp]
     OPC_6502_88,
     OPC_65SC02_89,
     OPC_6502_8A,
-    OPC_65C02_NOP11,    // $8B
+    OPC_65816_8B,       // $8B: PHB
     OPC_6502_8C,
     OPC_6502_8D,
     OPC_6502_8E,
-    OPC_Illegal,        // $8F: BBS0 currently unsupported
+    OPC_65816_8F,       // $8F: STA long
     OPC_6502_90,
     OPC_6502_91,
     OPC_65SC02_92,
-    OPC_65C02_NOP11,    // $93
+    OPC_65816_93,       // $93: STA (sr,S),y
     OPC_6502_94,
     OPC_6502_95,
     OPC_6502_96,
-    OPC_Illegal,        // $97: SMB1 currently unsupported
+    OPC_65816_97,       // $97: STA [zp],y
     OPC_6502_98,
     OPC_6502_99,
     OPC_6502_9A,
-    OPC_65C02_NOP11,    // $9B
+    OPC_65816_9B,       // $9B: TXY
     OPC_65SC02_9C,
     OPC_6502_9D,
     OPC_65SC02_9E,
-    OPC_Illegal,        // $9F: BBS1 currently unsupported
+    OPC_65816_9F,       // $9F: STA long,x
     OPC_6502_A0,
     OPC_6502_A1,
     OPC_6502_A2,
-    OPC_65C02_NOP11,    // $A3
+    OPC_65816_A3,       // $A3: LDA sr,S
     OPC_6502_A4,
     OPC_6502_A5,
     OPC_6502_A6,
-    OPC_Illegal,        // $A7: SMB2 currently unsupported
+    OPC_65816_A7,       // $A7: LDA [zp]
     OPC_6502_A8,
     OPC_6502_A9,
     OPC_6502_AA,
-    OPC_65C02_NOP11,    // $AB
+    OPC_65816_AB,       // $AB: PLB
     OPC_6502_AC,
     OPC_6502_AD,
     OPC_6502_AE,
-    OPC_Illegal,        // $AF: BBS2 currently unsupported
+    OPC_65816_AF,       // $AF: LDA long
     OPC_6502_B0,
     OPC_6502_B1,
     OPC_65SC02_B2,
-    OPC_65C02_NOP11,    // $B3
+    OPC_65816_B3,       // $B3: LDA (sr,S),y
     OPC_6502_B4,
     OPC_6502_B5,
     OPC_6502_B6,
-    OPC_Illegal,        // $B7: SMB3 currently unsupported
+    OPC_65816_B7,       // $B7: LDA [zp],y
     OPC_6502_B8,
     OPC_6502_B9,
     OPC_6502_BA,
-    OPC_65C02_NOP11,    // $BB
+    OPC_65816_BB,       // $BB: TYX
     OPC_6502_BC,
     OPC_6502_BD,
     OPC_6502_BE,
-    OPC_Illegal,        // $BF: BBS3 currently unsupported
+    OPC_65816_BF,       // $BF: LDA long,x
     OPC_6502_C0,
     OPC_6502_C1,
-    OPC_65C02_NOP22,    // $C2
-    OPC_65C02_NOP11,    // $C3
+    OPC_65816_C2,       // $C2: REP #imm
+    OPC_65816_C3,       // $C3: CMP sr,S
     OPC_6502_C4,
     OPC_6502_C5,
     OPC_6502_C6,
-    OPC_Illegal,        // $C7: SMB4 currently unsupported
+    OPC_65816_C7,       // $C7: CMP [zp]
     OPC_6502_C8,
     OPC_6502_C9,
     OPC_6502_CA,
-    OPC_Illegal,        // $CB: WAI currently unsupported
+    OPC_65816_CB,       // $CB: WAI
     OPC_6502_CC,
     OPC_6502_CD,
     OPC_6502_CE,
-    OPC_Illegal,        // $CF: BBS4 currently unsupported
+    OPC_65816_CF,       // $CF: CMP long
     OPC_6502_D0,
     OPC_6502_D1,
     OPC_65SC02_D2,
-    OPC_65C02_NOP11,    // $D3
-    OPC_65C02_NOP24,    // $D4
+    OPC_65816_D3,       // $D3: CMP (sr,S),y
+    OPC_65816_D4,       // $D4: PEI (zp)
     OPC_6502_D5,
     OPC_6502_D6,
-    OPC_Illegal,        // $D7: SMB5 currently unsupported
+    OPC_65816_D7,       // $D7: CMP [zp],y
     OPC_6502_D8,
     OPC_6502_D9,
     OPC_65SC02_DA,
-    OPC_Illegal,        // $DB: STP currently unsupported
-    OPC_65C02_NOP34,    // $DC
+    OPC_65816_DB,       // $DB: STP
+    OPC_65816_DC,       // $DC: JML (ind)
     OPC_6502_DD,
     OPC_6502_DE,
-    OPC_Illegal,        // $DF: BBS5 currently unsupported
+    OPC_65816_DF,       // $DF: CMP long,x
     OPC_6502_E0,
     OPC_6502_E1,
-    OPC_65C02_NOP22,    // $E2
-    OPC_65C02_NOP11,    // $E3
+    OPC_65816_E2,       // $E2: SEP #imm
+    OPC_65816_E3,       // $E3: SBC sr,S
     OPC_6502_E4,
     OPC_6502_E5,
     OPC_6502_E6,
-    OPC_Illegal,        // $E7: SMB6 currently unsupported
+    OPC_65816_E7,       // $E7: SBC [zp]
     OPC_6502_E8,
     OPC_6502_E9,
     OPC_6502_EA,
-    OPC_65C02_NOP11,    // $EB
+    OPC_65816_EB,       // $EB: XBA
     OPC_6502_EC,
     OPC_6502_ED,
     OPC_6502_EE,
-    OPC_Illegal,        // $EF: BBS6 currently unsupported
+    OPC_65816_EF,       // $EF: SBC long
     OPC_6502_F0,
     OPC_6502_F1,
     OPC_65SC02_F2,
-    OPC_65C02_NOP11,    // $F3
-    OPC_65C02_NOP24,    // $F4
+    OPC_65816_F3,       // $F3: SBC (sr,S),y
+    OPC_65816_F4,       // $F4: PEA #imm16
     OPC_6502_F5,
     OPC_6502_F6,
-    OPC_Illegal,        // $F7: SMB7 currently unsupported
+    OPC_65816_F7,       // $F7: SBC [zp],y
     OPC_6502_F8,
     OPC_6502_F9,
     OPC_65SC02_FA,
-    OPC_65C02_NOP11,    // $FB
+    OPC_65816_FB,       // $FB: XCE
     OPC_65C02_NOP34,    // $FC
     OPC_6502_FD,
     OPC_6502_FE,
-    OPC_Illegal,        // $FF: BBS7 currently unsupported
+    OPC_65816_FF,       // $FF: SBC long,x
 };
 
 
 
 /* Tables with opcode handlers */
-static const OPFunc* Handlers[2] = {OP6502Table, OP65C02Table};
+static const OPFunc* Handlers[3] = {OP6502Table, OP65C02Table, OP65816Table};
+
+/* Handler table for the current CPU, cached on reset so the dispatch in
+** ExecuteInsn indexes just one table.
+*/
+static const OPFunc* HandlerTab;
 
 
 
@@ -3232,6 +4528,9 @@ void Reset (void)
     /* Bits 5 and 4 aren't used, and always are 1! */
     Regs.SR = 0x30;
     Regs.PC = MemReadWord (0xFFFC);
+
+    /* Cache the handler table for the selected CPU */
+    HandlerTab = Handlers[CPU];
 }
 
 
@@ -3239,6 +4538,9 @@ void Reset (void)
 unsigned ExecuteInsn (void)
 /* Execute one CPU instruction */
 {
+    /* Remember the address of the insn for the execution profile */
+    unsigned StartPC = Regs.PC;
+
     /* If we have an NMI request, handle it */
     if (HaveNMIRequest) {
 
@@ -3274,12 +4576,23 @@ unsigned ExecuteInsn (void)
         unsigned char OPC = MemReadByte (Regs.PC);
 
         /* Execute it */
-        Handlers[CPU][OPC] ();
+        HandlerTab[OPC] ();
     }
 
     /* Count cycles */
     TotalCycles += Cycles;
 
+    /* Attribute the cycles to the address of the insn if profiling */
+    if (ProfileBuf) {
+        ProfileBuf[StartPC & 0xFFFF] += Cycles;
+        ++ProfileCount[StartPC & 0xFFFF];
+    }
+
+    /* Mark the address of the insn in the coverage bitmap */
+    if (CoverageBuf) {
+        CoverageBuf[(StartPC & 0xFFFF) >> 3] |= 0x01 << (StartPC & 0x07);
+    }
+
     /* Return the number of clock cycles needed by this insn */
     return Cycles;
 }
@@ -3292,3 +4605,315 @@ unsigned long GetCycles (void)
     /* Return the total number of cycles */
     return TotalCycles;
 }
+
+
+
+void SaveCPUState (void)
+/* Save the CPU state for later restoration */
+{
+    SavedRegs       = Regs;
+    SavedCycles     = TotalCycles;
+    SavedNMIRequest = HaveNMIRequest;
+    SavedIRQRequest = HaveIRQRequest;
+}
+
+
+
+void RestoreCPUState (void)
+/* Restore the CPU state from the snapshot */
+{
+    Regs           = SavedRegs;
+    TotalCycles    = SavedCycles;
+    HaveNMIRequest = SavedNMIRequest;
+    HaveIRQRequest = SavedIRQRequest;
+}
+
+
+
+void SetPC (unsigned Addr)
+/* Set the program counter */
+{
+    Regs.PC = Addr;
+}
+
+
+
+void EnableProfiling (void)
+/* Allocate and clear the counters for the execution profile */
+{
+    if (ProfileBuf == 0) {
+        ProfileBuf      = xmalloc (0x10000 * sizeof (*ProfileBuf));
+        ProfileCount    = xmalloc (0x10000 * sizeof (*ProfileCount));
+        ProfileTaken    = xmalloc (0x10000 * sizeof (*ProfileTaken));
+        ProfileNotTaken = xmalloc (0x10000 * sizeof (*ProfileNotTaken));
+        memset (ProfileBuf,      0, 0x10000 * sizeof (*ProfileBuf));
+        memset (ProfileCount,    0, 0x10000 * sizeof (*ProfileCount));
+        memset (ProfileTaken,    0, 0x10000 * sizeof (*ProfileTaken));
+        memset (ProfileNotTaken, 0, 0x10000 * sizeof (*ProfileNotTaken));
+    }
+}
+
+
+
+void EnableCoverage (void)
+/* Allocate and clear the coverage bitmap */
+{
+    if (CoverageBuf == 0) {
+        CoverageBuf = xmalloc (0x10000 / 8);
+        memset (CoverageBuf, 0, 0x10000 / 8);
+    }
+}
+
+
+
+void WriteCoverage (void)
+/* Write the coverage bitmap to the file given by CoverageName. The file
+** contains the raw bitmap, one bit per address in little endian bit order,
+** 8K in total.
+*/
+{
+    /* Open the output file */
+    FILE* F = fopen (CoverageName, "wb");
+    if (F == 0) {
+        Warning ("Cannot open '%s': %s", CoverageName, strerror (errno));
+        return;
+    }
+
+    /* Dump the bitmap */
+    if (fwrite (CoverageBuf, 1, 0x10000 / 8, F) != 0x10000 / 8) {
+        Warning ("Cannot write to '%s'", CoverageName);
+    }
+
+    /* Close the file */
+    fclose (F);
+}
+
+
+
+/* One basic block in the profile report */
+typedef struct ProfBlock ProfBlock;
+struct ProfBlock {
+    unsigned            Start;          /* First address of the block */
+    unsigned            End;            /* Last address of the block */
+    unsigned long       Execs;          /* Number of executions */
+    unsigned long       Cycles;         /* Cycles spent in the block */
+};
+
+/* One label from a VICE label file used for the per symbol rollup */
+typedef struct ProfLabel ProfLabel;
+struct ProfLabel {
+    unsigned long       Addr;           /* Address of the label */
+    char*               Name;           /* Name of the label */
+    unsigned long       Execs;          /* Executions attributed to it */
+    unsigned long       Cycles;         /* Cycles attributed to it */
+};
+
+
+
+static int CmpBlockCycles (const void* L, const void* R)
+/* Compare function to sort basic blocks by cycles, descending */
+{
+    const ProfBlock* Left  = L;
+    const ProfBlock* Right = R;
+    if (Left->Cycles != Right->Cycles) {
+        return (Left->Cycles < Right->Cycles)? 1 : -1;
+    }
+    return (Left->Start > Right->Start) - (Left->Start < Right->Start);
+}
+
+
+
+static int CmpLabelAddr (const void* L, const void* R)
+/* Compare function to sort labels by address, ascending */
+{
+    const ProfLabel* Left  = L;
+    const ProfLabel* Right = R;
+    return (Left->Addr > Right->Addr) - (Left->Addr < Right->Addr);
+}
+
+
+
+static int CmpLabelCycles (const void* L, const void* R)
+/* Compare function to sort labels by cycles, descending */
+{
+    const ProfLabel* Left  = L;
+    const ProfLabel* Right = R;
+    if (Left->Cycles != Right->Cycles) {
+        return (Left->Cycles < Right->Cycles)? 1 : -1;
+    }
+    return CmpLabelAddr (L, R);
+}
+
+
+
+static ProfLabel* ReadProfileLabels (unsigned* Count)
+/* Read the VICE label file given by ProfileLabelsName, as written by ld65
+** with -Ln. Return the labels sorted by address and their number in Count.
+*/
+{
+    char Line[512];
+    char Name[256];
+    unsigned long Addr;
+    ProfLabel* Labels = 0;
+    unsigned N = 0;
+    unsigned Size = 0;
+
+    /* Open the label file */
+    FILE* F = fopen (ProfileLabelsName, "r");
+    if (F == 0) {
+        Warning ("Cannot open '%s': %s", ProfileLabelsName, strerror (errno));
+        *Count = 0;
+        return 0;
+    }
+
+    /* Read the labels, ignoring lines in other formats and addresses
+    ** outside the 64K address space.
+    */
+    while (fgets (Line, sizeof (Line), F) != 0) {
+        if (sscanf (Line, "al %lx .%255s", &Addr, Name) != 2 ||
+            Addr > 0xFFFF) {
+            continue;
+        }
+        if (N >= Size) {
+            Size = (Size == 0)? 256 : Size * 2;
+            Labels = xrealloc (Labels, Size * sizeof (*Labels));
+        }
+        Labels[N].Addr   = Addr;
+        Labels[N].Name   = xstrdup (Name);
+        Labels[N].Execs  = 0;
+        Labels[N].Cycles = 0;
+        ++N;
+    }
+    fclose (F);
+
+    /* Sort the labels by address for the rollup */
+    qsort (Labels, N, sizeof (*Labels), CmpLabelAddr);
+
+    *Count = N;
+    return Labels;
+}
+
+
+
+void WriteProfile (void)
+/* Write the execution profile to the file given by ProfileName. The first
+** section lists each executed address with its execution and cycle counts.
+** It is followed by the hottest basic blocks, the taken/not taken counts
+** for all executed branches and - if a label file was given - a per symbol
+** rollup of the counters.
+*/
+{
+    unsigned long Addr;
+    unsigned I;
+    ProfBlock* Blocks = 0;
+    unsigned BlockCount = 0;
+    unsigned BlockSize = 0;
+
+    /* Open the output file */
+    FILE* F = fopen (ProfileName, "w");
+    if (F == 0) {
+        Warning ("Cannot open '%s': %s", ProfileName, strerror (errno));
+        return;
+    }
+
+    /* Dump the non zero counters */
+    fprintf (F, "; address: executions cycles\n");
+    for (Addr = 0; Addr < 0x10000; ++Addr) {
+        if (ProfileBuf[Addr] != 0) {
+            fprintf (F, "%04lX %lu %lu\n",
+                     Addr, ProfileCount[Addr], ProfileBuf[Addr]);
+        }
+    }
+
+    /* Collect basic blocks: A block is a run of executed addresses with
+    ** identical execution counts and no gap larger than the longest insn.
+    ** Targets of branches into the middle of a run change the count and
+    ** therefore start a new block.
+    */
+    for (Addr = 0; Addr < 0x10000; ++Addr) {
+        if (ProfileCount[Addr] == 0) {
+            continue;
+        }
+        if (BlockCount > 0                                      &&
+            Addr - Blocks[BlockCount-1].End <= 3                &&
+            Blocks[BlockCount-1].Execs == ProfileCount[Addr]) {
+            /* Continuation of the current block */
+            Blocks[BlockCount-1].End     = (unsigned) Addr;
+            Blocks[BlockCount-1].Cycles += ProfileBuf[Addr];
+        } else {
+            /* Start of a new block */
+            if (BlockCount >= BlockSize) {
+                BlockSize = (BlockSize == 0)? 256 : BlockSize * 2;
+                Blocks = xrealloc (Blocks, BlockSize * sizeof (*Blocks));
+            }
+            Blocks[BlockCount].Start  = (unsigned) Addr;
+            Blocks[BlockCount].End    = (unsigned) Addr;
+            Blocks[BlockCount].Execs  = ProfileCount[Addr];
+            Blocks[BlockCount].Cycles = ProfileBuf[Addr];
+            ++BlockCount;
+        }
+    }
+
+    /* Report the hottest blocks */
+    qsort (Blocks, BlockCount, sizeof (*Blocks), CmpBlockCycles);
+    fprintf (F, "; hottest blocks: start-end executions cycles\n");
+    for (I = 0; I < BlockCount && I < 16; ++I) {
+        fprintf (F, "%04X-%04X %lu %lu\n",
+                 Blocks[I].Start, Blocks[I].End,
+                 Blocks[I].Execs, Blocks[I].Cycles);
+    }
+    xfree (Blocks);
+
+    /* Report the branch statistics */
+    fprintf (F, "; branches: address taken not-taken\n");
+    for (Addr = 0; Addr < 0x10000; ++Addr) {
+        if (ProfileTaken[Addr] != 0 || ProfileNotTaken[Addr] != 0) {
+            fprintf (F, "%04lX %lu %lu\n",
+                     Addr, ProfileTaken[Addr], ProfileNotTaken[Addr]);
+        }
+    }
+
+    /* If a label file was given, attribute the counters to the symbols.
+    ** Each address is billed to the nearest label at or below it.
+    */
+    if (ProfileLabelsName) {
+        unsigned LabelCount;
+        ProfLabel* Labels = ReadProfileLabels (&LabelCount);
+        if (LabelCount > 0) {
+            for (Addr = 0; Addr < 0x10000; ++Addr) {
+                unsigned Lo, Hi;
+                if (ProfileCount[Addr] == 0 || Addr < Labels[0].Addr) {
+                    continue;
+                }
+                /* Binary search for the last label at or below Addr */
+                Lo = 0;
+                Hi = LabelCount - 1;
+                while (Lo < Hi) {
+                    unsigned Mid = (Lo + Hi + 1) / 2;
+                    if (Labels[Mid].Addr <= Addr) {
+                        Lo = Mid;
+                    } else {
+                        Hi = Mid - 1;
+                    }
+                }
+                Labels[Lo].Execs  += ProfileCount[Addr];
+                Labels[Lo].Cycles += ProfileBuf[Addr];
+            }
+
+            /* Report the symbols, hottest first */
+            qsort (Labels, LabelCount, sizeof (*Labels), CmpLabelCycles);
+            fprintf (F, "; symbols: name executions cycles\n");
+            for (I = 0; I < LabelCount; ++I) {
+                if (Labels[I].Cycles != 0) {
+                    fprintf (F, "%s %lu %lu\n",
+                             Labels[I].Name, Labels[I].Execs, Labels[I].Cycles);
+                }
+                xfree (Labels[I].Name);
+            }
+        }
+        xfree (Labels);
+    }
+
+    /* Close the file */
+    fclose (F);
+}
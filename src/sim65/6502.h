@@ -47,7 +47,8 @@
 /* Supported CPUs */
 typedef enum CPUType {
     CPU_6502,
-    CPU_65C02
+    CPU_65C02,
+    CPU_65816
 } CPUType;
 
 /* Current CPU */
@@ -63,6 +64,9 @@ struct CPURegs {
     unsigned    SR;             /* Status register */
     unsigned    SP;             /* Stackpointer */
     unsigned    PC;             /* Program counter */
+    unsigned    AH;             /* Hidden B accumulator (65816) */
+    unsigned    DR;             /* Direct page register (65816) */
+    unsigned    BR;             /* Data bank register (65816) */
 };
 
 /* Status register bits */
@@ -99,9 +103,47 @@ unsigned ExecuteInsn (void);
 unsigned long GetCycles (void);
 /* Return the total number of clock cycles executed */
 
+void SaveCPUState (void);
+/* Save the CPU state for later restoration */
+
+void RestoreCPUState (void);
+/* Restore the CPU state from the snapshot */
+
+void SetPC (unsigned Addr);
+/* Set the program counter */
+
+void EnableProfiling (void);
+/* Allocate and clear the counters for the execution profile */
+
+void EnableCoverage (void);
+/* Allocate and clear the coverage bitmap */
+
+void WriteCoverage (void);
+/* Write the coverage bitmap to the file given by CoverageName. The file
+** contains the raw bitmap, one bit per address in little endian bit order,
+** 8K in total.
+*/
+
+void WriteProfile (void);
+/* Write the execution profile to the file given by ProfileName. The first
+** section lists each executed address with its execution and cycle counts.
+** It is followed by the hottest basic blocks, the taken/not taken counts
+** for all executed branches and - if a label file was given - a per symbol
+** rollup of the counters.
+*/
+
 extern int PrintCycles;
 /* flag to print cycles at program termination */
 
+extern const char* ProfileName;
+/* name of file to write the execution profile to */
+
+extern const char* ProfileLabelsName;
+/* name of a VICE label file used for the per symbol profile rollup */
+
+extern const char* CoverageName;
+/* name of file to write the coverage bitmap to */
+
 
 /* End of 6502.h */
 
@@ -7,7 +7,7 @@
 /*                                                                           */
 /*                                                                           */
 /* (C) 2002-2003 Ullrich von Bassewitz                                       */
-/*               R�merstrasse 52                                             */
+/*               R�merstrasse 52                                             */
 /*               D-70794 Filderstadt                                         */
 /* EMail:        uz@cc65.org                                                 */
 /*                                                                           */
@@ -70,6 +70,12 @@ void Error (const char* Format, ...) attribute((noreturn, format(printf,1,2)));
 /* Print an error message and die */
 
 void ErrorCode (int Code, const char* Format, ...) attribute((noreturn, format(printf,2,3)));
+
+void SimExit (int Code) attribute((noreturn));
+/* Terminate the simulated program with the given exit code. In batch mode
+** this ends the current run instead of the simulator process. Defined in
+** main.c.
+*/
 /* Print an error message and die with the given exit code */
 
 void Internal (const char* Format, ...) attribute((noreturn, format(printf,1,2)));
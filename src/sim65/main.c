@@ -35,6 +35,7 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <setjmp.h>
 #include <errno.h>
 
 /* common */
@@ -63,6 +64,16 @@ const char* ProgramFile;
 /* exit simulator after MaxCycles Cycles */
 unsigned long MaxCycles;
 
+/* Name of a file with entry points for batch mode */
+static const char* BatchFile;
+
+/* Batch mode run control. When a batch run is active, SimExit returns to
+** the batch loop instead of terminating the process.
+*/
+static jmp_buf BatchEnv;
+static int     BatchActive;
+static int     BatchExitCode;
+
 /* Header signature 'sim65' */
 static const unsigned char HeaderSignature[] = {
     0x73, 0x69, 0x6D, 0x36, 0x35
@@ -90,8 +101,14 @@ static void Usage (void)
             "  -x <num>\t\tExit simulator after <num> cycles\n"
             "\n"
             "Long options:\n"
+            "  --batch name\t\tRun the entry points listed in the given file\n"
+            "  --coverage name\tWrite a coverage bitmap to the given file\n"
             "  --help\t\tHelp (this text)\n"
             "  --cycles\t\tPrint amount of executed CPU cycles\n"
+            "  --profile name\tWrite an execution profile to the given file\n"
+            "  --profile-labels name\tUse a VICE label file for the profile symbols\n"
+            "  --rom start-end\tMark the range as ROM, failing on writes to it\n"
+            "  --trace-writes start-end\tLog writes to the given range\n"
             "  --verbose\t\tIncrease verbosity\n"
             "  --version\t\tPrint the simulator version number\n",
             ProgName);
@@ -109,6 +126,15 @@ static void OptHelp (const char* Opt attribute ((unused)),
 
 
 
+static void OptBatch (const char* Opt attribute ((unused)),
+                      const char* Arg)
+/* Run the entry points listed in the given file */
+{
+    BatchFile = Arg;
+}
+
+
+
 static void OptVerbose (const char* Opt attribute ((unused)),
                         const char* Arg attribute ((unused)))
 /* Increase verbosity */
@@ -127,6 +153,72 @@ static void OptCycles (const char* Opt attribute ((unused)),
 
 
 
+static void OptCoverage (const char* Opt attribute ((unused)),
+                         const char* Arg)
+/* Write a coverage bitmap to the given file */
+{
+    CoverageName = Arg;
+    EnableCoverage ();
+}
+
+
+
+static void OptProfile (const char* Opt attribute ((unused)),
+                        const char* Arg)
+/* Write an execution profile to the given file */
+{
+    ProfileName = Arg;
+    EnableProfiling ();
+}
+
+
+
+static void OptProfileLabels (const char* Opt attribute ((unused)),
+                              const char* Arg)
+/* Use a VICE label file for the per symbol profile rollup */
+{
+    ProfileLabelsName = Arg;
+}
+
+
+
+static void GetAddrRange (const char* Opt, const char* Arg,
+                          unsigned* Start, unsigned* End)
+/* Parse an address range given as start-end in hex */
+{
+    unsigned long S, E;
+    char BoundsCheck;
+
+    if (sscanf (Arg, "%lx-%lx%c", &S, &E, &BoundsCheck) != 2 ||
+        S > E || E > 0xFFFF) {
+        Error ("Invalid address range given in argument: %s %s", Opt, Arg);
+    }
+    *Start = (unsigned) S;
+    *End   = (unsigned) E;
+}
+
+
+
+static void OptRom (const char* Opt, const char* Arg)
+/* Mark an address range as ROM, so writes to it are an error */
+{
+    unsigned Start, End;
+    GetAddrRange (Opt, Arg, &Start, &End);
+    MemSetPageAttr (Start, End, MA_ROM);
+}
+
+
+
+static void OptTraceWrites (const char* Opt, const char* Arg)
+/* Log all writes to the given address range */
+{
+    unsigned Start, End;
+    GetAddrRange (Opt, Arg, &Start, &End);
+    MemSetPageAttr (Start, End, MA_WTRACE);
+}
+
+
+
 static void OptVersion (const char* Opt attribute ((unused)),
                         const char* Arg attribute ((unused)))
 /* Print the simulator version */
@@ -142,6 +234,90 @@ static void OptQuitXIns (const char* Opt attribute ((unused)),
     MaxCycles = strtoul(Arg, NULL, 0);
 }
 
+void SimExit (int Code)
+/* Terminate the simulated program with the given exit code. In batch mode
+** this ends the current run instead of the simulator process.
+*/
+{
+    if (BatchActive) {
+        BatchExitCode = Code;
+        longjmp (BatchEnv, 1);
+    }
+    exit (Code);
+}
+
+
+
+static void Run (void)
+/* Run the loaded program until it terminates */
+{
+    while (1) {
+        ExecuteInsn ();
+        if (MaxCycles && (GetCycles () >= MaxCycles)) {
+            ErrorCode (SIM65_ERROR_TIMEOUT, "Maximum number of cycles reached.");
+        }
+    }
+}
+
+
+
+static int BatchRun (unsigned Addr)
+/* Restore the startup snapshot, then run the program once with the given
+** entry point. Return the exit code of the run.
+*/
+{
+    MemRestoreSnapshot ();
+    RestoreCPUState ();
+    SetPC (Addr);
+
+    /* Run until the program exits via SimExit */
+    BatchActive = 1;
+    if (setjmp (BatchEnv) == 0) {
+        Run ();
+    }
+    BatchActive = 0;
+
+    return BatchExitCode;
+}
+
+
+
+static int RunBatch (void)
+/* Run all entry points listed in the batch file against the loaded program,
+** restoring the startup state between runs. Return the number of runs that
+** exited with a code other than zero.
+*/
+{
+    unsigned long Addr;
+    int Failures = 0;
+
+    /* Open the file with the entry points */
+    FILE* F = fopen (BatchFile, "r");
+    if (F == 0) {
+        Error ("Cannot open '%s': %s", BatchFile, strerror (errno));
+    }
+
+    /* Snapshot the startup state once */
+    MemSaveSnapshot ();
+    SaveCPUState ();
+
+    /* One run per entry point */
+    while (fscanf (F, "%lx", &Addr) == 1) {
+        int Code = BatchRun ((unsigned) (Addr & 0xFFFF));
+        printf ("$%04lX: %d\n", Addr & 0xFFFF, Code);
+        if (Code != 0) {
+            ++Failures;
+        }
+    }
+
+    /* Close the file */
+    fclose (F);
+
+    return Failures;
+}
+
+
+
 static unsigned char ReadProgramFile (void)
 /* Load program into memory */
 {
@@ -172,7 +348,7 @@ static unsigned char ReadProgramFile (void)
 
     /* Get the CPU type from the file header */
     if ((Val = fgetc(F)) != EOF) {
-        if (Val != CPU_6502 && Val != CPU_65C02) {
+        if (Val != CPU_6502 && Val != CPU_65C02 && Val != CPU_65816) {
             Error ("'%s': Invalid CPU type", ProgramFile);
         }
         CPU = Val;
@@ -197,13 +373,16 @@ static unsigned char ReadProgramFile (void)
     }
     Reset = Val | (Val2 << 8);
 
-    /* Read the file body into memory */
+    /* Read the file body into memory. The loader stores directly,
+    ** bypassing the page attributes, so a program may be loaded into an
+    ** area that is marked as ROM.
+    */
     Addr = Load;
     while ((Val = fgetc(F)) != EOF) {
         if (Addr >= PARAVIRT_BASE) {
             Error ("'%s': To large to fit into $%04X-$%04X", ProgramFile, Addr, PARAVIRT_BASE);
         }
-        MemWriteByte (Addr++, (unsigned char) Val);
+        Mem[Addr++] = (unsigned char) Val;
     }
 
     /* Check for errors */
@@ -218,7 +397,8 @@ static unsigned char ReadProgramFile (void)
     Print (stderr, 1, "File version: %d\n", Version);
     Print (stderr, 1, "Reset: $%04X\n", Reset);
 
-    MemWriteWord(0xFFFC, Reset);
+    Mem[0xFFFC] = (unsigned char) (Reset & 0xFF);
+    Mem[0xFFFD] = (unsigned char) (Reset >> 8);
     return SPAddr;
 }
 
@@ -228,8 +408,14 @@ int main (int argc, char* argv[])
 {
     /* Program long options */
     static const LongOpt OptTab[] = {
+        { "--batch",            1,      OptBatch                },
+        { "--coverage",         1,      OptCoverage             },
         { "--help",             0,      OptHelp                 },
         { "--cycles",           0,      OptCycles               },
+        { "--profile",          1,      OptProfile              },
+        { "--profile-labels",   1,      OptProfileLabels        },
+        { "--rom",              1,      OptRom                  },
+        { "--trace-writes",     1,      OptTraceWrites          },
         { "--verbose",          0,      OptVerbose              },
         { "--version",          0,      OptVersion              },
     };
@@ -303,13 +489,13 @@ int main (int argc, char* argv[])
 
     Reset ();
 
-    while (1) {
-        ExecuteInsn ();
-        if (MaxCycles && (GetCycles () >= MaxCycles)) {
-            ErrorCode (SIM65_ERROR_TIMEOUT, "Maximum number of cycles reached.");
-        }
+    if (BatchFile) {
+        /* Run all listed entry points, restoring the state between runs */
+        return RunBatch () == 0? EXIT_SUCCESS : EXIT_FAILURE;
     }
 
+    Run ();
+
     /* Return an apropriate exit code */
     return EXIT_SUCCESS;
 }
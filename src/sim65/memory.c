@@ -33,8 +33,10 @@
 
 
 
+#include <stdio.h>
 #include <string.h>
 
+#include "error.h"
 #include "memory.h"
 
 
@@ -46,7 +48,16 @@
 
 
 /* THE memory */
-static unsigned char Mem[0x10000];
+unsigned char Mem[0x10000];
+
+/* Attributes for each memory page, zero filled: Plain RAM by default */
+unsigned char MemAttr[0x100];
+
+/* Scratch variable used by the MemWriteByte macro */
+unsigned MemWrAddr;
+
+/* Snapshot of the memory for batch mode */
+static unsigned char SnapMem[0x10000];
 
 
 
@@ -56,27 +67,45 @@ static unsigned char Mem[0x10000];
 
 
 
-void MemWriteByte (unsigned Addr, unsigned char Val)
-/* Write a byte to a memory location */
+void MemCheckedWrite (unsigned Addr, unsigned char Val)
+/* Write a byte to a location within a page that has attributes set */
 {
+    unsigned char Attr = MemAttr[Addr >> 8];
+
+    /* Log the write if the page is traced */
+    if (Attr & MA_WTRACE) {
+        fprintf (stderr, "sim65: Write $%02X to $%04X\n", Val, Addr);
+    }
+
+    /* A write to ROM is an error */
+    if (Attr & MA_ROM) {
+        Error ("Write $%02X to ROM at $%04X", Val, Addr);
+    }
+
+    /* Do the write */
     Mem[Addr] = Val;
 }
 
 
 
-void MemWriteWord (unsigned Addr, unsigned Val)
-/* Write a word to a memory location */
+void MemSetPageAttr (unsigned Start, unsigned End, unsigned char Attr)
+/* Set the given attribute for all pages that intersect the given address
+** range.
+*/
 {
-    MemWriteByte (Addr, Val & 0xFF);
-    MemWriteByte (Addr + 1, Val >> 8);
+    unsigned Page;
+    for (Page = (Start >> 8); Page <= (End >> 8); ++Page) {
+        MemAttr[Page] |= Attr;
+    }
 }
 
 
 
-unsigned char MemReadByte (unsigned Addr)
-/* Read a byte from a memory location */
+void MemWriteWord (unsigned Addr, unsigned Val)
+/* Write a word to a memory location */
 {
-    return Mem[Addr];
+    MemWriteByte (Addr, Val & 0xFF);
+    MemWriteByte (Addr + 1, Val >> 8);
 }
 
 
@@ -102,6 +131,22 @@ unsigned MemReadZPWord (unsigned char Addr)
 
 
 
+void MemSaveSnapshot (void)
+/* Save the memory contents for later restoration */
+{
+    memcpy (SnapMem, Mem, sizeof (Mem));
+}
+
+
+
+void MemRestoreSnapshot (void)
+/* Restore the memory contents from the snapshot */
+{
+    memcpy (Mem, SnapMem, sizeof (Mem));
+}
+
+
+
 void MemInit (void)
 /* Initialize the memory subsystem */
 {
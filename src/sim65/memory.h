@@ -38,21 +38,66 @@
 
 
 
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* THE memory */
+extern unsigned char Mem[0x10000];
+
+/* Attributes for each of the 256 memory pages. The table is zero filled by
+** default, so all pages behave like plain RAM until an attribute is set.
+*/
+#define MA_ROM          0x01    /* Writes to the page are an error */
+#define MA_WTRACE       0x02    /* Writes to the page are logged */
+
+extern unsigned char MemAttr[0x100];
+
+/* Scratch variable used by the MemWriteByte macro, so that the address
+** argument is evaluated exactly once.
+*/
+extern unsigned MemWrAddr;
+
+
+
 /*****************************************************************************/
 /*                                   Code                                    */
 /*****************************************************************************/
 
 
 
-void MemWriteByte (unsigned Addr, unsigned char Val);
-/* Write a byte to a memory location */
+/* Single byte accesses are on the hot path of the CPU emulation, so they
+** are done with macros to avoid the call overhead per emulated insn. Both
+** macros evaluate their arguments exactly once.
+*/
 
-void MemWriteWord (unsigned Addr, unsigned Val);
-/* Write a word to a memory location */
+#define MemWriteByte(Addr, Val)                                 \
+    ((void) (MemWrAddr = (Addr),                                \
+             MemAttr[MemWrAddr >> 8]?                           \
+                 MemCheckedWrite (MemWrAddr, (Val)) :           \
+                 (void) (Mem[MemWrAddr] = (Val))))
+/* Write a byte to a memory location. Writes dispatch over the page
+** attribute table; for a page without attributes - the common case - the
+** cost over a plain array store is one indexed load and a predictable
+** branch.
+*/
 
-unsigned char MemReadByte (unsigned Addr);
+#define MemReadByte(Addr)       (Mem[Addr])
 /* Read a byte from a memory location */
 
+void MemCheckedWrite (unsigned Addr, unsigned char Val);
+/* Write a byte to a location within a page that has attributes set */
+
+void MemSetPageAttr (unsigned Start, unsigned End, unsigned char Attr);
+/* Set the given attribute for all pages that intersect the given address
+** range.
+*/
+
+void MemWriteWord (unsigned Addr, unsigned Val);
+/* Write a word to a memory location */
+
 unsigned MemReadWord (unsigned Addr);
 /* Read a word from a memory location */
 
@@ -62,6 +107,12 @@ unsigned MemReadZPWord (unsigned char Addr);
 ** overflow.
 */
 
+void MemSaveSnapshot (void);
+/* Save the memory contents for later restoration */
+
+void MemRestoreSnapshot (void);
+/* Restore the memory contents from the snapshot */
+
 void MemInit (void);
 /* Initialize the memory subsystem */
 
@@ -7,7 +7,7 @@
 /*                                                                           */
 /*                                                                           */
 /* (C) 2013-2013 Ullrich von Bassewitz                                       */
-/*               R�merstrasse 52                                             */
+/*               R�merstrasse 52                                             */
 /*               D-70794 Filderstadt                                         */
 /* EMail:        uz@cc65.org                                                 */
 /*                                                                           */
@@ -59,10 +59,10 @@
 /* common */
 #include "cmdline.h"
 #include "print.h"
-#include "xmalloc.h"
 
 /* sim65 */
 #include "6502.h"
+#include "error.h"
 #include "memory.h"
 #include "paravirt.h"
 
@@ -126,8 +126,14 @@ static void PVExit (CPURegs* Regs)
     if (PrintCycles) {
         Print (stdout, 0, "%lu cycles\n", GetCycles ());
     }
+    if (ProfileName) {
+        WriteProfile ();
+    }
+    if (CoverageName) {
+        WriteCoverage ();
+    }
 
-    exit (Regs->AC);
+    SimExit (Regs->AC);
 }
 
 
@@ -244,8 +250,7 @@ static void PVClose (CPURegs* Regs)
 
 static void PVRead (CPURegs* Regs)
 {
-    unsigned char* Data;
-    unsigned RetVal, I = 0;
+    unsigned RetVal;
 
     unsigned Count = GetAX (Regs);
     unsigned Buf   = PopParam (2);
@@ -253,16 +258,15 @@ static void PVRead (CPURegs* Regs)
 
     Print (stderr, 2, "PVRead ($%04X, $%04X, $%04X)\n", FD, Buf, Count);
 
-    Data = xmalloc (Count);
-
-    RetVal = read (FD, Data, Count);
-
-    if (RetVal != (unsigned) -1) {
-        while (I < RetVal) {
-            MemWriteByte (Buf++, Data[I++]);
-        }
+    /* Transfer the data directly into the memory array, but don't run past
+    ** the end of the simulated memory.
+    */
+    Buf &= 0xFFFF;
+    if (Count > 0x10000 - Buf) {
+        Count = 0x10000 - Buf;
     }
-    xfree (Data);
+
+    RetVal = read (FD, Mem + Buf, Count);
 
     SetAX (Regs, RetVal);
 }
@@ -271,8 +275,7 @@ static void PVRead (CPURegs* Regs)
 
 static void PVWrite (CPURegs* Regs)
 {
-    unsigned char* Data;
-    unsigned RetVal, I = 0;
+    unsigned RetVal;
 
     unsigned Count = GetAX (Regs);
     unsigned Buf   = PopParam (2);
@@ -280,14 +283,15 @@ static void PVWrite (CPURegs* Regs)
 
     Print (stderr, 2, "PVWrite ($%04X, $%04X, $%04X)\n", FD, Buf, Count);
 
-    Data = xmalloc (Count);
-    while (I < Count) {
-        Data[I++] = MemReadByte (Buf++);
+    /* Transfer the data directly from the memory array, but don't run past
+    ** the end of the simulated memory.
+    */
+    Buf &= 0xFFFF;
+    if (Count > 0x10000 - Buf) {
+        Count = 0x10000 - Buf;
     }
 
-    RetVal = write (FD, Data, Count);
-
-    xfree (Data);
+    RetVal = write (FD, Mem + Buf, Count);
 
     SetAX (Regs, RetVal);
 }
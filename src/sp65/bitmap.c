@@ -175,3 +175,18 @@ Pixel GetPixel (const Bitmap* B, unsigned X, unsigned Y)
     /* Return the pixel */
     return B->Data[Y * B->Width + X];
 }
+
+
+
+const Pixel* GetBitmapRow (const Bitmap* B, unsigned Y)
+/* Return a pointer to the pixels of one bitmap row. Converters that walk
+** the bitmap in row order should use this and plain pointer arithmetic
+** instead of calling GetPixel once per pixel.
+*/
+{
+    /* Check the coordinate */
+    PRECONDITION (Y < B->Height);
+
+    /* Return the row */
+    return B->Data + Y * B->Width;
+}
@@ -117,6 +117,12 @@ Pixel GetPixel (const Bitmap* B, unsigned X, unsigned Y);
 ** or a palette index, depending on the type of the bitmap.
 */
 
+const Pixel* GetBitmapRow (const Bitmap* B, unsigned Y);
+/* Return a pointer to the pixels of one bitmap row. Converters that walk
+** the bitmap in row order should use this and plain pointer arithmetic
+** instead of calling GetPixel once per pixel.
+*/
+
 #if defined(HAVE_INLINE)
 INLINE int BitmapIsIndexed (const Bitmap* B)
 /* Return true if this is an indexed bitmap */
@@ -438,12 +438,13 @@ StrBuf* GenLynxSprite (const Bitmap* B, const Collection* A)
         signed i = 0;
         signed LastOpaquePixel = -1;
         char LineBuffer[512]; /* The maximum size is 508 pixels */
+        const Pixel* P = GetBitmapRow (B, Y);
 
         /* Fill the LineBuffer for easier optimisation */
         for (X = OX; X < (signed)GetBitmapWidth (B); ++X) {
 
             /* Fetch next bit into byte buffer */
-            LineBuffer[i] = GetPixel (B, X, Y).Index & ColorMask;
+            LineBuffer[i] = P[X].Index & ColorMask;
 
             if (LineBuffer[i] != EdgeIndex) {
                 LastOpaquePixel = i;
@@ -472,12 +473,13 @@ StrBuf* GenLynxSprite (const Bitmap* B, const Collection* A)
         signed i = 0;
         signed LastOpaquePixel = -1;
         char LineBuffer[512]; /* The maximum size is 508 pixels */
+        const Pixel* P = GetBitmapRow (B, Y);
 
         /* Fill the LineBuffer for easier optimisation */
         for (X = OX; X < (signed)GetBitmapWidth (B); ++X) {
 
             /* Fetch next bit into byte buffer */
-            LineBuffer[i] = GetPixel (B, X, Y).Index & ColorMask;
+            LineBuffer[i] = P[X].Index & ColorMask;
 
             if (LineBuffer[i] != EdgeIndex) {
                 LastOpaquePixel = i;
@@ -506,12 +508,13 @@ StrBuf* GenLynxSprite (const Bitmap* B, const Collection* A)
         signed i = 0;
         signed LastOpaquePixel = -1;
         char LineBuffer[512]; /* The maximum size is 508 pixels */
+        const Pixel* P = GetBitmapRow (B, Y);
 
         /* Fill the LineBuffer for easier optimisation */
         for (X = OX - 1; X >= 0; --X) {
 
             /* Fetch next bit into byte buffer */
-            LineBuffer[i] = GetPixel (B, X, Y).Index & ColorMask;
+            LineBuffer[i] = P[X].Index & ColorMask;
 
             if (LineBuffer[i] != EdgeIndex) {
                 LastOpaquePixel = i;
@@ -530,12 +533,13 @@ StrBuf* GenLynxSprite (const Bitmap* B, const Collection* A)
         signed i = 0;
         signed LastOpaquePixel = -1;
         char LineBuffer[512]; /* The maximum size is 508 pixels */
+        const Pixel* P = GetBitmapRow (B, Y);
 
         /* Fill the LineBuffer for easier optimisation */
         for (X = OX - 1; X >= 0; --X) {
 
             /* Fetch next bit into byte buffer */
-            LineBuffer[i] = GetPixel (B, X, Y).Index & ColorMask;
+            LineBuffer[i] = P[X].Index & ColorMask;
 
             if (LineBuffer[i] != EdgeIndex) {
                 LastOpaquePixel = i;
@@ -50,6 +50,7 @@
 #include "error.h"
 #include "input.h"
 #include "output.h"
+#include "quantize.h"
 
 
 
@@ -91,11 +92,13 @@ static void Usage (void)
             "  -w file[,attrlist]\t\tWrite the output to a file\n"
             "\n"
             "Long options:\n"
+            "  --batch file\t\t\tProcess options from a batch file\n"
             "  --convert-to fmt[,attrlist]\tConvert into target format\n"
             "  --dump-palette\t\tDump palette as table\n"
             "  --help\t\t\tHelp (this text)\n"
             "  --list-conversions\t\tList all possible conversions\n"
             "  --pop\t\t\t\tRestore the original loaded image\n"
+            "  --quantize n\t\t\tQuantize the bitmap to n colors\n"
             "  --read file[,attrlist]\tRead an input file\n"
             "  --slice x,y,w,h\t\tGenerate a slice from the loaded bitmap\n"
             "  --verbose\t\t\tIncrease verbosity\n"
@@ -138,6 +141,85 @@ static void SetOutputData (StrBuf* N)
 
 
 
+static void ProcessArgs (void);
+/* Process the arguments in ArgVec, dispatching the options found */
+
+
+
+static void OptBatch (const char* Opt attribute ((unused)), const char* Arg)
+/* Process a batch file with one set of options per line */
+{
+    static int InBatch = 0;
+
+    char        Line[1024];
+    unsigned    LineNum;
+    FILE*       F;
+
+    /* Nested batch files are most probably an error, so refuse them */
+    if (InBatch) {
+        Error ("Nested batch files are not allowed");
+    }
+    InBatch = 1;
+
+    /* Open the batch file */
+    F = fopen (Arg, "r");
+    if (F == 0) {
+        Error ("Cannot open batch file '%s': %s", Arg, strerror (errno));
+    }
+
+    /* Process the file line by line. Each line contains options just as
+    ** they would appear on the command line, and is processed with the
+    ** normal option handlers. The bitmap and conversion state carries over
+    ** from one line to the next as it does between command line options.
+    */
+    LineNum = 0;
+    while (fgets (Line, sizeof (Line), F) != 0) {
+
+        char*       Argv[65];
+        unsigned    Argc;
+        char*       T;
+
+        char**      SavedArgVec   = ArgVec;
+        unsigned    SavedArgCount = ArgCount;
+
+        /* Count the line */
+        ++LineNum;
+
+        /* Split the line into whitespace separated tokens. The first entry
+        ** is a dummy program name as on the real command line.
+        */
+        Argv[0] = "sp65";
+        Argc    = 1;
+        T = strtok (Line, " \t\r\n");
+        while (T != 0) {
+            if (Argc >= sizeof (Argv) / sizeof (Argv[0]) - 1) {
+                Error ("%s(%u): Too many arguments", Arg, LineNum);
+            }
+            Argv[Argc++] = T;
+            T = strtok (0, " \t\r\n");
+        }
+        Argv[Argc] = 0;
+
+        /* Skip empty lines and comments */
+        if (Argc == 1 || Argv[1][0] == '#') {
+            continue;
+        }
+
+        /* Let the normal option processing handle the line */
+        ArgVec   = Argv;
+        ArgCount = Argc;
+        ProcessArgs ();
+        ArgVec   = SavedArgVec;
+        ArgCount = SavedArgCount;
+    }
+
+    /* Close the batch file */
+    fclose (F);
+    InBatch = 0;
+}
+
+
+
 static void OptConvertTo (const char* Opt attribute ((unused)), const char* Arg)
 /* Convert the bitmap into a target format */
 {
@@ -217,6 +299,28 @@ static void OptPop (const char* Opt attribute ((unused)),
 
 
 
+static void OptQuantize (const char* Opt attribute ((unused)), const char* Arg)
+/* Quantize the working copy to the given number of colors */
+{
+    unsigned Colors;
+    char T;
+
+    /* We must have a bitmap otherwise we cannot quantize */
+    if (C == 0) {
+        Error ("Nothing to quantize");
+    }
+
+    /* The argument is the number of colors */
+    if (sscanf (Arg, "%u%c", &Colors, &T) != 1) {
+        Error ("Invalid argument. Quantize needs a number of colors");
+    }
+
+    /* Quantize the bitmap and use the result as the new working copy */
+    SetWorkBitmap (QuantizeBitmap (C, Colors));
+}
+
+
+
 static void OptRead (const char* Opt attribute ((unused)), const char* Arg)
 /* Read an input file */
 {
@@ -316,16 +420,18 @@ static void OptWrite (const char* Opt attribute ((unused)), const char* Arg)
 
 
 
-int main (int argc, char* argv [])
-/* sp65 main program */
+static void ProcessArgs (void)
+/* Process the arguments in ArgVec, dispatching the options found */
 {
     /* Program long options */
     static const LongOpt OptTab[] = {
+        { "--batch",            1,      OptBatch                },
         { "--convert-to",       1,      OptConvertTo            },
         { "--dump-palette",     0,      OptDumpPalette          },
         { "--help",             0,      OptHelp                 },
         { "--list-conversions", 0,      OptListConversions      },
         { "--pop",              0,      OptPop                  },
+        { "--quantize",         1,      OptQuantize             },
         { "--read",             1,      OptRead                 },
         { "--slice",            1,      OptSlice                },
         { "--verbose",          0,      OptVerbose              },
@@ -335,9 +441,6 @@ int main (int argc, char* argv [])
 
     unsigned I;
 
-    /* Initialize the cmdline module */
-    InitCmdLine (&argc, &argv, "sp65");
-
     /* Check the parameters */
     I = 1;
     while (I < ArgCount) {
@@ -398,12 +501,24 @@ int main (int argc, char* argv [])
         /* Next argument */
         ++I;
     }
+}
+
 
-    /* Do we have an input file? */
-    if (I == 1) {
+
+int main (int argc, char* argv [])
+/* sp65 main program */
+{
+    /* Initialize the cmdline module */
+    InitCmdLine (&argc, &argv, "sp65");
+
+    /* Do we have any arguments? */
+    if (ArgCount < 2) {
         Error ("No input file");
     }
 
+    /* Process the command line options */
+    ProcessArgs ();
+
     /* Cleanup data */
     SetWorkBitmap (C);
     FreeBitmap (B);
@@ -44,7 +44,6 @@
 /* sp65 */
 #include "attr.h"
 #include "error.h"
-#include "fileio.h"
 #include "pcx.h"
 
 
@@ -114,17 +113,12 @@ static void FreePCXHeader (PCXHeader* H)
 
 
 
-static PCXHeader* ReadPCXHeader (FILE* F, const char* Name)
-/* Read a structured PCX header from the given file and return it */
+static PCXHeader* ReadPCXHeader (const unsigned char* H, const char* Name)
+/* Read a structured PCX header from the given raw header and return it */
 {
-    RawPCXHeader H;
-
     /* Allocate a new PCXHeader structure */
     PCXHeader* P = NewPCXHeader ();
 
-    /* Read the raw header */
-    ReadData (F, H, sizeof (H));
-
     /* Convert the data into structured form */
     P->Id               = H[0];
     P->FileVersion      = H[1];
@@ -201,24 +195,36 @@ static void DumpPCXHeader (const PCXHeader* P, const char* Name)
 
 
 
-static void ReadPlane (FILE* F, PCXHeader* P, unsigned char* L)
-/* Read one (possibly compressed) plane from the file */
+static void ReadPlane (const unsigned char** D, const unsigned char* End,
+                       const PCXHeader* P, unsigned char* L, const char* Name)
+/* Decode one (possibly compressed) plane from the file data at *D, which
+** ends at End. *D is advanced behind the consumed data.
+*/
 {
+    const unsigned char* Data = *D;
+
     if (P->Compressed) {
 
         /* Uncompress RLE data */
         unsigned Remaining = P->Width;
         while (Remaining) {
 
+            unsigned char B;
             unsigned char C;
 
-            /* Read the next byte */
-            unsigned char B = Read8 (F);
+            /* Get the next byte */
+            if (Data >= End) {
+                Error ("Unexpected end of PCX file '%s'", Name);
+            }
+            B = *Data++;
 
             /* Check for a run length */
             if ((B & 0xC0) == 0xC0) {
                 C = (B & 0x3F);         /* Count */
-                B = Read8 (F);          /* Value */
+                if (Data >= End) {
+                    Error ("Unexpected end of PCX file '%s'", Name);
+                }
+                B = *Data++;            /* Value */
             } else {
                 C = 1;
             }
@@ -236,10 +242,17 @@ static void ReadPlane (FILE* F, PCXHeader* P, unsigned char* L)
         }
     } else {
 
-        /* Just read one line */
-        ReadData (F, L, P->Width);
+        /* Just copy one line */
+        if ((unsigned long) (End - Data) < P->Width) {
+            Error ("Unexpected end of PCX file '%s'", Name);
+        }
+        memcpy (L, Data, P->Width);
+        Data += P->Width;
 
     }
+
+    /* Update the caller's pointer */
+    *D = Data;
 }
 
 
@@ -253,7 +266,11 @@ Bitmap* ReadPCXFile (const Collection* A)
     Pixel* Px;
     unsigned MaxIdx = 0;
     unsigned X, Y;
-
+    unsigned char* Buf;
+    const unsigned char* Data;
+    const unsigned char* End;
+    unsigned long Size;
+    long FSize;
 
     /* Get the file name */
     const char* Name = NeedAttrVal (A, "name", "read pcx file");
@@ -264,8 +281,32 @@ Bitmap* ReadPCXFile (const Collection* A)
         Error ("Cannot open PCX file '%s': %s", Name, strerror (errno));
     }
 
+    /* Determine the size of the file and read it into memory with one large
+    ** read. The decoder then works on the memory buffer, which avoids one
+    ** library call per decoded byte.
+    */
+    if (fseek (F, 0, SEEK_END) != 0 || (FSize = ftell (F)) < 0) {
+        Error ("Cannot seek in PCX file '%s': %s", Name, strerror (errno));
+    }
+    Size = (unsigned long) FSize;
+    if (Size < sizeof (RawPCXHeader)) {
+        Error ("'%s' is not a PCX file", Name);
+    }
+    rewind (F);
+    Buf = xmalloc (Size);
+    if (fread (Buf, 1, Size, F) != Size) {
+        Error ("Error reading PCX file '%s'", Name);
+    }
+
+    /* Close the file, all data is in memory now */
+    fclose (F);
+
     /* Read the PCX header */
-    P = ReadPCXHeader (F, Name);
+    P = ReadPCXHeader (Buf, Name);
+
+    /* The pixel data follows the header */
+    Data = Buf + sizeof (RawPCXHeader);
+    End  = Buf + Size;
 
     /* Dump the header if requested */
     if (Verbosity > 0) {
@@ -294,7 +335,7 @@ Bitmap* ReadPCXFile (const Collection* A)
                 unsigned char Mask;
 
                 /* Read the plane */
-                ReadPlane (F, P, L);
+                ReadPlane (&Data, End, P, L, Name);
 
                 /* Create pixels */
                 for (X = 0, I = 0, Mask = 0x01; X < P->Width; ++Px) {
@@ -313,7 +354,7 @@ Bitmap* ReadPCXFile (const Collection* A)
             for (Y = 0, Px = B->Data; Y < P->Height; ++Y) {
 
                 /* Read the plane */
-                ReadPlane (F, P, L);
+                ReadPlane (&Data, End, P, L, Name);
 
                 /* Create pixels */
                 for (X = 0; X < P->Width; ++X, ++Px) {
@@ -335,35 +376,26 @@ Bitmap* ReadPCXFile (const Collection* A)
 
         } else {
 
-            unsigned      Count;
-            unsigned      I;
-            unsigned char Palette[256][3];
-            unsigned long EndPos;
-
-            /* Determine the current file position */
-            unsigned long CurPos = FileGetPos (F);
+            unsigned             Count;
+            unsigned             I;
+            const unsigned char* Palette;
 
-            /* Seek to the end of the file */
-            (void) fseek (F, 0, SEEK_END);
+            /* Get the number of bytes remaining behind the pixel data */
+            unsigned long Remaining = End - Data;
 
-            /* Get this position */
-            EndPos = FileGetPos (F);
-
-            /* There's a palette if the old location is 769 bytes from the end */
-            if (EndPos - CurPos == sizeof (Palette) + 1) {
-
-                /* Seek back */
-                FileSetPos (F, CurPos);
+            /* There's a palette if 769 bytes follow the pixel data */
+            if (Remaining == 256 * 3 + 1) {
 
                 /* Check for palette marker */
-                if (Read8 (F) != 0x0C) {
+                if (*Data != 0x0C) {
                     Error ("Invalid palette marker in PCX file '%s'", Name);
                 }
+                Palette = Data + 1;
 
-            } else if (EndPos == CurPos) {
+            } else if (Remaining == 0) {
 
                 /* The palette is in the header */
-                FileSetPos (F, 16);
+                Palette = Buf + 16;
 
                 /* Check the maximum index for safety */
                 if (MaxIdx > 15) {
@@ -373,19 +405,18 @@ Bitmap* ReadPCXFile (const Collection* A)
 
             } else {
                 Error ("Error in PCX file '%s': %lu bytes at end of pixel data",
-                       Name, EndPos - CurPos);
+                       Name, Remaining);
             }
 
-            /* Read the palette. We will just read what we need. */
+            /* Create the palette from the data. We will just use what we
+            ** need.
+            */
             Count = MaxIdx + 1;
-            ReadData (F, Palette, Count * sizeof (Palette[0]));
-
-            /* Create the palette from the data */
             B->Pal = NewPalette (Count);
             for (I = 0; I < Count; ++I) {
-                B->Pal->Entries[I].R = Palette[I][0];
-                B->Pal->Entries[I].G = Palette[I][1];
-                B->Pal->Entries[I].B = Palette[I][2];
+                B->Pal->Entries[I].R = Palette[I * 3 + 0];
+                B->Pal->Entries[I].G = Palette[I * 3 + 1];
+                B->Pal->Entries[I].B = Palette[I * 3 + 2];
                 B->Pal->Entries[I].A = 0;
             }
 
@@ -397,26 +428,26 @@ Bitmap* ReadPCXFile (const Collection* A)
         for (Y = 0, Px = B->Data; Y < P->Height; ++Y) {
 
             /* Read the R plane and move the data */
-            ReadPlane (F, P, L);
+            ReadPlane (&Data, End, P, L, Name);
             for (X = 0; X < P->Width; ++X, ++Px) {
                 Px->C.R = L[X];
             }
 
             /* Read the G plane and move the data */
-            ReadPlane (F, P, L);
+            ReadPlane (&Data, End, P, L, Name);
             for (X = 0; X < P->Width; ++X, ++Px) {
                 Px->C.G = L[X];
             }
 
             /* Read the B plane and move the data */
-            ReadPlane (F, P, L);
+            ReadPlane (&Data, End, P, L, Name);
             for (X = 0; X < P->Width; ++X, ++Px) {
                 Px->C.B = L[X];
             }
 
             /* Either read the A plane or clear it */
             if (P->Planes == 4) {
-                ReadPlane (F, P, L);
+                ReadPlane (&Data, End, P, L, Name);
                 for (X = 0; X < P->Width; ++X, ++Px) {
                     Px->C.A = L[X];
                 }
@@ -428,11 +459,9 @@ Bitmap* ReadPCXFile (const Collection* A)
         }
     }
 
-    /* Close the file */
-    fclose (F);
-
-    /* Free memory for the scan line */
+    /* Free memory for the scan line and the file data */
     xfree (L);
+    xfree (Buf);
 
     /* Free the PCX header */
     FreePCXHeader (P);
@@ -0,0 +1,308 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                quantize.c                                 */
+/*                                                                           */
+/*          Color quantization for the sp65 sprite and bitmap utility        */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#include <stdlib.h>
+#include <string.h>
+
+/* common */
+#include "xmalloc.h"
+
+/* sp65 */
+#include "error.h"
+#include "quantize.h"
+
+
+
+/*****************************************************************************/
+/*                                   Data                                    */
+/*****************************************************************************/
+
+
+
+/* The quantizer works on colors reduced to 5 bits per channel, so the
+** histogram is a small contiguous array instead of a hashed structure.
+*/
+#define HIST_SIZE       32768U          /* 2^15 entries */
+
+/* One used histogram entry: Packed 5:5:5 color plus pixel count */
+typedef struct QuantEntry QuantEntry;
+struct QuantEntry {
+    unsigned short      C;              /* Packed color */
+    unsigned long       N;              /* Number of pixels */
+};
+
+/* A box for the median cut algorithm. It covers a contiguous range of
+** entries in the entry array.
+*/
+typedef struct QuantBox QuantBox;
+struct QuantBox {
+    unsigned            Start;          /* First entry */
+    unsigned            Count;          /* Number of entries */
+};
+
+/* Channel shift used by the compare function for qsort */
+static unsigned QuantShift;
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+static unsigned PackColor (Color C)
+/* Pack a color into 5:5:5 format */
+{
+    return ((C.R >> 3) << 10) | ((C.G >> 3) << 5) | (C.B >> 3);
+}
+
+
+
+static unsigned char ExpandChannel (unsigned V)
+/* Expand a 5 bit channel value to 8 bits */
+{
+    return (unsigned char) ((V << 3) | (V >> 2));
+}
+
+
+
+static Color PixelColor (const Bitmap* B, Pixel P)
+/* Get the color of a pixel, resolving palette indices */
+{
+    const Palette* Pal = GetBitmapPalette (B);
+    if (Pal != 0) {
+        if (P.Index >= Pal->Count) {
+            Error ("Invalid palette index %u in bitmap '%*s'",
+                   P.Index,
+                   SB_GetLen (GetBitmapName (B)),
+                   SB_GetConstBuf (GetBitmapName (B)));
+        }
+        return Pal->Entries[P.Index];
+    } else {
+        return P.C;
+    }
+}
+
+
+
+static int CmpChannel (const void* E1, const void* E2)
+/* Compare two histogram entries by the channel given in QuantShift */
+{
+    unsigned V1 = (((const QuantEntry*) E1)->C >> QuantShift) & 0x1F;
+    unsigned V2 = (((const QuantEntry*) E2)->C >> QuantShift) & 0x1F;
+    return (int) V1 - (int) V2;
+}
+
+
+
+static int SplitBox (QuantBox* Boxes, unsigned NumBoxes, QuantEntry* E)
+/* Split the heaviest splittable box into two. Boxes must have room for one
+** more entry. Returns true if a box was split, false if no box is
+** splittable.
+*/
+{
+    unsigned long   BestWeight = 0;
+    QuantBox*       Best = 0;
+    QuantBox*       New;
+    unsigned        Min[3], Max[3];
+    unsigned        I, Chan, Range;
+    unsigned long   Weight, Half;
+
+    /* Search for the box with the most pixels that has more than one
+    ** distinct color and can therefore be split.
+    */
+    for (I = 0; I < NumBoxes; ++I) {
+        QuantBox* B = Boxes + I;
+        if (B->Count > 1) {
+            unsigned J;
+            Weight = 0;
+            for (J = 0; J < B->Count; ++J) {
+                Weight += E[B->Start + J].N;
+            }
+            if (Best == 0 || Weight > BestWeight) {
+                Best = B;
+                BestWeight = Weight;
+            }
+        }
+    }
+    if (Best == 0) {
+        /* Nothing to split */
+        return 0;
+    }
+
+    /* Determine the channel with the largest range within the box */
+    for (Chan = 0; Chan < 3; ++Chan) {
+        Min[Chan] = 0x1F;
+        Max[Chan] = 0;
+    }
+    for (I = 0; I < Best->Count; ++I) {
+        for (Chan = 0; Chan < 3; ++Chan) {
+            unsigned V = (E[Best->Start + I].C >> (Chan * 5)) & 0x1F;
+            if (V < Min[Chan]) {
+                Min[Chan] = V;
+            }
+            if (V > Max[Chan]) {
+                Max[Chan] = V;
+            }
+        }
+    }
+    QuantShift = 0;
+    Range = 0;
+    for (Chan = 0; Chan < 3; ++Chan) {
+        if (Max[Chan] - Min[Chan] >= Range) {
+            Range = Max[Chan] - Min[Chan];
+            QuantShift = Chan * 5;
+        }
+    }
+
+    /* Sort the entries of the box by this channel */
+    qsort (E + Best->Start, Best->Count, sizeof (*E), CmpChannel);
+
+    /* Split at the median pixel count, making sure that both halves get at
+    ** least one entry.
+    */
+    Half = 0;
+    I = 0;
+    while (I < Best->Count - 1) {
+        Half += E[Best->Start + I].N;
+        ++I;
+        if (Half * 2 >= BestWeight) {
+            break;
+        }
+    }
+
+    /* Create the new box from the upper half */
+    New = Boxes + NumBoxes;
+    New->Start  = Best->Start + I;
+    New->Count  = Best->Count - I;
+    Best->Count = I;
+
+    /* Done, one more box */
+    return 1;
+}
+
+
+
+Bitmap* QuantizeBitmap (const Bitmap* B, unsigned Colors)
+/* Quantize the colors of the given bitmap to the given number of colors and
+** return the result as a new, indexed bitmap. Colors must be in the range
+** 2..256. The quantizer uses median cut over a 15 bit color histogram, so
+** color resolution is reduced to 5 bits per channel in the process.
+*/
+{
+    unsigned long*  Hist;
+    QuantEntry*     E;
+    QuantBox*       Boxes;
+    unsigned char*  Lut;
+    unsigned        Used, NumBoxes;
+    unsigned        Width  = GetBitmapWidth (B);
+    unsigned        Height = GetBitmapHeight (B);
+    unsigned        X, Y, I;
+    Bitmap*         N;
+
+    /* Check the parameter */
+    if (Colors < 2 || Colors > 256) {
+        Error ("Invalid number of colors for quantization: %u", Colors);
+    }
+
+    /* Build the color histogram */
+    Hist = xmalloc (HIST_SIZE * sizeof (*Hist));
+    memset (Hist, 0, HIST_SIZE * sizeof (*Hist));
+    for (Y = 0; Y < Height; ++Y) {
+        const Pixel* P = GetBitmapRow (B, Y);
+        for (X = 0; X < Width; ++X) {
+            ++Hist[PackColor (PixelColor (B, P[X]))];
+        }
+    }
+
+    /* Collect the used colors into the entry array */
+    E = xmalloc (HIST_SIZE * sizeof (*E));
+    Used = 0;
+    for (I = 0; I < HIST_SIZE; ++I) {
+        if (Hist[I] != 0) {
+            E[Used].C = (unsigned short) I;
+            E[Used].N = Hist[I];
+            ++Used;
+        }
+    }
+    xfree (Hist);
+
+    /* Split boxes by median cut until we have the requested number of
+    ** colors or no box can be split any more.
+    */
+    Boxes = xmalloc (Colors * sizeof (*Boxes));
+    Boxes[0].Start = 0;
+    Boxes[0].Count = Used;
+    NumBoxes = 1;
+    while (NumBoxes < Colors && SplitBox (Boxes, NumBoxes, E)) {
+        ++NumBoxes;
+    }
+
+    /* Build the new bitmap with a palette holding the weighted average
+    ** color of each box, and a lookup table mapping each used color to its
+    ** palette index.
+    */
+    N = NewBitmap (Width, Height);
+    SB_Copy (&N->Name, GetBitmapName (B));
+    N->Pal = NewPalette (NumBoxes);
+    Lut = xmalloc (HIST_SIZE * sizeof (*Lut));
+    for (I = 0; I < NumBoxes; ++I) {
+        unsigned long R = 0, G = 0, Bl = 0, W = 0;
+        unsigned J;
+        for (J = 0; J < Boxes[I].Count; ++J) {
+            const QuantEntry* Q = E + Boxes[I].Start + J;
+            R  += (unsigned long) ExpandChannel ((Q->C >> 10) & 0x1F) * Q->N;
+            G  += (unsigned long) ExpandChannel ((Q->C >>  5) & 0x1F) * Q->N;
+            Bl += (unsigned long) ExpandChannel (Q->C & 0x1F) * Q->N;
+            W  += Q->N;
+            Lut[Q->C] = (unsigned char) I;
+        }
+        N->Pal->Entries[I] = RGB ((unsigned char) (R / W),
+                                  (unsigned char) (G / W),
+                                  (unsigned char) (Bl / W));
+    }
+
+    /* Remap the pixels */
+    for (Y = 0; Y < Height; ++Y) {
+        const Pixel* P = GetBitmapRow (B, Y);
+        Pixel* O = N->Data + (unsigned long) Y * Width;
+        for (X = 0; X < Width; ++X) {
+            O[X].Index = Lut[PackColor (PixelColor (B, P[X]))];
+        }
+    }
+
+    /* Cleanup */
+    xfree (Lut);
+    xfree (Boxes);
+    xfree (E);
+
+    /* Return the new bitmap */
+    return N;
+}
@@ -0,0 +1,57 @@
+/*****************************************************************************/
+/*                                                                           */
+/*                                quantize.h                                 */
+/*                                                                           */
+/*          Color quantization for the sp65 sprite and bitmap utility        */
+/*                                                                           */
+/*                                                                           */
+/*                                                                           */
+/* This software is provided 'as-is', without any expressed or implied       */
+/* warranty.  In no event will the authors be held liable for any damages    */
+/* arising from the use of this software.                                    */
+/*                                                                           */
+/* Permission is granted to anyone to use this software for any purpose,     */
+/* including commercial applications, and to alter it and redistribute it    */
+/* freely, subject to the following restrictions:                            */
+/*                                                                           */
+/* 1. The origin of this software must not be misrepresented; you must not   */
+/*    claim that you wrote the original software. If you use this software   */
+/*    in a product, an acknowledgment in the product documentation would be  */
+/*    appreciated but is not required.                                       */
+/* 2. Altered source versions must be plainly marked as such, and must not   */
+/*    be misrepresented as being the original software.                      */
+/* 3. This notice may not be removed or altered from any source              */
+/*    distribution.                                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+
+
+#ifndef QUANTIZE_H
+#define QUANTIZE_H
+
+
+
+/* sp65 */
+#include "bitmap.h"
+
+
+
+/*****************************************************************************/
+/*                                   Code                                    */
+/*****************************************************************************/
+
+
+
+Bitmap* QuantizeBitmap (const Bitmap* B, unsigned Colors);
+/* Quantize the colors of the given bitmap to the given number of colors and
+** return the result as a new, indexed bitmap. Colors must be in the range
+** 2..256. The quantizer uses median cut over a 15 bit color histogram, so
+** color resolution is reduced to 5 bits per channel in the process.
+*/
+
+
+
+/* End of quantize.h */
+
+#endif
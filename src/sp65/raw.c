@@ -75,9 +75,10 @@ StrBuf* GenRaw (const Bitmap* B, const Collection* A attribute ((unused)))
 
     /* Convert the image */
     for (Y = 0; Y < GetBitmapHeight (B); ++Y) {
+        const Pixel* P = GetBitmapRow (B, Y);
         for (X = 0; X < GetBitmapWidth (B); ++X) {
             /* Place one pixel into the buffer */
-            SB_AppendChar (D, (unsigned char) GetPixel (B, X, Y).Index);
+            SB_AppendChar (D, (unsigned char) P[X].Index);
         }
     }
 
@@ -0,0 +1,25 @@
+/* Cycle benchmark for the 32 bit left shift (tosasleax) */
+
+#include "bench.h"
+
+static volatile long A[BENCH_VALS] = {
+    1L, 300L, 70000L, -5L, 123456L, -2000000L, 255L, -1L
+};
+static volatile unsigned char S[BENCH_VALS] = {
+    1, 2, 3, 8, 15, 16, 24, 31
+};
+
+volatile long Res;
+
+int main (void)
+{
+    unsigned I, J;
+
+    BENCH_ANNOUNCE ("tosasleax");
+    for (I = 0; I < BENCH_ITER; ++I) {
+        for (J = 0; J < BENCH_VALS; ++J) {
+            Res = BENCH_OP (A[J], <<, S[J]);
+        }
+    }
+    return 0;
+}
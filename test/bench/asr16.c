@@ -0,0 +1,25 @@
+/* Cycle benchmark for the 16 bit arithmetic right shift (asraxy) */
+
+#include "bench.h"
+
+static volatile int A[BENCH_VALS] = {
+    1, 3, 100, -5, 1234, -20000, 255, -1
+};
+static volatile unsigned char S[BENCH_VALS] = {
+    1, 2, 3, 4, 7, 8, 12, 15
+};
+
+volatile int Res;
+
+int main (void)
+{
+    unsigned I, J;
+
+    BENCH_ANNOUNCE ("asraxy");
+    for (I = 0; I < BENCH_ITER; ++I) {
+        for (J = 0; J < BENCH_VALS; ++J) {
+            Res = BENCH_OP (A[J], >>, S[J]);
+        }
+    }
+    return 0;
+}
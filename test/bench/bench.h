@@ -0,0 +1,37 @@
+/*
+** Common definitions for the runtime cycle benchmarks.
+**
+** Each benchmark is built twice: Once performing the operation under test
+** and once, with BENCH_BASELINE defined, performing only the operand
+** accesses. The difference of the two sim65 cycle counts divided by the
+** number of operations is the cost of the runtime routine including the
+** call overhead. The operands live in volatile arrays, so both variants
+** execute the same loads and the operation cannot be constant folded.
+*/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+
+/* Number of walks over the operand table */
+#define BENCH_ITER      64U
+
+/* Number of operands in the table */
+#define BENCH_VALS      8U
+
+#ifdef BENCH_BASELINE
+#  define BENCH_OP(a,op,b)      ((a), (b))
+#else
+#  define BENCH_OP(a,op,b)      ((a) op (b))
+#endif
+
+/* Announce the routine name and the total operation count. The harness
+** reads this line together with the cycle count printed by sim65 -c.
+*/
+#define BENCH_ANNOUNCE(name) \
+    printf ("%s %u\n", (name), (unsigned) (BENCH_ITER * BENCH_VALS))
+
+/* End of bench.h */
+
+#endif
@@ -0,0 +1,25 @@
+/* Cycle benchmark for the 16 bit signed multiplication (tosmulax) */
+
+#include "bench.h"
+
+static volatile int A[BENCH_VALS] = {
+    2, 3, 100, -5, 1234, -20000, 255, -1
+};
+static volatile int B[BENCH_VALS] = {
+    7, -3, 250, 40, -2, 127, 1000, -32767
+};
+
+volatile int Res;
+
+int main (void)
+{
+    unsigned I, J;
+
+    BENCH_ANNOUNCE ("tosmulax");
+    for (I = 0; I < BENCH_ITER; ++I) {
+        for (J = 0; J < BENCH_VALS; ++J) {
+            Res = BENCH_OP (A[J], *, B[J]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,25 @@
+/* Cycle benchmark for the 32 bit multiplication (tosmuleax) */
+
+#include "bench.h"
+
+static volatile long A[BENCH_VALS] = {
+    2L, 300L, 70000L, -5L, 123456L, -2000000L, 255L, -1L
+};
+static volatile long B[BENCH_VALS] = {
+    7L, -3L, 250L, 400000L, -2L, 127L, 100000L, 65536L
+};
+
+volatile long Res;
+
+int main (void)
+{
+    unsigned I, J;
+
+    BENCH_ANNOUNCE ("tosmuleax");
+    for (I = 0; I < BENCH_ITER; ++I) {
+        for (J = 0; J < BENCH_VALS; ++J) {
+            Res = BENCH_OP (A[J], *, B[J]);
+        }
+    }
+    return 0;
+}
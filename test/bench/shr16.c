@@ -0,0 +1,25 @@
+/* Cycle benchmark for the 16 bit logical right shift (shraxy) */
+
+#include "bench.h"
+
+static volatile unsigned A[BENCH_VALS] = {
+    1U, 3U, 100U, 320U, 1234U, 40000U, 255U, 65535U
+};
+static volatile unsigned char S[BENCH_VALS] = {
+    1, 2, 3, 4, 7, 8, 12, 15
+};
+
+volatile unsigned Res;
+
+int main (void)
+{
+    unsigned I, J;
+
+    BENCH_ANNOUNCE ("shraxy");
+    for (I = 0; I < BENCH_ITER; ++I) {
+        for (J = 0; J < BENCH_VALS; ++J) {
+            Res = BENCH_OP (A[J], >>, S[J]);
+        }
+    }
+    return 0;
+}
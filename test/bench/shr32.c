@@ -0,0 +1,25 @@
+/* Cycle benchmark for the 32 bit logical right shift (tosshreax) */
+
+#include "bench.h"
+
+static volatile unsigned long A[BENCH_VALS] = {
+    1UL, 300UL, 70000UL, 5UL, 123456UL, 2000000UL, 255UL, 4294967295UL
+};
+static volatile unsigned char S[BENCH_VALS] = {
+    1, 2, 3, 8, 15, 16, 24, 31
+};
+
+volatile unsigned long Res;
+
+int main (void)
+{
+    unsigned I, J;
+
+    BENCH_ANNOUNCE ("tosshreax");
+    for (I = 0; I < BENCH_ITER; ++I) {
+        for (J = 0; J < BENCH_VALS; ++J) {
+            Res = BENCH_OP (A[J], >>, S[J]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,25 @@
+/* Cycle benchmark for the 16 bit unsigned multiplication (tosumulax) */
+
+#include "bench.h"
+
+static volatile unsigned A[BENCH_VALS] = {
+    2U, 3U, 100U, 320U, 1234U, 40000U, 255U, 65535U
+};
+static volatile unsigned B[BENCH_VALS] = {
+    7U, 9U, 250U, 40U, 2U, 127U, 1000U, 768U
+};
+
+volatile unsigned Res;
+
+int main (void)
+{
+    unsigned I, J;
+
+    BENCH_ANNOUNCE ("tosumulax");
+    for (I = 0; I < BENCH_ITER; ++I) {
+        for (J = 0; J < BENCH_VALS; ++J) {
+            Res = BENCH_OP (A[J], *, B[J]);
+        }
+    }
+    return 0;
+}
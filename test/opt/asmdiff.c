@@ -0,0 +1,58 @@
+// minimal tool to compare two assembler files
+//
+// Comment lines (first character ';') and .fopt lines are ignored, since
+// both carry the compiler version string and would make the reference
+// files break on every release.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+static char *readline(FILE *f, char *buf, size_t size)
+{
+    // return the next line that takes part in the comparison
+    while (fgets(buf, size, f) != NULL) {
+        if (buf[0] == ';') {
+            continue;
+        }
+        if (strstr(buf, ".fopt") != NULL) {
+            continue;
+        }
+        return buf;
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    FILE *f1, *f2;
+    char line1[512], line2[512];
+    unsigned no = 0;
+    if (argc < 3) {
+        return EXIT_FAILURE;
+    }
+    f1 = fopen(argv[1], "r");
+    f2 = fopen(argv[2], "r");
+    if ((f1 == NULL) || (f2 == NULL)) {
+        return EXIT_FAILURE;
+    }
+    for(;;) {
+        char *l1 = readline(f1, line1, sizeof line1);
+        char *l2 = readline(f2, line2, sizeof line2);
+        ++no;
+        if (l1 == NULL && l2 == NULL) {
+            return EXIT_SUCCESS;
+        }
+        if (l1 == NULL || l2 == NULL || strcmp(l1, l2) != 0) {
+            fprintf(stderr, "%s: differs from %s (line %u)\n",
+                    argv[1], argv[2], no);
+            if (l1 != NULL) {
+                fprintf(stderr, "< %s", l1);
+            }
+            if (l2 != NULL) {
+                fprintf(stderr, "> %s", l2);
+            }
+            return EXIT_FAILURE;
+        }
+    }
+}
@@ -0,0 +1,7 @@
+unsigned char c;
+void f (unsigned char x)
+{
+    if (x == 7) {
+        ++c;
+    }
+}
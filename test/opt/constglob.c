@@ -0,0 +1,17 @@
+static const unsigned char tab[4] = { 10, 20, 30, 40 };
+static int limit = 100;
+static struct { volatile unsigned char flag; unsigned char pad; } s = { 0, 1 };
+unsigned char o;
+int r;
+void f (int x)
+{
+    if (x < limit) {
+        r = x;
+    }
+    o = tab[2];
+}
+unsigned char g (void)
+{
+    /* The load must survive: the member is volatile */
+    return s.flag;
+}
@@ -0,0 +1,6 @@
+int a, b;
+void f (void)
+{
+    a = 5;
+    b = 5;
+}
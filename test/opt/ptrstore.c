@@ -0,0 +1,5 @@
+char buf[10];
+void f (unsigned char i, char v)
+{
+    buf[i] = v;
+}
@@ -0,0 +1,5 @@
+unsigned char c;
+unsigned f (void)
+{
+    return c + 0;
+}
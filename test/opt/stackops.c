@@ -0,0 +1,5 @@
+int r;
+void f (int x, int y)
+{
+    r = x + y;
+}
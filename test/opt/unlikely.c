@@ -0,0 +1,9 @@
+int r;
+void f (int x)
+{
+    if (__builtin_expect (x == 0, 0)) {
+        r = 1;
+    } else {
+        r = 2;
+    }
+}
@@ -0,0 +1,74 @@
+// resource limited command runner for the stress tests
+//
+// Runs the given command with a wall clock and an address space ceiling,
+// and fails if the command fails or exceeds either limit. This turns a
+// scaling regression into a broken build instead of a slow one. The
+// address space limit needs setrlimit and is skipped on systems that
+// don't have it; the time check works everywhere.
+//
+// Usage: limit <seconds> <mbytes> cmd [args...]
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef _WIN32
+#  include <sys/resource.h>
+#endif
+
+#define MAXCMD 4096
+
+int main(int argc, char* argv[])
+{
+    char Cmd[MAXCMD];
+    long Secs, MBytes, Elapsed;
+    time_t Start;
+    int I, Res;
+
+    if (argc < 4) {
+        fprintf(stderr, "Usage: limit <seconds> <mbytes> cmd [args...]\n");
+        return 2;
+    }
+    Secs   = atol(argv[1]);
+    MBytes = atol(argv[2]);
+
+    // Build the command line
+    Cmd[0] = '\0';
+    for (I = 3; I < argc; ++I) {
+        if (strlen(Cmd) + strlen(argv[I]) + 2 > MAXCMD) {
+            fprintf(stderr, "limit: command too long\n");
+            return 2;
+        }
+        if (I > 3) {
+            strcat(Cmd, " ");
+        }
+        strcat(Cmd, argv[I]);
+    }
+
+#ifndef _WIN32
+    // The limit is inherited by the child started below
+    {
+        struct rlimit RL;
+        RL.rlim_cur = RL.rlim_max = (rlim_t) MBytes << 20;
+        setrlimit(RLIMIT_AS, &RL);
+    }
+#endif
+
+    Start = time(0);
+    Res = system(Cmd);
+    Elapsed = (long) (time(0) - Start);
+
+    if (Res != 0) {
+        fprintf(stderr, "limit: command failed (memory ceiling %ldMB): %s\n",
+                MBytes, Cmd);
+        return 1;
+    }
+    if (Elapsed > Secs) {
+        fprintf(stderr, "limit: %lds exceeds the %lds ceiling: %s\n",
+                Elapsed, Secs, Cmd);
+        return 1;
+    }
+    printf("%3lds  %s\n", Elapsed, Cmd);
+    return 0;
+}
@@ -0,0 +1,125 @@
+// generator for the scaling stress tests
+//
+// Writes inputs that are far larger than anything in the regular test
+// suite, so quadratic behavior in the symbol, export, macro and optimizer
+// tables shows up as a blown time or memory ceiling instead of shipping
+// unnoticed. The output is deterministic, so it can be regenerated instead
+// of being checked in.
+//
+// Usage: stressgen <kind> <count> <file>
+//
+//   sym    assembler source with <count> global labels, every 16th
+//          exported, followed by a block of unnamed labels with forward
+//          and backward references
+//   macro  C source with <count> macro definitions, half of them
+//          function like, and a function using a sample of them
+//   func   C source with <count> small functions and one caller
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+static void Usage(void)
+{
+    fprintf(stderr, "Usage: stressgen <sym|macro|func> <count> <file>\n");
+    exit(2);
+}
+
+static void GenSym(FILE* F, unsigned long Count)
+{
+    unsigned long I;
+
+    fprintf(F, ".segment \"CODE\"\n");
+    for (I = 0; I < Count; ++I) {
+        if (I % 16 == 0) {
+            fprintf(F, ".export l%lu\n", I);
+        }
+        fprintf(F, "l%lu:\n", I);
+    }
+
+    // Unnamed labels are resolved by a separate table in the assembler,
+    // so give it a workout of its own, with both reference directions.
+    // The labels are zero sized and each is referenced exactly once, so
+    // the output fits the 64K address space of the default target and
+    // the assembler has nothing to warn about.
+    for (I = 0; I < Count / 64; ++I) {
+        fprintf(F, ":\n");
+        fprintf(F, "        .byte <(:+ - :-)\n");
+        fprintf(F, ":\n");
+    }
+    fprintf(F, ".byte 42\n");
+}
+
+static void GenMacro(FILE* F, unsigned long Count)
+{
+    unsigned long I;
+
+    for (I = 0; I < Count; ++I) {
+        if (I & 1) {
+            fprintf(F, "#define F%lu(x) ((x) + %lu)\n", I, I % 13);
+        } else {
+            fprintf(F, "#define M%lu %lu\n", I, I % 13);
+        }
+    }
+
+    // Use a spread out sample of the macros, so lookup has to walk the
+    // full table, not just the last additions.
+    fprintf(F, "int sum (void)\n{\n    return 0");
+    for (I = 0; I < 100; ++I) {
+        unsigned long N = (I * 997UL) % Count;
+        if (N & 1) {
+            fprintf(F, " + F%lu(1)", N);
+        } else {
+            fprintf(F, " + M%lu", N);
+        }
+    }
+    fprintf(F, ";\n}\n");
+}
+
+static void GenFunc(FILE* F, unsigned long Count)
+{
+    unsigned long I;
+
+    for (I = 0; I < Count; ++I) {
+        fprintf(F, "int f%lu (int x) { return x + %lu; }\n", I, I % 100);
+    }
+
+    fprintf(F, "int total (int x)\n{\n    int r = 0;\n");
+    for (I = 0; I < Count; I += 100) {
+        fprintf(F, "    r += f%lu (x);\n", I);
+    }
+    fprintf(F, "    return r;\n}\n");
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned long Count;
+    FILE* F;
+
+    if (argc != 4) {
+        Usage();
+    }
+    Count = strtoul(argv[2], 0, 0);
+    if (Count == 0) {
+        Usage();
+    }
+
+    F = fopen(argv[3], "w");
+    if (F == 0) {
+        fprintf(stderr, "stressgen: cannot open '%s'\n", argv[3]);
+        return 1;
+    }
+
+    if (strcmp(argv[1], "sym") == 0) {
+        GenSym(F, Count);
+    } else if (strcmp(argv[1], "macro") == 0) {
+        GenMacro(F, Count);
+    } else if (strcmp(argv[1], "func") == 0) {
+        GenFunc(F, Count);
+    } else {
+        Usage();
+    }
+
+    fclose(F);
+    return 0;
+}
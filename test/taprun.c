@@ -0,0 +1,237 @@
+// parallel TAP runner for the sim65 exit-code tests
+//
+// Runs the given programs through sim65, several instances at a time, and
+// prints one TAP line per program. A test fails if sim65 exits with a
+// nonzero code, or - when a cycle budget file is given - if it needs more
+// cycles than budgeted plus the allowed threshold. Cycle counts are taken
+// from the "<n> cycles" line that sim65 prints with -c and are
+// deterministic, so they can be used to gate performance regressions.
+//
+// Usage: taprun [options] sim65 prg ...
+//
+//   -j num    number of simulator instances to run in parallel (default 1)
+//   -x num    maximum number of cycles, passed through to sim65
+//   -b file   read cycle budgets from file and fail tests that exceed them
+//   -t num    threshold in percent a test may exceed its budget (default 5)
+//   -u file   write the measured cycle counts to file as a new budget
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#  define popen  _popen
+#  define pclose _pclose
+#else
+#  include <sys/wait.h>
+#endif
+
+#define MAXJOBS  64
+#define MAXLINE  512
+
+typedef struct Budget Budget;
+struct Budget {
+    char          Name[128];
+    unsigned long Cycles;
+};
+
+static Budget*      Budgets;
+static unsigned     BudgetCount;
+
+typedef struct Job Job;
+struct Job {
+    FILE*         F;            /* Pipe to the simulator instance */
+    const char*   Path;         /* Program being run */
+    int           Used;
+};
+
+static const char* Basename(const char* Path)
+{
+    const char* P;
+    for (P = Path + strlen(Path); P > Path; --P) {
+        if (P[-1] == '/' || P[-1] == '\\') {
+            break;
+        }
+    }
+    return P;
+}
+
+static void ReadBudgets(const char* Name)
+{
+    char Line[MAXLINE];
+    FILE* F = fopen(Name, "r");
+    if (F == NULL) {
+        fprintf(stderr, "taprun: cannot open budget file %s\n", Name);
+        exit(EXIT_FAILURE);
+    }
+    while (fgets(Line, sizeof(Line), F) != NULL) {
+        Budget B;
+        if (sscanf(Line, "%127s %lu", B.Name, &B.Cycles) == 2) {
+            Budgets = realloc(Budgets, (BudgetCount + 1) * sizeof(Budget));
+            if (Budgets == NULL) {
+                fprintf(stderr, "taprun: out of memory\n");
+                exit(EXIT_FAILURE);
+            }
+            Budgets[BudgetCount++] = B;
+        }
+    }
+    fclose(F);
+}
+
+static const Budget* FindBudget(const char* Name)
+{
+    unsigned I;
+    for (I = 0; I < BudgetCount; ++I) {
+        if (strcmp(Budgets[I].Name, Name) == 0) {
+            return &Budgets[I];
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+    Job           Jobs[MAXJOBS];
+    unsigned      JobCount = 1;
+    const char*   MaxCycles = NULL;
+    const char*   BudgetFile = NULL;
+    const char*   UpdateFile = NULL;
+    unsigned long Threshold = 5;
+    const char*   Sim65;
+    FILE*         Update = NULL;
+    int           I = 1;
+    int           First;
+    unsigned      Count, Next, Done, Failed = 0;
+
+    /* Parse the options */
+    while (I < argc && argv[I][0] == '-') {
+        const char* Arg;
+        if (I + 1 >= argc) {
+            break;
+        }
+        Arg = argv[I + 1];
+        if (strcmp(argv[I], "-j") == 0) {
+            JobCount = (unsigned) strtoul(Arg, NULL, 10);
+            if (JobCount < 1 || JobCount > MAXJOBS) {
+                fprintf(stderr, "taprun: invalid job count %s\n", Arg);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv[I], "-x") == 0) {
+            MaxCycles = Arg;
+        } else if (strcmp(argv[I], "-b") == 0) {
+            BudgetFile = Arg;
+        } else if (strcmp(argv[I], "-t") == 0) {
+            Threshold = strtoul(Arg, NULL, 10);
+        } else if (strcmp(argv[I], "-u") == 0) {
+            UpdateFile = Arg;
+        } else {
+            fprintf(stderr, "taprun: unknown option %s\n", argv[I]);
+            return EXIT_FAILURE;
+        }
+        I += 2;
+    }
+    if (argc - I < 2) {
+        fprintf(stderr,
+                "Usage: taprun [-j num] [-x num] [-b file] [-t num] [-u file]"
+                " sim65 prg ...\n");
+        return EXIT_FAILURE;
+    }
+    Sim65 = argv[I++];
+    First = I;
+    Count = (unsigned) (argc - First);
+
+    if (BudgetFile != NULL) {
+        ReadBudgets(BudgetFile);
+    }
+    if (UpdateFile != NULL) {
+        Update = fopen(UpdateFile, "w");
+        if (Update == NULL) {
+            fprintf(stderr, "taprun: cannot create %s\n", UpdateFile);
+            return EXIT_FAILURE;
+        }
+    }
+
+    printf("1..%u\n", Count);
+    memset(Jobs, 0, sizeof(Jobs));
+
+    /* Keep up to JobCount simulator instances running. The pipes are
+    ** drained and closed in start order, so the output is deterministic
+    ** regardless of the completion order of the children.
+    */
+    Next = 0;
+    Done = 0;
+    while (Done < Count) {
+
+        /* Fill the free slots */
+        while (Next < Count && !Jobs[Next % JobCount].Used) {
+            Job* J = &Jobs[Next % JobCount];
+            char Cmd[2 * MAXLINE];
+            J->Path = argv[First + Next];
+            if (MaxCycles != NULL) {
+                snprintf(Cmd, sizeof(Cmd), "\"%s\" -c -x %s \"%s\"",
+                         Sim65, MaxCycles, J->Path);
+            } else {
+                snprintf(Cmd, sizeof(Cmd), "\"%s\" -c \"%s\"", Sim65, J->Path);
+            }
+            J->F = popen(Cmd, "r");
+            if (J->F == NULL) {
+                fprintf(stderr, "taprun: cannot run %s\n", Cmd);
+                return EXIT_FAILURE;
+            }
+            J->Used = 1;
+            ++Next;
+        }
+
+        /* Finish the oldest running job */
+        {
+            Job* J = &Jobs[Done % JobCount];
+            char Line[MAXLINE];
+            unsigned long Cycles = 0;
+            int HaveCycles = 0;
+            int Status;
+            const char* Name = Basename(J->Path);
+            const Budget* B;
+
+            while (fgets(Line, sizeof(Line), J->F) != NULL) {
+                unsigned long C;
+                if (sscanf(Line, "%lu cycles", &C) == 1) {
+                    Cycles = C;
+                    HaveCycles = 1;
+                }
+            }
+            Status = pclose(J->F);
+#ifndef _WIN32
+            if (WIFEXITED(Status)) {
+                Status = WEXITSTATUS(Status);
+            }
+#endif
+            J->Used = 0;
+
+            if (Status != 0) {
+                printf("not ok %u - %s # exit status %d\n",
+                       Done + 1, Name, Status);
+                ++Failed;
+            } else if (HaveCycles &&
+                       (B = FindBudget(Name)) != NULL &&
+                       Cycles > B->Cycles + B->Cycles / 100 * Threshold) {
+                printf("not ok %u - %s # %lu cycles exceeds budget %lu +%lu%%\n",
+                       Done + 1, Name, Cycles, B->Cycles, Threshold);
+                ++Failed;
+            } else if (HaveCycles) {
+                printf("ok %u - %s # %lu cycles\n", Done + 1, Name, Cycles);
+                if (Update != NULL) {
+                    fprintf(Update, "%s %lu\n", Name, Cycles);
+                }
+            } else {
+                printf("ok %u - %s\n", Done + 1, Name);
+            }
+            ++Done;
+        }
+    }
+
+    if (Update != NULL) {
+        fclose(Update);
+    }
+    printf("# %u of %u tests failed\n", Failed, Count);
+    return Failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,119 @@
+/*
+  !!DESCRIPTION!! Split lo/hi byte array layout (#pragma soa)
+  !!ORIGIN!!      cc65 regression tests
+  !!LICENCE!!     Public Domain
+*/
+
+#include <stdio.h>
+
+unsigned char success=0;
+unsigned char failures=0;
+unsigned char dummy=0;
+
+#pragma soa (on)
+int aint[100];
+unsigned auint[256];
+int *aptr[8];
+#pragma soa (off)
+
+int int0 = 5;
+int int1 = 7;
+
+void done()
+{
+  dummy++;
+}
+
+int get(unsigned char i)
+{
+  return aint[i];
+}
+
+void put(unsigned char i, int v)
+{
+  aint[i] = v;
+}
+
+void roundtrip(void)
+{
+  unsigned char i;
+
+  for(i = 0; i < 100; i++)
+    aint[i] = -1000 - i;
+
+  for(i = 0; i < 100; i++)
+    if(aint[i] != -1000 - i)
+      failures++;
+}
+
+void constindex(void)
+{
+  aint[0] = 1234;
+  aint[99] = -4321;
+
+  if(aint[0] != 1234)
+    failures++;
+  if(aint[99] != -4321)
+    failures++;
+
+  aint[1] = aint[2] = 4000;
+  if(aint[1] + aint[2] != 8000)
+    failures++;
+}
+
+void fullrange(void)
+{
+  unsigned char i;
+  unsigned long sum;
+
+  i = 0;
+  do {
+    auint[i] = 0x8000u | i;
+  } while(++i != 0);
+
+  sum = 0;
+  i = 0;
+  do {
+    sum += auint[i];
+  } while(++i != 0);
+
+  if(sum != 256ul * 0x8000u + 255ul * 128)
+    failures++;
+}
+
+void ptrelements(void)
+{
+  aptr[3] = &int0;
+  aptr[4] = &int1;
+
+  if(*aptr[3] + *aptr[4] != 12)
+    failures++;
+}
+
+int main(void)
+{
+  roundtrip();
+  constindex();
+  fullrange();
+  ptrelements();
+
+  put(50, 2222);
+  if(get(50) != 2222)
+    failures++;
+
+  if(sizeof(aint) != 200)
+    failures++;
+
+  aint[7] = 0;
+  if(aint[7])
+    failures++;
+  aint[7] = -1;
+  if(!aint[7])
+    failures++;
+
+  success = failures;
+  done();
+  printf("failures: %d\n",failures);
+
+  return failures;
+}